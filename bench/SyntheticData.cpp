@@ -0,0 +1,179 @@
+//
+// File: SyntheticData.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "SyntheticData.h"
+
+//From the STL:
+#include <cctype>
+
+using namespace bpp;
+using namespace std;
+
+char SyntheticData::randomBase_(mt19937& rng)
+{
+  static const char bases[] = "ACGT";
+  return bases[rng() & 3];
+}
+
+vector<string> SyntheticData::getSpecies(size_t nbSpecies)
+{
+  vector<string> species(nbSpecies);
+  for (size_t i = 0; i < nbSpecies; ++i)
+    species[i] = "sp" + to_string(i);
+  return species;
+}
+
+/******************************************************************************/
+
+size_t SyntheticData::writeMaf(ostream& out, const MafOptions& options)
+{
+  mt19937 rng(options.seed);
+  uniform_real_distribution<double> unif(0., 1.);
+  vector<string> species = getSpecies(options.nbSpecies);
+  vector<size_t> positions(options.nbSpecies, 0);
+  const size_t srcSize = 1000000000;
+  string ancestor(options.blockLength, 'N');
+  string row, quals;
+  out << "##maf version=1 program=SyntheticData" << endl << "#" << endl << endl;
+  for (size_t b = 0; b < options.nbBlocks; ++b) {
+    for (size_t i = 0; i < ancestor.size(); ++i)
+      ancestor[i] = randomBase_(rng);
+    out << "a score=" << static_cast<int>(unif(rng) * 100000) << "\n";
+    for (size_t s = 0; s < species.size(); ++s) {
+      if (s > 0 && unif(rng) < options.missingRate) continue;
+      row = ancestor;
+      size_t size = 0;
+      bool inGap = false, inMask = false;
+      for (size_t i = 0; i < row.size(); ++i) {
+        if (inGap) {
+          inGap = unif(rng) < 0.7; //Mean gap length ~3.
+        } else {
+          inGap = (s > 0 && unif(rng) < options.gapRate);
+        }
+        if (inGap) {
+          row[i] = '-';
+          continue;
+        }
+        if (unif(rng) < options.mutationRate)
+          row[i] = randomBase_(rng);
+        inMask = (inMask ? unif(rng) < 0.98 : unif(rng) < options.maskRate); //Mean masked length ~50.
+        if (inMask)
+          row[i] = static_cast<char>(tolower(row[i]));
+        size++;
+      }
+      string src = species[s] + ".chr1";
+      out << "s " << src << " " << positions[s] << " " << size << " + " << srcSize << " " << row << "\n";
+      if (options.qualities && s > 0) {
+        quals.resize(row.size());
+        for (size_t i = 0; i < row.size(); ++i)
+          quals[i] = (row[i] == '-' ? '-' : static_cast<char>('0' + rng() % 10));
+        out << "q " << src << " " << quals << "\n";
+      }
+      positions[s] += size + 10; //Leave small unaligned regions between blocks.
+    }
+    out << "\n";
+  }
+  return positions[0];
+}
+
+/******************************************************************************/
+
+void SyntheticData::writeGff(ostream& out, const FeatureOptions& options)
+{
+  mt19937 rng(options.seed);
+  out << "##gff-version 3" << endl;
+  size_t pos = 1;
+  for (size_t i = 0; i < options.nbFeatures; i += 3) {
+    size_t l1 = options.meanLength / 2 + rng() % options.meanLength;
+    size_t intron = options.meanLength / 2 + rng() % options.meanLength;
+    size_t l2 = options.meanLength / 2 + rng() % options.meanLength;
+    char strand = (rng() & 1) ? '+' : '-';
+    size_t end = pos + l1 + intron + l2 - 1;
+    out << "chr1\tbench\tgene\t" << pos << "\t" << end << "\t.\t" << strand << "\t.\tID=gene" << i << ";Name=G" << i << "\n";
+    out << "chr1\tbench\texon\t" << pos << "\t" << pos + l1 - 1 << "\t.\t" << strand << "\t.\tID=exon" << i << ".1;Parent=gene" << i << "\n";
+    out << "chr1\tbench\texon\t" << end - l2 + 1 << "\t" << end << "\t.\t" << strand << "\t.\tID=exon" << i << ".2;Parent=gene" << i << "\n";
+    pos = end + 1 + rng() % (2 * options.meanSpacing + 1);
+  }
+}
+
+void SyntheticData::writeGtf(ostream& out, const FeatureOptions& options)
+{
+  mt19937 rng(options.seed);
+  size_t pos = 1;
+  for (size_t i = 0; i < options.nbFeatures; i += 2) {
+    size_t l1 = options.meanLength / 2 + rng() % options.meanLength;
+    size_t intron = options.meanLength / 2 + rng() % options.meanLength;
+    size_t l2 = options.meanLength / 2 + rng() % options.meanLength;
+    char strand = (rng() & 1) ? '+' : '-';
+    size_t start2 = pos + l1 + intron;
+    out << "chr1\tbench\texon\t" << pos << "\t" << pos + l1 - 1 << "\t.\t" << strand << "\t.\tgene_id \"gene" << i << "\"; transcript_id \"tr" << i << "\";\n";
+    out << "chr1\tbench\texon\t" << start2 << "\t" << start2 + l2 - 1 << "\t.\t" << strand << "\t.\tgene_id \"gene" << i << "\"; transcript_id \"tr" << i << "\";\n";
+    pos = start2 + l2 + rng() % (2 * options.meanSpacing + 1);
+  }
+}
+
+void SyntheticData::writeBedGraph(ostream& out, const FeatureOptions& options)
+{
+  mt19937 rng(options.seed);
+  out << "track type=bedGraph name=synthetic" << endl;
+  size_t pos = 0;
+  for (size_t i = 0; i < options.nbFeatures; ++i) {
+    size_t length = 1 + rng() % (2 * options.meanLength);
+    out << "chr1\t" << pos << "\t" << pos + length << "\t" << static_cast<double>(rng() % 10000) / 100. << "\n";
+    pos += length + rng() % (2 * options.meanSpacing + 1);
+  }
+}
+
+/******************************************************************************/
+
+void SyntheticData::writeFastq(ostream& out, const FastqOptions& options)
+{
+  mt19937 rng(options.seed);
+  string seq(options.readLength, 'N'), qual(options.readLength, '!');
+  for (size_t i = 0; i < options.nbReads; ++i) {
+    for (size_t j = 0; j < options.readLength; ++j) {
+      seq[j] = randomBase_(rng);
+      //Qualities decrease along the read, as in real data:
+      int q = 40 - static_cast<int>(20 * j / options.readLength) - static_cast<int>(rng() % 10);
+      qual[j] = static_cast<char>(33 + q);
+    }
+    out << "@read" << i << " synthetic\n" << seq << "\n+\n" << qual << "\n";
+  }
+}
+
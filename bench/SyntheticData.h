@@ -0,0 +1,138 @@
+//
+// File: SyntheticData.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _SYNTHETICDATA_H_
+#define _SYNTHETICDATA_H_
+
+//From the STL:
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief Deterministic generators of synthetic MAF, GFF, GTF, BedGraph and FASTQ data.
+ *
+ * All generators use a fixed seed, so that the same options always produce the same output,
+ * and benchmark results can be compared between versions.
+ *
+ * MAF blocks are generated by mutating a random ancestral sequence in each species, from
+ * species "sp0" to "spN". All species have a single chromosome "chr1", on which blocks are contiguous and sorted,
+ * so that features generated for the same chromosome overlap blocks.
+ */
+class SyntheticData
+{
+  public:
+    struct MafOptions {
+      size_t nbSpecies;
+      size_t nbBlocks;
+      size_t blockLength;
+      double mutationRate; //Probability that a position differs from the ancestral sequence.
+      double gapRate; //Probability that a gap starts at a given position.
+      double maskRate; //Probability that a masked region starts at a given position.
+      double missingRate; //Probability that a species is absent from a block (never the first one).
+      bool qualities; //Add quality lines.
+      uint32_t seed;
+
+      MafOptions():
+        nbSpecies(10), nbBlocks(1000), blockLength(1000), mutationRate(0.05), gapRate(0.01), maskRate(0.002),
+        missingRate(0.05), qualities(false), seed(42) {}
+    };
+
+    struct FeatureOptions {
+      size_t nbFeatures;
+      size_t meanLength;
+      size_t meanSpacing;
+      uint32_t seed;
+
+      FeatureOptions(): nbFeatures(10000), meanLength(200), meanSpacing(1000), seed(42) {}
+    };
+
+    struct FastqOptions {
+      size_t nbReads;
+      size_t readLength;
+      uint32_t seed;
+
+      FastqOptions(): nbReads(100000), readLength(150), seed(42) {}
+    };
+
+  public:
+    /**
+     * @brief Write a MAF file.
+     *
+     * @return The number of positions covered on the chromosome of the first species.
+     */
+    static size_t writeMaf(std::ostream& out, const MafOptions& options);
+
+    /**
+     * @brief Write a GFF3 file with genes and exons on chr1, two exons per gene.
+     */
+    static void writeGff(std::ostream& out, const FeatureOptions& options);
+
+    /**
+     * @brief Write a GTF file with exons on chr1, two per transcript.
+     */
+    static void writeGtf(std::ostream& out, const FeatureOptions& options);
+
+    /**
+     * @brief Write a BedGraph file with intervals on chr1.
+     */
+    static void writeBedGraph(std::ostream& out, const FeatureOptions& options);
+
+    /**
+     * @brief Write a FASTQ file with random reads.
+     */
+    static void writeFastq(std::ostream& out, const FastqOptions& options);
+
+    /**
+     * @return The names of the species used in the MAF file.
+     */
+    static std::vector<std::string> getSpecies(size_t nbSpecies);
+
+  private:
+    static char randomBase_(std::mt19937& rng);
+};
+
+} // end of namespace bpp.
+
+#endif //_SYNTHETICDATA_H_
+
@@ -0,0 +1,361 @@
+//
+// File: bench.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "SyntheticData.h"
+
+//From bpp-seq-omics:
+#include <Bpp/Seq/Io/Maf/MafParser.h>
+#include <Bpp/Seq/Io/Maf/PipelineProfiler.h>
+#include <Bpp/Seq/Io/Maf/MafStatistics.h>
+#include <Bpp/Seq/Io/Maf/AlignmentFilterMafIterator.h>
+#include <Bpp/Seq/Io/Maf/BlockLengthMafIterator.h>
+#include <Bpp/Seq/Io/Maf/BlockMergerMafIterator.h>
+#include <Bpp/Seq/Io/Maf/BlockSizeMafIterator.h>
+#include <Bpp/Seq/Io/Maf/ChromosomeMafIterator.h>
+#include <Bpp/Seq/Io/Maf/ConcatenateMafIterator.h>
+#include <Bpp/Seq/Io/Maf/DuplicateFilterMafIterator.h>
+#include <Bpp/Seq/Io/Maf/EntropyFilterMafIterator.h>
+#include <Bpp/Seq/Io/Maf/FeatureExtractorMafIterator.h>
+#include <Bpp/Seq/Io/Maf/FeatureFilterMafIterator.h>
+#include <Bpp/Seq/Io/Maf/FullGapFilterMafIterator.h>
+#include <Bpp/Seq/Io/Maf/MaskFilterMafIterator.h>
+#include <Bpp/Seq/Io/Maf/OrphanSequenceFilterMafIterator.h>
+#include <Bpp/Seq/Io/Maf/QualityFilterMafIterator.h>
+#include <Bpp/Seq/Io/Maf/RemoveEmptySequencesMafIterator.h>
+#include <Bpp/Seq/Io/Maf/SequenceFilterMafIterator.h>
+#include <Bpp/Seq/Io/Maf/WindowSplitMafIterator.h>
+#include <Bpp/Seq/Io/Maf/OutputMafIterator.h>
+#include <Bpp/Seq/Io/Maf/CoordinatesOutputMafIterator.h>
+#include <Bpp/Seq/Io/Maf/TableOutputMafIterator.h>
+#include <Bpp/Seq/Io/Maf/VcfOutputMafIterator.h>
+#include <Bpp/Seq/Io/LineReader.h>
+#include <Bpp/Seq/Io/Fastq.h>
+#include <Bpp/Seq/Io/FastqBatch.h>
+#include <Bpp/Seq/Feature/Gff/GffFeatureReader.h>
+#include <Bpp/Seq/Feature/Gtf/GtfFeatureReader.h>
+#include <Bpp/Seq/Feature/Bed/BedGraphFeatureReader.h>
+
+//From bpp-seq:
+#include <Bpp/Seq/Alphabet/AlphabetTools.h>
+#include <Bpp/Seq/SequenceWithQuality.h>
+
+//From the STL:
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <functional>
+#include <cstdlib>
+#include <cstring>
+
+using namespace bpp;
+using namespace std;
+
+/**
+ * Microbenchmarks of the hot paths of the library, on synthetic data.
+ *
+ * Usage: bpp-seq-omics-bench [--scale n] [--filter pattern]
+ * The scale multiplies the size of all data sets, and only benchmarks whose name contains the pattern are run.
+ * Each benchmark reports the time spent in the tested component only (input parsing is excluded for MAF
+ * iterators, using a PipelineProfiler), the throughput in MB of input text per second, and in items per second.
+ */
+
+namespace {
+
+  //A stream buffer discarding all output:
+  class NullStreamBuffer: public streambuf
+  {
+    protected:
+      int overflow(int c) { return traits_type::not_eof(c); }
+      streamsize xsputn(const char*, streamsize n) { return n; }
+  };
+
+  struct BenchData
+  {
+    string maf;
+    size_t nbBlocks;
+    vector<string> species;
+    string gff, gtf, bedGraph, fastq;
+    size_t nbReads;
+    SequenceFeatureSet features;
+  };
+
+  string filter_;
+
+  bool selected(const string& name)
+  {
+    return filter_.empty() || name.find(filter_) != string::npos;
+  }
+
+  void report(const string& name, double seconds, size_t nbBytes, size_t nbItems, const string& unit)
+  {
+    double mb = static_cast<double>(nbBytes) / 1048576.;
+    cout << left << setw(42) << name << right << fixed
+         << setw(10) << setprecision(3) << seconds << " s"
+         << setw(12) << setprecision(1) << (seconds > 0 ? mb / seconds : 0.) << " MB/s"
+         << setw(14) << setprecision(0) << (seconds > 0 ? static_cast<double>(nbItems) / seconds : 0.) << " " << unit << "/s" << endl;
+  }
+
+  double elapsed(chrono::steady_clock::time_point start)
+  {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  }
+
+  MafParser* newParser(const BenchData& data)
+  {
+    MafParser* parser = new MafParser(new MemoryLineReader(data.maf.data(), data.maf.size()), true);
+    parser->setVerbose(false);
+    return parser;
+  }
+
+  typedef function<AbstractFilterMafIterator* (MafIterator*)> IteratorFactory;
+
+  //Run a MAF iterator on a parser, and report the time spent in the iterator only:
+  void benchIterator(const BenchData& data, const string& name, IteratorFactory factory)
+  {
+    if (!selected(name)) return;
+    unique_ptr<MafParser> parser(newParser(data));
+    unique_ptr<AbstractFilterMafIterator> iterator(factory(parser.get()));
+    iterator->setVerbose(false);
+    iterator->setLogStream(shared_ptr<OutputStream>(new NullOutputStream()));
+    PipelineProfiler profiler;
+    profiler.attach(iterator.get());
+    while (MafBlock* block = iterator->nextBlock())
+      iterator->recycle(block);
+    const MafStageProfile& stage = profiler.getStage(profiler.getNumberOfStages() - 1);
+    report(name, static_cast<double>(stage.getExclusiveTime()) * 1e-9, data.maf.size(), stage.blocksIn, "blocks");
+  }
+
+  void benchStatistics(const vector<MafBlock*>& blocks, size_t nbBytes, const string& name, MafStatistics* statistics)
+  {
+    unique_ptr<MafStatistics> stats(statistics);
+    if (!selected(name)) return;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t i = 0; i < blocks.size(); ++i)
+      stats->compute(*blocks[i]);
+    report(name, elapsed(start), nbBytes, blocks.size(), "blocks");
+  }
+
+  template<class Reader>
+  void benchFeatureReader(const string& text, const string& name)
+  {
+    if (!selected(name)) return;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    Reader reader(new MemoryLineReader(text.data(), text.size()));
+    SequenceFeatureSet features;
+    reader.getAllFeatures(features);
+    report(name, elapsed(start), text.size(), features.getNumberOfFeatures(), "features");
+  }
+
+}
+
+/******************************************************************************/
+
+int main(int argc, char** argv)
+{
+  size_t scale = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc)
+      scale = static_cast<size_t>(max(1, atoi(argv[++i])));
+    else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+      filter_ = argv[++i];
+    else {
+      cerr << "Usage: " << argv[0] << " [--scale n] [--filter pattern]" << endl;
+      return 1;
+    }
+  }
+
+  try {
+    //Generate the data sets:
+    BenchData data;
+    SyntheticData::MafOptions mafOptions;
+    mafOptions.nbBlocks *= scale;
+    mafOptions.qualities = true;
+    ostringstream maf;
+    size_t refLength = SyntheticData::writeMaf(maf, mafOptions);
+    data.maf = maf.str();
+    data.nbBlocks = mafOptions.nbBlocks;
+    data.species = SyntheticData::getSpecies(mafOptions.nbSpecies);
+
+    SyntheticData::FeatureOptions featureOptions;
+    featureOptions.nbFeatures *= scale;
+    //Features cover the aligned region of the reference species:
+    featureOptions.meanSpacing = max<size_t>(1, refLength / featureOptions.nbFeatures);
+    ostringstream gff, gtf, bedGraph;
+    SyntheticData::writeGff(gff, featureOptions);
+    SyntheticData::writeGtf(gtf, featureOptions);
+    SyntheticData::writeBedGraph(bedGraph, featureOptions);
+    data.gff = gff.str();
+    data.gtf = gtf.str();
+    data.bedGraph = bedGraph.str();
+    GffFeatureReader(new MemoryLineReader(data.gff.data(), data.gff.size())).getAllFeatures(data.features);
+
+    SyntheticData::FastqOptions fastqOptions;
+    fastqOptions.nbReads *= scale;
+    ostringstream fastq;
+    SyntheticData::writeFastq(fastq, fastqOptions);
+    data.fastq = fastq.str();
+    data.nbReads = fastqOptions.nbReads;
+
+    cout << "MAF: " << data.nbBlocks << " blocks of " << mafOptions.blockLength << " columns, " << data.species.size() << " species, "
+         << data.maf.size() / 1048576 << " MB." << endl;
+    cout << "Features: " << data.features.getNumberOfFeatures() << ", reads: " << data.nbReads << "." << endl << endl;
+
+    //Parsers:
+    if (selected("MafParser")) {
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      unique_ptr<MafParser> parser(newParser(data));
+      size_t nbBlocks = 0;
+      while (MafBlock* block = parser->nextBlock()) {
+        nbBlocks++;
+        parser->recycle(block);
+      }
+      report("MafParser", elapsed(start), data.maf.size(), nbBlocks, "blocks");
+    }
+    if (selected("MafParser(no mask)")) {
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      MafParser parser(new MemoryLineReader(data.maf.data(), data.maf.size()), false);
+      parser.setVerbose(false);
+      size_t nbBlocks = 0;
+      while (MafBlock* block = parser.nextBlock()) {
+        nbBlocks++;
+        parser.recycle(block);
+      }
+      report("MafParser(no mask)", elapsed(start), data.maf.size(), nbBlocks, "blocks");
+    }
+
+    //Filters:
+    const vector<string>& species = data.species;
+    vector<string> half(species.begin(), species.begin() + static_cast<ptrdiff_t>(species.size() / 2));
+    vector<string> ref(1, species[0]);
+    benchIterator(data, "AlignmentFilterMafIterator", [&](MafIterator* it) { return new AlignmentFilterMafIterator(it, species, 10, 5, 3u, 0.5, false, true); });
+    benchIterator(data, "BlockLengthMafIterator", [&](MafIterator* it) { return new BlockLengthMafIterator(it, mafOptions.blockLength / 2); });
+    benchIterator(data, "BlockMergerMafIterator", [&](MafIterator* it) { return new BlockMergerMafIterator(it, ref, 100); });
+    benchIterator(data, "BlockSizeMafIterator", [&](MafIterator* it) { return new BlockSizeMafIterator(it, static_cast<unsigned int>(species.size())); });
+    benchIterator(data, "ChromosomeMafIterator", [&](MafIterator* it) { return new ChromosomeMafIterator(it, species[0], "chr1"); });
+    benchIterator(data, "ConcatenateMafIterator", [&](MafIterator* it) { return new ConcatenateMafIterator(it, 10000, species[0]); });
+    benchIterator(data, "DuplicateFilterMafIterator", [&](MafIterator* it) { return new DuplicateFilterMafIterator(it, species[0], true); });
+    benchIterator(data, "EntropyFilterMafIterator", [&](MafIterator* it) { return new EntropyFilterMafIterator(it, species, 10, 5, 0.5, 3, false, true, false); });
+    benchIterator(data, "FeatureExtractorMafIterator", [&](MafIterator* it) { return new FeatureExtractorMafIterator(it, species[0], data.features, false, false, true); });
+    benchIterator(data, "FeatureFilterMafIterator", [&](MafIterator* it) { return new FeatureFilterMafIterator(it, species[0], data.features, false); });
+    benchIterator(data, "FullGapFilterMafIterator", [&](MafIterator* it) { return new FullGapFilterMafIterator(it, species); });
+    benchIterator(data, "MaskFilterMafIterator", [&](MafIterator* it) { return new MaskFilterMafIterator(it, species, 10, 5, 5, false); });
+    benchIterator(data, "OrphanSequenceFilterMafIterator", [&](MafIterator* it) { return new OrphanSequenceFilterMafIterator(it, half); });
+    benchIterator(data, "QualityFilterMafIterator", [&](MafIterator* it) { return new QualityFilterMafIterator(it, vector<string>(species.begin() + 1, species.end()), 10, 5, 3, false); });
+    benchIterator(data, "RemoveEmptySequencesMafIterator", [&](MafIterator* it) { return new RemoveEmptySequencesMafIterator(it); });
+    benchIterator(data, "SequenceFilterMafIterator", [&](MafIterator* it) { return new SequenceFilterMafIterator(it, half); });
+    benchIterator(data, "WindowSplitMafIterator", [&](MafIterator* it) { return new WindowSplitMafIterator(it, 100); });
+
+    //Statistics, on blocks parsed once:
+    {
+      vector<MafBlock*> blocks;
+      unique_ptr<MafParser> parser(newParser(data));
+      while (MafBlock* block = parser->nextBlock())
+        blocks.push_back(block);
+      vector<string> ingroup(species.begin() + 1, species.end());
+      vector<double> bounds;
+      for (size_t i = 0; i <= ingroup.size() + 1; ++i)
+        bounds.push_back(static_cast<double>(i) - 0.5);
+      vector< vector<string> > populations;
+      populations.push_back(half);
+      populations.push_back(vector<string>(species.begin() + static_cast<ptrdiff_t>(half.size()), species.end()));
+      vector<string> four(species.begin(), species.begin() + 4);
+      const Alphabet* alpha = &AlphabetTools::DNA_ALPHABET;
+      size_t n = data.maf.size();
+      benchStatistics(blocks, n, "AlignmentScoreMafStatistics", new AlignmentScoreMafStatistics());
+      benchStatistics(blocks, n, "BlockLengthMafStatistics", new BlockLengthMafStatistics());
+      benchStatistics(blocks, n, "BlockSizeMafStatistics", new BlockSizeMafStatistics());
+      benchStatistics(blocks, n, "CharacterCountsMafStatistics", new CharacterCountsMafStatistics(alpha, species, "All"));
+      benchStatistics(blocks, n, "DivergenceMatrixMafStatistics", new DivergenceMatrixMafStatistics(species));
+      benchStatistics(blocks, n, "FourSpeciesPatternCountsMafStatistics", new FourSpeciesPatternCountsMafStatistics(alpha, four));
+      benchStatistics(blocks, n, "PairwiseDivergenceMafStatistics", new PairwiseDivergenceMafStatistics(species[0], species[1]));
+      benchStatistics(blocks, n, "PolymorphismMafStatistics", new PolymorphismMafStatistics(populations));
+      benchStatistics(blocks, n, "SequenceDiversityMafStatistics", new SequenceDiversityMafStatistics(ingroup));
+      benchStatistics(blocks, n, "SequenceLengthMafStatistics", new SequenceLengthMafStatistics(species[0]));
+      benchStatistics(blocks, n, "SiteFrequencySpectrumMafStatistics", new SiteFrequencySpectrumMafStatistics(alpha, bounds, ingroup, species[0]));
+      benchStatistics(blocks, n, "SiteMafStatistics", new SiteMafStatistics(species));
+      for (size_t i = 0; i < blocks.size(); ++i)
+        parser->recycle(blocks[i]);
+    }
+
+    //Output iterators, writing to a null stream:
+    NullStreamBuffer nullBuffer;
+    ostream nullStream(&nullBuffer);
+    vector<string> genotypes(species.begin() + 1, species.end());
+    benchIterator(data, "OutputMafIterator", [&](MafIterator* it) { return new OutputMafIterator(it, &nullStream, true); });
+    benchIterator(data, "OutputMafIterator(BGZF)", [&](MafIterator* it) { return new OutputMafIterator(it, &nullStream, true, true); });
+    benchIterator(data, "CoordinatesOutputMafIterator", [&](MafIterator* it) { return new CoordinatesOutputMafIterator(it, &nullStream, half); });
+    benchIterator(data, "TableOutputMafIterator", [&](MafIterator* it) { return new TableOutputMafIterator(it, &nullStream, species, species[0]); });
+    benchIterator(data, "VcfOutputMafIterator", [&](MafIterator* it) { return new VcfOutputMafIterator(it, &nullStream, species[0], genotypes); });
+
+    //Feature readers:
+    benchFeatureReader<GffFeatureReader>(data.gff, "GffFeatureReader");
+    benchFeatureReader<GtfFeatureReader>(data.gtf, "GtfFeatureReader");
+    benchFeatureReader<BedGraphFeatureReader>(data.bedGraph, "BedGraphFeatureReader");
+
+    //FASTQ readers:
+    if (selected("FastqBatchReader")) {
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      FastqBatchReader reader(new MemoryLineReader(data.fastq.data(), data.fastq.size()), &AlphabetTools::DNA_ALPHABET);
+      FastqBatch batch(&AlphabetTools::DNA_ALPHABET);
+      size_t nbReads = 0;
+      while (reader.nextBatch(batch, 16384) > 0)
+        nbReads += batch.size();
+      report("FastqBatchReader", elapsed(start), data.fastq.size(), nbReads, "reads");
+    }
+    if (selected("Fastq")) {
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      istringstream input(data.fastq);
+      Fastq fq;
+      SequenceWithQuality seq(&AlphabetTools::DNA_ALPHABET);
+      size_t nbReads = 0;
+      while (fq.nextSequence(input, seq))
+        nbReads++;
+      report("Fastq", elapsed(start), data.fastq.size(), nbReads, "reads");
+    }
+    return 0;
+  } catch (exception& ex) {
+    cerr << ex.what() << endl;
+    return 1;
+  }
+}
+
@@ -40,13 +40,12 @@ knowledge of the CeCILL license and that you accept its terms.
 #include "BedGraphFeatureReader.h"
 
 //From bpp-core:
-#include <Bpp/Text/StringTokenizer.h>
 #include <Bpp/Text/TextTools.h>
-#include <Bpp/Text/KeyvalTools.h>
 #include <Bpp/Numeric/VectorTools.h>
 
 //From the STL:
 #include <string>
+#include <cstring>
 #include <iostream>
 
 using namespace bpp;
@@ -56,14 +55,53 @@ const std::string BedGraphFeatureReader::BED_VALUE = "BedValue";
 
 
 void BedGraphFeatureReader::getNextLine_() {
-  nextLine_ = "";
-  while (TextTools::isEmpty(nextLine_) || nextLine_.size() < 2 || nextLine_[0] == '#') {
-    if (input_.eof()) {
-      nextLine_ = "";
-      return;
+  hasNextLine_ = FeatureParsingTools::nextDataLine(*reader_, nextLine_);
+}
+
+void BedGraphFeatureReader::skipHeader_()
+{
+  bool start = false;
+  do {
+    getNextLine_();
+    if (nextLine_.size >= 5 && memcmp(nextLine_.data, "track", 5) == 0) {
+      start = true;
     }
-    getline(input_, nextLine_);
+  } while (!start && hasNextLine_);
+  if (!start)
+    throw Exception("BedGraphFeatureReader::constructor: Invalid BedGraph file, missing proper header.");
+  getNextLine_();
+}
+
+void BedGraphFeatureReader::splitCurrentLine_()
+{
+  if (FeatureParsingTools::splitColumns(nextLine_, columns_, 4) != 4)
+    throw Exception("BedGraphFeatureReader::nextFeature(). Wrong BedGraph file format: should have 4 tab delimited columns.");
+}
+
+BasicSequenceFeature BedGraphFeatureReader::parseCurrentLine_()
+{
+  size_t start = static_cast<size_t>(columns_[1].toUnsignedInteger());
+  size_t end   = static_cast<size_t>(columns_[2].toUnsignedInteger());
+  string id    = "bed" + TextTools::toString(++id_);
+  static const string* source = SequenceFeature::internLabel("bed_graph");
+  static const string* type = SequenceFeature::internLabel("");
+  BasicSequenceFeature feature(id, seqIds_.intern(columns_[0]), source, type, start, end, '.', -1);
+  
+  //Set value attributes:
+  if (!(columns_[3] == ".")) feature.setAttribute(valueKeyId_, columns_[3].toString());
+  return feature;
+}
+
+const TabixIndex& BedGraphFeatureReader::getIndex_()
+{
+  if (!reader_->isSeekable())
+    throw Exception("BedGraphFeatureReader::getFeaturesInRange. Range queries need a BGZF-compressed file, opened from its name.");
+  if (!index_.get()) {
+    if (path_.empty())
+      throw Exception("BedGraphFeatureReader::getFeaturesInRange. No index was set for this input.");
+    index_.reset(new TabixIndex(TabixIndex::findIndexFile(path_)));
   }
+  return *index_;
 }
 
 const BasicSequenceFeature BedGraphFeatureReader::nextFeature()
@@ -72,20 +110,8 @@ const BasicSequenceFeature BedGraphFeatureReader::nextFeature()
     throw Exception("BedGraphFeatureReader::nextFeature(). No more feature in file.");
   
   //Parse current line:
-  StringTokenizer st(nextLine_, "\t");
-  if (st.numberOfRemainingTokens() != 4)
-    throw Exception("BedGraphFeatureReader::nextFeature(). Wrong BedGraph file format: should have 4 tab delimited columns.");
-  
-  //if ok, we can parse each column:
-  string seqId       = st.nextToken();
-  unsigned int start = TextTools::to<unsigned int>(st.nextToken());
-  unsigned int end   = TextTools::to<unsigned int>(st.nextToken());
-  string value       = st.nextToken();
-  string id          = "bed" + TextTools::toString(++id_);
-  BasicSequenceFeature feature(id, seqId, "bed_graph", "", start, end, '.', -1);
-  
-  //Set value attributes:
-  if (value != ".") feature.setAttribute(BED_VALUE, value);
+  splitCurrentLine_();
+  BasicSequenceFeature feature = parseCurrentLine_();
 
   //Read the next line:
   getNextLine_();
@@ -93,6 +119,69 @@ const BasicSequenceFeature BedGraphFeatureReader::nextFeature()
   return feature;
 }
 
+void BedGraphFeatureReader::getAllFeatures(SequenceFeatureSet& features)
+{
+  while (hasMoreFeature()) {
+    splitCurrentLine_();
+    features.addFeature(unique_ptr<SequenceFeature>(new BasicSequenceFeature(parseCurrentLine_())));
+    getNextLine_();
+  }
+}
+
+void BedGraphFeatureReader::getFeaturesOfType(const std::string& type, SequenceFeatureSet& features)
+{
+  //All features have an empty type:
+  if (!type.empty()) {
+    while (hasMoreFeature())
+      getNextLine_();
+    return;
+  }
+  getAllFeatures(features);
+}
+
+void BedGraphFeatureReader::getFeaturesOfSequence(const std::string& seqId, SequenceFeatureSet& features)
+{
+  while (hasMoreFeature()) {
+    splitCurrentLine_();
+    if (columns_[0] == seqId)
+      features.addFeature(unique_ptr<SequenceFeature>(new BasicSequenceFeature(parseCurrentLine_())));
+    else
+      ++id_; //Keep the same numbering as sequential reading.
+    getNextLine_();
+  }
+}
+
+void BedGraphFeatureReader::getFeaturesInRange(const std::string& seqId, size_t start, size_t end, SequenceFeatureSet& features)
+{
+  vector<TabixIndex::Chunk> chunks;
+  getIndex_().getChunks(seqId, start, end, chunks);
+  uint64_t resume = reader_->getLineOffset();
+  unsigned int id = id_;
+  id_ = 0;
+
+  FeatureParsingTools::readChunks(*reader_, chunks, [&](const TextSpan& line) {
+    if (FeatureParsingTools::splitColumns(line, columns_, 4) != 4)
+      throw Exception("BedGraphFeatureReader::getFeaturesInRange(). Wrong BedGraph file format: should have 4 tab delimited columns.");
+    if (!(columns_[0] == seqId))
+      return true;
+    //Coordinates are 0-based, and lines are sorted by start position:
+    size_t fStart = static_cast<size_t>(columns_[1].toUnsignedInteger());
+    if (fStart >= end)
+      return false;
+    size_t fEnd = static_cast<size_t>(columns_[2].toUnsignedInteger());
+    if (fEnd > start)
+      features.addFeature(unique_ptr<SequenceFeature>(new BasicSequenceFeature(parseCurrentLine_())));
+    return true;
+  });
+  id_ = id;
+
+  //Go back to where sequential reading was:
+  if (hasNextLine_) {
+    reader_->seek(resume);
+    getNextLine_();
+  }
+}
+
 std::string BedGraphFeatureReader::toString(const bpp::SequenceFeature& f) {
   std::vector< std::string > v;
   v.push_back(f.getSequenceId());
@@ -42,6 +42,10 @@ knowledge of the CeCILL license and that you accept its terms.
 
 #include "../SequenceFeature.h"
 #include "../FeatureReader.h"
+#include "../FeatureParsingTools.h"
+#include "../../Io/LineReader.h"
+#include "../../Io/CompressedInput.h"
+#include "../../Io/TabixIndex.h"
 
 //From bpp-core:
 #include <Bpp/Exceptions.h>
@@ -49,6 +53,7 @@ knowledge of the CeCILL license and that you accept its terms.
 //From the STL:
 #include <string>
 #include <vector>
+#include <memory>
 
 namespace bpp {
 
@@ -70,49 +75,95 @@ class BedGraphFeatureReader:
     static const std::string BED_VALUE;
 
   private:
-    std::istream& input_;
-    std::string nextLine_;
+    std::string path_;
+    std::unique_ptr<LineReader> reader_;
+    std::unique_ptr<TabixIndex> index_;
+    TextSpan nextLine_;
+    bool hasNextLine_;
+    TextSpan columns_[4];
+    FeatureLabelInterner seqIds_;
+    size_t valueKeyId_;
     unsigned int id_;
 
   public:
     BedGraphFeatureReader(std::istream& input):
-      input_(input), nextLine_(), id_(0)
+      path_(), reader_(new StreamLineReader(&input)), index_(), nextLine_(), hasNextLine_(false), columns_(),
+      seqIds_(), valueKeyId_(SequenceFeature::internAttributeKey(BED_VALUE)), id_(0)
     {
-      bool start = false;
-      do {
+      skipHeader_();
+    }
+
+    /**
+     * @brief Read features from a file, which may be gzip or BGZF compressed.
+     *
+     * @param path The path of the file to read.
+     * @param nbThreads The number of threads used to decompress BGZF files (0 for one per core).
+     * @see CompressedLineReader
+     */
+    BedGraphFeatureReader(const std::string& path, unsigned int nbThreads = 0):
+      path_(path), reader_(new CompressedLineReader(path, nbThreads)), index_(), nextLine_(), hasNextLine_(false), columns_(),
+      seqIds_(), valueKeyId_(SequenceFeature::internAttributeKey(BED_VALUE)), id_(0)
+    {
+      skipHeader_();
+    }
+
+    /**
+     * @brief Read features from a generic line reader.
+     *
+     * @param reader The line reader, which is owned by this object.
+     * @param readHeader Tell if the input starts with the track header. If not, the first line is a data line.
+     */
+    BedGraphFeatureReader(LineReader* reader, bool readHeader = true):
+      path_(), reader_(reader), index_(), nextLine_(), hasNextLine_(false), columns_(),
+      seqIds_(), valueKeyId_(SequenceFeature::internAttributeKey(BED_VALUE)), id_(0)
+    {
+      if (readHeader)
+        skipHeader_();
+      else
         getNextLine_();
-        if (nextLine_.size() >= 5 && nextLine_.substr(0, 5) == "track") {
-          start = true;
-        }
-      } while(!start && !input_.eof());
-      if (input_.eof())
-        throw Exception("BedGraphFeatureReader::constructor: Invalid BedGraph file, missing proper header.");
-      getNextLine_();
     }
 
   public:
-    bool hasMoreFeature() const { return nextLine_ != ""; }
+    bool hasMoreFeature() const { return hasNextLine_; }
     const BasicSequenceFeature nextFeature();
 
-    void getAllFeatures(SequenceFeatureSet& features) {
-      while (hasMoreFeature()) {
-        features.addFeature(nextFeature());
-      }
-    }
-    void getFeaturesOfType(const std::string& type, SequenceFeatureSet& features) {
-      while (hasMoreFeature()) {
-        BasicSequenceFeature feature = nextFeature();
-        if (feature.getType() == type)
-          features.addFeature(feature);
-      }
-    }
-    void getFeaturesOfSequence(const std::string& seqId, SequenceFeatureSet& features) {
-      while (hasMoreFeature()) {
-        BasicSequenceFeature feature = nextFeature();
-        if (feature.getSequenceId() == seqId)
-          features.addFeature(feature);
-      }
-    }
+    /**
+     * @brief Read all remaining features.
+     *
+     * Features are directly created in the set, without intermediate copy.
+     */
+    void getAllFeatures(SequenceFeatureSet& features);
+
+    void getFeaturesOfType(const std::string& type, SequenceFeatureSet& features);
+
+    /**
+     * @brief Read all remaining features of a given sequence.
+     *
+     * Only the lines matching the sequence are fully parsed.
+     */
+    void getFeaturesOfSequence(const std::string& seqId, SequenceFeatureSet& features);
+
+    /**
+     * @brief Read the features overlapping a region, using a tabix index.
+     *
+     * The file must be BGZF-compressed, sorted by coordinates and indexed (see TabixIndex), and the
+     * reader must have been created from its file name. Only the chunks of the file that may contain
+     * the region are decompressed and parsed. Sequential reading is not affected. Features read this
+     * way are numbered independently of the sequential reading.
+     *
+     * @param seqId The sequence id.
+     * @param start The beginning of the region (0-based, included).
+     * @param end The end of the region (0-based, excluded).
+     * @param features [out] The set where features are added.
+     */
+    void getFeaturesInRange(const std::string& seqId, size_t start, size_t end, SequenceFeatureSet& features);
+
+    /**
+     * @brief Use a given index file for range queries.
+     *
+     * By default, the index is the data file name with extension .tbi or .csi.
+     */
+    void setIndex(const std::string& indexPath) { index_.reset(new TabixIndex(indexPath)); }
 
     /**
      * @param f A sequence feature.
@@ -141,6 +192,14 @@ class BedGraphFeatureReader:
   private:
     void getNextLine_();
 
+    void skipHeader_();
+
+    const TabixIndex& getIndex_();
+
+    void splitCurrentLine_();
+
+    BasicSequenceFeature parseCurrentLine_();
+
 };
 
 } //end of namespace bpp
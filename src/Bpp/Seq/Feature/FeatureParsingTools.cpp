@@ -0,0 +1,101 @@
+//
+// File: FeatureParsingTools.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "FeatureParsingTools.h"
+
+//From the STL:
+#include <cstdlib>
+#include <cstring>
+
+using namespace bpp;
+using namespace std;
+
+size_t TextSpanInterner::getId(const TextSpan& text)
+{
+  //Consecutive lines very often share the same value:
+  if (last_ < values_.size() && text == *values_[last_])
+    return last_;
+  size_t h = hash(text);
+  auto range = index_.equal_range(h);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (text == *values_[it->second]) {
+      last_ = it->second;
+      return last_;
+    }
+  }
+  last_ = values_.size();
+  values_.push_back(new string(text.data, text.size));
+  index_.insert(make_pair(h, last_));
+  return last_;
+}
+
+void TextSpanInterner::clear()
+{
+  for (size_t i = 0; i < values_.size(); ++i)
+    delete values_[i];
+  values_.clear();
+  index_.clear();
+  last_ = 0;
+}
+
+size_t FeatureParsingTools::splitColumns(const TextSpan& line, TextSpan* columns, size_t maxColumns)
+{
+  size_t n = 0;
+  const char* p = line.data;
+  const char* end = line.data + line.size;
+  while (true) {
+    const char* tab = static_cast<const char*>(memchr(p, '\t', static_cast<size_t>(end - p)));
+    const char* stop = tab ? tab : end;
+    if (n == maxColumns) return n + 1;
+    columns[n++] = TextSpan(p, static_cast<size_t>(stop - p));
+    if (!tab) return n;
+    p = tab + 1;
+  }
+}
+
+double FeatureParsingTools::toDouble(const TextSpan& text)
+{
+  //Scores are short, a stack buffer avoids an allocation:
+  char buffer[64];
+  if (text.size >= sizeof(buffer))
+    return atof(text.toString().c_str());
+  memcpy(buffer, text.data, text.size);
+  buffer[text.size] = '\0';
+  return strtod(buffer, 0);
+}
@@ -0,0 +1,216 @@
+//
+// File: FeatureParsingTools.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _FEATUREPARSINGTOOLS_H_
+#define _FEATUREPARSINGTOOLS_H_
+
+#include "SequenceFeature.h"
+#include "../Io/LineReader.h"
+#include "../Io/TabixIndex.h"
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstring>
+
+namespace bpp {
+
+/**
+ * @brief A table of distinct strings, looked up from text spans without allocation.
+ *
+ * Feature files repeat the same few sequence names, sources and types on millions of lines.
+ * Interning them allows parsers to build features from a shared string instead of a new
+ * temporary one for each line. Strings are only allocated the first time they are seen.
+ * References returned remain valid as long as the table exists.
+ */
+class TextSpanInterner
+{
+  private:
+    std::vector<std::string*> values_;
+    std::unordered_multimap<size_t, size_t> index_;
+    size_t last_;
+
+  public:
+    TextSpanInterner(): values_(), index_(), last_(0) {}
+
+    virtual ~TextSpanInterner() { clear(); }
+
+  private:
+    TextSpanInterner(const TextSpanInterner&);
+    TextSpanInterner& operator=(const TextSpanInterner&);
+
+  public:
+    /**
+     * @return The interned copy of the given text.
+     */
+    const std::string& intern(const TextSpan& text) { return *values_[getId(text)]; }
+
+    /**
+     * @return The identifier of the given text, which is added to the table if needed.
+     * Identifiers are attributed consecutively, starting from 0.
+     */
+    size_t getId(const TextSpan& text);
+
+    const std::string& getValue(size_t id) const { return *values_[id]; }
+
+    size_t getNumberOfValues() const { return values_.size(); }
+
+    void clear();
+
+    /**
+     * @return A FNV-1a hash of the given text.
+     */
+    static size_t hash(const TextSpan& text) {
+      uint64_t h = 14695981039346656037ULL;
+      for (size_t i = 0; i < text.size; ++i) {
+        h ^= static_cast<unsigned char>(text.data[i]);
+        h *= 1099511628211ULL;
+      }
+      return static_cast<size_t>(h);
+    }
+};
+
+/**
+ * @brief Map text spans to the global feature labels (see SequenceFeature::internLabel).
+ *
+ * Each distinct value is looked up in the global table only once per parser,
+ * so that features are built from shared labels without locking.
+ */
+class FeatureLabelInterner
+{
+  private:
+    TextSpanInterner values_;
+    std::vector<const std::string*> labels_;
+
+  public:
+    FeatureLabelInterner(): values_(), labels_() {}
+
+  public:
+    /**
+     * @return The global label equal to the given text.
+     */
+    const std::string* intern(const TextSpan& text) {
+      size_t id = values_.getId(text);
+      if (id == labels_.size())
+        labels_.push_back(SequenceFeature::internLabel(values_.getValue(id)));
+      return labels_[id];
+    }
+};
+
+/**
+ * @brief Low-level helpers for feature file parsers.
+ *
+ * All functions work in place on the line buffer.
+ */
+class FeatureParsingTools
+{
+  public:
+    /**
+     * @brief Split a line into tab-delimited columns.
+     *
+     * @param line The line to split.
+     * @param columns [out] An array of at least maxColumns spans.
+     * @param maxColumns The maximum number of columns to retrieve.
+     * @return The number of columns found, which is maxColumns + 1 if the line has more columns.
+     */
+    static size_t splitColumns(const TextSpan& line, TextSpan* columns, size_t maxColumns);
+
+    /**
+     * @return The span without leading and trailing white spaces.
+     */
+    static TextSpan trim(const TextSpan& text) {
+      size_t a = 0, b = text.size;
+      while (a < b && TextSpan::isSpace(text.data[a])) ++a;
+      while (b > a && TextSpan::isSpace(text.data[b - 1])) --b;
+      return TextSpan(text.data + a, b - a);
+    }
+
+    /**
+     * @brief Parse a floating point number.
+     *
+     * As with TextTools::to<double>, an unparsable value such as "." gives 0.
+     */
+    static double toDouble(const TextSpan& text);
+
+    /**
+     * @brief Read the next data line, skipping empty lines and comments.
+     *
+     * Trailing carriage returns are removed.
+     *
+     * @param reader The line reader.
+     * @param line [out] The line found.
+     * @return False if no more data line is available.
+     */
+    static bool nextDataLine(LineReader& reader, TextSpan& line) {
+      while (reader.nextLine(line)) {
+        while (line.size > 0 && line.data[line.size - 1] == '\r') line.size--;
+        if (line.size >= 2 && line.data[0] != '#' && !line.isBlank())
+          return true;
+      }
+      return false;
+    }
+
+    /**
+     * @brief Read the data lines of a list of chunks, as returned by TabixIndex::getChunks.
+     *
+     * Empty lines, comments, and lines starting with "track" or "browser" are skipped.
+     *
+     * @param reader A seekable line reader, with BGZF virtual offsets.
+     * @param chunks The chunks to read.
+     * @param handler A function called on each line, returning false to stop reading.
+     */
+    template<class LineHandler>
+    static void readChunks(LineReader& reader, const std::vector<TabixIndex::Chunk>& chunks, LineHandler handler) {
+      TextSpan line;
+      for (size_t i = 0; i < chunks.size(); ++i) {
+        reader.seek(chunks[i].begin);
+        while (reader.nextLine(line) && reader.getLineOffset() < chunks[i].end) {
+          while (line.size > 0 && line.data[line.size - 1] == '\r') line.size--;
+          if (line.size < 2 || line.data[0] == '#' || line.isBlank()) continue;
+          if ((line.size >= 5 && std::memcmp(line.data, "track", 5) == 0) || (line.size >= 7 && std::memcmp(line.data, "browser", 7) == 0)) continue;
+          if (!handler(line)) return;
+        }
+      }
+    }
+};
+
+} //end of namespace bpp
+
+#endif //_FEATUREPARSINGTOOLS_H_
@@ -0,0 +1,214 @@
+//
+// File: FeatureRangeIndex.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "FeatureRangeIndex.h"
+#include "SequenceFeatureCache.h"
+
+//From the STL:
+#include <algorithm>
+
+using namespace bpp;
+using namespace std;
+
+namespace {
+  //Order ranges by start, end and original rank, so that the first feature with given coordinates comes first:
+  struct RangeOrder_ {
+    const vector<SeqRange>& ranges;
+    RangeOrder_(const vector<SeqRange>& r): ranges(r) {}
+    bool operator()(size_t i, size_t j) const {
+      if (ranges[i].begin() != ranges[j].begin()) return ranges[i].begin() < ranges[j].begin();
+      if (ranges[i].end() != ranges[j].end()) return ranges[i].end() < ranges[j].end();
+      return i < j;
+    }
+  };
+
+  const vector<SeqRange> EMPTY_RANGES_;
+  const vector<size_t> EMPTY_POSITIONS_;
+}
+
+/******************************************************************************/
+
+FeatureRangeIndex::FeatureRangeIndex(const SequenceFeatureSet& features):
+  index_()
+{
+  //Features are grouped by sequence first, in their original order:
+  map<string, vector<SeqRange> > ranges;
+  map<string, vector<SeqRange> >::iterator current = ranges.end();
+  for (size_t i = 0; i < features.getNumberOfFeatures(); ++i) {
+    const SequenceFeature& feature = features[i];
+    if (current == ranges.end() || current->first != feature.getSequenceId())
+      current = ranges.insert(make_pair(feature.getSequenceId(), vector<SeqRange>())).first;
+    current->second.push_back(feature.getRange());
+  }
+  for (map<string, vector<SeqRange> >::const_iterator it = ranges.begin(); it != ranges.end(); ++it)
+    indexSequence_(it->first, it->second);
+}
+
+FeatureRangeIndex::FeatureRangeIndex(const SequenceFeatureCache& cache):
+  index_()
+{
+  set<string> seqIds = cache.getSequences();
+  for (set<string>::const_iterator it = seqIds.begin(); it != seqIds.end(); ++it) {
+    vector<size_t> indices;
+    cache.getIndicesForSequence(*it, indices);
+    sort(indices.begin(), indices.end());
+    vector<SeqRange> ranges;
+    ranges.reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+      ranges.push_back(cache.getRange(indices[i]));
+    indexSequence_(*it, ranges);
+  }
+}
+
+/******************************************************************************/
+
+void FeatureRangeIndex::indexSequence_(const string& seqId, const vector<SeqRange>& ranges)
+{
+  vector<size_t> order;
+  order.reserve(ranges.size());
+  for (size_t i = 0; i < ranges.size(); ++i)
+    if (!ranges[i].isEmpty())
+      order.push_back(i);
+  if (order.empty())
+    return;
+  sort(order.begin(), order.end(), RangeOrder_(ranges));
+
+  SequenceIndex_& index = index_[seqId];
+  size_t maxEnd = 0;
+  for (size_t k = 0; k < order.size(); ++k) {
+    const SeqRange& r = ranges[order[k]];
+    //Features with identical coordinates are only indexed once:
+    if (!index.ranges.empty() && index.ranges.back().begin() == r.begin() && index.ranges.back().end() == r.end())
+      continue;
+    index.ranges.push_back(r);
+    maxEnd = max(maxEnd, r.end());
+    index.maxEnds.push_back(maxEnd);
+    //Overlapping and contiguous ranges are merged:
+    if (!index.bounds.empty() && r.begin() <= index.bounds.back()) {
+      index.bounds.back() = max(index.bounds.back(), r.end());
+    } else {
+      index.bounds.push_back(r.begin());
+      index.bounds.push_back(r.end());
+    }
+  }
+}
+
+/******************************************************************************/
+
+vector<string> FeatureRangeIndex::getSequences() const
+{
+  vector<string> seqIds;
+  for (map<string, SequenceIndex_>::const_iterator it = index_.begin(); it != index_.end(); ++it)
+    seqIds.push_back(it->first);
+  return seqIds;
+}
+
+const vector<SeqRange>& FeatureRangeIndex::getRanges(const string& seqId) const
+{
+  const SequenceIndex_* index = find_(seqId);
+  return index ? index->ranges : EMPTY_RANGES_;
+}
+
+const vector<size_t>& FeatureRangeIndex::getMaxEnds(const string& seqId) const
+{
+  const SequenceIndex_* index = find_(seqId);
+  return index ? index->maxEnds : EMPTY_POSITIONS_;
+}
+
+const vector<size_t>& FeatureRangeIndex::getBounds(const string& seqId) const
+{
+  const SequenceIndex_* index = find_(seqId);
+  return index ? index->bounds : EMPTY_POSITIONS_;
+}
+
+/******************************************************************************/
+
+vector<size_t> FeatureRangeIndex::getBoundsWithin(const string& seqId, const Range<size_t>& range) const
+{
+  vector<size_t> selection;
+  const vector<size_t>& bounds = getBounds(seqId);
+  //Intervals do not overlap, so their ends are sorted too.
+  //We look for the first interval ending after the beginning of the range:
+  size_t nbIntervals = bounds.size() / 2;
+  size_t lo = 0, hi = nbIntervals;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (bounds[2 * mid + 1] <= range.begin())
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  for (size_t i = lo; i < nbIntervals && bounds[2 * i] < range.end(); ++i) {
+    size_t a = max(bounds[2 * i], range.begin());
+    size_t b = min(bounds[2 * i + 1], range.end());
+    if (a < b) {
+      selection.push_back(a);
+      selection.push_back(b);
+    }
+  }
+  return selection;
+}
+
+size_t FeatureRangeIndex::getFirstCandidate(const string& seqId, size_t pos) const
+{
+  const vector<size_t>& maxEnds = getMaxEnds(seqId);
+  //All ranges before the first one with maxEnds >= pos end before pos:
+  return static_cast<size_t>(lower_bound(maxEnds.begin(), maxEnds.end(), pos) - maxEnds.begin());
+}
+
+void FeatureRangeIndex::fillRangeCollectionForRange(const string& seqId, const Range<size_t>& range, bool complete, RangeCollection<size_t>& ranges) const
+{
+  const SequenceIndex_* index = find_(seqId);
+  if (!index) return;
+  const vector<SeqRange>& r = index->ranges;
+  if (complete) {
+    //Included ranges start within the query range:
+    size_t i = static_cast<size_t>(lower_bound(r.begin(), r.end(), range.begin(),
+          [](const SeqRange& a, size_t b) { return a.begin() < b; }) - r.begin());
+    for (; i < r.size() && r[i].begin() < range.end(); ++i)
+      if (r[i].end() <= range.end())
+        ranges.addRange(r[i]);
+  } else {
+    size_t i = getFirstCandidate(seqId, range.begin() + 1);
+    for (; i < r.size() && r[i].begin() < range.end(); ++i)
+      if (r[i].end() > range.begin())
+        ranges.addRange(r[i]);
+  }
+}
+
@@ -0,0 +1,180 @@
+//
+// File: FeatureRangeIndex.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _FEATURERANGEINDEX_H_
+#define _FEATURERANGEINDEX_H_
+
+#include "SequenceFeature.h"
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <map>
+
+namespace bpp {
+
+class SequenceFeatureCache;
+
+/**
+ * @brief An immutable, per-sequence index of feature coordinates.
+ *
+ * For each sequence, the index stores the distinct feature ranges sorted by start and end
+ * positions (when several features share the same coordinates, the strand of the first one
+ * is kept), the running maximum of their end positions, and the union of all features as
+ * sorted, non-overlapping intervals.
+ *
+ * The index is built once, in O(n log n), and is never modified afterwards. It can therefore
+ * be shared by several feature-aware MAF iterators (see FeatureFilterMafIterator,
+ * FeatureExtractorMafIterator and CoordinateTranslatorMafIterator), possibly running in
+ * distinct threads, instead of each of them indexing the same features again.
+ *
+ * @author Julien Dutheil
+ */
+class FeatureRangeIndex
+{
+  private:
+    struct SequenceIndex_ {
+      std::vector<SeqRange> ranges;
+      std::vector<size_t> maxEnds;
+      std::vector<size_t> bounds;
+      SequenceIndex_(): ranges(), maxEnds(), bounds() {}
+    };
+    std::map<std::string, SequenceIndex_> index_;
+
+  public:
+    /**
+     * @brief Index all features in a set.
+     *
+     * @param features The features to index.
+     */
+    FeatureRangeIndex(const SequenceFeatureSet& features);
+
+    /**
+     * @brief Index all features in a binary snapshot, without building any feature object.
+     *
+     * @param cache The snapshot to index.
+     */
+    FeatureRangeIndex(const SequenceFeatureCache& cache);
+
+  private:
+    //Recopy is forbidden!
+    FeatureRangeIndex(const FeatureRangeIndex&);
+    FeatureRangeIndex& operator=(const FeatureRangeIndex&);
+
+  public:
+    /**
+     * @return True if at least one non-empty feature is indexed for the given sequence.
+     * @param seqId The sequence identifier.
+     */
+    bool hasSequence(const std::string& seqId) const { return index_.find(seqId) != index_.end(); }
+
+    /**
+     * @return The identifiers of all indexed sequences.
+     */
+    std::vector<std::string> getSequences() const;
+
+    /**
+     * @return The distinct feature ranges on a sequence, sorted by start then end position.
+     * The vector is empty if the sequence is not indexed.
+     * @param seqId The sequence identifier.
+     */
+    const std::vector<SeqRange>& getRanges(const std::string& seqId) const;
+
+    /**
+     * @return For each range returned by getRanges(), the maximum end position of all ranges up to this one.
+     * @param seqId The sequence identifier.
+     */
+    const std::vector<size_t>& getMaxEnds(const std::string& seqId) const;
+
+    /**
+     * @return The union of all features on a sequence, as sorted interval bounds (begin, end, begin, end...).
+     * Overlapping and contiguous features are merged, as in a MultiRange.
+     * @param seqId The sequence identifier.
+     */
+    const std::vector<size_t>& getBounds(const std::string& seqId) const;
+
+    /**
+     * @brief Get the union of all features overlapping a given range, restricted to this range.
+     *
+     * @param seqId The sequence identifier.
+     * @param range The range to look at.
+     * @return The bounds of the merged features within the range, in increasing order.
+     */
+    std::vector<size_t> getBoundsWithin(const std::string& seqId, const Range<size_t>& range) const;
+
+    /**
+     * @brief Get the position, in getRanges(), of the first range which may overlap a given position.
+     *
+     * All ranges before the returned position end before the given one.
+     *
+     * @param seqId The sequence identifier.
+     * @param pos The position to look at.
+     */
+    size_t getFirstCandidate(const std::string& seqId, size_t pos) const;
+
+    /**
+     * @brief Get all distinct feature ranges overlapping a given range.
+     *
+     * @param seqId The sequence identifier.
+     * @param range The range to look at.
+     * @param complete If true, only ranges fully included in the query range are retrieved.
+     * @param ranges [out] A collection where the selected ranges will be added.
+     */
+    void fillRangeCollectionForRange(const std::string& seqId, const Range<size_t>& range, bool complete, RangeCollection<size_t>& ranges) const;
+
+  private:
+    /**
+     * @brief Index the ranges of a sequence.
+     *
+     * @param seqId The sequence identifier.
+     * @param ranges The feature ranges, in the order of the features. Empty ranges are ignored.
+     */
+    void indexSequence_(const std::string& seqId, const std::vector<SeqRange>& ranges);
+
+    const SequenceIndex_* find_(const std::string& seqId) const {
+      std::map<std::string, SequenceIndex_>::const_iterator it = index_.find(seqId);
+      return (it == index_.end() ? 0 : &it->second);
+    }
+
+};
+
+} //end of namespace bpp
+
+#endif //_FEATURERANGEINDEX_H_
+
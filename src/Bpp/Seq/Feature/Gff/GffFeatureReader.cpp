@@ -40,13 +40,13 @@ knowledge of the CeCILL license and that you accept its terms.
 #include "GffFeatureReader.h"
 
 //From bpp-core:
-#include <Bpp/Text/StringTokenizer.h>
 #include <Bpp/Text/TextTools.h>
-#include <Bpp/Text/KeyvalTools.h>
 #include <Bpp/Numeric/VectorTools.h>
 
 //From the STL:
 #include <string>
+#include <cstring>
+#include <algorithm>
 #include <iostream>
 
 using namespace bpp;
@@ -66,13 +66,87 @@ const std::string GffFeatureReader::GFF_IS_CIRCULAR = "Is_circular";
 
 
 void GffFeatureReader::getNextLine_() {
-  nextLine_ = "";
-  while (TextTools::isEmpty(nextLine_) || nextLine_.size() < 2 || nextLine_[0] == '#') {
-    if (input_.eof()) {
-      nextLine_ = "";
-      return;
-    }
-    getline(input_, nextLine_);
+  hasNextLine_ = FeatureParsingTools::nextDataLine(*reader_, nextLine_);
+}
+
+void GffFeatureReader::splitCurrentLine_()
+{
+  if (FeatureParsingTools::splitColumns(nextLine_, columns_, 9) != 9)
+    throw Exception("GffFeatureReader::nextFeature(). Wrong GFF3 file format: should have 9 tab delimited columns.");
+}
+
+BasicSequenceFeature GffFeatureReader::parseCurrentLine_()
+{
+  //Columns are parsed in place, repeated strings are interned:
+  size_t start = static_cast<size_t>(columns_[3].toUnsignedInteger()) - 1;
+  size_t end   = static_cast<size_t>(columns_[4].toUnsignedInteger());
+  double score = FeatureParsingTools::toDouble(columns_[5]);
+  char strand  = columns_[6].empty() ? '.' : columns_[6][0];
+  BasicSequenceFeature feature("", seqIds_.intern(columns_[0]), sources_.intern(columns_[1]), types_.intern(columns_[2]), start, end, strand, score);
+  
+  //Set phase attributes:
+  if (!(columns_[7] == ".")) feature.setAttribute(GFF_PHASE, columns_[7].toString());
+
+  //Attributes are key=value pairs separated by semicolons:
+  const TextSpan& attrDesc = columns_[8];
+  size_t pos = 0;
+  while (pos < attrDesc.size) {
+    const char* sep = static_cast<const char*>(memchr(attrDesc.data + pos, ';', attrDesc.size - pos));
+    size_t stop = sep ? static_cast<size_t>(sep - attrDesc.data) : attrDesc.size;
+    TextSpan item = FeatureParsingTools::trim(attrDesc.substr(pos, stop - pos));
+    pos = stop + 1;
+    if (item.empty()) continue;
+    const char* eq = static_cast<const char*>(memchr(item.data, '=', item.size));
+    if (!eq)
+      throw Exception("GffFeatureReader::nextFeature(). Invalid attribute, should be key=value: " + item.toString());
+    size_t k = static_cast<size_t>(eq - item.data);
+    TextSpan key = FeatureParsingTools::trim(item.substr(0, k));
+    TextSpan value = FeatureParsingTools::trim(item.substr(k + 1));
+    if (key == "ID")
+      feature.setId(value.toString());
+    else
+      feature.setAttribute(getAttributeKeyId_(key), value.toString()); //We accept all attributes, even if they are not standard.
+  }
+  return feature;
+}
+
+const TabixIndex& GffFeatureReader::getIndex_()
+{
+  if (!reader_->isSeekable())
+    throw Exception("GffFeatureReader::getFeaturesInRange. Range queries need a BGZF-compressed file, opened from its name.");
+  if (!index_.get()) {
+    if (path_.empty())
+      throw Exception("GffFeatureReader::getFeaturesInRange. No index was set for this input.");
+    index_.reset(new TabixIndex(TabixIndex::findIndexFile(path_)));
+  }
+  return *index_;
+}
+
+void GffFeatureReader::getFeaturesInRange(const std::string& seqId, size_t start, size_t end, SequenceFeatureSet& features)
+{
+  vector<TabixIndex::Chunk> chunks;
+  getIndex_().getChunks(seqId, start, end, chunks);
+  uint64_t resume = reader_->getLineOffset();
+
+  FeatureParsingTools::readChunks(*reader_, chunks, [&](const TextSpan& line) {
+    if (FeatureParsingTools::splitColumns(line, columns_, 9) != 9)
+      throw Exception("GffFeatureReader::getFeaturesInRange(). Wrong GFF3 file format: should have 9 tab delimited columns.");
+    if (!(columns_[0] == seqId))
+      return true;
+    //Coordinates are 1-based, and lines are sorted by start position:
+    size_t fStart = static_cast<size_t>(columns_[3].toUnsignedInteger()) - 1;
+    if (fStart >= end)
+      return false;
+    size_t fEnd = static_cast<size_t>(columns_[4].toUnsignedInteger());
+    if (fEnd > start)
+      features.addFeature(unique_ptr<SequenceFeature>(new BasicSequenceFeature(parseCurrentLine_())));
+    return true;
+  });
+
+  //Go back to where sequential reading was:
+  if (hasNextLine_) {
+    reader_->seek(resume);
+    getNextLine_();
   }
 }
 
@@ -82,44 +156,47 @@ const BasicSequenceFeature GffFeatureReader::nextFeature()
     throw Exception("GffFeatureReader::nextFeature(). No more feature in file.");
   
   //Parse current line:
-  StringTokenizer st(nextLine_, "\t");
-  if (st.numberOfRemainingTokens() != 9)
-    throw Exception("GffFeatureReader::nextFeature(). Wrong GFF3 file format: should have 9 tab delimited columns.");
-  
-  //if ok, we can parse each column:
-  string seqId       = st.nextToken();
-  string source      = st.nextToken();
-  string type        = st.nextToken();
-  unsigned int start = TextTools::to<unsigned int>(st.nextToken()) - 1;
-  unsigned int end   = TextTools::to<unsigned int>(st.nextToken());
-  double score       = TextTools::to<double>(st.nextToken());
-  string strand      = st.nextToken();
-  string phase       = st.nextToken();
-  string attrDesc    = st.nextToken();
-  map<string, string> attributes;
-  KeyvalTools::multipleKeyvals(attrDesc, attributes, ";", false);
-  string id = attributes["ID"];
-  BasicSequenceFeature feature(id, seqId, source, type, start, end, strand[0], score);
-  
-  //Set phase attributes:
-  if (phase != ".") feature.setAttribute(GFF_PHASE, phase);
+  splitCurrentLine_();
+  BasicSequenceFeature feature = parseCurrentLine_();
 
-  //now check additional attributes:
-  for (map<string, string>::iterator it = attributes.begin(); it != attributes.end(); ++it) {
-    if (it->first != "ID")
-      feature.setAttribute(it->first, it->second); //We accept all attributes, even if they are not standard.
-  }
-  
   //Read the next line:
   getNextLine_();
 
   return feature;
 }
 
+void GffFeatureReader::getAllFeatures(SequenceFeatureSet& features)
+{
+  while (hasMoreFeature()) {
+    splitCurrentLine_();
+    features.addFeature(unique_ptr<SequenceFeature>(new BasicSequenceFeature(parseCurrentLine_())));
+    getNextLine_();
+  }
+}
+
+void GffFeatureReader::getFeaturesOfType(const std::string& type, SequenceFeatureSet& features)
+{
+  while (hasMoreFeature()) {
+    splitCurrentLine_();
+    if (columns_[2] == type)
+      features.addFeature(unique_ptr<SequenceFeature>(new BasicSequenceFeature(parseCurrentLine_())));
+    getNextLine_();
+  }
+}
+
+void GffFeatureReader::getFeaturesOfSequence(const std::string& seqId, SequenceFeatureSet& features)
+{
+  while (hasMoreFeature()) {
+    splitCurrentLine_();
+    if (columns_[0] == seqId)
+      features.addFeature(unique_ptr<SequenceFeature>(new BasicSequenceFeature(parseCurrentLine_())));
+    getNextLine_();
+  }
+}
+
 std::string GffFeatureReader::toString(const bpp::SequenceFeature& f) {
   std::vector< std::string > v;
   std::vector< std::string > attr;
-  std::set< std::string > attrNames = f.getAttributeList();
   v.push_back(f.getSequenceId());
   v.push_back(f.getSource());
   v.push_back(f.getType());
@@ -144,8 +221,17 @@ std::string GffFeatureReader::toString(const bpp::SequenceFeature& f) {
   if (f.getId() != "") {
     attr.push_back("ID=" + f.getId());
   }
-  for (std::set< std::string >::iterator it = attrNames.begin() ; it != attrNames.end() ; it++) {
-    attr.push_back(*it + "=" + f.getAttribute(*it));
+  const BasicSequenceFeature* bf = dynamic_cast<const BasicSequenceFeature*>(&f);
+  if (bf) {
+    //Attributes are stored sorted by name, there is no need to build a temporary set:
+    for (size_t i = 0; i < bf->getNumberOfAttributes(); ++i) {
+      attr.push_back(bf->getAttributeName(i) + "=" + bf->getAttributeValue(i));
+    }
+  } else {
+    std::set< std::string > attrNames = f.getAttributeList();
+    for (std::set< std::string >::iterator it = attrNames.begin() ; it != attrNames.end() ; it++) {
+      attr.push_back(*it + "=" + f.getAttribute(*it));
+    }
   }
   v.push_back(bpp::VectorTools::paste(attr, ";"));
   return bpp::VectorTools::paste(v, "\t");
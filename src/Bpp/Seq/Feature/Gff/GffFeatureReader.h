@@ -42,6 +42,9 @@ knowledge of the CeCILL license and that you accept its terms.
 
 #include "../SequenceFeature.h"
 #include "../FeatureReader.h"
+#include "../FeatureParsingTools.h"
+#include "../../Io/LineReader.h"
+#include "../../Io/CompressedInput.h"
 
 //From bpp-core:
 #include <Bpp/Exceptions.h>
@@ -49,6 +52,7 @@ knowledge of the CeCILL license and that you accept its terms.
 //From the STL:
 #include <string>
 #include <vector>
+#include <memory>
 
 namespace bpp {
 
@@ -81,39 +85,98 @@ class GffFeatureReader:
     static const std::string GFF_IS_CIRCULAR;
 
   private:
-    std::istream& input_;
-    std::string nextLine_;
+    std::string path_;
+    std::unique_ptr<LineReader> reader_;
+    std::unique_ptr<TabixIndex> index_;
+    TextSpan nextLine_;
+    bool hasNextLine_;
+    TextSpan columns_[9];
+    FeatureLabelInterner seqIds_;
+    FeatureLabelInterner sources_;
+    FeatureLabelInterner types_;
+    TextSpanInterner attributeKeys_;
+    std::vector<size_t> attributeKeyIds_; //Global identifiers of the attribute names in attributeKeys_.
 
   public:
     GffFeatureReader(std::istream& input):
-      input_(input), nextLine_()
+      path_(), reader_(new StreamLineReader(&input)), index_(), nextLine_(), hasNextLine_(false), columns_(),
+      seqIds_(), sources_(), types_(), attributeKeys_(), attributeKeyIds_()
+    {
+      getNextLine_();
+    }
+
+    /**
+     * @brief Read features from a file, which may be gzip or BGZF compressed.
+     *
+     * @param path The path of the file to read.
+     * @param nbThreads The number of threads used to decompress BGZF files (0 for one per core).
+     * @see CompressedLineReader
+     */
+    GffFeatureReader(const std::string& path, unsigned int nbThreads = 0):
+      path_(path), reader_(new CompressedLineReader(path, nbThreads)), index_(), nextLine_(), hasNextLine_(false), columns_(),
+      seqIds_(), sources_(), types_(), attributeKeys_(), attributeKeyIds_()
+    {
+      getNextLine_();
+    }
+
+    /**
+     * @brief Read features from a generic line reader.
+     *
+     * @param reader The line reader, which is owned by this object.
+     */
+    GffFeatureReader(LineReader* reader):
+      path_(), reader_(reader), index_(), nextLine_(), hasNextLine_(false), columns_(),
+      seqIds_(), sources_(), types_(), attributeKeys_(), attributeKeyIds_()
     {
       getNextLine_();
     }
 
   public:
-    bool hasMoreFeature() const { return nextLine_ != ""; }
+    bool hasMoreFeature() const { return hasNextLine_; }
     const BasicSequenceFeature nextFeature();
 
-    void getAllFeatures(SequenceFeatureSet& features) {
-      while (hasMoreFeature()) {
-        features.addFeature(nextFeature());
-      }
-    }
-    void getFeaturesOfType(const std::string& type, SequenceFeatureSet& features) {
-      while (hasMoreFeature()) {
-        BasicSequenceFeature feature = nextFeature();
-        if (feature.getType() == type)
-          features.addFeature(feature);
-      }
-    }
-    void getFeaturesOfSequence(const std::string& seqId, SequenceFeatureSet& features) {
-      while (hasMoreFeature()) {
-        BasicSequenceFeature feature = nextFeature();
-        if (feature.getSequenceId() == seqId)
-          features.addFeature(feature);
-      }
-    }
+    /**
+     * @brief Read all remaining features.
+     *
+     * Features are directly created in the set, without intermediate copy.
+     * SequenceFeatureSet::reserve can be called beforehand if the number of features is known.
+     */
+    void getAllFeatures(SequenceFeatureSet& features);
+
+    /**
+     * @brief Read all remaining features of a given type.
+     *
+     * Only the lines matching the type are fully parsed.
+     */
+    void getFeaturesOfType(const std::string& type, SequenceFeatureSet& features);
+
+    /**
+     * @brief Read all remaining features of a given sequence.
+     *
+     * Only the lines matching the sequence are fully parsed.
+     */
+    void getFeaturesOfSequence(const std::string& seqId, SequenceFeatureSet& features);
+
+    /**
+     * @brief Read the features overlapping a region, using a tabix index.
+     *
+     * The file must be BGZF-compressed, sorted by coordinates and indexed (see TabixIndex), and the
+     * reader must have been created from its file name. Only the chunks of the file that may contain
+     * the region are decompressed and parsed. Sequential reading is not affected.
+     *
+     * @param seqId The sequence id.
+     * @param start The beginning of the region (0-based, included).
+     * @param end The end of the region (0-based, excluded).
+     * @param features [out] The set where features are added.
+     */
+    void getFeaturesInRange(const std::string& seqId, size_t start, size_t end, SequenceFeatureSet& features);
+
+    /**
+     * @brief Use a given index file for range queries.
+     *
+     * By default, the index is the data file name with extension .tbi or .csi.
+     */
+    void setIndex(const std::string& indexPath) { index_.reset(new TabixIndex(indexPath)); }
 
     /**
      * @param f A sequence feature.
@@ -142,6 +205,28 @@ class GffFeatureReader:
   private:
     void getNextLine_();
 
+    const TabixIndex& getIndex_();
+
+    /**
+     * @brief Split the current line into columns_, checking their number.
+     */
+    void splitCurrentLine_();
+
+    /**
+     * @brief Build a feature from the columns of the current line.
+     */
+    BasicSequenceFeature parseCurrentLine_();
+
+    /**
+     * @return The global identifier of an attribute name.
+     */
+    size_t getAttributeKeyId_(const TextSpan& key) {
+      size_t id = attributeKeys_.getId(key);
+      if (id == attributeKeyIds_.size())
+        attributeKeyIds_.push_back(SequenceFeature::internAttributeKey(attributeKeys_.getValue(id)));
+      return attributeKeyIds_[id];
+    }
+
 };
 
 } //end of namespace bpp
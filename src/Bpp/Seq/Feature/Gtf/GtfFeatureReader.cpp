@@ -39,13 +39,9 @@ knowledge of the CeCILL license and that you accept its terms.
 
 #include "GtfFeatureReader.h"
 
-//From bpp-core:
-#include <Bpp/Text/StringTokenizer.h>
-#include <Bpp/Text/TextTools.h>
-#include <Bpp/Text/KeyvalTools.h>
-
 //From the STL:
 #include <string>
+#include <cstring>
 #include <iostream>
 
 using namespace bpp;
@@ -56,17 +52,88 @@ const string GtfFeatureReader::GTF_GENE_ID = "gene_id";
 const string GtfFeatureReader::GTF_TRANSCRIPT_ID = "transcript_id";
 
 void GtfFeatureReader::getNextLine_() {
-  nextLine_ = "";
-  // Remove comments
-  /*
-    todo: remove characters between # and end-of-line taking care of double quotes
-  */
-  while (TextTools::isEmpty(nextLine_) || nextLine_.size() < 2 || nextLine_[0] == '#') {
-    if (input_.eof()) {
-      nextLine_ = "";
-      return;
-    }
-    getline(input_, nextLine_);
+  hasNextLine_ = FeatureParsingTools::nextDataLine(*reader_, nextLine_);
+}
+
+void GtfFeatureReader::splitCurrentLine_()
+{
+  if (FeatureParsingTools::splitColumns(nextLine_, columns_, 9) != 9)
+    throw Exception("GtfFeatureReader::nextFeature(). Wrong GTF file format: should have 9 tab delimited columns.");
+}
+
+BasicSequenceFeature GtfFeatureReader::parseCurrentLine_()
+{
+  //Columns are parsed in place, repeated strings are interned:
+  size_t start = static_cast<size_t>(columns_[3].toUnsignedInteger()) - 1;
+  size_t end   = static_cast<size_t>(columns_[4].toUnsignedInteger());
+  double score = FeatureParsingTools::toDouble(columns_[5]);
+  char strand  = columns_[6].empty() ? '.' : columns_[6][0];
+  BasicSequenceFeature feature("", seqIds_.intern(columns_[0]), sources_.intern(columns_[1]), types_.intern(columns_[2]), start, end, strand, score);
+  
+  //Set phase attributes:
+  TextSpan phase = FeatureParsingTools::trim(columns_[7]);
+  if (!(phase == ".")) feature.setAttribute(GTF_PHASE, phase.toString());
+
+  //Attributes are 'key "value"' pairs separated by semicolons:
+  const TextSpan& attrDesc = columns_[8];
+  size_t pos = 0;
+  while (pos < attrDesc.size) {
+    const char* sep = static_cast<const char*>(memchr(attrDesc.data + pos, ';', attrDesc.size - pos));
+    size_t stop = sep ? static_cast<size_t>(sep - attrDesc.data) : attrDesc.size;
+    TextSpan item = FeatureParsingTools::trim(attrDesc.substr(pos, stop - pos));
+    pos = stop + 1;
+    if (item.empty()) continue;
+    const char* space = static_cast<const char*>(memchr(item.data, ' ', item.size));
+    size_t k = space ? static_cast<size_t>(space - item.data) : item.size;
+    TextSpan key = item.substr(0, k);
+    TextSpan value = item.substr(k);
+    // remove surrounding quotes
+    while (value.size > 0 && (value[0] == '"' || TextSpan::isSpace(value[0])))
+      value = value.substr(1);
+    while (value.size > 0 && (value[value.size - 1] == '"' || TextSpan::isSpace(value[value.size - 1])))
+      value.size--;
+    feature.setAttribute(getAttributeKeyId_(key), value.toString()); //We accept all attributes, even if they are not standard.
+  }
+  return feature;
+}
+
+const TabixIndex& GtfFeatureReader::getIndex_()
+{
+  if (!reader_->isSeekable())
+    throw Exception("GtfFeatureReader::getFeaturesInRange. Range queries need a BGZF-compressed file, opened from its name.");
+  if (!index_.get()) {
+    if (path_.empty())
+      throw Exception("GtfFeatureReader::getFeaturesInRange. No index was set for this input.");
+    index_.reset(new TabixIndex(TabixIndex::findIndexFile(path_)));
+  }
+  return *index_;
+}
+
+void GtfFeatureReader::getFeaturesInRange(const std::string& seqId, size_t start, size_t end, SequenceFeatureSet& features)
+{
+  vector<TabixIndex::Chunk> chunks;
+  getIndex_().getChunks(seqId, start, end, chunks);
+  uint64_t resume = reader_->getLineOffset();
+
+  FeatureParsingTools::readChunks(*reader_, chunks, [&](const TextSpan& line) {
+    if (FeatureParsingTools::splitColumns(line, columns_, 9) != 9)
+      throw Exception("GtfFeatureReader::getFeaturesInRange(). Wrong GTF file format: should have 9 tab delimited columns.");
+    if (!(columns_[0] == seqId))
+      return true;
+    //Coordinates are 1-based, and lines are sorted by start position:
+    size_t fStart = static_cast<size_t>(columns_[3].toUnsignedInteger()) - 1;
+    if (fStart >= end)
+      return false;
+    size_t fEnd = static_cast<size_t>(columns_[4].toUnsignedInteger());
+    if (fEnd > start)
+      features.addFeature(unique_ptr<SequenceFeature>(new BasicSequenceFeature(parseCurrentLine_())));
+    return true;
+  });
+
+  //Go back to where sequential reading was:
+  if (hasNextLine_) {
+    reader_->seek(resume);
+    getNextLine_();
   }
 }
 
@@ -76,71 +143,41 @@ const BasicSequenceFeature GtfFeatureReader::nextFeature()
     throw Exception("GtfFeatureReader::nextFeature(). No more feature in file.");
   
   //Parse current line:
-  StringTokenizer st(nextLine_, "\t");
-  if (st.numberOfRemainingTokens() != 9)
-    throw Exception("GtfFeatureReader::nextFeature(). Wrong GTF file format: should have 9 tab delimited columns.");
-  
-  //if ok, we can parse each column:
-  string seqId       = st.nextToken();
-  string source      = st.nextToken();
-  string type        = st.nextToken();
-  unsigned int start = TextTools::to<unsigned int>(st.nextToken()) - 1;
-  unsigned int end   = TextTools::to<unsigned int>(st.nextToken());
-  double score       = TextTools::to<double>(st.nextToken());
-  string strand      = st.nextToken();
-  string phase       = st.nextToken();
-  string attrDesc    = st.nextToken();
-  map<string, string> attributes;
-  StringTokenizer st1(attrDesc, ";");
-  while (st1.hasMoreToken()) {
-    string item(st1.nextToken());
-    if (TextTools::isEmpty(item)) continue;
-    item = TextTools::removeSurroundingWhiteSpaces(item);
-    string::size_type idx = item.find_first_of(' ');
-    string key(item.substr(0, idx));
-    string value(item.substr(idx));
-    // remove first "
-    while (
-        value.size() > 0 
-        && (
-          value[0] == '"' 
-          || TextTools::isWhiteSpaceCharacter(value[0])
-          )
-        ) {
-      value.erase(value.begin());
-    }
-    // remove last "
-    while (
-        value.size() > 0 
-        && (
-          value[value.size() - 1] == '"' 
-          || TextTools::isWhiteSpaceCharacter(value[value.size() - 1])
-          )
-        ) {
-      value.erase(value.end() - 1);
-    }
-    attributes[key] = value;
-    //std::cout << "[" << key << "] = [" << value << "]" << std::endl;
-  }
-  //KeyvalTools::multipleKeyvals(attrDesc, attributes, ";", false);
-  //std::string id = attributes["ID"];
-  string id = "";
-  BasicSequenceFeature feature(id, seqId, source, type, start, end, strand[0], score);
-  
-  //Set phase attributes:
-  phase = TextTools::removeSurroundingWhiteSpaces(phase);
-  if (phase != ".") feature.setAttribute(GTF_PHASE, phase);
-
-  //now check additional attributes:
-  for (map<std::string, std::string>::iterator it = attributes.begin(); it != attributes.end(); ++it) {
-    feature.setAttribute(it->first, it->second); //We accept all attributes, even if they are not standard.
-    //std::cout << "[" << it->first << "] = [" << it->second << "]" << std::endl;
-    //std::cout << "phase: " << phase << std::endl;
-  }
-  
+  splitCurrentLine_();
+  BasicSequenceFeature feature = parseCurrentLine_();
+
   //Read the next line:
   getNextLine_();
 
   return feature;
 }
 
+void GtfFeatureReader::getAllFeatures(SequenceFeatureSet& features)
+{
+  while (hasMoreFeature()) {
+    splitCurrentLine_();
+    features.addFeature(unique_ptr<SequenceFeature>(new BasicSequenceFeature(parseCurrentLine_())));
+    getNextLine_();
+  }
+}
+
+void GtfFeatureReader::getFeaturesOfType(const std::string& type, SequenceFeatureSet& features)
+{
+  while (hasMoreFeature()) {
+    splitCurrentLine_();
+    if (columns_[2] == type)
+      features.addFeature(unique_ptr<SequenceFeature>(new BasicSequenceFeature(parseCurrentLine_())));
+    getNextLine_();
+  }
+}
+
+void GtfFeatureReader::getFeaturesOfSequence(const std::string& seqId, SequenceFeatureSet& features)
+{
+  while (hasMoreFeature()) {
+    splitCurrentLine_();
+    if (columns_[0] == seqId)
+      features.addFeature(unique_ptr<SequenceFeature>(new BasicSequenceFeature(parseCurrentLine_())));
+    getNextLine_();
+  }
+}
+
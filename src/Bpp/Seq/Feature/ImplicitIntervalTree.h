@@ -0,0 +1,166 @@
+//
+// File: ImplicitIntervalTree.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _IMPLICITINTERVALTREE_H_
+#define _IMPLICITINTERVALTREE_H_
+
+//From the STL:
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+namespace bpp {
+
+/**
+ * @brief Algorithms on implicit augmented interval trees.
+ *
+ * Intervals [start, end[ are stored in arrays sorted by start position, which form
+ * an implicit binary tree: node i is at level k if its k lowest bits are set, and
+ * maxEnds[i] is the maximum end position in the subtree rooted at i (see cgranges).
+ * The arrays can be held in memory or mapped from a file, which is why they are
+ * passed as plain pointers, with the element type as a template parameter.
+ */
+class ImplicitIntervalTree
+{
+  public:
+    /**
+     * @brief Compute the maxEnds array.
+     *
+     * @param ends The end positions of the intervals, sorted by start position.
+     * @param maxEnds [out] An array of size n, filled by this function.
+     * @param n The number of intervals.
+     * @return The level of the root node (-1 if the tree is empty).
+     */
+    template<class T>
+    static int build(const T* ends, T* maxEnds, size_t n)
+    {
+      if (n == 0) return -1;
+      //Leaves are at even positions:
+      size_t lastI = 0;
+      T last = 0;
+      for (size_t i = 0; i < n; i += 2) {
+        lastI = i;
+        last = maxEnds[i] = ends[i];
+      }
+      //Internal nodes, level by level. Missing right children are replaced by the last node of the level:
+      int k;
+      for (k = 1; (static_cast<size_t>(1) << k) <= n; ++k) {
+        size_t x = static_cast<size_t>(1) << (k - 1);
+        size_t i0 = (x << 1) - 1;
+        size_t step = x << 2;
+        for (size_t i = i0; i < n; i += step) {
+          T el = maxEnds[i - x];
+          T er = i + x < n ? maxEnds[i + x] : last;
+          maxEnds[i] = std::max(ends[i], std::max(el, er));
+        }
+        lastI = ((lastI >> k) & 1) ? lastI - x : lastI + x;
+        if (lastI < n && maxEnds[lastI] > last)
+          last = maxEnds[lastI];
+      }
+      return k - 1;
+    }
+
+    /**
+     * @brief Find all intervals overlapping [begin, end[.
+     *
+     * @param ids The identifiers of the intervals, appended to the output.
+     * @param indices [out] The identifiers of the intervals found, in no particular order.
+     */
+    template<class T>
+    static void findOverlaps(const T* starts, const T* ends, const T* maxEnds, const T* ids, size_t n, int maxLevel,
+        size_t begin, size_t end, std::vector<size_t>& indices)
+    {
+      if (maxLevel < 0) return;
+      struct Node { size_t x; int k; bool leftDone; };
+      Node stack[64];
+      int t = 0;
+      stack[t].x = (static_cast<size_t>(1) << maxLevel) - 1;
+      stack[t].k = maxLevel;
+      stack[t++].leftDone = false;
+      while (t > 0) {
+        Node z = stack[--t];
+        if (z.k <= 3) {
+          //Small subtree, scan it linearly:
+          size_t i0 = (z.x >> z.k) << z.k;
+          size_t i1 = std::min(i0 + (static_cast<size_t>(1) << (z.k + 1)) - 1, n);
+          for (size_t i = i0; i < i1 && starts[i] < end; ++i)
+            if (ends[i] > begin)
+              indices.push_back(static_cast<size_t>(ids[i]));
+        } else if (!z.leftDone) {
+          size_t y = z.x - (static_cast<size_t>(1) << (z.k - 1));
+          stack[t].x = z.x;
+          stack[t].k = z.k;
+          stack[t++].leftDone = true;
+          //The left child may not exist, or may not overlap the query:
+          if (y >= n || maxEnds[y] > begin) {
+            stack[t].x = y;
+            stack[t].k = z.k - 1;
+            stack[t++].leftDone = false;
+          }
+        } else if (z.x < n && starts[z.x] < end) {
+          if (ends[z.x] > begin)
+            indices.push_back(static_cast<size_t>(ids[z.x]));
+          stack[t].x = z.x + (static_cast<size_t>(1) << (z.k - 1));
+          stack[t].k = z.k - 1;
+          stack[t++].leftDone = false;
+        }
+      }
+    }
+
+    /**
+     * @brief Find all intervals included in [begin, end].
+     *
+     * @param ids The identifiers of the intervals, appended to the output.
+     * @param indices [out] The identifiers of the intervals found, in start order.
+     */
+    template<class T>
+    static void findIncluded(const T* starts, const T* ends, const T* ids, size_t n,
+        size_t begin, size_t end, std::vector<size_t>& indices)
+    {
+      //Included intervals start within the range:
+      size_t i = static_cast<size_t>(std::lower_bound(starts, starts + n, static_cast<T>(begin)) - starts);
+      for (; i < n && starts[i] <= end; ++i)
+        if (ends[i] <= end)
+          indices.push_back(static_cast<size_t>(ids[i]));
+    }
+};
+
+} //end of namespace bpp
+
+#endif //_IMPLICITINTERVALTREE_H_
@@ -0,0 +1,224 @@
+//
+// File: ParallelFeatureLoader.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "ParallelFeatureLoader.h"
+#include "Gff/GffFeatureReader.h"
+#include "Gtf/GtfFeatureReader.h"
+#include "Bed/BedGraphFeatureReader.h"
+#include "../Io/CompressedInput.h"
+
+//From bpp-core:
+#include <Bpp/Text/TextTools.h>
+
+//From the STL:
+#include <algorithm>
+
+using namespace bpp;
+using namespace std;
+
+ParallelFeatureLoader::ParallelFeatureLoader(ReaderFactory factory, unsigned int nbThreads, size_t chunkSize):
+  factory_(factory), finalizer_(), nbThreads_(nbThreads), chunkSize_(chunkSize),
+  workers_(), pending_(), inFlight_(), stop_(false), mutex_(), workAvailable_(), jobDone_()
+{
+  if (!factory)
+    throw Exception("ParallelFeatureLoader (constructor). A reader factory must be provided.");
+  if (nbThreads_ == 0)
+    nbThreads_ = max(thread::hardware_concurrency(), 1u);
+  if (chunkSize_ == 0)
+    throw Exception("ParallelFeatureLoader (constructor). Chunk size must be positive.");
+}
+
+void ParallelFeatureLoader::load(const std::string& path, SequenceFeatureSet& features)
+{
+  CompressedInputStream input(path);
+  load(input, features);
+}
+
+void ParallelFeatureLoader::load(std::istream& input, SequenceFeatureSet& features)
+{
+  for (unsigned int i = 0; i < nbThreads_; ++i)
+    workers_.push_back(thread(&ParallelFeatureLoader::workerLoop_, this));
+  size_t maxInFlight = 4 * nbThreads_;
+  size_t count = 0;
+  try {
+    vector<char> remainder;
+    bool first = true;
+    bool eof = false;
+    while (!eof) {
+      shared_ptr<Job_> job(new Job_());
+      job->first = first;
+      job->text.swap(remainder);
+      size_t n = job->text.size();
+      job->text.resize(n + chunkSize_);
+      input.read(&job->text[n], static_cast<streamsize>(chunkSize_));
+      size_t nbRead = static_cast<size_t>(input.gcount());
+      job->text.resize(n + nbRead);
+      eof = (nbRead < chunkSize_);
+      if (!eof) {
+        //Cut after the last complete line, the rest goes with the next chunk:
+        vector<char>::reverse_iterator it = find(job->text.rbegin(), job->text.rend(), '\n');
+        if (it == job->text.rend()) {
+          //No complete line yet:
+          remainder.swap(job->text);
+          continue;
+        }
+        remainder.assign(it.base(), job->text.end());
+        job->text.erase(it.base(), job->text.end());
+      }
+      first = false;
+      //An empty input is still given to a reader, which may expect a header:
+      if (job->text.empty() && !job->first)
+        continue;
+      while (inFlight_.size() >= maxInFlight)
+        mergeFront_(features, count);
+      {
+        lock_guard<mutex> lock(mutex_);
+        inFlight_.push_back(job);
+        pending_.push_back(job);
+      }
+      workAvailable_.notify_one();
+    }
+    while (!inFlight_.empty())
+      mergeFront_(features, count);
+  } catch (...) {
+    stopWorkers_();
+    throw;
+  }
+  stopWorkers_();
+}
+
+void ParallelFeatureLoader::mergeFront_(SequenceFeatureSet& features, size_t& count)
+{
+  shared_ptr<Job_> job;
+  {
+    unique_lock<mutex> lock(mutex_);
+    while (!inFlight_.front()->done)
+      jobDone_.wait(lock);
+    job = inFlight_.front();
+    inFlight_.pop_front();
+  }
+  if (job->error)
+    rethrow_exception(job->error);
+  if (finalizer_) {
+    for (size_t i = 0; i < job->features.getNumberOfFeatures(); ++i)
+      finalizer_(job->features.getFeature(i), count + i);
+  }
+  count += job->features.getNumberOfFeatures();
+  features.transferFeatures(job->features);
+}
+
+void ParallelFeatureLoader::workerLoop_()
+{
+  while (true) {
+    shared_ptr<Job_> job;
+    {
+      unique_lock<mutex> lock(mutex_);
+      while (!stop_ && pending_.empty())
+        workAvailable_.wait(lock);
+      if (stop_)
+        return;
+      job = pending_.front();
+      pending_.pop_front();
+    }
+    try {
+      unique_ptr<FeatureReader> reader;
+      {
+        //Factories are not required to be thread-safe:
+        lock_guard<mutex> lock(mutex_);
+        reader.reset(factory_(new MemoryLineReader(job->text.data(), job->text.size()), job->first));
+      }
+      reader->getAllFeatures(job->features);
+      reader.reset();
+      vector<char>().swap(job->text); //Free text as soon as possible.
+    } catch (...) {
+      job->error = current_exception();
+    }
+    {
+      lock_guard<mutex> lock(mutex_);
+      job->done = true;
+    }
+    jobDone_.notify_all();
+  }
+}
+
+void ParallelFeatureLoader::stopWorkers_()
+{
+  {
+    lock_guard<mutex> lock(mutex_);
+    stop_ = true;
+  }
+  workAvailable_.notify_all();
+  for (size_t i = 0; i < workers_.size(); ++i)
+    workers_[i].join();
+  workers_.clear();
+  pending_.clear();
+  inFlight_.clear();
+  stop_ = false;
+}
+
+/******************************************************************************/
+
+void ParallelFeatureLoader::loadGff(const std::string& path, SequenceFeatureSet& features, unsigned int nbThreads)
+{
+  ParallelFeatureLoader loader([](LineReader* reader, bool) -> FeatureReader* {
+      return new GffFeatureReader(reader);
+    }, nbThreads);
+  loader.load(path, features);
+}
+
+void ParallelFeatureLoader::loadGtf(const std::string& path, SequenceFeatureSet& features, unsigned int nbThreads)
+{
+  ParallelFeatureLoader loader([](LineReader* reader, bool) -> FeatureReader* {
+      return new GtfFeatureReader(reader);
+    }, nbThreads);
+  loader.load(path, features);
+}
+
+void ParallelFeatureLoader::loadBedGraph(const std::string& path, SequenceFeatureSet& features, unsigned int nbThreads)
+{
+  ParallelFeatureLoader loader([](LineReader* reader, bool first) -> FeatureReader* {
+      return new BedGraphFeatureReader(reader, first);
+    }, nbThreads);
+  //Features are numbered along the whole file, as with a single reader:
+  loader.setFinalizer([](SequenceFeature& feature, size_t i) {
+      feature.setId("bed" + TextTools::toString(i + 1));
+    });
+  loader.load(path, features);
+}
+
@@ -0,0 +1,174 @@
+//
+// File: ParallelFeatureLoader.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _PARALLELFEATURELOADER_H_
+#define _PARALLELFEATURELOADER_H_
+
+#include "SequenceFeature.h"
+#include "FeatureReader.h"
+#include "../Io/LineReader.h"
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <iostream>
+
+namespace bpp {
+
+/**
+ * @brief Load a feature file using several threads.
+ *
+ * The input is read by large chunks, cut at line boundaries. Each chunk is parsed by a new reader
+ * instance on a pool of worker threads, and the resulting features are appended to the output set
+ * in file order, without being copied. The result is therefore identical to the one of a single
+ * reader, and the number of chunks read ahead is bounded, so that the whole input is never held in memory.
+ *
+ * Formats with a header, or where features are numbered by their line, need a little help:
+ * the reader factory is told whether the chunk is the first one of the input, and a finalizer
+ * can be called on each feature, in file order, with its index in the input.
+ *
+ * @author Julien Dutheil
+ */
+class ParallelFeatureLoader
+{
+  public:
+    /**
+     * @brief Build a reader on a chunk of input.
+     *
+     * The first argument is the line reader on the chunk, to be owned by the feature reader.
+     * The second one tells if the chunk is the beginning of the input.
+     */
+    typedef std::function<FeatureReader* (LineReader*, bool)> ReaderFactory;
+
+    /**
+     * @brief A function called on each loaded feature, with its index in the input.
+     */
+    typedef std::function<void (SequenceFeature&, size_t)> FeatureFinalizer;
+
+  private:
+    struct Job_
+    {
+      std::vector<char> text;
+      bool first;
+      SequenceFeatureSet features;
+      bool done;
+      std::exception_ptr error;
+      Job_(): text(), first(false), features(), done(false), error() {}
+    };
+
+  private:
+    ReaderFactory factory_;
+    FeatureFinalizer finalizer_;
+    unsigned int nbThreads_;
+    size_t chunkSize_;
+    std::vector<std::thread> workers_;
+    std::deque< std::shared_ptr<Job_> > pending_;
+    std::deque< std::shared_ptr<Job_> > inFlight_;
+    bool stop_;
+    std::mutex mutex_;
+    std::condition_variable workAvailable_;
+    std::condition_variable jobDone_;
+
+  public:
+    /**
+     * @param factory A function building a reader on one chunk of input.
+     * @param nbThreads The number of parsing threads (0 means one per available core).
+     * @param chunkSize The approximate size of chunks, in bytes.
+     */
+    ParallelFeatureLoader(ReaderFactory factory, unsigned int nbThreads = 0, size_t chunkSize = 8388608);
+
+    virtual ~ParallelFeatureLoader() {}
+
+  private:
+    //Recopy is forbidden!
+    ParallelFeatureLoader(const ParallelFeatureLoader& loader);
+    ParallelFeatureLoader& operator=(const ParallelFeatureLoader& loader);
+
+  public:
+    void setFinalizer(FeatureFinalizer finalizer) { finalizer_ = finalizer; }
+
+    unsigned int getNumberOfThreads() const { return nbThreads_; }
+
+    /**
+     * @brief Load all features from a file, which may be gzip or BGZF compressed.
+     *
+     * @param path The file to read.
+     * @param features [out] The set where features are appended.
+     */
+    void load(const std::string& path, SequenceFeatureSet& features);
+
+    /**
+     * @brief Load all features from a stream.
+     *
+     * @param input The stream to read.
+     * @param features [out] The set where features are appended.
+     */
+    void load(std::istream& input, SequenceFeatureSet& features);
+
+    /**
+     * @name Loaders for the supported formats.
+     *
+     * @{
+     */
+    static void loadGff(const std::string& path, SequenceFeatureSet& features, unsigned int nbThreads = 0);
+    static void loadGtf(const std::string& path, SequenceFeatureSet& features, unsigned int nbThreads = 0);
+    static void loadBedGraph(const std::string& path, SequenceFeatureSet& features, unsigned int nbThreads = 0);
+    /** @} */
+
+  private:
+    void workerLoop_();
+
+    /**
+     * @brief Wait for the oldest job, and append its features to the output.
+     */
+    void mergeFront_(SequenceFeatureSet& features, size_t& count);
+
+    void stopWorkers_();
+};
+
+} //end of namespace bpp
+
+#endif //_PARALLELFEATURELOADER_H_
@@ -38,8 +38,260 @@ knowledge of the CeCILL license and that you accept its terms.
 */
 
 #include "SequenceFeature.h"
+#include "ImplicitIntervalTree.h"
+
+//From bpp-core:
+#include <Bpp/Exceptions.h>
 
 using namespace bpp;
 
 const std::string SequenceFeature::NO_ATTRIBUTE_SET = "";
 
+//From the STL:
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+
+using namespace std;
+
+namespace {
+
+/**
+ * Attribute names are stored in a deque, so that references remain valid when new names are added.
+ * The table is created upon first use, to avoid static initialization order issues.
+ */
+struct AttributeKeyTable_
+{
+  deque<string> keys;
+  unordered_map<string, size_t> ids;
+  mutex lock;
+  AttributeKeyTable_(): keys(), ids(), lock() {}
+};
+
+AttributeKeyTable_& getAttributeKeyTable_()
+{
+  static AttributeKeyTable_ table;
+  return table;
+}
+
+/**
+ * Labels are stored in an unordered_set, whose elements are not moved when it grows.
+ */
+struct LabelTable_
+{
+  unordered_set<string> labels;
+  mutex lock;
+  LabelTable_(): labels(), lock() {}
+};
+
+LabelTable_& getLabelTable_()
+{
+  static LabelTable_ table;
+  return table;
+}
+
+struct StartOrder_
+{
+  const vector<SequenceFeature*>* features;
+  bool operator()(size_t i, size_t j) const {
+    const SequenceFeature& fi = *(*features)[i];
+    const SequenceFeature& fj = *(*features)[j];
+    if (fi.getStart() != fj.getStart()) return fi.getStart() < fj.getStart();
+    if (fi.getEnd() != fj.getEnd()) return fi.getEnd() < fj.getEnd();
+    return i < j;
+  }
+};
+
+}
+
+namespace {
+
+/**
+ * Names already seen by a thread, so that most lookups do not lock the shared table.
+ */
+struct AttributeKeyCache_
+{
+  unordered_map<string, size_t> ids;
+  vector<const string*> keys;
+  AttributeKeyCache_(): ids(), keys() {}
+
+  //Must be called with the table locked:
+  void update(const AttributeKeyTable_& table) {
+    for (size_t i = keys.size(); i < table.keys.size(); ++i)
+      keys.push_back(&table.keys[i]);
+  }
+};
+
+AttributeKeyCache_& getAttributeKeyCache_()
+{
+  thread_local AttributeKeyCache_ cache;
+  return cache;
+}
+
+}
+
+size_t SequenceFeature::internAttributeKey(const std::string& key)
+{
+  AttributeKeyCache_& cache = getAttributeKeyCache_();
+  unordered_map<string, size_t>::const_iterator cached = cache.ids.find(key);
+  if (cached != cache.ids.end())
+    return cached->second;
+  AttributeKeyTable_& table = getAttributeKeyTable_();
+  size_t id;
+  {
+    lock_guard<mutex> guard(table.lock);
+    unordered_map<string, size_t>::iterator it = table.ids.find(key);
+    if (it != table.ids.end()) {
+      id = it->second;
+    } else {
+      id = table.keys.size();
+      table.keys.push_back(key);
+      table.ids[key] = id;
+    }
+    cache.update(table);
+  }
+  cache.ids[key] = id;
+  return id;
+}
+
+bool SequenceFeature::findAttributeKey(const std::string& key, size_t& id)
+{
+  AttributeKeyCache_& cache = getAttributeKeyCache_();
+  unordered_map<string, size_t>::const_iterator cached = cache.ids.find(key);
+  if (cached != cache.ids.end()) {
+    id = cached->second;
+    return true;
+  }
+  AttributeKeyTable_& table = getAttributeKeyTable_();
+  {
+    lock_guard<mutex> guard(table.lock);
+    unordered_map<string, size_t>::iterator it = table.ids.find(key);
+    if (it == table.ids.end())
+      return false;
+    id = it->second;
+    cache.update(table);
+  }
+  cache.ids[key] = id;
+  return true;
+}
+
+const std::string& SequenceFeature::getAttributeKey(size_t id)
+{
+  AttributeKeyCache_& cache = getAttributeKeyCache_();
+  if (id < cache.keys.size())
+    return *cache.keys[id];
+  AttributeKeyTable_& table = getAttributeKeyTable_();
+  lock_guard<mutex> guard(table.lock);
+  if (id >= table.keys.size())
+    throw Exception("SequenceFeature::getAttributeKey. Unknown attribute identifier.");
+  cache.update(table);
+  return *cache.keys[id];
+}
+
+const std::string* SequenceFeature::internLabel(const std::string& label)
+{
+  //Each thread first looks in its own cache, so that the shared table is only locked once per label and thread:
+  thread_local unordered_map<string, const string*> cache;
+  unordered_map<string, const string*>::const_iterator cached = cache.find(label);
+  if (cached != cache.end())
+    return cached->second;
+  LabelTable_& table = getLabelTable_();
+  const string* interned;
+  {
+    lock_guard<mutex> guard(table.lock);
+    interned = &*table.labels.insert(label).first;
+  }
+  cache[label] = interned;
+  return interned;
+}
+
+void SequenceFeatureSet::IntervalTree_::build(const std::vector<SequenceFeature*>& all)
+{
+  features = inOrder;
+  StartOrder_ order;
+  order.features = &all;
+  sort(features.begin(), features.end(), order);
+  size_t n = features.size();
+  starts.resize(n);
+  ends.resize(n);
+  maxEnds.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    starts[i] = all[features[i]]->getStart();
+    ends[i]   = all[features[i]]->getEnd();
+  }
+  maxLevel = ImplicitIntervalTree::build(ends.data(), maxEnds.data(), n);
+}
+
+void SequenceFeatureSet::IntervalTree_::findOverlaps(size_t begin, size_t end, std::vector<size_t>& indices) const
+{
+  ImplicitIntervalTree::findOverlaps(starts.data(), ends.data(), maxEnds.data(), features.data(), starts.size(), maxLevel, begin, end, indices);
+}
+
+void SequenceFeatureSet::IntervalTree_::findIncluded(size_t begin, size_t end, std::vector<size_t>& indices) const
+{
+  ImplicitIntervalTree::findIncluded(starts.data(), ends.data(), features.data(), starts.size(), begin, end, indices);
+}
+
+void SequenceFeatureSet::buildIndex()
+{
+  sequenceIndex_.clear();
+  typeIndex_.clear();
+  for (size_t i = 0; i < features_.size(); ++i) {
+    sequenceIndex_[features_[i]->getSequenceId()].inOrder.push_back(i);
+    typeIndex_[features_[i]->getType()].push_back(i);
+  }
+  for (map<string, IntervalTree_>::iterator it = sequenceIndex_.begin(); it != sequenceIndex_.end(); ++it)
+    it->second.build(features_);
+  indexed_ = true;
+}
+
+void SequenceFeatureSet::getIndicesForRange(const std::string& seqId, const Range<size_t>& range, bool complete, std::vector<size_t>& indices) const
+{
+  if (indexed_) {
+    map<string, IntervalTree_>::const_iterator it = sequenceIndex_.find(seqId);
+    if (it == sequenceIndex_.end()) return;
+    size_t first = indices.size();
+    if (complete)
+      it->second.findIncluded(range.begin(), range.end(), indices);
+    else
+      it->second.findOverlaps(range.begin(), range.end(), indices);
+    sort(indices.begin() + static_cast<ptrdiff_t>(first), indices.end());
+    return;
+  }
+  SeqRange r(range);
+  for (size_t i = 0; i < features_.size(); ++i) {
+    const SequenceFeature& f = *features_[i];
+    if (f.getSequenceId() == seqId && (complete ? f.isIncludedIn(r) : f.overlap(r)))
+      indices.push_back(i);
+  }
+}
+
+void SequenceFeatureSet::getIndicesForSequence(const std::string& seqId, std::vector<size_t>& indices) const
+{
+  if (indexed_) {
+    map<string, IntervalTree_>::const_iterator it = sequenceIndex_.find(seqId);
+    if (it != sequenceIndex_.end())
+      indices.insert(indices.end(), it->second.inOrder.begin(), it->second.inOrder.end());
+    return;
+  }
+  for (size_t i = 0; i < features_.size(); ++i)
+    if (features_[i]->getSequenceId() == seqId)
+      indices.push_back(i);
+}
+
+void SequenceFeatureSet::getIndicesForType(const std::string& type, std::vector<size_t>& indices) const
+{
+  if (indexed_) {
+    map<string, vector<size_t> >::const_iterator it = typeIndex_.find(type);
+    if (it != typeIndex_.end())
+      indices.insert(indices.end(), it->second.begin(), it->second.end());
+    return;
+  }
+  for (size_t i = 0; i < features_.size(); ++i)
+    if (features_[i]->getType() == type)
+      indices.push_back(i);
+}
@@ -44,7 +44,10 @@ knowledge of the CeCILL license and that you accept its terms.
 #include <string>
 #include <map>
 #include <set>
+#include <vector>
+#include <memory>
 #include <algorithm>
+#include <cstddef>
 
 //From bpp-core:
 #include <Bpp/Clonable.h>
@@ -142,6 +145,44 @@ class SequenceFeature:
   public:
     virtual SequenceFeature* clone() const = 0;
 
+  public:
+    /**
+     * @name Global tables of attribute names and labels.
+     *
+     * Attribute names are shared by all features, and identified by an integer.
+     * These functions are thread-safe, and references to names remain valid during the whole program.
+     * Each thread caches the names and labels it has already seen, so that the shared tables are only
+     * locked the first time a thread looks for a given name.
+     * @{
+     */
+
+    /**
+     * @return The identifier of an attribute name, which is added to the table if needed.
+     */
+    static size_t internAttributeKey(const std::string& key);
+
+    /**
+     * @param key The attribute name to look for.
+     * @param id [out] Its identifier, if found.
+     * @return False if the name is not in the table.
+     */
+    static bool findAttributeKey(const std::string& key, size_t& id);
+
+    /**
+     * @return The attribute name with the given identifier.
+     */
+    static const std::string& getAttributeKey(size_t id);
+
+    /**
+     * @brief Get the shared copy of a sequence identifier, source or type.
+     *
+     * Labels are stored once for all features, which only keep a pointer to them.
+     * This function is thread-safe, and the returned pointer remains valid during the whole program.
+     */
+    static const std::string* internLabel(const std::string& label);
+
+    /** @} */
+
   public:
     /**
      * @return The id of this feature.
@@ -290,23 +331,29 @@ class SequenceFeature:
 /**
  * @brief A very simple implementation of the SequenceFeature class.
  *
- * It uses a hash map for storing attributes.
+ * Attributes are stored in a small vector of (name identifier, value) pairs, sorted by name,
+ * with names interned in the global table (see SequenceFeature::internAttributeKey).
+ * The sequence identifier, source and type are interned labels (see SequenceFeature::internLabel),
+ * shared by all features with the same values.
+ * Attributes can be iterated with getNumberOfAttributes(), getAttributeName(size_t) and
+ * getAttributeValue(size_t), in alphabetical order of their names.
  */
 class BasicSequenceFeature:
   public SequenceFeature
 {
   protected:
     std::string id_;
-    std::string sequenceId_;
-    std::string source_;
-    std::string type_;
+    const std::string* sequenceId_;
+    const std::string* source_;
+    const std::string* type_;
     SeqRange range_;
     double score_;
-    mutable std::map<std::string, std::string> attributes_;
+    std::vector< std::pair<size_t, std::string> > attributes_;
     //SequenceFeatureSet subFeatures_;
 
   public:
-    BasicSequenceFeature(): id_(""), sequenceId_(""), source_(""), type_(""), range_(0, 0, '.'), score_(-1), attributes_() {}
+    BasicSequenceFeature():
+      id_(""), sequenceId_(internLabel("")), source_(sequenceId_), type_(sequenceId_), range_(0, 0, '.'), score_(-1), attributes_() {}
 
     BasicSequenceFeature(
         const std::string& id,
@@ -317,10 +364,27 @@ class BasicSequenceFeature:
         size_t end,
         char strand,
         double score = -1):
+      id_(id), sequenceId_(internLabel(seqId)), source_(internLabel(source)),
+      type_(internLabel(type)), range_(start, end, strand), score_(score),
+      attributes_()
+      //attributes_(), subFeatures_()
+    {}
+
+    /**
+     * @brief Build a feature from labels already interned with SequenceFeature::internLabel.
+     */
+    BasicSequenceFeature(
+        const std::string& id,
+        const std::string* seqId,
+        const std::string* source,
+        const std::string* type,
+        size_t start,
+        size_t end,
+        char strand,
+        double score = -1):
       id_(id), sequenceId_(seqId), source_(source),
       type_(type), range_(start, end, strand), score_(score),
       attributes_()
-      //attributes_(), subFeatures_()
     {}
 
     virtual BasicSequenceFeature* clone() const { return new BasicSequenceFeature(*this); }
@@ -328,12 +392,12 @@ class BasicSequenceFeature:
   public:
     const std::string& getId() const { return id_; }
     void setId(const std::string& id) { id_ = id; }
-    const std::string& getSequenceId() const { return sequenceId_; }
-    void setSequenceId(const std::string& sid) { sequenceId_ = sid; }
-    const std::string& getSource() const { return source_; }
-    void setSource(const std::string& source) { source_ = source; }
-    const std::string& getType() const { return type_; }
-    void setType(const std::string& type) { type_ = type; }
+    const std::string& getSequenceId() const { return *sequenceId_; }
+    void setSequenceId(const std::string& sid) { sequenceId_ = internLabel(sid); }
+    const std::string& getSource() const { return *source_; }
+    void setSource(const std::string& source) { source_ = internLabel(source); }
+    const std::string& getType() const { return *type_; }
+    void setType(const std::string& type) { type_ = internLabel(type); }
     const size_t getStart() const { return range_.begin(); }
     const size_t getEnd() const { return range_.end(); }
     bool isStranded() const { return range_.isStranded(); }
@@ -345,42 +409,77 @@ class BasicSequenceFeature:
     void setScore(double score) { score_ = score; }
 
     const std::string& getAttribute(const std::string& attribute) const {
-      std::map<std::string, std::string>::iterator it = attributes_.find(attribute);
-      if (it != attributes_.end())
-        return it->second;
+      size_t id;
+      if (!findAttributeKey(attribute, id))
+        return NO_ATTRIBUTE_SET;
+      size_t i = findAttribute_(id);
+      if (i < attributes_.size())
+        return attributes_[i].second;
       else
         return NO_ATTRIBUTE_SET;
     }
     
+    /**
+     * @brief Get or create an attribute.
+     *
+     * The returned reference is invalidated when other attributes are added or removed.
+     */
     std::string& getAttribute(const std::string& attribute) {
-      return attributes_[attribute];
+      size_t id = internAttributeKey(attribute);
+      size_t i = findAttribute_(id);
+      if (i == attributes_.size())
+        i = insertAttribute_(id, std::string());
+      return attributes_[i].second;
     }
     
     void setAttribute(const std::string& attribute, const std::string& value) {
-      attributes_[attribute] = value;
+      setAttribute(internAttributeKey(attribute), value);
+    }
+
+    /**
+     * @brief Set an attribute from the identifier of its name, as returned by internAttributeKey.
+     */
+    void setAttribute(size_t keyId, const std::string& value) {
+      size_t i = findAttribute_(keyId);
+      if (i < attributes_.size())
+        attributes_[i].second = value;
+      else
+        insertAttribute_(keyId, value);
     }
 
     std::set< std::string > getAttributeList() const {
       std::set< std::string > d;
-      for (std::map<std::string, std::string>::iterator it = attributes_.begin() ; it != attributes_.end() ; it++) {
-        d.insert(it->first);
+      for (size_t i = 0; i < attributes_.size(); ++i) {
+        d.insert(getAttributeKey(attributes_[i].first));
       }
       return d;
     }
 
     void removeAttribute(const std::string& attribute) {
-      std::map<std::string, std::string>::iterator it = attributes_.find(attribute);
-      if (it != attributes_.end()) {
-        attributes_.erase(it);
+      size_t id;
+      if (!findAttributeKey(attribute, id))
+        return;
+      size_t i = findAttribute_(id);
+      if (i < attributes_.size()) {
+        attributes_.erase(attributes_.begin() + static_cast<std::ptrdiff_t>(i));
       }
     }
 
+    size_t getNumberOfAttributes() const { return attributes_.size(); }
+
+    size_t getAttributeKeyId(size_t i) const { return attributes_[i].first; }
+
+    const std::string& getAttributeName(size_t i) const { return getAttributeKey(attributes_[i].first); }
+
+    const std::string& getAttributeValue(size_t i) const { return attributes_[i].second; }
+
     SeqRange getRange() const {
       return SeqRange(range_);
     }
 
     bool overlap(const SequenceFeature& feat) const {
-      if (feat.getSequenceId() == sequenceId_) {
+      //Interned labels are compared by address first:
+      if (&feat.getSequenceId() == sequenceId_ || feat.getSequenceId() == *sequenceId_) {
         return range_.overlap(feat.getRange());
       }
       return false;
@@ -398,6 +497,29 @@ class BasicSequenceFeature:
       return range.contains(range_);
     }
 
+  private:
+    /**
+     * @return The position of the attribute with the given name identifier, or the number of attributes if there is none.
+     */
+    size_t findAttribute_(size_t keyId) const {
+      size_t i = 0;
+      while (i < attributes_.size() && attributes_[i].first != keyId) ++i;
+      return i;
+    }
+
+    /**
+     * @brief Insert a new attribute, keeping attributes sorted by name.
+     *
+     * @return The position of the new attribute.
+     */
+    size_t insertAttribute_(size_t keyId, const std::string& value) {
+      const std::string& name = getAttributeKey(keyId);
+      size_t i = 0;
+      while (i < attributes_.size() && getAttributeKey(attributes_[i].first) < name) ++i;
+      attributes_.insert(attributes_.begin() + static_cast<std::ptrdiff_t>(i), std::make_pair(keyId, value));
+      return i;
+    }
+
      //const SequenceFeatureSet& getSubFeatures() const { return subFeatures; }
     //SequenceFeatureSet& getSubFeatures() { return subFeatures; }
 
@@ -412,20 +534,55 @@ class BasicSequenceFeature:
  * For now, it is mostly a vector of feature object, stored as pointers.
  * A few functions are provided for convenience.
  *
+ * An index can be built with buildIndex(), after which sequence, type and range queries
+ * no longer scan all features. Features are grouped per sequence, and the features of each
+ * sequence are stored in an implicit interval tree (an augmented array sorted by start position),
+ * so that overlap queries take O(log n + k) time for k results. Adding features invalidates the index,
+ * in which case queries fall back to a linear scan until buildIndex() is called again. Query results are
+ * always returned in the order of the features in the set. To select features without copying them,
+ * see SequenceFeatureView.
+ *
  * @author Julien Dutheil
  */
 class SequenceFeatureSet
 {
+  private:
+    /**
+     * @brief Implicit interval tree over the features of one sequence.
+     *
+     * Node i is at level k if its k lowest bits are set, and maxEnds[i] is the maximum
+     * end position in the subtree rooted at i.
+     */
+    struct IntervalTree_
+    {
+      std::vector<size_t> starts;
+      std::vector<size_t> ends;
+      std::vector<size_t> maxEnds;
+      std::vector<size_t> features; //Indices of the features, sorted by start position.
+      std::vector<size_t> inOrder;  //Indices of the features, in set order.
+      int maxLevel;
+      IntervalTree_(): starts(), ends(), maxEnds(), features(), inOrder(), maxLevel(-1) {}
+      void build(const std::vector<SequenceFeature*>& all);
+      void findOverlaps(size_t begin, size_t end, std::vector<size_t>& indices) const;
+      void findIncluded(size_t begin, size_t end, std::vector<size_t>& indices) const;
+    };
+
   private:
     std::vector<SequenceFeature*> features_;
+    std::map<std::string, IntervalTree_> sequenceIndex_;
+    std::map<std::string, std::vector<size_t> > typeIndex_;
+    bool indexed_;
+
+    //Snapshots restore the index directly:
+    friend class SequenceFeatureCache;
 
   public:
-    SequenceFeatureSet(): features_() {};
+    SequenceFeatureSet(): features_(), sequenceIndex_(), typeIndex_(), indexed_(false) {};
 
     virtual ~SequenceFeatureSet() { clear(); }
 
     SequenceFeatureSet(const SequenceFeatureSet& sfs):
-      features_()
+      features_(), sequenceIndex_(sfs.sequenceIndex_), typeIndex_(sfs.typeIndex_), indexed_(sfs.indexed_)
     {
       for (std::vector<SequenceFeature*>::const_iterator it = sfs.features_.begin();
           it != sfs.features_.end();
@@ -441,6 +598,9 @@ class SequenceFeatureSet
           ++it) {
         features_.push_back((**it).clone());
       }
+      sequenceIndex_ = sfs.sequenceIndex_;
+      typeIndex_ = sfs.typeIndex_;
+      indexed_ = sfs.indexed_;
       return *this;
     }
 
@@ -456,8 +616,49 @@ class SequenceFeatureSet
         delete *it;
       }
       features_.clear();
+      sequenceIndex_.clear();
+      typeIndex_.clear();
+      indexed_ = false;
     }
 
+    /**
+     * @brief Build the sequence, type and range index.
+     *
+     * This takes O(n log n) time, and should be called once all features have been added.
+     */
+    void buildIndex();
+
+    /**
+     * @return True if the index is built and up to date.
+     */
+    bool isIndexed() const { return indexed_; }
+
+    /**
+     * @brief Get the indices of features of a given sequence overlapping (or included in) a range.
+     *
+     * @param seqId The sequence id.
+     * @param range The range to look for.
+     * @param complete If true, only features fully included in the range are returned.
+     * @param indices [out] A vector where the indices of the features found are appended, in set order.
+     */
+    void getIndicesForRange(const std::string& seqId, const Range<size_t>& range, bool complete, std::vector<size_t>& indices) const;
+
+    /**
+     * @brief Get the indices of all features of a given sequence.
+     *
+     * @param seqId The sequence id.
+     * @param indices [out] A vector where the indices of the features found are appended, in set order.
+     */
+    void getIndicesForSequence(const std::string& seqId, std::vector<size_t>& indices) const;
+
+    /**
+     * @brief Get the indices of all features of a given type.
+     *
+     * @param type The feature type.
+     * @param indices [out] A vector where the indices of the features found are appended, in set order.
+     */
+    void getIndicesForType(const std::string& type, std::vector<size_t>& indices) const;
+
     /**
      * @param i The index of the feature.
      * @return A reference toward the feature.
@@ -466,6 +667,15 @@ class SequenceFeatureSet
       return *features_[i];
     }
 
+    /**
+     * @param i The index of the feature.
+     * @return A modifiable reference toward the feature.
+     * Changing the sequence, type or coordinates of an indexed feature requires to call buildIndex() again.
+     */
+    SequenceFeature& getFeature(size_t i) {
+      return *features_[i];
+    }
+
     /**
      * @param i The index of the feature.
      * @return A reference toward the feature.
@@ -492,6 +702,42 @@ class SequenceFeatureSet
      */
     void addFeature(const SequenceFeature& feature) {
       features_.push_back(feature.clone());
+      indexed_ = false;
+    }
+
+    /**
+     * @brief Add a feature to the container, without copying it.
+     *
+     * @param feature The feature to add to the container, which takes ownership of it.
+     */
+    void addFeature(std::unique_ptr<SequenceFeature> feature) {
+      features_.push_back(feature.get());
+      feature.release();
+      indexed_ = false;
+    }
+
+    /**
+     * @brief Allocate space for a given total number of features.
+     *
+     * Readers adding many features can call this first to avoid reallocations.
+     */
+    void reserve(size_t nbFeatures) { features_.reserve(nbFeatures); }
+
+    /**
+     * @brief Move all features of another set at the end of this one.
+     *
+     * Features are not copied, and the other set is left empty.
+     *
+     * @param features The set to empty.
+     */
+    void transferFeatures(SequenceFeatureSet& features) {
+      if (&features == this) return;
+      features_.insert(features_.end(), features.features_.begin(), features.features_.end());
+      features.features_.clear();
+      features.sequenceIndex_.clear();
+      features.typeIndex_.clear();
+      features.indexed_ = false;
+      indexed_ = false;
     }
 
     /**
@@ -540,12 +786,10 @@ class SequenceFeatureSet
      * @param coords [out] a container where to add the coordinates of each feature.
      */
     void fillRangeCollectionForSequence(const std::string& seqId, RangeCollection<size_t>& coords) const {
-      for (std::vector<SequenceFeature*>::const_iterator it = features_.begin();
-          it != features_.end();
-          ++it) {
-        if ((**it).getSequenceId() == seqId) {
-          coords.addRange((**it).getRange());
-        }
+      std::vector<size_t> indices;
+      getIndicesForSequence(seqId, indices);
+      for (size_t i = 0; i < indices.size(); ++i) {
+        coords.addRange(features_[indices[i]]->getRange());
       }
     }
 
@@ -554,15 +798,9 @@ class SequenceFeatureSet
      * @return A new set with all features of a given type.
      */
     SequenceFeatureSet* getSubsetForType(const std::string& type) const {
-      SequenceFeatureSet* subset = new SequenceFeatureSet();
-      for (std::vector<SequenceFeature*>::const_iterator it = features_.begin();
-          it != features_.end();
-          ++it) {
-        if ((**it).getType() == type) {
-          subset->addFeature(**it);
-        }
-      }
-      return subset;
+      std::vector<size_t> indices;
+      getIndicesForType(type, indices);
+      return getSubset_(indices);
     }
 
     /**
@@ -586,15 +824,9 @@ class SequenceFeatureSet
      * @return A new set with all features for a given sequence id.
      */
     SequenceFeatureSet* getSubsetForSequence(const std::string& id) const {
-      SequenceFeatureSet* subset = new SequenceFeatureSet();
-      for (std::vector<SequenceFeature*>::const_iterator it = features_.begin();
-          it != features_.end();
-          ++it) {
-        if ((**it).getSequenceId() == id) {
-          subset->addFeature(**it);
-        }
-      }
-      return subset;
+      std::vector<size_t> indices;
+      getIndicesForSequence(id, indices);
+      return getSubset_(indices);
     }
 
     /**
@@ -620,6 +852,19 @@ class SequenceFeatureSet
      * @return A new set with all features included in the given range.
      */
     SequenceFeatureSet* getSubsetForRange(const SeqRange& range, bool complete) const {
+      if (indexed_) {
+        std::vector<size_t> indices;
+        for (std::map<std::string, IntervalTree_>::const_iterator it = sequenceIndex_.begin();
+            it != sequenceIndex_.end();
+            ++it) {
+          if (complete)
+            it->second.findIncluded(range.begin(), range.end(), indices);
+          else
+            it->second.findOverlaps(range.begin(), range.end(), indices);
+        }
+        std::sort(indices.begin(), indices.end());
+        return getSubset_(indices);
+      }
       SequenceFeatureSet* subset = new SequenceFeatureSet();
       for (std::vector<SequenceFeature*>::const_iterator it = features_.begin();
           it != features_.end();
@@ -635,6 +880,16 @@ class SequenceFeatureSet
       return subset;
     }
 
+  private:
+    SequenceFeatureSet* getSubset_(const std::vector<size_t>& indices) const {
+      SequenceFeatureSet* subset = new SequenceFeatureSet();
+      subset->reserve(indices.size());
+      for (size_t i = 0; i < indices.size(); ++i) {
+        subset->addFeature(*features_[indices[i]]);
+      }
+      return subset;
+    }
+
 };
 
 } //end of namespace bpp
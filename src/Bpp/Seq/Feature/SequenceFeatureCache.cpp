@@ -0,0 +1,620 @@
+//
+// File: SequenceFeatureCache.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "SequenceFeatureCache.h"
+#include "ImplicitIntervalTree.h"
+
+//From bpp-core:
+#include <Bpp/Exceptions.h>
+#include <Bpp/Text/TextTools.h>
+
+//From the STL:
+#include <fstream>
+#include <map>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+//All sections start at a multiple of 8 bytes, and all records are made of 8-byte fields.
+
+struct SequenceFeatureCache::Header_
+{
+  char magic[8];
+  uint32_t byteOrder;
+  uint32_t version;
+  uint64_t fileSize;
+  uint64_t nbFeatures;
+  uint64_t nbStrings;
+  uint64_t nbAttributes;
+  uint64_t nbSequences;
+  uint64_t nbTypes;
+  uint64_t stringOffsetsOffset; //nbStrings + 1 offsets in the string data.
+  uint64_t stringsOffset;
+  uint64_t featuresOffset;
+  uint64_t attributesOffset;
+  uint64_t sequencesOffset;
+  uint64_t typesOffset;
+};
+
+struct SequenceFeatureCache::FeatureRecord_
+{
+  uint64_t start;
+  uint64_t end;
+  double score;
+  uint64_t id;
+  uint64_t sequence;
+  uint64_t source;
+  uint64_t type;
+  uint64_t firstAttribute;
+  uint32_t nbAttributes;
+  uint32_t strand;
+};
+
+struct SequenceFeatureCache::AttributeRecord_
+{
+  uint64_t key;
+  uint64_t value;
+};
+
+//The tree of a sequence is stored as five arrays of nbFeatures values:
+//starts, ends and maxEnds, sorted by start position, then the feature indices in start order, then in set order.
+struct SequenceFeatureCache::SequenceRecord_
+{
+  uint64_t name;
+  uint64_t nbFeatures;
+  int64_t maxLevel;
+  uint64_t offset;
+};
+
+struct SequenceFeatureCache::TypeRecord_
+{
+  uint64_t name;
+  uint64_t nbFeatures;
+  uint64_t offset; //Feature indices, in set order.
+};
+
+namespace {
+
+const char CACHE_MAGIC_[8] = { 'B', 'P', 'P', 'F', 'E', 'A', 'T', '\0' };
+const uint32_t CACHE_BYTE_ORDER_ = 0x01020304;
+const uint32_t CACHE_VERSION_ = 1;
+
+class StringTable_
+{
+  public:
+    vector<const string*> values;
+    unordered_map<string, uint64_t> ids;
+    StringTable_(): values(), ids() {}
+    uint64_t getId(const string& s) {
+      unordered_map<string, uint64_t>::iterator it = ids.find(s);
+      if (it != ids.end()) return it->second;
+      uint64_t id = static_cast<uint64_t>(values.size());
+      values.push_back(&ids.insert(make_pair(s, id)).first->first);
+      return id;
+    }
+};
+
+struct SequenceTree_
+{
+  vector<uint64_t> inOrder;
+  vector<uint64_t> features;
+  vector<uint64_t> starts;
+  vector<uint64_t> ends;
+  vector<uint64_t> maxEnds;
+  int maxLevel;
+  SequenceTree_(): inOrder(), features(), starts(), ends(), maxEnds(), maxLevel(-1) {}
+};
+
+struct RecordStartOrder_
+{
+  const vector<uint64_t>* starts;
+  const vector<uint64_t>* ends;
+  bool operator()(uint64_t i, uint64_t j) const {
+    if ((*starts)[i] != (*starts)[j]) return (*starts)[i] < (*starts)[j];
+    if ((*ends)[i] != (*ends)[j]) return (*ends)[i] < (*ends)[j];
+    return i < j;
+  }
+};
+
+uint64_t align8_(uint64_t offset) { return (offset + 7) & ~static_cast<uint64_t>(7); }
+
+void writePadding_(ofstream& out, uint64_t& offset)
+{
+  static const char zeros[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+  uint64_t aligned = align8_(offset);
+  out.write(zeros, static_cast<streamsize>(aligned - offset));
+  offset = aligned;
+}
+
+template<class T>
+void writeArray_(ofstream& out, uint64_t& offset, const T* values, size_t n)
+{
+  if (n > 0)
+    out.write(reinterpret_cast<const char*>(values), static_cast<streamsize>(n * sizeof(T)));
+  offset += static_cast<uint64_t>(n * sizeof(T));
+}
+
+}
+
+/******************************************************************************/
+
+void SequenceFeatureCache::write(const SequenceFeatureSet& features, const std::string& path)
+{
+  size_t n = features.getNumberOfFeatures();
+  StringTable_ strings;
+  vector<FeatureRecord_> records(n);
+  vector<AttributeRecord_> attributes;
+  map<string, SequenceTree_> trees;
+  map<string, vector<uint64_t> > types;
+  vector<uint64_t> allStarts(n), allEnds(n);
+  for (size_t i = 0; i < n; ++i) {
+    const SequenceFeature& f = features[i];
+    FeatureRecord_& r = records[i];
+    r.start    = allStarts[i] = static_cast<uint64_t>(f.getStart());
+    r.end      = allEnds[i]   = static_cast<uint64_t>(f.getEnd());
+    r.score    = f.getScore();
+    r.id       = strings.getId(f.getId());
+    r.sequence = strings.getId(f.getSequenceId());
+    r.source   = strings.getId(f.getSource());
+    r.type     = strings.getId(f.getType());
+    r.strand   = static_cast<uint32_t>(static_cast<unsigned char>(f.getRange().getStrand()));
+    r.firstAttribute = static_cast<uint64_t>(attributes.size());
+    AttributeRecord_ a;
+    const BasicSequenceFeature* bf = dynamic_cast<const BasicSequenceFeature*>(&f);
+    if (bf) {
+      for (size_t j = 0; j < bf->getNumberOfAttributes(); ++j) {
+        a.key   = strings.getId(bf->getAttributeName(j));
+        a.value = strings.getId(bf->getAttributeValue(j));
+        attributes.push_back(a);
+      }
+    } else {
+      set<string> names = f.getAttributeList();
+      for (set<string>::const_iterator it = names.begin(); it != names.end(); ++it) {
+        a.key   = strings.getId(*it);
+        a.value = strings.getId(f.getAttribute(*it));
+        attributes.push_back(a);
+      }
+    }
+    r.nbAttributes = static_cast<uint32_t>(attributes.size() - r.firstAttribute);
+    trees[f.getSequenceId()].inOrder.push_back(i);
+    types[f.getType()].push_back(i);
+  }
+
+  //Build the trees:
+  RecordStartOrder_ order;
+  order.starts = &allStarts;
+  order.ends = &allEnds;
+  for (map<string, SequenceTree_>::iterator it = trees.begin(); it != trees.end(); ++it) {
+    SequenceTree_& t = it->second;
+    t.features = t.inOrder;
+    sort(t.features.begin(), t.features.end(), order);
+    size_t m = t.features.size();
+    t.starts.resize(m);
+    t.ends.resize(m);
+    t.maxEnds.resize(m);
+    for (size_t j = 0; j < m; ++j) {
+      t.starts[j] = allStarts[t.features[j]];
+      t.ends[j]   = allEnds[t.features[j]];
+    }
+    t.maxLevel = ImplicitIntervalTree::build(t.ends.data(), t.maxEnds.data(), m);
+  }
+  vector<SequenceRecord_> sequences;
+  for (map<string, SequenceTree_>::iterator it = trees.begin(); it != trees.end(); ++it) {
+    SequenceRecord_ s;
+    s.name = strings.getId(it->first);
+    s.nbFeatures = static_cast<uint64_t>(it->second.inOrder.size());
+    s.maxLevel = it->second.maxLevel;
+    s.offset = 0;
+    sequences.push_back(s);
+  }
+  vector<TypeRecord_> typeRecords;
+  for (map<string, vector<uint64_t> >::iterator it = types.begin(); it != types.end(); ++it) {
+    TypeRecord_ t;
+    t.name = strings.getId(it->first);
+    t.nbFeatures = static_cast<uint64_t>(it->second.size());
+    t.offset = 0;
+    typeRecords.push_back(t);
+  }
+  vector<uint64_t> stringOffsets(strings.values.size() + 1, 0);
+  for (size_t i = 0; i < strings.values.size(); ++i)
+    stringOffsets[i + 1] = stringOffsets[i] + static_cast<uint64_t>(strings.values[i]->size());
+
+  //Compute the layout:
+  Header_ header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, CACHE_MAGIC_, 8);
+  header.byteOrder    = CACHE_BYTE_ORDER_;
+  header.version      = CACHE_VERSION_;
+  header.nbFeatures   = static_cast<uint64_t>(n);
+  header.nbStrings    = static_cast<uint64_t>(strings.values.size());
+  header.nbAttributes = static_cast<uint64_t>(attributes.size());
+  header.nbSequences  = static_cast<uint64_t>(sequences.size());
+  header.nbTypes      = static_cast<uint64_t>(typeRecords.size());
+  uint64_t offset = sizeof(Header_);
+  header.stringOffsetsOffset = offset;
+  offset += stringOffsets.size() * sizeof(uint64_t);
+  header.stringsOffset = offset;
+  offset = align8_(offset + stringOffsets.back());
+  header.featuresOffset = offset;
+  offset += records.size() * sizeof(FeatureRecord_);
+  header.attributesOffset = offset;
+  offset += attributes.size() * sizeof(AttributeRecord_);
+  header.sequencesOffset = offset;
+  offset += sequences.size() * sizeof(SequenceRecord_);
+  header.typesOffset = offset;
+  offset += typeRecords.size() * sizeof(TypeRecord_);
+  size_t k = 0;
+  for (map<string, SequenceTree_>::iterator it = trees.begin(); it != trees.end(); ++it, ++k) {
+    sequences[k].offset = offset;
+    offset += 5 * sequences[k].nbFeatures * sizeof(uint64_t);
+  }
+  k = 0;
+  for (map<string, vector<uint64_t> >::iterator it = types.begin(); it != types.end(); ++it, ++k) {
+    typeRecords[k].offset = offset;
+    offset += typeRecords[k].nbFeatures * sizeof(uint64_t);
+  }
+  header.fileSize = offset;
+
+  //Write everything:
+  ofstream out(path.c_str(), ios::out | ios::binary);
+  if (!out)
+    throw IOException("SequenceFeatureCache::write. Cannot open file " + path + " for writing.");
+  offset = 0;
+  writeArray_(out, offset, &header, 1);
+  writeArray_(out, offset, stringOffsets.data(), stringOffsets.size());
+  for (size_t i = 0; i < strings.values.size(); ++i)
+    writeArray_(out, offset, strings.values[i]->data(), strings.values[i]->size());
+  writePadding_(out, offset);
+  writeArray_(out, offset, records.data(), records.size());
+  writeArray_(out, offset, attributes.data(), attributes.size());
+  writeArray_(out, offset, sequences.data(), sequences.size());
+  writeArray_(out, offset, typeRecords.data(), typeRecords.size());
+  for (map<string, SequenceTree_>::iterator it = trees.begin(); it != trees.end(); ++it) {
+    const SequenceTree_& t = it->second;
+    writeArray_(out, offset, t.starts.data(), t.starts.size());
+    writeArray_(out, offset, t.ends.data(), t.ends.size());
+    writeArray_(out, offset, t.maxEnds.data(), t.maxEnds.size());
+    writeArray_(out, offset, t.features.data(), t.features.size());
+    writeArray_(out, offset, t.inOrder.data(), t.inOrder.size());
+  }
+  for (map<string, vector<uint64_t> >::iterator it = types.begin(); it != types.end(); ++it)
+    writeArray_(out, offset, it->second.data(), it->second.size());
+  out.close();
+  if (!out)
+    throw IOException("SequenceFeatureCache::write. Error while writing file " + path + ".");
+}
+
+bool SequenceFeatureCache::isCache(const std::string& path)
+{
+  ifstream in(path.c_str(), ios::in | ios::binary);
+  char magic[8];
+  if (!in.read(magic, 8))
+    return false;
+  return memcmp(magic, CACHE_MAGIC_, 8) == 0;
+}
+
+/******************************************************************************/
+
+SequenceFeatureCache::SequenceFeatureCache(const std::string& path):
+  path_(path), data_(0), size_(0), header_(0), stringOffsets_(0), strings_(0),
+  features_(0), attributes_(0), sequences_(0), types_(0)
+{
+#ifndef _WIN32
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw IOException("SequenceFeatureCache (constructor). Cannot open file " + path + ".");
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw IOException("SequenceFeatureCache (constructor). Cannot stat file " + path + ".");
+  }
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ < sizeof(Header_)) {
+    close(fd);
+    throw IOException("SequenceFeatureCache (constructor). File " + path + " is not a feature snapshot.");
+  }
+  void* addr = mmap(0, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  //The mapping remains valid after the file descriptor is closed:
+  close(fd);
+  if (addr == MAP_FAILED)
+    throw IOException("SequenceFeatureCache (constructor). Cannot map file " + path + " into memory.");
+  data_ = static_cast<const char*>(addr);
+#else
+  throw Exception("SequenceFeatureCache (constructor). Memory mapping is not supported on this platform.");
+#endif
+  try {
+    header_ = reinterpret_cast<const Header_*>(data_);
+    check_(memcmp(header_->magic, CACHE_MAGIC_, 8) == 0, "not a feature snapshot");
+    check_(header_->byteOrder == CACHE_BYTE_ORDER_, "written on a machine with another byte order");
+    check_(header_->version == CACHE_VERSION_, "unsupported version " + TextTools::toString(header_->version));
+    check_(header_->fileSize == size_, "truncated file");
+    check_(header_->stringOffsetsOffset % 8 == 0 && header_->featuresOffset % 8 == 0 && header_->attributesOffset % 8 == 0
+        && header_->sequencesOffset % 8 == 0 && header_->typesOffset % 8 == 0, "misaligned sections");
+    check_(header_->nbStrings < size_ / sizeof(uint64_t)
+        && fits_(header_->stringOffsetsOffset, header_->nbStrings + 1, sizeof(uint64_t))
+        && fits_(header_->featuresOffset, header_->nbFeatures, sizeof(FeatureRecord_))
+        && fits_(header_->attributesOffset, header_->nbAttributes, sizeof(AttributeRecord_))
+        && fits_(header_->sequencesOffset, header_->nbSequences, sizeof(SequenceRecord_))
+        && fits_(header_->typesOffset, header_->nbTypes, sizeof(TypeRecord_)), "sections beyond end of file");
+    stringOffsets_ = getArray_(header_->stringOffsetsOffset);
+    for (uint64_t i = 0; i < header_->nbStrings; ++i)
+      check_(stringOffsets_[i] <= stringOffsets_[i + 1], "invalid string offsets");
+    check_(fits_(header_->stringsOffset, stringOffsets_[header_->nbStrings], 1), "strings beyond end of file");
+    strings_       = data_ + header_->stringsOffset;
+    features_      = reinterpret_cast<const FeatureRecord_*>(data_ + header_->featuresOffset);
+    attributes_    = reinterpret_cast<const AttributeRecord_*>(data_ + header_->attributesOffset);
+    sequences_     = reinterpret_cast<const SequenceRecord_*>(data_ + header_->sequencesOffset);
+    types_         = reinterpret_cast<const TypeRecord_*>(data_ + header_->typesOffset);
+    checkRecords_();
+  } catch (...) {
+#ifndef _WIN32
+    munmap(const_cast<char*>(data_), size_);
+#endif
+    throw;
+  }
+}
+
+SequenceFeatureCache::~SequenceFeatureCache()
+{
+#ifndef _WIN32
+  if (data_)
+    munmap(const_cast<char*>(data_), size_);
+#endif
+}
+
+void SequenceFeatureCache::check_(bool test, const std::string& what) const
+{
+  if (!test)
+    throw IOException("SequenceFeatureCache (constructor). Invalid snapshot " + path_ + ": " + what + ".");
+}
+
+bool SequenceFeatureCache::fits_(uint64_t offset, uint64_t count, size_t recordSize) const
+{
+  //Written so that corrupted values cannot overflow:
+  return offset <= size_ && count <= (size_ - offset) / recordSize;
+}
+
+void SequenceFeatureCache::checkIndices_(const uint64_t* indices, uint64_t n) const
+{
+  for (uint64_t j = 0; j < n; ++j)
+    check_(indices[j] < header_->nbFeatures, "invalid feature index");
+}
+
+void SequenceFeatureCache::checkRecords_() const
+{
+  //Every offset, count and index read from the file is checked once, so that accessors do not need to:
+  uint64_t nbStrings = header_->nbStrings;
+  for (uint64_t i = 0; i < header_->nbFeatures; ++i) {
+    const FeatureRecord_& r = features_[i];
+    check_(r.id < nbStrings && r.sequence < nbStrings && r.source < nbStrings && r.type < nbStrings, "invalid feature string");
+    check_(r.firstAttribute <= header_->nbAttributes && r.nbAttributes <= header_->nbAttributes - r.firstAttribute, "invalid feature attributes");
+  }
+  for (uint64_t i = 0; i < header_->nbAttributes; ++i)
+    check_(attributes_[i].key < nbStrings && attributes_[i].value < nbStrings, "invalid attribute string");
+  for (uint64_t k = 0; k < header_->nbSequences; ++k) {
+    const SequenceRecord_& s = sequences_[k];
+    check_(s.name < nbStrings, "invalid sequence name");
+    check_(s.offset % 8 == 0 && s.nbFeatures <= header_->nbFeatures && fits_(s.offset, 5 * s.nbFeatures, sizeof(uint64_t)), "sequence index beyond end of file");
+    //The root level is the one computed by ImplicitIntervalTree::build:
+    int64_t level = -1;
+    while (level < 63 && (static_cast<uint64_t>(1) << (level + 1)) <= s.nbFeatures)
+      level++;
+    check_(s.maxLevel == level, "invalid sequence index");
+    checkIndices_(getArray_(s.offset) + 3 * s.nbFeatures, 2 * s.nbFeatures);
+  }
+  for (uint64_t k = 0; k < header_->nbTypes; ++k) {
+    const TypeRecord_& t = types_[k];
+    check_(t.name < nbStrings, "invalid type name");
+    check_(t.offset % 8 == 0 && fits_(t.offset, t.nbFeatures, sizeof(uint64_t)), "type index beyond end of file");
+    checkIndices_(getArray_(t.offset), t.nbFeatures);
+  }
+}
+
+/******************************************************************************/
+
+size_t SequenceFeatureCache::getNumberOfFeatures() const { return static_cast<size_t>(header_->nbFeatures); }
+
+std::string SequenceFeatureCache::getId(size_t i) const { return toString_(features_[i].id); }
+
+std::string SequenceFeatureCache::getSequenceId(size_t i) const { return toString_(features_[i].sequence); }
+
+std::string SequenceFeatureCache::getType(size_t i) const { return toString_(features_[i].type); }
+
+size_t SequenceFeatureCache::getStart(size_t i) const { return static_cast<size_t>(features_[i].start); }
+
+size_t SequenceFeatureCache::getEnd(size_t i) const { return static_cast<size_t>(features_[i].end); }
+
+SeqRange SequenceFeatureCache::getRange(size_t i) const
+{
+  return SeqRange(static_cast<size_t>(features_[i].start), static_cast<size_t>(features_[i].end), static_cast<char>(features_[i].strand));
+}
+
+BasicSequenceFeature* SequenceFeatureCache::newFeature_(size_t i, std::unordered_map<uint64_t, size_t>& keyIds) const
+{
+  const FeatureRecord_& r = features_[i];
+  BasicSequenceFeature* f = new BasicSequenceFeature(
+      toString_(r.id), toString_(r.sequence), toString_(r.source), toString_(r.type),
+      static_cast<size_t>(r.start), static_cast<size_t>(r.end), static_cast<char>(r.strand), r.score);
+  for (uint64_t j = r.firstAttribute; j < r.firstAttribute + r.nbAttributes; ++j) {
+    const AttributeRecord_& a = attributes_[j];
+    unordered_map<uint64_t, size_t>::iterator it = keyIds.find(a.key);
+    if (it == keyIds.end())
+      it = keyIds.insert(make_pair(a.key, SequenceFeature::internAttributeKey(toString_(a.key)))).first;
+    f->setAttribute(it->second, toString_(a.value));
+  }
+  return f;
+}
+
+BasicSequenceFeature SequenceFeatureCache::getFeature(size_t i) const
+{
+  if (i >= getNumberOfFeatures())
+    throw IndexOutOfBoundsException("SequenceFeatureCache::getFeature.", i, 0, getNumberOfFeatures() - 1);
+  unordered_map<uint64_t, size_t> keyIds;
+  unique_ptr<BasicSequenceFeature> f(newFeature_(i, keyIds));
+  return *f;
+}
+
+void SequenceFeatureCache::getFeatures(const std::vector<size_t>& indices, SequenceFeatureSet& features) const
+{
+  unordered_map<uint64_t, size_t> keyIds;
+  features.reserve(features.getNumberOfFeatures() + indices.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    if (indices[i] >= getNumberOfFeatures())
+      throw IndexOutOfBoundsException("SequenceFeatureCache::getFeatures.", indices[i], 0, getNumberOfFeatures() - 1);
+    features.addFeature(unique_ptr<SequenceFeature>(newFeature_(indices[i], keyIds)));
+  }
+}
+
+void SequenceFeatureCache::load(SequenceFeatureSet& features) const
+{
+  bool restoreIndex = features.isEmpty();
+  unordered_map<uint64_t, size_t> keyIds;
+  size_t n = getNumberOfFeatures();
+  features.reserve(features.getNumberOfFeatures() + n);
+  for (size_t i = 0; i < n; ++i)
+    features.addFeature(unique_ptr<SequenceFeature>(newFeature_(i, keyIds)));
+  if (!restoreIndex)
+    return;
+  for (uint64_t k = 0; k < header_->nbSequences; ++k) {
+    const SequenceRecord_& s = sequences_[k];
+    size_t m = static_cast<size_t>(s.nbFeatures);
+    const uint64_t* arrays = getArray_(s.offset);
+    SequenceFeatureSet::IntervalTree_& tree = features.sequenceIndex_[toString_(s.name)];
+    tree.starts.assign(arrays, arrays + m);
+    tree.ends.assign(arrays + m, arrays + 2 * m);
+    tree.maxEnds.assign(arrays + 2 * m, arrays + 3 * m);
+    tree.features.assign(arrays + 3 * m, arrays + 4 * m);
+    tree.inOrder.assign(arrays + 4 * m, arrays + 5 * m);
+    tree.maxLevel = static_cast<int>(s.maxLevel);
+  }
+  for (uint64_t k = 0; k < header_->nbTypes; ++k) {
+    const TypeRecord_& t = types_[k];
+    const uint64_t* indices = getArray_(t.offset);
+    features.typeIndex_[toString_(t.name)].assign(indices, indices + t.nbFeatures);
+  }
+  features.indexed_ = true;
+}
+
+/******************************************************************************/
+
+std::set<std::string> SequenceFeatureCache::getSequences() const
+{
+  set<string> seqIds;
+  for (uint64_t k = 0; k < header_->nbSequences; ++k)
+    seqIds.insert(toString_(sequences_[k].name));
+  return seqIds;
+}
+
+std::set<std::string> SequenceFeatureCache::getTypes() const
+{
+  set<string> types;
+  for (uint64_t k = 0; k < header_->nbTypes; ++k)
+    types.insert(toString_(types_[k].name));
+  return types;
+}
+
+bool SequenceFeatureCache::hasSequence(const std::string& seqId) const
+{
+  return findSequence_(seqId) != 0;
+}
+
+bool SequenceFeatureCache::equals_(uint64_t id, const std::string& s) const
+{
+  return getStringLength_(id) == s.size() && memcmp(getString_(id), s.data(), s.size()) == 0;
+}
+
+const SequenceFeatureCache::SequenceRecord_* SequenceFeatureCache::findSequence_(const std::string& seqId) const
+{
+  //Records are sorted by name:
+  size_t a = 0, b = static_cast<size_t>(header_->nbSequences);
+  while (a < b) {
+    size_t c = (a + b) / 2;
+    int cmp = seqId.compare(0, seqId.size(), getString_(sequences_[c].name), getStringLength_(sequences_[c].name));
+    if (cmp == 0) return &sequences_[c];
+    if (cmp > 0) a = c + 1;
+    else b = c;
+  }
+  return 0;
+}
+
+void SequenceFeatureCache::getIndicesForRange(const std::string& seqId, const Range<size_t>& range, bool complete, std::vector<size_t>& indices) const
+{
+  const SequenceRecord_* s = findSequence_(seqId);
+  if (!s) return;
+  size_t m = static_cast<size_t>(s->nbFeatures);
+  const uint64_t* arrays = getArray_(s->offset);
+  size_t first = indices.size();
+  if (complete)
+    ImplicitIntervalTree::findIncluded(arrays, arrays + m, arrays + 3 * m, m, range.begin(), range.end(), indices);
+  else
+    ImplicitIntervalTree::findOverlaps(arrays, arrays + m, arrays + 2 * m, arrays + 3 * m, m, static_cast<int>(s->maxLevel), range.begin(), range.end(), indices);
+  sort(indices.begin() + static_cast<ptrdiff_t>(first), indices.end());
+}
+
+void SequenceFeatureCache::getIndicesForSequence(const std::string& seqId, std::vector<size_t>& indices) const
+{
+  const SequenceRecord_* s = findSequence_(seqId);
+  if (!s) return;
+  const uint64_t* inOrder = getArray_(s->offset) + 4 * s->nbFeatures;
+  indices.insert(indices.end(), inOrder, inOrder + s->nbFeatures);
+}
+
+void SequenceFeatureCache::getIndicesForType(const std::string& type, std::vector<size_t>& indices) const
+{
+  for (uint64_t k = 0; k < header_->nbTypes; ++k) {
+    if (equals_(types_[k].name, type)) {
+      const uint64_t* ids = getArray_(types_[k].offset);
+      indices.insert(indices.end(), ids, ids + types_[k].nbFeatures);
+      return;
+    }
+  }
+}
+
@@ -0,0 +1,202 @@
+//
+// File: SequenceFeatureCache.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _SEQUENCEFEATURECACHE_H_
+#define _SEQUENCEFEATURECACHE_H_
+
+#include "SequenceFeature.h"
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <set>
+#include <unordered_map>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief A binary snapshot of a SequenceFeatureSet, read through a memory mapping.
+ *
+ * Parsing large annotation files takes much longer than the analyses which use them.
+ * The write() method saves a feature set in a compact binary form: a table of distinct
+ * strings, arrays of fixed-size feature and attribute records, and the sequence, type
+ * and interval index of the set (see SequenceFeatureSet::buildIndex()).
+ *
+ * Opening a snapshot maps the file in memory, and nothing is decoded until needed:
+ * coordinates and names are read directly from the mapping, range queries use the
+ * stored interval trees, and BasicSequenceFeature objects are only built for the
+ * features requested. A full SequenceFeatureSet can also be loaded, with its index
+ * restored rather than recomputed. All offsets, counts and string indices of the file
+ * are checked once when it is opened, so that a corrupted snapshot is rejected rather
+ * than read out of bounds.
+ *
+ * Snapshots use the byte order of the machine which wrote them, and are rejected
+ * on a machine with another byte order. Memory mapping is only supported on POSIX systems.
+ *
+ * @author Julien Dutheil
+ */
+class SequenceFeatureCache
+{
+  private:
+    struct Header_;
+    struct FeatureRecord_;
+    struct AttributeRecord_;
+    struct SequenceRecord_;
+    struct TypeRecord_;
+
+  private:
+    std::string path_;
+    const char* data_;
+    size_t size_;
+    const Header_* header_;
+    const uint64_t* stringOffsets_;
+    const char* strings_;
+    const FeatureRecord_* features_;
+    const AttributeRecord_* attributes_;
+    const SequenceRecord_* sequences_;
+    const TypeRecord_* types_;
+
+  public:
+    /**
+     * @brief Open a snapshot.
+     *
+     * @param path The snapshot file, as written by write().
+     * @throw IOException If the file cannot be mapped, or is not a valid snapshot
+     * (including offsets or indices beyond the end of the file).
+     */
+    SequenceFeatureCache(const std::string& path);
+
+    virtual ~SequenceFeatureCache();
+
+  private:
+    //Recopy is forbidden!
+    SequenceFeatureCache(const SequenceFeatureCache&);
+    SequenceFeatureCache& operator=(const SequenceFeatureCache&);
+
+  public:
+    /**
+     * @brief Write a snapshot of a feature set.
+     *
+     * The set does not have to be indexed, the index is computed on the fly if needed.
+     * Attributes are stored by name, and do not depend on the attribute identifiers of the current process.
+     *
+     * @param features The features to save.
+     * @param path The file to write.
+     * @throw IOException If the file cannot be written.
+     */
+    static void write(const SequenceFeatureSet& features, const std::string& path);
+
+    /**
+     * @brief Tell if a file looks like a snapshot, by checking its first bytes.
+     */
+    static bool isCache(const std::string& path);
+
+  public:
+    size_t getNumberOfFeatures() const;
+
+    /**
+     * @name Direct access to the fields of a feature, without building it.
+     *
+     * @{
+     */
+    std::string getId(size_t i) const;
+    std::string getSequenceId(size_t i) const;
+    std::string getType(size_t i) const;
+    size_t getStart(size_t i) const;
+    size_t getEnd(size_t i) const;
+    SeqRange getRange(size_t i) const;
+    /** @} */
+
+    /**
+     * @return The feature at a given index, built from the snapshot.
+     */
+    BasicSequenceFeature getFeature(size_t i) const;
+
+    /**
+     * @brief Add the features with the given indices to a set.
+     */
+    void getFeatures(const std::vector<size_t>& indices, SequenceFeatureSet& features) const;
+
+    /**
+     * @brief Load the whole set.
+     *
+     * The index of the set is restored from the snapshot, if the set is empty beforehand.
+     *
+     * @param features [out] The set where features are added.
+     */
+    void load(SequenceFeatureSet& features) const;
+
+    std::set<std::string> getSequences() const;
+    std::set<std::string> getTypes() const;
+    bool hasSequence(const std::string& seqId) const;
+
+    /**
+     * @name Index queries, with the same semantics as in SequenceFeatureSet.
+     *
+     * Indices are appended in set order.
+     *
+     * @{
+     */
+    void getIndicesForRange(const std::string& seqId, const Range<size_t>& range, bool complete, std::vector<size_t>& indices) const;
+    void getIndicesForSequence(const std::string& seqId, std::vector<size_t>& indices) const;
+    void getIndicesForType(const std::string& type, std::vector<size_t>& indices) const;
+    /** @} */
+
+  private:
+    size_t getStringLength_(uint64_t id) const { return static_cast<size_t>(stringOffsets_[id + 1] - stringOffsets_[id]); }
+    const char* getString_(uint64_t id) const { return strings_ + stringOffsets_[id]; }
+    std::string toString_(uint64_t id) const { return std::string(getString_(id), getStringLength_(id)); }
+    bool equals_(uint64_t id, const std::string& s) const;
+    const SequenceRecord_* findSequence_(const std::string& seqId) const;
+    const uint64_t* getArray_(uint64_t offset) const { return reinterpret_cast<const uint64_t*>(data_ + offset); }
+    void check_(bool test, const std::string& what) const;
+    bool fits_(uint64_t offset, uint64_t count, size_t recordSize) const;
+    void checkIndices_(const uint64_t* indices, uint64_t n) const;
+    void checkRecords_() const;
+
+    /**
+     * @param keyIds A cache of the attribute identifiers of each attribute name, in the current process.
+     */
+    BasicSequenceFeature* newFeature_(size_t i, std::unordered_map<uint64_t, size_t>& keyIds) const;
+};
+
+} //end of namespace bpp
+
+#endif //_SEQUENCEFEATURECACHE_H_
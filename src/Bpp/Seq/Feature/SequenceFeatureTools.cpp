@@ -47,9 +47,25 @@ knowledge of the CeCILL license and that you accept its terms.
 
 //From STL
 #include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <algorithm>
+#include <functional>
+#include <set>
 
 using namespace bpp;
 
+const short SequenceFeatureTools::STRAND_IGNORE = 0;
+const short SequenceFeatureTools::STRAND_SAME = 1;
+const short SequenceFeatureTools::STRAND_OPPOSITE = 2;
+
+const short SequenceFeatureTools::JOIN_OVERLAP = 0;
+const short SequenceFeatureTools::JOIN_A_IN_B = 1;
+const short SequenceFeatureTools::JOIN_B_IN_A = 2;
+
 /******************************************************************************/
 
 Sequence* SequenceFeatureTools::extract(const Sequence& seq, const SeqRange& range)
@@ -78,38 +94,349 @@ void SequenceFeatureTools::extract(const Sequence& seq, const SeqRange& range, S
 
 unsigned int SequenceFeatureTools::getOrfs(const Sequence& seq, SequenceFeatureSet& featSet, const GeneticCode& gCode)
 {
-  if (! AlphabetTools::isNucleicAlphabet(seq.getAlphabet())) {
-    throw AlphabetException("SequenceFeatureTools::getOrfs: Sequence alphabet must be nucleic!", seq.getAlphabet());
+  OrfScanner scanner(gCode, 0, false, true);
+  return static_cast<unsigned int>(scanner.scan(seq, featSet));
+}
+
+/******************************************************************************/
+
+namespace {
+
+/**
+ * Order features by sequence, then (optionally) strand, then start and end positions.
+ */
+struct FeatureOrder_
+{
+  const SequenceFeatureSet* features;
+  bool withStrand;
+  static char strandKey(const SequenceFeature& f) {
+    return f.isStranded() ? (f.isNegativeStrand() ? '-' : '+') : '.';
   }
-  unsigned int orfCpt = 0;
-  const CodonAlphabet* codonAlpha = gCode.getSourceAlphabet();
-  std::vector< std::vector<size_t> > starts(3), stops(3);
-  size_t phase = 0;
-  for (size_t p = 0 ; p < seq.size() - 2 ; p++) {
-    phase = p % 3;
-    if (gCode.isStart(codonAlpha->getCodon(seq.getValue(p), seq.getValue(p + 1), seq.getValue(p + 2)))) {
-      starts[phase].push_back(p);
-      //std::cerr << "Start: " << p << " (" << phase << ")" << std::endl;
-    } else if (gCode.isStop(codonAlpha->getCodon(seq.getValue(p), seq.getValue(p + 1), seq.getValue(p + 2)))) {
-      stops[phase].push_back(p);
-      //std::cerr << "Stop:  " << p << " (" << phase << ")" << std::endl;
+  bool operator()(size_t i, size_t j) const {
+    const SequenceFeature& fi = (*features)[i];
+    const SequenceFeature& fj = (*features)[j];
+    int c = fi.getSequenceId().compare(fj.getSequenceId());
+    if (c != 0) return c < 0;
+    if (withStrand) {
+      char si = strandKey(fi), sj = strandKey(fj);
+      if (si != sj) return si < sj;
     }
+    if (fi.getStart() != fj.getStart()) return fi.getStart() < fj.getStart();
+    if (fi.getEnd() != fj.getEnd()) return fi.getEnd() < fj.getEnd();
+    return i < j;
   }
-  for (size_t i = 0 ; i < 3 ; ++i) {
-    std::vector< size_t >::iterator start(starts[i].begin()), stop(stops[i].begin());
-    while (stop != stops[i].end() && start != starts[i].end()) {
-      if (*stop < *start) {
-        stop++;
+};
+
+void sortFeatures_(const SequenceFeatureSet& features, bool withStrand, std::vector<size_t>& order)
+{
+  order.resize(features.getNumberOfFeatures());
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  FeatureOrder_ comp;
+  comp.features = &features;
+  comp.withStrand = withStrand;
+  std::sort(order.begin(), order.end(), comp);
+}
+
+}
+
+bool SequenceFeatureTools::strandMatch_(const SequenceFeature& a, const SequenceFeature& b, short strandMode)
+{
+  if (strandMode == STRAND_SAME)
+    return a.isStranded() == b.isStranded() && a.isNegativeStrand() == b.isNegativeStrand();
+  if (strandMode == STRAND_OPPOSITE)
+    return a.isStranded() && b.isStranded() && a.isNegativeStrand() != b.isNegativeStrand();
+  return true;
+}
+
+void SequenceFeatureTools::sweep_(const SequenceFeatureSet& featuresA, const SequenceFeatureSet& featuresB,
+    std::function<void (size_t, const std::vector<size_t>&)> handler, short strandMode, short mode, bool all)
+{
+  if (strandMode != STRAND_IGNORE && strandMode != STRAND_SAME && strandMode != STRAND_OPPOSITE)
+    throw Exception("SequenceFeatureTools::overlapJoin. Unknown strand mode.");
+  if (mode != JOIN_OVERLAP && mode != JOIN_A_IN_B && mode != JOIN_B_IN_A)
+    throw Exception("SequenceFeatureTools::overlapJoin. Unknown join mode.");
+  std::vector<size_t> orderA, orderB;
+  sortFeatures_(featuresA, false, orderA);
+  sortFeatures_(featuresB, false, orderB);
+  size_t m = orderB.size();
+  size_t j = 0;
+  //Active features of the second set, as (end position, rank in orderB), in a min-heap on end positions:
+  std::vector< std::pair<size_t, size_t> > active;
+  std::greater< std::pair<size_t, size_t> > endOrder;
+  std::vector<size_t> ranks, matches;
+  const std::string* seqId = 0;
+  for (size_t k = 0; k < orderA.size(); ++k) {
+    const SequenceFeature& a = featuresA[orderA[k]];
+    if (!seqId || a.getSequenceId() != *seqId) {
+      //New sequence, move to its first feature in the second set:
+      seqId = &a.getSequenceId();
+      active.clear();
+      while (j < m && featuresB[orderB[j]].getSequenceId() < *seqId)
+        ++j;
+    }
+    //Features starting before the end of the current one become active:
+    while (j < m && featuresB[orderB[j]].getStart() < a.getEnd() && featuresB[orderB[j]].getSequenceId() == *seqId) {
+      active.push_back(std::make_pair(featuresB[orderB[j]].getEnd(), j));
+      std::push_heap(active.begin(), active.end(), endOrder);
+      ++j;
+    }
+    //Features ending before its start can no longer match, as the next ones start later:
+    while (!active.empty() && active.front().first <= a.getStart()) {
+      std::pop_heap(active.begin(), active.end(), endOrder);
+      active.pop_back();
+    }
+
+    ranks.clear();
+    for (size_t l = 0; l < active.size(); ++l) {
+      const SequenceFeature& b = featuresB[orderB[active[l].second]];
+      if (b.getStart() >= a.getEnd()) continue;
+      if (mode == JOIN_A_IN_B && (a.getStart() < b.getStart() || a.getEnd() > b.getEnd())) continue;
+      if (mode == JOIN_B_IN_A && (b.getStart() < a.getStart() || b.getEnd() > a.getEnd())) continue;
+      if (!strandMatch_(a, b, strandMode)) continue;
+      ranks.push_back(active[l].second);
+    }
+    //Matches are reported by increasing start position:
+    std::sort(ranks.begin(), ranks.end());
+    matches.resize(ranks.size());
+    for (size_t l = 0; l < ranks.size(); ++l)
+      matches[l] = orderB[ranks[l]];
+    if (all || !matches.empty())
+      handler(orderA[k], matches);
+  }
+}
+
+void SequenceFeatureTools::overlapJoin(const SequenceFeatureSet& featuresA, const SequenceFeatureSet& featuresB,
+    JoinHandler handler, short strandMode, short mode)
+{
+  sweep_(featuresA, featuresB, [&handler](size_t i, const std::vector<size_t>& matches) {
+      for (size_t l = 0; l < matches.size(); ++l)
+        handler(i, matches[l]);
+    }, strandMode, mode, false);
+}
+
+void SequenceFeatureTools::overlapJoin(const SequenceFeatureSet& featuresA, const SequenceFeatureSet& featuresB,
+    std::vector< std::pair<size_t, size_t> >& pairs, short strandMode, short mode)
+{
+  overlapJoin(featuresA, featuresB, [&pairs](size_t i, size_t j) {
+      pairs.push_back(std::make_pair(i, j));
+    }, strandMode, mode);
+}
+
+BasicSequenceFeature* SequenceFeatureTools::copyWithRange_(const SequenceFeature& feature, size_t start, size_t end)
+{
+  BasicSequenceFeature* copy = new BasicSequenceFeature(
+      feature.getId(), feature.getSequenceId(), feature.getSource(), feature.getType(),
+      start, end, feature.getRange().getStrand(), feature.getScore());
+  const BasicSequenceFeature* basic = dynamic_cast<const BasicSequenceFeature*>(&feature);
+  if (basic) {
+    for (size_t i = 0; i < basic->getNumberOfAttributes(); ++i)
+      copy->setAttribute(basic->getAttributeKeyId(i), basic->getAttributeValue(i));
+  } else {
+    std::set<std::string> names = feature.getAttributeList();
+    for (std::set<std::string>::const_iterator it = names.begin(); it != names.end(); ++it)
+      copy->setAttribute(*it, feature.getAttribute(*it));
+  }
+  return copy;
+}
+
+void SequenceFeatureTools::intersect(const SequenceFeatureSet& featuresA, const SequenceFeatureSet& featuresB,
+    SequenceFeatureSet& result, short strandMode)
+{
+  sweep_(featuresA, featuresB, [&](size_t i, const std::vector<size_t>& matches) {
+      const SequenceFeature& a = featuresA[i];
+      for (size_t l = 0; l < matches.size(); ++l) {
+        const SequenceFeature& b = featuresB[matches[l]];
+        result.addFeature(std::unique_ptr<SequenceFeature>(copyWithRange_(a,
+                std::max(a.getStart(), b.getStart()), std::min(a.getEnd(), b.getEnd()))));
+      }
+    }, strandMode, JOIN_OVERLAP, false);
+}
+
+void SequenceFeatureTools::subtract(const SequenceFeatureSet& featuresA, const SequenceFeatureSet& featuresB,
+    SequenceFeatureSet& result, short strandMode)
+{
+  sweep_(featuresA, featuresB, [&](size_t i, const std::vector<size_t>& matches) {
+      const SequenceFeature& a = featuresA[i];
+      if (matches.empty()) {
+        result.addFeature(a);
+        return;
+      }
+      //Matches come by increasing start position:
+      size_t pos = a.getStart();
+      for (size_t l = 0; l < matches.size(); ++l) {
+        const SequenceFeature& b = featuresB[matches[l]];
+        if (b.getStart() > pos)
+          result.addFeature(std::unique_ptr<SequenceFeature>(copyWithRange_(a, pos, b.getStart())));
+        pos = std::max(pos, b.getEnd());
+      }
+      if (pos < a.getEnd())
+        result.addFeature(std::unique_ptr<SequenceFeature>(copyWithRange_(a, pos, a.getEnd())));
+    }, strandMode, JOIN_OVERLAP, true);
+}
+
+void SequenceFeatureTools::merge(const SequenceFeatureSet& features, SequenceFeatureSet& result, short strandMode)
+{
+  if (strandMode != STRAND_IGNORE && strandMode != STRAND_SAME)
+    throw Exception("SequenceFeatureTools::merge. Strand mode should be STRAND_IGNORE or STRAND_SAME.");
+  bool withStrand = (strandMode == STRAND_SAME);
+  std::vector<size_t> order;
+  sortFeatures_(features, withStrand, order);
+  size_t k = 0;
+  while (k < order.size()) {
+    const SequenceFeature& first = features[order[k]];
+    char strand = withStrand ? FeatureOrder_::strandKey(first) : '.';
+    size_t start = first.getStart(), end = first.getEnd();
+    for (++k; k < order.size(); ++k) {
+      const SequenceFeature& f = features[order[k]];
+      if (f.getSequenceId() != first.getSequenceId() || (withStrand && FeatureOrder_::strandKey(f) != strand) || f.getStart() > end)
+        break;
+      end = std::max(end, f.getEnd());
+    }
+    result.addFeature(std::unique_ptr<SequenceFeature>(new BasicSequenceFeature("", first.getSequenceId(), "Bio++", "region", start, end, strand)));
+  }
+}
+
+/******************************************************************************/
+
+OrfScanner::OrfScanner(const GeneticCode& gCode, size_t minLength, bool bothStrands, bool nestedStarts):
+  minLength_(minLength), bothStrands_(bothStrands), nestedStarts_(nestedStarts)
+{
+  const CodonAlphabet* codonAlpha = gCode.getSourceAlphabet();
+  unsigned char forward[64];
+  for (int c = 0; c < 64; ++c) {
+    int codon = codonAlpha->getCodon(c >> 4, (c >> 2) & 3, c & 3);
+    forward[c] = static_cast<unsigned char>((gCode.isStart(codon) ? 1 : 0) | (gCode.isStop(codon) ? 2 : 0));
+  }
+  for (int c = 0; c < 64; ++c) {
+    //Reverse complement, with nucleotides coded A=0, C=1, G=2, T/U=3:
+    int rc = ((3 - (c & 3)) << 4) | ((3 - ((c >> 2) & 3)) << 2) | (3 - (c >> 4));
+    codonFlags_[c] = static_cast<unsigned char>(forward[c] | (forward[rc] << 2));
+  }
+}
+
+namespace {
+
+struct OrfFrame_
+{
+  std::vector<size_t> starts; //Forward starts waiting for a stop.
+  bool hasStop;               //Reverse strand: a stop was found in this frame.
+  size_t lastStop;
+  bool hasBest;               //Reverse strand: a start was found after the last stop.
+  size_t best;
+  OrfFrame_(): starts(), hasStop(false), lastStop(0), hasBest(false), best(0) {}
+};
+
+}
+
+size_t OrfScanner::scan(const Sequence& seq, SequenceFeatureSet& features) const
+{
+  if (! AlphabetTools::isNucleicAlphabet(seq.getAlphabet())) {
+    throw AlphabetException("OrfScanner::scan: Sequence alphabet must be nucleic!", seq.getAlphabet());
+  }
+  const std::vector<int>& content = seq.getContent();
+  size_t n = content.size();
+  OrfFrame_ frames[3];
+  std::vector< std::pair<size_t, size_t> > orfs[6]; //Forward frames, then reverse ones.
+  unsigned int code = 0;
+  size_t valid = 0;
+  size_t frame = 0; //i % 3
+  for (size_t i = 0; i < n; ++i, frame = (frame == 2 ? 0 : frame + 1)) {
+    int x = content[i];
+    if (x < 0 || x > 3) {
+      valid = 0;
+      continue;
+    }
+    code = ((code << 2) | static_cast<unsigned int>(x)) & 63;
+    if (++valid < 3) continue;
+    unsigned char flags = codonFlags_[code];
+    if (!flags) continue;
+    size_t p = i - 2; //First position of the codon.
+    size_t f = (frame == 2 ? 0 : frame + 1);
+    OrfFrame_& fr = frames[f];
+    if (flags & 2) {
+      //ORFs are closed by the stop:
+      for (size_t k = 0; k < fr.starts.size(); ++k)
+        if (p + 2 - fr.starts[k] >= minLength_)
+          orfs[f].push_back(std::make_pair(fr.starts[k], p + 2));
+      fr.starts.clear();
+    } else if ((flags & 1) && (nestedStarts_ || fr.starts.empty())) {
+      fr.starts.push_back(p);
+    }
+    if (!bothStrands_) continue;
+    //On the reverse strand, the stop comes first, and the start which is the furthest from it gives the longest ORF:
+    if (flags & 8) {
+      if (fr.hasBest && fr.best + 3 - (fr.lastStop + 1) >= minLength_)
+        orfs[3 + f].push_back(std::make_pair(fr.lastStop + 1, fr.best + 3));
+      fr.hasBest = false;
+      fr.hasStop = true;
+      fr.lastStop = p;
+    } else if ((flags & 4) && fr.hasStop) {
+      if (nestedStarts_) {
+        if (p + 3 - (fr.lastStop + 1) >= minLength_)
+          orfs[3 + f].push_back(std::make_pair(fr.lastStop + 1, p + 3));
       } else {
-        orfCpt++;
-        //std::cerr << "ORF:  " << *start << " - " << *stop + 2 << " (" << i << ")" << std::endl;
-        bpp::BasicSequenceFeature feat("", seq.getName(), "Bio++", "CDS", *start, *stop + 2, '+');
-        featSet.addFeature(feat);
-        start++;
+        fr.hasBest = true;
+        fr.best = p;
       }
     }
   }
-  return orfCpt;
+  for (size_t f = 0; f < 3; ++f) {
+    const OrfFrame_& fr = frames[f];
+    if (fr.hasBest && fr.best + 3 - (fr.lastStop + 1) >= minLength_)
+      orfs[3 + f].push_back(std::make_pair(fr.lastStop + 1, fr.best + 3));
+  }
+
+  size_t nbOrfs = 0;
+  for (size_t f = 0; f < 6; ++f)
+    nbOrfs += orfs[f].size();
+  features.reserve(features.getNumberOfFeatures() + nbOrfs);
+  for (size_t f = 0; f < 6; ++f) {
+    for (size_t k = 0; k < orfs[f].size(); ++k) {
+      features.addFeature(std::unique_ptr<SequenceFeature>(new BasicSequenceFeature(
+              "", seq.getName(), "Bio++", "CDS", orfs[f][k].first, orfs[f][k].second, f < 3 ? '+' : '-')));
+    }
+  }
+  return nbOrfs;
+}
+
+size_t OrfScanner::scan(const SequenceContainer& sequences, SequenceFeatureSet& features, unsigned int nbThreads) const
+{
+  size_t nbSeqs = sequences.getNumberOfSequences();
+  if (nbThreads == 0)
+    nbThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  if (nbThreads > nbSeqs)
+    nbThreads = static_cast<unsigned int>(std::max(nbSeqs, static_cast<size_t>(1)));
+  std::vector<SequenceFeatureSet> results(nbSeqs);
+  std::atomic<size_t> next(0);
+  std::exception_ptr error;
+  std::mutex errorMutex;
+  auto worker = [&]() {
+    try {
+      for (size_t i = next++; i < nbSeqs; i = next++)
+        scan(sequences.getSequence(i), results[i]);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if (!error) error = std::current_exception();
+      next = nbSeqs;
+    }
+  };
+  std::vector<std::thread> threads;
+  for (unsigned int t = 1; t < nbThreads; ++t)
+    threads.push_back(std::thread(worker));
+  worker();
+  for (size_t t = 0; t < threads.size(); ++t)
+    threads[t].join();
+  if (error)
+    std::rethrow_exception(error);
+
+  size_t nbOrfs = 0;
+  for (size_t i = 0; i < nbSeqs; ++i) {
+    nbOrfs += results[i].getNumberOfFeatures();
+    features.transferFeatures(results[i]);
+  }
+  return nbOrfs;
 }
 
 /******************************************************************************/
+
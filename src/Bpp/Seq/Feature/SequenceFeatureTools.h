@@ -44,12 +44,98 @@ knowledge of the CeCILL license and that you accept its terms.
 
 //From bpp-seq:
 #include <Bpp/Seq/Sequence.h>
+#include <Bpp/Seq/Container/SequenceContainer.h>
 #include <Bpp/Seq/GeneticCode/GeneticCode.h>
 
+//From the STL:
+#include <vector>
+#include <functional>
+
 namespace bpp {
 
+/**
+ * @brief A fast ORF finder, scanning the six reading frames of nucleic sequences.
+ *
+ * Start and stop codons of the genetic code are tabulated once, for both strands, using 2-bit
+ * codon indexes. Each sequence is then read in a single pass, with a rolling codon index, and
+ * all six frames are processed together. ORFs are filtered by length during the scan.
+ *
+ * An ORF runs from a start codon to the next stop codon in the same frame. With nested starts,
+ * every start codon before a stop gives an ORF, otherwise only the first one (the longest ORF)
+ * is reported. Codons containing gaps or ambiguous characters are neither starts nor stops.
+ *
+ * ORFs are returned as "CDS" features with source "Bio++", ordered by strand, frame and start position.
+ * Coordinates follow SequenceFeatureTools::getOrfs: the last position of the stop codon is not included.
+ */
+class OrfScanner
+{
+  private:
+    //For each codon index: 1 = start, 2 = stop, 4 = start on the reverse strand, 8 = stop on the reverse strand.
+    unsigned char codonFlags_[64];
+    size_t minLength_;
+    bool bothStrands_;
+    bool nestedStarts_;
+
+  public:
+    /**
+     * @param gCode The genetic code to use.
+     * @param minLength The minimum length of the ORFs to report, in nucleotides.
+     * @param bothStrands Tell if the reverse strand should also be scanned.
+     * @param nestedStarts Tell if all start codons should give an ORF, or only the first one before each stop.
+     */
+    OrfScanner(const GeneticCode& gCode, size_t minLength = 0, bool bothStrands = true, bool nestedStarts = false);
+
+  public:
+    /**
+     * @brief Find the ORFs of a sequence.
+     *
+     * @param seq The sequence to scan. Must be a nucleic sequence.
+     * @param features [out] The set where ORFs are added.
+     * @return The number of ORFs found.
+     */
+    size_t scan(const Sequence& seq, SequenceFeatureSet& features) const;
+
+    /**
+     * @brief Find the ORFs of several sequences, in parallel.
+     *
+     * Each thread fills its own feature sets, which are then appended to the output in sequence order.
+     *
+     * @param sequences The sequences to scan. Must be nucleic sequences.
+     * @param features [out] The set where ORFs are added.
+     * @param nbThreads The number of threads to use (0 means one per available core).
+     * @return The number of ORFs found.
+     */
+    size_t scan(const SequenceContainer& sequences, SequenceFeatureSet& features, unsigned int nbThreads = 0) const;
+};
+
 class SequenceFeatureTools
 {
+  public:
+    /**
+     * @name Strand modes for joins.
+     *
+     * @{
+     */
+    static const short STRAND_IGNORE;
+    static const short STRAND_SAME;
+    static const short STRAND_OPPOSITE;
+    /** @} */
+
+    /**
+     * @name Matching modes for joins.
+     *
+     * @{
+     */
+    static const short JOIN_OVERLAP;    //Features overlap by at least one position.
+    static const short JOIN_A_IN_B;     //The feature of the first set is included in the one of the second set.
+    static const short JOIN_B_IN_A;     //The feature of the second set is included in the one of the first set.
+    /** @} */
+
+    /**
+     * @brief A function called on each pair of matching features, with their indices in the first and second set.
+     */
+    typedef std::function<void (size_t, size_t)> JoinHandler;
+
   public:
     /**
      * @brief Extract a sub-sequence given a SeqRange.
@@ -82,6 +168,9 @@ class SequenceFeatureTools
     /**
      * @brief Get ORF features for a Sequence.
      *
+     * Only the forward strand is scanned, and all nested ORFs are reported.
+     * See OrfScanner for more options, and for scanning many sequences.
+     *
      * @param seq The Sequence where to find ORF. Must be a nucleic sequence.
      * @param featSet A SequenceFeatureSet to fill with the annotations.
      * @param gCode The genetic code to use.
@@ -92,6 +181,91 @@ class SequenceFeatureTools
         SequenceFeatureSet& featSet,
         const GeneticCode& gCode);
 
+    /**
+     * @brief Find all pairs of matching features between two sets.
+     *
+     * Both sets are sorted once by sequence and start position, and pairs are found with
+     * a sweep line, in O((n + m) log(n + m) + k) time for k pairs. Pairs are reported by
+     * sequence name, then by start position of the feature of the first set, then by start
+     * position of the feature of the second set.
+     *
+     * @param featuresA The first set.
+     * @param featuresB The second set.
+     * @param handler A function called on each pair.
+     * @param strandMode One of STRAND_IGNORE, STRAND_SAME or STRAND_OPPOSITE.
+     * With STRAND_OPPOSITE, only stranded features can match.
+     * @param mode One of JOIN_OVERLAP, JOIN_A_IN_B or JOIN_B_IN_A.
+     */
+    static void overlapJoin(const SequenceFeatureSet& featuresA, const SequenceFeatureSet& featuresB,
+        JoinHandler handler, short strandMode = STRAND_IGNORE, short mode = JOIN_OVERLAP);
+
+    /**
+     * @brief Find all pairs of matching features between two sets.
+     *
+     * @param pairs [out] A vector where the pairs of indices are appended.
+     * @see overlapJoin(const SequenceFeatureSet&, const SequenceFeatureSet&, JoinHandler, short, short)
+     */
+    static void overlapJoin(const SequenceFeatureSet& featuresA, const SequenceFeatureSet& featuresB,
+        std::vector< std::pair<size_t, size_t> >& pairs, short strandMode = STRAND_IGNORE, short mode = JOIN_OVERLAP);
+
+    /**
+     * @brief Intersect two sets.
+     *
+     * For each pair of overlapping features, the part of the feature of the first set that overlaps
+     * the second one is added to the result, with the same id, type, strand, score and attributes.
+     *
+     * @param featuresA The features to intersect.
+     * @param featuresB The features to intersect with.
+     * @param result [out] The set where intersections are added.
+     * @param strandMode One of STRAND_IGNORE, STRAND_SAME or STRAND_OPPOSITE.
+     */
+    static void intersect(const SequenceFeatureSet& featuresA, const SequenceFeatureSet& featuresB,
+        SequenceFeatureSet& result, short strandMode = STRAND_IGNORE);
+
+    /**
+     * @brief Subtract a set from another one.
+     *
+     * For each feature of the first set, the parts not covered by any feature of the second set
+     * are added to the result, with the same id, type, strand, score and attributes. Features
+     * are processed by sequence and start position.
+     *
+     * @param featuresA The features to subtract from.
+     * @param featuresB The features to subtract.
+     * @param result [out] The set where remaining parts are added.
+     * @param strandMode One of STRAND_IGNORE, STRAND_SAME or STRAND_OPPOSITE.
+     */
+    static void subtract(const SequenceFeatureSet& featuresA, const SequenceFeatureSet& featuresB,
+        SequenceFeatureSet& result, short strandMode = STRAND_IGNORE);
+
+    /**
+     * @brief Merge overlapping and adjacent features.
+     *
+     * Each group of features overlapping or touching each other is replaced by a new feature
+     * of type "region" and source "Bio++", spanning the whole group, with an empty id.
+     *
+     * @param features The features to merge.
+     * @param result [out] The set where merged features are added, by sequence and start position.
+     * @param strandMode STRAND_IGNORE to merge features regardless of their strand,
+     * or STRAND_SAME to merge each strand separately.
+     */
+    static void merge(const SequenceFeatureSet& features, SequenceFeatureSet& result, short strandMode = STRAND_IGNORE);
+
+  private:
+    /**
+     * @brief Sweep two sets, calling a function for each feature of the first set, with the matching features of the second one.
+     *
+     * @param all Tell if features of the first set without any match should also be reported.
+     */
+    static void sweep_(const SequenceFeatureSet& featuresA, const SequenceFeatureSet& featuresB,
+        std::function<void (size_t, const std::vector<size_t>&)> handler, short strandMode, short mode, bool all);
+
+    static bool strandMatch_(const SequenceFeature& a, const SequenceFeature& b, short strandMode);
+
+    /**
+     * @return A copy of a feature, with new coordinates.
+     */
+    static BasicSequenceFeature* copyWithRange_(const SequenceFeature& feature, size_t start, size_t end);
+
 };
 
 } //end of namespace bpp
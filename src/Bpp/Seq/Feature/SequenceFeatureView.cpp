@@ -0,0 +1,133 @@
+//
+// File: SequenceFeatureView.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "SequenceFeatureView.h"
+
+using namespace bpp;
+
+//From the STL:
+#include <algorithm>
+
+using namespace std;
+
+SequenceFeatureView SequenceFeatureView::intersect_(const std::vector<size_t>& indices) const
+{
+  if (all_)
+    return SequenceFeatureView(*set_, indices);
+  vector<size_t> common;
+  set_intersection(indices_.begin(), indices_.end(), indices.begin(), indices.end(), back_inserter(common));
+  return SequenceFeatureView(*set_, common);
+}
+
+SequenceFeatureView SequenceFeatureView::ofType(const std::string& type) const
+{
+  if (set_->isIndexed() && (all_ || indices_.size() > set_->getNumberOfFeatures() / 8)) {
+    vector<size_t> indices;
+    set_->getIndicesForType(type, indices);
+    return intersect_(indices);
+  }
+  return filter_([&type](const SequenceFeature& f) { return f.getType() == type; });
+}
+
+SequenceFeatureView SequenceFeatureView::ofTypes(const std::vector<std::string>& types) const
+{
+  return filter_([&types](const SequenceFeature& f) { return find(types.begin(), types.end(), f.getType()) != types.end(); });
+}
+
+SequenceFeatureView SequenceFeatureView::ofSequence(const std::string& seqId) const
+{
+  if (set_->isIndexed() && (all_ || indices_.size() > set_->getNumberOfFeatures() / 8)) {
+    vector<size_t> indices;
+    set_->getIndicesForSequence(seqId, indices);
+    return intersect_(indices);
+  }
+  return filter_([&seqId](const SequenceFeature& f) { return f.getSequenceId() == seqId; });
+}
+
+SequenceFeatureView SequenceFeatureView::ofSequences(const std::vector<std::string>& seqIds) const
+{
+  return filter_([&seqIds](const SequenceFeature& f) { return find(seqIds.begin(), seqIds.end(), f.getSequenceId()) != seqIds.end(); });
+}
+
+SequenceFeatureView SequenceFeatureView::inRange(const std::string& seqId, const Range<size_t>& range, bool complete) const
+{
+  if (set_->isIndexed()) {
+    //Range queries are cheap with the index, even for a small view:
+    vector<size_t> indices;
+    set_->getIndicesForRange(seqId, range, complete, indices);
+    return intersect_(indices);
+  }
+  SeqRange r(range);
+  return filter_([&seqId, &r, complete](const SequenceFeature& f) {
+      return f.getSequenceId() == seqId && (complete ? f.isIncludedIn(r) : f.overlap(r));
+  });
+}
+
+SequenceFeatureView SequenceFeatureView::inRange(const Range<size_t>& range, bool complete) const
+{
+  SeqRange r(range);
+  return filter_([&r, complete](const SequenceFeature& f) {
+      return complete ? f.isIncludedIn(r) : f.overlap(r);
+  });
+}
+
+std::set<std::string> SequenceFeatureView::getSequences() const
+{
+  std::set<std::string> seqIds;
+  for (size_t i = 0; i < getNumberOfFeatures(); ++i)
+    seqIds.insert(getFeature(i).getSequenceId());
+  return seqIds;
+}
+
+std::set<std::string> SequenceFeatureView::getTypes() const
+{
+  std::set<std::string> types;
+  for (size_t i = 0; i < getNumberOfFeatures(); ++i)
+    types.insert(getFeature(i).getType());
+  return types;
+}
+
+SequenceFeatureSet* SequenceFeatureView::materialize() const
+{
+  SequenceFeatureSet* subset = new SequenceFeatureSet();
+  subset->reserve(getNumberOfFeatures());
+  for (size_t i = 0; i < getNumberOfFeatures(); ++i)
+    subset->addFeature(getFeature(i));
+  return subset;
+}
@@ -0,0 +1,212 @@
+//
+// File: SequenceFeatureView.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _SEQUENCEFEATUREVIEW_H_
+#define _SEQUENCEFEATUREVIEW_H_
+
+#include "SequenceFeature.h"
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <set>
+#include <iterator>
+#include <cstddef>
+
+namespace bpp {
+
+/**
+ * @brief A read-only selection of features from a SequenceFeatureSet, without copy.
+ *
+ * A view stores the indices of the selected features in the parent set, which must outlive it
+ * and must not be modified while the view is in use. Views are cheap to create and can be chained,
+ * for instance:
+ * @code
+ * SequenceFeatureView exons = SequenceFeatureView(features).ofType("exon").ofSequence("chr1");
+ * for (SequenceFeatureView::const_iterator it = exons.begin(); it != exons.end(); ++it)
+ *   ...
+ * @endcode
+ * When the view covers the complete parent set and the set is indexed (see SequenceFeatureSet::buildIndex),
+ * selections use the index. Otherwise, they scan the features of the view. Features are always
+ * iterated in the order of the parent set. A new set with copies of the features can be obtained
+ * with materialize().
+ */
+class SequenceFeatureView
+{
+  private:
+    const SequenceFeatureSet* set_;
+    std::vector<size_t> indices_;
+    bool all_; //If true, the view contains all features of the set, and indices_ is not used.
+
+  public:
+    class const_iterator
+    {
+      public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef const SequenceFeature value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const SequenceFeature* pointer;
+        typedef const SequenceFeature& reference;
+
+      private:
+        const SequenceFeatureView* view_;
+        size_t pos_;
+
+      public:
+        const_iterator(const SequenceFeatureView* view, size_t pos): view_(view), pos_(pos) {}
+
+      public:
+        const SequenceFeature& operator*() const { return view_->getFeature(pos_); }
+        const SequenceFeature* operator->() const { return &view_->getFeature(pos_); }
+        const_iterator& operator++() { ++pos_; return *this; }
+        const_iterator operator++(int) { const_iterator tmp(*this); ++pos_; return tmp; }
+        bool operator==(const const_iterator& it) const { return pos_ == it.pos_ && view_ == it.view_; }
+        bool operator!=(const const_iterator& it) const { return !(*this == it); }
+    };
+
+  public:
+    /**
+     * @brief Build a view on all features of a set.
+     */
+    SequenceFeatureView(const SequenceFeatureSet& set):
+      set_(&set), indices_(), all_(true) {}
+
+    /**
+     * @brief Build a view on selected features of a set.
+     *
+     * @param set The parent set.
+     * @param indices The indices of the features in the set, in increasing order.
+     */
+    SequenceFeatureView(const SequenceFeatureSet& set, const std::vector<size_t>& indices):
+      set_(&set), indices_(indices), all_(false) {}
+
+  public:
+    const SequenceFeatureSet& getParentSet() const { return *set_; }
+
+    size_t getNumberOfFeatures() const { return all_ ? set_->getNumberOfFeatures() : indices_.size(); }
+
+    bool isEmpty() const { return getNumberOfFeatures() == 0; }
+
+    /**
+     * @return The index in the parent set of the ith feature of the view.
+     */
+    size_t getIndex(size_t i) const { return all_ ? i : indices_[i]; }
+
+    const SequenceFeature& getFeature(size_t i) const { return set_->getFeature(getIndex(i)); }
+
+    const SequenceFeature& operator[](size_t i) const { return getFeature(i); }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, getNumberOfFeatures()); }
+
+    /**
+     * @return A view with the features of this view with the given type.
+     */
+    SequenceFeatureView ofType(const std::string& type) const;
+
+    /**
+     * @return A view with the features of this view with any of the given types.
+     */
+    SequenceFeatureView ofTypes(const std::vector<std::string>& types) const;
+
+    /**
+     * @return A view with the features of this view on the given sequence.
+     */
+    SequenceFeatureView ofSequence(const std::string& seqId) const;
+
+    /**
+     * @return A view with the features of this view on any of the given sequences.
+     */
+    SequenceFeatureView ofSequences(const std::vector<std::string>& seqIds) const;
+
+    /**
+     * @param seqId The sequence id.
+     * @param range The range to look for.
+     * @param complete If true, only features fully included in the range are kept, otherwise all overlapping features are.
+     * @return A view with the features of this view on the given sequence and range.
+     */
+    SequenceFeatureView inRange(const std::string& seqId, const Range<size_t>& range, bool complete) const;
+
+    /**
+     * @brief Range selection, regardless of the sequence, as in SequenceFeatureSet::getSubsetForRange.
+     */
+    SequenceFeatureView inRange(const Range<size_t>& range, bool complete) const;
+
+    /**
+     * @return The set of sequence ids of the features in this view.
+     */
+    std::set<std::string> getSequences() const;
+
+    /**
+     * @return The set of types of the features in this view.
+     */
+    std::set<std::string> getTypes() const;
+
+    /**
+     * @brief Add the coordinates of all features in this view to a RangeCollection container.
+     */
+    void fillRangeCollection(RangeCollection<size_t>& coords) const {
+      for (size_t i = 0; i < getNumberOfFeatures(); ++i)
+        coords.addRange(getFeature(i).getRange());
+    }
+
+    /**
+     * @return A new set with copies of all features in this view.
+     */
+    SequenceFeatureSet* materialize() const;
+
+  private:
+    template<class Predicate>
+    SequenceFeatureView filter_(Predicate predicate) const {
+      std::vector<size_t> indices;
+      for (size_t i = 0; i < getNumberOfFeatures(); ++i)
+        if (predicate(getFeature(i)))
+          indices.push_back(getIndex(i));
+      return SequenceFeatureView(*set_, indices);
+    }
+
+    /**
+     * @brief Restrict a sorted list of indices from the parent set to the ones in this view.
+     */
+    SequenceFeatureView intersect_(const std::vector<size_t>& indices) const;
+};
+
+} //end of namespace bpp
+
+#endif //_SEQUENCEFEATUREVIEW_H_
@@ -0,0 +1,222 @@
+//
+// File: AsyncFileWriter.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+
+#include "AsyncFileWriter.h"
+
+#include <Bpp/Exceptions.h>
+#include <Bpp/Text/TextTools.h>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+AsyncFileWriter::AsyncFileWriter(unsigned int nbThreads, size_t maxPending):
+  queue_(), maxPending_(max(maxPending, static_cast<size_t>(1))), workers_(), mutex_(), notEmpty_(), notFull_(),
+  stop_(false), error_(), packed_(false), archivePath_(), archive_(), index_(), archiveOffset_(0), nbRecords_(0), names_()
+{
+  if (nbThreads == 0)
+    nbThreads = max(thread::hardware_concurrency(), 1u);
+  for (unsigned int i = 0; i < nbThreads; ++i)
+    workers_.push_back(thread(&AsyncFileWriter::workerLoop_, this));
+}
+
+AsyncFileWriter::AsyncFileWriter(const std::string& archive, size_t maxPending):
+  queue_(), maxPending_(max(maxPending, static_cast<size_t>(1))), workers_(), mutex_(), notEmpty_(), notFull_(),
+  stop_(false), error_(), packed_(true), archivePath_(archive),
+  archive_(archive.c_str(), ios::out | ios::binary), index_((archive + ".idx").c_str(), ios::out),
+  archiveOffset_(0), nbRecords_(0), names_()
+{
+  if (!archive_ || !index_)
+    throw IOException("AsyncFileWriter (constructor). Cannot create archive " + archive + ".");
+  //Records are written in order by a single thread:
+  workers_.push_back(thread(&AsyncFileWriter::workerLoop_, this));
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+  try {
+    close();
+  } catch (exception& e) {
+    //Destructors must not throw.
+  }
+}
+
+/******************************************************************************/
+
+void AsyncFileWriter::write(const std::string& name, std::string& content)
+{
+  //Names are stored in the tab-separated index:
+  if (name.find_first_of("\t\r\n") != string::npos)
+    throw Exception("AsyncFileWriter::write. Invalid record name: " + name + ".");
+  unique_lock<mutex> lock(mutex_);
+  if (error_)
+    rethrow_exception(error_);
+  if (stop_)
+    throw Exception("AsyncFileWriter::write. Writer is closed.");
+  //Two records with the same name would be written concurrently to the same file, or be ambiguous in the index:
+  if (!names_.insert(name).second)
+    throw Exception("AsyncFileWriter::write. Duplicated record name: " + name + ".");
+  notFull_.wait(lock, [this] { return queue_.size() < maxPending_; });
+  queue_.push_back(Record_());
+  queue_.back().name = name;
+  queue_.back().content.swap(content);
+  notEmpty_.notify_one();
+}
+
+void AsyncFileWriter::close()
+{
+  {
+    lock_guard<mutex> lock(mutex_);
+    stop_ = true;
+  }
+  notEmpty_.notify_all();
+  for (size_t i = 0; i < workers_.size(); ++i)
+    workers_[i].join();
+  workers_.clear();
+  if (packed_) {
+    if (archive_.is_open()) archive_.close();
+    if (index_.is_open()) index_.close();
+  }
+  if (error_) {
+    exception_ptr error = error_;
+    error_ = exception_ptr();
+    rethrow_exception(error);
+  }
+}
+
+size_t AsyncFileWriter::getNumberOfRecords()
+{
+  lock_guard<mutex> lock(mutex_);
+  return nbRecords_;
+}
+
+/******************************************************************************/
+
+void AsyncFileWriter::workerLoop_()
+{
+  Record_ record;
+  while (true) {
+    {
+      unique_lock<mutex> lock(mutex_);
+      notEmpty_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (queue_.empty())
+        return; //Stopped and nothing left to write.
+      record.name.swap(queue_.front().name);
+      record.content.swap(queue_.front().content);
+      queue_.pop_front();
+    }
+    notFull_.notify_one();
+    try {
+      writeRecord_(record);
+    } catch (...) {
+      lock_guard<mutex> lock(mutex_);
+      if (!error_) error_ = current_exception();
+    }
+    lock_guard<mutex> lock(mutex_);
+    nbRecords_++;
+  }
+}
+
+void AsyncFileWriter::writeRecord_(Record_& record)
+{
+  if (packed_) {
+    archive_.write(record.content.data(), static_cast<streamsize>(record.content.size()));
+    index_ << record.name << "\t" << archiveOffset_ << "\t" << record.content.size() << "\n";
+    if (!archive_ || !index_)
+      throw IOException("AsyncFileWriter::writeRecord_. Cannot write record " + record.name + " to archive " + archivePath_ + ".");
+    archiveOffset_ += record.content.size();
+  } else {
+    ofstream output(record.name.c_str(), ios::out | ios::binary);
+    output.write(record.content.data(), static_cast<streamsize>(record.content.size()));
+    if (!output)
+      throw IOException("AsyncFileWriter::writeRecord_. Cannot write file " + record.name + ".");
+  }
+  record.content.clear();
+}
+
+/******************************************************************************/
+
+bool AsyncFileWriter::readRecord(const std::string& archive, const std::string& name, std::string& content)
+{
+  AsyncFileReader reader(archive);
+  return reader.readRecord(name, content);
+}
+
+/******************************************************************************/
+
+AsyncFileReader::AsyncFileReader(const std::string& archive):
+  archivePath_(archive), archive_(archive.c_str(), ios::in | ios::binary), index_()
+{
+  if (!archive_)
+    throw IOException("AsyncFileReader (constructor). Cannot open archive " + archive + ".");
+  ifstream index((archive + ".idx").c_str(), ios::in);
+  if (!index)
+    throw IOException("AsyncFileReader (constructor). Cannot open index of archive " + archive + ".");
+  string line;
+  while (getline(index, line)) {
+    size_t p1 = line.find('\t');
+    size_t p2 = (p1 == string::npos ? string::npos : line.find('\t', p1 + 1));
+    if (p2 == string::npos)
+      throw IOException("AsyncFileReader (constructor). Invalid index line: " + line);
+    uint64_t offset = TextTools::to<uint64_t>(line.substr(p1 + 1, p2 - p1 - 1));
+    size_t size = TextTools::to<size_t>(line.substr(p2 + 1));
+    if (!index_.insert(make_pair(line.substr(0, p1), make_pair(offset, size))).second)
+      throw IOException("AsyncFileReader (constructor). Duplicated record " + line.substr(0, p1) + " in archive " + archive + ".");
+  }
+}
+
+bool AsyncFileReader::readRecord(const std::string& name, std::string& content)
+{
+  map<string, pair<uint64_t, size_t> >::const_iterator it = index_.find(name);
+  if (it == index_.end())
+    return false;
+  size_t size = it->second.second;
+  archive_.clear();
+  archive_.seekg(static_cast<streamoff>(it->second.first));
+  content.resize(size);
+  if (size > 0)
+    archive_.read(&content[0], static_cast<streamsize>(size));
+  if (size > 0 && static_cast<size_t>(archive_.gcount()) != size)
+    throw IOException("AsyncFileReader::readRecord. Truncated record " + name + " in archive " + archivePath_ + ".");
+  return true;
+}
+
+/******************************************************************************/
@@ -0,0 +1,213 @@
+//
+// File: AsyncFileWriter.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+
+#ifndef _ASYNCFILEWRITER_H_
+#define _ASYNCFILEWRITER_H_
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <deque>
+#include <set>
+#include <map>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief Write many small files asynchronously.
+ *
+ * Records (a file name and its content) are put in a bounded queue, which is drained by a pool of
+ * I/O threads, so that the latency of opening and closing files does not stall the caller.
+ * When the queue is full, write() blocks until a record has been written.
+ *
+ * Alternatively, all records can be packed into a single archive file, in which case they are written
+ * one after the other, in submission order, by a single I/O thread. An index file, named after the archive
+ * with the ".idx" extension, lists one record per line: name, offset of the record in the archive, and size
+ * (tab-separated). Records are read back with AsyncFileReader.
+ *
+ * Record names must be unique, and may not contain tabulations or line breaks.
+ * Errors occurring on the I/O threads are forwarded to the caller at the next call to write() or close().
+ * A writer can be shared by several iterators, records being then interleaved.
+ */
+class AsyncFileWriter
+{
+  private:
+    struct Record_
+    {
+      std::string name;
+      std::string content;
+      Record_(): name(), content() {}
+    };
+
+  private:
+    std::deque<Record_> queue_;
+    size_t maxPending_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    bool stop_;
+    std::exception_ptr error_;
+    bool packed_;
+    std::string archivePath_;
+    std::ofstream archive_;
+    std::ofstream index_;
+    uint64_t archiveOffset_;
+    size_t nbRecords_;
+    std::set<std::string> names_;
+
+  public:
+    /**
+     * @brief Build a writer creating one file per record.
+     *
+     * @param nbThreads The number of I/O threads. 0 means one per available core.
+     * @param maxPending The maximum number of records waiting in the queue.
+     */
+    AsyncFileWriter(unsigned int nbThreads = 4, size_t maxPending = 1024);
+
+    /**
+     * @brief Build a writer packing all records into a single archive file.
+     *
+     * @param archive The path of the archive file. The index file will be archive + ".idx".
+     * @param maxPending The maximum number of records waiting in the queue.
+     * @throw IOException If the files cannot be created.
+     */
+    AsyncFileWriter(const std::string& archive, size_t maxPending = 1024);
+
+    virtual ~AsyncFileWriter();
+
+  private:
+    AsyncFileWriter(const AsyncFileWriter&);
+    AsyncFileWriter& operator=(const AsyncFileWriter&);
+
+  public:
+    bool isPacked() const { return packed_; }
+
+    /**
+     * @brief Queue a record for writing.
+     *
+     * @param name The name of the file (or of the record in the archive).
+     * @param content The content to write. The string is swapped with an empty one, to avoid a copy.
+     * @throw Exception If a previous record could not be written, if the writer is closed,
+     * or if the name is invalid or was already used.
+     */
+    void write(const std::string& name, std::string& content);
+
+    /**
+     * @brief Wait for all pending records to be written, and stop the I/O threads.
+     *
+     * @throw Exception If a record could not be written.
+     */
+    void close();
+
+    /**
+     * @return The number of records written so far.
+     */
+    size_t getNumberOfRecords();
+
+    /**
+     * @brief Read a record from an archive, using its index file.
+     *
+     * The index is loaded for each call: use AsyncFileReader to read several records.
+     *
+     * @param archive The path of the archive file.
+     * @param name The name of the record.
+     * @param content [out] The content of the record.
+     * @return False if no record with this name is found.
+     * @throw IOException If the files cannot be read.
+     */
+    static bool readRecord(const std::string& archive, const std::string& name, std::string& content);
+
+  private:
+    void workerLoop_();
+    void writeRecord_(Record_& record);
+};
+
+/**
+ * @brief Read records from an archive written by AsyncFileWriter.
+ *
+ * The index file is loaded once, so that each record is then found in logarithmic time.
+ */
+class AsyncFileReader
+{
+  private:
+    std::string archivePath_;
+    std::ifstream archive_;
+    //Offset and size of each record:
+    std::map<std::string, std::pair<uint64_t, size_t> > index_;
+
+  public:
+    /**
+     * @param archive The path of the archive file. The index file is archive + ".idx".
+     * @throw IOException If the files cannot be read, or if the index is invalid or has duplicated names.
+     */
+    AsyncFileReader(const std::string& archive);
+
+    virtual ~AsyncFileReader() {}
+
+  private:
+    AsyncFileReader(const AsyncFileReader&);
+    AsyncFileReader& operator=(const AsyncFileReader&);
+
+  public:
+    size_t getNumberOfRecords() const { return index_.size(); }
+
+    bool hasRecord(const std::string& name) const { return index_.find(name) != index_.end(); }
+
+    /**
+     * @brief Read a record.
+     *
+     * @param name The name of the record.
+     * @param content [out] The content of the record.
+     * @return False if no record with this name is found.
+     * @throw IOException If the record cannot be read.
+     */
+    bool readRecord(const std::string& name, std::string& content);
+};
+
+} // end of namespace bpp.
+
+#endif //_ASYNCFILEWRITER_H_
@@ -0,0 +1,97 @@
+//
+// File: CompactRead.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "CompactRead.h"
+
+//From bpp-core:
+#include <Bpp/Text/TextTools.h>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+string CompactRead::toString() const
+{
+  string text(length_, ' ');
+  const int8_t* bases = getBases();
+  for (size_t i = 0; i < length_; ++i) {
+    string c = alphabet_->intToChar(bases[i]);
+    text[i] = c[0];
+  }
+  return text;
+}
+
+SequenceWithQuality* CompactRead::toSequence() const
+{
+  const int8_t* bases = getBases();
+  const uint8_t* qualities = getQualities();
+  vector<int> states(bases, bases + length_);
+  vector<int> scores(length_);
+  for (size_t i = 0; i < length_; ++i)
+    scores[i] = static_cast<int>(qualities[i]) + 33;
+  return new SequenceWithQuality(name_, states, scores, alphabet_);
+}
+
+void CompactRead::fromSequence(const Sequence& seq)
+{
+  alphabet_ = seq.getAlphabet();
+  name_ = seq.getName();
+  size_t n = seq.size();
+  data_.assign(2 * n, 0);
+  length_ = n;
+  int8_t* bases = getBases();
+  for (size_t i = 0; i < n; ++i) {
+    int state = seq[i];
+    if (state < -128 || state > 127)
+      throw Exception("CompactRead::fromSequence. State " + TextTools::toString(state) + " does not fit in one byte.");
+    bases[i] = static_cast<int8_t>(state);
+  }
+  const SequenceWithQuality* sq = dynamic_cast<const SequenceWithQuality*>(&seq);
+  if (sq) {
+    uint8_t* qualities = getQualities();
+    for (size_t i = 0; i < n; ++i) {
+      int q = sq->getQuality(i) - 33;
+      if (q < 0 || q > 255)
+        throw Exception("CompactRead::fromSequence. Quality " + TextTools::toString(sq->getQuality(i)) + " is out of range.");
+      qualities[i] = static_cast<uint8_t>(q);
+    }
+  }
+}
+
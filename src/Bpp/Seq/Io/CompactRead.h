@@ -0,0 +1,173 @@
+//
+// File: CompactRead.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _COMPACTREAD_H_
+#define _COMPACTREAD_H_
+
+//From bpp-seq:
+#include <Bpp/Seq/Alphabet/Alphabet.h>
+#include <Bpp/Seq/Sequence.h>
+#include <Bpp/Seq/SequenceWithQuality.h>
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+namespace bpp {
+
+/**
+ * @brief A read with one-byte state codes and one-byte Phred quality scores.
+ *
+ * A SequenceWithQuality stores each state and each quality score as an int, that is, 8 bytes per
+ * position plus the overhead of the object. A CompactRead stores both in a single buffer of 2 bytes
+ * per position: the state codes of the alphabet, followed by the Phred scores (without the ASCII
+ * offset of the FASTQ format). Alphabets must therefore have state codes fitting in one byte,
+ * which is the case of nucleotide and protein alphabets.
+ *
+ * Reads are converted from and to the Sequence interface with fromSequence() and toSequence().
+ * Many reads are best held in a FastqBatch, which uses the same encoding.
+ *
+ * @see Fastq::nextRead, FastqBatch
+ */
+class CompactRead
+{
+  private:
+    const Alphabet* alphabet_;
+    std::string name_;
+    std::vector<uint8_t> data_;
+    size_t length_;
+
+  public:
+    CompactRead(const Alphabet* alphabet):
+      alphabet_(alphabet), name_(), data_(), length_(0) {}
+
+    /**
+     * @param name The name of the read.
+     * @param bases The state codes of the read.
+     * @param qualities The Phred quality scores of the read.
+     * @param length The number of positions.
+     * @param alphabet The alphabet of the read.
+     */
+    CompactRead(const std::string& name, const int8_t* bases, const uint8_t* qualities, size_t length, const Alphabet* alphabet):
+      alphabet_(alphabet), name_(name), data_(), length_(0)
+    {
+      setContent(bases, qualities, length);
+    }
+
+  public:
+    const Alphabet* getAlphabet() const { return alphabet_; }
+
+    const std::string& getName() const { return name_; }
+    void setName(const std::string& name) { name_ = name; }
+
+    size_t size() const { return length_; }
+
+    /**
+     * @brief Change the length of the read. New positions are left uninitialized.
+     *
+     * @param length The new number of positions.
+     */
+    void resize(size_t length) {
+      if (length == length_) return;
+      std::vector<uint8_t> data(2 * length);
+      size_t n = std::min(length, length_);
+      std::copy(data_.begin(), data_.begin() + static_cast<std::ptrdiff_t>(n), data.begin());
+      std::copy(data_.begin() + static_cast<std::ptrdiff_t>(length_), data_.begin() + static_cast<std::ptrdiff_t>(length_ + n), data.begin() + static_cast<std::ptrdiff_t>(length));
+      data_.swap(data);
+      length_ = length;
+    }
+
+    const int8_t* getBases() const { return reinterpret_cast<const int8_t*>(data_.data()); }
+    int8_t* getBases() { return reinterpret_cast<int8_t*>(data_.data()); }
+    const uint8_t* getQualities() const { return data_.data() + length_; }
+    uint8_t* getQualities() { return data_.data() + length_; }
+
+    int getState(size_t i) const { return static_cast<int>(getBases()[i]); }
+    unsigned int getQuality(size_t i) const { return static_cast<unsigned int>(getQualities()[i]); }
+
+    /**
+     * @brief Set the content of the read.
+     *
+     * @param bases The state codes of the read.
+     * @param qualities The Phred quality scores of the read.
+     * @param length The number of positions.
+     */
+    void setContent(const int8_t* bases, const uint8_t* qualities, size_t length) {
+      if (length != length_) {
+        data_.resize(2 * length);
+        length_ = length;
+      }
+      std::copy(bases, bases + length, getBases());
+      std::copy(qualities, qualities + length, getQualities());
+    }
+
+    /**
+     * @return The memory used by the read content, in bytes.
+     */
+    size_t getMemorySize() const { return name_.capacity() + data_.capacity(); }
+
+    /**
+     * @return The read as a string of characters.
+     */
+    std::string toString() const;
+
+    /**
+     * @return A new sequence object with the content of the read.
+     * As with Fastq::nextSequence, qualities are stored with their ASCII offset.
+     */
+    SequenceWithQuality* toSequence() const;
+
+    /**
+     * @brief Copy the content of a sequence.
+     *
+     * If the sequence is a SequenceWithQuality, its qualities are expected to be stored with
+     * their ASCII offset, as done by Fastq::nextSequence. Otherwise, all qualities are set to 0.
+     *
+     * @param seq The sequence to copy.
+     * @throw Exception If a state or a quality does not fit in one byte.
+     */
+    void fromSequence(const Sequence& seq);
+};
+
+} // end of namespace bpp.
+
+#endif //_COMPACTREAD_H_
+
@@ -0,0 +1,445 @@
+//
+// File: CompressedInput.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "CompressedInput.h"
+
+#include <Bpp/Text/TextTools.h>
+
+//From zlib:
+#include <zlib.h>
+
+//From the STL:
+#include <cstring>
+#include <algorithm>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+struct CompressedFileReader::GzipState_
+{
+  z_stream stream;
+  vector<unsigned char> input;
+  bool initialized;
+  GzipState_(): stream(), input(1048576), initialized(false) {
+    memset(&stream, 0, sizeof(z_stream));
+  }
+  ~GzipState_() {
+    if (initialized) inflateEnd(&stream);
+  }
+};
+
+/******************************************************************************/
+
+CompressedFileReader::CompressedFileReader(const std::string& path, unsigned int nbThreads, size_t maxBlocksAhead):
+  path_(path), input_(path.c_str(), ios::in | ios::binary), format_(FORMAT_PLAIN),
+  inputPosition_(0), outputPosition_(0), inputEof_(false), buffer_(), gzip_(), startOffset_(0),
+  workers_(), pending_(), inFlight_(), current_(), maxInFlight_(max(maxBlocksAhead, static_cast<size_t>(1))), stop_(false),
+  mutex_(), workAvailable_(), jobDone_()
+{
+  if (!input_)
+    throw IOException("CompressedFileReader (constructor). Cannot open file " + path + ".");
+  detectFormat_();
+  if (format_ == FORMAT_BGZF) {
+    startWorkers_(nbThreads);
+  } else if (format_ == FORMAT_GZIP) {
+    gzip_.reset(new GzipState_());
+    if (inflateInit2(&gzip_->stream, 15 + 32) != Z_OK)
+      throw Exception("CompressedFileReader (constructor). Cannot initialize gzip decompression.");
+    gzip_->initialized = true;
+  }
+}
+
+CompressedFileReader::~CompressedFileReader()
+{
+  stopWorkers_();
+}
+
+/******************************************************************************/
+
+void CompressedFileReader::detectFormat_()
+{
+  unsigned char header[18];
+  input_.read(reinterpret_cast<char*>(header), 18);
+  streamsize n = input_.gcount();
+  input_.clear();
+  input_.seekg(0, ios::beg);
+  if (n >= 2 && header[0] == 0x1f && header[1] == 0x8b) {
+    format_ = FORMAT_GZIP;
+    //BGZF has an extra field with a 'BC' subfield:
+    if (n == 18 && (header[3] & 4) && header[12] == 'B' && header[13] == 'C' && header[14] == 2 && header[15] == 0)
+      format_ = FORMAT_BGZF;
+  } else {
+    format_ = FORMAT_PLAIN;
+  }
+}
+
+bool CompressedFileReader::isCompressed(const std::string& path)
+{
+  ifstream in(path.c_str(), ios::in | ios::binary);
+  unsigned char magic[2] = {0, 0};
+  in.read(reinterpret_cast<char*>(magic), 2);
+  return in.gcount() == 2 && magic[0] == 0x1f && magic[1] == 0x8b;
+}
+
+/******************************************************************************/
+
+void CompressedFileReader::startWorkers_(unsigned int nbThreads)
+{
+  if (nbThreads == 0)
+    nbThreads = max(thread::hardware_concurrency(), 1u);
+  stop_ = false;
+  for (unsigned int i = 0; i < nbThreads; ++i)
+    workers_.push_back(thread(&CompressedFileReader::workerLoop_, this));
+}
+
+void CompressedFileReader::stopWorkers_()
+{
+  {
+    lock_guard<mutex> lock(mutex_);
+    stop_ = true;
+  }
+  workAvailable_.notify_all();
+  for (size_t i = 0; i < workers_.size(); ++i)
+    workers_[i].join();
+  workers_.clear();
+}
+
+void CompressedFileReader::workerLoop_()
+{
+  while (true) {
+    shared_ptr<BgzfJob_> job;
+    {
+      unique_lock<mutex> lock(mutex_);
+      while (!stop_ && pending_.empty())
+        workAvailable_.wait(lock);
+      if (stop_)
+        return;
+      job = pending_.front();
+      pending_.pop_front();
+    }
+    inflateBgzfBlock_(*job);
+    {
+      lock_guard<mutex> lock(mutex_);
+      job->done = true;
+    }
+    jobDone_.notify_all();
+  }
+}
+
+void CompressedFileReader::inflateBgzfBlock_(BgzfJob_& job)
+{
+  size_t csize = job.compressed.size();
+  if (csize < 8) {
+    job.error = "Truncated BGZF block.";
+    return;
+  }
+  const unsigned char* footer = &job.compressed[csize - 8];
+  uint32_t crc = static_cast<uint32_t>(footer[0]) | (static_cast<uint32_t>(footer[1]) << 8) | (static_cast<uint32_t>(footer[2]) << 16) | (static_cast<uint32_t>(footer[3]) << 24);
+  uint32_t isize = static_cast<uint32_t>(footer[4]) | (static_cast<uint32_t>(footer[5]) << 8) | (static_cast<uint32_t>(footer[6]) << 16) | (static_cast<uint32_t>(footer[7]) << 24);
+  job.data.resize(isize);
+  if (isize == 0)
+    return;
+  z_stream zs;
+  memset(&zs, 0, sizeof(z_stream));
+  if (inflateInit2(&zs, -15) != Z_OK) {
+    job.error = "Cannot initialize decompression.";
+    return;
+  }
+  zs.next_in = &job.compressed[0];
+  zs.avail_in = static_cast<uInt>(csize - 8);
+  zs.next_out = reinterpret_cast<Bytef*>(&job.data[0]);
+  zs.avail_out = static_cast<uInt>(isize);
+  int ret = inflate(&zs, Z_FINISH);
+  inflateEnd(&zs);
+  if (ret != Z_STREAM_END || zs.avail_out != 0) {
+    job.error = "Corrupted BGZF block.";
+    return;
+  }
+  if (crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(&job.data[0]), static_cast<uInt>(isize)) != crc)
+    job.error = "CRC mismatch in BGZF block.";
+}
+
+bool CompressedFileReader::readBgzfBlock_(BgzfJob_& job)
+{
+  unsigned char header[12];
+  input_.read(reinterpret_cast<char*>(header), 12);
+  if (input_.gcount() == 0)
+    return false;
+  if (input_.gcount() != 12 || header[0] != 0x1f || header[1] != 0x8b || !(header[3] & 4))
+    throw IOException("CompressedFileReader::readBgzfBlock_(). Invalid BGZF block header in file " + path_ + ".");
+  size_t xlen = static_cast<size_t>(header[10]) | (static_cast<size_t>(header[11]) << 8);
+  vector<unsigned char> extra(xlen);
+  input_.read(reinterpret_cast<char*>(&extra[0]), static_cast<streamsize>(xlen));
+  if (static_cast<size_t>(input_.gcount()) != xlen)
+    throw IOException("CompressedFileReader::readBgzfBlock_(). Truncated BGZF block header in file " + path_ + ".");
+  //Look for the BC subfield, containing the block size:
+  size_t bsize = 0;
+  for (size_t i = 0; i + 4 <= xlen; ) {
+    size_t slen = static_cast<size_t>(extra[i + 2]) | (static_cast<size_t>(extra[i + 3]) << 8);
+    if (extra[i] == 'B' && extra[i + 1] == 'C' && slen == 2 && i + 6 <= xlen) {
+      bsize = (static_cast<size_t>(extra[i + 4]) | (static_cast<size_t>(extra[i + 5]) << 8)) + 1;
+      break;
+    }
+    i += 4 + slen;
+  }
+  if (bsize < 12 + xlen + 8)
+    throw IOException("CompressedFileReader::readBgzfBlock_(). Missing or invalid BGZF block size in file " + path_ + ".");
+  size_t remaining = bsize - 12 - xlen;
+  job.address = inputPosition_;
+  job.compressed.resize(remaining);
+  input_.read(reinterpret_cast<char*>(&job.compressed[0]), static_cast<streamsize>(remaining));
+  if (static_cast<size_t>(input_.gcount()) != remaining)
+    throw IOException("CompressedFileReader::readBgzfBlock_(). Truncated BGZF block in file " + path_ + ".");
+  inputPosition_ += bsize;
+  return true;
+}
+
+void CompressedFileReader::fillBgzfQueue_()
+{
+  while (!inputEof_ && inFlight_.size() < maxInFlight_) {
+    shared_ptr<BgzfJob_> job(new BgzfJob_());
+    if (!readBgzfBlock_(*job)) {
+      inputEof_ = true;
+      break;
+    }
+    {
+      lock_guard<mutex> lock(mutex_);
+      pending_.push_back(job);
+      inFlight_.push_back(job);
+    }
+    workAvailable_.notify_one();
+  }
+}
+
+/******************************************************************************/
+
+bool CompressedFileReader::nextGzipChunk_()
+{
+  z_stream& zs = gzip_->stream;
+  if (buffer_.size() == 0)
+    buffer_.resize(1048576);
+  zs.next_out = reinterpret_cast<Bytef*>(&buffer_[0]);
+  zs.avail_out = static_cast<uInt>(buffer_.size());
+  while (zs.avail_out > 0) {
+    if (zs.avail_in == 0) {
+      if (inputEof_) break;
+      input_.read(reinterpret_cast<char*>(&gzip_->input[0]), static_cast<streamsize>(gzip_->input.size()));
+      streamsize n = input_.gcount();
+      if (n <= 0) {
+        inputEof_ = true;
+        break;
+      }
+      zs.next_in = &gzip_->input[0];
+      zs.avail_in = static_cast<uInt>(n);
+    }
+    int ret = inflate(&zs, Z_NO_FLUSH);
+    if (ret == Z_STREAM_END) {
+      //Concatenated members are allowed:
+      inflateReset(&zs);
+    } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+      throw IOException("CompressedFileReader::nextChunk(). Corrupted gzip data in file " + path_ + ".");
+    }
+  }
+  return zs.avail_out < buffer_.size();
+}
+
+bool CompressedFileReader::nextChunk(const char*& data, size_t& size, size_t& start, uint64_t& address)
+{
+  start = 0;
+  if (format_ == FORMAT_BGZF) {
+    current_.reset();
+    while (true) {
+      fillBgzfQueue_();
+      if (inFlight_.empty())
+        return false;
+      shared_ptr<BgzfJob_> job = inFlight_.front();
+      {
+        unique_lock<mutex> lock(mutex_);
+        while (!job->done)
+          jobDone_.wait(lock);
+        inFlight_.pop_front();
+      }
+      if (!job->error.empty())
+        throw IOException("CompressedFileReader::nextChunk(). " + job->error + " File: " + path_ + ".");
+      if (job->data.size() <= startOffset_) {
+        //Empty block (for instance the end of file marker), or seek position at the end of the block.
+        startOffset_ = 0;
+        continue;
+      }
+      current_ = job;
+      data = &job->data[0];
+      size = job->data.size();
+      start = startOffset_;
+      address = job->address;
+      startOffset_ = 0;
+      return true;
+    }
+  } else {
+    size_t n = 0;
+    if (format_ == FORMAT_GZIP) {
+      if (!nextGzipChunk_())
+        return false;
+      n = buffer_.size() - gzip_->stream.avail_out;
+    } else {
+      if (buffer_.size() == 0)
+        buffer_.resize(1048576);
+      input_.read(&buffer_[0], static_cast<streamsize>(buffer_.size()));
+      n = static_cast<size_t>(input_.gcount());
+      if (n == 0)
+        return false;
+    }
+    data = &buffer_[0];
+    size = n;
+    address = outputPosition_;
+    outputPosition_ += n;
+    return true;
+  }
+}
+
+/******************************************************************************/
+
+void CompressedFileReader::seek(uint64_t offset)
+{
+  if (format_ == FORMAT_GZIP)
+    throw Exception("CompressedFileReader::seek(). Random access is not supported for plain gzip files, use bgzip to compress file " + path_ + ".");
+  uint64_t filePos = offset;
+  if (format_ == FORMAT_BGZF) {
+    //Discard all blocks read ahead. Blocks currently processed by a worker
+    //are shared, and will be released when the worker is done with them:
+    {
+      lock_guard<mutex> lock(mutex_);
+      pending_.clear();
+      inFlight_.clear();
+    }
+    current_.reset();
+    filePos = offset >> 16;
+    startOffset_ = static_cast<size_t>(offset & 0xFFFF);
+    inputPosition_ = filePos;
+  } else {
+    outputPosition_ = offset;
+  }
+  input_.clear();
+  input_.seekg(static_cast<streamoff>(filePos), ios::beg);
+  if (!input_)
+    throw IOException("CompressedFileReader::seek(). Cannot seek to position " + TextTools::toString(filePos) + " in file " + path_ + ".");
+  inputEof_ = false;
+}
+
+/******************************************************************************/
+
+bool CompressedLineReader::nextLine(TextSpan& line)
+{
+  if (carryUsed_) {
+    carry_.clear();
+    carryUsed_ = false;
+  }
+  while (true) {
+    if (position_ >= chunkSize_) {
+      size_t start = 0;
+      if (!reader_.nextChunk(chunk_, chunkSize_, start, address_)) {
+        chunk_ = 0;
+        chunkSize_ = 0;
+        position_ = 0;
+        if (carry_.size() > 0) {
+          //Last line without end of line character:
+          line = TextSpan(carry_.data(), carry_.size());
+          lineOffset_ = carryOffset_;
+          carryUsed_ = true;
+          return true;
+        }
+        return false;
+      }
+      position_ = start;
+    }
+    const char* begin = chunk_ + position_;
+    size_t available = chunkSize_ - position_;
+    const char* found = static_cast<const char*>(memchr(begin, '\n', available));
+    if (found) {
+      size_t len = static_cast<size_t>(found - begin);
+      if (carry_.size() == 0) {
+        line = TextSpan(begin, len);
+        lineOffset_ = reader_.makeOffset(address_, position_);
+      } else {
+        carry_.append(begin, len);
+        line = TextSpan(carry_.data(), carry_.size());
+        lineOffset_ = carryOffset_;
+        carryUsed_ = true;
+      }
+      position_ += len + 1;
+      return true;
+    }
+    //The line continues in the next chunk:
+    if (carry_.size() == 0)
+      carryOffset_ = reader_.makeOffset(address_, position_);
+    carry_.append(begin, available);
+    position_ = chunkSize_;
+  }
+}
+
+void CompressedLineReader::seek(uint64_t offset)
+{
+  reader_.seek(offset);
+  chunk_ = 0;
+  chunkSize_ = 0;
+  position_ = 0;
+  carry_.clear();
+  carryUsed_ = false;
+  lineOffset_ = offset;
+}
+
+/******************************************************************************/
+
+CompressedStreamBuffer::int_type CompressedStreamBuffer::underflow()
+{
+  if (gptr() < egptr())
+    return traits_type::to_int_type(*gptr());
+  const char* data = 0;
+  size_t size = 0;
+  size_t start = 0;
+  uint64_t address = 0;
+  if (!reader_.nextChunk(data, size, start, address))
+    return traits_type::eof();
+  char* p = const_cast<char*>(data);
+  setg(p, p + start, p + size);
+  return traits_type::to_int_type(*gptr());
+}
+
+/******************************************************************************/
@@ -0,0 +1,286 @@
+//
+// File: CompressedInput.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _COMPRESSEDINPUT_H_
+#define _COMPRESSEDINPUT_H_
+
+#include "LineReader.h"
+
+//From the STL:
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace bpp {
+
+/**
+ * @brief Low-level reader for plain, gzip and BGZF compressed files.
+ *
+ * The format is detected from the first bytes of the file:
+ * - Uncompressed files are read in large chunks.
+ * - Plain gzip files (possibly with several members) are decompressed on a single stream.
+ * - BGZF files (as produced by bgzip) are made of independent deflate blocks.
+ *   Blocks are read ahead and decompressed concurrently on a pool of threads,
+ *   and delivered in file order.
+ *
+ * Decompressed data are returned by chunks, each chunk corresponding to one BGZF block
+ * for BGZF input. Random access is supported for uncompressed and BGZF files. In the
+ * latter case, offsets are BGZF virtual offsets, that is, the position of the compressed
+ * block in the file shifted by 16 bits, plus the position within the uncompressed block.
+ */
+class CompressedFileReader
+{
+  public:
+    static constexpr short FORMAT_PLAIN = 0;
+    static constexpr short FORMAT_GZIP = 1;
+    static constexpr short FORMAT_BGZF = 2;
+
+  private:
+    struct BgzfJob_
+    {
+      uint64_t address;
+      std::vector<unsigned char> compressed;
+      std::vector<char> data;
+      bool done;
+      std::string error;
+      BgzfJob_(): address(0), compressed(), data(), done(false), error() {}
+    };
+
+    struct GzipState_;
+
+  private:
+    std::string path_;
+    std::ifstream input_;
+    short format_;
+    uint64_t inputPosition_; //Position of the next byte to read in the file.
+    uint64_t outputPosition_; //Total decompressed bytes delivered, for non-BGZF input.
+    bool inputEof_;
+    std::vector<char> buffer_; //Current chunk, for non-BGZF input.
+    std::unique_ptr<GzipState_> gzip_;
+    size_t startOffset_;
+
+    //BGZF multi-threading:
+    std::vector<std::thread> workers_;
+    std::deque< std::shared_ptr<BgzfJob_> > pending_; //Jobs waiting for a worker.
+    std::deque< std::shared_ptr<BgzfJob_> > inFlight_; //All jobs not yet delivered, in file order.
+    std::shared_ptr<BgzfJob_> current_;
+    size_t maxInFlight_;
+    bool stop_;
+    std::mutex mutex_;
+    std::condition_variable workAvailable_;
+    std::condition_variable jobDone_;
+
+  public:
+    /**
+     * @param path The file to read.
+     * @param nbThreads The number of decompression threads to use for BGZF input. 0 means one per available core.
+     * @param maxBlocksAhead The maximum number of BGZF blocks read and decompressed ahead of the consumer.
+     * @throw IOException If the file cannot be open.
+     */
+    CompressedFileReader(const std::string& path, unsigned int nbThreads = 0, size_t maxBlocksAhead = 256);
+
+    virtual ~CompressedFileReader();
+
+  private:
+    CompressedFileReader(const CompressedFileReader&);
+    CompressedFileReader& operator=(const CompressedFileReader&);
+
+  public:
+    short getFormat() const { return format_; }
+
+    /**
+     * @brief Get the next chunk of decompressed data.
+     *
+     * @param data [out] A pointer toward the data, valid until the next call to this object.
+     * @param size [out] The size of the chunk.
+     * @param start [out] The position in the chunk where reading should start (non-zero after a seek in BGZF file).
+     * @param address [out] The address of the chunk, to be used with makeOffset.
+     * @return False if the end of file is reached.
+     */
+    bool nextChunk(const char*& data, size_t& size, size_t& start, uint64_t& address);
+
+    /**
+     * @return The offset corresponding to a position in a chunk.
+     */
+    uint64_t makeOffset(uint64_t address, size_t position) const {
+      if (format_ == FORMAT_BGZF)
+        return (address << 16) | static_cast<uint64_t>(position);
+      else
+        return address + position;
+    }
+
+    bool isSeekable() const { return format_ != FORMAT_GZIP; }
+
+    /**
+     * @brief Move to a given offset, as returned by makeOffset.
+     *
+     * @throw Exception If the file is a plain gzip file.
+     */
+    void seek(uint64_t offset);
+
+    /**
+     * @return True if the file starts with a gzip header.
+     * @param path The file to test.
+     */
+    static bool isCompressed(const std::string& path);
+
+  private:
+    void detectFormat_();
+    bool readBgzfBlock_(BgzfJob_& job);
+    void fillBgzfQueue_();
+    void workerLoop_();
+    void stopWorkers_();
+    void startWorkers_(unsigned int nbThreads);
+    bool nextGzipChunk_();
+    static void inflateBgzfBlock_(BgzfJob_& job);
+};
+
+/**
+ * @brief Line reader on a (possibly compressed) file.
+ *
+ * Lines are returned without copy, unless they span several chunks of the
+ * decompressed data. Offsets are BGZF virtual offsets for BGZF files, and
+ * byte offsets otherwise.
+ */
+class CompressedLineReader:
+  public LineReader
+{
+  private:
+    CompressedFileReader reader_;
+    const char* chunk_;
+    size_t chunkSize_;
+    size_t position_;
+    uint64_t address_;
+    std::string carry_;
+    bool carryUsed_;
+    uint64_t carryOffset_;
+    uint64_t lineOffset_;
+
+  public:
+    /**
+     * @param path The file to read.
+     * @param nbThreads The number of decompression threads to use for BGZF input. 0 means one per available core.
+     */
+    CompressedLineReader(const std::string& path, unsigned int nbThreads = 0):
+      LineReader(),
+      reader_(path, nbThreads), chunk_(0), chunkSize_(0), position_(0),
+      address_(0), carry_(), carryUsed_(false), carryOffset_(0), lineOffset_(0)
+    {}
+
+  private:
+    CompressedLineReader(const CompressedLineReader&);
+    CompressedLineReader& operator=(const CompressedLineReader&);
+
+  public:
+    bool nextLine(TextSpan& line);
+    uint64_t getLineOffset() const { return lineOffset_; }
+    bool isSeekable() const { return reader_.isSeekable(); }
+    void seek(uint64_t offset);
+
+    short getFormat() const { return reader_.getFormat(); }
+};
+
+/**
+ * @brief Stream buffer on top of a CompressedFileReader.
+ */
+class CompressedStreamBuffer:
+  public std::streambuf
+{
+  private:
+    CompressedFileReader reader_;
+
+  public:
+    CompressedStreamBuffer(const std::string& path, unsigned int nbThreads = 0):
+      std::streambuf(), reader_(path, nbThreads) {}
+
+  private:
+    CompressedStreamBuffer(const CompressedStreamBuffer&);
+    CompressedStreamBuffer& operator=(const CompressedStreamBuffer&);
+
+  public:
+    short getFormat() const { return reader_.getFormat(); }
+
+  protected:
+    int_type underflow();
+};
+
+/**
+ * @brief Input stream on a (possibly compressed) file.
+ *
+ * This stream can be used in place of a std::ifstream with all readers taking a
+ * std::istream as input, such as Fastq, GffFeatureReader or GtfFeatureReader.
+ * Plain gzip and BGZF files are decompressed on the fly, the latter using several
+ * threads. Uncompressed files are also supported.
+ * @code
+ * CompressedInputStream input("reads.fastq.gz");
+ * Fastq fq;
+ * SequenceWithQuality seq(&AlphabetTools::DNA_ALPHABET);
+ * while (fq.nextSequence(input, seq)) { ... }
+ * @endcode
+ */
+class CompressedInputStream:
+  public std::istream
+{
+  private:
+    CompressedStreamBuffer buffer_;
+
+  public:
+    CompressedInputStream(const std::string& path, unsigned int nbThreads = 0):
+      std::istream(0), buffer_(path, nbThreads)
+    {
+      rdbuf(&buffer_);
+    }
+
+  private:
+    CompressedInputStream(const CompressedInputStream&);
+    CompressedInputStream& operator=(const CompressedInputStream&);
+
+  public:
+    short getFormat() const { return buffer_.getFormat(); }
+};
+
+} // end of namespace bpp.
+
+#endif //_COMPRESSEDINPUT_H_
@@ -0,0 +1,194 @@
+//
+// File: CompressedOutput.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+
+#include "CompressedOutput.h"
+
+#include <Bpp/Exceptions.h>
+#include <Bpp/Text/TextTools.h>
+
+//From zlib:
+#include <zlib.h>
+
+//From the STL:
+#include <cstring>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+const size_t BgzfStreamBuffer::BLOCK_SIZE = 0xff00;
+
+struct BgzfStreamBuffer::DeflateState_
+{
+  z_stream stream;
+  bool initialized;
+  DeflateState_(): stream(), initialized(false) {
+    memset(&stream, 0, sizeof(z_stream));
+  }
+  ~DeflateState_() {
+    if (initialized) deflateEnd(&stream);
+  }
+};
+
+/******************************************************************************/
+
+BgzfStreamBuffer::BgzfStreamBuffer(std::ostream* output, int level):
+  std::streambuf(), output_(output), buffer_(BLOCK_SIZE), compressed_(), deflate_(new DeflateState_()),
+  address_(0), closed_(false)
+{
+  if (!output_)
+    throw Exception("BgzfStreamBuffer (constructor). Output stream is null.");
+  //Raw deflate, the gzip header and footer are written by hand:
+  if (deflateInit2(&deflate_->stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    throw Exception("BgzfStreamBuffer (constructor). Cannot initialize compression.");
+  deflate_->initialized = true;
+  compressed_.resize(18 + deflateBound(&deflate_->stream, static_cast<uLong>(BLOCK_SIZE)) + 8);
+  setp(&buffer_[0], &buffer_[0] + buffer_.size());
+}
+
+BgzfStreamBuffer::~BgzfStreamBuffer()
+{
+  try {
+    close();
+  } catch (exception& e) {
+    //Destructors must not throw.
+  }
+}
+
+/******************************************************************************/
+
+void BgzfStreamBuffer::writeBlock_(const char* data, size_t size)
+{
+  z_stream& zs = deflate_->stream;
+  if (deflateReset(&zs) != Z_OK)
+    throw Exception("BgzfStreamBuffer::writeBlock_. Cannot reset compression.");
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+  zs.avail_in = static_cast<uInt>(size);
+  zs.next_out = &compressed_[18];
+  zs.avail_out = static_cast<uInt>(compressed_.size() - 26);
+  if (deflate(&zs, Z_FINISH) != Z_STREAM_END)
+    throw Exception("BgzfStreamBuffer::writeBlock_. Compression failed.");
+  size_t blockSize = 18 + zs.total_out + 8;
+  if (blockSize > 65536)
+    throw Exception("BgzfStreamBuffer::writeBlock_. Compressed block is too large: " + TextTools::toString(blockSize) + ".");
+
+  //Header, with the 'BC' extra field storing the total block size minus 1:
+  static const unsigned char header[16] = {0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0};
+  memcpy(&compressed_[0], header, 16);
+  compressed_[16] = static_cast<unsigned char>((blockSize - 1) & 0xff);
+  compressed_[17] = static_cast<unsigned char>((blockSize - 1) >> 8);
+
+  //Footer, with the CRC and the uncompressed size (little endian):
+  uLong crc = crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(data), static_cast<uInt>(size));
+  unsigned char* footer = &compressed_[blockSize - 8];
+  for (size_t i = 0; i < 4; ++i) {
+    footer[i] = static_cast<unsigned char>((crc >> (8 * i)) & 0xff);
+    footer[4 + i] = static_cast<unsigned char>((size >> (8 * i)) & 0xff);
+  }
+  output_->write(reinterpret_cast<const char*>(&compressed_[0]), static_cast<streamsize>(blockSize));
+  if (!*output_)
+    throw IOException("BgzfStreamBuffer::writeBlock_. Cannot write to output stream.");
+  address_ += blockSize;
+}
+
+void BgzfStreamBuffer::flushBlock()
+{
+  size_t n = static_cast<size_t>(pptr() - pbase());
+  if (n > 0) {
+    writeBlock_(pbase(), n);
+    setp(&buffer_[0], &buffer_[0] + buffer_.size());
+  }
+}
+
+void BgzfStreamBuffer::close()
+{
+  if (closed_) return;
+  flushBlock();
+  //An empty block marks the end of the file:
+  writeBlock_(0, 0);
+  output_->flush();
+  closed_ = true;
+  setp(0, 0);
+}
+
+/******************************************************************************/
+
+BgzfStreamBuffer::int_type BgzfStreamBuffer::overflow(int_type c)
+{
+  if (closed_)
+    return traits_type::eof();
+  flushBlock();
+  if (!traits_type::eq_int_type(c, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+  }
+  return traits_type::not_eof(c);
+}
+
+std::streamsize BgzfStreamBuffer::xsputn(const char* s, std::streamsize n)
+{
+  if (closed_)
+    return 0;
+  streamsize written = 0;
+  while (written < n) {
+    streamsize room = epptr() - pptr();
+    if (room == 0) {
+      flushBlock();
+      room = epptr() - pptr();
+    }
+    streamsize k = min(room, n - written);
+    memcpy(pptr(), s + written, static_cast<size_t>(k));
+    pbump(static_cast<int>(k));
+    written += k;
+  }
+  return written;
+}
+
+int BgzfStreamBuffer::sync()
+{
+  if (closed_)
+    return 0;
+  //Blocks are not cut on sync, so that flushing the stream after each line does not degrade compression:
+  output_->flush();
+  return *output_ ? 0 : -1;
+}
+
+/******************************************************************************/
@@ -0,0 +1,171 @@
+//
+// File: CompressedOutput.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+
+#ifndef _COMPRESSEDOUTPUT_H_
+#define _COMPRESSEDOUTPUT_H_
+
+//From the STL:
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief Stream buffer writing BGZF compressed data.
+ *
+ * Data are cut into blocks of at most BLOCK_SIZE uncompressed bytes, each block being
+ * compressed independently as a gzip member with a 'BC' extra field, as done by bgzip.
+ * The resulting file can be read by any gzip reader, and randomly accessed using BGZF
+ * virtual offsets. The end-of-file marker is written when the buffer is closed.
+ * Synchronizing the stream (e.g. with std::endl) does not cut the current block, use flushBlock() for this.
+ *
+ * @see CompressedFileReader
+ */
+class BgzfStreamBuffer:
+  public std::streambuf
+{
+  public:
+    /**
+     * @brief Maximum number of uncompressed bytes in a block.
+     *
+     * This guarantees that a compressed block is never larger than 64 KiB, even for incompressible data.
+     */
+    static const size_t BLOCK_SIZE;
+
+  private:
+    struct DeflateState_;
+
+  private:
+    std::ostream* output_;
+    std::vector<char> buffer_;
+    std::vector<unsigned char> compressed_;
+    std::unique_ptr<DeflateState_> deflate_;
+    uint64_t address_; //Number of compressed bytes written so far.
+    bool closed_;
+
+  public:
+    /**
+     * @param output The stream where to write compressed data. It is not owned by the buffer.
+     * @param level The compression level, from 0 (no compression) to 9 (best compression). -1 means default level.
+     * @throw Exception If compression cannot be initialized.
+     */
+    BgzfStreamBuffer(std::ostream* output, int level = -1);
+
+    virtual ~BgzfStreamBuffer();
+
+  private:
+    BgzfStreamBuffer(const BgzfStreamBuffer&);
+    BgzfStreamBuffer& operator=(const BgzfStreamBuffer&);
+
+  public:
+    /**
+     * @return The BGZF virtual offset of the next character to be written.
+     */
+    uint64_t getVirtualOffset() const {
+      return (address_ << 16) | static_cast<uint64_t>(pptr() - pbase());
+    }
+
+    /**
+     * @brief Compress the current block, even if it is not full.
+     *
+     * This allows the next data to start at the beginning of a new block.
+     */
+    void flushBlock();
+
+    /**
+     * @brief Write all pending data and the end-of-file marker.
+     *
+     * No data can be written after this method has been called.
+     */
+    void close();
+
+  protected:
+    int_type overflow(int_type c);
+    std::streamsize xsputn(const char* s, std::streamsize n);
+    int sync();
+
+  private:
+    void writeBlock_(const char* data, size_t size);
+};
+
+/**
+ * @brief Output stream writing BGZF compressed data.
+ *
+ * This stream can be used in place of a std::ofstream with all writers taking a
+ * std::ostream as output.
+ * @code
+ * ofstream file("out.maf.gz", ios::out | ios::binary);
+ * BgzfOutputStream output(&file);
+ * OutputMafIterator writer(iterator, &output);
+ * ...
+ * output.close();
+ * @endcode
+ */
+class BgzfOutputStream:
+  public std::ostream
+{
+  private:
+    BgzfStreamBuffer buffer_;
+
+  public:
+    BgzfOutputStream(std::ostream* output, int level = -1):
+      std::ostream(0), buffer_(output, level)
+    {
+      rdbuf(&buffer_);
+    }
+
+  private:
+    BgzfOutputStream(const BgzfOutputStream&);
+    BgzfOutputStream& operator=(const BgzfOutputStream&);
+
+  public:
+    uint64_t getVirtualOffset() const { return buffer_.getVirtualOffset(); }
+
+    void flushBlock() { buffer_.flushBlock(); }
+
+    void close() { buffer_.close(); }
+};
+
+} // end of namespace bpp.
+
+#endif //_COMPRESSEDOUTPUT_H_
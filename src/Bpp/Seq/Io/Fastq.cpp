@@ -41,6 +41,8 @@ knowledge of the CeCILL license and that you accept its terms.
 #include <Bpp/Seq/SequenceWithQuality.h>
 
 #include <typeinfo>
+#include <algorithm>
+#include <Bpp/Seq/Alphabet/AlphabetExceptions.h>
 
 using namespace bpp;
 
@@ -109,3 +111,70 @@ void Fastq::writeSequence(std::ostream& output, const Sequence& seq) const
   output << std::endl;
   output << qual << std::endl;
 }
+
+/******************************************************************************/
+
+bool Fastq::nextRead(std::istream& input, CompactRead& read) const
+{
+  std::string name, bases, buffer, qualities;
+  while (TextTools::isEmpty(name) && input) {
+    getline(input, name);
+  }
+  if (TextTools::isEmpty(name)) // We hit the end of the file
+    return false;
+  getline(input, bases);
+  getline(input, buffer);
+  getline(input, qualities);
+  if (name[0] != '@')
+    throw IOException("Fastq::nextRead. Record does not start with '@': " + name);
+  read.setName(name.substr(1));
+  if (repeatName() && buffer.substr(1) != read.getName())
+    throw Exception("Names are not equivalent for sequence(@ line) and quality (+ line)");
+  if (qualities.size() != bases.size())
+    throw IOException("Fastq::nextRead. Sequence and quality lines do not have the same size for read " + read.getName());
+  //States are looked up once per distinct character:
+  const Alphabet* alphabet = read.getAlphabet();
+  int codes[256];
+  std::fill(codes, codes + 256, 256);
+  read.resize(bases.size());
+  int8_t* states = read.getBases();
+  uint8_t* scores = read.getQualities();
+  for (size_t i = 0; i < bases.size(); ++i) {
+    unsigned char c = static_cast<unsigned char>(bases[i]);
+    if (codes[c] == 256) {
+      int state = alphabet->charToInt(std::string(1, bases[i]));
+      if (state < -128 || state > 127)
+        throw BadCharException(std::string(1, bases[i]), "Fastq::nextRead. State does not fit in one byte: ", alphabet);
+      codes[c] = state;
+    }
+    states[i] = static_cast<int8_t>(codes[c]);
+    char q = qualities[i];
+    if (q < 33 || q > 126) {
+      throw BadIntegerException("Quality must lie between 33 and 126", q);
+    }
+    scores[i] = static_cast<uint8_t>(q - 33);
+  }
+  return true;
+}
+
+/******************************************************************************/
+
+void Fastq::writeRead(std::ostream& output, const CompactRead& read) const
+{
+  std::string qual(read.size(), ' ');
+  const uint8_t* scores = read.getQualities();
+  for (size_t i = 0; i < read.size(); ++i) {
+    if (scores[i] > 93) {
+      throw BadIntegerException("Quality must lie between 0 and 93", static_cast<int>(scores[i]));
+    }
+    qual[i] = static_cast<char>(scores[i] + 33);
+  }
+  output << "@" << read.getName() << "\n";
+  output << read.toString() << "\n";
+  output << "+";
+  if (repeatName()) {
+    output << read.getName();
+  }
+  output << "\n";
+  output << qual << "\n";
+}
@@ -46,11 +46,20 @@ knowledge of the CeCILL license and that you accept its terms.
 #include <Bpp/Seq/Sequence.h>
 #include <Bpp/Seq/SequenceWithQuality.h>
 
+#include "CompressedInput.h"
+#include "CompactRead.h"
+
 namespace bpp
 {
   /**
    * @brief The fastq sequence file format.
    *
+   * Compressed files (gzip or BGZF) can be read by using a CompressedInputStream
+   * as input stream.
+   *
+   * To process large numbers of reads, FastqBatchReader is much faster, as it avoids
+   * building one sequence object per read.
+   *
    * @author Sylvain Gaillard
    */
   class Fastq:
@@ -121,6 +130,26 @@ namespace bpp
       bool nextSequence(std::istream& input, Sequence& seq) const;
       /** @} */
 
+      /**
+       * @brief Read the next sequence as a CompactRead.
+       *
+       * The read must have an alphabet, which is used to encode the bases.
+       *
+       * @param input The stream to read.
+       * @param read [out] The read object to fill.
+       * @return False if the end of the stream was reached.
+       * @throw BadCharException If a base is not in the alphabet of the read.
+       */
+      bool nextRead(std::istream& input, CompactRead& read) const;
+
+      /**
+       * @brief Write a CompactRead.
+       *
+       * @param output The stream where to write.
+       * @param read The read to write.
+       */
+      void writeRead(std::ostream& output, const CompactRead& read) const;
+
       /**
        * @name The OSequenceStream interface.
        *
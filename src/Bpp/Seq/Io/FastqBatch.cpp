@@ -0,0 +1,216 @@
+//
+// File: FastqBatch.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "FastqBatch.h"
+#include "CompressedInput.h"
+
+//From bpp-core:
+#include <Bpp/Text/TextTools.h>
+
+//From bpp-seq:
+#include <Bpp/Seq/Alphabet/AlphabetExceptions.h>
+
+//From the STL:
+#include <cstring>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+void FastqBatch::addRead(const string& name, const int8_t* bases, const uint8_t* qualities, size_t length)
+{
+  names_.insert(names_.end(), name.begin(), name.end());
+  nameEnds_.push_back(names_.size());
+  bases_.insert(bases_.end(), bases, bases + length);
+  qualities_.insert(qualities_.end(), qualities, qualities + length);
+  readEnds_.push_back(bases_.size());
+}
+
+SequenceWithQuality* FastqBatch::toSequence(size_t i) const
+{
+  size_t n = getLength(i);
+  const int8_t* bases = getBases(i);
+  const uint8_t* qualities = getQualities(i);
+  vector<int> states(bases, bases + n);
+  vector<int> scores(n);
+  for (size_t j = 0; j < n; ++j)
+    scores[j] = static_cast<int>(qualities[j]) + FastqBatchReader::QUALITY_OFFSET;
+  return new SequenceWithQuality(getName(i).toString(), states, scores, alphabet_);
+}
+
+/******************************************************************************/
+
+const uint8_t FastqBatchReader::QUALITY_OFFSET = 33;
+const uint8_t FastqBatchReader::MAX_QUALITY = 93;
+const int8_t FastqBatchReader::INVALID_STATE_ = -128;
+
+FastqBatchReader::FastqBatchReader(istream& input, const Alphabet* alphabet):
+  reader_(new StreamLineReader(&input, 4194304)), alphabet_(alphabet), charCodes_(), nbReads_(0)
+{
+  initCharTable_();
+}
+
+FastqBatchReader::FastqBatchReader(const string& path, const Alphabet* alphabet, unsigned int nbThreads):
+  reader_(new CompressedLineReader(path, nbThreads)), alphabet_(alphabet), charCodes_(), nbReads_(0)
+{
+  initCharTable_();
+}
+
+FastqBatchReader::FastqBatchReader(LineReader* reader, const Alphabet* alphabet):
+  reader_(reader), alphabet_(alphabet), charCodes_(), nbReads_(0)
+{
+  if (!reader)
+    throw NullPointerException("FastqBatchReader (constructor). Line reader should not be a NULL pointer!");
+  initCharTable_();
+}
+
+void FastqBatchReader::initCharTable_()
+{
+  if (!alphabet_)
+    throw NullPointerException("FastqBatchReader (constructor). Alphabet should not be a NULL pointer!");
+  for (int i = 0; i < 256; ++i) {
+    charCodes_[i] = INVALID_STATE_;
+    string str(1, static_cast<char>(i));
+    if (alphabet_->isCharInAlphabet(str)) {
+      int code = alphabet_->charToInt(str);
+      if (code <= INVALID_STATE_ || code > 127)
+        throw Exception("FastqBatchReader (constructor). Alphabet states must fit in one byte.");
+      charCodes_[i] = static_cast<int8_t>(code);
+    }
+  }
+}
+
+/******************************************************************************/
+
+bool FastqBatchReader::nextLine_(TextSpan& line)
+{
+  if (!reader_->nextLine(line))
+    return false;
+  if (line.size > 0 && line[line.size - 1] == '\r')
+    line.size--;
+  return true;
+}
+
+void FastqBatchReader::encodeBases_(const TextSpan& line, int8_t* codes) const
+{
+  //Branch-free loop, errors are only looked for once the whole line is encoded:
+  const unsigned char* chars = reinterpret_cast<const unsigned char*>(line.data);
+  unsigned char invalid = 0;
+  for (size_t i = 0; i < line.size; ++i) {
+    int8_t code = charCodes_[chars[i]];
+    codes[i] = code;
+    invalid |= static_cast<unsigned char>(code == INVALID_STATE_);
+  }
+  if (invalid) {
+    for (size_t i = 0; i < line.size; ++i)
+      if (charCodes_[chars[i]] == INVALID_STATE_)
+        throw BadCharException(string(1, line[i]), "FastqBatchReader::nextRead. Read " + TextTools::toString(nbReads_ + 1) + " contains a character which is not in the alphabet: ", alphabet_);
+  }
+}
+
+void FastqBatchReader::encodeQualities_(const TextSpan& line, uint8_t* qualities) const
+{
+  const unsigned char* chars = reinterpret_cast<const unsigned char*>(line.data);
+  unsigned char invalid = 0;
+  for (size_t i = 0; i < line.size; ++i) {
+    uint8_t q = static_cast<uint8_t>(chars[i] - QUALITY_OFFSET);
+    qualities[i] = q;
+    invalid |= static_cast<unsigned char>(q > MAX_QUALITY);
+  }
+  if (invalid)
+    throw IOException("FastqBatchReader::nextRead. Read " + TextTools::toString(nbReads_ + 1) + " has a quality character out of range [!, ~].");
+}
+
+/******************************************************************************/
+
+bool FastqBatchReader::nextRead(FastqBatch& batch)
+{
+  TextSpan line;
+  //Blank lines between records are ignored:
+  do {
+    if (!nextLine_(line))
+      return false;
+  } while (line.isBlank());
+
+  size_t nameBegin = batch.names_.size();
+  size_t readBegin = batch.bases_.size();
+  try {
+    if (line[0] != '@')
+      throw IOException("FastqBatchReader::nextRead. Read " + TextTools::toString(nbReads_ + 1) + " does not start with '@'.");
+    batch.names_.insert(batch.names_.end(), line.data + 1, line.end());
+    size_t nameLength = line.size - 1;
+
+    if (!nextLine_(line))
+      throw IOException("FastqBatchReader::nextRead. Truncated read " + TextTools::toString(nbReads_ + 1) + ".");
+    size_t length = line.size;
+    batch.bases_.resize(readBegin + length);
+    encodeBases_(line, batch.bases_.data() + readBegin);
+
+    if (!nextLine_(line) || line.empty() || line[0] != '+')
+      throw IOException("FastqBatchReader::nextRead. Missing '+' line for read " + TextTools::toString(nbReads_ + 1) + ".");
+    if (line.size > 1 && (line.size - 1 != nameLength || memcmp(line.data + 1, batch.names_.data() + nameBegin, nameLength) != 0))
+      throw IOException("FastqBatchReader::nextRead. Names are not equivalent for sequence (@ line) and quality (+ line) of read " + TextTools::toString(nbReads_ + 1) + ".");
+
+    if (!nextLine_(line))
+      throw IOException("FastqBatchReader::nextRead. Truncated read " + TextTools::toString(nbReads_ + 1) + ".");
+    if (line.size != length)
+      throw IOException("FastqBatchReader::nextRead. Read " + TextTools::toString(nbReads_ + 1) + " has " + TextTools::toString(length) + " bases but " + TextTools::toString(line.size) + " quality scores.");
+    batch.qualities_.resize(readBegin + length);
+    encodeQualities_(line, batch.qualities_.data() + readBegin);
+  } catch (...) {
+    //Leave the batch as it was before this read:
+    batch.names_.resize(nameBegin);
+    batch.bases_.resize(readBegin);
+    batch.qualities_.resize(readBegin);
+    throw;
+  }
+  batch.nameEnds_.push_back(batch.names_.size());
+  batch.readEnds_.push_back(batch.bases_.size());
+  nbReads_++;
+  return true;
+}
+
+size_t FastqBatchReader::nextBatch(FastqBatch& batch, size_t maxReads)
+{
+  batch.clear();
+  while (batch.size() < maxReads && nextRead(batch)) {}
+  return batch.size();
+}
+
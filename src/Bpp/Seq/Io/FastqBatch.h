@@ -0,0 +1,287 @@
+//
+// File: FastqBatch.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _FASTQBATCH_H_
+#define _FASTQBATCH_H_
+
+#include "LineReader.h"
+#include "CompactRead.h"
+
+//From bpp-seq:
+#include <Bpp/Seq/Alphabet/Alphabet.h>
+#include <Bpp/Seq/SequenceWithQuality.h>
+
+//From the STL:
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief A reusable batch of reads, with names, bases and qualities stored contiguously.
+ *
+ * Bases are stored as one-byte state codes of the batch alphabet, and qualities as
+ * one-byte Phred scores (that is, without the ASCII offset of the FASTQ format), as in CompactRead.
+ * Clearing a batch keeps its allocated memory, so that a single batch can be refilled
+ * for a whole file without any further allocation.
+ *
+ * Names, bases and qualities are returned as pointers into the batch, which remain valid
+ * until the batch is modified.
+ *
+ * @see FastqBatchReader
+ */
+class FastqBatch
+{
+  private:
+    const Alphabet* alphabet_;
+    std::vector<char> names_;
+    std::vector<size_t> nameEnds_;
+    std::vector<int8_t> bases_;
+    std::vector<uint8_t> qualities_;
+    std::vector<size_t> readEnds_;
+
+  public:
+    /**
+     * @param alphabet The alphabet of the reads. Its state codes must fit in one byte.
+     */
+    FastqBatch(const Alphabet* alphabet):
+      alphabet_(alphabet), names_(), nameEnds_(), bases_(), qualities_(), readEnds_() {}
+
+  public:
+    const Alphabet* getAlphabet() const { return alphabet_; }
+
+    /**
+     * @return The number of reads in the batch.
+     */
+    size_t size() const { return readEnds_.size(); }
+
+    bool empty() const { return readEnds_.empty(); }
+
+    /**
+     * @return The total number of bases in the batch.
+     */
+    size_t getNumberOfBases() const { return bases_.size(); }
+
+    /**
+     * @brief Remove all reads, but keep the allocated memory.
+     */
+    void clear() {
+      names_.clear();
+      nameEnds_.clear();
+      bases_.clear();
+      qualities_.clear();
+      readEnds_.clear();
+    }
+
+    /**
+     * @brief Preallocate memory.
+     *
+     * @param nbReads The expected number of reads.
+     * @param nbBases The expected total number of bases.
+     */
+    void reserve(size_t nbReads, size_t nbBases) {
+      nameEnds_.reserve(nbReads);
+      readEnds_.reserve(nbReads);
+      bases_.reserve(nbBases);
+      qualities_.reserve(nbBases);
+    }
+
+    TextSpan getName(size_t i) const {
+      size_t begin = (i == 0 ? 0 : nameEnds_[i - 1]);
+      return TextSpan(names_.data() + begin, nameEnds_[i] - begin);
+    }
+
+    size_t getLength(size_t i) const {
+      return readEnds_[i] - getReadBegin_(i);
+    }
+
+    /**
+     * @return A pointer toward the state codes of a read.
+     */
+    const int8_t* getBases(size_t i) const { return bases_.data() + getReadBegin_(i); }
+
+    /**
+     * @return A pointer toward the Phred quality scores of a read.
+     */
+    const uint8_t* getQualities(size_t i) const { return qualities_.data() + getReadBegin_(i); }
+
+    /**
+     * @brief Append a read to the batch.
+     *
+     * @param name The name of the read.
+     * @param bases The state codes of the read.
+     * @param qualities The Phred quality scores of the read.
+     * @param length The number of bases.
+     */
+    void addRead(const std::string& name, const int8_t* bases, const uint8_t* qualities, size_t length);
+
+    void addRead(const CompactRead& read) {
+      addRead(read.getName(), read.getBases(), read.getQualities(), read.size());
+    }
+
+    /**
+     * @brief Copy a read of the batch.
+     *
+     * @param i The index of the read.
+     * @param read [out] The object where to copy the read.
+     */
+    void getRead(size_t i, CompactRead& read) const {
+      read.setName(getName(i).toString());
+      read.setContent(getBases(i), getQualities(i), getLength(i));
+    }
+
+    /**
+     * @return A new sequence object with the content of a read.
+     * As with Fastq::nextSequence, qualities are stored with their ASCII offset.
+     * @param i The index of the read.
+     */
+    SequenceWithQuality* toSequence(size_t i) const;
+
+  private:
+    size_t getReadBegin_(size_t i) const { return i == 0 ? 0 : readEnds_[i - 1]; }
+
+    friend class FastqBatchReader;
+};
+
+/**
+ * @brief High-throughput FASTQ reader, filling batches of reads.
+ *
+ * Input is read in large chunks through a LineReader, and the lines of each record
+ * are decoded in place, without intermediate strings. Bases are encoded with a lookup
+ * table built once for the alphabet, and qualities are converted in a single pass over
+ * the quality line. Unlike Fastq::nextSequence, records are validated: a record must
+ * start with '@', have as many quality scores as bases, and a name on the '+' line,
+ * if any, must match the one on the '@' line. Windows end of lines are supported.
+ *
+ * @code
+ * FastqBatchReader reader("reads.fastq.gz", &AlphabetTools::DNA_ALPHABET);
+ * FastqBatch batch(&AlphabetTools::DNA_ALPHABET);
+ * while (reader.nextBatch(batch, 100000)) {
+ *   for (size_t i = 0; i < batch.size(); ++i) { ... batch.getBases(i) ... }
+ * }
+ * @endcode
+ */
+class FastqBatchReader
+{
+  public:
+    static const uint8_t QUALITY_OFFSET;
+    static const uint8_t MAX_QUALITY;
+
+  private:
+    static const int8_t INVALID_STATE_;
+
+    std::unique_ptr<LineReader> reader_;
+    const Alphabet* alphabet_;
+    int8_t charCodes_[256];
+    uint64_t nbReads_;
+
+  public:
+    /**
+     * @param input The stream to read from, which is not owned by this object.
+     * @param alphabet The alphabet of the reads. Its state codes must fit in one byte.
+     */
+    FastqBatchReader(std::istream& input, const Alphabet* alphabet);
+
+    /**
+     * @brief Read reads from a file, which may be gzip or BGZF compressed.
+     *
+     * @param path The path of the file to read.
+     * @param alphabet The alphabet of the reads. Its state codes must fit in one byte.
+     * @param nbThreads The number of threads used to decompress BGZF files (0 for one per core).
+     * @see CompressedLineReader
+     */
+    FastqBatchReader(const std::string& path, const Alphabet* alphabet, unsigned int nbThreads = 0);
+
+    /**
+     * @param reader The line reader, which is owned by this object.
+     * @param alphabet The alphabet of the reads. Its state codes must fit in one byte.
+     */
+    FastqBatchReader(LineReader* reader, const Alphabet* alphabet);
+
+  private:
+    //Recopy is forbidden!
+    FastqBatchReader(const FastqBatchReader&);
+    FastqBatchReader& operator=(const FastqBatchReader&);
+
+  public:
+    const Alphabet* getAlphabet() const { return alphabet_; }
+
+    /**
+     * @brief Read the next reads.
+     *
+     * @param batch [out] The batch to fill. It is cleared first.
+     * @param maxReads The maximum number of reads to read.
+     * @return The number of reads read, 0 if the end of input was reached.
+     * @throw IOException If a record is malformed or truncated.
+     * @throw BadCharException If a base is not in the alphabet.
+     */
+    size_t nextBatch(FastqBatch& batch, size_t maxReads);
+
+    /**
+     * @brief Read the next read and append it to a batch.
+     *
+     * @param batch [out] The batch to which the read is added.
+     * @return False if the end of input was reached.
+     */
+    bool nextRead(FastqBatch& batch);
+
+    /**
+     * @return The number of reads read so far.
+     */
+    uint64_t getNumberOfReads() const { return nbReads_; }
+
+    /**
+     * @return The underlying line reader.
+     */
+    LineReader& getLineReader() { return *reader_; }
+
+  private:
+    void initCharTable_();
+    bool nextLine_(TextSpan& line);
+    void encodeBases_(const TextSpan& line, int8_t* codes) const;
+    void encodeQualities_(const TextSpan& line, uint8_t* qualities) const;
+};
+
+} // end of namespace bpp.
+
+#endif //_FASTQBATCH_H_
+
@@ -0,0 +1,300 @@
+//
+// File: FastqBatchWriter.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "FastqBatchWriter.h"
+
+//From bpp-core:
+#include <Bpp/Text/TextTools.h>
+
+//From the STL:
+#include <cstring>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+const short FastqBatchWriter::FORMAT_PLAIN = 0;
+const short FastqBatchWriter::FORMAT_BGZF = 1;
+
+FastqBatchWriter::FastqBatchWriter(ostream& output, bool repeatName, bool background, size_t bufferSize):
+  file_(), bgzf_(), output_(&output), repeatName_(repeatName), bufferSize_(bufferSize),
+  buffer_(), alphabet_(0), chars_(), closed_(false),
+  background_(background), thread_(), pending_(), free_(), maxPending_(4), stop_(false), error_(),
+  mutex_(), notEmpty_(), notFull_()
+{
+  init_();
+}
+
+FastqBatchWriter::FastqBatchWriter(const string& path, short format, int level, bool repeatName, bool background, size_t bufferSize):
+  file_(new ofstream(path.c_str(), ios::out | ios::binary)), bgzf_(), output_(0), repeatName_(repeatName), bufferSize_(bufferSize),
+  buffer_(), alphabet_(0), chars_(), closed_(false),
+  background_(background), thread_(), pending_(), free_(), maxPending_(4), stop_(false), error_(),
+  mutex_(), notEmpty_(), notFull_()
+{
+  if (!*file_)
+    throw IOException("FastqBatchWriter (constructor). Could not create file " + path + ".");
+  if (format == FORMAT_BGZF) {
+    bgzf_.reset(new BgzfOutputStream(file_.get(), level));
+    output_ = bgzf_.get();
+  } else if (format == FORMAT_PLAIN) {
+    output_ = file_.get();
+  } else {
+    throw Exception("FastqBatchWriter (constructor). Unknown format: " + TextTools::toString(format) + ".");
+  }
+  init_();
+}
+
+FastqBatchWriter::~FastqBatchWriter()
+{
+  try {
+    close();
+  } catch (...) {
+    //Errors can only be reported by an explicit call to close().
+  }
+}
+
+void FastqBatchWriter::init_()
+{
+  if (bufferSize_ == 0)
+    throw Exception("FastqBatchWriter (constructor). Buffer size must be positive.");
+  buffer_.reserve(bufferSize_);
+  if (background_)
+    thread_ = thread(&FastqBatchWriter::writerLoop_, this);
+}
+
+void FastqBatchWriter::setAlphabet_(const Alphabet* alphabet)
+{
+  if (alphabet == alphabet_) return;
+  if (!alphabet)
+    throw NullPointerException("FastqBatchWriter::write. Reads have no alphabet.");
+  for (int i = -128; i < 128; ++i) {
+    chars_[static_cast<uint8_t>(i)] = '\0';
+    if (alphabet->isIntInAlphabet(i))
+      chars_[static_cast<uint8_t>(i)] = alphabet->intToChar(i)[0];
+  }
+  alphabet_ = alphabet;
+}
+
+/******************************************************************************/
+
+void FastqBatchWriter::append_(const char* name, size_t nameLength, const int8_t* bases, const uint8_t* qualities, size_t length)
+{
+  size_t pos = buffer_.size();
+  buffer_.resize(pos + 2 * length + (repeatName_ ? 2 : 1) * nameLength + 6);
+  char* out = &buffer_[pos];
+  *out++ = '@';
+  memcpy(out, name, nameLength);
+  out += nameLength;
+  *out++ = '\n';
+  unsigned char invalid = 0;
+  for (size_t i = 0; i < length; ++i) {
+    char c = chars_[static_cast<uint8_t>(bases[i])];
+    out[i] = c;
+    invalid |= static_cast<unsigned char>(c == '\0');
+  }
+  out += length;
+  *out++ = '\n';
+  *out++ = '+';
+  if (repeatName_) {
+    memcpy(out, name, nameLength);
+    out += nameLength;
+  }
+  *out++ = '\n';
+  for (size_t i = 0; i < length; ++i) {
+    uint8_t q = qualities[i];
+    out[i] = static_cast<char>(q + FastqBatchReader::QUALITY_OFFSET);
+    invalid |= static_cast<unsigned char>(q > FastqBatchReader::MAX_QUALITY);
+  }
+  out += length;
+  *out++ = '\n';
+  if (invalid) {
+    buffer_.resize(pos);
+    throw Exception("FastqBatchWriter::write. Read " + string(name, nameLength) + " has a state which is not in the alphabet, or a quality above " + TextTools::toString(static_cast<int>(FastqBatchReader::MAX_QUALITY)) + ".");
+  }
+}
+
+void FastqBatchWriter::write(const FastqBatch& batch)
+{
+  if (closed_)
+    throw Exception("FastqBatchWriter::write. Writer is closed.");
+  checkError_();
+  if (batch.empty()) return;
+  setAlphabet_(batch.getAlphabet());
+  for (size_t i = 0; i < batch.size(); ++i) {
+    TextSpan name = batch.getName(i);
+    append_(name.data, name.size, batch.getBases(i), batch.getQualities(i), batch.getLength(i));
+    if (buffer_.size() >= bufferSize_)
+      submit_();
+  }
+}
+
+void FastqBatchWriter::write(const CompactRead& read)
+{
+  if (closed_)
+    throw Exception("FastqBatchWriter::write. Writer is closed.");
+  checkError_();
+  setAlphabet_(read.getAlphabet());
+  append_(read.getName().data(), read.getName().size(), read.getBases(), read.getQualities(), read.size());
+  if (buffer_.size() >= bufferSize_)
+    submit_();
+}
+
+/******************************************************************************/
+
+void FastqBatchWriter::submit_()
+{
+  if (buffer_.empty()) return;
+  if (!background_) {
+    output_->write(buffer_.data(), static_cast<streamsize>(buffer_.size()));
+    buffer_.clear();
+    if (!*output_)
+      throw IOException("FastqBatchWriter::write. Output error.");
+    return;
+  }
+  vector<char> next;
+  {
+    unique_lock<mutex> lock(mutex_);
+    while (pending_.size() >= maxPending_ && !error_)
+      notFull_.wait(lock);
+    if (error_)
+      rethrow_exception(error_);
+    pending_.push_back(vector<char>());
+    pending_.back().swap(buffer_);
+    //Buffers are recycled:
+    if (!free_.empty()) {
+      next.swap(free_.front());
+      free_.pop_front();
+    }
+  }
+  notEmpty_.notify_one();
+  buffer_.swap(next);
+  buffer_.clear();
+  buffer_.reserve(bufferSize_);
+}
+
+void FastqBatchWriter::checkError_()
+{
+  if (!background_) return;
+  lock_guard<mutex> lock(mutex_);
+  if (error_)
+    rethrow_exception(error_);
+}
+
+void FastqBatchWriter::writerLoop_()
+{
+  while (true) {
+    vector<char> data;
+    {
+      unique_lock<mutex> lock(mutex_);
+      while (!stop_ && pending_.empty())
+        notEmpty_.wait(lock);
+      if (pending_.empty())
+        return; //Stopped, and nothing left to write.
+      data.swap(pending_.front());
+      //The buffer stays in the queue while it is written, so that flush() waits for it:
+    }
+    try {
+      output_->write(data.data(), static_cast<streamsize>(data.size()));
+      if (!*output_)
+        throw IOException("FastqBatchWriter::write. Output error.");
+    } catch (...) {
+      lock_guard<mutex> lock(mutex_);
+      error_ = current_exception();
+      pending_.clear();
+      notFull_.notify_all();
+      return;
+    }
+    {
+      lock_guard<mutex> lock(mutex_);
+      pending_.pop_front();
+      if (free_.size() < maxPending_) {
+        data.clear();
+        free_.push_back(vector<char>());
+        free_.back().swap(data);
+      }
+    }
+    notFull_.notify_all();
+  }
+}
+
+void FastqBatchWriter::flush()
+{
+  submit_();
+  if (background_) {
+    unique_lock<mutex> lock(mutex_);
+    while (!pending_.empty() && !error_)
+      notFull_.wait(lock);
+    if (error_)
+      rethrow_exception(error_);
+  }
+  output_->flush();
+}
+
+void FastqBatchWriter::close()
+{
+  if (closed_) return;
+  closed_ = true;
+  exception_ptr error;
+  try {
+    submit_();
+  } catch (...) {
+    //The thread is still stopped before reporting the error:
+    error = current_exception();
+  }
+  if (background_) {
+    {
+      lock_guard<mutex> lock(mutex_);
+      stop_ = true;
+    }
+    notEmpty_.notify_all();
+    thread_.join();
+    if (error_)
+      error = error_;
+  }
+  if (error)
+    rethrow_exception(error);
+  if (bgzf_)
+    bgzf_->close();
+  if (file_)
+    file_->close();
+  else
+    output_->flush();
+}
+
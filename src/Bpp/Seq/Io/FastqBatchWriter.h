@@ -0,0 +1,182 @@
+//
+// File: FastqBatchWriter.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _FASTQBATCHWRITER_H_
+#define _FASTQBATCHWRITER_H_
+
+#include "FastqBatch.h"
+#include "CompressedOutput.h"
+
+//From the STL:
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+namespace bpp {
+
+/**
+ * @brief High-throughput FASTQ writer, for batches of reads.
+ *
+ * Reads are formatted into large buffers, using a table built once for the alphabet, and
+ * buffers are only written when full, without any flush between records. Optionally, writing
+ * (and compressing, for BGZF output) takes place on a background thread, while the caller formats
+ * the next reads. Errors occurring on the background thread are forwarded to the caller at the
+ * next call to write() or close().
+ *
+ * @code
+ * FastqBatchWriter writer("filtered.fastq.gz", FastqBatchWriter::FORMAT_BGZF);
+ * while (reader.nextBatch(batch, 100000)) {
+ *   ... filter batch ...
+ *   writer.write(batch);
+ * }
+ * writer.close();
+ * @endcode
+ *
+ * @see FastqBatchReader
+ */
+class FastqBatchWriter
+{
+  public:
+    static const short FORMAT_PLAIN;
+    static const short FORMAT_BGZF;
+
+  private:
+    std::unique_ptr<std::ofstream> file_;
+    std::unique_ptr<BgzfOutputStream> bgzf_;
+    std::ostream* output_;
+    bool repeatName_;
+    size_t bufferSize_;
+    std::vector<char> buffer_;
+    const Alphabet* alphabet_;
+    char chars_[256];
+    bool closed_;
+
+    //Background writing:
+    bool background_;
+    std::thread thread_;
+    std::deque< std::vector<char> > pending_;
+    std::deque< std::vector<char> > free_;
+    size_t maxPending_;
+    bool stop_;
+    std::exception_ptr error_;
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+
+  public:
+    /**
+     * @brief Write reads to a stream.
+     *
+     * @param output The stream where to write, which is not owned by this object.
+     * @param repeatName Tell if the name of the reads should be repeated on the '+' line.
+     * @param background Tell if buffers should be written on a background thread.
+     * @param bufferSize The size of the buffers, in bytes.
+     */
+    FastqBatchWriter(std::ostream& output, bool repeatName = false, bool background = true, size_t bufferSize = 4194304);
+
+    /**
+     * @brief Write reads to a file.
+     *
+     * @param path The path of the file to create.
+     * @param format The format of the file, FORMAT_PLAIN or FORMAT_BGZF. BGZF files can be read by any gzip reader.
+     * @param level The compression level, for BGZF output.
+     * @param repeatName Tell if the name of the reads should be repeated on the '+' line.
+     * @param background Tell if buffers should be written (and compressed) on a background thread.
+     * @param bufferSize The size of the buffers, in bytes.
+     * @throw IOException If the file cannot be created.
+     */
+    FastqBatchWriter(const std::string& path, short format = FORMAT_PLAIN, int level = -1, bool repeatName = false, bool background = true, size_t bufferSize = 4194304);
+
+    virtual ~FastqBatchWriter();
+
+  private:
+    //Recopy is forbidden!
+    FastqBatchWriter(const FastqBatchWriter&);
+    FastqBatchWriter& operator=(const FastqBatchWriter&);
+
+  public:
+    /**
+     * @brief Write all reads of a batch.
+     *
+     * @param batch The reads to write.
+     * @throw Exception If a state is not in the alphabet, if a quality is above 93, or if a previous write failed.
+     */
+    void write(const FastqBatch& batch);
+
+    /**
+     * @brief Write a single read.
+     *
+     * @param read The read to write.
+     */
+    void write(const CompactRead& read);
+
+    /**
+     * @brief Write all buffered reads to the output stream.
+     *
+     * In background mode, this waits until all buffers have been written.
+     */
+    void flush();
+
+    /**
+     * @brief Write all buffered reads, and close the file, if any.
+     *
+     * No read can be written after this method has been called.
+     */
+    void close();
+
+  private:
+    void init_();
+    void setAlphabet_(const Alphabet* alphabet);
+    void append_(const char* name, size_t nameLength, const int8_t* bases, const uint8_t* qualities, size_t length);
+    void submit_();
+    void checkError_();
+    void writerLoop_();
+};
+
+} // end of namespace bpp.
+
+#endif //_FASTQBATCHWRITER_H_
+
@@ -0,0 +1,235 @@
+//
+// File: FastqIndex.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "FastqIndex.h"
+#include "CompressedInput.h"
+
+//From bpp-core:
+#include <Bpp/Text/TextTools.h>
+
+//From the STL:
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+
+using namespace bpp;
+using namespace std;
+
+namespace {
+  //Compare reads by name, then by ordinal:
+  struct NameOrder_ {
+    const bpp::FastqIndex& index;
+    NameOrder_(const bpp::FastqIndex& idx): index(idx) {}
+    bool operator()(size_t i, size_t j) const {
+      bpp::TextSpan a = index.getName(i), b = index.getName(j);
+      int c = memcmp(a.data, b.data, min(a.size, b.size));
+      if (c != 0) return c < 0;
+      if (a.size != b.size) return a.size < b.size;
+      return i < j;
+    }
+  };
+
+  size_t nameLength_(const bpp::TextSpan& line) {
+    size_t n = 1;
+    while (n < line.size && !bpp::TextSpan::isSpace(line[n])) ++n;
+    return n - 1;
+  }
+}
+
+/******************************************************************************/
+
+FastqIndex FastqIndex::build(const string& path, unsigned int nbThreads)
+{
+  CompressedLineReader reader(path, nbThreads);
+  if (!reader.isSeekable())
+    throw IOException("FastqIndex::build. File " + path + " is gzip compressed and cannot be indexed, compress it with bgzip instead.");
+  FastqIndex index;
+  TextSpan line;
+  while (true) {
+    //Blank lines between records are ignored:
+    bool eof;
+    do {
+      eof = !reader.nextLine(line);
+    } while (!eof && line.isBlank());
+    if (eof) break;
+    if (line[0] != '@')
+      throw IOException("FastqIndex::build. Read " + TextTools::toString(index.getNumberOfReads() + 1) + " does not start with '@' in file " + path + ".");
+    index.offsets_.push_back(reader.getLineOffset());
+    index.names_.insert(index.names_.end(), line.data + 1, line.data + 1 + nameLength_(line));
+    index.nameEnds_.push_back(index.names_.size());
+    if (!reader.nextLine(line))
+      throw IOException("FastqIndex::build. Truncated read " + TextTools::toString(index.getNumberOfReads()) + " in file " + path + ".");
+    size_t length = line.size;
+    if (length > 0 && line[length - 1] == '\r') length--;
+    index.lengths_.push_back(static_cast<uint32_t>(length));
+    if (!reader.nextLine(line) || !reader.nextLine(line))
+      throw IOException("FastqIndex::build. Truncated read " + TextTools::toString(index.getNumberOfReads()) + " in file " + path + ".");
+  }
+  index.sort_();
+  return index;
+}
+
+FastqIndex FastqIndex::load(const string& path, unsigned int nbThreads)
+{
+  string indexPath = getIndexPath(path);
+  ifstream test(indexPath.c_str(), ios::in);
+  if (test) {
+    test.close();
+    FastqIndex index;
+    index.read(indexPath);
+    return index;
+  }
+  FastqIndex index = build(path, nbThreads);
+  index.write(indexPath);
+  return index;
+}
+
+void FastqIndex::sort_()
+{
+  sorted_.resize(offsets_.size());
+  for (size_t i = 0; i < sorted_.size(); ++i)
+    sorted_[i] = i;
+  sort(sorted_.begin(), sorted_.end(), NameOrder_(*this));
+}
+
+/******************************************************************************/
+
+void FastqIndex::write(const string& indexPath) const
+{
+  ofstream output(indexPath.c_str(), ios::out | ios::binary);
+  if (!output)
+    throw IOException("FastqIndex::write. Could not create file " + indexPath + ".");
+  for (size_t i = 0; i < getNumberOfReads(); ++i) {
+    TextSpan name = getName(i);
+    output.write(name.data, static_cast<streamsize>(name.size));
+    output << "\t" << offsets_[i] << "\t" << lengths_[i] << "\n";
+  }
+  if (!output)
+    throw IOException("FastqIndex::write. Error while writing file " + indexPath + ".");
+}
+
+void FastqIndex::read(const string& indexPath)
+{
+  ifstream input(indexPath.c_str(), ios::in | ios::binary);
+  if (!input)
+    throw IOException("FastqIndex::read. Could not open file " + indexPath + ".");
+  names_.clear();
+  nameEnds_.clear();
+  offsets_.clear();
+  lengths_.clear();
+  StreamLineReader reader(&input);
+  TextSpan line;
+  while (reader.nextLine(line)) {
+    if (line.isBlank()) continue;
+    size_t pos = 0;
+    TextSpan name, offset, length, extra;
+    if (!line.nextToken(pos, name) || !line.nextToken(pos, offset) || !line.nextToken(pos, length) || line.nextToken(pos, extra))
+      throw IOException("FastqIndex::read. Invalid line in file " + indexPath + ": " + line.toString());
+    names_.insert(names_.end(), name.begin(), name.end());
+    nameEnds_.push_back(names_.size());
+    offsets_.push_back(offset.toUnsignedInteger());
+    lengths_.push_back(static_cast<uint32_t>(length.toUnsignedInteger()));
+  }
+  sort_();
+}
+
+/******************************************************************************/
+
+bool FastqIndex::find(const string& name, size_t& i) const
+{
+  //First read with a name not lower than the one searched:
+  size_t lo = 0, hi = sorted_.size();
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    TextSpan n = getName(sorted_[mid]);
+    int c = memcmp(n.data, name.data(), min(n.size, name.size()));
+    if (c < 0 || (c == 0 && n.size < name.size()))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo < sorted_.size() && getName(sorted_[lo]) == name) {
+    i = sorted_[lo];
+    return true;
+  }
+  return false;
+}
+
+void FastqIndex::fetch(FastqBatchReader& reader, size_t begin, size_t end, FastqBatch& batch) const
+{
+  if (end > getNumberOfReads())
+    throw IndexOutOfBoundsException("FastqIndex::fetch.", end, 0, getNumberOfReads());
+  if (begin >= end) return;
+  reader.getLineReader().seek(offsets_[begin]);
+  for (size_t i = begin; i < end; ++i) {
+    if (!reader.nextRead(batch))
+      throw IOException("FastqIndex::fetch. Unexpected end of file, the index may not match the file.");
+  }
+}
+
+bool FastqIndex::fetch(FastqBatchReader& reader, const string& name, FastqBatch& batch) const
+{
+  size_t i;
+  if (!find(name, i))
+    return false;
+  fetch(reader, i, batch);
+  return true;
+}
+
+vector<size_t> FastqIndex::split(size_t nbParts) const
+{
+  if (nbParts == 0)
+    throw Exception("FastqIndex::split. The number of parts must be positive.");
+  uint64_t total = 0;
+  for (size_t i = 0; i < lengths_.size(); ++i)
+    total += lengths_[i] + 1;
+  vector<size_t> bounds(1, 0);
+  uint64_t cumul = 0;
+  for (size_t i = 0; i < lengths_.size() && bounds.size() < nbParts; ++i) {
+    cumul += lengths_[i] + 1;
+    if (cumul * nbParts >= total * bounds.size())
+      bounds.push_back(i + 1);
+  }
+  bounds.push_back(getNumberOfReads());
+  bounds.erase(unique(bounds.begin(), bounds.end()), bounds.end());
+  if (bounds.size() == 1)
+    bounds.push_back(bounds[0]);
+  return bounds;
+}
+
@@ -0,0 +1,184 @@
+//
+// File: FastqIndex.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _FASTQINDEX_H_
+#define _FASTQINDEX_H_
+
+#include "FastqBatch.h"
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief Random-access index of the records in a FASTQ file.
+ *
+ * The index stores, for each read, its name (up to the first white space), its length and the
+ * offset of its record in the file: a byte offset for uncompressed files, and a BGZF virtual offset
+ * for BGZF files. Plain gzip files cannot be indexed, as they do not support random access.
+ *
+ * Indexes are saved in a sidecar file, named after the FASTQ file with the ".fqi" extension, with one
+ * tab-separated line per read (name, offset and length). Reads can then be fetched by name or by ordinal,
+ * and ranges of records can be assigned to independent readers, e.g. one per thread.
+ *
+ * @code
+ * FastqIndex index = FastqIndex::load("reads.fastq.gz"); //Built and saved if needed.
+ * FastqBatchReader reader("reads.fastq.gz", &AlphabetTools::DNA_ALPHABET);
+ * FastqBatch batch(&AlphabetTools::DNA_ALPHABET);
+ * index.fetch(reader, "read42", batch);
+ * @endcode
+ */
+class FastqIndex
+{
+  private:
+    std::vector<char> names_;
+    std::vector<size_t> nameEnds_;
+    std::vector<uint64_t> offsets_;
+    std::vector<uint32_t> lengths_;
+    std::vector<size_t> sorted_; //Reads sorted by name.
+
+  public:
+    FastqIndex(): names_(), nameEnds_(), offsets_(), lengths_(), sorted_() {}
+
+  public:
+    /**
+     * @brief Index a file, which may be BGZF compressed.
+     *
+     * @param path The FASTQ file.
+     * @param nbThreads The number of threads used to decompress BGZF files (0 for one per core).
+     * @return The index of the file.
+     * @throw IOException If the file is gzip compressed, cannot be read, or is not a valid FASTQ file.
+     */
+    static FastqIndex build(const std::string& path, unsigned int nbThreads = 0);
+
+    /**
+     * @brief Read the index of a file from its sidecar file, or build and save it if it does not exist.
+     *
+     * @param path The FASTQ file.
+     * @param nbThreads The number of threads used to decompress BGZF files, if the index has to be built.
+     * @return The index of the file.
+     */
+    static FastqIndex load(const std::string& path, unsigned int nbThreads = 0);
+
+    /**
+     * @return The path of the sidecar index file of a FASTQ file.
+     */
+    static std::string getIndexPath(const std::string& path) { return path + ".fqi"; }
+
+    /**
+     * @brief Write the index to a file.
+     *
+     * @param indexPath The file to create, typically getIndexPath(path).
+     */
+    void write(const std::string& indexPath) const;
+
+    /**
+     * @brief Read an index from a file.
+     *
+     * @param indexPath The index file.
+     * @throw IOException If the file cannot be read or is not a valid index.
+     */
+    void read(const std::string& indexPath);
+
+    size_t getNumberOfReads() const { return offsets_.size(); }
+
+    TextSpan getName(size_t i) const {
+      size_t begin = (i == 0 ? 0 : nameEnds_[i - 1]);
+      return TextSpan(names_.data() + begin, nameEnds_[i] - begin);
+    }
+
+    uint64_t getOffset(size_t i) const { return offsets_[i]; }
+
+    size_t getLength(size_t i) const { return lengths_[i]; }
+
+    /**
+     * @brief Look for a read by name.
+     *
+     * @param name The name of the read, up to the first white space.
+     * @param i [out] The ordinal of the read, if found. If several reads have this name, the first one is returned.
+     * @return True if the read was found.
+     */
+    bool find(const std::string& name, size_t& i) const;
+
+    /**
+     * @brief Read a given read.
+     *
+     * @param reader A reader on the indexed file. Its line reader must be seekable.
+     * @param i The ordinal of the read.
+     * @param batch [out] The batch to which the read is added.
+     */
+    void fetch(FastqBatchReader& reader, size_t i, FastqBatch& batch) const { fetch(reader, i, i + 1, batch); }
+
+    /**
+     * @brief Read a range of reads.
+     *
+     * @param reader A reader on the indexed file. Its line reader must be seekable.
+     * @param begin The ordinal of the first read.
+     * @param end The ordinal after the last read.
+     * @param batch [out] The batch to which the reads are added.
+     */
+    void fetch(FastqBatchReader& reader, size_t begin, size_t end, FastqBatch& batch) const;
+
+    /**
+     * @brief Read a read given its name.
+     *
+     * @return False if no read with this name is in the index.
+     */
+    bool fetch(FastqBatchReader& reader, const std::string& name, FastqBatch& batch) const;
+
+    /**
+     * @brief Cut the file into parts with approximately the same number of bases.
+     *
+     * @param nbParts The number of parts.
+     * @return The ordinals of the first read of each part, followed by the number of reads.
+     * Each range can be read with fetch(), on distinct readers.
+     */
+    std::vector<size_t> split(size_t nbParts) const;
+
+  private:
+    void sort_();
+};
+
+} // end of namespace bpp.
+
+#endif //_FASTQINDEX_H_
+
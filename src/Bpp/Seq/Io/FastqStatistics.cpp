@@ -0,0 +1,306 @@
+//
+// File: FastqStatistics.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "FastqStatistics.h"
+
+//From bpp-core:
+#include <Bpp/Text/TextTools.h>
+
+//From bpp-seq:
+#include <Bpp/Seq/Alphabet/AlphabetTools.h>
+
+//From the STL:
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+const size_t FastqStatistics::NB_QUALITIES = 94;
+
+FastqStatistics::FastqStatistics(const Alphabet* alphabet):
+  alphabet_(alphabet), nbStates_(0), isNucleic_(false), columns_(256),
+  qualityCounts_(), stateCounts_(), lengthCounts_(), gcCounts_(101, 0),
+  nbReads_(0), nbBases_(0), nbGc_(0), nbResolved_(0)
+{
+  if (!alphabet)
+    throw NullPointerException("FastqStatistics (constructor). Alphabet should not be a NULL pointer!");
+  size_t size = alphabet->getSize();
+  nbStates_ = size + 1;
+  isNucleic_ = AlphabetTools::isNucleicAlphabet(alphabet);
+  for (int i = -128; i < 128; ++i) {
+    columns_[static_cast<uint8_t>(i)] = static_cast<uint8_t>(i >= 0 && static_cast<size_t>(i) < size ? i : size);
+  }
+}
+
+void FastqStatistics::resize_(size_t length)
+{
+  lengthCounts_.resize(length + 1, 0);
+  qualityCounts_.resize(length * NB_QUALITIES, 0);
+  stateCounts_.resize(length * nbStates_, 0);
+}
+
+void FastqStatistics::clear()
+{
+  qualityCounts_.clear();
+  stateCounts_.clear();
+  lengthCounts_.clear();
+  gcCounts_.assign(101, 0);
+  nbReads_ = 0;
+  nbBases_ = 0;
+  nbGc_ = 0;
+  nbResolved_ = 0;
+}
+
+/******************************************************************************/
+
+void FastqStatistics::add(const int8_t* bases, const uint8_t* qualities, size_t length)
+{
+  if (length >= lengthCounts_.size())
+    resize_(length);
+  lengthCounts_[length]++;
+  nbReads_++;
+  nbBases_ += length;
+  uint64_t* qCounts = qualityCounts_.data();
+  for (size_t i = 0; i < length; ++i)
+    qCounts[i * NB_QUALITIES + min(static_cast<size_t>(qualities[i]), NB_QUALITIES - 1)]++;
+  uint64_t* sCounts = stateCounts_.data();
+  const uint8_t* columns = columns_.data();
+  for (size_t i = 0; i < length; ++i)
+    sCounts[i * nbStates_ + columns[static_cast<uint8_t>(bases[i])]]++;
+  if (isNucleic_) {
+    //C and G have codes 1 and 2 in both DNA and RNA alphabets:
+    size_t gc = 0, resolved = 0;
+    for (size_t i = 0; i < length; ++i) {
+      uint8_t c = columns[static_cast<uint8_t>(bases[i])];
+      resolved += (c < 4);
+      gc += (c == 1 || c == 2);
+    }
+    if (resolved > 0)
+      gcCounts_[(100 * gc + resolved / 2) / resolved]++;
+    nbGc_ += gc;
+    nbResolved_ += resolved;
+  }
+}
+
+void FastqStatistics::add(const FastqBatch& batch)
+{
+  if (batch.getAlphabet() != alphabet_ && !batch.getAlphabet()->equals(*alphabet_))
+    throw AlphabetMismatchException("FastqStatistics::add. Alphabets do not match.", alphabet_, batch.getAlphabet());
+  for (size_t i = 0; i < batch.size(); ++i)
+    add(batch.getBases(i), batch.getQualities(i), batch.getLength(i));
+}
+
+void FastqStatistics::merge(const FastqStatistics& stats)
+{
+  if (stats.alphabet_ != alphabet_ && !stats.alphabet_->equals(*alphabet_))
+    throw AlphabetMismatchException("FastqStatistics::merge. Alphabets do not match.", alphabet_, stats.alphabet_);
+  if (stats.lengthCounts_.size() > lengthCounts_.size())
+    resize_(stats.lengthCounts_.size() - 1);
+  for (size_t i = 0; i < stats.lengthCounts_.size(); ++i)
+    lengthCounts_[i] += stats.lengthCounts_[i];
+  for (size_t i = 0; i < stats.qualityCounts_.size(); ++i)
+    qualityCounts_[i] += stats.qualityCounts_[i];
+  for (size_t i = 0; i < stats.stateCounts_.size(); ++i)
+    stateCounts_[i] += stats.stateCounts_[i];
+  for (size_t i = 0; i < gcCounts_.size(); ++i)
+    gcCounts_[i] += stats.gcCounts_[i];
+  nbReads_ += stats.nbReads_;
+  nbBases_ += stats.nbBases_;
+  nbGc_ += stats.nbGc_;
+  nbResolved_ += stats.nbResolved_;
+}
+
+/******************************************************************************/
+
+uint64_t FastqStatistics::getNumberOfBases(size_t cycle) const
+{
+  uint64_t n = 0;
+  for (size_t q = 0; q < NB_QUALITIES; ++q)
+    n += getQualityCount(cycle, q);
+  return n;
+}
+
+double FastqStatistics::getMeanQuality(size_t cycle) const
+{
+  uint64_t n = 0;
+  double sum = 0;
+  for (size_t q = 0; q < NB_QUALITIES; ++q) {
+    uint64_t c = getQualityCount(cycle, q);
+    n += c;
+    sum += static_cast<double>(q) * static_cast<double>(c);
+  }
+  return n > 0 ? sum / static_cast<double>(n) : 0.;
+}
+
+unsigned int FastqStatistics::getQualityQuantile(size_t cycle, double prob) const
+{
+  uint64_t n = getNumberOfBases(cycle);
+  if (n == 0) return 0;
+  //Smallest score such that at least a proportion prob of the bases have a lower or equal score:
+  uint64_t target = max(static_cast<uint64_t>(ceil(prob * static_cast<double>(n))), static_cast<uint64_t>(1));
+  uint64_t cumul = 0;
+  for (size_t q = 0; q < NB_QUALITIES; ++q) {
+    cumul += getQualityCount(cycle, q);
+    if (cumul >= target)
+      return static_cast<unsigned int>(q);
+  }
+  return static_cast<unsigned int>(NB_QUALITIES - 1);
+}
+
+void FastqStatistics::printPerCycle(ostream& output) const
+{
+  output << "cycle\tmean\tq25\tmedian\tq75";
+  for (size_t s = 0; s + 1 < nbStates_; ++s)
+    output << "\t" << alphabet_->intToChar(static_cast<int>(s));
+  output << "\tother" << endl;
+  for (size_t cycle = 0; cycle < getMaximumLength(); ++cycle) {
+    double n = static_cast<double>(getNumberOfBases(cycle));
+    output << (cycle + 1) << "\t" << getMeanQuality(cycle) << "\t" << getQualityQuantile(cycle, 0.25)
+      << "\t" << getQualityQuantile(cycle, 0.5) << "\t" << getQualityQuantile(cycle, 0.75);
+    for (size_t s = 0; s < nbStates_; ++s)
+      output << "\t" << (n > 0 ? static_cast<double>(getStateCount(cycle, s)) / n : 0.);
+    output << "\n";
+  }
+  output.flush();
+}
+
+/******************************************************************************/
+
+void FastqQualityControl::compute(FastqBatchReader& reader, FastqStatistics& stats, unsigned int nbThreads, size_t batchSize)
+{
+  if (nbThreads == 0)
+    nbThreads = max(thread::hardware_concurrency(), 1u);
+  if (batchSize == 0)
+    throw Exception("FastqQualityControl::compute. Batch size must be positive.");
+
+  //Batches circulate between the reader (this thread) and the workers:
+  deque< shared_ptr<FastqBatch> > full, empty;
+  bool done = false;
+  exception_ptr error;
+  mutex m;
+  condition_variable fullAvailable, emptyAvailable;
+  for (unsigned int i = 0; i < 2 * nbThreads; ++i)
+    empty.push_back(shared_ptr<FastqBatch>(new FastqBatch(reader.getAlphabet())));
+
+  vector< unique_ptr<FastqStatistics> > partial;
+  vector<thread> workers;
+  for (unsigned int i = 0; i < nbThreads; ++i) {
+    partial.push_back(unique_ptr<FastqStatistics>(new FastqStatistics(stats.getAlphabet())));
+    FastqStatistics* local = partial.back().get();
+    workers.push_back(thread([&, local]() {
+      while (true) {
+        shared_ptr<FastqBatch> batch;
+        {
+          unique_lock<mutex> lock(m);
+          while (!done && full.empty())
+            fullAvailable.wait(lock);
+          if (full.empty())
+            return;
+          batch = full.front();
+          full.pop_front();
+        }
+        try {
+          local->add(*batch);
+        } catch (...) {
+          lock_guard<mutex> lock(m);
+          if (!error)
+            error = current_exception();
+        }
+        {
+          lock_guard<mutex> lock(m);
+          empty.push_back(batch);
+        }
+        emptyAvailable.notify_one();
+      }
+    }));
+  }
+
+  try {
+    while (true) {
+      shared_ptr<FastqBatch> batch;
+      {
+        unique_lock<mutex> lock(m);
+        while (empty.empty())
+          emptyAvailable.wait(lock);
+        if (error)
+          break;
+        batch = empty.front();
+        empty.pop_front();
+      }
+      if (reader.nextBatch(*batch, batchSize) == 0)
+        break;
+      {
+        lock_guard<mutex> lock(m);
+        full.push_back(batch);
+      }
+      fullAvailable.notify_one();
+    }
+  } catch (...) {
+    lock_guard<mutex> lock(m);
+    if (!error)
+      error = current_exception();
+  }
+  {
+    lock_guard<mutex> lock(m);
+    done = true;
+  }
+  fullAvailable.notify_all();
+  for (size_t i = 0; i < workers.size(); ++i)
+    workers[i].join();
+  if (error)
+    rethrow_exception(error);
+  for (size_t i = 0; i < partial.size(); ++i)
+    stats.merge(*partial[i]);
+}
+
+void FastqQualityControl::compute(const string& path, FastqStatistics& stats, unsigned int nbThreads)
+{
+  FastqBatchReader reader(path, stats.getAlphabet(), nbThreads);
+  compute(reader, stats, nbThreads);
+}
+
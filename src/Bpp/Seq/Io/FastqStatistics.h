@@ -0,0 +1,223 @@
+//
+// File: FastqStatistics.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _FASTQSTATISTICS_H_
+#define _FASTQSTATISTICS_H_
+
+#include "FastqBatch.h"
+
+//From the STL:
+#include <iostream>
+#include <vector>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief Quality-control statistics on reads.
+ *
+ * The following counts are accumulated:
+ * - for each cycle (position in the read), the number of bases with each Phred quality score,
+ * - for each cycle, the number of bases with each resolved state of the alphabet, other states
+ *   (gaps and unresolved characters, such as N) being counted together,
+ * - the number of reads of each length,
+ * - for nucleotide alphabets, the number of reads for each percentage of G+C among resolved bases.
+ *
+ * Statistics computed on distinct sets of reads can be merged, so that each thread can use its own
+ * accumulator (see FastqQualityControl). Results are of the same nature as the "per base sequence quality",
+ * "per base sequence content", "sequence length distribution" and "per sequence GC content" modules of FastQC.
+ */
+class FastqStatistics
+{
+  public:
+    static const size_t NB_QUALITIES;
+
+  private:
+    const Alphabet* alphabet_;
+    size_t nbStates_; //Resolved states, plus one column for all others.
+    bool isNucleic_;
+    std::vector<uint8_t> columns_; //Column of each one-byte state code.
+    std::vector<uint64_t> qualityCounts_; //NB_QUALITIES entries per cycle.
+    std::vector<uint64_t> stateCounts_; //nbStates_ entries per cycle.
+    std::vector<uint64_t> lengthCounts_;
+    std::vector<uint64_t> gcCounts_; //Percentage of G+C, from 0 to 100.
+    uint64_t nbReads_;
+    uint64_t nbBases_;
+    uint64_t nbGc_;
+    uint64_t nbResolved_;
+
+  public:
+    /**
+     * @param alphabet The alphabet of the reads.
+     */
+    FastqStatistics(const Alphabet* alphabet);
+
+  public:
+    const Alphabet* getAlphabet() const { return alphabet_; }
+
+    /**
+     * @brief Add all reads of a batch.
+     */
+    void add(const FastqBatch& batch);
+
+    /**
+     * @brief Add a read.
+     *
+     * @param bases The state codes of the read.
+     * @param qualities The Phred quality scores of the read.
+     * @param length The length of the read.
+     */
+    void add(const int8_t* bases, const uint8_t* qualities, size_t length);
+
+    /**
+     * @brief Add the counts of another set of statistics.
+     *
+     * @param stats The statistics to add, on the same alphabet.
+     * @throw Exception If alphabets do not match.
+     */
+    void merge(const FastqStatistics& stats);
+
+    /**
+     * @brief Reset all counts.
+     */
+    void clear();
+
+    uint64_t getNumberOfReads() const { return nbReads_; }
+    uint64_t getNumberOfBases() const { return nbBases_; }
+
+    /**
+     * @return The length of the longest read, that is, the number of cycles.
+     */
+    size_t getMaximumLength() const { return lengthCounts_.empty() ? 0 : lengthCounts_.size() - 1; }
+
+    /**
+     * @return The number of reads with a given length.
+     */
+    uint64_t getLengthCount(size_t length) const { return length < lengthCounts_.size() ? lengthCounts_[length] : 0; }
+
+    /**
+     * @return The number of bases with a given quality score at a given cycle.
+     */
+    uint64_t getQualityCount(size_t cycle, size_t quality) const {
+      return cycle < getMaximumLength() && quality < NB_QUALITIES ? qualityCounts_[cycle * NB_QUALITIES + quality] : 0;
+    }
+
+    /**
+     * @return The number of bases with a given state at a given cycle.
+     * @param cycle The position in the reads.
+     * @param state A resolved state, or the alphabet size for all other states.
+     */
+    uint64_t getStateCount(size_t cycle, size_t state) const {
+      return cycle < getMaximumLength() && state < nbStates_ ? stateCounts_[cycle * nbStates_ + state] : 0;
+    }
+
+    /**
+     * @return The number of bases at a given cycle, that is, the number of reads at least as long.
+     */
+    uint64_t getNumberOfBases(size_t cycle) const;
+
+    /**
+     * @return The mean quality score at a given cycle.
+     */
+    double getMeanQuality(size_t cycle) const;
+
+    /**
+     * @return A quantile of the quality scores at a given cycle.
+     * @param cycle The position in the reads.
+     * @param prob The probability of the quantile, between 0 and 1 (0.5 for the median).
+     */
+    unsigned int getQualityQuantile(size_t cycle, double prob) const;
+
+    /**
+     * @return The proportion of G+C among resolved bases of all reads, for nucleotide alphabets.
+     */
+    double getGcContent() const { return nbResolved_ > 0 ? static_cast<double>(nbGc_) / static_cast<double>(nbResolved_) : 0.; }
+
+    /**
+     * @return The number of reads with a given percentage of G+C, from 0 to 100, for nucleotide alphabets.
+     */
+    uint64_t getGcCount(size_t percent) const { return percent < gcCounts_.size() ? gcCounts_[percent] : 0; }
+
+    /**
+     * @brief Write per-cycle statistics as a tab-separated table.
+     *
+     * Columns are the cycle (starting at 1), the mean quality, the first quartile, median and
+     * third quartile of quality scores, and the proportion of each state.
+     *
+     * @param output The stream where to write.
+     */
+    void printPerCycle(std::ostream& output) const;
+
+  private:
+    void resize_(size_t length);
+};
+
+/**
+ * @brief Compute quality-control statistics over a whole input, using several threads.
+ *
+ * Batches are read on the calling thread, and dispatched to worker threads which each
+ * accumulate their own statistics. These are merged once all reads have been processed.
+ */
+class FastqQualityControl
+{
+  public:
+    /**
+     * @brief Compute statistics on all remaining reads of a reader.
+     *
+     * @param reader The reader to use.
+     * @param stats [out] The statistics where the counts are added.
+     * @param nbThreads The number of worker threads (0 means one per available core).
+     * @param batchSize The number of reads in each batch.
+     */
+    static void compute(FastqBatchReader& reader, FastqStatistics& stats, unsigned int nbThreads = 0, size_t batchSize = 16384);
+
+    /**
+     * @brief Compute statistics on a file, which may be gzip or BGZF compressed.
+     *
+     * @param path The file to read.
+     * @param stats [out] The statistics where the counts are added.
+     * @param nbThreads The number of worker threads (0 means one per available core).
+     */
+    static void compute(const std::string& path, FastqStatistics& stats, unsigned int nbThreads = 0);
+};
+
+} // end of namespace bpp.
+
+#endif //_FASTQSTATISTICS_H_
+
@@ -0,0 +1,222 @@
+//
+// File: LineReader.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "LineReader.h"
+
+#include <Bpp/Text/TextTools.h>
+
+//From the STL:
+#include <algorithm>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+StreamLineReader::StreamLineReader(std::istream* stream, size_t chunkSize):
+  LineReader(),
+  stream_(stream), buffer_(max(chunkSize, static_cast<size_t>(4096))),
+  begin_(0), end_(0), bufferOffset_(0), lineOffset_(0), eof_(false)
+{
+  if (!stream)
+    throw NullPointerException("StreamLineReader (constructor). Input stream should not be a NULL pointer!");
+}
+
+bool StreamLineReader::fill_()
+{
+  if (eof_) return false;
+  //Shift remaining data to the beginning of the buffer:
+  if (begin_ > 0) {
+    size_t remaining = end_ - begin_;
+    if (remaining > 0)
+      memmove(&buffer_[0], &buffer_[begin_], remaining);
+    bufferOffset_ += begin_;
+    begin_ = 0;
+    end_ = remaining;
+  }
+  //The current line does not fit in the buffer, we make it bigger:
+  if (end_ == buffer_.size())
+    buffer_.resize(buffer_.size() * 2);
+  stream_->read(&buffer_[end_], static_cast<streamsize>(buffer_.size() - end_));
+  size_t n = static_cast<size_t>(stream_->gcount());
+  end_ += n;
+  if (!*stream_) eof_ = true;
+  return n > 0;
+}
+
+bool StreamLineReader::nextLine(TextSpan& line)
+{
+  size_t searchFrom = begin_;
+  while (true) {
+    const char* start = &buffer_[0] + searchFrom;
+    const char* found = static_cast<const char*>(memchr(start, '\n', end_ - searchFrom));
+    if (found) {
+      size_t pos = static_cast<size_t>(found - &buffer_[0]);
+      line = TextSpan(&buffer_[begin_], pos - begin_);
+      lineOffset_ = bufferOffset_ + begin_;
+      begin_ = pos + 1;
+      return true;
+    }
+    size_t scanned = end_ - begin_;
+    if (!fill_()) {
+      //Last line without end of line character:
+      if (end_ > begin_) {
+        line = TextSpan(&buffer_[begin_], end_ - begin_);
+        lineOffset_ = bufferOffset_ + begin_;
+        begin_ = end_;
+        return true;
+      }
+      return false;
+    }
+    //fill_ moved data at the beginning of the buffer, no need to rescan what we already have:
+    searchFrom = begin_ + scanned;
+  }
+}
+
+bool StreamLineReader::isSeekable() const
+{
+  streampos pos = stream_->tellg();
+  return pos != streampos(-1);
+}
+
+void StreamLineReader::seek(uint64_t offset)
+{
+  stream_->clear();
+  stream_->seekg(static_cast<streamoff>(offset), ios::beg);
+  if (!*stream_)
+    throw IOException("StreamLineReader::seek(). Cannot seek to position " + TextTools::toString(offset) + ".");
+  begin_ = 0;
+  end_ = 0;
+  bufferOffset_ = offset;
+  lineOffset_ = offset;
+  eof_ = false;
+}
+
+/******************************************************************************/
+
+bool MemoryLineReader::nextLine(TextSpan& line)
+{
+  if (position_ >= size_)
+    return false;
+  const char* start = data_ + position_;
+  const char* found = static_cast<const char*>(memchr(start, '\n', size_ - position_));
+  size_t len = found ? static_cast<size_t>(found - start) : size_ - position_;
+  line = TextSpan(start, len);
+  lineOffset_ = position_;
+  position_ += len + 1;
+  return true;
+}
+
+void MemoryLineReader::seek(uint64_t offset)
+{
+  if (offset > size_)
+    throw Exception("MemoryLineReader::seek(). Position " + TextTools::toString(offset) + " is beyond the end of buffer.");
+  position_ = static_cast<size_t>(offset);
+  lineOffset_ = position_;
+}
+
+/******************************************************************************/
+
+MappedFileLineReader::MappedFileLineReader(const std::string& path):
+  LineReader(),
+  path_(path), data_(0), size_(0), position_(0), lineOffset_(0)
+{
+#ifndef _WIN32
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw IOException("MappedFileLineReader (constructor). Cannot open file " + path + ".");
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw IOException("MappedFileLineReader (constructor). Cannot stat file " + path + ".");
+  }
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ > 0) {
+    void* addr = mmap(0, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+      close(fd);
+      throw IOException("MappedFileLineReader (constructor). Cannot map file " + path + " into memory.");
+    }
+    madvise(addr, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(addr);
+  }
+  //The mapping remains valid after the file descriptor is closed:
+  close(fd);
+#else
+  throw Exception("MappedFileLineReader (constructor). Memory mapping is not supported on this platform.");
+#endif
+}
+
+MappedFileLineReader::~MappedFileLineReader()
+{
+#ifndef _WIN32
+  if (data_)
+    munmap(const_cast<char*>(data_), size_);
+#endif
+}
+
+bool MappedFileLineReader::nextLine(TextSpan& line)
+{
+  if (position_ >= size_)
+    return false;
+  const char* start = data_ + position_;
+  const char* found = static_cast<const char*>(memchr(start, '\n', size_ - position_));
+  size_t len = found ? static_cast<size_t>(found - start) : size_ - position_;
+  line = TextSpan(start, len);
+  lineOffset_ = position_;
+  position_ += len + 1;
+  return true;
+}
+
+void MappedFileLineReader::seek(uint64_t offset)
+{
+  if (offset > size_)
+    throw IOException("MappedFileLineReader::seek(). Position " + TextTools::toString(offset) + " is beyond the end of file " + path_ + ".");
+  position_ = static_cast<size_t>(offset);
+  lineOffset_ = position_;
+}
+
+/******************************************************************************/
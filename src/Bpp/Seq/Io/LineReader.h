@@ -0,0 +1,331 @@
+//
+// File: LineReader.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _LINEREADER_H_
+#define _LINEREADER_H_
+
+#include <Bpp/Exceptions.h>
+
+//From the STL:
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief A non-owning view on a range of characters.
+ *
+ * This is a minimal equivalent of C++17 std::string_view, used by parsers to
+ * scan lines without allocating intermediate strings. The underlying buffer
+ * belongs to the object which produced the span, and is only valid until the
+ * next call to this object.
+ */
+class TextSpan
+{
+  public:
+    const char* data;
+    size_t size;
+
+  public:
+    TextSpan(): data(0), size(0) {}
+    TextSpan(const char* d, size_t s): data(d), size(s) {}
+
+  public:
+    bool empty() const { return size == 0; }
+    const char& operator[](size_t i) const { return data[i]; }
+    const char* begin() const { return data; }
+    const char* end() const { return data + size; }
+
+    TextSpan substr(size_t pos, size_t len = std::string::npos) const {
+      if (pos > size) pos = size;
+      if (len > size - pos) len = size - pos;
+      return TextSpan(data + pos, len);
+    }
+
+    std::string toString() const { return std::string(data, size); }
+
+    bool operator==(const char* s) const {
+      size_t n = std::strlen(s);
+      return n == size && std::memcmp(data, s, n) == 0;
+    }
+
+    bool operator==(const std::string& s) const {
+      return s.size() == size && std::memcmp(data, s.data(), size) == 0;
+    }
+
+    /**
+     * @return True if the span only contains white spaces (or is empty).
+     */
+    bool isBlank() const {
+      for (size_t i = 0; i < size; ++i)
+        if (!isSpace(data[i])) return false;
+      return true;
+    }
+
+    /**
+     * @brief Retrieve the next token, starting from a given position.
+     *
+     * @param pos [in,out] Position where to start the search. Updated to the position right after the token.
+     * @param token [out] The token found, if any.
+     * @return False if no more token could be found.
+     */
+    bool nextToken(size_t& pos, TextSpan& token) const {
+      while (pos < size && isSpace(data[pos])) ++pos;
+      if (pos >= size) return false;
+      size_t start = pos;
+      while (pos < size && !isSpace(data[pos])) ++pos;
+      token = TextSpan(data + start, pos - start);
+      return true;
+    }
+
+    static bool isSpace(char c) {
+      return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+    /**
+     * @brief Parse the span as an unsigned decimal integer.
+     *
+     * @throw Exception If the span is empty or contains non-digit characters.
+     */
+    uint64_t toUnsignedInteger() const {
+      if (size == 0)
+        throw Exception("TextSpan::toUnsignedInteger(). Empty token.");
+      uint64_t val = 0;
+      for (size_t i = 0; i < size; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i] - '0');
+        if (c > 9)
+          throw Exception("TextSpan::toUnsignedInteger(). Invalid integer: " + toString());
+        val = val * 10 + c;
+      }
+      return val;
+    }
+};
+
+/**
+ * @brief Interface for line-based readers of text input.
+ *
+ * Implementations return each line as a TextSpan pointing into an internal
+ * buffer, thus avoiding a string allocation per line. The trailing end of line
+ * character is not included in the span.
+ */
+class LineReader
+{
+  public:
+    LineReader() {}
+    virtual ~LineReader() {}
+
+  public:
+    /**
+     * @brief Read the next line.
+     *
+     * @param line [out] A span on the line read. It remains valid until the next call to this method, or to seek().
+     * @return False if the end of input was reached and no line was read.
+     */
+    virtual bool nextLine(TextSpan& line) = 0;
+
+    /**
+     * @return The offset of the beginning of the last line returned by nextLine().
+     * For plain input this is a byte position, compressed readers may use another (virtual) offset scheme.
+     */
+    virtual uint64_t getLineOffset() const = 0;
+
+    /**
+     * @return True if the seek() method is supported.
+     */
+    virtual bool isSeekable() const = 0;
+
+    /**
+     * @brief Move to the specified offset, typically as returned by getLineOffset().
+     *
+     * @throw Exception If the reader does not support random access.
+     */
+    virtual void seek(uint64_t offset) = 0;
+};
+
+/**
+ * @brief Line reader on a std::istream.
+ *
+ * The stream is read in large chunks rather than line by line, so that a
+ * single buffer is kept and reused during the whole parsing. The stream is
+ * not owned by this object. Because of the chunked reading, the position of
+ * the stream is generally ahead of the last line returned.
+ */
+class StreamLineReader:
+  public LineReader
+{
+  private:
+    std::istream* stream_;
+    std::vector<char> buffer_;
+    size_t begin_; //Start of unread data in buffer
+    size_t end_;   //End of valid data in buffer
+    uint64_t bufferOffset_; //Offset in stream of the beginning of the buffer
+    uint64_t lineOffset_;
+    bool eof_;
+
+  public:
+    /**
+     * @param stream The input stream to read from.
+     * @param chunkSize The size of each read operation.
+     */
+    StreamLineReader(std::istream* stream, size_t chunkSize = 1048576);
+
+  private:
+    StreamLineReader(const StreamLineReader& reader):
+      LineReader(),
+      stream_(reader.stream_), buffer_(reader.buffer_),
+      begin_(reader.begin_), end_(reader.end_),
+      bufferOffset_(reader.bufferOffset_), lineOffset_(reader.lineOffset_),
+      eof_(reader.eof_) {}
+
+    StreamLineReader& operator=(const StreamLineReader& reader) {
+      stream_       = reader.stream_;
+      buffer_       = reader.buffer_;
+      begin_        = reader.begin_;
+      end_          = reader.end_;
+      bufferOffset_ = reader.bufferOffset_;
+      lineOffset_   = reader.lineOffset_;
+      eof_          = reader.eof_;
+      return *this;
+    }
+
+  public:
+    bool nextLine(TextSpan& line);
+    uint64_t getLineOffset() const { return lineOffset_; }
+    bool isSeekable() const;
+    void seek(uint64_t offset);
+
+  private:
+    /**
+     * @brief Move remaining data to the beginning of the buffer and read a new chunk.
+     *
+     * @return False if no more data could be read.
+     */
+    bool fill_();
+};
+
+/**
+ * @brief Line reader on a buffer already in memory.
+ *
+ * The buffer is not owned by this object, and must remain valid as long as lines are read.
+ * Offsets are positions in the buffer.
+ */
+class MemoryLineReader:
+  public LineReader
+{
+  private:
+    const char* data_;
+    size_t size_;
+    size_t position_;
+    size_t lineOffset_;
+
+  public:
+    /**
+     * @param data The beginning of the text.
+     * @param size The size of the text, in bytes.
+     */
+    MemoryLineReader(const char* data, size_t size):
+      LineReader(),
+      data_(data), size_(size), position_(0), lineOffset_(0) {}
+
+  public:
+    bool nextLine(TextSpan& line);
+    uint64_t getLineOffset() const { return lineOffset_; }
+    bool isSeekable() const { return true; }
+    void seek(uint64_t offset);
+};
+
+/**
+ * @brief Line reader using a read-only memory mapping of a file.
+ *
+ * The whole file is mapped, and lines point directly into the mapped memory:
+ * no copy of the input text is ever made. Memory mapping is only supported on
+ * POSIX systems, an exception is thrown by the constructor otherwise.
+ */
+class MappedFileLineReader:
+  public LineReader
+{
+  private:
+    std::string path_;
+    const char* data_;
+    size_t size_;
+    size_t position_;
+    size_t lineOffset_;
+
+  public:
+    /**
+     * @param path The path of the file to map.
+     * @throw IOException If the file cannot be open or mapped.
+     */
+    MappedFileLineReader(const std::string& path);
+
+    virtual ~MappedFileLineReader();
+
+  private:
+    //Recopy is forbidden!
+    MappedFileLineReader(const MappedFileLineReader& reader):
+      LineReader(),
+      path_(reader.path_), data_(0), size_(0), position_(0), lineOffset_(0) {}
+
+    MappedFileLineReader& operator=(const MappedFileLineReader& reader) {
+      path_       = reader.path_;
+      data_       = 0;
+      size_       = 0;
+      position_   = 0;
+      lineOffset_ = 0;
+      return *this;
+    }
+
+  public:
+    bool nextLine(TextSpan& line);
+    uint64_t getLineOffset() const { return lineOffset_; }
+    bool isSeekable() const { return true; }
+    void seek(uint64_t offset);
+
+    /**
+     * @return The size of the mapped file, in bytes.
+     */
+    size_t getFileSize() const { return size_; }
+};
+
+} // end of namespace bpp.
+
+#endif //_LINEREADER_H_
@@ -38,6 +38,7 @@ knowledge of the CeCILL license and that you accept its terms.
 */
 
 #include "AlignmentFilterMafIterator.h"
+#include "SlidingWindowTools.h"
 
 using namespace bpp;
 
@@ -47,127 +48,69 @@ using namespace bpp;
 
 using namespace std;
 
-MafBlock* AlignmentFilterMafIterator::analyseCurrentBlock_()
+//Events reported by this filter:
+static const MafEventType ALN_KEPT("ALN CLEANER", "kept", MafEventType::LEVEL_DEBUG,
+    "ALN CLEANER: block %d is clean and kept as is.");
+static const MafEventType ALN_REMOVED("ALN CLEANER", "removed", MafEventType::LEVEL_INFO,
+    "ALN CLEANER: block %d was entirely removed. Tried to get the next one.");
+static const MafEventType ALN_SPLIT("ALN CLEANER", "split", MafEventType::LEVEL_INFO,
+    "ALN CLEANER: block %d with size %0 will be split into %1 blocks.");
+static const MafEventType ALN_REGION_REMOVED("ALN CLEANER", "region_removed", MafEventType::LEVEL_DEBUG,
+    "ALN CLEANER: removing region (%0, %1) from block %d.");
+
+MafBlock* AlignmentFilterMafIterator::splitNextBlock_()
 {
-  if (blockBuffer_.size() == 0) {
-    //Else there is no more block in the buffer, we need to parse more:
-    do {
-      MafBlock* block = iterator_->nextBlock();
-      if (!block) return 0; //No more block.
-    
-      //Parse block.
-      int gap = AlphabetTools::DNA_ALPHABET.getGapCharacterCode();
-      int unk = AlphabetTools::DNA_ALPHABET.getUnknownCharacterCode();
-      size_t nr;
-      size_t nc = static_cast<size_t>(block->getNumberOfSites());
-      if (nc < windowSize_)
-        throw Exception("AlignmentFilterMafIterator::analyseCurrentBlock_. Block is smaller than window size: " + TextTools::toString(nc));
+  //Else there is no more block in the buffer, we need to parse more:
+  do {
+    MafBlock* block = iterator_->nextBlock();
+    if (!block) return 0; //No more block.
+  
+    //Parse block.
+    int unk = AlphabetTools::DNA_ALPHABET.getUnknownCharacterCode();
+    size_t nr;
+    size_t nc = static_cast<size_t>(block->getNumberOfSites());
+    if (nc < windowSize_)
+      throw Exception("AlignmentFilterMafIterator::analyseCurrentBlock_. Block is smaller than window size: " + TextTools::toString(nc));
 
-      vector< vector<int> > aln;
-      if (missingAsGap_) {
-        nr = species_.size();
-        aln.resize(nr);
-        for (size_t i = 0; i < nr; ++i) {
-          if (block->hasSequenceForSpecies(species_[i]))
-            aln[i] = block->getSequenceForSpecies(species_[i]).getContent();
-          else {
-            aln[i].resize(nc); 
-            fill(aln[i].begin(), aln[i].end(), gap);
-          } 
-        }
-      } else {
-        vector<string> speciesSet = VectorTools::vectorIntersection(species_, block->getSpeciesList());
-        for (size_t i = 0; i < species_.size(); ++i) {
-          if (block->hasSequenceForSpecies(species_[i])) {
-            aln.push_back(block->getSequenceForSpecies(species_[i]).getContent());
-          } else {
-            if (!relative_) {
-              throw Exception("AlignmentFilterMafIterator::analyseCurrentBlock_. Block does not include selected species '" + species_[i] + "' and threshold are absolutes, leading to an undefined behavior. Consider selecting blocks first, or use relative thresholds.");
-            }
-          }
+    if (!missingAsGap_ && !relative_) {
+      for (size_t i = 0; i < species_.size(); ++i) {
+        if (!block->hasSequenceForSpecies(species_[i])) {
+          throw Exception("AlignmentFilterMafIterator::analyseCurrentBlock_. Block does not include selected species '" + species_[i] + "' and threshold are absolutes, leading to an undefined behavior. Consider selecting blocks first, or use relative thresholds.");
         }
-        nr = aln.size();
       }
+    }
 
-      //First we create a mask:
-      vector<size_t> pos;
-      vector<int> col(nr);
-      //Reset window:
-      window_.clear();
-      //Init window:
-      size_t i;
-      for (i = 0; i < windowSize_; ++i) {
-        for (size_t j = 0; j < nr; ++j) {
-          col[j] = aln[j][i];
-        }
-        window_.push_back(col);
-      }
-      //Slide window:
-      if (verbose_) {
-        ApplicationTools::message->endLine();
-        ApplicationTools::displayTask("Sliding window for alignment filter", true);
-      }
-      while (i + step_ < nc) {
-        if (verbose_)
-          ApplicationTools::displayGauge(i - windowSize_, nc - windowSize_ - 1, '>');
-        //Evaluate current window:
-        unsigned int sumGap = 0;
-        double sumEnt = 0;
-        for (size_t u = 0; u < window_.size(); ++u) {
-          for (size_t v = 0; v < window_[u].size(); ++v) {
-            if (window_[u][v] == gap || window_[u][v] == unk) {
-              sumGap++;
-            }
-            col[v] = window_[u][v];
-            if (col[v] == unk) col[v] = gap;
-          }
-          sumEnt += VectorTools::shannonDiscrete<int, double>(col) / log(5.);
-        }
-        bool test = (sumEnt / static_cast<double>(windowSize_)) > maxEnt_;
-        if (relative_) {
-          double propGap = static_cast<double>(sumGap) / static_cast<double>(nr * windowSize_);
-          test = test && (propGap > maxPropGap_);
-        } else {
-          test = test && (sumGap > maxGap_);
-        }
-        if (!test) { // flipped this logic to make passing windows fail
-          if (pos.size() == 0) {
-            pos.push_back(i - windowSize_);
-            pos.push_back(i);
-          } else {
-            if (i - windowSize_ <= pos[pos.size() - 1]) {
-              pos[pos.size() - 1] = i; //Windows are overlapping and we extend previous region
-            } else { //This is a new region
-              pos.push_back(i - windowSize_);
-              pos.push_back(i);
-            }
-          }
-        }
-      
-        //Move forward:
-        for (size_t k = 0; k < step_; ++k) {
-          for (size_t j = 0; j < nr; ++j) {
-            col[j] = aln[j][i];
-          }
-          window_.push_back(col);
-          window_.pop_front();
-          ++i;
-        }
-      }
-      
-      //Evaluate last window:
-      unsigned int sumGap = 0;
+    //Per-column gap counts and entropies are computed once for the block (column counts are shared with other stages).
+    //Gaps in each window are then counted in constant time using prefix sums. Entropies are summed over the window
+    //in column order, as differences of floating point prefix sums would not give exactly the same thresholds:
+    const ColumnCounts& counts = block->getColumnCounts(species_, false, missingAsGap_);
+    nr = counts.getNumberOfRows();
+    vector<unsigned int> colGaps(nc);
+    vector<double> colEnt(nc);
+    double log5 = log(5.);
+    for (size_t c = 0; c < nc; ++c) {
+      colGaps[c] = counts.getNumberOfGaps(c) + counts.getCount(c, unk);
+      colEnt[c] = counts.getEntropy(c, false, true) / log5;
+    }
+    PrefixSums<unsigned int> gapSums(colGaps);
+
+    vector<size_t> pos;
+    vector<size_t> ends = SlidingWindowTools::getWindowEnds(nc, windowSize_, step_);
+    //Slide window:
+    if (displaysTasks_()) {
+      ApplicationTools::message->endLine();
+      ApplicationTools::displayTask("Sliding window for alignment filter", true);
+    }
+    size_t i;
+    for (size_t w = 0; w < ends.size(); ++w) {
+      i = ends[w];
+      if (displaysTasks_() && w + 1 < ends.size())
+        displayGauge_(i - windowSize_, nc - windowSize_ - 1, '>');
+      //Evaluate current window:
+      unsigned int sumGap = gapSums.sum(i - windowSize_, i);
       double sumEnt = 0;
-      for (size_t u = 0; u < window_.size(); ++u) {
-        for (size_t v = 0; v < window_[u].size(); ++v) {
-          if (window_[u][v] == gap || window_[u][v] == unk) {
-            sumGap++;
-          }
-          col[v] = window_[u][v];
-          if (col[v] == unk) col[v] = gap;
-        }
-        sumEnt += VectorTools::shannonDiscrete<int, double>(col) / log(5.);
-      }
+      for (size_t c = i - windowSize_; c < i; ++c)
+        sumEnt += colEnt[c];
       bool test = (sumEnt / static_cast<double>(windowSize_)) > maxEnt_;
       if (relative_) {
         double propGap = static_cast<double>(sumGap) / static_cast<double>(nr * windowSize_);
@@ -176,326 +119,184 @@ MafBlock* AlignmentFilterMafIterator::analyseCurrentBlock_()
         test = test && (sumGap > maxGap_);
       }
       if (!test) { // flipped this logic to make passing windows fail
-        if (pos.size() == 0) {
-          pos.push_back(i - windowSize_);
-          pos.push_back(i);
-        } else {
-          if (i - windowSize_ <= pos[pos.size() - 1]) {
-            pos[pos.size() - 1] = i; //Windows are overlapping and we extend previous region
-          } else { //This is a new region
-            pos.push_back(i - windowSize_);
-            pos.push_back(i);
-          }
-        }
-      } 
-      if (verbose_)
-        ApplicationTools::displayTaskDone();
-    
-      //Now we remove regions with two many gaps, using a sliding window:
-      if (pos.size() == 0) {
-        blockBuffer_.push_back(block);
-        if (logstream_) {
-          (*logstream_ << "ALN CLEANER: block " << block->getDescription() << " is clean and kept as is.").endLine();
-        }
-      } else if (pos.size() == 2 && pos.front() == 0 && pos.back() == block->getNumberOfSites()) {
-        //Everything is removed:
-        if (logstream_) {
-          (*logstream_ << "ALN CLEANER: block " << block->getDescription() << " was entirely removed. Tried to get the next one.").endLine();
-        }
-      } else {
-        if (logstream_) {
-          (*logstream_ << "ALN CLEANER: block " << block->getDescription() << " with size "<< block->getNumberOfSites() << " will be split into " << (pos.size() / 2 + 1) << " blocks.").endLine();
-        }
-        if (verbose_) {
-          ApplicationTools::message->endLine();
-          ApplicationTools::displayTask("Spliting block", true);
-        }
-        for (i = 0; i < pos.size(); i+=2) {
-          if (verbose_)
-            ApplicationTools::displayGauge(i, pos.size() - 2, '=');
-          if (logstream_) {
-            (*logstream_ << "ALN CLEANER: removing region (" << pos[i] << ", " << pos[i+1] << ") from block " << block->getDescription() << ".").endLine();
-          }
-          if (pos[i] > 0) {
-            MafBlock* newBlock = new MafBlock();
-            newBlock->setScore(block->getScore());
-            newBlock->setPass(block->getPass());
-            for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-              MafSequence* subseq;
-              if (i == 0) {
-                subseq = block->getSequence(j).subSequence(0, pos[i]);
-              } else {
-                subseq = block->getSequence(j).subSequence(pos[i - 1], pos[i] - pos[i - 1]);
-              }
-              newBlock->addSequence(*subseq);
-              delete subseq;
-            }
-            blockBuffer_.push_back(newBlock);
-          }
-        
-          if (keepTrashedBlocks_) {
-            MafBlock* outBlock = new MafBlock();
-            outBlock->setScore(block->getScore());
-            outBlock->setPass(block->getPass());
-            for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-              MafSequence* outseq = block->getSequence(j).subSequence(pos[i], pos[i + 1] - pos[i]);
-              outBlock->addSequence(*outseq);
-              delete outseq;
-            } 
-            trashBuffer_.push_back(outBlock);
-          }
-        }
-        //Add last block:
-        if (pos[pos.size() - 1] < block->getNumberOfSites()) {
-          MafBlock* newBlock = new MafBlock();
-          newBlock->setScore(block->getScore());
-          newBlock->setPass(block->getPass());
-          for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-            MafSequence* subseq;
-            subseq = block->getSequence(j).subSequence(pos[pos.size() - 1], block->getNumberOfSites() - pos[pos.size() - 1]);
-            newBlock->addSequence(*subseq);
-            delete subseq;
-          }
-          blockBuffer_.push_back(newBlock);
+        SlidingWindowTools::addRegion(pos, i - windowSize_, i);
+      }
+    }
+    if (displaysTasks_())
+      ApplicationTools::displayTaskDone();
+  
+    //Now we remove regions with two many gaps, using a sliding window:
+    if (pos.size() == 0) {
+      logEvent_(ALN_KEPT, block);
+      return block;
+    } else if (pos.size() == 2 && pos.front() == 0 && pos.back() == block->getNumberOfSites()) {
+      //Everything is removed:
+      logEvent_(ALN_REMOVED, block);
+      recycle(block);
+    } else {
+      //Pieces share the input block, which is recycled when the last one is released:
+      std::shared_ptr<const MafBlock> parent = MafBlockView::share(block, iterator_);
+      logEvent_(ALN_SPLIT, block, {block->getNumberOfSites(), pos.size() / 2 + 1});
+      if (displaysTasks_()) {
+        ApplicationTools::message->endLine();
+        ApplicationTools::displayTask("Spliting block", true);
+      }
+      for (i = 0; i < pos.size(); i+=2) {
+        if (displaysTasks_())
+          displayGauge_(i, pos.size() - 2, '=');
+        logEvent_(ALN_REGION_REMOVED, block, {pos[i], pos[i+1]});
+        if (pos[i] > 0) {
+          if (i == 0)
+            viewBuffer_.push_back(MafBlockView(parent, 0, pos[i]));
+          else
+            viewBuffer_.push_back(MafBlockView(parent, pos[i - 1], pos[i] - pos[i - 1]));
         }
-        if (verbose_)
-          ApplicationTools::displayTaskDone();
-
-        delete block;
+      
+        if (keepTrashedBlocks_)
+          trashBuffer_.push_back(MafBlockView(parent, pos[i], pos[i + 1] - pos[i]).materialize());
       }
-    } while (blockBuffer_.size() == 0);
-  }
-
-  MafBlock* block = blockBuffer_.front();
-  blockBuffer_.pop_front();
-  return block;
+      //Add last block:
+      if (pos.back() < block->getNumberOfSites())
+        viewBuffer_.push_back(MafBlockView(parent, pos.back(), block->getNumberOfSites() - pos.back()));
+      if (displaysTasks_())
+        ApplicationTools::displayTaskDone();
+    }
+  } while (viewBuffer_.size() == 0);
+  return 0;
 }
 
-MafBlock* AlignmentFilter2MafIterator::analyseCurrentBlock_()
+MafBlock* AlignmentFilter2MafIterator::splitNextBlock_()
 {
-  if (blockBuffer_.size() == 0) {
-    //Else there is no more block in the buffer, we need to parse more:
-    do {
-      MafBlock* block = iterator_->nextBlock();
-      if (!block) return 0; //No more block.
-    
-      //Parse block.
-      int gap = AlphabetTools::DNA_ALPHABET.getGapCharacterCode();
-      int unk = AlphabetTools::DNA_ALPHABET.getUnknownCharacterCode();
-      size_t nr;
-      size_t nc = static_cast<size_t>(block->getNumberOfSites());
-      if (nc < windowSize_)
-        throw Exception("AlignmentFilter2MafIterator::analyseCurrentBlock_. Block is smaller than window size: " + TextTools::toString(nc));
+  //Else there is no more block in the buffer, we need to parse more:
+  do {
+    MafBlock* block = iterator_->nextBlock();
+    if (!block) return 0; //No more block.
+  
+    //Parse block.
+    int gap = AlphabetTools::DNA_ALPHABET.getGapCharacterCode();
+    int unk = AlphabetTools::DNA_ALPHABET.getUnknownCharacterCode();
+    size_t nr;
+    size_t nc = static_cast<size_t>(block->getNumberOfSites());
+    if (nc < windowSize_)
+      throw Exception("AlignmentFilter2MafIterator::analyseCurrentBlock_. Block is smaller than window size: " + TextTools::toString(nc));
 
-      vector< vector<int> > aln;
-      if (missingAsGap_) {
-        nr = species_.size();
-        aln.resize(nr);
-        for (size_t i = 0; i < nr; ++i) {
-          if (block->hasSequenceForSpecies(species_[i]))
-            aln[i] = block->getSequenceForSpecies(species_[i]).getContent();
-          else {
-            aln[i].resize(nc); 
-            fill(aln[i].begin(), aln[i].end(), gap);
-          } 
-        }
-      } else {
-        vector<string> speciesSet = VectorTools::vectorIntersection(species_, block->getSpeciesList());
-        for (size_t i = 0; i < species_.size(); ++i) {
-          if (block->hasSequenceForSpecies(species_[i])) {
-            aln.push_back(block->getSequenceForSpecies(species_[i]).getContent());
-          } else {
-            if (!relative_) {
-              throw Exception("AlignmentFilter2MafIterator::analyseCurrentBlock_. Block does not include selected species '" + species_[i] + "' and threshold are absolutes, leading to an undefined behavior. Consider selecting blocks first, or use relative thresholds.");
-            }
+    //Sequences are accessed in place:
+    vector<const vector<int>*> aln;
+    vector<int> gapSeq;
+    if (missingAsGap_) {
+      nr = species_.size();
+      aln.resize(nr);
+      for (size_t i = 0; i < nr; ++i) {
+        if (block->hasSequenceForSpecies(species_[i]))
+          aln[i] = &block->getSequenceForSpecies(species_[i]).getContent();
+        else {
+          if (gapSeq.size() != nc)
+            gapSeq.assign(nc, gap);
+          aln[i] = &gapSeq;
+        } 
+      }
+    } else {
+      for (size_t i = 0; i < species_.size(); ++i) {
+        if (block->hasSequenceForSpecies(species_[i])) {
+          aln.push_back(&block->getSequenceForSpecies(species_[i]).getContent());
+        } else {
+          if (!relative_) {
+            throw Exception("AlignmentFilter2MafIterator::analyseCurrentBlock_. Block does not include selected species '" + species_[i] + "' and threshold are absolutes, leading to an undefined behavior. Consider selecting blocks first, or use relative thresholds.");
           }
         }
-        nr = aln.size();
       }
+      nr = aln.size();
+    }
 
-      //First we create a mask:
-      vector<size_t> pos;
-      vector<bool> col(nr);
-      //Reset window:
-      window_.clear();
-      //Init window:
-      size_t i;
-      for (i = 0; i < windowSize_; ++i) {
-        for (size_t j = 0; j < nr; ++j) {
-          col[j] = (aln[j][i] == gap || aln[j][i] == unk);
+    //Per-column gap events are computed once for the block,
+    //and each window is then evaluated in constant time using prefix sums.
+    //A gap event is a column with too many gaps, which either starts the window,
+    //follows a column without too many gaps, or has a different gap pattern than the previous column.
+    vector<unsigned int> isGappy(nc);
+    vector<unsigned int> isEvent(nc);
+    for (size_t c = 0; c < nc; ++c) {
+      unsigned int partialCount = 0;
+      bool samePattern = (c > 0);
+      for (size_t j = 0; j < nr; ++j) {
+        int state = (*aln[j])[c];
+        bool isGap = (state == gap || state == unk);
+        if (isGap) partialCount++;
+        if (samePattern) {
+          int prev = (*aln[j])[c - 1];
+          samePattern = (isGap == (prev == gap || prev == unk));
         }
-        window_.push_back(col);
       }
-      //Slide window:
-      if (verbose_) {
-        ApplicationTools::message->endLine();
-        ApplicationTools::displayTask("Sliding window for alignment filter", true);
-      }
-      while (i + step_ < nc) {
-        if (verbose_)
-          ApplicationTools::displayGauge(i - windowSize_, nc - windowSize_ - 1, '>');
-        //Evaluate current window:
-        unsigned int count = 0;
-        bool posIsGap = false;
-        for (size_t u = 0; u < window_.size(); ++u) {
-          unsigned int partialCount = 0;
-          if (!posIsGap || (u > 0 && window_[u] != window_[u - 1])) {
-            for (size_t v = 0; v < window_[u].size(); ++v)
-              if (window_[u][v]) partialCount++;
-            bool test;
-            if (relative_) {
-              test = (static_cast<double>(partialCount) / static_cast<double>(nr) > maxPropGap_);
-            } else {
-              test = (partialCount > maxGap_);
-            }
-            if (test) {
-              count++;
-              posIsGap = true;
-            } else {
-              posIsGap = false;
-            }
-          }
-        }
-        if (count > maxPos_) {
-          if (pos.size() == 0) {
-            pos.push_back(i - windowSize_);
-            pos.push_back(i);
-          } else {
-            if (i - windowSize_ <= pos[pos.size() - 1]) {
-              pos[pos.size() - 1] = i; //Windows are overlapping and we extend previous region
-            } else { //This is a new region
-              pos.push_back(i - windowSize_);
-              pos.push_back(i);
-            }
-          }
-        }
-      
-        //Move forward:
-        for (size_t k = 0; k < step_; ++k) {
-          for (size_t j = 0; j < nr; ++j) {
-            col[j] = (aln[j][i] == gap || aln[j][i] == unk);
-          }
-          window_.push_back(col);
-          window_.pop_front();
-          ++i;
-        }
+      bool test;
+      if (relative_) {
+        test = (static_cast<double>(partialCount) / static_cast<double>(nr) > maxPropGap_);
+      } else {
+        test = (partialCount > maxGap_);
       }
+      isGappy[c] = test ? 1 : 0;
+      isEvent[c] = (test && (c == 0 || !isGappy[c - 1] || !samePattern)) ? 1 : 0;
+    }
+    PrefixSums<unsigned int> eventSums(isEvent);
 
-      //Evaluate last window:
+    vector<size_t> pos;
+    vector<size_t> ends = SlidingWindowTools::getWindowEnds(nc, windowSize_, step_);
+    //Slide window:
+    if (displaysTasks_()) {
+      ApplicationTools::message->endLine();
+      ApplicationTools::displayTask("Sliding window for alignment filter", true);
+    }
+    size_t i;
+    for (size_t w = 0; w < ends.size(); ++w) {
+      i = ends[w];
+      if (displaysTasks_() && w + 1 < ends.size())
+        displayGauge_(i - windowSize_, nc - windowSize_ - 1, '>');
+      //Evaluate current window, the first column of which always counts as an event if it is gappy:
       unsigned int count = 0;
-      bool posIsGap = false;
-      for (size_t u = 0; u < window_.size(); ++u) {
-        unsigned int partialCount = 0;
-        if (!posIsGap || (u > 0 && window_[u] != window_[u - 1])) {
-          for (size_t v = 0; v < window_[u].size(); ++v)
-            if (window_[u][v]) partialCount++;
-          bool test;
-          if (relative_) {
-            test = (static_cast<double>(partialCount) / static_cast<double>(nr) > maxPropGap_);
-          } else {
-            test = (partialCount > maxGap_);
-          }
-          if (test) {
-            count++;
-            posIsGap = true;
-          } else {
-            posIsGap = false;
-          }
-        }
-      }
+      if (windowSize_ > 0)
+        count = isGappy[i - windowSize_] + eventSums.sum(i - windowSize_ + 1, i);
       if (count > maxPos_) {
-        if (pos.size() == 0) {
-          pos.push_back(i - windowSize_);
-          pos.push_back(i);
-        } else {
-          if (i - windowSize_ <= pos[pos.size() - 1]) {
-            pos[pos.size() - 1] = i; //Windows are overlapping and we extend previous region
-          } else { //This is a new region
-            pos.push_back(i - windowSize_);
-            pos.push_back(i);
-          }
-        }
-      } 
-      if (verbose_)
-        ApplicationTools::displayTaskDone();
-    
-      //Now we remove regions with two many gaps, using a sliding window:
-      if (pos.size() == 0) {
-        blockBuffer_.push_back(block);
-        if (logstream_) {
-          (*logstream_ << "ALN CLEANER: block " << block->getDescription() << " is clean and kept as is.").endLine();
-        }
-      } else if (pos.size() == 2 && pos.front() == 0 && pos.back() == block->getNumberOfSites()) {
-        //Everything is removed:
-        if (logstream_) {
-          (*logstream_ << "ALN CLEANER: block " << block->getDescription() << " was entirely removed. Tried to get the next one.").endLine();
-        }
-      } else {
-        if (logstream_) {
-          (*logstream_ << "ALN CLEANER: block " << block->getDescription() << " with size "<< block->getNumberOfSites() << " will be split into " << (pos.size() / 2 + 1) << " blocks.").endLine();
-        }
-        if (verbose_) {
-          ApplicationTools::message->endLine();
-          ApplicationTools::displayTask("Spliting block", true);
-        }
-        for (i = 0; i < pos.size(); i+=2) {
-          if (verbose_)
-            ApplicationTools::displayGauge(i, pos.size() - 2, '=');
-          if (logstream_) {
-            (*logstream_ << "ALN CLEANER: removing region (" << pos[i] << ", " << pos[i+1] << ") from block " << block->getDescription() << ".").endLine();
-          }
-          if (pos[i] > 0) {
-            MafBlock* newBlock = new MafBlock();
-            newBlock->setScore(block->getScore());
-            newBlock->setPass(block->getPass());
-            for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-              MafSequence* subseq;
-              if (i == 0) {
-                subseq = block->getSequence(j).subSequence(0, pos[i]);
-              } else {
-                subseq = block->getSequence(j).subSequence(pos[i - 1], pos[i] - pos[i - 1]);
-              }
-              newBlock->addSequence(*subseq);
-              delete subseq;
-            }
-            blockBuffer_.push_back(newBlock);
-          }
-        
-          if (keepTrashedBlocks_) {
-            MafBlock* outBlock = new MafBlock();
-            outBlock->setScore(block->getScore());
-            outBlock->setPass(block->getPass());
-            for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-              MafSequence* outseq = block->getSequence(j).subSequence(pos[i], pos[i + 1] - pos[i]);
-              outBlock->addSequence(*outseq);
-              delete outseq;
-            } 
-            trashBuffer_.push_back(outBlock);
-          }
-        }
-        //Add last block:
-        if (pos[pos.size() - 1] < block->getNumberOfSites()) {
-          MafBlock* newBlock = new MafBlock();
-          newBlock->setScore(block->getScore());
-          newBlock->setPass(block->getPass());
-          for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-            MafSequence* subseq;
-            subseq = block->getSequence(j).subSequence(pos[pos.size() - 1], block->getNumberOfSites() - pos[pos.size() - 1]);
-            newBlock->addSequence(*subseq);
-            delete subseq;
-          }
-          blockBuffer_.push_back(newBlock);
+        SlidingWindowTools::addRegion(pos, i - windowSize_, i);
+      }
+    }
+    if (displaysTasks_())
+      ApplicationTools::displayTaskDone();
+  
+    //Now we remove regions with two many gaps, using a sliding window:
+    if (pos.size() == 0) {
+      logEvent_(ALN_KEPT, block);
+      return block;
+    } else if (pos.size() == 2 && pos.front() == 0 && pos.back() == block->getNumberOfSites()) {
+      //Everything is removed:
+      logEvent_(ALN_REMOVED, block);
+      recycle(block);
+    } else {
+      //Pieces share the input block, which is recycled when the last one is released:
+      std::shared_ptr<const MafBlock> parent = MafBlockView::share(block, iterator_);
+      logEvent_(ALN_SPLIT, block, {block->getNumberOfSites(), pos.size() / 2 + 1});
+      if (displaysTasks_()) {
+        ApplicationTools::message->endLine();
+        ApplicationTools::displayTask("Spliting block", true);
+      }
+      for (i = 0; i < pos.size(); i+=2) {
+        if (displaysTasks_())
+          displayGauge_(i, pos.size() - 2, '=');
+        logEvent_(ALN_REGION_REMOVED, block, {pos[i], pos[i+1]});
+        if (pos[i] > 0) {
+          if (i == 0)
+            viewBuffer_.push_back(MafBlockView(parent, 0, pos[i]));
+          else
+            viewBuffer_.push_back(MafBlockView(parent, pos[i - 1], pos[i] - pos[i - 1]));
         }
-        if (verbose_)
-          ApplicationTools::displayTaskDone();
-
-        delete block;
+      
+        if (keepTrashedBlocks_)
+          trashBuffer_.push_back(MafBlockView(parent, pos[i], pos[i + 1] - pos[i]).materialize());
       }
-    } while (blockBuffer_.size() == 0);
-  }
-
-  MafBlock* block = blockBuffer_.front();
-  blockBuffer_.pop_front();
-  return block;
+      //Add last block:
+      if (pos.back() < block->getNumberOfSites())
+        viewBuffer_.push_back(MafBlockView(parent, pos.back(), block->getNumberOfSites() - pos.back()));
+      if (displaysTasks_())
+        ApplicationTools::displayTaskDone();
+    }
+  } while (viewBuffer_.size() == 0);
+  return 0;
 }
 
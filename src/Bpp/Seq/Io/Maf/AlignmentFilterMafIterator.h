@@ -61,7 +61,7 @@ namespace bpp {
  * In case a sequence from the list is missing, it can be either ignored or counted as a full sequence of gaps.
  */
 class AlignmentFilterMafIterator:
-  public AbstractFilterMafIterator,
+  public AbstractSplitMafIterator,
   public virtual MafTrashIterator
 {
   private:
@@ -71,9 +71,7 @@ class AlignmentFilterMafIterator:
     unsigned int maxGap_;
     double maxPropGap_;
     double maxEnt_;
-    std::deque<MafBlock*> blockBuffer_;
     std::deque<MafBlock*> trashBuffer_;
-    std::deque< std::vector<int> > window_;
     bool keepTrashedBlocks_;
     bool missingAsGap_;
     bool relative_;
@@ -101,16 +99,14 @@ class AlignmentFilterMafIterator:
         double maxEnt,
         bool keepTrashedBlocks,
         bool missingAsGap) :
-      AbstractFilterMafIterator(iterator),
+      AbstractSplitMafIterator(iterator),
       species_(species),
       windowSize_(windowSize),
       step_(step),
       maxGap_(maxGap),
       maxPropGap_(),
       maxEnt_(maxEnt),
-      blockBuffer_(),
       trashBuffer_(),
-      window_(species.size()),
       keepTrashedBlocks_(keepTrashedBlocks),
       missingAsGap_(missingAsGap),
       relative_(false)
@@ -137,16 +133,14 @@ class AlignmentFilterMafIterator:
         double maxEnt,
         bool keepTrashedBlocks,
         bool missingAsGap) :
-      AbstractFilterMafIterator(iterator),
+      AbstractSplitMafIterator(iterator),
       species_(species),
       windowSize_(windowSize),
       step_(step),
       maxGap_(),
       maxPropGap_(maxPropGap),
       maxEnt_(maxEnt),
-      blockBuffer_(),
       trashBuffer_(),
-      window_(species.size()),
       keepTrashedBlocks_(keepTrashedBlocks),
       missingAsGap_(missingAsGap),
       relative_(true)
@@ -161,8 +155,14 @@ class AlignmentFilterMafIterator:
       return block;
     }
 
+  protected:
+    void getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const {
+      AbstractSplitMafIterator::getBufferContent_(nbBlocks, nbBytes);
+      addBufferContent_(trashBuffer_, nbBlocks, nbBytes);
+    }
+
   private:
-    MafBlock* analyseCurrentBlock_();
+    MafBlock* splitNextBlock_();
 };
 
 /**
@@ -174,7 +174,7 @@ class AlignmentFilterMafIterator:
  * In case a sequence from the list is missing, it can be either ignored or counted as a full sequence of gaps.
  */
 class AlignmentFilter2MafIterator:
-  public AbstractFilterMafIterator,
+  public AbstractSplitMafIterator,
   public virtual MafTrashIterator
 {
   private:
@@ -184,9 +184,7 @@ class AlignmentFilter2MafIterator:
     unsigned int maxGap_;
     double maxPropGap_;
     unsigned int maxPos_;
-    std::deque<MafBlock*> blockBuffer_;
     std::deque<MafBlock*> trashBuffer_;
-    std::deque< std::vector<bool> > window_;
     bool keepTrashedBlocks_;
     bool missingAsGap_;
     bool relative_;
@@ -206,16 +204,14 @@ class AlignmentFilter2MafIterator:
      * @param missingAsGap Add missing species as gap sequences where needed.
      */
     AlignmentFilter2MafIterator(MafIterator* iterator, const std::vector<std::string>& species, unsigned int windowSize, unsigned int step, unsigned int maxGap, unsigned int maxPos, bool keepTrashedBlocks, bool missingAsGap) :
-      AbstractFilterMafIterator(iterator),
+      AbstractSplitMafIterator(iterator),
       species_(species),
       windowSize_(windowSize),
       step_(step),
       maxGap_(maxGap),
       maxPropGap_(),
       maxPos_(maxPos),
-      blockBuffer_(),
       trashBuffer_(),
-      window_(species.size()),
       keepTrashedBlocks_(keepTrashedBlocks),
       missingAsGap_(missingAsGap),
       relative_(false)
@@ -235,16 +231,14 @@ class AlignmentFilter2MafIterator:
      * @param missingAsGap Add missing species as gap sequences where needed.
      */
     AlignmentFilter2MafIterator(MafIterator* iterator, const std::vector<std::string>& species, unsigned int windowSize, unsigned int step, double maxPropGap, unsigned int maxPos, bool keepTrashedBlocks, bool missingAsGap) :
-      AbstractFilterMafIterator(iterator),
+      AbstractSplitMafIterator(iterator),
       species_(species),
       windowSize_(windowSize),
       step_(step),
       maxGap_(),
       maxPropGap_(maxPropGap),
       maxPos_(maxPos),
-      blockBuffer_(),
       trashBuffer_(),
-      window_(species.size()),
       keepTrashedBlocks_(keepTrashedBlocks),
       missingAsGap_(missingAsGap),
       relative_(true)
@@ -258,8 +252,14 @@ class AlignmentFilter2MafIterator:
       return block;
     }
 
+  protected:
+    void getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const {
+      AbstractSplitMafIterator::getBufferContent_(nbBlocks, nbBytes);
+      addBufferContent_(trashBuffer_, nbBlocks, nbBytes);
+    }
+
   private:
-    MafBlock* analyseCurrentBlock_();
+    MafBlock* splitNextBlock_();
 
 };
 
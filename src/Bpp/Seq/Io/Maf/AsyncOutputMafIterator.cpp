@@ -0,0 +1,122 @@
+//
+// File: AsyncOutputMafIterator.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "AsyncOutputMafIterator.h"
+
+using namespace bpp;
+using namespace std;
+
+AsyncOutputMafIterator::AsyncOutputMafIterator(MafIterator* iterator, StageFactory factory, size_t queueSize, bool forwardBlocks):
+  AbstractFilterMafIterator(iterator),
+  input_(), stage_(), queue_(queueSize), forwardBlocks_(forwardBlocks),
+  writer_(), error_(), failed_(false), finished_(false)
+{
+  stage_.reset(factory(&input_));
+  if (!stage_.get())
+    throw Exception("AsyncOutputMafIterator (constructor). The factory returned no output stage.");
+  stage_->setVerbose(false);
+  writer_ = thread(&AsyncOutputMafIterator::write_, this);
+}
+
+AsyncOutputMafIterator::~AsyncOutputMafIterator()
+{
+  if (!finished_) {
+    try {
+      close();
+    } catch (...) {
+      //Errors cannot be forwarded from the destructor.
+    }
+  }
+}
+
+void AsyncOutputMafIterator::write_()
+{
+  MafBlock* block = 0;
+  while (queue_.pop(block)) {
+    if (error_) {
+      //A previous block failed, the remaining ones are discarded:
+      if (block) delete block;
+      continue;
+    }
+    try {
+      input_.setBlock(block);
+      //An empty input lets the output stage know that the input is done:
+      MafBlock* out = stage_->nextBlock();
+      if (out)
+        stage_->recycle(out);
+    } catch (...) {
+      error_ = current_exception();
+      failed_.store(true);
+    }
+    if (!block) return;
+  }
+}
+
+void AsyncOutputMafIterator::close()
+{
+  if (finished_) return;
+  finished_ = true;
+  queue_.push(0);
+  queue_.close();
+  writer_.join();
+  //Deleting the stage flushes its output:
+  stage_.reset();
+  if (error_)
+    rethrow_exception(error_);
+}
+
+MafBlock* AsyncOutputMafIterator::analyseCurrentBlock_()
+{
+  if (finished_) return 0;
+  MafBlock* block = 0;
+  while (!failed_.load() && (block = iterator_->nextBlock())) {
+    if (forwardBlocks_) {
+      //The writer thread reads a copy-on-write copy, which shares its sequences with the forwarded block.
+      //Lazy data must be built before both threads can read them:
+      block->prepareForSharing();
+      MafBlock* copy = new MafBlock(*block);
+      queue_.push(copy);
+      currentBlock_ = block;
+      return block;
+    }
+    queue_.push(block);
+  }
+  close(); //Forwards errors, if any.
+  return 0;
+}
@@ -0,0 +1,130 @@
+//
+// File: AsyncOutputMafIterator.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _ASYNCOUTPUTMAFITERATOR_H_
+#define _ASYNCOUTPUTMAFITERATOR_H_
+
+#include "MafIterator.h"
+#include "ParallelMafIterator.h"
+#include "SpscBoundedQueue.h"
+
+//From the STL:
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <exception>
+
+namespace bpp {
+
+/**
+ * @brief Run an output iterator on a dedicated writer thread.
+ *
+ * The output stage (OutputMafIterator, VcfOutputMafIterator, MsmcOutputMafIterator, etc.) is
+ * given as a factory, as for ParallelMafIterator, and is built on top of an internal input
+ * iterator. Blocks are handed over to the writer thread through a bounded queue, so that the
+ * formatting and writing of the output overlap with the parsing and filtering upstream. The
+ * output stage is deleted, and hence flushed, when the input is done or when close() is called.
+ *
+ * Blocks returned by nextBlock() belong to the caller, who may modify or delete them. When blocks
+ * are forwarded downstream, the writer thread therefore works on a copy. Otherwise, blocks are
+ * directly handed over, and all blocks are written upon the first call to nextBlock(), which then
+ * returns 0.
+ *
+ * The output stream of the stage should not be used by any other thread. Exceptions thrown by the
+ * output stage are forwarded to the caller of nextBlock() or close().
+ *
+ * Example:
+ * @code
+ * AsyncOutputMafIterator it(input, [&](MafIterator* in) {
+ *   return new OutputMafIterator(in, &output);
+ * });
+ * @endcode
+ */
+class AsyncOutputMafIterator:
+  public AbstractFilterMafIterator
+{
+  public:
+    typedef ParallelMafIterator::StageFactory StageFactory;
+
+  private:
+    SingleBlockMafIterator input_;
+    std::unique_ptr<MafIterator> stage_;
+    SpscBoundedQueue<MafBlock*> queue_;
+    bool forwardBlocks_;
+    std::thread writer_;
+    std::exception_ptr error_;
+    std::atomic<bool> failed_;
+    bool finished_;
+
+  public:
+    /**
+     * @param iterator The input iterator.
+     * @param factory A function building the output stage from an input iterator.
+     * The stage is owned by the AsyncOutputMafIterator.
+     * @param queueSize The maximum number of blocks waiting to be written.
+     * @param forwardBlocks If true, blocks are copied to the writer thread and forwarded downstream.
+     */
+    AsyncOutputMafIterator(MafIterator* iterator, StageFactory factory, size_t queueSize = 16, bool forwardBlocks = true);
+
+    virtual ~AsyncOutputMafIterator();
+
+  private:
+    //Recopy is forbidden!
+    AsyncOutputMafIterator(const AsyncOutputMafIterator& iterator);
+    AsyncOutputMafIterator& operator=(const AsyncOutputMafIterator& iterator);
+
+  public:
+    size_t getQueueSize() const { return queue_.getCapacity(); }
+
+    /**
+     * @brief Wait for all pending blocks to be written, and delete the output stage.
+     *
+     * This is called automatically at the end of the input.
+     */
+    void close();
+
+  private:
+    MafBlock* analyseCurrentBlock_();
+
+    void write_();
+};
+
+} // end of namespace bpp.
+
+#endif //_ASYNCOUTPUTMAFITERATOR_H_
@@ -0,0 +1,240 @@
+//
+// File: BcfOutputMafIterator.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+
+#include "BcfOutputMafIterator.h"
+
+#include <Bpp/Text/TextTools.h>
+
+using namespace bpp;
+
+//From the STL:
+#include <string>
+#include <sstream>
+#include <algorithm>
+
+using namespace std;
+
+//BCF2 type codes:
+static const unsigned char BCF_INT8 = 1;
+static const unsigned char BCF_INT16 = 2;
+static const unsigned char BCF_INT32 = 3;
+static const unsigned char BCF_CHAR = 7;
+static const char BCF_INT8_VECTOR_END = static_cast<char>(0x81);
+
+//Dictionary indices, as declared in the header:
+static const int BCF_FILTER_PASS = 0;
+static const int BCF_FILTER_GAP = 1;
+static const int BCF_FILTER_UNK = 2;
+static const int BCF_INFO_AC = 3;
+static const int BCF_FORMAT_GT = 4;
+
+BcfOutputMafIterator::BcfOutputMafIterator(MafIterator* iterator, std::ostream* out, const std::string& reference, const std::vector<std::string>& contigs,
+    const std::vector< std::vector<std::string> >& genotypes, bool outputAll, bool generateDiploids, int compressionLevel) :
+  AbstractVariantOutputMafIterator(iterator, reference, genotypes, outputAll, generateDiploids),
+  output_(), contigs_(contigs), contigIndex_(), shared_(), indiv_(), genotype_()
+{
+  if (contigs_.size() == 0)
+    throw Exception("BcfOutputMafIterator (constructor). At least one contig must be provided.");
+  for (size_t i = 0; i < contigs_.size(); ++i) {
+    if (!contigIndex_.insert(make_pair(contigs_[i], static_cast<int>(i))).second)
+      throw Exception("BcfOutputMafIterator (constructor). Duplicated contig '" + contigs_[i] + "'.");
+  }
+  for (size_t g = 0; g < genotypes_.size(); ++g) {
+    if (getPloidy_(g) > 127)
+      throw Exception("BcfOutputMafIterator (constructor). Too many sequences in genotype " + TextTools::toString(g) + ".");
+  }
+  if (out) {
+    output_.reset(new BgzfOutputStream(out, compressionLevel));
+    writeHeader_();
+  }
+}
+
+void BcfOutputMafIterator::close()
+{
+  if (output_.get()) {
+    output_->close();
+    output_.reset();
+  }
+}
+
+/******************************************************************************/
+
+void BcfOutputMafIterator::appendInt32_(std::string& buffer, uint32_t value)
+{
+  //BCF is little endian:
+  buffer += static_cast<char>(value & 0xff);
+  buffer += static_cast<char>((value >> 8) & 0xff);
+  buffer += static_cast<char>((value >> 16) & 0xff);
+  buffer += static_cast<char>((value >> 24) & 0xff);
+}
+
+void BcfOutputMafIterator::appendTypeDescriptor_(std::string& buffer, size_t length, unsigned char type)
+{
+  if (length < 15) {
+    buffer += static_cast<char>((length << 4) | type);
+  } else {
+    //The length follows as a typed integer:
+    buffer += static_cast<char>((15 << 4) | type);
+    appendTypedInt_(buffer, static_cast<int>(length));
+  }
+}
+
+void BcfOutputMafIterator::appendTypedInt_(std::string& buffer, int value)
+{
+  //Values from -128 to -121 (and equivalent for larger types) are reserved:
+  if (value >= -120 && value <= 127) {
+    buffer += static_cast<char>((1 << 4) | BCF_INT8);
+    buffer += static_cast<char>(value);
+  } else if (value >= -32760 && value <= 32767) {
+    buffer += static_cast<char>((1 << 4) | BCF_INT16);
+    buffer += static_cast<char>(value & 0xff);
+    buffer += static_cast<char>((value >> 8) & 0xff);
+  } else {
+    buffer += static_cast<char>((1 << 4) | BCF_INT32);
+    appendInt32_(buffer, static_cast<uint32_t>(value));
+  }
+}
+
+/******************************************************************************/
+
+void BcfOutputMafIterator::writeHeader_()
+{
+  ostringstream text;
+  writeVcfHeader_(text, contigs_);
+  string header = text.str();
+  header += '\0';
+  string magic = "BCF\2\2";
+  appendInt32_(magic, static_cast<uint32_t>(header.size()));
+  output_->write(magic.data(), static_cast<streamsize>(magic.size()));
+  output_->write(header.data(), static_cast<streamsize>(header.size()));
+}
+
+void BcfOutputMafIterator::writeVariant_(const Variant_& variant)
+{
+  const string& chars = ColumnCounts::getCharacters();
+  map<string, int>::const_iterator it = contigIndex_.find(*variant.chromosome);
+  if (it == contigIndex_.end())
+    throw Exception("BcfOutputMafIterator::writeVariant_. Chromosome '" + *variant.chromosome + "' was not declared in the header.");
+  if (variant.position > 2147483647)
+    throw Exception("BcfOutputMafIterator::writeVariant_. Position " + TextTools::toString(variant.position) + " is too large for BCF.");
+
+  //AC, as written by VcfOutputMafIterator, is the count of the reference allele at non-variable positions:
+  unsigned int ac[4];
+  size_t nbAc = 0;
+  if (variant.nbAlt == 0) {
+    ac[nbAc++] = variant.counts[variant.reference + 1];
+  } else {
+    for (int x = 0; x < 4; ++x) {
+      if (variant.alleles[x] > 0)
+        ac[nbAc++] = variant.counts[x + 1];
+    }
+  }
+
+  //Shared data:
+  size_t nbSamples = genotypes_.size();
+  shared_.clear();
+  appendInt32_(shared_, static_cast<uint32_t>(it->second));
+  appendInt32_(shared_, static_cast<uint32_t>(variant.position - 1)); //0-based
+  appendInt32_(shared_, 1); //Length of the reference allele
+  appendInt32_(shared_, 0x7F800001); //Missing quality
+  appendInt32_(shared_, static_cast<uint32_t>(((variant.nbAlt + 1) << 16) | 1));
+  appendInt32_(shared_, static_cast<uint32_t>(((nbSamples > 0 ? 1 : 0) << 24) | nbSamples));
+  appendTypeDescriptor_(shared_, 0, BCF_CHAR); //Missing ID
+  appendTypeDescriptor_(shared_, 1, BCF_CHAR);
+  shared_ += chars[static_cast<size_t>(variant.reference + 1)];
+  for (int x = 0; x < 4; ++x) {
+    if (variant.alleles[x] > 0) {
+      appendTypeDescriptor_(shared_, 1, BCF_CHAR);
+      shared_ += chars[static_cast<size_t>(x + 1)];
+    }
+  }
+  if (variant.hasGap || variant.hasUnknown) {
+    appendTypeDescriptor_(shared_, (variant.hasGap ? 1 : 0) + (variant.hasUnknown ? 1 : 0), BCF_INT8);
+    if (variant.hasGap) shared_ += static_cast<char>(BCF_FILTER_GAP);
+    if (variant.hasUnknown) shared_ += static_cast<char>(BCF_FILTER_UNK);
+  } else {
+    appendTypeDescriptor_(shared_, 1, BCF_INT8);
+    shared_ += static_cast<char>(BCF_FILTER_PASS);
+  }
+  appendTypedInt_(shared_, BCF_INFO_AC);
+  unsigned int maxCount = *max_element(ac, ac + nbAc);
+  unsigned char type = maxCount <= 127 ? BCF_INT8 : (maxCount <= 32767 ? BCF_INT16 : BCF_INT32);
+  appendTypeDescriptor_(shared_, nbAc, type);
+  for (size_t k = 0; k < nbAc; ++k) {
+    unsigned int c = ac[k];
+    if (type == BCF_INT8) {
+      shared_ += static_cast<char>(c);
+    } else if (type == BCF_INT16) {
+      shared_ += static_cast<char>(c & 0xff);
+      shared_ += static_cast<char>((c >> 8) & 0xff);
+    } else {
+      appendInt32_(shared_, c);
+    }
+  }
+
+  //Genotypes, as phased int8 values padded to the largest ploidy:
+  indiv_.clear();
+  if (nbSamples > 0) {
+    size_t ploidy = 0;
+    for (size_t g = 0; g < nbSamples; ++g)
+      ploidy = max(ploidy, getPloidy_(g));
+    appendTypedInt_(indiv_, BCF_FORMAT_GT);
+    appendTypeDescriptor_(indiv_, ploidy, BCF_INT8);
+    for (size_t g = 0; g < nbSamples; ++g) {
+      getGenotype_(variant, g, genotype_);
+      for (size_t h = 0; h < ploidy; ++h) {
+        if (h < genotype_.size()) {
+          //(allele + 1) << 1, the phasing bit being set on all alleles but the first one:
+          indiv_ += static_cast<char>(((genotype_[h] + 1) << 1) | (h > 0 ? 1 : 0));
+        } else {
+          indiv_ += BCF_INT8_VECTOR_END;
+        }
+      }
+    }
+  }
+
+  string lengths;
+  appendInt32_(lengths, static_cast<uint32_t>(shared_.size()));
+  appendInt32_(lengths, static_cast<uint32_t>(indiv_.size()));
+  output_->write(lengths.data(), 8);
+  output_->write(shared_.data(), static_cast<streamsize>(shared_.size()));
+  output_->write(indiv_.data(), static_cast<streamsize>(indiv_.size()));
+}
+
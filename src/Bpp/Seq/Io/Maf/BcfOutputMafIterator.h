@@ -0,0 +1,123 @@
+//
+// File: BcfOutputMafIterator.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+
+#ifndef _BCFOUTPUTMAFITERATOR_H_
+#define _BCFOUTPUTMAFITERATOR_H_
+
+#include "VcfOutputMafIterator.h"
+#include "../CompressedOutput.h"
+
+//From the STL:
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+namespace bpp {
+
+/**
+ * @brief This iterator performs a simple SNP call from the MAF blocks, and outputs the results in the binary variant call format (BCF2).
+ *
+ * Variants are the same as the ones written by VcfOutputMafIterator. The BCF file is BGZF compressed, and
+ * contains typed AC (INFO) and GT (FORMAT) fields. As BCF records refer to chromosomes by their index in the
+ * header, the list of chromosomes of the reference species must be given in advance.
+ * As in the VCF output, AC is the count of the reference allele at non-variable positions (when outputAll is true).
+ *
+ * The BGZF stream is closed when the input iterator is exhausted, or when the iterator is destroyed.
+ */
+class BcfOutputMafIterator:
+  public AbstractVariantOutputMafIterator
+{
+  private:
+    std::unique_ptr<BgzfOutputStream> output_;
+    std::vector<std::string> contigs_;
+    std::map<std::string, int> contigIndex_;
+    std::string shared_;
+    std::string indiv_;
+    std::vector<int> genotype_;
+
+  public:
+    /**
+     * @brief Build a new BcfOutputMafIterator object.
+     *
+     * @param iterator The input iterator.
+     * @param out The output stream where to write the BCF file. It should be open in binary mode.
+     * @param reference The species to use as a reference.
+     * @param contigs The list of chromosomes (or contigs) of the reference species. An exception is thrown if a block refers to another chromosome.
+     * @param genotypes A list of species combinations for which genotype information should be written in the BCF file. When more than one sequence is specified in a combination, a (phased) polyploid genotype will be created.
+     * @param outputAll If true, also output non-variable positions.
+     * @param generateDiploids If true, output artificial "homozygous" diploids.
+     * @param compressionLevel The BGZF compression level (see BgzfStreamBuffer).
+     */
+    BcfOutputMafIterator(MafIterator* iterator, std::ostream* out, const std::string& reference, const std::vector<std::string>& contigs,
+        const std::vector< std::vector<std::string> >& genotypes, bool outputAll = false, bool generateDiploids = false, int compressionLevel = -1);
+
+  private:
+    BcfOutputMafIterator(const BcfOutputMafIterator& iterator);
+    BcfOutputMafIterator& operator=(const BcfOutputMafIterator& iterator);
+
+  public:
+    virtual ~BcfOutputMafIterator()
+    {
+      close();
+    }
+
+    /**
+     * @brief Write all pending data and the end-of-file marker.
+     */
+    void close();
+
+  protected:
+    bool hasOutput_() const { return output_.get() != 0; }
+    void writeVariant_(const Variant_& variant);
+    void endOfInput_() { close(); }
+
+  private:
+    void writeHeader_();
+
+    static void appendInt32_(std::string& buffer, uint32_t value);
+    static void appendTypeDescriptor_(std::string& buffer, size_t length, unsigned char type);
+    static void appendTypedInt_(std::string& buffer, int value);
+};
+
+} // end of namespace bpp.
+
+#endif //_BCFOUTPUTMAFITERATOR_H_
@@ -0,0 +1,184 @@
+//
+// File: BinaryIoTools.h
+// Authors: Julien Dutheil
+// Created: Thu Oct 15 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _BINARYIOTOOLS_H_
+#define _BINARYIOTOOLS_H_
+
+//From bpp-core:
+#include <Bpp/Exceptions.h>
+
+//From the STL:
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <istream>
+#include <ostream>
+
+namespace bpp {
+
+/**
+ * @brief Little endian binary I/O, shared by the binary file formats of the library.
+ *
+ * Integers are written on a fixed number of bytes, or as varints (7 bits per byte, lowest bits first).
+ * Strings are written as their length, on 4 bytes or as a varint, followed by their characters.
+ * Read functions throw an IOException when the input ends, with the given context at the start of the message.
+ */
+class BinaryIoTools
+{
+  public:
+    static void writeUInt(std::ostream& out, uint64_t value, size_t nbBytes)
+    {
+      char b[8];
+      for (size_t i = 0; i < nbBytes; ++i)
+        b[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+      out.write(b, static_cast<std::streamsize>(nbBytes));
+    }
+
+    static void writeString(std::ostream& out, const std::string& s)
+    {
+      writeUInt(out, s.size(), 4);
+      out.write(s.data(), static_cast<std::streamsize>(s.size()));
+    }
+
+    static void appendUInt(std::string& buffer, uint64_t value, size_t nbBytes)
+    {
+      for (size_t i = 0; i < nbBytes; ++i)
+        buffer += static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+
+    static void appendString(std::string& buffer, const std::string& s)
+    {
+      appendUInt(buffer, s.size(), 4);
+      buffer += s;
+    }
+
+    static void writeVarint(std::ostream& out, uint64_t value)
+    {
+      char b[10];
+      size_t n = 0;
+      while (value >= 0x80) {
+        b[n++] = static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+      }
+      b[n++] = static_cast<char>(value);
+      out.write(b, static_cast<std::streamsize>(n));
+    }
+
+    static void writeVarintString(std::ostream& out, const std::string& s)
+    {
+      writeVarint(out, s.size());
+      out.write(s.data(), static_cast<std::streamsize>(s.size()));
+    }
+
+    /**
+     * @param in The input stream.
+     * @param nbBytes The number of bytes of the integer, at most 8.
+     * @param where The context of error messages, typically the calling method.
+     * @param file The name of the input file, if it should be reported in error messages.
+     */
+    static uint64_t readUInt(std::istream& in, size_t nbBytes, const char* where, const std::string* file = 0)
+    {
+      unsigned char b[8];
+      in.read(reinterpret_cast<char*>(b), static_cast<std::streamsize>(nbBytes));
+      if (!in)
+        throwEndOfFile(where, file);
+      uint64_t value = 0;
+      for (size_t i = 0; i < nbBytes; ++i)
+        value |= static_cast<uint64_t>(b[i]) << (8 * i);
+      return value;
+    }
+
+    static std::string readString(std::istream& in, const char* where, const std::string* file = 0)
+    {
+      return readChars_(in, static_cast<size_t>(readUInt(in, 4, where, file)), where, file);
+    }
+
+    /**
+     * @return False if the input ended before the end of the integer.
+     * @throw IOException If the integer has more than 64 bits.
+     */
+    static bool readVarint(std::istream& in, uint64_t& value, const char* where)
+    {
+      value = 0;
+      for (unsigned int shift = 0; shift < 64; shift += 7) {
+        int c = in.get();
+        if (c == std::char_traits<char>::eof())
+          return false;
+        value |= static_cast<uint64_t>(c & 0x7F) << shift;
+        if (!(c & 0x80))
+          return true;
+      }
+      throw IOException(std::string(where) + ". Invalid integer.");
+    }
+
+    static uint64_t readRequiredVarint(std::istream& in, const char* where)
+    {
+      uint64_t value;
+      if (!readVarint(in, value, where))
+        throwEndOfFile(where);
+      return value;
+    }
+
+    static std::string readVarintString(std::istream& in, const char* where)
+    {
+      return readChars_(in, static_cast<size_t>(readRequiredVarint(in, where)), where, 0);
+    }
+
+    static void throwEndOfFile(const char* where, const std::string* file = 0)
+    {
+      if (file)
+        throw IOException(std::string(where) + ". Unexpected end of file " + *file + ".");
+      throw IOException(std::string(where) + ". Unexpected end of file.");
+    }
+
+  private:
+    static std::string readChars_(std::istream& in, size_t n, const char* where, const std::string* file)
+    {
+      std::string s(n, '\0');
+      if (n > 0)
+        in.read(&s[0], static_cast<std::streamsize>(n));
+      if (!in)
+        throwEndOfFile(where, file);
+      return s;
+    }
+};
+
+} // end of namespace bpp.
+
+#endif //_BINARYIOTOOLS_H_
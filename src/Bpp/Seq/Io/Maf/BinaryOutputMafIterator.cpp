@@ -0,0 +1,327 @@
+//
+// File: BinaryOutputMafIterator.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "BinaryOutputMafIterator.h"
+#include "BinaryIoTools.h"
+
+//From bpp-core:
+#include <Bpp/Text/TextTools.h>
+
+//From zlib:
+#include <zlib.h>
+
+using namespace bpp;
+
+//From the STL:
+#include <string>
+#include <cstring>
+#include <memory>
+#include <algorithm>
+
+using namespace std;
+
+/******************************************************************************/
+
+BinaryOutputMafIterator::BinaryOutputMafIterator(MafIterator* iterator,
+    std::ostream* out,
+    const std::string& reference,
+    size_t chunkSize,
+    int compressionLevel) :
+  AbstractFilterMafIterator(iterator),
+  output_(out), refSpecies_(reference),
+  chunkSize_(max(chunkSize, static_cast<size_t>(1))), compressionLevel_(compressionLevel),
+  chunk_(ios::out | ios::binary), nbChunkBlocks_(0), names_(), chrIndex_(), chrNames_(),
+  chunkOffsets_(), chunkSizes_(), blockChromosomes_(), blockStarts_(), blockStops_(),
+  offset_(0), buffer_(), compressed_(), closed_(false)
+{
+  if (!output_) return;
+  write_("BPPMAF01");
+}
+
+void BinaryOutputMafIterator::write_(const std::string& data)
+{
+  output_->write(data.data(), static_cast<streamsize>(data.size()));
+  if (!*output_)
+    throw IOException("BinaryOutputMafIterator::write_. Cannot write to output stream.");
+  offset_ += data.size();
+}
+
+void BinaryOutputMafIterator::writeBlock_(const MafBlock& block)
+{
+  //Index the block according to the reference species:
+  uint32_t chrId = 0xffffffff;
+  uint64_t start = 0, stop = 0;
+  if (block.hasSequenceForSpecies(refSpecies_)) {
+    const MafSequence& refSeq = block.getSequenceForSpecies(refSpecies_);
+    if (refSeq.hasCoordinates()) {
+      map<string, uint32_t>::iterator it = chrIndex_.find(refSeq.getChromosome());
+      if (it == chrIndex_.end()) {
+        chrId = static_cast<uint32_t>(chrNames_.size());
+        chrIndex_[refSeq.getChromosome()] = chrId;
+        chrNames_.push_back(refSeq.getChromosome());
+      } else {
+        chrId = it->second;
+      }
+      start = refSeq.start();
+      stop = refSeq.stop();
+    }
+  }
+  blockChromosomes_.push_back(chrId);
+  blockStarts_.push_back(start);
+  blockStops_.push_back(stop);
+
+  PackedMafBlock(block).write(chunk_, &names_);
+  nbChunkBlocks_++;
+  if (static_cast<size_t>(chunk_.tellp()) >= chunkSize_)
+    writeChunk_();
+}
+
+void BinaryOutputMafIterator::writeChunk_()
+{
+  if (nbChunkBlocks_ == 0) return;
+  chunkOffsets_.push_back(offset_);
+  chunkSizes_.push_back(nbChunkBlocks_);
+  buffer_.clear();
+  BinaryIoTools::appendUInt(buffer_, nbChunkBlocks_, 4);
+  //Name table, by index:
+  vector<const string*> names(names_.size());
+  for (map<string, uint32_t>::const_iterator it = names_.begin(); it != names_.end(); ++it)
+    names[it->second] = &it->first;
+  BinaryIoTools::appendUInt(buffer_, static_cast<uint32_t>(names.size()), 4);
+  for (size_t i = 0; i < names.size(); ++i)
+    BinaryIoTools::appendString(buffer_, *names[i]);
+  //Content:
+  string content = chunk_.str();
+  const Bytef* raw = reinterpret_cast<const Bytef*>(content.data());
+  size_t size = content.size();
+  if (compressionLevel_ != 0 && size > 0) {
+    uLongf compressedSize = compressBound(static_cast<uLong>(size));
+    compressed_.resize(compressedSize);
+    if (compress2(&compressed_[0], &compressedSize, raw, static_cast<uLong>(size), compressionLevel_) != Z_OK)
+      throw Exception("BinaryOutputMafIterator::writeChunk_. Compression failed.");
+    buffer_ += static_cast<char>(1);
+    BinaryIoTools::appendUInt(buffer_, static_cast<uint32_t>(compressedSize), 4);
+    BinaryIoTools::appendUInt(buffer_, static_cast<uint32_t>(size), 4);
+    buffer_.append(reinterpret_cast<const char*>(&compressed_[0]), compressedSize);
+  } else {
+    buffer_ += static_cast<char>(0);
+    BinaryIoTools::appendUInt(buffer_, static_cast<uint32_t>(size), 4);
+    BinaryIoTools::appendUInt(buffer_, static_cast<uint32_t>(size), 4);
+    buffer_.append(content);
+  }
+  write_(buffer_);
+  chunk_.str("");
+  nbChunkBlocks_ = 0;
+  names_.clear();
+}
+
+void BinaryOutputMafIterator::close()
+{
+  if (!output_ || closed_) return;
+  closed_ = true;
+  writeChunk_();
+  uint64_t footerOffset = offset_;
+  buffer_ = "FOOT";
+  BinaryIoTools::appendUInt(buffer_, static_cast<uint32_t>(chrNames_.size()), 4);
+  for (const string& chr : chrNames_)
+    BinaryIoTools::appendString(buffer_, chr);
+  BinaryIoTools::appendUInt(buffer_, static_cast<uint32_t>(chunkOffsets_.size()), 4);
+  for (size_t i = 0; i < chunkOffsets_.size(); ++i) {
+    BinaryIoTools::appendUInt(buffer_, chunkOffsets_[i], 8);
+    BinaryIoTools::appendUInt(buffer_, chunkSizes_[i], 4);
+  }
+  for (size_t i = 0; i < blockChromosomes_.size(); ++i) {
+    BinaryIoTools::appendUInt(buffer_, blockChromosomes_[i], 4);
+    BinaryIoTools::appendUInt(buffer_, blockStarts_[i], 8);
+    BinaryIoTools::appendUInt(buffer_, blockStops_[i], 8);
+  }
+  BinaryIoTools::appendUInt(buffer_, footerOffset, 8);
+  buffer_ += "BPPMAFND";
+  write_(buffer_);
+  output_->flush();
+}
+
+/******************************************************************************/
+
+BinaryMafParser::BinaryMafParser(const std::string& path):
+  path_(path), input_(path.c_str(), ios::in | ios::binary), chrNames_(), chunkOffsets_(), chunkFirstBlocks_(),
+  blockChromosomes_(), blockStarts_(), blockStops_(), chrBlocks_(), chrMaxStops_(), nbBlocks_(0), currentChunk_(0), nextBlock_(0),
+  names_(), content_(ios::in | ios::binary), encoded_()
+{
+  if (!input_)
+    throw IOException("BinaryMafParser (constructor). Cannot open file " + path + ".");
+  char magic[8];
+  input_.read(magic, 8);
+  if (!input_ || memcmp(magic, "BPPMAF01", 8) != 0)
+    throw IOException("BinaryMafParser (constructor). File " + path + " is not a binary MAF file.");
+
+  //Footer:
+  input_.seekg(0, ios::end);
+  uint64_t fileSize = static_cast<uint64_t>(input_.tellg());
+  input_.seekg(-16, ios::end);
+  uint64_t footerOffset = readUInt64_();
+  input_.read(magic, 8);
+  if (!input_ || memcmp(magic, "BPPMAFND", 8) != 0)
+    throw IOException("BinaryMafParser (constructor). File " + path + " is truncated.");
+  input_.seekg(static_cast<streamoff>(footerOffset));
+  input_.read(magic, 4);
+  if (!input_ || memcmp(magic, "FOOT", 4) != 0)
+    throw IOException("BinaryMafParser (constructor). Invalid footer in file " + path + ".");
+  size_t nbChr = readUInt32_();
+  for (size_t i = 0; i < nbChr; ++i)
+    chrNames_.push_back(readString_());
+  size_t nbChunks = readUInt32_();
+  for (size_t i = 0; i < nbChunks; ++i) {
+    chunkOffsets_.push_back(readUInt64_());
+    chunkFirstBlocks_.push_back(nbBlocks_);
+    nbBlocks_ += readUInt32_();
+  }
+  chunkFirstBlocks_.push_back(nbBlocks_);
+  //Each entry of the block index takes 20 bytes, before the footer offset and the end magic:
+  uint64_t indexOffset = static_cast<uint64_t>(input_.tellg());
+  if (indexOffset > fileSize - 16 || nbBlocks_ > (fileSize - 16 - indexOffset) / 20)
+    throw IOException("BinaryMafParser (constructor). Invalid block index in file " + path + ".");
+  blockChromosomes_.resize(nbBlocks_);
+  blockStarts_.resize(nbBlocks_);
+  blockStops_.resize(nbBlocks_);
+  chrBlocks_.resize(nbChr);
+  chrMaxStops_.resize(nbChr);
+  for (size_t i = 0; i < nbBlocks_; ++i) {
+    uint32_t chrId = blockChromosomes_[i] = readUInt32_();
+    blockStarts_[i] = readUInt64_();
+    uint64_t stop = blockStops_[i] = readUInt64_();
+    if (chrId == 0xffffffff)
+      continue; //Not indexed.
+    if (chrId >= nbChr)
+      throw IOException("BinaryMafParser (constructor). Invalid block index in file " + path + ".");
+    vector<uint64_t>& maxStops = chrMaxStops_[chrId];
+    chrBlocks_[chrId].push_back(i);
+    maxStops.push_back(maxStops.empty() ? stop : max(maxStops.back(), stop));
+  }
+  currentChunk_ = nbChunks;
+}
+
+uint32_t BinaryMafParser::readUInt32_()
+{
+  return static_cast<uint32_t>(BinaryIoTools::readUInt(input_, 4, "BinaryMafParser::readUInt32_", &path_));
+}
+
+uint64_t BinaryMafParser::readUInt64_()
+{
+  return BinaryIoTools::readUInt(input_, 8, "BinaryMafParser::readUInt64_", &path_);
+}
+
+string BinaryMafParser::readString_()
+{
+  return BinaryIoTools::readString(input_, "BinaryMafParser::readString_", &path_);
+}
+
+void BinaryMafParser::loadChunk_(size_t chunk)
+{
+  input_.clear();
+  input_.seekg(static_cast<streamoff>(chunkOffsets_[chunk]));
+  readUInt32_(); //Number of blocks, already known from the directory.
+  size_t nbNames = readUInt32_();
+  names_.resize(nbNames);
+  for (size_t i = 0; i < nbNames; ++i)
+    names_[i] = readString_();
+  char encoding;
+  input_.read(&encoding, 1);
+  size_t encodedSize = readUInt32_();
+  size_t rawSize = readUInt32_();
+  string content(rawSize, '\0');
+  if (encoding == 0) {
+    if (rawSize > 0)
+      input_.read(&content[0], static_cast<streamsize>(rawSize));
+  } else {
+    encoded_.resize(encodedSize);
+    if (encodedSize > 0)
+      input_.read(reinterpret_cast<char*>(&encoded_[0]), static_cast<streamsize>(encodedSize));
+    uLongf n = static_cast<uLongf>(rawSize);
+    if (rawSize > 0 && (encodedSize == 0 || uncompress(reinterpret_cast<Bytef*>(&content[0]), &n, &encoded_[0], static_cast<uLong>(encodedSize)) != Z_OK || n != rawSize))
+      throw IOException("BinaryMafParser::loadChunk_. Invalid compressed chunk in file " + path_ + ".");
+  }
+  if (!input_)
+    throw IOException("BinaryMafParser::loadChunk_. Unexpected end of file " + path_ + ".");
+  content_.clear();
+  content_.str(content);
+  currentChunk_ = chunk;
+}
+
+void BinaryMafParser::seekBlock(size_t block)
+{
+  if (block > nbBlocks_)
+    throw IndexOutOfBoundsException("BinaryMafParser::seekBlock.", block, 0, nbBlocks_);
+  nextBlock_ = block;
+  if (block == nbBlocks_) return;
+  //Chunk containing the block:
+  size_t chunk = static_cast<size_t>(upper_bound(chunkFirstBlocks_.begin(), chunkFirstBlocks_.end(), block) - chunkFirstBlocks_.begin()) - 1;
+  loadChunk_(chunk);
+  //Skip the previous blocks of the chunk:
+  for (size_t i = chunkFirstBlocks_[chunk]; i < block; ++i)
+    delete PackedMafBlock::read(content_, &names_);
+}
+
+size_t BinaryMafParser::findBlock(const std::string& chr, size_t position) const
+{
+  vector<string>::const_iterator it = find(chrNames_.begin(), chrNames_.end(), chr);
+  if (it == chrNames_.end())
+    return nbBlocks_;
+  size_t chrId = static_cast<size_t>(it - chrNames_.begin());
+  //Running maxima are sorted, and the first one after the position is reached at the block we look for:
+  const vector<uint64_t>& maxStops = chrMaxStops_[chrId];
+  vector<uint64_t>::const_iterator j = upper_bound(maxStops.begin(), maxStops.end(), static_cast<uint64_t>(position));
+  if (j == maxStops.end())
+    return nbBlocks_;
+  return chrBlocks_[chrId][static_cast<size_t>(j - maxStops.begin())];
+}
+
+MafBlock* BinaryMafParser::analyseCurrentBlock_()
+{
+  if (nextBlock_ >= nbBlocks_)
+    return 0; //No more block.
+  if (currentChunk_ >= chunkOffsets_.size() || nextBlock_ >= chunkFirstBlocks_[currentChunk_ + 1])
+    seekBlock(nextBlock_);
+  unique_ptr<PackedMafBlock> packed(PackedMafBlock::read(content_, &names_));
+  if (!packed.get())
+    throw IOException("BinaryMafParser::nextBlock. Chunk ends before its last block in file " + path_ + ".");
+  nextBlock_++;
+  return packed->unpack();
+}
+
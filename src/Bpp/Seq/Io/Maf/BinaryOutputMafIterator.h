@@ -0,0 +1,234 @@
+//
+// File: BinaryOutputMafIterator.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _BINARYOUTPUTMAFITERATOR_H_
+#define _BINARYOUTPUTMAFITERATOR_H_
+
+#include "MafIterator.h"
+#include "PackedMafBlock.h"
+
+//From the STL:
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief This iterator writes blocks in a binary format, which can be read back much faster than MAF text.
+ *
+ * It is meant for intermediate results of multi-stage workflows, see BinaryMafParser for reading them.
+ * Blocks are stored in packed form (see PackedMafBlock): states use 4 bits per position, gaps being code 0,
+ * masks are stored as bitmaps and quality scores with 4 bits per position. Block properties are not kept.
+ * All integers are little endian. The file is made of:
+ * - A header: the magic string "BPPMAF01".
+ * - A series of chunks, each holding consecutive blocks: the number of blocks (uint32), the name table of the chunk
+ *   (uint32 count, then names, in the order of their indices), the encoding of the content (uint8, 0 for raw, 1 for zlib),
+ *   its encoded size (uint32) and its raw size (uint32), then the content. The content is the series of blocks,
+ *   written with PackedMafBlock::write, with sequence names given as indices in the name table of the chunk.
+ * - A footer: the magic string "FOOT", the chromosome dictionary of the reference species (uint32 count, then names),
+ *   the chunk directory (uint32 count, then for each chunk its offset as a uint64 and its number of blocks as a uint32),
+ *   the block index (for each block, the chromosome index of the reference sequence as a uint32, 0xffffffff if not available,
+ *   and its start and stop positions as uint64), the offset of the footer (uint64) and the magic string "BPPMAFND".
+ * Strings are written as their size (uint32) followed by their characters.
+ *
+ * Runs of gaps and repeated names are compact after compression, which is done chunk by chunk so that chunks can be
+ * decompressed independently. The footer is written when the input iterator is exhausted, or when the iterator is destroyed.
+ */
+class BinaryOutputMafIterator:
+  public AbstractFilterMafIterator
+{
+  private:
+    std::ostream* output_;
+    std::string refSpecies_;
+    size_t chunkSize_;
+    int compressionLevel_;
+    std::ostringstream chunk_;
+    uint32_t nbChunkBlocks_;
+    std::map<std::string, uint32_t> names_;
+    std::map<std::string, uint32_t> chrIndex_;
+    std::vector<std::string> chrNames_;
+    std::vector<uint64_t> chunkOffsets_;
+    std::vector<uint32_t> chunkSizes_;
+    std::vector<uint32_t> blockChromosomes_;
+    std::vector<uint64_t> blockStarts_;
+    std::vector<uint64_t> blockStops_;
+    uint64_t offset_;
+    std::string buffer_;
+    std::vector<unsigned char> compressed_;
+    bool closed_;
+
+  public:
+    /**
+     * @brief Build a new BinaryOutputMafIterator object.
+     *
+     * @param iterator The input iterator.
+     * @param out The output stream where to write the file. It should be open in binary mode.
+     * @param reference The species used for the block index. Blocks without this species are written but not indexed.
+     * @param chunkSize The approximate uncompressed size of a chunk, in bytes.
+     * @param compressionLevel The zlib compression level of the chunks. 0 means no compression.
+     */
+    BinaryOutputMafIterator(MafIterator* iterator,
+        std::ostream* out,
+        const std::string& reference = "",
+        size_t chunkSize = 1048576,
+        int compressionLevel = 1);
+
+  private:
+    BinaryOutputMafIterator(const BinaryOutputMafIterator& iterator);
+    BinaryOutputMafIterator& operator=(const BinaryOutputMafIterator& iterator);
+
+  public:
+    virtual ~BinaryOutputMafIterator()
+    {
+      try {
+        close();
+      } catch (std::exception& e) {
+        //Destructors must not throw.
+      }
+    }
+
+    /**
+     * @brief Write the last chunk and the footer.
+     *
+     * No block will be written after this method has been called.
+     */
+    void close();
+
+    MafBlock* analyseCurrentBlock_() {
+      currentBlock_ = iterator_->nextBlock();
+      if (output_ && !closed_) {
+        if (currentBlock_)
+          writeBlock_(*currentBlock_);
+        else
+          close(); //No more block.
+      }
+      return currentBlock_;
+    }
+
+  private:
+    void writeBlock_(const MafBlock& block);
+    void writeChunk_();
+    void write_(const std::string& data);
+};
+
+/**
+ * @brief Read files written by BinaryOutputMafIterator.
+ *
+ * Blocks are read in file order, starting from the first one, or from any block using the index (see seekBlock and findBlock).
+ */
+class BinaryMafParser:
+  public AbstractMafIterator
+{
+  private:
+    std::string path_;
+    std::ifstream input_;
+    std::vector<std::string> chrNames_;
+    std::vector<uint64_t> chunkOffsets_;
+    std::vector<size_t> chunkFirstBlocks_;
+    std::vector<uint32_t> blockChromosomes_;
+    std::vector<uint64_t> blockStarts_;
+    std::vector<uint64_t> blockStops_;
+    std::vector< std::vector<size_t> > chrBlocks_; //Indexed blocks of each chromosome, in file order.
+    std::vector< std::vector<uint64_t> > chrMaxStops_; //Maximum stop position of the blocks in chrBlocks_, up to each one.
+    size_t nbBlocks_;
+    size_t currentChunk_; //The chunk loaded in content_, or the number of chunks if none.
+    size_t nextBlock_;
+    std::vector<std::string> names_;
+    std::istringstream content_;
+    std::vector<unsigned char> encoded_;
+
+  public:
+    /**
+     * @param path The file to read.
+     * @throw IOException If the file cannot be read or is not a valid binary MAF file.
+     */
+    BinaryMafParser(const std::string& path);
+
+  private:
+    BinaryMafParser(const BinaryMafParser&);
+    BinaryMafParser& operator=(const BinaryMafParser&);
+
+  public:
+    size_t getNumberOfBlocks() const { return nbBlocks_; }
+
+    size_t getNumberOfChunks() const { return chunkOffsets_.size(); }
+
+    const std::vector<std::string>& getChromosomes() const { return chrNames_; }
+
+    /**
+     * @return The index of the next block to be read.
+     */
+    size_t tellBlock() const { return nextBlock_; }
+
+    /**
+     * @brief Move to a given block, which will be returned by the next call to nextBlock().
+     *
+     * @param block The block index. If it equals the number of blocks, no more block will be returned.
+     * @throw IndexOutOfBoundsException If the index is larger than the number of blocks.
+     */
+    void seekBlock(size_t block);
+
+    /**
+     * @brief Find the first block, in file order, whose reference sequence ends after a given position.
+     *
+     * The search takes a logarithmic time in the number of blocks of the chromosome.
+     *
+     * @param chr The chromosome of the reference sequence.
+     * @param position The position.
+     * @return The index of the block, or the number of blocks if none was found.
+     */
+    size_t findBlock(const std::string& chr, size_t position) const;
+
+  private:
+    MafBlock* analyseCurrentBlock_();
+
+    void loadChunk_(size_t chunk);
+    uint32_t readUInt32_();
+    uint64_t readUInt64_();
+    std::string readString_();
+};
+
+} // end of namespace bpp.
+
+#endif //_BINARYOUTPUTMAFITERATOR_H_
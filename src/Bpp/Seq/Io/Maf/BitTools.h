@@ -0,0 +1,135 @@
+//
+// File: BitTools.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _BITTOOLS_H_
+#define _BITTOOLS_H_
+
+//From the STL:
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace bpp {
+
+/**
+ * @brief Low-level tools for word-packed bit and nibble arrays.
+ */
+class BitTools
+{
+  public:
+    /**
+     * @return The number of bits set in a 64-bit word.
+     */
+    static inline unsigned int popcount(uint64_t x)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+      return static_cast<unsigned int>(__builtin_popcountll(x));
+#else
+      x = x - ((x >> 1) & 0x5555555555555555ULL);
+      x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+      x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+      return static_cast<unsigned int>((x * 0x0101010101010101ULL) >> 56);
+#endif
+    }
+
+    /**
+     * @return The number of trailing zeros in a non-null 64-bit word.
+     */
+    static inline unsigned int countTrailingZeros(uint64_t x)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+      return static_cast<unsigned int>(__builtin_ctzll(x));
+#else
+      unsigned int n = 0;
+      while (!(x & 1)) { x >>= 1; ++n; }
+      return n;
+#endif
+    }
+
+    /**
+     * @return The number of nibbles equal to a given value in a 64-bit word (16 nibbles).
+     *
+     * @param word The word to scan.
+     * @param value The nibble value to count, in [0, 15].
+     * @param nbNibbles Only the first (lower) nbNibbles nibbles are considered.
+     */
+    static inline unsigned int countNibbles(uint64_t word, unsigned int value, unsigned int nbNibbles = 16)
+    {
+      //Null nibbles are the ones matching the value:
+      uint64_t x = word ^ (static_cast<uint64_t>(value) * 0x1111111111111111ULL);
+      x |= x >> 1;
+      x |= x >> 2;
+      x &= 0x1111111111111111ULL;
+      if (nbNibbles < 16)
+        x |= ~((1ULL << (4 * nbNibbles)) - 1) & 0x1111111111111111ULL;
+      return 16 - popcount(x);
+    }
+
+    /**
+     * @return The number of words needed to store a given number of bits.
+     */
+    static inline size_t getNumberOfWords(size_t nbBits) { return (nbBits + 63) / 64; }
+
+    static inline bool getBit(const std::vector<uint64_t>& bits, size_t i) { return (bits[i >> 6] >> (i & 63)) & 1; }
+
+    static inline void setBit(std::vector<uint64_t>& bits, size_t i) { bits[i >> 6] |= (1ULL << (i & 63)); }
+
+    static inline void clearBit(std::vector<uint64_t>& bits, size_t i) { bits[i >> 6] &= ~(1ULL << (i & 63)); }
+
+    /**
+     * @return The number of bits set in the given range [begin, end[ of a bit array.
+     */
+    static size_t countBits(const std::vector<uint64_t>& bits, size_t begin, size_t end)
+    {
+      if (begin >= end) return 0;
+      size_t wb = begin >> 6, we = (end - 1) >> 6;
+      uint64_t first = ~0ULL << (begin & 63);
+      uint64_t last  = ~0ULL >> (63 - ((end - 1) & 63));
+      if (wb == we)
+        return popcount(bits[wb] & first & last);
+      size_t n = popcount(bits[wb] & first);
+      for (size_t w = wb + 1; w < we; ++w)
+        n += popcount(bits[w]);
+      return n + popcount(bits[we] & last);
+    }
+};
+
+} // end of namespace bpp.
+
+#endif //_BITTOOLS_H_
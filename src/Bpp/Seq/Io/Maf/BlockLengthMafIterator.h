@@ -64,24 +64,45 @@ class BlockLengthMafIterator:
       minLength_(minLength)
     {}
 
+  public:
+    /**
+     * @brief Filter a block which is not pulled from the input iterator, as a stage of a StaticMafPipeline.
+     *
+     * @return False if the block should be discarded.
+     */
+    bool processBlock(MafBlock& block) { return acceptBlock_(block); }
+
   private:
     MafBlock* analyseCurrentBlock_() throw (Exception) {
-      bool test;
       do {
         currentBlock_ = iterator_->nextBlock();
         if (!currentBlock_) break;
-        test = (currentBlock_->getNumberOfSites() < minLength_);
-        if (test) {
-          if (logstream_) {
-            (*logstream_ << "BLOCK LENGTH FILTER: block " << currentBlock_->getDescription() << " with size " << currentBlock_->getNumberOfSites() << " was discarded.").endLine();
-          }
-          delete currentBlock_;
-          currentBlock_ = 0;
-        }
-      } while (test);
+        if (acceptBlock_(*currentBlock_))
+          break;
+        recycle(currentBlock_);
+        currentBlock_ = 0;
+      } while (true);
       return currentBlock_;
     }
 
+    size_t analyseCurrentBlocks_(std::vector<MafBlock*>& blocks, size_t maxNbBlocks) {
+      return filterBlocks_(blocks, maxNbBlocks, [this](MafBlock& block) { return acceptBlock_(block); });
+    }
+
+    static const MafEventType& discardedEvent_() {
+      static const MafEventType type("BLOCK LENGTH FILTER", "discarded", MafEventType::LEVEL_INFO,
+          "BLOCK LENGTH FILTER: block %d with size %0 was discarded.");
+      return type;
+    }
+
+    bool acceptBlock_(const MafBlock& block) {
+      if (block.getNumberOfSites() < minLength_) {
+        logEvent_(discardedEvent_(), &block, {block.getNumberOfSites()});
+        return false;
+      }
+      return true;
+    }
+
 };
 
 } // end of namespace bpp.
@@ -41,6 +41,7 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _BLOCKMERGERMAFITERATOR_H_
 
 #include "MafIterator.h"
+#include "MafBlockAppender.h"
 
 //From the STL:
 #include <iostream>
@@ -66,10 +67,11 @@ class BlockMergerMafIterator:
   private:
     std::vector<std::string> species_;
     MafBlock* incomingBlock_;
-    std::vector<std::string> ignoreChrs_; //These chromosomes will never be merged (ex: 'Un').
+    std::vector<size_t> ignoreChrs_; //IDs of chromosomes which will never be merged (ex: 'Un').
     unsigned int maxDist_;
     bool renameChimericChromosomes_;
     std::map<std::string, unsigned int> chimericChromosomeCounts_;
+    MafBlockAppender appender_;
 
   public:
     BlockMergerMafIterator(MafIterator* iterator, const std::vector<std::string>& species, unsigned int maxDist = 0, bool renameChimericChromosomes = false) :
@@ -79,32 +81,16 @@ class BlockMergerMafIterator:
       ignoreChrs_(),
       maxDist_(maxDist),
       renameChimericChromosomes_(renameChimericChromosomes),
-      chimericChromosomeCounts_()
+      chimericChromosomeCounts_(),
+      appender_(this)
     {
       incomingBlock_ = iterator->nextBlock();
     }
 
   private:
-    BlockMergerMafIterator(const BlockMergerMafIterator& iterator) :
-      AbstractFilterMafIterator(0),
-      species_(iterator.species_),
-      incomingBlock_(iterator.incomingBlock_),
-      ignoreChrs_(iterator.ignoreChrs_),
-      maxDist_(iterator.maxDist_),
-      renameChimericChromosomes_(iterator.renameChimericChromosomes_),
-      chimericChromosomeCounts_(iterator.chimericChromosomeCounts_)
-    {}
-    
-    BlockMergerMafIterator& operator=(const BlockMergerMafIterator& iterator)
-    {
-      species_                   = iterator.species_;
-      incomingBlock_             = iterator.incomingBlock_;
-      ignoreChrs_                = iterator.ignoreChrs_;
-      maxDist_                   = iterator.maxDist_;
-      renameChimericChromosomes_ = iterator.renameChimericChromosomes_;
-      chimericChromosomeCounts_  = iterator.chimericChromosomeCounts_;
-      return *this;
-    }
+    //Recopy is forbidden!
+    BlockMergerMafIterator(const BlockMergerMafIterator& iterator);
+    BlockMergerMafIterator& operator=(const BlockMergerMafIterator& iterator);
 
   public:
     /**
@@ -112,12 +98,23 @@ class BlockMergerMafIterator:
      * @param chr The name of the chromosome to be ignored.
      */
     void ignoreChromosome(const std::string& chr) {
-      ignoreChrs_.push_back(chr);
+      ignoreChrs_.push_back(MafNameDictionary::chromosomes().intern(chr));
     }
   
+  protected:
+    void getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const {
+      if (incomingBlock_) {
+        nbBlocks++;
+        nbBytes += incomingBlock_->getMemorySize();
+      }
+    }
+
   private:
     MafBlock* analyseCurrentBlock_();
 
+    //Check if the incoming block can be appended to the current one, and compute the space between them:
+    bool canMerge_(size_t& globalSpace) const;
+
 };
 
 } // end of namespace bpp.
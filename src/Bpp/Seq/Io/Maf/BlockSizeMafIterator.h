@@ -66,22 +66,35 @@ class BlockSizeMafIterator:
 
   private:
     MafBlock* analyseCurrentBlock_() throw (Exception) {
-      bool test;
       do {
         currentBlock_ = iterator_->nextBlock();
         if (!currentBlock_) break;
-        test = (currentBlock_->getNumberOfSequences() < minSize_);
-        if (test) {
-          if (logstream_) {
-            (*logstream_ << "BLOCK SIZE FILTER: block " << currentBlock_->getDescription() << " with size " << currentBlock_->getNumberOfSites() << " was discarded.").endLine();
-          }
-          delete currentBlock_;
-          currentBlock_ = 0;
-        }
-      } while (test);
+        if (acceptBlock_(*currentBlock_))
+          break;
+        recycle(currentBlock_);
+        currentBlock_ = 0;
+      } while (true);
       return currentBlock_;
     }
 
+    size_t analyseCurrentBlocks_(std::vector<MafBlock*>& blocks, size_t maxNbBlocks) {
+      return filterBlocks_(blocks, maxNbBlocks, [this](MafBlock& block) { return acceptBlock_(block); });
+    }
+
+    static const MafEventType& discardedEvent_() {
+      static const MafEventType type("BLOCK SIZE FILTER", "discarded", MafEventType::LEVEL_INFO,
+          "BLOCK SIZE FILTER: block %d with size %0 was discarded.");
+      return type;
+    }
+
+    bool acceptBlock_(const MafBlock& block) {
+      if (block.getNumberOfSequences() < minSize_) {
+        logEvent_(discardedEvent_(), &block, {block.getNumberOfSites()});
+        return false;
+      }
+      return true;
+    }
+
 };
 
 } // end of namespace bpp.
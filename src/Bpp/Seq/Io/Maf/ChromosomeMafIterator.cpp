@@ -47,32 +47,40 @@ using namespace bpp;
 
 using namespace std;
 
+//Events reported by this filter:
+static const MafEventType CHROMOSOME_NO_REFERENCE("CHROMOSOME FILTER", "no_reference", MafEventType::LEVEL_INFO,
+    "CHROMOSOME FILTER: block does not contain reference species and was removed.");
+static const MafEventType CHROMOSOME_OTHER_CHROMOSOME("CHROMOSOME FILTER", "other_chromosome", MafEventType::LEVEL_INFO,
+    "CHROMOSOME FILTER: reference species without queried chromosome was removed.");
+
+bool ChromosomeMafIterator::acceptBlock_(const MafBlock& block)
+{
+  bool foundRef = false;
+  string chr = "";
+  for (size_t i = 0; i < block.getNumberOfSequences() && !foundRef; ++i) {
+    string species = block.getSequence(i).getSpecies(); 
+    if (species == ref_) {
+      foundRef = true;
+      chr = block.getSequence(i).getChromosome();
+    }
+  }
+  if (!foundRef) {
+    logEvent_(CHROMOSOME_NO_REFERENCE, &block);
+    return false;
+  } else if (chr != chr_) {
+    logEvent_(CHROMOSOME_OTHER_CHROMOSOME, &block);
+    return false;
+  }
+  return true;
+}
+
 MafBlock* ChromosomeMafIterator::analyseCurrentBlock_()
 {
   currentBlock_ = iterator_->nextBlock();
   while (currentBlock_) {
-    bool foundRef = false;
-    string chr = "";
-    for (size_t i = 0; i < currentBlock_->getNumberOfSequences() && !foundRef; ++i) {
-      string species = currentBlock_->getSequence(i).getSpecies(); 
-      if (species == ref_) {
-        foundRef = true;
-        chr = currentBlock_->getSequence(i).getChromosome();
-      }
-    }
-    if (!foundRef) {
-      if (logstream_) {
-        (*logstream_ << "CHROMOSOME FILTER: block does not contain reference species and was removed.").endLine();
-      }
-      delete currentBlock_;
-    } else if (chr != chr_) {
-      if (logstream_) {
-        (*logstream_ << "CHROMOSOME FILTER: reference species without queried chromosome was removed.").endLine();
-      }
-      delete currentBlock_;
-    } else {
+    if (acceptBlock_(*currentBlock_))
       return currentBlock_;
-    }
+    recycle(currentBlock_);
 
     //Look for the next block:
     currentBlock_ = iterator_->nextBlock();
@@ -88,6 +88,12 @@ class ChromosomeMafIterator:
   private:
     MafBlock* analyseCurrentBlock_();
 
+    size_t analyseCurrentBlocks_(std::vector<MafBlock*>& blocks, size_t maxNbBlocks) {
+      return filterBlocks_(blocks, maxNbBlocks, [this](MafBlock& block) { return acceptBlock_(block); });
+    }
+
+    bool acceptBlock_(const MafBlock& block);
+
 };
 
 } // end of namespace bpp.
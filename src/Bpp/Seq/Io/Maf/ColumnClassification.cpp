@@ -0,0 +1,97 @@
+//
+// File: ColumnClassification.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "ColumnClassification.h"
+
+#include <Bpp/Exceptions.h>
+#include <Bpp/Text/TextTools.h>
+
+using namespace bpp;
+
+//From the STL:
+#include <algorithm>
+
+using namespace std;
+
+void ColumnClassification::compute(const std::vector<const std::vector<int>*>& rows, size_t nbSites)
+{
+  nbSites_ = nbSites;
+  size_t nbWords = BitTools::getNumberOfWords(nbSites);
+  complete_.assign(nbWords, 0);
+  constant_.assign(nbWords, 0);
+  biallelic_.assign(nbWords, 0);
+  gap_.assign(nbWords, 0);
+  unknown_.assign(nbWords, 0);
+  for (size_t j = 0; j < rows.size(); ++j) {
+    if (rows[j]->size() != nbSites)
+      throw Exception("ColumnClassification::compute. Sequence " + TextTools::toString(j) + " does not have the expected length.");
+  }
+  for (size_t w = 0; w < nbWords; ++w) {
+    size_t begin = w * 64;
+    size_t n = min(static_cast<size_t>(64), nbSites - begin);
+    //Presence of each state (gap first) in the 64 columns:
+    uint64_t present[16] = {0};
+    for (size_t j = 0; j < rows.size(); ++j) {
+      const int* row = &(*rows[j])[begin];
+      unsigned int maxCode = 0;
+      for (size_t k = 0; k < n; ++k) {
+        unsigned int code = static_cast<unsigned int>(row[k] + 1);
+        maxCode = max(maxCode, code);
+        present[code & 15] |= (1ULL << k);
+      }
+      if (maxCode >= 16)
+        throw Exception("ColumnClassification::compute. Invalid state in sequence " + TextTools::toString(j) + ".");
+    }
+    uint64_t valid = (n == 64 ? ~0ULL : ((1ULL << n) - 1));
+    uint64_t unresolved = present[0];
+    for (size_t c = 5; c < 16; ++c)
+      unresolved |= present[c];
+    uint64_t a = present[1], c = present[2], g = present[3], t = present[4];
+    //Columns with at least two, or at least three distinct nucleotides:
+    uint64_t atLeast2 = (a & c) | (a & g) | (a & t) | (c & g) | (c & t) | (g & t);
+    uint64_t atLeast3 = (a & c & g) | (a & c & t) | (a & g & t) | (c & g & t);
+    uint64_t complete = ~unresolved & valid;
+    complete_[w]  = complete;
+    constant_[w]  = complete & (a | c | g | t) & ~atLeast2;
+    biallelic_[w] = complete & atLeast2 & ~atLeast3;
+    gap_[w]       = present[0];
+    unknown_[w]   = present[15];
+  }
+}
+
@@ -0,0 +1,114 @@
+//
+// File: ColumnClassification.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _COLUMNCLASSIFICATION_H_
+#define _COLUMNCLASSIFICATION_H_
+
+#include "BitTools.h"
+
+//From the STL:
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief Classification of all columns of a selection of sequences, as bitmaps.
+ *
+ * Sequences are DNA sequences, with gaps coded as -1 and unknown characters (N) as 14.
+ * For each column, the following properties are computed, in one pass over the sequences, 64 columns at a time:
+ * - complete: the column contains only nucleotides (no gap nor unresolved character),
+ * - constant: the column is complete and contains a single nucleotide,
+ * - biallelic: the column is complete and contains exactly two distinct nucleotides,
+ * - gap: the column contains at least one gap,
+ * - unknown: the column contains at least one unknown character.
+ * Each property is stored as a bitmap, with one bit per column (see BitTools).
+ * A column of an empty selection is complete and not constant.
+ */
+class ColumnClassification
+{
+  private:
+    size_t nbSites_;
+    std::vector<uint64_t> complete_;
+    std::vector<uint64_t> constant_;
+    std::vector<uint64_t> biallelic_;
+    std::vector<uint64_t> gap_;
+    std::vector<uint64_t> unknown_;
+
+  public:
+    ColumnClassification():
+      nbSites_(0), complete_(), constant_(), biallelic_(), gap_(), unknown_() {}
+
+    /**
+     * @brief Classify the columns of a set of sequences.
+     *
+     * @param rows The states of each sequence. All sequences must have nbSites states.
+     * @param nbSites The number of sites.
+     * @throw Exception if a sequence has an invalid state.
+     */
+    ColumnClassification(const std::vector<const std::vector<int>*>& rows, size_t nbSites):
+      nbSites_(0), complete_(), constant_(), biallelic_(), gap_(), unknown_()
+    {
+      compute(rows, nbSites);
+    }
+
+    virtual ~ColumnClassification() {}
+
+  public:
+    void compute(const std::vector<const std::vector<int>*>& rows, size_t nbSites);
+
+    size_t getNumberOfSites() const { return nbSites_; }
+
+    bool isComplete(size_t site) const { return BitTools::getBit(complete_, site); }
+    bool isConstant(size_t site) const { return BitTools::getBit(constant_, site); }
+    bool isBiallelic(size_t site) const { return BitTools::getBit(biallelic_, site); }
+    bool hasGap(size_t site) const { return BitTools::getBit(gap_, site); }
+    bool hasUnknown(size_t site) const { return BitTools::getBit(unknown_, site); }
+
+    const std::vector<uint64_t>& getCompleteBitmap() const { return complete_; }
+    const std::vector<uint64_t>& getConstantBitmap() const { return constant_; }
+    const std::vector<uint64_t>& getBiallelicBitmap() const { return biallelic_; }
+    const std::vector<uint64_t>& getGapBitmap() const { return gap_; }
+    const std::vector<uint64_t>& getUnknownBitmap() const { return unknown_; }
+};
+
+} // end of namespace bpp.
+
+#endif //_COLUMNCLASSIFICATION_H_
@@ -0,0 +1,186 @@
+//
+// File: ColumnCounts.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "ColumnCounts.h"
+#include "GapRunSequence.h"
+
+#include <Bpp/Exceptions.h>
+#include <Bpp/Text/TextTools.h>
+
+//From bpp-seq:
+#include <Bpp/Seq/Alphabet/AlphabetTools.h>
+
+using namespace bpp;
+
+//From the STL:
+#include <cmath>
+
+using namespace std;
+
+void ColumnCounts::compute(const std::vector<const std::vector<int>*>& rows, size_t nbSites)
+{
+  nbSites_ = nbSites;
+  nbRows_ = rows.size();
+  counts_.assign(nbSites * NB_CODES, 0);
+  for (size_t j = 0; j < rows.size(); ++j) {
+    if (rows[j]->size() != nbSites)
+      throw Exception("ColumnCounts::compute. Sequence " + TextTools::toString(j) + " does not have the expected length.");
+    const int* row = nbSites > 0 ? &(*rows[j])[0] : 0;
+    //Range check first, in a separate loop without branches in the body:
+    unsigned int maxCode = 0;
+    for (size_t c = 0; c < nbSites; ++c) {
+      unsigned int code = static_cast<unsigned int>(row[c] + 1);
+      maxCode = (code > maxCode ? code : maxCode);
+    }
+    if (maxCode >= NB_CODES)
+      throw Exception("ColumnCounts::compute. Invalid state in sequence " + TextTools::toString(j) + ".");
+    unsigned int* counts = nbSites > 0 ? &counts_[0] : 0;
+    for (size_t c = 0; c < nbSites; ++c)
+      counts[c * NB_CODES + static_cast<size_t>(row[c] + 1)]++;
+  }
+}
+
+void ColumnCounts::compute(const std::vector<const GapRunSequence*>& rows, size_t nbSites)
+{
+  nbSites_ = nbSites;
+  nbRows_ = rows.size();
+  counts_.assign(nbSites * NB_CODES, 0);
+  for (size_t c = 0; c < nbSites; ++c)
+    counts_[c * NB_CODES] = static_cast<unsigned int>(nbRows_);
+  for (size_t j = 0; j < rows.size(); ++j) {
+    const GapRunSequence& row = *rows[j];
+    if (row.size() != nbSites)
+      throw Exception("ColumnCounts::compute. Sequence " + TextTools::toString(j) + " does not have the expected length.");
+    //States are stored with 4 bits, and are therefore always valid codes:
+    for (size_t r = 0; r < row.getNumberOfRuns(); ++r) {
+      const GapRunSequence::Run& run = row.getRun(r);
+      unsigned int* counts = &counts_[run.begin * NB_CODES];
+      for (size_t i = 0; i < run.length; ++i, counts += NB_CODES) {
+        counts[0]--;
+        counts[static_cast<size_t>(row.getResidue(run.rank + i) + 1)]++;
+      }
+    }
+  }
+}
+
+unsigned int ColumnCounts::getNumberOfUnresolved(size_t site) const
+{
+  const unsigned int* counts = getCounts(site);
+  unsigned int n = 0;
+  for (size_t k = 5; k < NB_CODES; ++k)
+    n += counts[k];
+  return n;
+}
+
+unsigned int ColumnCounts::getNumberOfResolved(size_t site) const
+{
+  const unsigned int* counts = getCounts(site);
+  return counts[1] + counts[2] + counts[3] + counts[4];
+}
+
+double ColumnCounts::getEntropy(size_t site, bool ignoreGaps, bool unknownAsGap) const
+{
+  unsigned int counts[NB_CODES];
+  const unsigned int* siteCounts = getCounts(site);
+  for (size_t k = 0; k < NB_CODES; ++k)
+    counts[k] = siteCounts[k];
+  if (unknownAsGap) {
+    counts[0] += counts[NB_CODES - 1];
+    counts[NB_CODES - 1] = 0;
+  }
+  size_t first = ignoreGaps ? 1 : 0;
+  double n = 0;
+  for (size_t k = first; k < NB_CODES; ++k)
+    n += counts[k];
+  if (n == 0)
+    return 0.;
+  double s = 0;
+  for (size_t k = first; k < NB_CODES; ++k) {
+    if (counts[k] > 0) {
+      double f = static_cast<double>(counts[k]) / n;
+      s += f * log(f);
+    }
+  }
+  return -s;
+}
+
+void ColumnCounts::countStates(const int* states, size_t n, unsigned int counts[NB_CODES])
+{
+  //Four sub-histograms are used to break dependencies between consecutive increments:
+  unsigned int h[4][NB_CODES] = {{0}};
+  size_t i = 0;
+  unsigned int maxCode = 0;
+  for (; i + 4 <= n; i += 4) {
+    unsigned int c0 = static_cast<unsigned int>(states[i] + 1);
+    unsigned int c1 = static_cast<unsigned int>(states[i + 1] + 1);
+    unsigned int c2 = static_cast<unsigned int>(states[i + 2] + 1);
+    unsigned int c3 = static_cast<unsigned int>(states[i + 3] + 1);
+    unsigned int m = max(max(c0, c1), max(c2, c3));
+    maxCode = max(maxCode, m);
+    if (m >= NB_CODES) break;
+    h[0][c0]++;
+    h[1][c1]++;
+    h[2][c2]++;
+    h[3][c3]++;
+  }
+  if (maxCode >= NB_CODES)
+    throw Exception("ColumnCounts::countStates. Invalid state.");
+  for (; i < n; ++i) {
+    unsigned int c = static_cast<unsigned int>(states[i] + 1);
+    if (c >= NB_CODES)
+      throw Exception("ColumnCounts::countStates. Invalid state.");
+    h[0][c]++;
+  }
+  for (size_t k = 0; k < NB_CODES; ++k)
+    counts[k] += h[0][k] + h[1][k] + h[2][k] + h[3][k];
+}
+
+const std::string& ColumnCounts::getCharacters()
+{
+  static const string characters = buildCharacters_();
+  return characters;
+}
+
+string ColumnCounts::buildCharacters_()
+{
+  string characters;
+  for (int state = -1; state < static_cast<int>(NB_CODES) - 1; ++state)
+    characters += AlphabetTools::DNA_ALPHABET.intToChar(state)[0];
+  return characters;
+}
@@ -0,0 +1,184 @@
+//
+// File: ColumnCounts.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _COLUMNCOUNTS_H_
+#define _COLUMNCOUNTS_H_
+
+#include <Bpp/Clonable.h>
+
+//From the STL:
+#include <vector>
+#include <string>
+#include <cstddef>
+
+namespace bpp {
+
+class GapRunSequence;
+
+/**
+ * @brief Per-column state counts for a selection of sequences of an alignment block.
+ *
+ * For each column, the number of occurrences of each DNA state is stored, including gaps (-1),
+ * the four nucleotides (0 to 3) and all unresolved states (4 to 14, 14 being N).
+ * Counts are computed once, in a single pass over the selected sequences, and other column statistics
+ * (gap counts, entropies, etc.) are then obtained in constant time per column.
+ * Counts can also be computed from rows encoded as runs (see GapRunSequence), in which case gap runs are skipped.
+ */
+class ColumnCounts:
+  public virtual Clonable
+{
+  public:
+    /**
+     * @brief Number of distinct codes: gap, plus the 15 states of the DNA alphabet.
+     */
+    static const size_t NB_CODES = 16;
+
+  private:
+    size_t nbSites_;
+    size_t nbRows_;
+    std::vector<unsigned int> counts_;
+
+  public:
+    ColumnCounts(): nbSites_(0), nbRows_(0), counts_() {}
+
+    /**
+     * @brief Compute counts for a set of sequences.
+     *
+     * @param rows The states of each sequence. All sequences must have nbSites states.
+     * @param nbSites The number of sites.
+     * @throw Exception if a sequence has an invalid state.
+     */
+    ColumnCounts(const std::vector<const std::vector<int>*>& rows, size_t nbSites):
+      nbSites_(0), nbRows_(0), counts_()
+    {
+      compute(rows, nbSites);
+    }
+
+    /**
+     * @brief Compute counts for a set of sequences encoded as runs.
+     *
+     * @param rows The encoded sequences. All sequences must have nbSites columns.
+     * @param nbSites The number of sites.
+     * @throw Exception if a sequence does not have the expected length.
+     */
+    ColumnCounts(const std::vector<const GapRunSequence*>& rows, size_t nbSites):
+      nbSites_(0), nbRows_(0), counts_()
+    {
+      compute(rows, nbSites);
+    }
+
+    ColumnCounts* clone() const { return new ColumnCounts(*this); }
+
+    virtual ~ColumnCounts() {}
+
+  public:
+    void compute(const std::vector<const std::vector<int>*>& rows, size_t nbSites);
+
+    /**
+     * @brief Compute counts for a set of sequences encoded as runs.
+     *
+     * All positions are first counted as gaps, and only residues are then visited, so that the time needed
+     * for each row is proportional to its number of residues.
+     */
+    void compute(const std::vector<const GapRunSequence*>& rows, size_t nbSites);
+
+    size_t getNumberOfSites() const { return nbSites_; }
+
+    size_t getNumberOfRows() const { return nbRows_; }
+
+    /**
+     * @return The number of occurrences of a state at a given site.
+     * @param site The site index.
+     * @param state The state, from -1 (gap) to 14 (N).
+     */
+    unsigned int getCount(size_t site, int state) const {
+      return counts_[site * NB_CODES + static_cast<size_t>(state + 1)];
+    }
+
+    /**
+     * @return A pointer to the NB_CODES counts of a given site, gaps first.
+     */
+    const unsigned int* getCounts(size_t site) const { return &counts_[site * NB_CODES]; }
+
+    unsigned int getNumberOfGaps(size_t site) const { return counts_[site * NB_CODES]; }
+
+    /**
+     * @return The number of unresolved states (including N) at a given site.
+     */
+    unsigned int getNumberOfUnresolved(size_t site) const;
+
+    /**
+     * @return The number of nucleotides (A, C, G or T), at a given site.
+     */
+    unsigned int getNumberOfResolved(size_t site) const;
+
+    /**
+     * @return The Shannon entropy (natural logarithm) of a given site.
+     * @param site The site index.
+     * @param ignoreGaps If true, gaps are not taken into account. Otherwise, they count as a state.
+     * @param unknownAsGap If true, unknown characters (N) are considered as gaps.
+     */
+    double getEntropy(size_t site, bool ignoreGaps = false, bool unknownAsGap = false) const;
+
+    /**
+     * @brief Count states in a sequence.
+     *
+     * This is a branch-free histogram kernel, which can be used independently of the ColumnCounts class.
+     *
+     * @param states A pointer to the states.
+     * @param n The number of states.
+     * @param counts [out] An array of NB_CODES values, where counts will be added (gaps first).
+     * @throw Exception if an invalid state is found.
+     */
+    static void countStates(const int* states, size_t n, unsigned int counts[NB_CODES]);
+
+    /**
+     * @return The NB_CODES characters of the DNA alphabet, gaps first, so that the character of a state is at index state + 1.
+     *
+     * The table is built once, from AlphabetTools::DNA_ALPHABET.
+     */
+    static const std::string& getCharacters();
+
+  private:
+    static std::string buildCharacters_();
+};
+
+} // end of namespace bpp.
+
+#endif //_COLUMNCOUNTS_H_
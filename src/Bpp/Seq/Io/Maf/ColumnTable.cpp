@@ -0,0 +1,87 @@
+//
+// File: ColumnTable.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "ColumnTable.h"
+
+#include <Bpp/Exceptions.h>
+#include <Bpp/Text/TextTools.h>
+
+using namespace bpp;
+
+//From the STL:
+#include <algorithm>
+
+using namespace std;
+
+void ColumnTable::compute(const std::vector<const std::vector<int>*>& rows, size_t nbSites)
+{
+  nbSites_ = nbSites;
+  nbRows_ = rows.size();
+  states_.resize(nbSites * nbRows_);
+  for (size_t j = 0; j < rows.size(); ++j) {
+    if (rows[j]->size() != nbSites)
+      throw Exception("ColumnTable::compute. Sequence " + TextTools::toString(j) + " does not have the expected length.");
+    //Range check first, in a separate loop without branches in the body:
+    const int* row = nbSites > 0 ? &(*rows[j])[0] : 0;
+    unsigned int maxCode = 0;
+    for (size_t c = 0; c < nbSites; ++c) {
+      unsigned int code = static_cast<unsigned int>(row[c] + 1);
+      maxCode = (code > maxCode ? code : maxCode);
+    }
+    if (maxCode >= 16)
+      throw Exception("ColumnTable::compute. Invalid state in sequence " + TextTools::toString(j) + ".");
+  }
+  if (states_.empty()) return;
+
+  //Tiles of TILE_SIZE sites and rows fit in the L1 cache, so that both reads and writes are local:
+  int8_t* states = &states_[0];
+  for (size_t r0 = 0; r0 < nbRows_; r0 += TILE_SIZE) {
+    size_t r1 = min(r0 + TILE_SIZE, nbRows_);
+    for (size_t c0 = 0; c0 < nbSites; c0 += TILE_SIZE) {
+      size_t c1 = min(c0 + TILE_SIZE, nbSites);
+      for (size_t r = r0; r < r1; ++r) {
+        const int* row = &(*rows[r])[0];
+        int8_t* out = states + r;
+        for (size_t c = c0; c < c1; ++c)
+          out[c * nbRows_] = static_cast<int8_t>(row[c]);
+      }
+    }
+  }
+}
+
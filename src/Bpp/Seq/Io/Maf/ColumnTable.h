@@ -0,0 +1,113 @@
+//
+// File: ColumnTable.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _COLUMNTABLE_H_
+#define _COLUMNTABLE_H_
+
+#include <Bpp/Clonable.h>
+
+//From the STL:
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief A site-major copy of the states of a selection of sequences of an alignment block.
+ *
+ * The states of all selected sequences at a given site are stored contiguously, as bytes, so that consumers
+ * looking at complete columns (variant callers, genotype outputs...) read memory linearly, instead of fetching
+ * one value per sequence. States are the DNA codes, from -1 (gap) to 14 (N).
+ *
+ * The table is built once from the row-major sequences, by a cache-blocked transposition, and is typically
+ * shared through the block cache (see MafBlock::getColumnTable).
+ */
+class ColumnTable:
+  public virtual Clonable
+{
+  public:
+    /**
+     * @brief The size of the square tiles used for the transposition.
+     */
+    static const size_t TILE_SIZE = 64;
+
+  private:
+    size_t nbSites_;
+    size_t nbRows_;
+    std::vector<int8_t> states_;
+
+  public:
+    ColumnTable(): nbSites_(0), nbRows_(0), states_() {}
+
+    /**
+     * @brief Transpose a set of sequences.
+     *
+     * @param rows The states of each sequence. All sequences must have nbSites states.
+     * @param nbSites The number of sites.
+     * @throw Exception if a sequence has an invalid state.
+     */
+    ColumnTable(const std::vector<const std::vector<int>*>& rows, size_t nbSites):
+      nbSites_(0), nbRows_(0), states_()
+    {
+      compute(rows, nbSites);
+    }
+
+    ColumnTable* clone() const { return new ColumnTable(*this); }
+
+    virtual ~ColumnTable() {}
+
+  public:
+    void compute(const std::vector<const std::vector<int>*>& rows, size_t nbSites);
+
+    size_t getNumberOfSites() const { return nbSites_; }
+
+    size_t getNumberOfRows() const { return nbRows_; }
+
+    /**
+     * @return A pointer to the getNumberOfRows() states of a given site, in the order of the selection.
+     */
+    const int8_t* getColumn(size_t site) const { return &states_[site * nbRows_]; }
+
+    int getState(size_t site, size_t row) const { return states_[site * nbRows_ + row]; }
+};
+
+} // end of namespace bpp.
+
+#endif //_COLUMNTABLE_H_
@@ -0,0 +1,315 @@
+//
+// File: ColumnarTableOutputMafIterator.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+
+#include "ColumnarTableOutputMafIterator.h"
+#include "BinaryIoTools.h"
+#include "ColumnCounts.h"
+
+//From bpp-core:
+#include <Bpp/Text/TextTools.h>
+
+//From zlib:
+#include <zlib.h>
+
+using namespace bpp;
+
+//From the STL:
+#include <string>
+#include <cstring>
+
+using namespace std;
+
+/******************************************************************************/
+
+ColumnarTableOutputMafIterator::ColumnarTableOutputMafIterator(MafIterator* iterator,
+    std::ostream* out,
+    const std::vector<std::string>& species,
+    const std::string& reference,
+    size_t chunkSize,
+    int compressionLevel) :
+  AbstractFilterMafIterator(iterator),
+  output_(out), species_(species), refSpecies_(reference),
+  chunkSize_(max(chunkSize, static_cast<size_t>(1))), compressionLevel_(compressionLevel),
+  positions_(), chromosomes_(), columns_(species.size()), chrIndex_(), chrNames_(),
+  chunkOffsets_(), chunkSizes_(), offset_(0), buffer_(), compressed_(), closed_(false)
+{
+  if (!output_) return;
+  //Write header:
+  buffer_ = "BPPCOL01";
+  BinaryIoTools::appendUInt(buffer_, static_cast<uint32_t>(species_.size()), 4);
+  BinaryIoTools::appendUInt(buffer_, static_cast<uint32_t>(chunkSize_), 4);
+  buffer_ += ColumnCounts::getCharacters();
+  for (const string& sp : species_)
+    BinaryIoTools::appendString(buffer_, sp);
+  write_(buffer_);
+}
+
+void ColumnarTableOutputMafIterator::write_(const std::string& data)
+{
+  output_->write(data.data(), static_cast<streamsize>(data.size()));
+  if (!*output_)
+    throw IOException("ColumnarTableOutputMafIterator::write_. Cannot write to output stream.");
+  offset_ += data.size();
+}
+
+/******************************************************************************/
+
+void ColumnarTableOutputMafIterator::writeBlock_(const MafBlock& block)
+{
+  //Check for reference species for coordinates:
+  const MafSequence* refSeq = 0;
+  uint32_t chrId = 0xffffffff;
+  if (block.hasSequenceForSpecies(refSpecies_)) {
+    refSeq = &block.getSequenceForSpecies(refSpecies_);
+    map<string, uint32_t>::iterator it = chrIndex_.find(refSeq->getChromosome());
+    if (it == chrIndex_.end()) {
+      chrId = static_cast<uint32_t>(chrNames_.size());
+      chrIndex_[refSeq->getChromosome()] = chrId;
+      chrNames_.push_back(refSeq->getChromosome());
+    } else {
+      chrId = it->second;
+    }
+  }
+
+  //Preprocess data:
+  vector<const vector<int>*> rows;
+  for (const string& sp : species_) {
+    rows.push_back(&block.getSequenceForSpecies(sp).getContent());
+  }
+  const vector<int>* ref = refSeq ? &refSeq->getContent() : 0;
+  int64_t pos = -1; //Position in the reference sequence, -1 before the first character.
+  //Loop over all alignment columns:
+  size_t nbSites = block.getNumberOfSites();
+  for (size_t i = 0; i < nbSites; ) {
+    //Fill the current chunk as much as possible:
+    size_t n = min(nbSites - i, chunkSize_ - positions_.size());
+    for (size_t k = i; k < i + n; ++k) {
+      if (ref) {
+        if ((*ref)[k] >= 0) pos++;
+        positions_.push_back(pos);
+      } else {
+        positions_.push_back(-1);
+      }
+    }
+    chromosomes_.insert(chromosomes_.end(), n, chrId);
+    for (size_t j = 0; j < rows.size(); ++j) {
+      vector<uint8_t>& column = columns_[j];
+      const int* states = &(*rows[j])[i];
+      for (size_t k = 0; k < n; ++k)
+        column.push_back(static_cast<uint8_t>((states[k] + 1) & 0x0f));
+    }
+    i += n;
+    if (positions_.size() == chunkSize_)
+      writeChunk_();
+  }
+}
+
+void ColumnarTableOutputMafIterator::appendColumn_(const void* data, size_t size)
+{
+  const Bytef* raw = reinterpret_cast<const Bytef*>(data);
+  if (compressionLevel_ != 0 && size > 0) {
+    uLongf compressedSize = compressBound(static_cast<uLong>(size));
+    compressed_.resize(compressedSize);
+    if (compress2(&compressed_[0], &compressedSize, raw, static_cast<uLong>(size), compressionLevel_) != Z_OK)
+      throw Exception("ColumnarTableOutputMafIterator::appendColumn_. Compression failed.");
+    buffer_ += static_cast<char>(1);
+    BinaryIoTools::appendUInt(buffer_, static_cast<uint32_t>(compressedSize), 4);
+    BinaryIoTools::appendUInt(buffer_, static_cast<uint32_t>(size), 4);
+    buffer_.append(reinterpret_cast<const char*>(&compressed_[0]), compressedSize);
+  } else {
+    buffer_ += static_cast<char>(0);
+    BinaryIoTools::appendUInt(buffer_, static_cast<uint32_t>(size), 4);
+    BinaryIoTools::appendUInt(buffer_, static_cast<uint32_t>(size), 4);
+    buffer_.append(reinterpret_cast<const char*>(raw), size);
+  }
+}
+
+void ColumnarTableOutputMafIterator::writeChunk_()
+{
+  size_t n = positions_.size();
+  if (n == 0) return;
+  chunkOffsets_.push_back(offset_);
+  chunkSizes_.push_back(static_cast<uint32_t>(n));
+  buffer_.clear();
+  BinaryIoTools::appendUInt(buffer_, static_cast<uint32_t>(n), 4);
+  //Integers are converted to little endian before compression:
+  string tmp;
+  tmp.reserve(n * 8);
+  for (size_t k = 0; k < n; ++k)
+    BinaryIoTools::appendUInt(tmp, static_cast<uint64_t>(positions_[k]), 8);
+  appendColumn_(tmp.data(), tmp.size());
+  tmp.clear();
+  for (size_t k = 0; k < n; ++k)
+    BinaryIoTools::appendUInt(tmp, chromosomes_[k], 4);
+  appendColumn_(tmp.data(), tmp.size());
+  for (size_t j = 0; j < columns_.size(); ++j)
+    appendColumn_(&columns_[j][0], n);
+  write_(buffer_);
+  positions_.clear();
+  chromosomes_.clear();
+  for (size_t j = 0; j < columns_.size(); ++j)
+    columns_[j].clear();
+}
+
+void ColumnarTableOutputMafIterator::close()
+{
+  if (!output_ || closed_) return;
+  closed_ = true;
+  writeChunk_();
+  uint64_t footerOffset = offset_;
+  buffer_ = "FOOT";
+  BinaryIoTools::appendUInt(buffer_, static_cast<uint32_t>(chrNames_.size()), 4);
+  for (const string& chr : chrNames_)
+    BinaryIoTools::appendString(buffer_, chr);
+  BinaryIoTools::appendUInt(buffer_, static_cast<uint32_t>(chunkOffsets_.size()), 4);
+  for (size_t i = 0; i < chunkOffsets_.size(); ++i) {
+    BinaryIoTools::appendUInt(buffer_, chunkOffsets_[i], 8);
+    BinaryIoTools::appendUInt(buffer_, chunkSizes_[i], 4);
+  }
+  BinaryIoTools::appendUInt(buffer_, footerOffset, 8);
+  buffer_ += "BPPCOLND";
+  write_(buffer_);
+  output_->flush();
+}
+
+/******************************************************************************/
+
+ColumnarTableReader::ColumnarTableReader(const std::string& path):
+  path_(path), input_(path.c_str(), ios::in | ios::binary), species_(), chunkSize_(0), states_(ColumnCounts::NB_CODES, '\0'),
+  chrNames_(), chunkOffsets_(), chunkSizes_()
+{
+  if (!input_)
+    throw IOException("ColumnarTableReader (constructor). Cannot open file " + path + ".");
+  char magic[8];
+  input_.read(magic, 8);
+  if (!input_ || memcmp(magic, "BPPCOL01", 8) != 0)
+    throw IOException("ColumnarTableReader (constructor). File " + path + " is not a columnar table.");
+  size_t nbSpecies = readUInt32_();
+  chunkSize_ = readUInt32_();
+  input_.read(&states_[0], static_cast<streamsize>(states_.size()));
+  for (size_t i = 0; i < nbSpecies; ++i)
+    species_.push_back(readString_());
+
+  //Footer:
+  input_.seekg(-16, ios::end);
+  uint64_t footerOffset = readUInt64_();
+  input_.read(magic, 8);
+  if (!input_ || memcmp(magic, "BPPCOLND", 8) != 0)
+    throw IOException("ColumnarTableReader (constructor). File " + path + " is truncated.");
+  input_.seekg(static_cast<streamoff>(footerOffset));
+  input_.read(magic, 4);
+  if (!input_ || memcmp(magic, "FOOT", 4) != 0)
+    throw IOException("ColumnarTableReader (constructor). Invalid footer in file " + path + ".");
+  size_t nbChr = readUInt32_();
+  for (size_t i = 0; i < nbChr; ++i)
+    chrNames_.push_back(readString_());
+  size_t nbChunks = readUInt32_();
+  for (size_t i = 0; i < nbChunks; ++i) {
+    chunkOffsets_.push_back(readUInt64_());
+    chunkSizes_.push_back(readUInt32_());
+  }
+}
+
+uint32_t ColumnarTableReader::readUInt32_()
+{
+  return static_cast<uint32_t>(BinaryIoTools::readUInt(input_, 4, "ColumnarTableReader::readUInt32_", &path_));
+}
+
+uint64_t ColumnarTableReader::readUInt64_()
+{
+  return BinaryIoTools::readUInt(input_, 8, "ColumnarTableReader::readUInt64_", &path_);
+}
+
+string ColumnarTableReader::readString_()
+{
+  return BinaryIoTools::readString(input_, "ColumnarTableReader::readString_", &path_);
+}
+
+void ColumnarTableReader::readColumn_(void* data, size_t size)
+{
+  char encoding;
+  input_.read(&encoding, 1);
+  size_t encodedSize = readUInt32_();
+  size_t rawSize = readUInt32_();
+  if (rawSize != size)
+    throw IOException("ColumnarTableReader::readColumn_. Invalid column size in file " + path_ + ".");
+  if (encoding == 0) {
+    if (size > 0)
+      input_.read(reinterpret_cast<char*>(data), static_cast<streamsize>(size));
+  } else {
+    vector<unsigned char> encoded(encodedSize);
+    if (encodedSize > 0)
+      input_.read(reinterpret_cast<char*>(&encoded[0]), static_cast<streamsize>(encodedSize));
+    uLongf n = static_cast<uLongf>(size);
+    if (uncompress(reinterpret_cast<Bytef*>(data), &n, &encoded[0], static_cast<uLong>(encodedSize)) != Z_OK || n != size)
+      throw IOException("ColumnarTableReader::readColumn_. Invalid compressed column in file " + path_ + ".");
+  }
+  if (!input_)
+    throw IOException("ColumnarTableReader::readColumn_. Unexpected end of file " + path_ + ".");
+}
+
+void ColumnarTableReader::readChunk(size_t chunk, std::vector<int64_t>& positions, std::vector<uint32_t>& chromosomes, std::vector< std::vector<uint8_t> >& columns)
+{
+  if (chunk >= chunkOffsets_.size())
+    throw IndexOutOfBoundsException("ColumnarTableReader::readChunk.", chunk, 0, chunkOffsets_.size() - 1);
+  input_.clear();
+  input_.seekg(static_cast<streamoff>(chunkOffsets_[chunk]));
+  size_t n = readUInt32_();
+  vector<unsigned char> tmp(n * 8);
+  readColumn_(tmp.size() > 0 ? &tmp[0] : 0, n * 8);
+  positions.resize(n);
+  for (size_t k = 0; k < n; ++k) {
+    uint64_t v = 0;
+    for (size_t b = 0; b < 8; ++b)
+      v |= static_cast<uint64_t>(tmp[k * 8 + b]) << (8 * b);
+    positions[k] = static_cast<int64_t>(v);
+  }
+  readColumn_(tmp.size() > 0 ? &tmp[0] : 0, n * 4);
+  chromosomes.resize(n);
+  for (size_t k = 0; k < n; ++k)
+    chromosomes[k] = static_cast<uint32_t>(tmp[k * 4]) | (static_cast<uint32_t>(tmp[k * 4 + 1]) << 8) | (static_cast<uint32_t>(tmp[k * 4 + 2]) << 16) | (static_cast<uint32_t>(tmp[k * 4 + 3]) << 24);
+  columns.resize(species_.size());
+  for (size_t j = 0; j < species_.size(); ++j) {
+    columns[j].resize(n);
+    readColumn_(n > 0 ? &columns[j][0] : 0, n);
+  }
+}
+
+/******************************************************************************/
@@ -0,0 +1,222 @@
+//
+// File: ColumnarTableOutputMafIterator.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+
+#ifndef _COLUMNARTABLEOUTPUTMAFITERATOR_H_
+#define _COLUMNARTABLEOUTPUTMAFITERATOR_H_
+
+#include "MafIterator.h"
+
+//From the STL:
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief This iterator outputs sequence states for selected species and positions, in a columnar binary format.
+ *
+ * This is a binary alternative to TableOutputMafIterator. Rows (alignment columns) are grouped into chunks,
+ * and each chunk stores one column for the position, one for the chromosome and one per species.
+ * All integers are little endian. The file is made of:
+ * - A header: the magic string "BPPCOL01", the number of species (uint32), the chunk size (uint32),
+ *   the 16-character state dictionary (see below), and the species names.
+ * - A series of chunks: the number of rows (uint32), followed by the columns, in this order: position
+ *   (int64, 0-based position in the reference sequence, as returned by MafSequence::getSequencePosition,
+ *   -1 if not available), chromosome (uint32 index in the chromosome dictionary, 0xffffffff if not available),
+ *   then one uint8 column per species. Each column starts with its encoding (uint8, 0 for raw, 1 for zlib),
+ *   its encoded size (uint32) and its raw size (uint32).
+ * - A footer: the magic string "FOOT", the chromosome dictionary (uint32 count, then names), the chunk directory
+ *   (uint32 count, then for each chunk its offset as a uint64 and its number of rows as a uint32), the offset of
+ *   the footer (uint64) and the magic string "BPPCOLND".
+ * Strings are written as their size (uint32) followed by their characters.
+ *
+ * Species states are coded as indices in the state dictionary, that is the state plus one. The dictionary holds the
+ * characters of the gap and of the 15 states of the DNA alphabet, in the alphabet order: "-ACGTMRWSYKVHDBN"
+ * (see ColumnCounts::getCharacters).
+ * The footer allows readers to locate chunks without scanning the file, see ColumnarTableReader.
+ * The footer is written when the input iterator is exhausted, or when the iterator is destroyed.
+ */
+class ColumnarTableOutputMafIterator:
+  public AbstractFilterMafIterator
+{
+  private:
+    std::ostream* output_;
+    std::vector<std::string> species_;
+    std::string refSpecies_;
+    size_t chunkSize_;
+    int compressionLevel_;
+    std::vector<int64_t> positions_;
+    std::vector<uint32_t> chromosomes_;
+    std::vector< std::vector<uint8_t> > columns_;
+    std::map<std::string, uint32_t> chrIndex_;
+    std::vector<std::string> chrNames_;
+    std::vector<uint64_t> chunkOffsets_;
+    std::vector<uint32_t> chunkSizes_;
+    uint64_t offset_;
+    std::string buffer_;
+    std::vector<unsigned char> compressed_;
+    bool closed_;
+
+  public:
+    /**
+     * @brief Build a new ColumnarTableOutputMafIterator object.
+     *
+     * @param iterator The input iterator.
+     * @param out The output stream where to write the table file. It should be open in binary mode.
+     * @param species A list of species for which sequence content should be output (one column per selected species).
+     * In case one species is duplicated in a block, the first sequence will be used.
+     * @param reference The species to use as a reference for coordinates.
+     * It does not have to be one of the selected species for output.
+     * @param chunkSize The number of rows per chunk.
+     * @param compressionLevel The zlib compression level of the columns. 0 means no compression.
+     */
+    ColumnarTableOutputMafIterator(MafIterator* iterator,
+        std::ostream* out,
+        const std::vector<std::string>& species,
+        const std::string& reference,
+        size_t chunkSize = 65536,
+        int compressionLevel = 1);
+
+  private:
+    ColumnarTableOutputMafIterator(const ColumnarTableOutputMafIterator& iterator);
+    ColumnarTableOutputMafIterator& operator=(const ColumnarTableOutputMafIterator& iterator);
+
+  public:
+    virtual ~ColumnarTableOutputMafIterator()
+    {
+      try {
+        close();
+      } catch (std::exception& e) {
+        //Destructors must not throw.
+      }
+    }
+
+    /**
+     * @brief Write the last chunk and the footer.
+     *
+     * No block will be written after this method has been called.
+     */
+    void close();
+
+    MafBlock* analyseCurrentBlock_() {
+      currentBlock_ = iterator_->nextBlock();
+      if (output_ && !closed_) {
+        if (currentBlock_)
+          writeBlock_(*currentBlock_);
+        else
+          close(); //No more block.
+      }
+      return currentBlock_;
+    }
+
+  private:
+    void writeBlock_(const MafBlock& block);
+    void writeChunk_();
+    void appendColumn_(const void* data, size_t size);
+    void write_(const std::string& data);
+};
+
+/**
+ * @brief Read files written by ColumnarTableOutputMafIterator.
+ *
+ * Chunks can be read in any order.
+ */
+class ColumnarTableReader
+{
+  private:
+    std::string path_;
+    std::ifstream input_;
+    std::vector<std::string> species_;
+    size_t chunkSize_;
+    std::string states_;
+    std::vector<std::string> chrNames_;
+    std::vector<uint64_t> chunkOffsets_;
+    std::vector<uint32_t> chunkSizes_;
+
+  public:
+    /**
+     * @param path The file to read.
+     * @throw IOException If the file cannot be read or is not a valid table.
+     */
+    ColumnarTableReader(const std::string& path);
+
+  private:
+    ColumnarTableReader(const ColumnarTableReader&);
+    ColumnarTableReader& operator=(const ColumnarTableReader&);
+
+  public:
+    const std::vector<std::string>& getSpecies() const { return species_; }
+
+    const std::vector<std::string>& getChromosomes() const { return chrNames_; }
+
+    /**
+     * @return The state dictionary, that is the character of each state code.
+     */
+    const std::string& getStates() const { return states_; }
+
+    size_t getNumberOfChunks() const { return chunkOffsets_.size(); }
+
+    size_t getNumberOfRows(size_t chunk) const { return chunkSizes_[chunk]; }
+
+    /**
+     * @brief Read one chunk.
+     *
+     * @param chunk The chunk index.
+     * @param positions [out] The positions of all rows.
+     * @param chromosomes [out] The chromosome indices of all rows.
+     * @param columns [out] One vector of state codes per species.
+     * @throw IOException If the chunk cannot be read.
+     */
+    void readChunk(size_t chunk, std::vector<int64_t>& positions, std::vector<uint32_t>& chromosomes, std::vector< std::vector<uint8_t> >& columns);
+
+  private:
+    uint32_t readUInt32_();
+    uint64_t readUInt64_();
+    std::string readString_();
+    void readColumn_(void* data, size_t size);
+};
+
+} // end of namespace bpp.
+
+#endif //_COLUMNARTABLEOUTPUTMAFITERATOR_H_
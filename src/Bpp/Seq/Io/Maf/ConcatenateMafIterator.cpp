@@ -53,94 +53,63 @@ using namespace std;
 MafBlock* ConcatenateMafIterator::analyseCurrentBlock_()
 {
   if (!incomingBlock_) return 0;
-  currentBlock_  = incomingBlock_;
+  appender_.reset(incomingBlock_);
   incomingBlock_ = iterator_->nextBlock();
   size_t count = 1;
-  if (verbose_)
+  if (displaysTasks_())
     ApplicationTools::displayMessage("Concatenating new block...");
   while (incomingBlock_ &&
           (refSpecies_ == "" || 
             (incomingBlock_->hasSequenceForSpecies(refSpecies_) &&
-              currentBlock_->hasSequenceForSpecies(refSpecies_) &&
+              appender_.hasSequenceForSpecies(refSpecies_) &&
               incomingBlock_->getSequenceForSpecies(refSpecies_).getChromosome() ==
-              currentBlock_->getSequenceForSpecies(refSpecies_).getChromosome()
+              appender_.getSequenceForSpecies(refSpecies_).getChromosome()
             )
           )
         )
   {
-    if (currentBlock_->getNumberOfSites() >= minimumSize_) {
-      return currentBlock_;
+    if (appender_.getNumberOfSites() >= minimumSize_) {
+      break;
     }
-    if (verbose_) {
+    if (displaysTasks_()) {
       ApplicationTools::displayUnlimitedGauge(count++, "Concatenating...");
     }
 
-    //We merge the two blocks:
-    vector<string> sp1 = currentBlock_->getSpeciesList();
-    vector<string> sp2 = incomingBlock_->getSpeciesList();
-    vector<string> allSp = VectorTools::unique(VectorTools::vectorUnion(sp1, sp2));
-    //We need to create a new MafBlock:
-    MafBlock* mergedBlock = new MafBlock();
-    //We average the score and pass values:
-    unsigned int p1 = currentBlock_->getPass();
-    unsigned int p2 = incomingBlock_->getPass();
-    if (p1 == p2) mergedBlock->setPass(p1);
-    double s1 = currentBlock_->getScore();
-    double n1 = static_cast<double>(currentBlock_->getNumberOfSites());
-    double s2 = incomingBlock_->getScore();
-    double n2 = static_cast<double>(incomingBlock_->getNumberOfSites());
-    mergedBlock->setScore((s1 * n1 + s2 * n2) / (n1 + n2));
-
-    //Now fill the new block:
-    for (size_t i = 0; i < allSp.size(); ++i) {
-      unique_ptr<MafSequence> seq;
-      try {
-        seq.reset(new MafSequence(currentBlock_->getSequenceForSpecies(allSp[i])));
-
-        //Check is there is a second sequence:
-        try {
-          unique_ptr<MafSequence> tmp(new MafSequence(incomingBlock_->getSequenceForSpecies(allSp[i])));
-          string ref1 = seq->getDescription(), ref2 = tmp->getDescription();
-          if (seq->getChromosome() != tmp->getChromosome()) {
-            seq->setChromosome("fus");
-            seq->removeCoordinates();
-          }
-          if (seq->getStrand() != tmp->getStrand()) {
-            seq->setStrand('?');
-            seq->removeCoordinates();
-          }
-          if (seq->getName() != tmp->getName())
-            tmp->setName(seq->getName()); //force name conversion to prevent exception in 'merge'.
-          seq->merge(*tmp);
-          if (logstream_) {
-            (*logstream_ << "BLOCK CONCATENATE: merging " << ref1 << " with " << ref2 << " into " << seq->getDescription()).endLine();
-          }
-        } catch (SequenceNotFoundException& snfe2) {
-          //There was a first sequence, we just extend it:
-          string ref1 = seq->getDescription();
-          seq->setToSizeR(seq->size() + incomingBlock_->getNumberOfSites());
-          if (logstream_) {
-            (*logstream_ << "BLOCK CONCATENATE: extending " << ref1 << " with " << incomingBlock_->getNumberOfSites() << " gaps on the right.").endLine();
-          }
+    //We append the incoming block to the current one, in place:
+    vector<string> sp2 = VectorTools::unique(incomingBlock_->getSpeciesList());
+    for (size_t i = 0; i < sp2.size(); ++i) {
+      const MafSequence& tmp = incomingBlock_->getSequenceForSpecies(sp2[i]);
+      MafSequence* seq = appender_.getSequenceToExtend(sp2[i]);
+      if (seq) {
+        string ref1 = seq->getDescription(), ref2 = tmp.getDescription();
+        if (seq->getChromosome() != tmp.getChromosome()) {
+          seq->setChromosome("fus");
+          seq->removeCoordinates();
+        }
+        if (seq->getStrand() != tmp.getStrand()) {
+          seq->setStrand('?');
+          seq->removeCoordinates();
+        }
+        appender_.appendToSequence(*seq, tmp);
+        if (logstream_) {
+          (*logstream_ << "BLOCK CONCATENATE: merging " << ref1 << " with " << ref2 << " into " << seq->getDescription()).endLine();
         }
-      } catch (SequenceNotFoundException& snfe1) {
-        //There must be a second sequence then:
-        seq.reset(new MafSequence(incomingBlock_->getSequenceForSpecies(allSp[i])));
-        string ref2 = seq->getDescription();
-        seq->setToSizeL(seq->size() + currentBlock_->getNumberOfSites());
+      } else {
+        //The species is new, its sequence is extended with gaps on the left:
+        appender_.addSequence(tmp);
         if (logstream_) {
-          (*logstream_ << "BLOCK CONCATENATE: adding " << ref2 << " and extend it with " << currentBlock_->getNumberOfSites() << " gaps on the left.").endLine();
+          (*logstream_ << "BLOCK CONCATENATE: adding " << tmp.getDescription() << " and extend it with " << appender_.getNumberOfSites() << " gaps on the left.").endLine();
         }
       }
-      mergedBlock->addSequence(*seq);
     }
+    //Sequences missing from the incoming block are extended with gaps on the right when needed.
+    appender_.endBlock(*incomingBlock_);
     //Cleaning stuff:
-    delete currentBlock_;
-    delete incomingBlock_;
-    currentBlock_ = mergedBlock;
+    recycle(incomingBlock_);
     //We check if we can also merge the next block:
     incomingBlock_ = iterator_->nextBlock();
   }
+  currentBlock_ = appender_.release();
   return currentBlock_;
 }
 
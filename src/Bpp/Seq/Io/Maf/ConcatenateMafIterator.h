@@ -41,6 +41,7 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _CONCATENATEMAFITERATOR_H_
 
 #include "MafIterator.h"
+#include "MafBlockAppender.h"
 
 //From the STL:
 #include <iostream>
@@ -64,31 +65,30 @@ class ConcatenateMafIterator:
     MafBlock* incomingBlock_;
     unsigned int minimumSize_;
     std::string refSpecies_;
+    MafBlockAppender appender_;
 
   public:
     ConcatenateMafIterator(MafIterator* iterator, unsigned int minimumSize, std::string refSpecies = "") :
       AbstractFilterMafIterator(iterator),
       incomingBlock_(0),
       minimumSize_(minimumSize),
-      refSpecies_(refSpecies)
+      refSpecies_(refSpecies),
+      appender_(this)
     {
       incomingBlock_ = iterator->nextBlock();
     }
 
   private:
-    ConcatenateMafIterator(const ConcatenateMafIterator& iterator) :
-      AbstractFilterMafIterator(0),
-      incomingBlock_(iterator.incomingBlock_),
-      minimumSize_(iterator.minimumSize_),
-      refSpecies_(iterator.refSpecies_)
-    {}
-    
-    ConcatenateMafIterator& operator=(const ConcatenateMafIterator& iterator)
-    {
-      incomingBlock_ = iterator.incomingBlock_;
-      minimumSize_ = iterator.minimumSize_;
-      refSpecies_ = iterator.refSpecies_;
-      return *this;
+    //Recopy is forbidden!
+    ConcatenateMafIterator(const ConcatenateMafIterator& iterator);
+    ConcatenateMafIterator& operator=(const ConcatenateMafIterator& iterator);
+
+  protected:
+    void getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const {
+      if (incomingBlock_) {
+        nbBlocks++;
+        nbBytes += incomingBlock_->getMemorySize();
+      }
     }
 
   private:
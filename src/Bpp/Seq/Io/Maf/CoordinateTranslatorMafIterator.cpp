@@ -40,9 +40,6 @@ knowledge of the CeCILL license and that you accept its terms.
 
 #include "CoordinateTranslatorMafIterator.h"
 
-//From bpp-seq:
-#include <Bpp/Seq/SequenceWalker.h>
-
 using namespace bpp;
 
 //From the STL:
@@ -66,22 +63,14 @@ MafBlock* CoordinateTranslatorMafIterator::analyseCurrentBlock_()
   const MafSequence& refSeq = block->getSequenceForSpecies(referenceSpecies_);
   const MafSequence& targetSeq = block->getSequenceForSpecies(targetSpecies_);
 
-  //first check if there is one (for now we assume that features refer to the chromosome or contig name, with implicit species):
-  std::map<std::string, SequenceFeatureSet*>::iterator mr = inputFeaturesPerChr_.find(refSeq.getChromosome());
-  if (mr == inputFeaturesPerChr_.end())
-    return block.release();
-    
-  //second get only features within this block:
-  unique_ptr<SequenceFeatureSet> selectedFeatures(mr->second->getSubsetForRange(SeqRange(refSeq.getRange(true)), true)); 
+  //get only features within this block (for now we assume that features refer to the chromosome or contig name, with implicit species):
+  RangeSet<size_t> ranges;
+  index_->fillRangeCollectionForRange(refSeq.getChromosome(), refSeq.getRange(true), true, ranges);
 
   //test if there are some features to translate here:
-  if (selectedFeatures->isEmpty())
+  if (ranges.isEmpty())
     return block.release();
 
-  //Get coordinate range sets:
-  RangeSet<size_t> ranges;
-  selectedFeatures->fillRangeCollection(ranges);
-
   //If the reference sequence is on the negative strand, then we have to correct the coordinates:
   if (refSeq.getStrand() == '-') {
     RangeSet<size_t> cRanges;
@@ -94,12 +83,10 @@ MafBlock* CoordinateTranslatorMafIterator::analyseCurrentBlock_()
     ranges = cRanges;
   }
 
-  //We will need to convert to alignment positions, using a sequence walker:
-  SequenceWalker referenceWalker(refSeq);
-  SequenceWalker targetWalker(targetSeq);
+  //Positions are converted using the gap index of each sequence.
 
   //Now creates all blocks for all ranges:
-  if (verbose_) {
+  if (displaysTasks_()) {
     ApplicationTools::message->endLine();
     ApplicationTools::displayTask("Extracting annotations", true);
   }
@@ -113,21 +100,21 @@ MafBlock* CoordinateTranslatorMafIterator::analyseCurrentBlock_()
       it !=  ranges.getSet().end();
       ++it)
   {
-    if (verbose_) {
-      ApplicationTools::displayGauge(i++, ranges.getSet().size() - 1, '=');
+    if (displaysTasks_()) {
+      displayGauge_(i++, ranges.getSet().size() - 1, '=');
     }
-    size_t a = referenceWalker.getAlignmentPosition((**it).begin() - refSeq.start());
-    size_t b = referenceWalker.getAlignmentPosition((**it).end() - refSeq.start() - 1);
+    size_t a = refSeq.getAlignmentPosition((**it).begin() - refSeq.start());
+    size_t b = refSeq.getAlignmentPosition((**it).end() - refSeq.start() - 1);
     string targetPos1 = "NA", targetPos2 = "NA";
     if (!alphabet->isGap(targetSeq[a]) || outputClosestCoordinate_) {
-      size_t a2 = targetWalker.getSequencePosition(a) + targetSeq.start();
+      size_t a2 = targetSeq.getSequencePosition(a) + targetSeq.start();
       if (targetSeq.getStrand() == '-') {
         a2 = targetSeq.getSrcSize() - a2;
       }
       targetPos1 = TextTools::toString(a2);
     }
     if (!alphabet->isGap(targetSeq[b]) || outputClosestCoordinate_) {
-      size_t b2 = targetWalker.getSequencePosition(b) + targetSeq.start() + 1;
+      size_t b2 = targetSeq.getSequencePosition(b) + targetSeq.start() + 1;
       if (targetSeq.getStrand() == '-') {
         b2 = targetSeq.getSrcSize() - b2;
       }
@@ -137,7 +124,7 @@ MafBlock* CoordinateTranslatorMafIterator::analyseCurrentBlock_()
     output_ << targetSeq.getChromosome() << "\t" << targetSeq.getStrand() << "\t" << targetPos1 << "\t" << targetPos2 << endl;
   }
         
-  if (verbose_)
+  if (displaysTasks_())
     ApplicationTools::displayTaskDone();
 
   //Block is simply forwarded:
@@ -41,11 +41,13 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _COORDINATETRANSLATORMAFITERATOR_H_
 
 #include "MafIterator.h"
+#include "../../Feature/FeatureRangeIndex.h"
 
 //From the STL:
 #include <iostream>
 #include <string>
 #include <deque>
+#include <memory>
 
 //From bpp-core:
 #include <Bpp/Numeric/DataTable.h>
@@ -57,6 +59,8 @@ namespace bpp {
  *
  * This filter is similar in principle to the UCSC "liftOver" utility and software alike.
  * For now, only write a text file with all coordinates from reference and corresponding target sequence.
+ * To translate arbitrary positions on demand, without parsing the alignment again, see LiftoverIndex.
+ * Features are looked up in a FeatureRangeIndex, which may be shared with other iterators.
  */
 class CoordinateTranslatorMafIterator:
   public AbstractFilterMafIterator
@@ -64,7 +68,8 @@ class CoordinateTranslatorMafIterator:
   private:
     std::string referenceSpecies_;
     std::string targetSpecies_;
-    std::map<std::string, SequenceFeatureSet*> inputFeaturesPerChr_;
+    std::unique_ptr<FeatureRangeIndex> ownedIndex_;
+    const FeatureRangeIndex* index_;
     std::ostream& output_;
     bool outputClosestCoordinate_;
 
@@ -90,31 +95,45 @@ class CoordinateTranslatorMafIterator:
       AbstractFilterMafIterator(iterator),
       referenceSpecies_(referenceSpecies),
       targetSpecies_(targetSpecies),
-      inputFeaturesPerChr_(),
+      ownedIndex_(new FeatureRangeIndex(features)),
+      index_(ownedIndex_.get()),
       output_(output),
       outputClosestCoordinate_(outputClosestCoordinate)
     {
-      //Sort features per chromosome for a faster access:
-      std::set<std::string> seqIds = features.getSequences();
-      for (std::set<std::string>::iterator it = seqIds.begin();
-          it != seqIds.end();
-          ++it) {
-        {
-          inputFeaturesPerChr_[*it] = features.getSubsetForSequence(*it);
-        }
-      }
       output_ << "chr.ref\tstrand.ref\tbegin.ref\tend.ref\tchr.target\tstrand.target\tbegin.target\tend.target" << std::endl;
     }
 
-    virtual ~CoordinateTranslatorMafIterator() {
-      //Clean sorted features.
-      for (std::map<std::string, SequenceFeatureSet*>::iterator it = inputFeaturesPerChr_.begin();
-          it != inputFeaturesPerChr_.end();
-          it++) {
-        delete it->second;
-      }
+    /**
+     * @brief Build a new CoordinateTranslator iterator from a shared feature index.
+     *
+     * @param iterator The input iterator
+     * @param referenceSpecies The reference species for feature coordinates
+     * @param targetSpecies The target species for which features coordinates should be translated
+     * @param index An index of the features to lift over, which must outlive this iterator.
+     * @param output Output stream for translated coordinates
+     * @param outputClosestCoordinate In case the target sequence has a gap at the corresponding position,
+     *        tells if the previous non-gap position should be returned, or NA.
+     */
+    CoordinateTranslatorMafIterator(
+        MafIterator* iterator,
+        const std::string& referenceSpecies,
+        const std::string& targetSpecies,
+        const FeatureRangeIndex& index,
+        std::ostream& output,
+        bool outputClosestCoordinate = true) :
+      AbstractFilterMafIterator(iterator),
+      referenceSpecies_(referenceSpecies),
+      targetSpecies_(targetSpecies),
+      ownedIndex_(),
+      index_(&index),
+      output_(output),
+      outputClosestCoordinate_(outputClosestCoordinate)
+    {
+      output_ << "chr.ref\tstrand.ref\tbegin.ref\tend.ref\tchr.target\tstrand.target\tbegin.target\tend.target" << std::endl;
     }
 
+    virtual ~CoordinateTranslatorMafIterator() {}
+
   private:
     MafBlock* analyseCurrentBlock_();
 
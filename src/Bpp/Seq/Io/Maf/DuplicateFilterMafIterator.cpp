@@ -44,40 +44,96 @@ using namespace bpp;
 //From the STL:
 #include <string>
 #include <numeric>
+#include <algorithm>
 
 using namespace std;
 
+//Marks empty slots in the hash set:
+static const uint64_t EMPTY_SLOT = UINT64_MAX;
+
+static inline uint64_t mixKey(uint64_t h, uint64_t x)
+{
+  h ^= x + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return h;
+}
+
+void DuplicateFilterMafIterator::BlockKeySet_::insert_(const BlockKey_& key)
+{
+  size_t mask = slots_.size() - 1;
+  size_t i = static_cast<size_t>(mixKey(mixKey(mixKey(0, key.chrStrand), key.start), key.stop)) & mask;
+  while (slots_[i].chrStrand != EMPTY_SLOT) {
+    if (slots_[i] == key) return;
+    i = (i + 1) & mask;
+  }
+  slots_[i] = key;
+  size_++;
+}
+
+bool DuplicateFilterMafIterator::BlockKeySet_::insert(const BlockKey_& key)
+{
+  //Keep the load factor below 1/2, capacity is always a power of 2:
+  if (2 * (size_ + 1) > slots_.size()) {
+    BlockKey_ empty = { EMPTY_SLOT, 0, 0 };
+    vector<BlockKey_> old(max(static_cast<size_t>(16), 2 * slots_.size()), empty);
+    old.swap(slots_);
+    size_ = 0;
+    for (size_t i = 0; i < old.size(); ++i) {
+      if (old[i].chrStrand != EMPTY_SLOT)
+        insert_(old[i]);
+    }
+  }
+  size_t n = size_;
+  insert_(key);
+  return size_ > n;
+}
+
+void DuplicateFilterMafIterator::BlockKeySet_::clear()
+{
+  if (size_ == 0) return;
+  BlockKey_ empty = { EMPTY_SLOT, 0, 0 };
+  fill(slots_.begin(), slots_.end(), empty);
+  size_ = 0;
+}
+
 MafBlock* DuplicateFilterMafIterator::analyseCurrentBlock_()
 {
   currentBlock_ = iterator_->nextBlock();
   while (currentBlock_) {
-    bool foundRef = false;
-    string chr = "";
-    char strand = '+';
-    size_t start = 0;
-    size_t stop  = 0;
-    for (size_t i = 0; i < currentBlock_->getNumberOfSequences() && !foundRef; ++i) {
-      string species = currentBlock_->getSequence(i).getSpecies(); 
-      if (species == ref_) {
-        foundRef = true;
-        chr    = currentBlock_->getSequence(i).getChromosome();
-        strand = currentBlock_->getSequence(i).getStrand();
-        start  = currentBlock_->getSequence(i).start();
-        stop   = currentBlock_->getSequence(i).stop();
-      }
-    }
-    if (!foundRef) {
+    if (!currentBlock_->hasSequenceForSpecies(ref_)) {
       if (logstream_) {
         (*logstream_ << "DUPLICATE FILTER: block does not contain reference species and was removed.").endLine();
       }
-      delete currentBlock_;
+      recycle(currentBlock_);
     } else {
-      size_t occurrence = blocks_[chr][strand][start][stop]++;
-      if (occurrence > 0) {
+      const MafSequence& refSeq = currentBlock_->getSequenceForSpecies(ref_);
+      size_t start = refSeq.start();
+      size_t chr = refSeq.getChromosomeId();
+      if (sortedInput_) {
+        //Only blocks starting at the same position can be duplicates:
+        if (chrIds_.insert(chr).second) {
+          currentChr_ = chr;
+          currentStart_ = start;
+          blocks_.clear();
+        } else if (chr != currentChr_ || start < currentStart_) {
+          throw Exception("DuplicateFilterMafIterator::nextBlock. Input blocks are not sorted according to reference species '" + ref_ + "' (block " + currentBlock_->getDescription() + ").");
+        } else if (start > currentStart_) {
+          currentStart_ = start;
+          blocks_.clear();
+        }
+      }
+      BlockKey_ key = {
+        (static_cast<uint64_t>(chr) << 8) | static_cast<unsigned char>(refSeq.getStrand()),
+        static_cast<uint64_t>(start),
+        static_cast<uint64_t>(refSeq.stop())
+      };
+      if (!blocks_.insert(key)) {
         if (logstream_) {
           (*logstream_ << "DUPLICATE FILTER: sequence in reference species was found in a previous block. New block was removed.").endLine();
         }
-        delete currentBlock_;
+        recycle(currentBlock_);
       } else {
         return currentBlock_;
       }
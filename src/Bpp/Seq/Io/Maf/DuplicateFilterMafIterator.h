@@ -46,44 +46,110 @@ knowledge of the CeCILL license and that you accept its terms.
 #include <iostream>
 #include <string>
 #include <deque>
+#include <vector>
+#include <set>
+#include <cstdint>
 
 namespace bpp {
 
 /**
  * @brief Filter maf blocks to remove duplicated blocks, according to a reference sequence).
+ *
+ * Blocks are identified by the chromosome, strand, start and stop positions of the reference sequence.
+ * Coordinates of all blocks seen so far are stored in a flat hash set.
+ * If the input is known to be sorted by chromosome and start position of the reference sequence,
+ * only the coordinates of blocks sharing the current start position are kept, so that memory usage remains constant.
  */
 class DuplicateFilterMafIterator:
   public AbstractFilterMafIterator
 {
+  private:
+    /**
+     * @brief Packed coordinates of a block in the reference sequence.
+     */
+    struct BlockKey_ {
+      uint64_t chrStrand; //Chromosome id and strand.
+      uint64_t start;
+      uint64_t stop;
+      bool operator==(const BlockKey_& key) const {
+        return chrStrand == key.chrStrand && start == key.start && stop == key.stop;
+      }
+    };
+
+    /**
+     * @brief Open-addressing hash set of block keys, with linear probing.
+     */
+    class BlockKeySet_ {
+      private:
+        std::vector<BlockKey_> slots_;
+        size_t size_;
+
+      public:
+        BlockKeySet_(): slots_(), size_(0) {}
+
+      public:
+        /**
+         * @return True if the key was inserted, false if it was already present.
+         */
+        bool insert(const BlockKey_& key);
+        /**
+         * @brief Remove all keys, keeping the allocated capacity.
+         */
+        void clear();
+        size_t size() const { return size_; }
+
+      private:
+        void insert_(const BlockKey_& key);
+    };
+
   private:
     std::string ref_;
+    bool sortedInput_;
+    std::set<size_t> chrIds_; //In sorted mode, the IDs of all chromosomes seen so far.
     /**
-     * Contains the list of 'seen' block, as [chr][strand][start][stop]
+     * Contains the list of 'seen' block. In sorted mode, only blocks starting at the current position are stored.
      */
-    std::map< std::string, std::map< char, std::map< size_t, std::map< size_t, size_t > > > > blocks_;
+    BlockKeySet_ blocks_;
+    //In sorted mode, the current chromosome id and start position:
+    size_t currentChr_;
+    size_t currentStart_;
 
   public:
     /**
      * @param iterator The input iterator.
      * @param reference The reference species name.
+     * @param sortedInput Tell if input blocks are sorted by chromosome and start position of the reference sequence.
+     * In this case, only a constant amount of memory is used, and an exception is thrown if unsorted blocks are found.
      */
-    DuplicateFilterMafIterator(MafIterator* iterator, const std::string& reference) :
+    DuplicateFilterMafIterator(MafIterator* iterator, const std::string& reference, bool sortedInput = false) :
       AbstractFilterMafIterator(iterator),
       ref_(reference),
-      blocks_()
+      sortedInput_(sortedInput),
+      chrIds_(),
+      blocks_(),
+      currentChr_(0),
+      currentStart_(0)
     {}
 
   private:
     DuplicateFilterMafIterator(const DuplicateFilterMafIterator& iterator) :
       AbstractFilterMafIterator(0),
       ref_(iterator.ref_),
-      blocks_(iterator.blocks_)
+      sortedInput_(iterator.sortedInput_),
+      chrIds_(iterator.chrIds_),
+      blocks_(iterator.blocks_),
+      currentChr_(iterator.currentChr_),
+      currentStart_(iterator.currentStart_)
     {}
     
     DuplicateFilterMafIterator& operator=(const DuplicateFilterMafIterator& iterator)
     {
-      ref_    = iterator.ref_;
-      blocks_ = iterator.blocks_;
+      ref_          = iterator.ref_;
+      sortedInput_  = iterator.sortedInput_;
+      chrIds_       = iterator.chrIds_;
+      blocks_       = iterator.blocks_;
+      currentChr_   = iterator.currentChr_;
+      currentStart_ = iterator.currentStart_;
       return *this;
     }
 
@@ -38,202 +38,109 @@ knowledge of the CeCILL license and that you accept its terms.
 */
 
 #include "EntropyFilterMafIterator.h"
+#include "SlidingWindowTools.h"
 
 using namespace bpp;
 
 //From the STL:
 #include <string>
 #include <numeric>
+#include <algorithm>
 
 using namespace std;
 
-MafBlock* EntropyFilterMafIterator::analyseCurrentBlock_()
+//Events reported by this filter:
+static const MafEventType ENTROPY_KEPT("ENTROPY CLEANER", "kept", MafEventType::LEVEL_DEBUG,
+    "ENTROPY CLEANER: block %d is clean and kept as is.");
+static const MafEventType ENTROPY_REMOVED("ENTROPY CLEANER", "removed", MafEventType::LEVEL_INFO,
+    "ENTROPY CLEANER: block %d was entirely removed. Tried to get the next one.");
+static const MafEventType ENTROPY_SPLIT("ENTROPY CLEANER", "split", MafEventType::LEVEL_INFO,
+    "ENTROPY CLEANER: block %d with size %0 will be split into %1 blocks.");
+static const MafEventType ENTROPY_REGION_REMOVED("ENTROPY CLEANER", "region_removed", MafEventType::LEVEL_DEBUG,
+    "ENTROPY CLEANER: removing region (%0, %1) from block %d.");
+
+MafBlock* EntropyFilterMafIterator::splitNextBlock_()
 {
-  if (blockBuffer_.size() == 0) {
-    //Else there is no more block in the buffer, we need to parse more:
-    do {
-      MafBlock* block = iterator_->nextBlock();
-      if (!block) return 0; //No more block.
-    
-      //Parse block.
-      int gap = AlphabetTools::DNA_ALPHABET.getGapCharacterCode();
-      //unused for now
-      //int unk = AlphabetTools::DNA_ALPHABET.getUnknownCharacterCode();
-      size_t nr;
-      size_t nc = static_cast<size_t>(block->getNumberOfSites());
-      if (nc < windowSize_)
-        throw Exception("EntropyFilterMafIterator::analyseCurrentBlock_. Block is smaller than window size: " + TextTools::toString(nc));
-
-      vector< vector<int> > aln;
-      if (missingAsGap_ && !ignoreGaps_) {
-        nr = species_.size();
-        aln.resize(nr);
-        for (size_t i = 0; i < nr; ++i) {
-          if (block->hasSequenceForSpecies(species_[i]))
-            aln[i] = block->getSequenceForSpecies(species_[i]).getContent();
-          else {
-            aln[i].resize(nc); 
-            fill(aln[i].begin(), aln[i].end(), gap);
-          } 
-        }
-      } else {
-        vector<string> speciesSet = VectorTools::vectorIntersection(species_, block->getSpeciesList());
-        nr = speciesSet.size();
-        aln.resize(nr);
-        for (size_t i = 0; i < nr; ++i) {
-          aln[i] = block->getSequenceForSpecies(species_[i]).getContent();
-        }
-      }
-      //First we create a mask:
-      vector<size_t> pos;
-      //Reset window:
-      window_.clear();
-      //Init window:
-      size_t i;
-      for (i = 0; i < windowSize_; ++i) {
-        vector<int> col;
-        for (size_t j = 0; j < nr; ++j) {
-          int x = aln[j][i];
-          if (x != gap || !ignoreGaps_)
-            col.push_back(x);
-        }
-        double entropy = VectorTools::shannonDiscrete<int, double>(col) / log(5.);
-        window_.push_back(entropy > maxEnt_ ? 1 : 0);
+  //Else there is no more block in the buffer, we need to parse more:
+  do {
+    MafBlock* block = iterator_->nextBlock();
+    if (!block) return 0; //No more block.
+  
+    //Parse block.
+    size_t nc = static_cast<size_t>(block->getNumberOfSites());
+    //A block smaller than the window is evaluated as a single window:
+    size_t windowSize = min(static_cast<size_t>(windowSize_), nc);
+
+    //Column counts and entropies are computed once for the block (counts are shared with other stages),
+    //then the number of high entropy positions in each window is obtained with prefix sums:
+    const ColumnCounts& counts = block->getColumnCounts(species_, false, missingAsGap_ && !ignoreGaps_);
+    vector<unsigned int> isHighEntropy(nc);
+    double log5 = log(5.);
+    for (size_t c = 0; c < nc; ++c) {
+      double entropy = counts.getEntropy(c, ignoreGaps_) / log5;
+      isHighEntropy[c] = (entropy > maxEnt_ ? 1 : 0);
+    }
+    PrefixSums<unsigned int> entSums(isHighEntropy);
+    //First we create a mask:
+    vector<size_t> pos;
+    //Slide window:
+    if (displaysTasks_()) {
+      ApplicationTools::message->endLine();
+      ApplicationTools::displayTask("Sliding window for entropy filter", true);
+    }
+    vector<size_t> ends = SlidingWindowTools::getWindowEnds(nc, windowSize, step_);
+    for (size_t w = 0; w < ends.size(); ++w) {
+      bool last = (w + 1 == ends.size());
+      if (displaysTasks_() && !last)
+        displayGauge_(ends[w] - windowSize, nc - windowSize - 1, '>');
+      //Evaluate current window:
+      unsigned int count = entSums.sum(ends[w] - windowSize, ends[w]);
+      if (count <= maxPos_) { // flipped this logic to make passing windows fail
+        //Note: contiguous regions are only merged on the last window.
+        SlidingWindowTools::addRegion(pos, ends[w] - windowSize, ends[w], !last);
       }
-      //Slide window:
-      if (verbose_) {
+    }
+    size_t i;
+    if (displaysTasks_())
+      ApplicationTools::displayTaskDone();
+  
+    //Now we remove regions with two many gaps, using a sliding window:
+    if (pos.size() == 0) {
+      logEvent_(ENTROPY_KEPT, block);
+      return block;
+    } else if (pos.size() == 2 && pos.front() == 0 && pos.back() == block->getNumberOfSites()) {
+      //Everything is removed:
+      logEvent_(ENTROPY_REMOVED, block);
+      recycle(block);
+    } else {
+      //Pieces share the input block, which is recycled when the last one is released:
+      std::shared_ptr<const MafBlock> parent = MafBlockView::share(block, iterator_);
+      logEvent_(ENTROPY_SPLIT, block, {block->getNumberOfSites(), pos.size() / 2 + 1});
+      if (displaysTasks_()) {
         ApplicationTools::message->endLine();
-        ApplicationTools::displayTask("Sliding window for entropy filter", true);
+        ApplicationTools::displayTask("Spliting block", true);
       }
-      while (i + step_ < nc) {
-        if (verbose_)
-          ApplicationTools::displayGauge(i - windowSize_, nc - windowSize_ - 1, '>');
-        //Evaluate current window:
-        unsigned int count = std::accumulate(window_.begin(), window_.end(), 0u);
-        if (count <= maxPos_) { // flipped this logic to make passing windows fail
-          if (pos.size() == 0) {
-            pos.push_back(i - windowSize_);
-            pos.push_back(i);
-          } else {
-            if (i - windowSize_ < pos[pos.size() - 1]) {
-              pos[pos.size() - 1] = i; //Windows are overlapping and we extend previous region
-            } else { //This is a new region
-              pos.push_back(i - windowSize_);
-              pos.push_back(i);
-            }
-          }
+      for (i = 0; i < pos.size(); i+=2) {
+        if (displaysTasks_())
+          displayGauge_(i, pos.size() - 2, '=');
+        logEvent_(ENTROPY_REGION_REMOVED, block, {pos[i], pos[i+1]});
+        if (pos[i] > 0) {
+          if (i == 0)
+            viewBuffer_.push_back(MafBlockView(parent, 0, pos[i]));
+          else
+            viewBuffer_.push_back(MafBlockView(parent, pos[i - 1], pos[i] - pos[i - 1]));
         }
       
-        //Move forward:
-        for (size_t k = 0; k < step_; ++k) {
-          vector<int> col;
-          for (size_t j = 0; j < nr; ++j) {
-            int x = aln[j][i];
-            if (x != gap || !ignoreGaps_)
-              col.push_back(x);
-          }
-          double entropy = VectorTools::shannonDiscrete<int, double>(col) / log(5.);
-          window_.push_back(entropy > maxEnt_ ? 1 : 0);
-          window_.pop_front();
-          ++i;
-        }
+        if (keepTrashedBlocks_)
+          trashBuffer_.push_back(MafBlockView(parent, pos[i], pos[i + 1] - pos[i]).materialize());
       }
-
-      //Evaluate last window:
-      unsigned int count = std::accumulate(window_.begin(), window_.end(), 0u);
-      if (count <= maxPos_) { // flipped this logic to make passing windows fail
-        if (pos.size() == 0) {
-          pos.push_back(i - windowSize_);
-          pos.push_back(i);
-        } else {
-          if (i - windowSize_ <= pos[pos.size() - 1]) {
-            pos[pos.size() - 1] = i; //Windows are overlapping and we extend previous region
-          } else { //This is a new region
-            pos.push_back(i - windowSize_);
-            pos.push_back(i);
-          }
-        }
-      } 
-      if (verbose_)
+      //Add last block:
+      if (pos.back() < block->getNumberOfSites())
+        viewBuffer_.push_back(MafBlockView(parent, pos.back(), block->getNumberOfSites() - pos.back()));
+      if (displaysTasks_())
         ApplicationTools::displayTaskDone();
-    
-      //Now we remove regions with two many gaps, using a sliding window:
-      if (pos.size() == 0) {
-        blockBuffer_.push_back(block);
-        if (logstream_) {
-          (*logstream_ << "ENTROPY CLEANER: block " << block->getDescription() << " is clean and kept as is.").endLine();
-        }
-      } else if (pos.size() == 2 && pos.front() == 0 && pos.back() == block->getNumberOfSites()) {
-        //Everything is removed:
-        if (logstream_) {
-          (*logstream_ << "ENTROPY CLEANER: block " << block->getDescription() << " was entirely removed. Tried to get the next one.").endLine();
-        }
-      } else {
-        if (logstream_) {
-          (*logstream_ << "ALN CLEANER: block " << block->getDescription() << " with size "<< block->getNumberOfSites() << " will be split into " << (pos.size() / 2 + 1) << " blocks.").endLine();
-        }
-        if (verbose_) {
-          ApplicationTools::message->endLine();
-          ApplicationTools::displayTask("Spliting block", true);
-        }
-        for (i = 0; i < pos.size(); i+=2) {
-          if (verbose_)
-            ApplicationTools::displayGauge(i, pos.size() - 2, '=');
-          if (logstream_) {
-            (*logstream_ << "ENTROPY CLEANER: removing region (" << pos[i] << ", " << pos[i+1] << ") from block " << block->getDescription() << ".").endLine();
-          }
-          if (pos[i] > 0) {
-            MafBlock* newBlock = new MafBlock();
-            newBlock->setScore(block->getScore());
-            newBlock->setPass(block->getPass());
-            for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-              MafSequence* subseq;
-              if (i == 0) {
-                subseq = block->getSequence(j).subSequence(0, pos[i]);
-              } else {
-                subseq = block->getSequence(j).subSequence(pos[i - 1], pos[i] - pos[i - 1]);
-              }
-              newBlock->addSequence(*subseq);
-              delete subseq;
-            }
-            blockBuffer_.push_back(newBlock);
-          }
-        
-          if (keepTrashedBlocks_) {
-            MafBlock* outBlock = new MafBlock();
-            outBlock->setScore(block->getScore());
-            outBlock->setPass(block->getPass());
-            for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-              MafSequence* outseq = block->getSequence(j).subSequence(pos[i], pos[i + 1] - pos[i]);
-              outBlock->addSequence(*outseq);
-              delete outseq;
-            } 
-            trashBuffer_.push_back(outBlock);
-          }
-        }
-        //Add last block:
-        if (pos[pos.size() - 1] < block->getNumberOfSites()) {
-          MafBlock* newBlock = new MafBlock();
-          newBlock->setScore(block->getScore());
-          newBlock->setPass(block->getPass());
-          for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-            MafSequence* subseq;
-            subseq = block->getSequence(j).subSequence(pos[pos.size() - 1], block->getNumberOfSites() - pos[pos.size() - 1]);
-            newBlock->addSequence(*subseq);
-            delete subseq;
-          }
-          blockBuffer_.push_back(newBlock);
-        }
-        if (verbose_)
-          ApplicationTools::displayTaskDone();
-
-        delete block;
-      }
-    } while (blockBuffer_.size() == 0);
-  }
-
-  MafBlock* block = blockBuffer_.front();
-  blockBuffer_.pop_front();
-  return block;
+    }
+  } while (viewBuffer_.size() == 0);
+  return 0;
 }
 
@@ -55,9 +55,10 @@ namespace bpp {
  * This iterators takes two parameters: g=maxEnt and n=maxPos. Windows with more than n positions with a entropy higher than maxEnt will be discarded.
  * In addition, consecutives patterns are only counted once.
  * In case a sequence from the list is missing, it can be either ignored or counted as a full sequence of gaps.
+ * Blocks smaller than the window are evaluated as a single window.
  */
 class EntropyFilterMafIterator:
-  public AbstractFilterMafIterator,
+  public AbstractSplitMafIterator,
   public virtual MafTrashIterator
 {
   private:
@@ -66,24 +67,20 @@ class EntropyFilterMafIterator:
     unsigned int step_;
     double maxEnt_;
     unsigned int maxPos_;
-    std::deque<MafBlock*> blockBuffer_;
     std::deque<MafBlock*> trashBuffer_;
-    std::deque<unsigned int> window_;
     bool keepTrashedBlocks_;
     bool missingAsGap_;
     bool ignoreGaps_;
 
   public:
     EntropyFilterMafIterator(MafIterator* iterator, const std::vector<std::string>& species, unsigned int windowSize, unsigned int step, double maxEnt, unsigned int maxPos, bool keepTrashedBlocks, bool missingAsGap, bool ignoreGaps) :
-      AbstractFilterMafIterator(iterator),
+      AbstractSplitMafIterator(iterator),
       species_(species),
       windowSize_(windowSize),
       step_(step),
       maxEnt_(maxEnt),
       maxPos_(maxPos),
-      blockBuffer_(),
       trashBuffer_(),
-      window_(species.size()),
       keepTrashedBlocks_(keepTrashedBlocks),
       missingAsGap_(missingAsGap),
       ignoreGaps_(ignoreGaps)
@@ -97,8 +94,14 @@ class EntropyFilterMafIterator:
       return block;
     }
 
+  protected:
+    void getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const {
+      AbstractSplitMafIterator::getBufferContent_(nbBlocks, nbBytes);
+      addBufferContent_(trashBuffer_, nbBlocks, nbBytes);
+    }
+
   private:
-    MafBlock* analyseCurrentBlock_();
+    MafBlock* splitNextBlock_();
 
 };
 
@@ -39,9 +39,6 @@ knowledge of the CeCILL license and that you accept its terms.
 
 #include "FeatureExtractorMafIterator.h"
 
-//From bpp-seq:
-#include <Bpp/Seq/SequenceWalker.h>
-
 using namespace bpp;
 
 //From the STL:
@@ -50,6 +47,33 @@ using namespace bpp;
 
 using namespace std;
 
+void FeatureExtractorMafIterator::getCandidateRanges_(const string& chr, const Range<size_t>& range, RangeSet<size_t>& ranges)
+{
+  const vector<SeqRange>& chrRanges = index_->getRanges(chr);
+  const vector<size_t>& maxEnds = index_->getMaxEnds(chr);
+  Cursor_& cursor = cursors_[chr];
+  size_t n = chrRanges.size();
+  size_t first;
+  if (sortedInput_ && range.begin() >= cursor.lastStart) {
+    //Merge-join: blocks come in increasing order, so the cursor only moves forward:
+    while (cursor.position < n && maxEnds[cursor.position] < range.begin())
+      cursor.position++;
+    first = cursor.position;
+  } else {
+    if (sortedInput_ && logstream_) {
+      (*logstream_ << "FEATURE EXTRACTOR: block is not sorted according to the reference species, features are searched from scratch.").endLine();
+    }
+    //All features before the first one with maxEnds >= range.begin() end before the range:
+    first = index_->getFirstCandidate(chr, range.begin());
+    cursor.position = first;
+  }
+  cursor.lastStart = range.begin();
+  for (size_t i = first; i < n && chrRanges[i].begin() <= range.end(); ++i) {
+    if (chrRanges[i].end() >= range.begin())
+      ranges.addRange(chrRanges[i]);
+  }
+}
+
 MafBlock* FeatureExtractorMafIterator::analyseCurrentBlock_()
 {
   while (blockBuffer_.size() == 0) {
@@ -66,11 +90,12 @@ MafBlock* FeatureExtractorMafIterator::analyseCurrentBlock_()
     //Get the feature ranges for this block:
     const MafSequence& refSeq = block->getSequenceForSpecies(refSpecies_);
     //first check if there is one (for now we assume that features refer to the chromosome or contig name, with implicit species):
-    std::map<std::string, RangeSet<size_t> >::iterator mr = ranges_.find(refSeq.getChromosome());
-    if (mr == ranges_.end())
+    if (!index_->hasSequence(refSeq.getChromosome()))
       goto START;
         
-    RangeSet<size_t> ranges = mr->second;
+    //Only features close to the block are considered, then filtered exactly:
+    RangeSet<size_t> ranges;
+    getCandidateRanges_(refSeq.getChromosome(), refSeq.getRange(true), ranges);
     if (completeOnly_)
       ranges.filterWithin(refSeq.getRange(true));
     else  
@@ -91,11 +116,10 @@ MafBlock* FeatureExtractorMafIterator::analyseCurrentBlock_()
       ranges = cRanges;
     }
 
-    //We will need to convert to alignment positions, using a sequence walker:
-    SequenceWalker walker(refSeq);
+    //Positions are converted to alignment positions using the gap index of the reference sequence.
 
     //Now creates all blocks for all ranges:
-    if (verbose_) {
+    if (displaysTasks_()) {
       ApplicationTools::message->endLine();
       ApplicationTools::displayTask("Extracting annotations", true);
     }
@@ -108,15 +132,15 @@ MafBlock* FeatureExtractorMafIterator::analyseCurrentBlock_()
         it !=  ranges.getSet().end();
         ++it)
     {
-      if (verbose_) {
-        ApplicationTools::displayGauge(i++, ranges.getSet().size() - 1, '=');
+      if (displaysTasks_()) {
+        displayGauge_(i++, ranges.getSet().size() - 1, '=');
       } 
       //This does not go after i=0, problem with ranges?????
       MafBlock* newBlock = new MafBlock();
       newBlock->setScore(block->getScore());
       newBlock->setPass(block->getPass());
-      size_t a = walker.getAlignmentPosition((**it).begin() - refSeq.start());
-      size_t b = walker.getAlignmentPosition((**it).end() - refSeq.start() - 1);
+      size_t a = refSeq.getAlignmentPosition((**it).begin() - refSeq.start());
+      size_t b = refSeq.getAlignmentPosition((**it).end() - refSeq.start() - 1);
       for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
         unique_ptr<MafSequence> subseq;
         subseq.reset(block->getSequence(j).subSequence(a, b - a + 1));
@@ -128,12 +152,12 @@ MafBlock* FeatureExtractorMafIterator::analyseCurrentBlock_()
           }
         }
         (*logstream_ << subseq->getName()).endLine();
-        newBlock->addSequence(*subseq);
+        newBlock->addSequence(std::move(subseq));
       }
       blockBuffer_.push_back(newBlock);
     }
         
-    if (verbose_)
+    if (displaysTasks_())
       ApplicationTools::displayTaskDone();
 
   }
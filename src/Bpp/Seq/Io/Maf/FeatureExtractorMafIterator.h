@@ -41,11 +41,15 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _FEATUREEXTRACTORMAFITERATOR_H_
 
 #include "MafIterator.h"
+#include "../../Feature/FeatureRangeIndex.h"
 
 //From the STL:
 #include <iostream>
 #include <string>
 #include <deque>
+#include <vector>
+#include <map>
+#include <memory>
 
 namespace bpp {
 
@@ -56,6 +60,13 @@ namespace bpp {
  * Note that this iterator is not the opposite of FeatureFilterMafIterator,
  * as overlapping features will all be extracted. This iterator may therefore results
  * in duplication of original data.
+ *
+ * Features are indexed per chromosome (see FeatureRangeIndex), either at construction time, or once for several
+ * iterators sharing the same index. For each block, only the features overlapping
+ * the reference sequence are retrieved, using a binary search. If the input blocks are known to be sorted
+ * along the reference sequence (see OrderFilterMafIterator), a moving cursor is used instead, so that
+ * features are visited a constant number of times over the whole input. Should a block be found out of order,
+ * the binary search is used for this block and the cursor is reset.
  */
 class FeatureExtractorMafIterator:
   public AbstractFilterMafIterator
@@ -65,7 +76,18 @@ class FeatureExtractorMafIterator:
     bool completeOnly_;
     bool ignoreStrand_;
     std::deque<MafBlock*> blockBuffer_;
-    std::map<std::string, RangeSet<size_t> > ranges_;
+    bool sortedInput_;
+
+    std::unique_ptr<FeatureRangeIndex> ownedIndex_;
+    const FeatureRangeIndex* index_;
+
+    //Position of the merge-join cursor in the ranges of each chromosome, and start of the last block seen:
+    struct Cursor_ {
+      size_t position;
+      size_t lastStart;
+      Cursor_(): position(0), lastStart(0) {}
+    };
+    std::map<std::string, Cursor_> cursors_;
 
   public:
     /**
@@ -76,29 +98,59 @@ class FeatureExtractorMafIterator:
      * @param complete Tell if features should be extracted only if they can be extracted in full
      * @param features The set of features to extract
      * @param ignoreStrand If true, features will be extracted 'as is', without being reversed in case they are on the negative strand.
+     * @param sortedInput Tell if input blocks are sorted according to the reference species, in which case features are traversed with a moving cursor.
+     */
+    FeatureExtractorMafIterator(MafIterator* iterator, const std::string& refSpecies, const SequenceFeatureSet& features, bool complete = false, bool ignoreStrand = false, bool sortedInput = false) :
+      AbstractFilterMafIterator(iterator),
+      refSpecies_(refSpecies),
+      completeOnly_(complete),
+      ignoreStrand_(ignoreStrand),
+      blockBuffer_(),
+      sortedInput_(sortedInput),
+      ownedIndex_(new FeatureRangeIndex(features)),
+      index_(ownedIndex_.get()),
+      cursors_()
+    {}
+
+    /**
+     * @brief Build a new FeatureExtractor iterator from a shared feature index.
+     *
+     * @param iterator The input iterator
+     * @param refSpecies The reference species for feature coordinates
+     * @param index An index of the features to extract, which must outlive this iterator.
+     * @param complete Tell if features should be extracted only if they can be extracted in full
+     * @param ignoreStrand If true, features will be extracted 'as is', without being reversed in case they are on the negative strand.
+     * @param sortedInput Tell if input blocks are sorted according to the reference species, in which case features are traversed with a moving cursor.
      */
-    FeatureExtractorMafIterator(MafIterator* iterator, const std::string& refSpecies, const SequenceFeatureSet& features, bool complete = false, bool ignoreStrand = false) :
+    FeatureExtractorMafIterator(MafIterator* iterator, const std::string& refSpecies, const FeatureRangeIndex& index, bool complete = false, bool ignoreStrand = false, bool sortedInput = false) :
       AbstractFilterMafIterator(iterator),
       refSpecies_(refSpecies),
       completeOnly_(complete),
       ignoreStrand_(ignoreStrand),
       blockBuffer_(),
-      ranges_()
-    {
-      //Build ranges:
-      std::set<std::string> seqIds = features.getSequences();
-      for (std::set<std::string>::iterator it = seqIds.begin();
-          it != seqIds.end();
-          ++it) {
-        {
-          features.fillRangeCollectionForSequence(*it, ranges_[*it]);
-        }
-      }
+      sortedInput_(sortedInput),
+      ownedIndex_(),
+      index_(&index),
+      cursors_()
+    {}
+
+  protected:
+    void getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const {
+      addBufferContent_(blockBuffer_, nbBlocks, nbBytes);
     }
 
   private:
     MafBlock* analyseCurrentBlock_();
 
+    /**
+     * @brief Retrieve all features which overlap or are adjacent to a given range.
+     *
+     * @param chr The chromosome to look at.
+     * @param range The range to look at.
+     * @param ranges [out] A set where the selected features will be added.
+     */
+    void getCandidateRanges_(const std::string& chr, const Range<size_t>& range, RangeSet<size_t>& ranges);
+
 };
 
 } // end of namespace bpp.
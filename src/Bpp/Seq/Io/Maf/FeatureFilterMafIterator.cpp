@@ -47,164 +47,128 @@ using namespace bpp;
 
 using namespace std;
 
-MafBlock* FeatureFilterMafIterator::analyseCurrentBlock_()
+//Events reported by this filter:
+static const MafEventType FEATURE_NO_REFERENCE("FEATURE FILTER", "no_reference", MafEventType::LEVEL_DEBUG,
+    "FEATURE FILTER: block %d does not contain the reference species and was kept as is.");
+static const MafEventType FEATURE_NO_FEATURE("FEATURE FILTER", "no_feature", MafEventType::LEVEL_DEBUG,
+    "FEATURE FILTER: block %d does not contain any feature and was kept as is.");
+static const MafEventType FEATURE_REMOVED("FEATURE FILTER", "removed", MafEventType::LEVEL_INFO,
+    "FEATURE FILTER: block %d was entirely removed. Tried to get the next one.");
+static const MafEventType FEATURE_SPLIT("FEATURE FILTER", "split", MafEventType::LEVEL_INFO,
+    "FEATURE FILTER: block %d with size %0 will be split into %1 blocks.");
+static const MafEventType FEATURE_REGION_REMOVED("FEATURE FILTER", "region_removed", MafEventType::LEVEL_DEBUG,
+    "FEATURE FILTER: removing region (%0, %1) from block %d.");
+
+MafBlock* FeatureFilterMafIterator::splitNextBlock_()
 {
-  if (blockBuffer_.size() == 0) {
-    //Unless there is no more block in the buffer, we need to parse more:
-    do {
-      MafBlock* block = iterator_->nextBlock();
-      if (!block) return 0; //No more block.
-
-      //Check if the block contains the reference species:
-      if (!block->hasSequenceForSpecies(refSpecies_)) {
-        if (logstream_) {
-          (*logstream_ << "FEATURE FILTER: block " << block->getDescription() << " does not contain the reference species and was kept as is.").endLine(); 
-        }
-        return block;
-      }
-
-      //Get the feature ranges for this block:
-      const MafSequence& refSeq = block->getSequenceForSpecies(refSpecies_);
-      //first check if there is one (for now we assume that features refer to the chromosome or contig name, with implicit species):
-      std::map<std::string, MultiRange<size_t> >::iterator mr = ranges_.find(refSeq.getChromosome());
-      if (mr == ranges_.end()) {
-        if (logstream_) {
-          (*logstream_ << "FEATURE FILTER: block " << block->getDescription() << " does not contain any feature and was kept as is.").endLine(); 
-        }
-        return block;
-      }
-      //else
-      MultiRange<size_t> mRange = mr->second;
-      //mRange.restrictTo(Range<size_t>(refSeq.start(), refSeq.stop() + 1)); jdutheil on 17/04/13: do we really need the +1 here?
-      mRange.restrictTo(refSeq.getRange(true));
-      if (mRange.isEmpty()) {
-        if (logstream_) {
-          (*logstream_ << "FEATURE FILTER: block " << block->getDescription() << " does not contain any feature and was kept as is.").endLine(); 
-        }
-        return block;
+  //Unless there is no more block in the buffer, we need to parse more:
+  do {
+    MafBlock* block = iterator_->nextBlock();
+    if (!block) return 0; //No more block.
+
+    //Check if the block contains the reference species:
+    if (!block->hasSequenceForSpecies(refSpecies_)) {
+      logEvent_(FEATURE_NO_REFERENCE, block);
+      return block;
+    }
+
+    //Get the feature ranges for this block:
+    const MafSequence& refSeq = block->getSequenceForSpecies(refSpecies_);
+    //first check if there is one (for now we assume that features refer to the chromosome or contig name, with implicit species):
+    if (!index_->hasSequence(refSeq.getChromosome())) {
+      logEvent_(FEATURE_NO_FEATURE, block);
+      return block;
+    }
+    //else
+    //Only features overlapping the block are retrieved:
+    //(restricting to Range<size_t>(refSeq.start(), refSeq.stop() + 1)); jdutheil on 17/04/13: do we really need the +1 here?)
+    std::vector<size_t> tmp = index_->getBoundsWithin(refSeq.getChromosome(), refSeq.getRange(true));
+    if (tmp.empty()) {
+      logEvent_(FEATURE_NO_FEATURE, block);
+      return block;
+    }
+
+    //If the reference sequence is on the negative strand, then we have to correct the coordinates:
+    std::deque<size_t> refBounds;
+    if (refSeq.getStrand() == '-') {
+      for (size_t i = 0; i < tmp.size(); ++i)
+      {
+        refBounds.push_front(refSeq.getSrcSize() - tmp[i]);
       }
-      std::vector<size_t> tmp = mRange.getBounds();
-
-      //If the reference sequence is on the negative strand, then we have to correct the coordinates:
-      std::deque<size_t> refBounds;
-      if (refSeq.getStrand() == '-') {
-        for (size_t i = 0; i < tmp.size(); ++i)
-        {
-          refBounds.push_front(refSeq.getSrcSize() - tmp[i]);
+    } else {
+      refBounds = deque<size_t>(tmp.begin(), tmp.end());
+    }
+
+    //Now extract corresponding alignments. We use the range to split the original block.
+    //Only thing to watch out is the coordinates, refering to the ref species...
+    //A good idea is then to convert those with respect to the given block:
+
+    int gap = refSeq.getAlphabet()->getGapCharacterCode();
+    long int refPos = static_cast<long int>(refSeq.start()) - 1;
+    //long int refPos = refSeq.getStrand() == '-' ? static_cast<long int>(refSeq.getSrcSize() - refSeq.start()) - 1 : static_cast<long int>(refSeq.start()) - 1;
+    std::vector<size_t> pos;
+    if (displaysTasks_()) {
+      ApplicationTools::message->endLine();
+      ApplicationTools::displayTask("Removing features", true);
+    }
+    for (size_t alnPos = 0; alnPos < refSeq.size() && refBounds.size() > 0; ++alnPos) {
+      if (displaysTasks_())
+        displayGauge_(static_cast<size_t>(refPos + 1), refBounds.back() + 1, '>');
+      if (refSeq[alnPos] != gap) {
+        refPos++;
+        //check if this position is a bound:
+        while (refBounds.front() == static_cast<size_t>(refPos)) {
+          pos.push_back(alnPos);
+          refBounds.pop_front();
         }
-      } else {
-        refBounds = deque<size_t>(tmp.begin(), tmp.end());
       }
-
-      //Now extract corresponding alignments. We use the range to split the original block.
-      //Only thing to watch out is the coordinates, refering to the ref species...
-      //A good idea is then to convert those with respect to the given block:
-
-      int gap = refSeq.getAlphabet()->getGapCharacterCode();
-      long int refPos = static_cast<long int>(refSeq.start()) - 1;
-      //long int refPos = refSeq.getStrand() == '-' ? static_cast<long int>(refSeq.getSrcSize() - refSeq.start()) - 1 : static_cast<long int>(refSeq.start()) - 1;
-      std::vector<size_t> pos;
-      if (verbose_) {
-        ApplicationTools::message->endLine();
-        ApplicationTools::displayTask("Removing features", true);
+    }
+    if (displaysTasks_())
+      ApplicationTools::displayTaskDone();
+
+    //Check if the last bound matches the end of the alignment:
+    if (refBounds.size() > 0 && refBounds.front() == refSeq.stop()) {
+      pos.push_back(refSeq.size());
+      refBounds.pop_front();
+    }
+
+    if (refBounds.size() > 0) {
+      VectorTools::print(vector<size_t>(refBounds.begin(), refBounds.end()));
+      throw Exception("FeatureFilterMafIterator::nextBlock(). An error occurred here, " + TextTools::toString(refBounds.size()) + " coordinates are left, in sequence " + refSeq.getDescription() + "... this is most likely a bug, please report!");
+    }
+
+    //Next step is simply to split the block according to the translated coordinates:
+    if (pos.size() == 2 && pos.front() == 0 && pos.back() == block->getNumberOfSites()) {
+      //Everything is removed:
+      logEvent_(FEATURE_REMOVED, block);
+    } else {
+      //Pieces share the input block, which is recycled when the last one is released:
+      std::shared_ptr<const MafBlock> parent = MafBlockView::share(block, iterator_);
+      logEvent_(FEATURE_SPLIT, block, {block->getNumberOfSites(), pos.size() / 2 + 1});
+      if (displaysTasks_()) {
+        ApplicationTools::displayTask("Spliting block", true);
       }
-      for (size_t alnPos = 0; alnPos < refSeq.size() && refBounds.size() > 0; ++alnPos) {
-        if (verbose_)
-          ApplicationTools::displayGauge(static_cast<size_t>(refPos + 1), refBounds.back() + 1, '>');
-        if (refSeq[alnPos] != gap) {
-          refPos++;
-          //check if this position is a bound:
-          while (refBounds.front() == static_cast<size_t>(refPos)) {
-            pos.push_back(alnPos);
-            refBounds.pop_front();
-          }
+      for (size_t i = 0; i < pos.size(); i+=2) {
+        if (displaysTasks_())
+          displayGauge_(i, pos.size() - 2, '=');
+        logEvent_(FEATURE_REGION_REMOVED, block, {pos[i], pos[i+1]});
+        if (pos[i] > 0) {
+          if (i == 0)
+            viewBuffer_.push_back(MafBlockView(parent, 0, pos[i]));
+          else
+            viewBuffer_.push_back(MafBlockView(parent, pos[i - 1], pos[i] - pos[i - 1]));
         }
+      
+        if (keepTrashedBlocks_)
+          trashBuffer_.push_back(MafBlockView(parent, pos[i], pos[i + 1] - pos[i]).materialize());
       }
-      if (verbose_)
+      //Add last block:
+      if (pos.back() < block->getNumberOfSites())
+        viewBuffer_.push_back(MafBlockView(parent, pos.back(), block->getNumberOfSites() - pos.back()));
+      if (displaysTasks_())
         ApplicationTools::displayTaskDone();
-
-      //Check if the last bound matches the end of the alignment:
-      if (refBounds.size() > 0 && refBounds.front() == refSeq.stop()) {
-        pos.push_back(refSeq.size());
-        refBounds.pop_front();
-      }
-
-      if (refBounds.size() > 0) {
-        VectorTools::print(vector<size_t>(refBounds.begin(), refBounds.end()));
-        throw Exception("FeatureFilterMafIterator::nextBlock(). An error occurred here, " + TextTools::toString(refBounds.size()) + " coordinates are left, in sequence " + refSeq.getDescription() + "... this is most likely a bug, please report!");
-      }
-
-      //Next step is simply to split the block according to the translated coordinates:
-      if (pos.size() == 2 && pos.front() == 0 && pos.back() == block->getNumberOfSites()) {
-        //Everything is removed:
-        if (logstream_) {
-          (*logstream_ << "FEATURE FILTER: block " << block->getDescription() << " was entirely removed. Tried to get the next one.").endLine();
-        }
-      } else {
-        if (logstream_) {
-          (*logstream_ << "FEATURE FILTER: block " << block->getDescription() << " with size "<< block->getNumberOfSites() << " will be split into " << (pos.size() / 2 + 1) << " blocks.").endLine();
-        }
-        if (verbose_) {
-          ApplicationTools::displayTask("Spliting block", true);
-        }
-        for (size_t i = 0; i < pos.size(); i+=2) {
-          if (verbose_)
-            ApplicationTools::displayGauge(i, pos.size() - 2, '=');
-          if (logstream_) {
-            (*logstream_ << "FEATURE FILTER: removing region (" << pos[i] << ", " << pos[i+1] << ") from block " << block->getDescription() << ".").endLine();
-          }
-          if (pos[i] > 0) {
-            MafBlock* newBlock = new MafBlock();
-            newBlock->setScore(block->getScore());
-            newBlock->setPass(block->getPass());
-            for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-              MafSequence* subseq;
-              if (i == 0) {
-                subseq = block->getSequence(j).subSequence(0, pos[i]);
-              } else {
-                subseq = block->getSequence(j).subSequence(pos[i - 1], pos[i] - pos[i - 1]);
-              }
-              newBlock->addSequence(*subseq);
-              delete subseq;
-            }
-            blockBuffer_.push_back(newBlock);
-          }
-        
-          if (keepTrashedBlocks_) {
-            MafBlock* outBlock = new MafBlock();
-            outBlock->setScore(block->getScore());
-            outBlock->setPass(block->getPass());
-            for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-              MafSequence* outseq = block->getSequence(j).subSequence(pos[i], pos[i + 1] - pos[i]);
-              outBlock->addSequence(*outseq);
-              delete outseq;
-            } 
-            trashBuffer_.push_back(outBlock);
-          }
-        }
-        //Add last block:
-        if (pos.back() < block->getNumberOfSites()) {
-          MafBlock* newBlock = new MafBlock();
-          newBlock->setScore(block->getScore());
-          newBlock->setPass(block->getPass());
-          for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-            MafSequence* subseq;
-            subseq = block->getSequence(j).subSequence(pos[pos.size() - 1], block->getNumberOfSites() - pos[pos.size() - 1]);
-            newBlock->addSequence(*subseq);
-            delete subseq;
-          }
-          blockBuffer_.push_back(newBlock);
-        }
-        if (verbose_)
-          ApplicationTools::displayTaskDone();
-
-        delete block;
-      }
-    } while (blockBuffer_.size() == 0);
-  }
-
-  MafBlock* nxtBlock = blockBuffer_.front();
-  blockBuffer_.pop_front();
-  return nxtBlock;
+    }
+  } while (viewBuffer_.size() == 0);
+  return 0;
 }
 
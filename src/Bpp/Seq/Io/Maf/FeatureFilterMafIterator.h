@@ -41,11 +41,14 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _FEATUREFILTERMAFITERATOR_H_
 
 #include "MafIterator.h"
+#include "../../Feature/FeatureRangeIndex.h"
 
 //From the STL:
 #include <iostream>
 #include <string>
 #include <deque>
+#include <vector>
+#include <memory>
 
 namespace bpp {
 
@@ -53,37 +56,46 @@ namespace bpp {
  * @brief Remove from alignment all positions that fall within any feature from a list given as a SequenceFeatureSet object.
  *
  * Removed regions are outputed as a trash iterator.
+ *
+ * Features are merged and indexed per chromosome, as sorted arrays of non-overlapping intervals (see FeatureRangeIndex).
+ * For each block, only the features overlapping the reference sequence are retrieved, using a binary search.
+ * The index is either built at construction time, or shared with other iterators.
  */
 class FeatureFilterMafIterator:
-  public AbstractFilterMafIterator,
+  public AbstractSplitMafIterator,
   public MafTrashIterator
 {
   private:
     std::string refSpecies_;
-    std::deque<MafBlock*> blockBuffer_;
     std::deque<MafBlock*> trashBuffer_;
     bool keepTrashedBlocks_;
-    std::map<std::string, MultiRange<size_t> > ranges_;
+    std::unique_ptr<FeatureRangeIndex> ownedIndex_;
+    const FeatureRangeIndex* index_;
 
   public:
     FeatureFilterMafIterator(MafIterator* iterator, const std::string& refSpecies, const SequenceFeatureSet& features, bool keepTrashedBlocks) :
-      AbstractFilterMafIterator(iterator),
+      AbstractSplitMafIterator(iterator),
       refSpecies_(refSpecies),
-      blockBuffer_(),
       trashBuffer_(),
       keepTrashedBlocks_(keepTrashedBlocks),
-      ranges_()
-    {
-      //Build ranges:
-      std::set<std::string> seqIds = features.getSequences();
-      for (std::set<std::string>::iterator it = seqIds.begin();
-          it != seqIds.end();
-          ++it) {
-        {
-          features.fillRangeCollectionForSequence(*it, ranges_[*it]);
-        }
-      }
-    }
+      ownedIndex_(new FeatureRangeIndex(features)),
+      index_(ownedIndex_.get())
+    {}
+
+    /**
+     * @param iterator The input iterator
+     * @param refSpecies The reference species for feature coordinates
+     * @param index An index of the features to remove, which must outlive this iterator.
+     * @param keepTrashedBlocks Tell if removed regions should be output as a trash iterator.
+     */
+    FeatureFilterMafIterator(MafIterator* iterator, const std::string& refSpecies, const FeatureRangeIndex& index, bool keepTrashedBlocks) :
+      AbstractSplitMafIterator(iterator),
+      refSpecies_(refSpecies),
+      trashBuffer_(),
+      keepTrashedBlocks_(keepTrashedBlocks),
+      ownedIndex_(),
+      index_(&index)
+    {}
 
   public:
     MafBlock* nextRemovedBlock() {
@@ -93,8 +105,14 @@ class FeatureFilterMafIterator:
       return block;
     }
 
+  protected:
+    void getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const {
+      AbstractSplitMafIterator::getBufferContent_(nbBlocks, nbBytes);
+      addBufferContent_(trashBuffer_, nbBlocks, nbBytes);
+    }
+
   private:
-    MafBlock* analyseCurrentBlock_();
+    MafBlock* splitNextBlock_();
 
 };
 
@@ -39,10 +39,6 @@ knowledge of the CeCILL license and that you accept its terms.
 
 #include "FullGapFilterMafIterator.h"
 
-//From bpp-seq
-#include <Bpp/Seq/Container/VectorSiteContainer.h>
-#include <Bpp/Seq/SiteTools.h>
-
 using namespace bpp;
 
 //From the STL:
@@ -54,63 +50,56 @@ using namespace std;
 MafBlock* FullGapFilterMafIterator::analyseCurrentBlock_()
 {
   MafBlock* block = iterator_->nextBlock();
-  if (!block) return 0;
+  if (block)
+    cleanBlock_(*block);
+  return block;
+}
 
-  //We create a copy of the ingroup alignement for better efficiency:
-  VectorSiteContainer vsc(&AlphabetTools::DNA_ALPHABET);
-  for (size_t i = 0; i < species_.size(); ++i) {
-    if (block->hasSequenceForSpecies(species_[i])) {
-      vsc.addSequence(block->getSequenceForSpecies(species_[i]));
-    }
-  }
-  if (vsc.getNumberOfSequences() == 0) return block; //Block ignored as it does not contain any of the focus species.
+void FullGapFilterMafIterator::cleanBlock_(MafBlock& block)
+{
+  //Gap counts for the ingroup are shared with other stages working on the same selection:
+  const ColumnCounts& counts = block.getColumnCounts(species_);
+  size_t nr = counts.getNumberOfRows();
+  if (nr == 0) return; //Block ignored as it does not contain any of the focus species.
 
   //Now check the positions that are only made of gaps:
-  if (verbose_) {
+  if (displaysTasks_()) {
     ApplicationTools::message->endLine();
     ApplicationTools::displayTask("Cleaning block for gap sites", true);
   }
-  size_t n = block->getNumberOfSites();
-  vector <size_t> start;
-  vector <unsigned int> count;
+  size_t n = block.getNumberOfSites();
+  vector< pair<size_t, size_t> > ranges;
   bool test = false;
+  size_t totalRemoved = 0;
   for (size_t i = 0; i < n; ++i) {
-    const Site* site = &vsc.getSite(i);
-    if (SiteTools::isGapOnly(*site)) {
+    if (counts.getNumberOfGaps(i) == nr) {
       if (test) {
-        count[count.size() - 1]++;
+        ranges.back().second++;
       } else {
-        start.push_back(i);
-        count.push_back(1);
+        ranges.push_back(make_pair(i, static_cast<size_t>(1)));
         test = true;
       }
+      totalRemoved++;
     } else {
       test = false;
     }
   }
-  //Now remove blocks:
-  size_t totalRemoved = 0;
-  for(size_t i = start.size(); i > 0; --i) {
-    if (verbose_)
-      ApplicationTools::displayGauge(start.size() - i, start.size() - 1, '=');
-    block->getAlignment().deleteSites(start[i - 1], count[i - 1]);
-    totalRemoved += count[i - 1];
-  }
-  if (verbose_)
+  //Now remove all gap runs at once:
+  block.deleteSites(ranges);
+  if (displaysTasks_())
     ApplicationTools::displayTaskDone();
   
   //Correct coordinates:
   if (totalRemoved > 0) {
-    for (size_t i = 0; i < block->getNumberOfSequences(); ++i) {
-      const MafSequence* seq = &block->getSequence(i);
+    for (size_t i = 0; i < block.getNumberOfSequences(); ++i) {
+      const MafSequence* seq = &block.getSequence(i);
       if (!VectorTools::contains(species_, seq->getSpecies())) {
-        block->removeCoordinatesFromSequence(i);
+        block.removeCoordinatesFromSequence(i);
       }
     }
   }
   if (logstream_) {
     (*logstream_ << "FULL GAP CLEANER: " << totalRemoved << " positions have been removed.").endLine();
   }
-  return block;
 }
 
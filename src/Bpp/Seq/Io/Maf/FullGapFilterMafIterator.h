@@ -69,9 +69,19 @@ class FullGapFilterMafIterator:
       species_(species)
     {}
 
+  public:
+    /**
+     * @brief Clean a block which is not pulled from the input iterator, as a stage of a StaticMafPipeline.
+     *
+     * @return Always true, as blocks are never discarded.
+     */
+    bool processBlock(MafBlock& block) { cleanBlock_(block); return true; }
+
   private:
     MafBlock* analyseCurrentBlock_();
 
+    void cleanBlock_(MafBlock& block);
+
 };
 
 } // end of namespace bpp.
@@ -0,0 +1,178 @@
+//
+// File: GapRunSequence.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "GapRunSequence.h"
+
+#include <Bpp/Seq/Alphabet/AlphabetExceptions.h>
+
+//From the STL:
+#include <algorithm>
+
+using namespace bpp;
+using namespace std;
+
+GapRunSequence::GapRunSequence(const MafSequence& sequence):
+  name_(sequence.getName()),
+  hasCoordinates_(sequence.hasCoordinates()),
+  begin_(hasCoordinates_ ? sequence.start() : 0),
+  strand_(sequence.getStrand()),
+  srcSize_(sequence.getSrcSize()),
+  size_(sequence.size()),
+  runs_(),
+  residues_(),
+  nbResidues_(0)
+{
+  const vector<int>& content = sequence.getContent();
+  residues_.reserve((sequence.getGenomicSize() + 15) / 16);
+  for (size_t i = 0; i < size_; ++i) {
+    int state = content[i];
+    if (state == -1)
+      continue;
+    if (state < -1 || state > 14)
+      throw BadIntException(state, "GapRunSequence (constructor). State can't be encoded.");
+    if (runs_.empty() || runs_.back().begin + runs_.back().length != i)
+      runs_.push_back(Run(i, 0, nbResidues_));
+    runs_.back().length++;
+    if ((nbResidues_ & 15) == 0)
+      residues_.push_back(0);
+    residues_[nbResidues_ >> 4] |= static_cast<uint64_t>(state) << ((nbResidues_ & 15) << 2);
+    nbResidues_++;
+  }
+}
+
+/******************************************************************************/
+
+size_t GapRunSequence::findRun_(size_t alnPos) const
+{
+  vector<Run>::const_iterator it = upper_bound(runs_.begin(), runs_.end(), alnPos,
+      [](size_t pos, const Run& run) { return pos < run.begin; });
+  return it == runs_.begin() ? runs_.size() : static_cast<size_t>(it - runs_.begin()) - 1;
+}
+
+int GapRunSequence::getState(size_t alnPos) const
+{
+  if (alnPos >= size_)
+    throw IndexOutOfBoundsException("GapRunSequence::getState.", alnPos, 0, size_ - 1);
+  size_t r = findRun_(alnPos);
+  if (r == runs_.size() || alnPos >= runs_[r].begin + runs_[r].length)
+    return -1;
+  return getResidue(runs_[r].rank + alnPos - runs_[r].begin);
+}
+
+size_t GapRunSequence::rank(size_t alnPos) const
+{
+  if (alnPos == 0)
+    return 0;
+  size_t r = findRun_(alnPos - 1);
+  if (r == runs_.size())
+    return 0;
+  return runs_[r].rank + min(alnPos - runs_[r].begin, runs_[r].length);
+}
+
+size_t GapRunSequence::getAlignmentPosition(size_t seqPos) const
+{
+  if (seqPos >= nbResidues_)
+    throw Exception("GapRunSequence::getAlignmentPosition, sequence position out of range: " + TextTools::toString(seqPos));
+  //Last run with a rank lower than or equal to the position:
+  vector<Run>::const_iterator it = upper_bound(runs_.begin(), runs_.end(), seqPos,
+      [](size_t pos, const Run& run) { return pos < run.rank; });
+  --it;
+  return it->begin + seqPos - it->rank;
+}
+
+size_t GapRunSequence::getSequencePosition(size_t alnPos) const
+{
+  if (alnPos >= size_)
+    throw Exception("GapRunSequence::getSequencePosition, alignment position out of range: " + TextTools::toString(alnPos));
+  //Residues up to and including the column, minus one:
+  return rank(alnPos + 1) - 1;
+}
+
+size_t GapRunSequence::getGenomicSize(size_t begin, size_t end) const
+{
+  if (begin > end || end > size_)
+    throw Exception("GapRunSequence::getGenomicSize, invalid range: [" + TextTools::toString(begin) + ", " + TextTools::toString(end) + "[.");
+  return rank(end) - rank(begin);
+}
+
+void GapRunSequence::decode(std::vector<int>& content) const
+{
+  content.assign(size_, -1);
+  for (size_t r = 0; r < runs_.size(); ++r) {
+    const Run& run = runs_[r];
+    for (size_t i = 0; i < run.length; ++i)
+      content[run.begin + i] = getResidue(run.rank + i);
+  }
+}
+
+MafSequence* GapRunSequence::unpack() const
+{
+  vector<int> content;
+  decode(content);
+  MafSequence* seq = new MafSequence(name_, std::move(content), begin_, strand_, srcSize_, nbResidues_);
+  if (!hasCoordinates_)
+    seq->removeCoordinates();
+  return seq;
+}
+
+void GapRunSequence::countStates(unsigned int counts[16]) const
+{
+  counts[0] += static_cast<unsigned int>(size_ - nbResidues_);
+  for (size_t w = 0; w < residues_.size(); ++w) {
+    uint64_t word = residues_[w];
+    size_t n = min(static_cast<size_t>(16), nbResidues_ - 16 * w);
+    for (size_t k = 0; k < n; ++k, word >>= 4)
+      counts[(word & 0xF) + 1]++;
+  }
+}
+
+bool GapRunSequence::isSparse(const MafSequence& sequence)
+{
+  //Packed states use half a byte per column, runs use sizeof(Run) bytes each, plus half a byte per residue:
+  const vector<int>& content = sequence.getContent();
+  size_t nbRuns = 0;
+  bool inRun = false;
+  for (size_t i = 0; i < content.size(); ++i) {
+    bool residue = content[i] >= 0;
+    nbRuns += static_cast<size_t>(residue && !inRun);
+    inRun = residue;
+  }
+  return nbRuns * sizeof(Run) + (sequence.getGenomicSize() + 1) / 2 < (content.size() + 1) / 2;
+}
+
@@ -0,0 +1,203 @@
+//
+// File: GapRunSequence.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _GAPRUNSEQUENCE_H_
+#define _GAPRUNSEQUENCE_H_
+
+#include "MafSequence.h"
+
+//From the STL:
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief A compact, read-only representation of a MafSequence, for rows made mostly of gaps.
+ *
+ * The row is stored as the list of its runs of non-gap positions, each run being described by its first
+ * alignment column, its length, and the number of residues before it. Residues of all runs are packed one after
+ * the other with 4 bits per state (the alphabet code, from 0 for A to 14 for N), sixteen residues per 64-bit word.
+ * Memory usage and scan time are therefore proportional to the number of residues and runs, and not to the number of
+ * alignment columns. Gap runs are implicit, and are skipped by counting kernels (see ColumnCounts::compute).
+ *
+ * Accessors and coordinate conversions are performed with a binary search over the runs.
+ * Annotations (masks and quality scores) are not stored, see PackedMafSequence for a representation keeping them.
+ */
+class GapRunSequence
+{
+  public:
+    struct Run
+    {
+      size_t begin;  //First alignment column of the run.
+      size_t length; //Number of residues in the run.
+      size_t rank;   //Number of residues before the run.
+      Run(size_t b = 0, size_t l = 0, size_t r = 0): begin(b), length(l), rank(r) {}
+    };
+
+  private:
+    std::string name_;
+    bool hasCoordinates_;
+    size_t begin_;
+    char strand_;
+    size_t srcSize_;
+    size_t size_;
+    std::vector<Run> runs_;
+    std::vector<uint64_t> residues_;
+    size_t nbResidues_;
+
+  public:
+    /**
+     * @brief Encode an existing sequence.
+     *
+     * @param sequence The sequence to encode.
+     * @throw BadIntException if the sequence contains an invalid state.
+     */
+    GapRunSequence(const MafSequence& sequence);
+
+  public:
+    const std::string& getName() const { return name_; }
+
+    bool hasCoordinates() const { return hasCoordinates_; }
+    size_t start() const { return begin_; }
+    char getStrand() const { return strand_; }
+    size_t getSrcSize() const { return srcSize_; }
+
+    /**
+     * @return The number of alignment columns.
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * @return The number of residues (non-gap positions).
+     */
+    size_t getGenomicSize() const { return nbResidues_; }
+
+    size_t getNumberOfRuns() const { return runs_.size(); }
+
+    /**
+     * @return A run of non-gap positions, the runs being sorted by position.
+     */
+    const Run& getRun(size_t i) const { return runs_[i]; }
+
+    /**
+     * @return The state of the k-th residue of the ungapped sequence.
+     */
+    int getResidue(size_t k) const {
+      return static_cast<int>((residues_[k >> 4] >> ((k & 15) << 2)) & 0xF);
+    }
+
+    /**
+     * @return The packed residues, 16 per word, first residue in the lowest nibble.
+     */
+    const std::vector<uint64_t>& getWords() const { return residues_; }
+
+    /**
+     * @return The alphabet state at a given alignment column (-1 for a gap).
+     * @throw IndexOutOfBoundsException if the column is out of bounds.
+     */
+    int getState(size_t alnPos) const;
+
+    /**
+     * @return The number of residues in the alignment columns [0, alnPos[.
+     * @param alnPos A column in [0, size()].
+     */
+    size_t rank(size_t alnPos) const;
+
+    /**
+     * @return The alignment position of a given character of the ungapped sequence.
+     * @param seqPos The position in the ungapped sequence, starting at 0.
+     * @throw Exception if the sequence has less than seqPos + 1 characters.
+     */
+    size_t getAlignmentPosition(size_t seqPos) const;
+
+    /**
+     * @return The position in the ungapped sequence of a given alignment column, with the same conventions as MafSequence::getSequencePosition.
+     * @param alnPos The alignment position.
+     * @throw Exception if the alignment position is out of bounds.
+     */
+    size_t getSequencePosition(size_t alnPos) const;
+
+    /**
+     * @return The number of characters (non-gap positions) in a given alignment range.
+     * @param begin The first alignment position.
+     * @param end The alignment position after the last one.
+     * @throw Exception if the range is not valid.
+     */
+    size_t getGenomicSize(size_t begin, size_t end) const;
+
+    /**
+     * @brief Decode all states.
+     *
+     * @param content A vector which will be filled with the states codes.
+     */
+    void decode(std::vector<int>& content) const;
+
+    /**
+     * @return A new MafSequence object.
+     */
+    MafSequence* unpack() const;
+
+    /**
+     * @brief Count all states.
+     *
+     * @param counts An array of size 16, where counts will be added, gaps first (as in ColumnCounts).
+     */
+    void countStates(unsigned int counts[16]) const;
+
+    /**
+     * @return The size of the encoded data, in bytes.
+     */
+    size_t getMemorySize() const { return runs_.size() * sizeof(Run) + residues_.size() * sizeof(uint64_t); }
+
+    /**
+     * @return True if a row is encoded in less memory as runs than as packed states with 4 bits per column (see PackedMafSequence).
+     * @param sequence The row to test.
+     */
+    static bool isSparse(const MafSequence& sequence);
+
+  private:
+    //Index of the last run starting at or before a given column, or runs_.size() if there is none:
+    size_t findRun_(size_t alnPos) const;
+};
+
+} // end of namespace bpp.
+
+#endif //_GAPRUNSEQUENCE_H_
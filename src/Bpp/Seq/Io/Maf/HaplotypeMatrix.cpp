@@ -0,0 +1,154 @@
+//
+// File: HaplotypeMatrix.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "HaplotypeMatrix.h"
+#include "BinaryIoTools.h"
+#include "ColumnClassification.h"
+
+using namespace bpp;
+
+//From the STL:
+#include <string>
+
+using namespace std;
+
+static void pad(std::string& buffer)
+{
+  buffer.append((8 - buffer.size() % 8) % 8, '\0');
+}
+
+/******************************************************************************/
+
+size_t HaplotypeMatrix::addBlock(const MafBlock& block, const std::string& reference)
+{
+  if (!block.hasSequenceForSpecies(reference))
+    return 0;
+  vector<const vector<int>*> rows;
+  for (size_t i = 0; i < names_.size(); ++i) {
+    if (!block.hasSequenceForSpecies(names_[i]))
+      return 0;
+    rows.push_back(&block.getSequenceForSpecies(names_[i]).getContent());
+  }
+  const MafSequence& refSeq = block.getSequenceForSpecies(reference);
+  const vector<int>& ref = refSeq.getContent();
+  size_t pos = refSeq.start();
+  size_t nbSites = block.getNumberOfSites();
+  size_t nbVariants = positions_.size();
+
+  //Variants are found 64 sites at a time, and genotypes are read from the site-major copy of the rows:
+  ColumnClassification classes(rows, nbSites);
+  const vector<uint64_t>& biallelic = classes.getBiallelicBitmap();
+  const ColumnTable& table = block.getColumnTable(names_);
+  for (size_t w = 0; w < BitTools::getNumberOfWords(nbSites); ++w) {
+    size_t begin = w * 64;
+    size_t n = min(static_cast<size_t>(64), nbSites - begin);
+    uint64_t variable = biallelic[w];
+    size_t k = 0; //Next site of the word whose position is not counted yet.
+    while (variable) {
+      unsigned int b = BitTools::countTrailingZeros(variable);
+      variable &= variable - 1;
+      for (; k < b; ++k)
+        pos += static_cast<size_t>(ref[begin + k] >= 0);
+      k = b + 1;
+      size_t i = begin + b;
+      if (ref[i] < 0) //Gap in the reference
+        continue;
+      positions_.push_back(pos++);
+      const int8_t* column = table.getColumn(i);
+      int a1 = column[0];
+      int a2 = a1;
+      bits_.resize(bits_.size() + nbWords_, 0);
+      uint64_t* bits = &bits_[bits_.size() - nbWords_];
+      for (size_t j = 0; j < names_.size(); ++j) {
+        if (column[j] != a1) {
+          a2 = column[j];
+          bits[j >> 6] |= static_cast<uint64_t>(1) << (j & 63);
+        }
+      }
+      alleles_.push_back(static_cast<uint8_t>(a1));
+      alleles_.push_back(static_cast<uint8_t>(a2));
+    }
+    for (; k < n; ++k)
+      pos += static_cast<size_t>(ref[begin + k] >= 0);
+  }
+  return positions_.size() - nbVariants;
+}
+
+void HaplotypeMatrix::write(std::ostream& out) const
+{
+  string names;
+  BinaryIoTools::appendUInt(names, static_cast<uint32_t>(chromosome_.size()), 4);
+  names += chromosome_;
+  for (size_t i = 0; i < names_.size(); ++i) {
+    BinaryIoTools::appendUInt(names, static_cast<uint32_t>(names_[i].size()), 4);
+    names += names_[i];
+  }
+  pad(names);
+  uint64_t namesOffset = 64;
+  uint64_t positionsOffset = namesOffset + names.size();
+  uint64_t allelesOffset = positionsOffset + 8 * positions_.size();
+  uint64_t bitsOffset = allelesOffset + (2 * positions_.size() + 7) / 8 * 8;
+
+  string buffer = "BPPHAP01";
+  BinaryIoTools::appendUInt(buffer, names_.size(), 8);
+  BinaryIoTools::appendUInt(buffer, positions_.size(), 8);
+  BinaryIoTools::appendUInt(buffer, nbWords_, 8);
+  BinaryIoTools::appendUInt(buffer, namesOffset, 8);
+  BinaryIoTools::appendUInt(buffer, positionsOffset, 8);
+  BinaryIoTools::appendUInt(buffer, allelesOffset, 8);
+  BinaryIoTools::appendUInt(buffer, bitsOffset, 8);
+  buffer += names;
+  for (size_t i = 0; i < positions_.size(); ++i)
+    BinaryIoTools::appendUInt(buffer, positions_[i], 8);
+  buffer.append(alleles_.begin(), alleles_.end());
+  pad(buffer);
+  out.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+  //Bits are written by pieces, to avoid doubling the memory of large matrices:
+  buffer.clear();
+  for (size_t i = 0; i < bits_.size(); ++i) {
+    BinaryIoTools::appendUInt(buffer, bits_[i], 8);
+    if (buffer.size() >= 65536 || i + 1 == bits_.size()) {
+      out.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+      buffer.clear();
+    }
+  }
+  if (!out)
+    throw IOException("HaplotypeMatrix::write. Cannot write to output stream.");
+}
+
@@ -0,0 +1,147 @@
+//
+// File: HaplotypeMatrix.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _HAPLOTYPEMATRIX_H_
+#define _HAPLOTYPEMATRIX_H_
+
+#include "MafBlock.h"
+#include "BitTools.h"
+
+//From the STL:
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief A bit-packed, variant-major matrix of biallelic sites, for a set of haplotypes along a chromosome.
+ *
+ * Haplotypes are the first sequences of a selection of species. Blocks are added one after the other, and
+ * only complete biallelic sites (see ColumnClassification) at positions where the reference sequence is not a gap are kept.
+ * For each variant, the matrix stores the position in the reference sequence (0-based), the first allele (the state of
+ * the first haplotype), the second allele, and one bit per haplotype, set if the haplotype carries the second allele.
+ * Bits of a variant are stored in getNumberOfWordsPerVariant() consecutive 64-bit words, first haplotype in the lowest bit.
+ *
+ * Matrices can be written in a binary format designed to be memory-mapped. All integers are little endian, and all
+ * sections start at a multiple of 8 bytes:
+ * - A header of 64 bytes: the magic string "BPPHAP01", then, as uint64, the number of haplotypes, the number of variants,
+ *   the number of words per variant, and the offsets of the names, positions, alleles and bits sections.
+ * - Names: the chromosome name, then the haplotype names, each written as its size (uint32) followed by its characters.
+ * - Positions: one uint64 per variant.
+ * - Alleles: two uint8 per variant, the state codes of the first and second alleles (0 to 3 for A, C, G, T).
+ * - Bits: the words of all variants, as uint64.
+ */
+class HaplotypeMatrix
+{
+  private:
+    std::vector<std::string> names_;
+    std::string chromosome_;
+    size_t nbWords_;
+    std::vector<uint64_t> positions_;
+    std::vector<uint8_t> alleles_;
+    std::vector<uint64_t> bits_;
+
+  public:
+    /**
+     * @param names The species names of the haplotypes.
+     * @param chromosome The chromosome of the reference sequence.
+     */
+    HaplotypeMatrix(const std::vector<std::string>& names, const std::string& chromosome = ""):
+      names_(names), chromosome_(chromosome), nbWords_(BitTools::getNumberOfWords(names.size())),
+      positions_(), alleles_(), bits_()
+    {}
+
+  public:
+    const std::vector<std::string>& getNames() const { return names_; }
+
+    const std::string& getChromosome() const { return chromosome_; }
+    void setChromosome(const std::string& chromosome) { chromosome_ = chromosome; }
+
+    size_t getNumberOfHaplotypes() const { return names_.size(); }
+    size_t getNumberOfVariants() const { return positions_.size(); }
+    size_t getNumberOfWordsPerVariant() const { return nbWords_; }
+
+    uint64_t getPosition(size_t variant) const { return positions_[variant]; }
+    int getFirstAllele(size_t variant) const { return alleles_[2 * variant]; }
+    int getSecondAllele(size_t variant) const { return alleles_[2 * variant + 1]; }
+
+    /**
+     * @return A pointer to the getNumberOfWordsPerVariant() words of a given variant.
+     */
+    const uint64_t* getVariant(size_t variant) const { return &bits_[variant * nbWords_]; }
+
+    bool hasSecondAllele(size_t variant, size_t haplotype) const {
+      return (bits_[variant * nbWords_ + (haplotype >> 6)] >> (haplotype & 63)) & 1;
+    }
+
+    /**
+     * @brief Add the variants of a block.
+     *
+     * Blocks where one of the species or the reference species is missing are ignored.
+     *
+     * @param block The block.
+     * @param reference The species used for positions.
+     * @return The number of variants added.
+     * @throw Exception if the reference sequence has no coordinates.
+     */
+    size_t addBlock(const MafBlock& block, const std::string& reference);
+
+    /**
+     * @brief Remove all variants.
+     */
+    void clear() {
+      positions_.clear();
+      alleles_.clear();
+      bits_.clear();
+    }
+
+    /**
+     * @brief Write the matrix in binary form.
+     *
+     * @param out The output stream, open in binary mode.
+     * @throw IOException if the stream cannot be written.
+     */
+    void write(std::ostream& out) const;
+};
+
+} // end of namespace bpp.
+
+#endif //_HAPLOTYPEMATRIX_H_
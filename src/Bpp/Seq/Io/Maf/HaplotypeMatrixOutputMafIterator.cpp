@@ -0,0 +1,88 @@
+//
+// File: HaplotypeMatrixOutputMafIterator.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "HaplotypeMatrixOutputMafIterator.h"
+
+using namespace bpp;
+
+//From the STL:
+#include <string>
+#include <fstream>
+
+using namespace std;
+
+MafBlock* HaplotypeMatrixOutputMafIterator::analyseCurrentBlock_()
+{
+  MafBlock* block = iterator_->nextBlock();
+  if (!block) {
+    if (hasChromosome_)
+      writeMatrix_();
+    hasChromosome_ = false;
+    return 0;
+  }
+  if (block->hasSequenceForSpecies(refSpecies_)) {
+    const string& chr = block->getSequenceForSpecies(refSpecies_).getChromosome();
+    if (!hasChromosome_ || chr != matrix_.getChromosome()) {
+      if (hasChromosome_)
+        writeMatrix_();
+      if (writtenChrs_.find(chr) != writtenChrs_.end())
+        throw Exception("HaplotypeMatrixOutputMafIterator::analyseCurrentBlock_. Blocks are not grouped by chromosome: " + chr + " was already written.");
+      matrix_.setChromosome(chr);
+      hasChromosome_ = true;
+    }
+    matrix_.addBlock(*block, refSpecies_);
+  }
+  return block;
+}
+
+void HaplotypeMatrixOutputMafIterator::writeMatrix_()
+{
+  string file = file_;
+  TextTools::replaceAll(file, "%c", matrix_.getChromosome());
+  ofstream output(file.c_str(), ios::out | ios::binary);
+  if (!output)
+    throw IOException("HaplotypeMatrixOutputMafIterator::writeMatrix_. Cannot open file " + file + ".");
+  matrix_.write(output);
+  if (logstream_) {
+    (*logstream_ << "HAPLOTYPE MATRIX: wrote " << matrix_.getNumberOfVariants() << " variants for chromosome " << matrix_.getChromosome() << " to " << file << ".").endLine();
+  }
+  writtenChrs_.insert(matrix_.getChromosome());
+  matrix_.clear();
+}
+
@@ -0,0 +1,121 @@
+//
+// File: HaplotypeMatrixOutputMafIterator.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _HAPLOTYPEMATRIXOUTPUTMAFITERATOR_H_
+#define _HAPLOTYPEMATRIXOUTPUTMAFITERATOR_H_
+
+#include "MafIterator.h"
+#include "HaplotypeMatrix.h"
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <set>
+
+namespace bpp {
+
+/**
+ * @brief This iterator forwards the iterator given as input after having collected its biallelic sites
+ * into one HaplotypeMatrix per chromosome of the reference species.
+ *
+ * Each matrix is written in binary form (see HaplotypeMatrix::write) when a block on a new chromosome is met,
+ * and when the input iterator has no more block. Blocks must therefore be grouped by chromosome.
+ * Blocks without the reference species or one of the selected species are forwarded without being used.
+ */
+class HaplotypeMatrixOutputMafIterator:
+  public AbstractFilterMafIterator
+{
+  private:
+    std::string file_;
+    std::string refSpecies_;
+    HaplotypeMatrix matrix_;
+    std::set<std::string> writtenChrs_;
+    bool hasChromosome_;
+
+  public:
+    /**
+     * @brief Creates a HaplotypeMatrixOutputMafIterator
+     *
+     * @param iterator The input iterator.
+     * @param species The species to use as haplotypes (the first sequence of each species is used).
+     * @param reference The species to use as a reference for coordinates and chromosomes.
+     * @param file A string describing the path to the output files. The %c code is replaced by the chromosome name.
+     */
+    HaplotypeMatrixOutputMafIterator(
+        MafIterator* iterator,
+        const std::vector<std::string>& species,
+        const std::string& reference,
+        const std::string& file) :
+      AbstractFilterMafIterator(iterator),
+      file_(file),
+      refSpecies_(reference),
+      matrix_(species),
+      writtenChrs_(),
+      hasChromosome_(false)
+    {}
+
+  private:
+    HaplotypeMatrixOutputMafIterator(const HaplotypeMatrixOutputMafIterator& iterator) :
+      AbstractFilterMafIterator(0),
+      file_(iterator.file_),
+      refSpecies_(iterator.refSpecies_),
+      matrix_(iterator.matrix_),
+      writtenChrs_(iterator.writtenChrs_),
+      hasChromosome_(iterator.hasChromosome_)
+    {}
+    
+    HaplotypeMatrixOutputMafIterator& operator=(const HaplotypeMatrixOutputMafIterator& iterator)
+    {
+      file_          = iterator.file_;
+      refSpecies_    = iterator.refSpecies_;
+      matrix_        = iterator.matrix_;
+      writtenChrs_   = iterator.writtenChrs_;
+      hasChromosome_ = iterator.hasChromosome_;
+      return *this;
+    }
+
+  private:
+    MafBlock* analyseCurrentBlock_();
+
+    void writeMatrix_();
+};
+
+} // end of namespace bpp.
+
+#endif //_HAPLOTYPEMATRIXOUTPUTMAFITERATOR_H_
@@ -38,9 +38,17 @@ knowledge of the CeCILL license and that you accept its terms.
 */
 
 #include "IterationListener.h"
+#include "SamplingMafIterator.h"
+
+// From bpp-core:
+#include <Bpp/Numeric/NumConstants.h>
+#include <Bpp/Numeric/Random/RandomTools.h>
 
 // From the STL:
 #include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
 
 using namespace std;
 using namespace bpp;
@@ -57,7 +65,7 @@ void CsvStatisticsOutputIterationListener::iterationStarts()
 
 void CsvStatisticsOutputIterationListener::iterationMoves(const MafBlock& currentBlock)
 {
-  const vector<const BppNumberI*>& values = statsIterator_->getResults();
+  const MafStatisticsResult& values = statsIterator_->getResults();
   if (currentBlock.hasSequenceForSpecies(refSpecies_)) {
     const MafSequence& refSeq = currentBlock.getSequenceForSpecies(refSpecies_);
     if (refSeq.hasCoordinates()) 
@@ -67,11 +75,164 @@ void CsvStatisticsOutputIterationListener::iterationMoves(const MafBlock& curren
   } else {
     *output_ << "NA" << sep_ << "NA" << sep_ << "NA";
   }
-  for (size_t i = 0; i < values.size(); ++i) {
-    *output_ << sep_ << (values[i] ? values[i]->toString() : "NA");
-    //Memory cleaning:
-    if (values[i]) delete values[i];
+  for (size_t i = 0; i < values.getNumberOfSlots(); ++i) {
+    *output_ << sep_ << values.getValueAsString(i);
+  }
+  output_->endLine();
+}
+
+void WindowedStatisticsOutputIterationListener::iterationStarts()
+{
+  const vector<string>& header = statsIterator_->getResultsColumnNames();
+  *output_ << "Chr" << sep_ << "Start" << sep_ << "Stop" << sep_ << "NbBlocks" << sep_ << "Coverage";
+  for (size_t i = 0; i < header.size(); ++i) {
+    *output_ << sep_ << header[i] << ".Sum" << sep_ << header[i] << ".Mean" << sep_ << header[i] << ".Min" << sep_ << header[i] << ".Max";
+  }
+  output_->endLine();
+}
+
+void WindowedStatisticsOutputIterationListener::iterationMoves(const MafBlock& currentBlock)
+{
+  if (!currentBlock.hasSequenceForSpecies(refSpecies_)) return;
+  const MafSequence& refSeq = currentBlock.getSequenceForSpecies(refSpecies_);
+  if (!refSeq.hasCoordinates()) return;
+  Range<size_t> range = refSeq.getRange(true);
+  if (range.length() == 0) return;
+  if (refSeq.getChromosome() != currentChr_) {
+    flushWindows_(numeric_limits<size_t>::max());
+    currentChr_ = refSeq.getChromosome();
+  }
+  size_t first = range.begin() / windowSize_;
+  size_t last = (range.end() - 1) / windowSize_;
+  flushWindows_(first);
+
+  const MafStatisticsResult& values = statsIterator_->getResults();
+  size_t nbValues = values.getNumberOfSlots();
+  double length = static_cast<double>(range.length());
+  for (size_t w = first; w <= last; ++w) {
+    size_t begin = max(range.begin(), w * windowSize_);
+    size_t end = min(range.end(), (w + 1) * windowSize_);
+    double weight = static_cast<double>(end - begin);
+    double fraction = weight / length;
+    map<size_t, Window_>::iterator it = windows_.find(w);
+    if (it == windows_.end()) {
+      Accumulator_ empty = { 0., 0., 0., numeric_limits<double>::infinity(), -numeric_limits<double>::infinity() };
+      it = windows_.insert(make_pair(w, Window_(nbValues, empty))).first;
+    }
+    Window_& window = it->second;
+    window.nbBlocks++;
+    window.coverage += end - begin;
+    for (size_t i = 0; i < nbValues; ++i) {
+      if (!values.hasValue(i)) continue;
+      double x = values.getValue(i);
+      if (std::isnan(x)) continue;
+      Accumulator_& acc = window.accumulators[i];
+      acc.sum += x * fraction;
+      acc.weightedSum += x * weight;
+      acc.weight += weight;
+      if (x < acc.min) acc.min = x;
+      if (x > acc.max) acc.max = x;
+    }
+  }
+}
+
+void WindowedStatisticsOutputIterationListener::iterationStops()
+{
+  flushWindows_(numeric_limits<size_t>::max());
+}
+
+void WindowedStatisticsOutputIterationListener::flushWindows_(size_t window)
+{
+  while (windows_.size() > 0 && windows_.begin()->first < window) {
+    size_t w = windows_.begin()->first;
+    const Window_& win = windows_.begin()->second;
+    *output_ << currentChr_ << sep_ << w * windowSize_ << sep_ << (w + 1) * windowSize_ << sep_ << win.nbBlocks << sep_ << win.coverage;
+    for (size_t i = 0; i < win.accumulators.size(); ++i) {
+      const Accumulator_& acc = win.accumulators[i];
+      if (acc.weight > 0)
+        *output_ << sep_ << acc.sum << sep_ << acc.weightedSum / acc.weight << sep_ << acc.min << sep_ << acc.max;
+      else
+        *output_ << sep_ << "NA" << sep_ << "NA" << sep_ << "NA" << sep_ << "NA";
+    }
+    output_->endLine();
+    windows_.erase(windows_.begin());
+  }
+}
+
+/******************************************************************************/
+
+void SampleSummaryIterationListener::iterationStarts()
+{
+  size_t n = statsIterator_->getResultsColumnNames().size();
+  nbValues_.assign(n, 0);
+  means_.assign(n, 0.);
+  sumSquares_.assign(n, 0.);
+}
+
+void SampleSummaryIterationListener::iterationMoves(const MafBlock& currentBlock)
+{
+  const MafStatisticsResult& values = statsIterator_->getResults();
+  for (size_t i = 0; i < values.getNumberOfSlots() && i < means_.size(); ++i) {
+    double x = values.getValue(i);
+    if (std::isnan(x))
+      continue;
+    nbValues_[i]++;
+    double delta = x - means_[i];
+    means_[i] += delta / static_cast<double>(nbValues_[i]);
+    sumSquares_[i] += delta * (x - means_[i]);
   }
+}
+
+void SampleSummaryIterationListener::iterationStops()
+{
+  if (!output_)
+    return;
+  const vector<string>& header = statsIterator_->getResultsColumnNames();
+  *output_ << "Statistic" << sep_ << "NbValues" << sep_ << "Mean" << sep_ << "StandardError" << sep_ << "Lower" << sep_ << "Upper";
   output_->endLine();
+  for (size_t i = 0; i < means_.size(); ++i) {
+    Estimate estimate = getEstimate(i, level_);
+    *output_ << header[i] << sep_ << estimate.nbValues;
+    if (estimate.nbValues > 0)
+      *output_ << sep_ << estimate.mean;
+    else
+      *output_ << sep_ << "NA";
+    if (estimate.nbValues > 1)
+      *output_ << sep_ << estimate.standardError << sep_ << estimate.lower << sep_ << estimate.upper;
+    else
+      *output_ << sep_ << "NA" << sep_ << "NA" << sep_ << "NA";
+    output_->endLine();
+  }
+}
+
+SampleSummaryIterationListener::Estimate SampleSummaryIterationListener::getEstimate(size_t column, double level, bool total) const
+{
+  if (column >= means_.size())
+    throw IndexOutOfBoundsException("SampleSummaryIterationListener::getEstimate.", column, 0, means_.size());
+  Estimate estimate;
+  size_t n = nbValues_[column];
+  estimate.nbValues = n;
+  estimate.mean = n > 0 ? means_[column] : NumConstants::NaN();
+  estimate.standardError = NumConstants::NaN();
+  if (n > 1) {
+    double se = sqrt(sumSquares_[column] / static_cast<double>(n - 1) / static_cast<double>(n));
+    if (sampler_ && sampler_->hasPopulationSize() && sampler_->getPopulationSize() > 1) {
+      //Finite population correction, as the sample is drawn without replacement:
+      double N = static_cast<double>(sampler_->getPopulationSize());
+      se *= sqrt(max(0., (N - static_cast<double>(n)) / (N - 1.)));
+    }
+    estimate.standardError = se;
+  }
+  if (total) {
+    if (!sampler_ || !sampler_->hasPopulationSize())
+      throw Exception("SampleSummaryIterationListener::getEstimate. Totals require the population size.");
+    double N = static_cast<double>(sampler_->getPopulationSize());
+    estimate.mean *= N;
+    estimate.standardError *= N;
+  }
+  double z = RandomTools::qNorm(0.5 + level / 2.);
+  estimate.lower = estimate.mean - z * estimate.standardError;
+  estimate.upper = estimate.mean + z * estimate.standardError;
+  return estimate;
 }
 
@@ -43,8 +43,15 @@ knowledge of the CeCILL license and that you accept its terms.
 #include "MafIterator.h"
 #include "SequenceStatisticsMafIterator.h"
 
+//From the STL:
+#include <map>
+#include <string>
+#include <vector>
+
 namespace bpp {
 
+class SamplingMafIterator;
+
 /**
  * @brief Listener which enables to catch events when parsing a Maf file.
  */
@@ -57,6 +64,18 @@ class IterationListener
     virtual void iterationStarts() = 0;
     virtual void iterationMoves(const MafBlock& currentBlock) = 0;
     virtual void iterationStops() = 0;
+
+    /**
+     * @brief Called when several blocks were retrieved at once, with MafIterator::nextBlocks().
+     *
+     * The default implementation calls iterationMoves() on each block.
+     * @param blocks The blocks, in iteration order.
+     * @param nbBlocks The number of blocks.
+     */
+    virtual void iterationMovesBatch(const MafBlock* const* blocks, size_t nbBlocks) {
+      for (size_t i = 0; i < nbBlocks; ++i)
+        iterationMoves(*blocks[i]);
+    }
 };
 
 /**
@@ -124,6 +143,180 @@ class CsvStatisticsOutputIterationListener:
   
 };
 
+/**
+ * @brief Iteration listener that works with a SequenceStatisticsMafIterator,
+ * aggregating results in fixed windows along a reference species.
+ *
+ * Windows of a fixed size are defined along each chromosome of the reference species (on the positive strand).
+ * For each window and each statistic, the following values are computed over all blocks overlapping the window:
+ * - Sum: the sum of values, where the value of a block spanning several windows is split according to the proportion
+ *   of its reference positions in each window (this is appropriate for counts),
+ * - Mean: the mean of values, weighted by the number of reference positions of each block in the window,
+ * - Min and Max: the extreme values.
+ * Missing values, and NaN values, are ignored. The number of blocks and reference positions covered are also written.
+ *
+ * Windows are written in CSV format as soon as a block starts after them, so that only a few windows are stored in memory.
+ * The input is therefore expected to be sorted according to the reference species, otherwise windows may be written several times.
+ * Blocks without the reference species, or without coordinates, are ignored.
+ */
+class WindowedStatisticsOutputIterationListener:
+  public AbstractStatisticsOutputIterationListener
+{
+  private:
+    struct Accumulator_ {
+      double sum;
+      double weightedSum;
+      double weight;
+      double min;
+      double max;
+    };
+
+    struct Window_ {
+      size_t nbBlocks;
+      size_t coverage;
+      std::vector<Accumulator_> accumulators;
+      Window_(size_t nbValues, const Accumulator_& empty):
+        nbBlocks(0), coverage(0), accumulators(nbValues, empty) {}
+    };
+
+  private:
+    OutputStream* output_;
+    std::string sep_;
+    std::string refSpecies_;
+    size_t windowSize_;
+    std::string currentChr_;
+    std::map<size_t, Window_> windows_;
+
+  public:
+    /**
+     * @param iterator The statistics iterator.
+     * @param refSpecies The reference species.
+     * @param windowSize The size of windows, in reference positions.
+     * @param output The output stream.
+     * @param sep The column separator.
+     */
+    WindowedStatisticsOutputIterationListener(SequenceStatisticsMafIterator* iterator, const std::string& refSpecies, size_t windowSize, OutputStream* output, const std::string& sep = "\t"):
+      AbstractStatisticsOutputIterationListener(iterator), output_(output), sep_(sep), refSpecies_(refSpecies), windowSize_(windowSize), currentChr_(), windows_()
+    {
+      if (windowSize == 0)
+        throw Exception("WindowedStatisticsOutputIterationListener (constructor). Window size must be positive.");
+    }
+    
+    WindowedStatisticsOutputIterationListener(const WindowedStatisticsOutputIterationListener& listener):
+      AbstractStatisticsOutputIterationListener(listener), output_(listener.output_), sep_(listener.sep_), refSpecies_(listener.refSpecies_),
+      windowSize_(listener.windowSize_), currentChr_(listener.currentChr_), windows_(listener.windows_) {}
+    
+    WindowedStatisticsOutputIterationListener& operator=(const WindowedStatisticsOutputIterationListener& listener)
+    {
+      AbstractStatisticsOutputIterationListener::operator=(listener);
+      output_      = listener.output_;
+      sep_         = listener.sep_;
+      refSpecies_  = listener.refSpecies_;
+      windowSize_  = listener.windowSize_;
+      currentChr_  = listener.currentChr_;
+      windows_     = listener.windows_;
+      return *this;
+    }
+
+    virtual ~WindowedStatisticsOutputIterationListener() {}
+
+  public:
+    virtual void iterationStarts();
+    virtual void iterationMoves(const MafBlock& currentBlock);
+    virtual void iterationStops();
+
+  private:
+    /**
+     * @brief Write and remove all windows before a given one.
+     *
+     * @param window The index of the first window to keep.
+     */
+    void flushWindows_(size_t window);
+  
+};
+
+/**
+ * @brief Iteration listener that works with a SequenceStatisticsMafIterator,
+ * summarizing the values of each statistic over a random sample of blocks or sites (see SamplingMafIterator).
+ *
+ * For each statistic, the mean of the values over the sample is computed, with its standard error and a confidence interval
+ * based on the normal approximation. When the sampling iterator is given, a finite population correction is applied
+ * to the standard error, and totals over the whole population can be estimated as well.
+ * Missing values are ignored. If an output stream is given, a table of estimates is written when iterations stop.
+ */
+class SampleSummaryIterationListener:
+  public AbstractStatisticsOutputIterationListener
+{
+  public:
+    struct Estimate {
+      size_t nbValues;
+      double mean;
+      double standardError;
+      double lower;
+      double upper;
+    };
+
+  private:
+    const SamplingMafIterator* sampler_;
+    OutputStream* output_;
+    std::string sep_;
+    double level_;
+    //Running means and sums of squared deviations, updated with Welford's algorithm:
+    std::vector<size_t> nbValues_;
+    std::vector<double> means_;
+    std::vector<double> sumSquares_;
+
+  public:
+    /**
+     * @param iterator The statistics iterator.
+     * @param sampler The sampling iterator, used to get the population size (may be NULL).
+     * @param output Where to write the estimates of all statistics (may be NULL).
+     * @param level The level of the confidence intervals written to the output.
+     * @param sep The column separator.
+     */
+    SampleSummaryIterationListener(SequenceStatisticsMafIterator* iterator, const SamplingMafIterator* sampler = 0,
+        OutputStream* output = 0, double level = 0.95, const std::string& sep = "\t"):
+      AbstractStatisticsOutputIterationListener(iterator), sampler_(sampler), output_(output), sep_(sep), level_(level),
+      nbValues_(), means_(), sumSquares_() {}
+
+    SampleSummaryIterationListener(const SampleSummaryIterationListener& listener):
+      AbstractStatisticsOutputIterationListener(listener), sampler_(listener.sampler_), output_(listener.output_),
+      sep_(listener.sep_), level_(listener.level_),
+      nbValues_(listener.nbValues_), means_(listener.means_), sumSquares_(listener.sumSquares_) {}
+
+    SampleSummaryIterationListener& operator=(const SampleSummaryIterationListener& listener)
+    {
+      AbstractStatisticsOutputIterationListener::operator=(listener);
+      sampler_    = listener.sampler_;
+      output_     = listener.output_;
+      sep_        = listener.sep_;
+      level_      = listener.level_;
+      nbValues_   = listener.nbValues_;
+      means_      = listener.means_;
+      sumSquares_ = listener.sumSquares_;
+      return *this;
+    }
+
+    virtual ~SampleSummaryIterationListener() {}
+
+  public:
+    virtual void iterationStarts();
+    virtual void iterationMoves(const MafBlock& currentBlock);
+    virtual void iterationStops();
+
+    /**
+     * @brief Get the estimate of the mean, or of the total, of a statistic over the population.
+     *
+     * @param column The index of the statistic, see SequenceStatisticsMafIterator::getResultsColumnNames().
+     * @param level The level of the confidence interval, for instance 0.95.
+     * @param total If true, the total of the statistic over the population is estimated, as the mean times the population size.
+     * @return The estimate. The standard error and the interval are NaN if less than two values are available.
+     * @throw IndexOutOfBoundsException if the column is not valid.
+     * @throw Exception if a total is requested and the population size is not known.
+     */
+    Estimate getEstimate(size_t column, double level = 0.95, bool total = false) const;
+};
+
 } //end of namespace bpp.
 
 #endif //_ITERATIONLISTENER_H_
@@ -0,0 +1,295 @@
+//
+// File: LiftoverIndex.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+
+#include "LiftoverIndex.h"
+#include "BinaryIoTools.h"
+#include "MafIterator.h"
+
+#include <Bpp/Text/TextTools.h>
+
+using namespace bpp;
+
+//From the STL:
+#include <fstream>
+#include <algorithm>
+#include <memory>
+#include <cstring>
+
+using namespace std;
+
+//Binary I/O, little endian:
+
+static const char READ_CONTEXT[] = "LiftoverIndex::read()";
+
+/******************************************************************************/
+
+vector<string> LiftoverIndex::getReferenceChromosomes() const
+{
+  vector<string> chrs;
+  for (map<string, vector<Segment> >::const_iterator it = segments_.begin(); it != segments_.end(); ++it)
+    chrs.push_back(it->first);
+  return chrs;
+}
+
+size_t LiftoverIndex::getNumberOfSegments() const
+{
+  size_t n = 0;
+  for (map<string, vector<Segment> >::const_iterator it = segments_.begin(); it != segments_.end(); ++it)
+    n += it->second.size();
+  return n;
+}
+
+uint32_t LiftoverIndex::getTargetChromosomeIndex_(const std::string& chr)
+{
+  map<string, uint32_t>::iterator it = targetChrIndex_.find(chr);
+  if (it != targetChrIndex_.end())
+    return it->second;
+  uint32_t index = static_cast<uint32_t>(targetChrs_.size());
+  targetChrs_.push_back(chr);
+  targetChrIndex_[chr] = index;
+  return index;
+}
+
+void LiftoverIndex::addSegment_(const std::string& chr, const Segment& segment)
+{
+  segments_[chr].push_back(segment);
+  sorted_ = false;
+}
+
+/******************************************************************************/
+
+void LiftoverIndex::addBlock(const MafBlock& block)
+{
+  if (!block.hasSequenceForSpecies(refSpecies_) || !block.hasSequenceForSpecies(targetSpecies_))
+    return;
+  const MafSequence& refSeq = block.getSequenceForSpecies(refSpecies_);
+  const MafSequence& targetSeq = block.getSequenceForSpecies(targetSpecies_);
+  if (!refSeq.hasCoordinates() || !targetSeq.hasCoordinates())
+    return;
+  uint32_t targetChr = getTargetChromosomeIndex_(targetSeq.getChromosome());
+  bool refNegative = refSeq.getStrand() == '-';
+  bool targetNegative = targetSeq.getStrand() == '-';
+
+  //Positions on the positive strand of a sequence, given the number of residues before:
+  uint64_t refStart = refSeq.start(), refSize = refSeq.getSrcSize();
+  uint64_t targetStart = targetSeq.start(), targetSize = targetSeq.getSrcSize();
+
+  const vector<int>& ref = refSeq.getContent();
+  const vector<int>& target = targetSeq.getContent();
+  uint64_t rp = 0, tp = 0; //Number of residues before the current column.
+  uint64_t firstRp = 0, firstTp = 0, length = 0; //Current run of aligned residues.
+  for (size_t i = 0; i <= ref.size(); ++i) {
+    bool aligned = i < ref.size() && ref[i] >= 0 && target[i] >= 0;
+    if (aligned && length > 0 && rp == firstRp + length && tp == firstTp + length) {
+      length++;
+    } else {
+      if (length > 0) {
+        //Store the segment, oriented according to the positive strand of the reference:
+        Segment segment;
+        segment.length = static_cast<uint32_t>(length);
+        segment.targetChr = targetChr;
+        segment.reversed = (refNegative != targetNegative);
+        uint64_t r = refNegative ? firstRp + length - 1 : firstRp;
+        uint64_t t = refNegative ? firstTp + length - 1 : firstTp;
+        segment.refStart = refNegative ? refSize - 1 - (refStart + r) : refStart + r;
+        segment.targetStart = targetNegative ? targetSize - 1 - (targetStart + t) : targetStart + t;
+        addSegment_(refSeq.getChromosome(), segment);
+        length = 0;
+      }
+      if (aligned) {
+        firstRp = rp;
+        firstTp = tp;
+        length = 1;
+      }
+    }
+    if (i < ref.size()) {
+      if (ref[i] >= 0) rp++;
+      if (target[i] >= 0) tp++;
+    }
+  }
+}
+
+/******************************************************************************/
+
+void LiftoverIndex::sort_()
+{
+  maxEnds_.clear();
+  for (map<string, vector<Segment> >::iterator it = segments_.begin(); it != segments_.end(); ++it) {
+    vector<Segment>& segments = it->second;
+    std::sort(segments.begin(), segments.end());
+    vector<uint64_t>& maxEnds = maxEnds_[it->first];
+    maxEnds.resize(segments.size());
+    uint64_t m = 0;
+    for (size_t i = 0; i < segments.size(); ++i) {
+      m = max(m, segments[i].refStart + segments[i].length);
+      maxEnds[i] = m;
+    }
+  }
+  sorted_ = true;
+}
+
+bool LiftoverIndex::contains_(const Segment& segment, uint64_t position, Position& result)
+{
+  if (position < segment.refStart || position >= segment.refStart + segment.length)
+    return false;
+  uint64_t k = position - segment.refStart;
+  result.mapped = true;
+  result.chr = segment.targetChr;
+  result.position = segment.reversed ? segment.targetStart - k : segment.targetStart + k;
+  result.strand = segment.reversed ? '-' : '+';
+  return true;
+}
+
+LiftoverIndex::Position LiftoverIndex::lift(const std::string& chr, uint64_t position)
+{
+  vector<uint64_t> positions(1, position);
+  vector<Position> results;
+  lift(chr, positions, results);
+  return results[0];
+}
+
+void LiftoverIndex::lift(const std::string& chr, const std::vector<uint64_t>& positions, std::vector<Position>& results)
+{
+  if (!sorted_) sort_();
+  results.assign(positions.size(), Position());
+  map<string, vector<Segment> >::const_iterator it = segments_.find(chr);
+  if (it == segments_.end())
+    return;
+  const vector<Segment>& segments = it->second;
+  const vector<uint64_t>& maxEnds = maxEnds_[chr];
+  size_t n = segments.size();
+  size_t next = 0; //Index of the first segment starting after the previous position.
+  for (size_t i = 0; i < positions.size(); ++i) {
+    uint64_t pos = positions[i];
+    if (i > 0 && pos >= positions[i - 1]) {
+      //Sorted input: the cursor only moves forward.
+      while (next < n && segments[next].refStart <= pos)
+        next++;
+    } else {
+      Segment key;
+      key.refStart = pos;
+      next = static_cast<size_t>(upper_bound(segments.begin(), segments.end(), key) - segments.begin());
+    }
+    //The matching segment is most likely the last one starting before the position, but earlier ones may overlap:
+    for (size_t j = next; j > 0 && maxEnds[j - 1] > pos; --j) {
+      if (contains_(segments[j - 1], pos, results[i]))
+        break;
+    }
+  }
+}
+
+/******************************************************************************/
+
+void LiftoverIndex::write(const std::string& path)
+{
+  if (!sorted_) sort_();
+  ofstream out(path.c_str(), ios::out | ios::binary);
+  if (!out)
+    throw IOException("LiftoverIndex::write(). Cannot open file " + path + " for writing.");
+  out.write("BPPLIFT1", 8);
+  BinaryIoTools::writeString(out, refSpecies_);
+  BinaryIoTools::writeString(out, targetSpecies_);
+  BinaryIoTools::writeUInt(out, targetChrs_.size(), 4);
+  for (size_t i = 0; i < targetChrs_.size(); ++i)
+    BinaryIoTools::writeString(out, targetChrs_[i]);
+  BinaryIoTools::writeUInt(out, segments_.size(), 4);
+  for (map<string, vector<Segment> >::const_iterator it = segments_.begin(); it != segments_.end(); ++it) {
+    BinaryIoTools::writeString(out, it->first);
+    BinaryIoTools::writeUInt(out, it->second.size(), 8);
+    for (size_t i = 0; i < it->second.size(); ++i) {
+      const Segment& segment = it->second[i];
+      BinaryIoTools::writeUInt(out, segment.refStart, 8);
+      BinaryIoTools::writeUInt(out, segment.targetStart, 8);
+      BinaryIoTools::writeUInt(out, segment.length, 4);
+      BinaryIoTools::writeUInt(out, segment.targetChr, 4);
+      BinaryIoTools::writeUInt(out, segment.reversed ? 1 : 0, 1);
+    }
+  }
+  if (!out)
+    throw IOException("LiftoverIndex::write(). Error while writing file " + path + ".");
+}
+
+LiftoverIndex* LiftoverIndex::read(const std::string& path)
+{
+  ifstream in(path.c_str(), ios::in | ios::binary);
+  if (!in)
+    throw IOException("LiftoverIndex::read(). Cannot open file " + path + ".");
+  char magic[8];
+  in.read(magic, 8);
+  if (!in || memcmp(magic, "BPPLIFT1", 8) != 0)
+    throw IOException("LiftoverIndex::read(). File " + path + " is not a valid liftover index.");
+  string refSpecies = BinaryIoTools::readString(in, READ_CONTEXT);
+  string targetSpecies = BinaryIoTools::readString(in, READ_CONTEXT);
+  unique_ptr<LiftoverIndex> index(new LiftoverIndex(refSpecies, targetSpecies));
+  size_t nbTargetChrs = static_cast<size_t>(BinaryIoTools::readUInt(in, 4, READ_CONTEXT));
+  for (size_t i = 0; i < nbTargetChrs; ++i)
+    index->getTargetChromosomeIndex_(BinaryIoTools::readString(in, READ_CONTEXT));
+  size_t nbChrs = static_cast<size_t>(BinaryIoTools::readUInt(in, 4, READ_CONTEXT));
+  for (size_t c = 0; c < nbChrs; ++c) {
+    string chr = BinaryIoTools::readString(in, READ_CONTEXT);
+    size_t nbSegments = static_cast<size_t>(BinaryIoTools::readUInt(in, 8, READ_CONTEXT));
+    vector<Segment>& segments = index->segments_[chr];
+    segments.resize(nbSegments);
+    for (size_t i = 0; i < nbSegments; ++i) {
+      Segment& segment = segments[i];
+      segment.refStart = BinaryIoTools::readUInt(in, 8, READ_CONTEXT);
+      segment.targetStart = BinaryIoTools::readUInt(in, 8, READ_CONTEXT);
+      segment.length = static_cast<uint32_t>(BinaryIoTools::readUInt(in, 4, READ_CONTEXT));
+      segment.targetChr = static_cast<uint32_t>(BinaryIoTools::readUInt(in, 4, READ_CONTEXT));
+      segment.reversed = BinaryIoTools::readUInt(in, 1, READ_CONTEXT) != 0;
+      if (segment.targetChr >= nbTargetChrs)
+        throw IOException("LiftoverIndex::read(). Invalid chromosome index in file " + path + ".");
+    }
+  }
+  index->sorted_ = false;
+  return index.release();
+}
+
+LiftoverIndex* LiftoverIndex::build(MafIterator& iterator, const std::string& refSpecies, const std::string& targetSpecies)
+{
+  unique_ptr<LiftoverIndex> index(new LiftoverIndex(refSpecies, targetSpecies));
+  while (MafBlock* block = iterator.nextBlock()) {
+    index->addBlock(*block);
+    iterator.recycle(block);
+  }
+  return index.release();
+}
+
+/******************************************************************************/
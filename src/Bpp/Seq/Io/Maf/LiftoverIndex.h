@@ -0,0 +1,188 @@
+//
+// File: LiftoverIndex.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+
+#ifndef _LIFTOVERINDEX_H_
+#define _LIFTOVERINDEX_H_
+
+#include <Bpp/Exceptions.h>
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+namespace bpp {
+
+class MafBlock;
+class MafIterator;
+
+/**
+ * @brief A persistent index for translating coordinates from a reference species to a target species.
+ *
+ * This is similar in principle to the chain files used by the UCSC "liftOver" utility. The index
+ * is built in one pass over the alignment, and stores, for each chromosome of the reference, the ungapped
+ * segments aligned to the target species, sorted by reference position. Coordinates are then translated
+ * by binary search, without going back to the alignment.
+ *
+ * All coordinates are 0-based, and expressed on the positive strand of each sequence. A segment aligned to
+ * the opposite strand of the target is flagged as reversed, in which case target positions decrease as
+ * reference positions increase.
+ *
+ * The index can be saved to a binary file and loaded again later.
+ *
+ * @see CoordinateTranslatorMafIterator
+ */
+class LiftoverIndex
+{
+  public:
+    struct Segment
+    {
+      uint64_t refStart;
+      uint64_t targetStart; //Target position corresponding to refStart.
+      uint32_t length;
+      uint32_t targetChr; //Index in the list of target chromosomes.
+      bool reversed;
+      Segment(): refStart(0), targetStart(0), length(0), targetChr(0), reversed(false) {}
+      bool operator<(const Segment& segment) const { return refStart < segment.refStart; }
+    };
+
+    /**
+     * @brief The result of a translation.
+     */
+    struct Position
+    {
+      bool mapped;
+      uint32_t chr; //Index in the list of target chromosomes.
+      uint64_t position;
+      char strand; //'-' if the segment is reversed.
+      Position(): mapped(false), chr(0), position(0), strand('+') {}
+    };
+
+  private:
+    std::string refSpecies_;
+    std::string targetSpecies_;
+    std::vector<std::string> targetChrs_;
+    std::map<std::string, uint32_t> targetChrIndex_;
+    std::map<std::string, std::vector<Segment> > segments_;
+    std::map<std::string, std::vector<uint64_t> > maxEnds_; //Running maximum of segment ends, for overlapping segments.
+    bool sorted_;
+
+  public:
+    LiftoverIndex(const std::string& refSpecies, const std::string& targetSpecies):
+      refSpecies_(refSpecies), targetSpecies_(targetSpecies), targetChrs_(), targetChrIndex_(),
+      segments_(), maxEnds_(), sorted_(true) {}
+
+  public:
+    const std::string& getReferenceSpecies() const { return refSpecies_; }
+
+    const std::string& getTargetSpecies() const { return targetSpecies_; }
+
+    const std::vector<std::string>& getTargetChromosomes() const { return targetChrs_; }
+
+    std::vector<std::string> getReferenceChromosomes() const;
+
+    /**
+     * @return The total number of segments.
+     */
+    size_t getNumberOfSegments() const;
+
+    /**
+     * @brief Add the aligned segments of a block.
+     *
+     * Blocks where the reference or the target species is missing, or has no coordinates, are ignored.
+     * In case a species is duplicated, the first sequence is used.
+     */
+    void addBlock(const MafBlock& block);
+
+    /**
+     * @brief Translate one position.
+     *
+     * @param chr The chromosome of the reference species.
+     * @param position The position on the reference chromosome.
+     * @return The corresponding target position. The position is not mapped if the reference position is
+     * not aligned to a residue of the target species.
+     */
+    Position lift(const std::string& chr, uint64_t position);
+
+    /**
+     * @brief Translate a series of positions on the same chromosome.
+     *
+     * Sorted positions are translated in a single merge pass, others by binary search.
+     *
+     * @param chr The chromosome of the reference species.
+     * @param positions The positions on the reference chromosome.
+     * @param results [out] The corresponding target positions.
+     */
+    void lift(const std::string& chr, const std::vector<uint64_t>& positions, std::vector<Position>& results);
+
+    /**
+     * @brief Write the index to a binary file.
+     */
+    void write(const std::string& path);
+
+    /**
+     * @brief Read an index from a file.
+     *
+     * @throw IOException If the file cannot be read or is not a valid index.
+     */
+    static LiftoverIndex* read(const std::string& path);
+
+    /**
+     * @brief Build an index from all blocks of an iterator.
+     *
+     * Blocks are recycled after indexing.
+     * @param iterator The iterator to read blocks from.
+     * @param refSpecies The reference species.
+     * @param targetSpecies The target species.
+     * @return A new index object.
+     */
+    static LiftoverIndex* build(MafIterator& iterator, const std::string& refSpecies, const std::string& targetSpecies);
+
+  private:
+    uint32_t getTargetChromosomeIndex_(const std::string& chr);
+    void addSegment_(const std::string& chr, const Segment& segment);
+    void sort_();
+    static bool contains_(const Segment& segment, uint64_t position, Position& result);
+};
+
+} // end of namespace bpp.
+
+#endif //_LIFTOVERINDEX_H_
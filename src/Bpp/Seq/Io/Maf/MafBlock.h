@@ -41,16 +41,46 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _MAFBLOCK_H_
 
 #include "MafSequence.h"
+#include "MafNameDictionary.h"
+#include "ColumnCounts.h"
+#include "ColumnTable.h"
+#include "MafPropertyKey.h"
 #include <Bpp/Seq/Container/AlignedSequenceContainer.h>
 
 #include <Bpp/Clonable.h>
 
+//From the STL:
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <mutex>
+
 namespace bpp {
 
 /**
  * @brief A synteny block data structure, the basic unit of a MAF alignement file.
  *
  * This class basically contains a AlignedSequenceContainer made of MafSequence objects.
+ *
+ * The block maintains an index of its rows by species ID (see MafNameDictionary), so that
+ * species lookups are performed in constant time. The index is updated when sequences are added
+ * or deleted via the block's methods. It is recomputed on the next lookup after the container was
+ * accessed for modification via the non-const getAlignment() method.
+ *
+ * Column counts for a given selection of species (see getColumnCounts) are cached as block properties,
+ * so that successive filters and statistics working on the same selection share them.
+ * Cached counts are discarded whenever sequences are added or removed, or when the alignment is accessed
+ * for modification. Site-major copies of the same selections (see getColumnTable) are cached in the same way.
+ *
+ * Properties can also be accessed with typed keys (see MafPropertyKey), which are resolved to slots once,
+ * so that their access takes constant time. Properties declared as caches are discarded with column counts, and
+ * are not kept by copies unless requested.
+ *
+ * Copies of a block are copy-on-write: they share their sequences and properties with the original block,
+ * so that copying costs a few pointer copies. A private copy of the sequences is only made when one of the blocks
+ * is modified. As shared sequences build their lazy annotations and indexes on first access, a copy sent to another
+ * thread should own its sequences (see detach()), or the block should be prepared for sharing (see prepareForSharing()).
+ * Cached properties and column counts are guarded by a lock, so that they can be requested from several threads.
  */
 class MafBlock:
   public virtual Clonable
@@ -58,45 +88,76 @@ class MafBlock:
   private:
     double score_;
     unsigned int pass_;
-    AlignedSequenceContainer alignment_;
-    std::map<std::string, Clonable*> properties_;
+    std::shared_ptr<AlignedSequenceContainer> alignment_;
+    mutable std::map< std::string, std::shared_ptr<Clonable> > properties_;
+    struct Slot_
+    {
+      std::shared_ptr<void> value;
+      bool cache;
+
+      Slot_(): value(), cache(false) {}
+    };
+    mutable std::vector<Slot_> slots_;
+    mutable bool indexValid_;
+    mutable std::vector<const MafSequence*> rows_;
+    mutable std::unordered_map< size_t, std::vector<size_t> > speciesRows_;
+    mutable std::mutex cacheMutex_; //Guards properties_ and slots_ in property accessors.
 
   public:
     MafBlock() :
       score_(log(0)),
       pass_(0),
-      alignment_(&AlphabetTools::DNA_ALPHABET),
-      properties_()
+      alignment_(new AlignedSequenceContainer(&AlphabetTools::DNA_ALPHABET)),
+      properties_(),
+      slots_(),
+      indexValid_(true),
+      rows_(),
+      speciesRows_(),
+      cacheMutex_()
     {}
 
     MafBlock(const MafBlock& block):
       score_(block.score_),
       pass_(block.pass_),
       alignment_(block.alignment_),
-      properties_()
+      properties_(block.properties_),
+      slots_(block.slots_),
+      indexValid_(block.indexValid_),
+      rows_(block.rows_),
+      speciesRows_(block.speciesRows_),
+      cacheMutex_()
     {
-      std::map<std::string, Clonable*>::const_iterator it;
-      for (it = block.properties_.begin(); it != block.properties_.end(); ++it) {
-        properties_[it->first] = it->second->clone();
-      }
+      deleteCacheSlots_();
     }
 
     MafBlock& operator=(const MafBlock& block)
     {
-      score_     = block.score_;
-      pass_      = block.pass_;
-      alignment_ = block.alignment_;
-      deleteProperties_();
-      std::map<std::string, Clonable*>::const_iterator it;
-      for (it = block.properties_.begin(); it != block.properties_.end(); ++it) {
-        properties_[it->first] = it->second->clone();
-      }
+      score_       = block.score_;
+      pass_        = block.pass_;
+      alignment_   = block.alignment_;
+      properties_  = block.properties_;
+      slots_       = block.slots_;
+      deleteCacheSlots_();
+      indexValid_  = block.indexValid_;
+      rows_        = block.rows_;
+      speciesRows_ = block.speciesRows_;
       return *this;
     }
 
     MafBlock* clone() const { return new MafBlock(*this); }
 
-    virtual ~MafBlock() { deleteProperties_(); }
+    /**
+     * @param keepCaches If true, cache properties accessed with typed keys are shared with the copy.
+     * @return A copy of this block.
+     */
+    MafBlock* clone(bool keepCaches) const {
+      MafBlock* block = new MafBlock(*this);
+      if (keepCaches)
+        block->slots_ = slots_;
+      return block;
+    }
+
+    virtual ~MafBlock() {}
 
   public:
     void setScore(double score) { score_ = score; }
@@ -105,14 +166,79 @@ class MafBlock:
     double getScore() const { return score_; }
     unsigned int getPass() const { return pass_; }
 
-    AlignedSequenceContainer& getAlignment() { return alignment_; }
-    const AlignedSequenceContainer& getAlignment() const { return alignment_; }
+    /**
+     * @return The underlying alignment, for modification. The species index will be recomputed on next use,
+     * and cached column counts are discarded.
+     */
+    AlignedSequenceContainer& getAlignment() {
+      detach();
+      indexValid_ = false;
+      deleteCaches_();
+      return *alignment_;
+    }
+    const AlignedSequenceContainer& getAlignment() const { return *alignment_; }
+
+    /**
+     * @brief Make a private copy of the sequences, if they are shared with other copies of this block.
+     */
+    void detach() {
+      if (alignment_.use_count() > 1) {
+        alignment_.reset(new AlignedSequenceContainer(*alignment_));
+        indexValid_ = false;
+      }
+    }
+
+    /**
+     * @return True if the sequences of this block are shared with another copy.
+     */
+    bool isShared() const { return alignment_.use_count() > 1; }
 
-    size_t getNumberOfSequences() const { return alignment_.getNumberOfSequences(); }
+    /**
+     * @brief Build the species index and the lazy data of all sequences.
+     *
+     * After this call, and as long as the block is not modified, its const methods can be called from several threads.
+     */
+    void prepareForSharing() const {
+      if (!indexValid_)
+        updateIndex_();
+      for (size_t i = 0; i < rows_.size(); ++i)
+        rows_[i]->prepareForSharing();
+    }
+
+    size_t getNumberOfSequences() const { return alignment_->getNumberOfSequences(); }
     
-    size_t getNumberOfSites() const { return alignment_.getNumberOfSites(); }
+    size_t getNumberOfSites() const { return alignment_->getNumberOfSites(); }
 
-    void addSequence(const MafSequence& sequence) { alignment_.addSequence(sequence, false); }
+    /**
+     * @return An estimate of the number of bytes used by the block and its sequences.
+     */
+    size_t getMemorySize() const {
+      size_t size = sizeof(MafBlock);
+      for (size_t i = 0; i < getNumberOfSequences(); ++i)
+        size += getSequence(i).getMemorySize();
+      return size;
+    }
+
+    void addSequence(const MafSequence& sequence) {
+      detach();
+      alignment_->addSequence(sequence, false);
+      indexLastSequence_();
+      deleteCaches_();
+    }
+
+    /**
+     * @brief Add a sequence to the block, without copying its content.
+     *
+     * The sequence content is moved to the block, and the sequence object itself is destroyed.
+     */
+    void addSequence(std::unique_ptr<MafSequence> sequence) { moveSequence_(*sequence); }
+
+    /**
+     * @brief Add a sequence to the block, without copying its content.
+     *
+     * The sequence content is moved to the block, and the input sequence is left empty.
+     */
+    void addSequence(MafSequence&& sequence) { moveSequence_(sequence); }
 
     bool hasSequence(const std::string& name) const {
       return getAlignment().hasSequence(name);
@@ -123,35 +249,152 @@ class MafBlock:
     }
 
     const MafSequence& getSequence(size_t i) const {
+      if (indexValid_ && i < rows_.size())
+        return *rows_[i];
       return dynamic_cast<const MafSequence&>(getAlignment().getSequence(i));
     }
 
-    bool hasSequenceForSpecies(const std::string& species) const {
-      for (size_t i = 0; i < getNumberOfSequences(); ++i) {
-        const MafSequence& seq = getSequence(i);
-        if (seq.getSpecies() == species)
-          return true;
+    /**
+     * @brief Remove a sequence from the block.
+     *
+     * @param i The index of the sequence to remove.
+     */
+    void deleteSequence(size_t i) {
+      detach();
+      alignment_->deleteSequence(i);
+      indexValid_ = false;
+      deleteCaches_();
+    }
+
+    /**
+     * @brief Remove several sequences from the block, in a single pass.
+     *
+     * Kept sequences are moved, in their original order, to a new container, so that no row is shifted more than once.
+     * If the sequences are shared with another copy of the block, only the kept sequences are copied.
+     *
+     * @param keep For each sequence, true if it should be kept.
+     * @return The number of sequences removed.
+     * @throw Exception if the mask does not have one element per sequence.
+     */
+    size_t keepSequences(const std::vector<bool>& keep) {
+      size_t nbSequences = getNumberOfSequences();
+      if (keep.size() != nbSequences)
+        throw Exception("MafBlock::keepSequences. The mask has " + TextTools::toString(keep.size()) + " elements, but the block has " + TextTools::toString(nbSequences) + " sequences.");
+      size_t nbKept = static_cast<size_t>(std::count(keep.begin(), keep.end(), true));
+      if (nbKept == nbSequences) return 0;
+      bool shared = isShared();
+      std::shared_ptr<AlignedSequenceContainer> compacted(new AlignedSequenceContainer(&AlphabetTools::DNA_ALPHABET));
+      for (size_t i = 0; i < nbSequences; ++i) {
+        if (!keep[i]) continue;
+        MafSequence& sequence = const_cast<MafSequence&>(dynamic_cast<const MafSequence&>(alignment_->getSequence(i)));
+        //Sequences shared with other blocks are copied, the other ones are moved:
+        sequence.moveOnClone_ = !shared;
+        try {
+          compacted->addSequence(sequence, false);
+        } catch (...) {
+          sequence.moveOnClone_ = false;
+          throw;
+        }
+        sequence.moveOnClone_ = false;
+      }
+      alignment_ = compacted;
+      indexValid_ = false;
+      deleteCaches_();
+      return nbSequences - nbKept;
+    }
+
+    /**
+     * @brief Remove several ranges of sites from all sequences, in a single pass over each row.
+     *
+     * This is equivalent to calling getAlignment().deleteSites() for each range, starting from the last one,
+     * but every position is moved at most once. Coordinates of the sequences are not modified.
+     *
+     * @param ranges The ranges to remove, as (first site, number of sites) pairs, sorted and non-overlapping.
+     * @throw Exception if the ranges are not sorted or overlap.
+     * @throw IndexOutOfBoundsException if a range ends after the last site.
+     */
+    void deleteSites(const std::vector< std::pair<size_t, size_t> >& ranges) {
+      if (ranges.empty()) return;
+      if (ranges.back().first + ranges.back().second > getNumberOfSites())
+        throw IndexOutOfBoundsException("MafBlock::deleteSites.", ranges.back().first + ranges.back().second, 0, getNumberOfSites());
+      detach();
+      //Rows are compacted in place, then moved to a new container with the new number of sites:
+      std::shared_ptr<AlignedSequenceContainer> compacted(new AlignedSequenceContainer(&AlphabetTools::DNA_ALPHABET));
+      for (size_t i = 0; i < alignment_->getNumberOfSequences(); ++i) {
+        MafSequence& sequence = const_cast<MafSequence&>(dynamic_cast<const MafSequence&>(alignment_->getSequence(i)));
+        sequence.deleteSites(ranges);
+        sequence.moveOnClone_ = true;
+        try {
+          compacted->addSequence(sequence, false);
+        } catch (...) {
+          sequence.moveOnClone_ = false;
+          throw;
+        }
+        sequence.moveOnClone_ = false;
       }
-      return false;
+      alignment_ = compacted;
+      indexValid_ = false;
+      deleteCaches_();
+    }
+
+    bool hasSequenceForSpecies(const std::string& species) const {
+      return hasSequenceForSpecies(MafNameDictionary::species().find(species));
+    }
+
+    /**
+     * @param speciesId The species ID, as given by MafNameDictionary::species().
+     * @return True if the block contains a sequence for the given species.
+     */
+    bool hasSequenceForSpecies(size_t speciesId) const {
+      return getSpeciesRows_(speciesId) != 0;
+    }
+
+    /**
+     * @return The number of distinct species in the block.
+     */
+    size_t getNumberOfSpecies() const {
+      if (!indexValid_)
+        updateIndex_();
+      return speciesRows_.size();
+    }
+
+    /**
+     * @param speciesId The species ID, as given by MafNameDictionary::species().
+     * @return The number of sequences for the given species.
+     */
+    size_t getNumberOfSequencesForSpecies(size_t speciesId) const {
+      const std::vector<size_t>* rows = getSpeciesRows_(speciesId);
+      return rows ? rows->size() : 0;
     }
 
     //Return the first sequence with the species name.
     const MafSequence& getSequenceForSpecies(const std::string& species) const {
-      for (size_t i = 0; i < getNumberOfSequences(); ++i) {
-        const MafSequence& seq = getSequence(i);
-        if (seq.getSpecies() == species)
-          return seq;
-      }
-      throw SequenceNotFoundException("MafBlock::getSequenceForSpecies. No sequence with the given species name in this block.", species);
+      const std::vector<size_t>* rows = getSpeciesRows_(MafNameDictionary::species().find(species));
+      if (!rows)
+        throw SequenceNotFoundException("MafBlock::getSequenceForSpecies. No sequence with the given species name in this block.", species);
+      return *rows_[rows->front()];
+    }
+
+    //Return the first sequence with the species ID.
+    const MafSequence& getSequenceForSpecies(size_t speciesId) const {
+      const std::vector<size_t>* rows = getSpeciesRows_(speciesId);
+      if (!rows)
+        throw SequenceNotFoundException("MafBlock::getSequenceForSpecies. No sequence with the given species name in this block.", MafNameDictionary::species().getName(speciesId));
+      return *rows_[rows->front()];
     }
 
     //Return all sequences with the species name.
     std::vector<const MafSequence*> getSequencesForSpecies(const std::string& species) const {
+      return getSequencesForSpecies(MafNameDictionary::species().find(species));
+    }
+
+    //Return all sequences with the species ID.
+    std::vector<const MafSequence*> getSequencesForSpecies(size_t speciesId) const {
       std::vector<const MafSequence*> selection;
-      for (size_t i = 0; i < getNumberOfSequences(); ++i) {
-        const MafSequence* seq = &getSequence(i);
-        if (seq->getSpecies() == species)
-          selection.push_back(seq);
+      const std::vector<size_t>* rows = getSpeciesRows_(speciesId);
+      if (rows) {
+        for (size_t i = 0; i < rows->size(); ++i)
+          selection.push_back(rows_[(*rows)[i]]);
       }
       return selection;
     }
@@ -167,10 +410,70 @@ class MafBlock:
       return lst;
     }
 
+    /**
+     * @brief Get the per-column state counts for a selection of species.
+     *
+     * Counts are computed on first request and stored as a block property, so that
+     * further requests for the same selection are answered without recounting.
+     * The returned reference is valid until the block is modified.
+     *
+     * @param species The selection of species.
+     * @param allSequences If true, all sequences of each species are counted. Otherwise, only the first one is.
+     * @param missingAsGap If true, species missing from the block are counted as a sequence made of gaps only.
+     * @return The column counts for the selection.
+     */
+    const ColumnCounts& getColumnCounts(const std::vector<std::string>& species, bool allSequences = false, bool missingAsGap = false) const
+    {
+      std::string key = getSelectionKey_("ColumnCounts(", species, allSequences, missingAsGap);
+      std::lock_guard<std::mutex> lock(cacheMutex_);
+      std::map< std::string, std::shared_ptr<Clonable> >::const_iterator it = properties_.find(key);
+      if (it != properties_.end())
+        return dynamic_cast<const ColumnCounts&>(*it->second);
+
+      size_t nbSites = getNumberOfSites();
+      std::vector<const std::vector<int>*> selection;
+      std::vector<int> gapSeq;
+      getSelection_(species, allSequences, missingAsGap, selection, gapSeq);
+      ColumnCounts* counts = new ColumnCounts(selection, nbSites);
+      properties_[key].reset(counts);
+      return *counts;
+    }
+
+    /**
+     * @brief Get a site-major copy of the states of a selection of species.
+     *
+     * The table is built on first request and cached as a block property, like column counts.
+     * Rows are ordered as in the selection, with all sequences of a species next to each other
+     * when allSequences is true. The returned reference is valid until the block is modified.
+     *
+     * @param species The selection of species.
+     * @param allSequences If true, all sequences of each species are included. Otherwise, only the first one is.
+     * @param missingAsGap If true, species missing from the block are included as a sequence made of gaps only.
+     * Otherwise they are skipped, and the table has fewer rows than the selection.
+     * @return The column table for the selection.
+     */
+    const ColumnTable& getColumnTable(const std::vector<std::string>& species, bool allSequences = false, bool missingAsGap = false) const
+    {
+      std::string key = getSelectionKey_("ColumnTable(", species, allSequences, missingAsGap);
+      std::lock_guard<std::mutex> lock(cacheMutex_);
+      std::map< std::string, std::shared_ptr<Clonable> >::const_iterator it = properties_.find(key);
+      if (it != properties_.end())
+        return dynamic_cast<const ColumnTable&>(*it->second);
+
+      size_t nbSites = getNumberOfSites();
+      std::vector<const std::vector<int>*> selection;
+      std::vector<int> gapSeq;
+      getSelection_(species, allSequences, missingAsGap, selection, gapSeq);
+      ColumnTable* table = new ColumnTable(selection, nbSites);
+      properties_[key].reset(table);
+      return *table;
+    }
+
     void removeCoordinatesFromSequence(size_t i) {
       //This is a bit of a trick, but avoid useless recopies.
-      //It is safe here because the AlignedSequenceContainer is fully encapsulated.
+      //It is safe here because the AlignedSequenceContainer is fully encapsulated, and not shared after detach().
       //It would not work if a VectorSiteContainer was used.
+      detach();
       const_cast<MafSequence&>(getSequence(i)).removeCoordinates();
     }
 
@@ -180,13 +483,43 @@ class MafBlock:
       return desc;
     }
 
+    /**
+     * @brief Remove all sequences and properties, and reset score and pass.
+     *
+     * @param buffers If not NULL, the state vectors of all sequences are moved to this vector instead of being freed, so that their memory can be reused.
+     */
+    void clear(std::vector< std::vector<int> >* buffers = 0)
+    {
+      if (alignment_.use_count() > 1) {
+        //Shared sequences are left to the other copies:
+        alignment_.reset(new AlignedSequenceContainer(alignment_->getAlphabet()));
+      } else {
+        if (buffers) {
+          for (size_t i = 0; i < getNumberOfSequences(); ++i) {
+            //This is safe because the container is fully encapsulated, and cleared right after.
+            MafSequence& seq = const_cast<MafSequence&>(getSequence(i));
+            buffers->push_back(std::vector<int>());
+            buffers->back().swap(seq.content_);
+          }
+        }
+        alignment_->clear();
+      }
+      score_ = log(0);
+      pass_ = 0;
+      deleteProperties_();
+      rows_.clear();
+      speciesRows_.clear();
+      indexValid_ = true;
+    }
+
     /**
      * @return True or False, if data are associated to the given property.
      * @param property The name of the property to look for.
      */
     bool hasProperty(const std::string& property) const
     {
-      std::map<std::string, Clonable*>::const_iterator it = properties_.find(property);
+      std::lock_guard<std::mutex> lock(cacheMutex_);
+      std::map< std::string, std::shared_ptr<Clonable> >::const_iterator it = properties_.find(property);
       return it != properties_.end();
     }
 
@@ -199,7 +532,8 @@ class MafBlock:
      */
     const Clonable& getProperty(const std::string& property) const
     {
-      std::map<std::string, Clonable*>::const_iterator it = properties_.find(property);
+      std::lock_guard<std::mutex> lock(cacheMutex_);
+      std::map< std::string, std::shared_ptr<Clonable> >::const_iterator it = properties_.find(property);
       if (it == properties_.end())
         throw Exception("MafBlock::getProperty. No data for property: " + property + " in block.");
       return *it->second;
@@ -213,10 +547,10 @@ class MafBlock:
      */
     void deleteProperty(const std::string& property)
     {
-      std::map<std::string, Clonable*>::iterator it = properties_.find(property);
+      std::lock_guard<std::mutex> lock(cacheMutex_);
+      std::map< std::string, std::shared_ptr<Clonable> >::iterator it = properties_.find(property);
       if (it == properties_.end())
         throw Exception("MafBlock::deleteProperty. No data for property: " + property + " in block.");
-      delete it->second;
       properties_.erase(it);
     }
 
@@ -232,19 +566,195 @@ class MafBlock:
     {
       if (!data)
         throw Exception("MafBlock::setProperty. Pointer to data is NULL.");
-      if (hasProperty(property))
-        deleteProperty(property);
-      properties_[property] = data;
+      std::shared_ptr<Clonable> value(data);
+      std::lock_guard<std::mutex> lock(cacheMutex_);
+      properties_[property] = value;
     }
 
+    /**
+     * @name Typed properties.
+     *
+     * @{
+     */
+
+    template<class T>
+    bool hasProperty(const MafPropertyKey<T>& key) const
+    {
+      size_t slot = key.getSlot();
+      std::lock_guard<std::mutex> lock(cacheMutex_);
+      return slot < slots_.size() && slots_[slot].value;
+    }
+
+    /**
+     * @brief Get the data associated to a typed property, computing it if needed.
+     *
+     * @param key The property key.
+     * @return The data associated to the given property.
+     * @throw Exception if no data is associated to the given property, and the key has no compute function.
+     */
+    template<class T>
+    const T& getProperty(const MafPropertyKey<T>& key) const
+    {
+      size_t slot = key.getSlot();
+      {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        if (slot < slots_.size() && slots_[slot].value)
+          return *static_cast<const T*>(slots_[slot].value.get());
+      }
+      if (!key.canCompute())
+        throw Exception("MafBlock::getProperty. No data for property: " + key.getName() + " in block.");
+      //Computed without the lock, as the computation may access other properties:
+      std::shared_ptr<T> data(key.compute(*this));
+      if (!data)
+        throw Exception("MafBlock::getProperty. Property " + key.getName() + " could not be computed.");
+      std::lock_guard<std::mutex> lock(cacheMutex_);
+      //Another thread may have computed the same property in the meantime, in which case its data is kept:
+      if (slot < slots_.size() && slots_[slot].value)
+        return *static_cast<const T*>(slots_[slot].value.get());
+      setSlot_(slot, data, key.isCache());
+      return *data;
+    }
+
+    /**
+     * @brief Set the data associated to a typed property.
+     *
+     * Existing data will be deleted and replaced by the new one.
+     * @param key The property key.
+     * @param data The data to associate to this property, which is owned by the block.
+     * @throw Exception if the pointer toward the input data is NULL.
+     */
+    template<class T>
+    void setProperty(const MafPropertyKey<T>& key, T* data)
+    {
+      if (!data)
+        throw Exception("MafBlock::setProperty. Pointer to data is NULL.");
+      std::shared_ptr<T> value(data);
+      size_t slot = key.getSlot();
+      std::lock_guard<std::mutex> lock(cacheMutex_);
+      setSlot_(slot, value, key.isCache());
+    }
+
+    template<class T>
+    void deleteProperty(const MafPropertyKey<T>& key)
+    {
+      size_t slot = key.getSlot();
+      std::lock_guard<std::mutex> lock(cacheMutex_);
+      if (slot >= slots_.size() || !slots_[slot].value)
+        throw Exception("MafBlock::deleteProperty. No data for property: " + key.getName() + " in block.");
+      slots_[slot].value.reset();
+    }
+
+    /** @} */
+
   private:
-    void deleteProperties_()
+    //Must be called with the mutex locked:
+    void setSlot_(size_t slot, std::shared_ptr<void> value, bool cache) const
     {
-      std::map<std::string, Clonable*>::iterator it;
-      for (it = properties_.begin(); it != properties_.end(); ++it) {
-        delete it->second;
+      if (slot >= slots_.size())
+        slots_.resize(slot + 1);
+      slots_[slot].value = value;
+      slots_[slot].cache = cache;
+    }
+
+    void deleteCacheSlots_()
+    {
+      for (size_t i = 0; i < slots_.size(); ++i)
+        if (slots_[i].cache)
+          slots_[i].value.reset();
+    }
+
+    void indexLastSequence_()
+    {
+      if (!indexValid_)
+        return;
+      size_t i = alignment_->getNumberOfSequences() - 1;
+      const MafSequence* seq = &dynamic_cast<const MafSequence&>(alignment_->getSequence(i));
+      rows_.push_back(seq);
+      speciesRows_[seq->getSpeciesId()].push_back(i);
+    }
+
+    void updateIndex_() const
+    {
+      rows_.clear();
+      speciesRows_.clear();
+      for (size_t i = 0; i < alignment_->getNumberOfSequences(); ++i) {
+        const MafSequence* seq = &dynamic_cast<const MafSequence&>(alignment_->getSequence(i));
+        rows_.push_back(seq);
+        speciesRows_[seq->getSpeciesId()].push_back(i);
       }
+      indexValid_ = true;
+    }
+
+    //Return the rows for a given species, or 0 if there is none:
+    const std::vector<size_t>* getSpeciesRows_(size_t speciesId) const
+    {
+      if (!indexValid_)
+        updateIndex_();
+      std::unordered_map< size_t, std::vector<size_t> >::const_iterator it = speciesRows_.find(speciesId);
+      return it == speciesRows_.end() ? 0 : &it->second;
+    }
+
+    void moveSequence_(MafSequence& sequence)
+    {
+      //The container stores a clone of the sequence, which we make steal the content:
+      detach();
+      sequence.moveOnClone_ = true;
+      try {
+        alignment_->addSequence(sequence, false);
+      } catch (...) {
+        sequence.moveOnClone_ = false;
+        throw;
+      }
+      sequence.moveOnClone_ = false;
+      indexLastSequence_();
+      deleteCaches_();
+    }
+
+    static std::string getSelectionKey_(const std::string& prefix, const std::vector<std::string>& species, bool allSequences, bool missingAsGap)
+    {
+      std::string key = prefix + std::string(allSequences ? "all" : "first") + (missingAsGap ? ",gaps):" : "):");
+      for (size_t i = 0; i < species.size(); ++i)
+        key += (i > 0 ? "\t" : "") + species[i];
+      return key;
+    }
+
+    //Collect the contents of the selected rows. gapSeq holds the content used for missing species, and must live as long as the selection:
+    void getSelection_(const std::vector<std::string>& species, bool allSequences, bool missingAsGap,
+        std::vector<const std::vector<int>*>& selection, std::vector<int>& gapSeq) const
+    {
+      size_t nbSites = getNumberOfSites();
+      for (size_t i = 0; i < species.size(); ++i) {
+        const std::vector<size_t>* rows = getSpeciesRows_(MafNameDictionary::species().find(species[i]));
+        if (rows) {
+          size_t n = allSequences ? rows->size() : 1;
+          for (size_t j = 0; j < n; ++j)
+            selection.push_back(&rows_[(*rows)[j]]->getContent());
+        } else if (missingAsGap) {
+          if (gapSeq.size() != nbSites)
+            gapSeq.assign(nbSites, AlphabetTools::DNA_ALPHABET.getGapCharacterCode());
+          selection.push_back(&gapSeq);
+        }
+      }
+    }
+
+    //Remove all cached column counts and tables, which have a key starting with "ColumnCounts(" or "ColumnTable(", and cache slots:
+    void deleteCaches_()
+    {
+      deleteCacheSlots_();
+      const char* prefixes[] = { "ColumnCounts(", "ColumnTable(" };
+      for (size_t i = 0; i < 2; ++i) {
+        const std::string prefix = prefixes[i];
+        std::map< std::string, std::shared_ptr<Clonable> >::iterator it = properties_.lower_bound(prefix);
+        while (it != properties_.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+          properties_.erase(it++);
+        }
+      }
+    }
+
+    void deleteProperties_()
+    {
       properties_.clear();
+      slots_.clear();
     }
 };
 
@@ -0,0 +1,161 @@
+//
+// File: MafBlockAppender.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "MafBlockAppender.h"
+#include "MafIterator.h"
+
+using namespace bpp;
+
+//From the STL:
+#include <algorithm>
+
+using namespace std;
+
+void MafBlockAppender::reset(MafBlock* block)
+{
+  if (block_ || !rows_.empty())
+    throw Exception("MafBlockAppender::reset. The previous block was not released.");
+  block_ = block;
+}
+
+bool MafBlockAppender::hasSequenceForSpecies(const string& species) const
+{
+  if (block_) return block_->hasSequenceForSpecies(species);
+  return speciesRows_.find(species) != speciesRows_.end();
+}
+
+const MafSequence& MafBlockAppender::getSequenceForSpecies(const string& species) const
+{
+  if (block_) return block_->getSequenceForSpecies(species);
+  map<string, size_t>::const_iterator it = speciesRows_.find(species);
+  if (it == speciesRows_.end())
+    throw SequenceNotFoundException("MafBlockAppender::getSequenceForSpecies. No sequence with the given species name in this block.", species);
+  return *rows_[it->second];
+}
+
+/******************************************************************************/
+
+void MafBlockAppender::startAppend_()
+{
+  if (!block_)
+    throw Exception("MafBlockAppender::startAppend_. No block was started.");
+  for (size_t i = 0; i < block_->getNumberOfSequences(); ++i) {
+    const MafSequence& seq = block_->getSequence(i);
+    if (speciesRows_.insert(make_pair(seq.getSpecies(), rows_.size())).second)
+      rows_.push_back(unique_ptr<MafSequence>(new MafSequence(seq)));
+  }
+  nbSites_ = block_->getNumberOfSites();
+  score_ = block_->getScore();
+  pass_ = block_->getPass();
+  if (recycler_)
+    recycler_->recycle(block_);
+  else
+    delete block_;
+  block_ = 0;
+}
+
+MafSequence* MafBlockAppender::getSequenceToExtend(const string& species)
+{
+  if (block_) startAppend_();
+  map<string, size_t>::iterator it = speciesRows_.find(species);
+  if (it == speciesRows_.end())
+    return 0;
+  MafSequence& row = *rows_[it->second];
+  pad_(row);
+  return &row;
+}
+
+void MafBlockAppender::appendToSequence(MafSequence& row, const MafSequence& sequence, size_t spacer)
+{
+  grow_(row, row.size() + spacer + sequence.size());
+  if (spacer > 0)
+    row.append(vector<int>(spacer, AlphabetTools::DNA_ALPHABET.getUnknownCharacterCode()));
+  if (row.getName() != sequence.getName()) {
+    //Force name conversion to prevent exception in 'merge':
+    MafSequence tmp(sequence);
+    tmp.setName(row.getName());
+    row.merge(tmp);
+  } else {
+    row.merge(sequence);
+  }
+}
+
+void MafBlockAppender::addSequence(const MafSequence& sequence, size_t spacer)
+{
+  if (block_) startAppend_();
+  if (!speciesRows_.insert(make_pair(sequence.getSpecies(), rows_.size())).second)
+    throw Exception("MafBlockAppender::addSequence. Species " + sequence.getSpecies() + " is already in the block.");
+  unique_ptr<MafSequence> row(new MafSequence(sequence));
+  row->setToSizeL(row->size() + nbSites_ + spacer);
+  rows_.push_back(std::move(row));
+}
+
+void MafBlockAppender::endBlock(const MafBlock& block, size_t spacer)
+{
+  if (block_) startAppend_();
+  unsigned int pass = block.getPass();
+  if (pass != pass_) pass_ = 0;
+  double n1 = static_cast<double>(nbSites_);
+  double n2 = static_cast<double>(block.getNumberOfSites());
+  score_ = (score_ * n1 + block.getScore() * n2) / (n1 + n2);
+  nbSites_ += spacer + block.getNumberOfSites();
+}
+
+MafBlock* MafBlockAppender::release()
+{
+  if (block_) {
+    MafBlock* block = block_;
+    block_ = 0;
+    return block;
+  }
+  if (rows_.empty())
+    return 0;
+  MafBlock* mergedBlock = new MafBlock();
+  mergedBlock->setScore(score_);
+  mergedBlock->setPass(pass_);
+  for (map<string, size_t>::iterator it = speciesRows_.begin(); it != speciesRows_.end(); ++it) {
+    pad_(*rows_[it->second]);
+    mergedBlock->addSequence(std::move(rows_[it->second]));
+  }
+  rows_.clear();
+  speciesRows_.clear();
+  nbSites_ = 0;
+  return mergedBlock;
+}
+
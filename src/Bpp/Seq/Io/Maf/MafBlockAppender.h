@@ -0,0 +1,174 @@
+//
+// File: MafBlockAppender.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _MAFBLOCKAPPENDER_H_
+#define _MAFBLOCKAPPENDER_H_
+
+#include "MafBlock.h"
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+namespace bpp {
+
+class MafIterator;
+
+/**
+ * @brief Concatenate consecutive blocks in place.
+ *
+ * This helper class is used by iterators which merge series of blocks, like BlockMergerMafIterator and
+ * ConcatenateMafIterator. The first block is kept as is, and only copied when a second one is appended.
+ * Sequences are then extended in place, with a geometric growth of their capacity, so that appending n blocks takes
+ * a time linear in the total size, instead of copying the whole block at each step.
+ *
+ * Species missing from an appended block are not modified: they are padded with gaps when next extended, or
+ * when the merged block is released. Only the first sequence of each species is kept, and after at least one
+ * append, sequences of the merged block are ordered by species name.
+ */
+class MafBlockAppender
+{
+  private:
+    MafIterator* recycler_;
+    MafBlock* block_;
+    std::vector< std::unique_ptr<MafSequence> > rows_;
+    std::map<std::string, size_t> speciesRows_;
+    size_t nbSites_;
+    double score_;
+    unsigned int pass_;
+
+  public:
+    /**
+     * @param recycler The iterator to which blocks are recycled once merged. If NULL, blocks are deleted.
+     */
+    MafBlockAppender(MafIterator* recycler = 0):
+      recycler_(recycler), block_(0), rows_(), speciesRows_(), nbSites_(0), score_(0), pass_(0)
+    {}
+
+  private:
+    //Recopy is forbidden!
+    MafBlockAppender(const MafBlockAppender& appender);
+    MafBlockAppender& operator=(const MafBlockAppender& appender);
+
+  public:
+    virtual ~MafBlockAppender() { delete block_; }
+
+  public:
+    /**
+     * @brief Start a new merged block.
+     *
+     * @param block The first block, which is owned by the appender until release() is called.
+     */
+    void reset(MafBlock* block);
+
+    size_t getNumberOfSites() const {
+      return block_ ? block_->getNumberOfSites() : nbSites_;
+    }
+
+    bool hasSequenceForSpecies(const std::string& species) const;
+
+    /**
+     * @return The first sequence of a given species, which may be shorter than the merged block if it was missing in the last ones.
+     * @throw SequenceNotFoundException if there is no sequence for this species.
+     */
+    const MafSequence& getSequenceForSpecies(const std::string& species) const;
+
+    /**
+     * @brief Get a sequence for modification, before a new block is appended.
+     *
+     * The sequence is padded with gaps to the current size of the merged block.
+     * @param species The species of the sequence.
+     * @return A pointer toward the sequence, or NULL if there is no sequence for this species.
+     */
+    MafSequence* getSequenceToExtend(const std::string& species);
+
+    /**
+     * @brief Append a sequence of the new block, to a sequence returned by getSequenceToExtend().
+     *
+     * @param row The sequence to extend.
+     * @param sequence The sequence to append. Its name is converted if needed.
+     * @param spacer The number of unknown characters to insert before the sequence.
+     */
+    void appendToSequence(MafSequence& row, const MafSequence& sequence, size_t spacer = 0);
+
+    /**
+     * @brief Add a sequence of the new block for a species which is not in the merged block yet.
+     *
+     * The sequence is padded with gaps on the left, for the size of the merged block and the spacer.
+     * @param sequence The sequence to add.
+     * @param spacer The number of positions between the merged block and the new block.
+     */
+    void addSequence(const MafSequence& sequence, size_t spacer = 0);
+
+    /**
+     * @brief Account for a new block, once all its sequences have been appended or added.
+     *
+     * The score is averaged, weighted by the block sizes, and the pass value is removed if it differs.
+     * @param block The appended block, which is not recycled by this method.
+     * @param spacer The number of positions between the merged block and the new block.
+     */
+    void endBlock(const MafBlock& block, size_t spacer = 0);
+
+    /**
+     * @return The merged block, which is now owned by the caller, or NULL if no block was started.
+     */
+    MafBlock* release();
+
+  private:
+    //Copy the sequences of the first block, before a second one is appended:
+    void startAppend_();
+
+    static void grow_(MafSequence& row, size_t nbSites) {
+      if (row.capacity() < nbSites)
+        row.reserve(std::max(nbSites, 2 * row.capacity()));
+    }
+
+    void pad_(MafSequence& row) {
+      if (row.size() < nbSites_) {
+        grow_(row, nbSites_);
+        row.setToSizeR(nbSites_);
+      }
+    }
+};
+
+} // end of namespace bpp.
+
+#endif //_MAFBLOCKAPPENDER_H_
@@ -0,0 +1,117 @@
+//
+// File: MafBlockPool.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "MafBlockPool.h"
+
+using namespace bpp;
+using namespace std;
+
+MafBlockPool::~MafBlockPool()
+{
+  clear();
+}
+
+MafBlock* MafBlockPool::getBlock()
+{
+  {
+    lock_guard<mutex> lock(mutex_);
+    if (!blocks_.empty()) {
+      MafBlock* block = blocks_.back();
+      blocks_.pop_back();
+      return block;
+    }
+  }
+  return new MafBlock();
+}
+
+void MafBlockPool::recycle(MafBlock* block)
+{
+  if (!block) return;
+  //Clearing is done outside of the lock:
+  vector< vector<int> > buffers;
+  block->clear(&buffers);
+  lock_guard<mutex> lock(mutex_);
+  for (size_t i = 0; i < buffers.size() && buffers_.size() < maxBuffers_; ++i) {
+    buffers_.push_back(vector<int>());
+    buffers_.back().swap(buffers[i]);
+  }
+  if (blocks_.size() < maxBlocks_)
+    blocks_.push_back(block);
+  else
+    delete block;
+}
+
+std::vector<int> MafBlockPool::getBuffer()
+{
+  vector<int> buffer;
+  lock_guard<mutex> lock(mutex_);
+  if (!buffers_.empty()) {
+    buffer.swap(buffers_.back());
+    buffers_.pop_back();
+    buffer.clear();
+  }
+  return buffer;
+}
+
+size_t MafBlockPool::getNumberOfBlocks()
+{
+  lock_guard<mutex> lock(mutex_);
+  return blocks_.size();
+}
+
+size_t MafBlockPool::getNumberOfBuffers()
+{
+  lock_guard<mutex> lock(mutex_);
+  return buffers_.size();
+}
+
+void MafBlockPool::clear()
+{
+  lock_guard<mutex> lock(mutex_);
+  for (size_t i = 0; i < blocks_.size(); ++i)
+    delete blocks_[i];
+  blocks_.clear();
+  buffers_.clear();
+}
+
+MafBlockPool& MafBlockPool::getDefaultPool()
+{
+  static MafBlockPool pool;
+  return pool;
+}
@@ -0,0 +1,122 @@
+//
+// File: MafBlockPool.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _MAFBLOCKPOOL_H_
+#define _MAFBLOCKPOOL_H_
+
+#include "MafBlock.h"
+
+//From the STL:
+#include <vector>
+#include <mutex>
+
+namespace bpp {
+
+/**
+ * @brief A pool of recycled MafBlock objects and sequence buffers.
+ *
+ * Blocks which are not used anymore can be given back to the pool, instead of being deleted.
+ * Their content is cleared, and the state vectors of their sequences are kept, with their capacity,
+ * to be reused by the parser when building new sequences. This avoids most heap allocations
+ * in long pipelines.
+ *
+ * The pool has a bounded size: blocks and buffers recycled when the pool is full are freed.
+ * All methods are thread-safe.
+ *
+ * @see MafIterator::recycle
+ */
+class MafBlockPool
+{
+  private:
+    size_t maxBlocks_;
+    size_t maxBuffers_;
+    std::vector<MafBlock*> blocks_;
+    std::vector< std::vector<int> > buffers_;
+    std::mutex mutex_;
+
+  public:
+    /**
+     * @param maxBlocks Maximum number of blocks kept in the pool.
+     * @param maxBuffers Maximum number of sequence buffers kept in the pool.
+     */
+    MafBlockPool(size_t maxBlocks = 64, size_t maxBuffers = 4096):
+      maxBlocks_(maxBlocks), maxBuffers_(maxBuffers), blocks_(), buffers_(), mutex_() {}
+
+    virtual ~MafBlockPool();
+
+  private:
+    MafBlockPool(const MafBlockPool& pool);
+    MafBlockPool& operator=(const MafBlockPool& pool);
+
+  public:
+    /**
+     * @return An empty block, either recycled or newly created.
+     */
+    MafBlock* getBlock();
+
+    /**
+     * @brief Give back a block to the pool.
+     *
+     * @param block The block to recycle (may be NULL). The block must not be used anymore after the call.
+     */
+    void recycle(MafBlock* block);
+
+    /**
+     * @return An empty state vector, with a non-null capacity if it was recycled.
+     */
+    std::vector<int> getBuffer();
+
+    size_t getNumberOfBlocks();
+
+    size_t getNumberOfBuffers();
+
+    /**
+     * @brief Free all blocks and buffers in the pool.
+     */
+    void clear();
+
+    /**
+     * @return The pool used by default by parsers and iterators.
+     */
+    static MafBlockPool& getDefaultPool();
+};
+
+} // end of namespace bpp.
+
+#endif //_MAFBLOCKPOOL_H_
@@ -0,0 +1,82 @@
+//
+// File: MafBlockView.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "MafBlockView.h"
+#include "MafBlockPool.h"
+#include "MafIterator.h"
+
+using namespace bpp;
+using namespace std;
+
+MafBlockView::MafBlockView(MafBlock* block, MafIterator* source):
+  block_(share(block, source)), begin_(0), length_(block ? block->getNumberOfSites() : 0)
+{}
+
+MafBlockView::MafBlockView(std::shared_ptr<const MafBlock> block, size_t begin, size_t length):
+  block_(block), begin_(begin), length_(length)
+{
+  if (begin + length > block->getNumberOfSites())
+    throw IndexOutOfBoundsException("MafBlockView (constructor). Slice does not fit in block.", begin + length, 0, block->getNumberOfSites());
+}
+
+std::shared_ptr<const MafBlock> MafBlockView::share(MafBlock* block, MafIterator* source)
+{
+  return std::shared_ptr<const MafBlock>(block, [source](const MafBlock* b) {
+    if (source)
+      source->recycle(const_cast<MafBlock*>(b));
+    else
+      MafBlockPool::getDefaultPool().recycle(const_cast<MafBlock*>(b));
+  });
+}
+
+string MafBlockView::getDescription() const
+{
+  return TextTools::toString(getNumberOfSequences()) + "x" + TextTools::toString(length_);
+}
+
+MafBlock* MafBlockView::materialize() const
+{
+  MafBlock* newBlock = new MafBlock();
+  newBlock->setScore(block_->getScore());
+  newBlock->setPass(block_->getPass());
+  for (size_t j = 0; j < block_->getNumberOfSequences(); ++j) {
+    newBlock->addSequence(unique_ptr<MafSequence>(getSubSequence(j)));
+  }
+  return newBlock;
+}
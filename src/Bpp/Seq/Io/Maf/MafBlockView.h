@@ -0,0 +1,174 @@
+//
+// File: MafBlockView.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _MAFBLOCKVIEW_H_
+#define _MAFBLOCKVIEW_H_
+
+#include "MafBlock.h"
+
+//From the STL:
+#include <memory>
+#include <string>
+
+namespace bpp {
+
+class MafIterator;
+
+/**
+ * @brief A read-only slice of a MafBlock.
+ *
+ * A view references a range of columns of a parent block, without copying any data.
+ * The parent block is shared between all its views, and is recycled by the iterator which produced it
+ * (see MafIterator::recycle) when the last view referencing it is destroyed, so this iterator must outlive
+ * the views. Coordinates of the sequences in the slice are computed on the fly, using the gap index of the
+ * parent sequences.
+ *
+ * Views are typically produced by iterators splitting blocks (see MafIterator::nextBlockView),
+ * and only materialized as new blocks when a modifiable copy is needed.
+ * As the parent block is shared, it must not be modified while views on it exist.
+ */
+class MafBlockView
+{
+  private:
+    std::shared_ptr<const MafBlock> block_;
+    size_t begin_;
+    size_t length_;
+
+  public:
+    MafBlockView(): block_(), begin_(0), length_(0) {}
+
+    /**
+     * @brief Build a view of a complete block.
+     *
+     * @param block The block, which is then owned by the view.
+     * @param source The iterator which produced the block, and recycles it. If NULL, the block is sent to the default MafBlockPool.
+     */
+    explicit MafBlockView(MafBlock* block, MafIterator* source = 0);
+
+    /**
+     * @brief Build a view of a range of columns of a block.
+     *
+     * @param block The parent block.
+     * @param begin The first column of the slice.
+     * @param length The number of columns in the slice.
+     * @throw IndexOutOfBoundsException if the slice does not fit in the block.
+     */
+    MafBlockView(std::shared_ptr<const MafBlock> block, size_t begin, size_t length);
+
+  public:
+    /**
+     * @return A shared pointer to the given block, which recycles it when it is not used anymore.
+     * @param block The block to share. The returned pointer takes ownership of it.
+     * @param source The iterator which produced the block, and recycles it. If NULL, the block is sent to the default MafBlockPool.
+     */
+    static std::shared_ptr<const MafBlock> share(MafBlock* block, MafIterator* source = 0);
+
+    bool isEmpty() const { return !block_; }
+
+    const MafBlock& getBlock() const { return *block_; }
+
+    const std::shared_ptr<const MafBlock>& getSharedBlock() const { return block_; }
+
+    /**
+     * @return The position of the first column of the view in the parent block.
+     */
+    size_t getBegin() const { return begin_; }
+
+    size_t getNumberOfSites() const { return length_; }
+
+    size_t getNumberOfSequences() const { return block_->getNumberOfSequences(); }
+
+    /**
+     * @return The number of bytes used by the parent block, which may be shared with other views.
+     */
+    size_t getMemorySize() const { return block_ ? block_->getMemorySize() : 0; }
+
+    double getScore() const { return block_->getScore(); }
+
+    unsigned int getPass() const { return block_->getPass(); }
+
+    /**
+     * @return The full sequence of the parent block.
+     * @param i The row index.
+     */
+    const MafSequence& getSequence(size_t i) const { return block_->getSequence(i); }
+
+    /**
+     * @return A pointer to the first state in the view, for a given row.
+     * @param i The row index.
+     */
+    const int* getStates(size_t i) const { return block_->getSequence(i).getContent().data() + begin_; }
+
+    int getState(size_t i, size_t site) const { return block_->getSequence(i).getContent()[begin_ + site]; }
+
+    /**
+     * @return The number of characters (non-gap positions) in the view, for a given row.
+     * @param i The row index.
+     */
+    size_t getGenomicSize(size_t i) const { return block_->getSequence(i).getGenomicSize(begin_, begin_ + length_); }
+
+    /**
+     * @return The start coordinate of a given row in the view.
+     * @param i The row index.
+     * @throw Exception if the sequence does not have coordinates.
+     */
+    size_t start(size_t i) const {
+      const MafSequence& seq = block_->getSequence(i);
+      return seq.start() + seq.getGenomicSize(0, begin_);
+    }
+
+    size_t stop(size_t i) const { return start(i) + getGenomicSize(i); }
+
+    std::string getDescription() const;
+
+    /**
+     * @return A new sequence with the content of a given row in the view.
+     * @param i The row index.
+     */
+    MafSequence* getSubSequence(size_t i) const { return block_->getSequence(i).subSequence(begin_, length_); }
+
+    /**
+     * @return A new block with a copy of the data in the view.
+     */
+    MafBlock* materialize() const;
+};
+
+} // end of namespace bpp.
+
+#endif //_MAFBLOCKVIEW_H_
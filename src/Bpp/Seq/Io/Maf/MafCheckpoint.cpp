@@ -0,0 +1,228 @@
+//
+// File: MafCheckpoint.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "MafCheckpoint.h"
+#include "BinaryIoTools.h"
+#include "MafParser.h"
+#include "ProgressReporter.h"
+#include "../CompressedOutput.h"
+
+using namespace bpp;
+
+//From the STL:
+#include <fstream>
+#include <algorithm>
+#include <typeinfo>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+//From POSIX:
+#include <unistd.h>
+
+using namespace std;
+
+//Binary I/O, little endian:
+
+static const char READ_CONTEXT[] = "MafCheckpoint::read()";
+
+static const char CHECKPOINT_MAGIC[] = "BPPCKPT1";
+
+const string& MafCheckpoint::getValue(const string& key) const
+{
+  map<string, string>::const_iterator it = values_.find(key);
+  if (it == values_.end())
+    throw Exception("MafCheckpoint::getValue. No value for key '" + key + "'.");
+  return it->second;
+}
+
+void MafCheckpoint::write(const string& path) const
+{
+  string tmpPath = path + ".tmp";
+  {
+    ofstream out(tmpPath.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!out)
+      throw IOException("MafCheckpoint::write(). Could not open file: " + tmpPath);
+    out.write(CHECKPOINT_MAGIC, 8);
+    BinaryIoTools::writeUInt(out, values_.size(), 4);
+    for (map<string, string>::const_iterator it = values_.begin(); it != values_.end(); ++it) {
+      BinaryIoTools::writeString(out, it->first);
+      BinaryIoTools::writeString(out, it->second);
+    }
+    BinaryIoTools::writeUInt(out, outputSizes_.size(), 4);
+    for (size_t i = 0; i < outputSizes_.size(); ++i) {
+      BinaryIoTools::writeString(out, outputSizes_[i].first);
+      BinaryIoTools::writeUInt(out, outputSizes_[i].second, 8);
+    }
+    out.flush();
+    if (!out)
+      throw IOException("MafCheckpoint::write(). Error while writing file: " + tmpPath);
+  }
+  if (rename(tmpPath.c_str(), path.c_str()) != 0)
+    throw IOException("MafCheckpoint::write(). Could not replace file: " + path);
+}
+
+MafCheckpoint* MafCheckpoint::read(const string& path)
+{
+  ifstream in(path.c_str(), ios::in | ios::binary);
+  if (!in)
+    return 0;
+  char magic[8];
+  in.read(magic, 8);
+  if (!in || memcmp(magic, CHECKPOINT_MAGIC, 8) != 0)
+    throw IOException("MafCheckpoint::read(). Not a checkpoint file: " + path);
+  unique_ptr<MafCheckpoint> checkpoint(new MafCheckpoint());
+  size_t nbValues = static_cast<size_t>(BinaryIoTools::readUInt(in, 4, READ_CONTEXT));
+  for (size_t i = 0; i < nbValues; ++i) {
+    string key = BinaryIoTools::readString(in, READ_CONTEXT);
+    checkpoint->values_[key] = BinaryIoTools::readString(in, READ_CONTEXT);
+  }
+  size_t nbOutputs = static_cast<size_t>(BinaryIoTools::readUInt(in, 4, READ_CONTEXT));
+  for (size_t i = 0; i < nbOutputs; ++i) {
+    string output = BinaryIoTools::readString(in, READ_CONTEXT);
+    checkpoint->outputSizes_.push_back(make_pair(output, BinaryIoTools::readUInt(in, 8, READ_CONTEXT)));
+  }
+  return checkpoint.release();
+}
+
+/******************************************************************************/
+
+MafCheckpointer::MafCheckpointer(AbstractMafIterator* iterator, const string& path, double interval):
+  path_(path), interval_(interval), stages_(), parser_(0), outputs_(),
+  last_(chrono::steady_clock::now()), nbCheckpoints_(0)
+{
+  if (!iterator)
+    throw NullPointerException("MafCheckpointer (constructor). Iterator should not be a NULL pointer!");
+  AbstractMafIterator* it = iterator;
+  while (it && find(stages_.begin(), stages_.end(), it) == stages_.end()) {
+    stages_.push_back(it);
+    AbstractFilterMafIterator* filter = dynamic_cast<AbstractFilterMafIterator*>(it);
+    it = (filter ? dynamic_cast<AbstractMafIterator*>(filter->getInputIterator()) : 0);
+  }
+  reverse(stages_.begin(), stages_.end());
+  parser_ = dynamic_cast<MafParser*>(stages_.front());
+  if (!parser_)
+    throw Exception("MafCheckpointer (constructor). The pipeline should start with a MafParser.");
+  iterator->addIterationListener(this);
+}
+
+void MafCheckpointer::addOutputFile(const string& path, ostream* stream)
+{
+  if (!stream)
+    throw NullPointerException("MafCheckpointer::addOutputFile. Stream should not be a NULL pointer!");
+  outputs_.push_back(make_pair(path, stream));
+}
+
+string MafCheckpointer::getStageType_(size_t i) const
+{
+  return typeid(*stages_[i]).name();
+}
+
+bool MafCheckpointer::checkpoint()
+{
+  //All parsed blocks must have gone through the whole pipeline:
+  for (size_t i = 0; i < stages_.size(); ++i)
+    if (stages_[i]->getNumberOfBufferedBlocks() > 0)
+      return false;
+  MafCheckpoint checkpoint;
+  checkpoint.setValue("stages", static_cast<uint64_t>(stages_.size()));
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    string prefix = "stage" + TextTools::toString(i) + ".";
+    checkpoint.setValue(prefix + "type", getStageType_(i));
+    CheckpointableMafIterator* stage = dynamic_cast<CheckpointableMafIterator*>(stages_[i]);
+    if (stage)
+      stage->saveState(checkpoint, prefix);
+  }
+  for (size_t i = 0; i < outputs_.size(); ++i) {
+    flushOutput_(*outputs_[i].second);
+    if (!*outputs_[i].second)
+      throw IOException("MafCheckpointer::checkpoint. Error while writing file: " + outputs_[i].first);
+    checkpoint.setOutputSize(outputs_[i].first, ProgressReporter::getFileSize(outputs_[i].first));
+  }
+  checkpoint.write(path_);
+  nbCheckpoints_++;
+  last_ = chrono::steady_clock::now();
+  return true;
+}
+
+void MafCheckpointer::flushOutput_(std::ostream& out)
+{
+  //BGZF streams keep the current block on flush, it has to be written for the file size to include all data:
+  BgzfOutputStream* bgzf = dynamic_cast<BgzfOutputStream*>(&out);
+  if (bgzf)
+    bgzf->flushBlock();
+  out.flush();
+}
+
+bool MafCheckpointer::resume()
+{
+  unique_ptr<MafCheckpoint> checkpoint(MafCheckpoint::read(path_));
+  if (!checkpoint.get())
+    return false;
+  if (checkpoint->getUIntValue("stages") != stages_.size())
+    throw Exception("MafCheckpointer::resume. The checkpoint was taken with a different pipeline.");
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    if (checkpoint->getValue("stage" + TextTools::toString(i) + ".type") != getStageType_(i))
+      throw Exception("MafCheckpointer::resume. The checkpoint was taken with a different pipeline, at stage " + TextTools::toString(i) + ".");
+  }
+  //Discard what was written after the checkpoint, including headers written again upon construction:
+  for (size_t i = 0; i < outputs_.size(); ++i)
+    flushOutput_(*outputs_[i].second);
+  const vector< pair<string, uint64_t> >& sizes = checkpoint->getOutputSizes();
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    if (truncate(sizes[i].first.c_str(), static_cast<off_t>(sizes[i].second)) != 0)
+      throw IOException("MafCheckpointer::resume. Could not truncate file: " + sizes[i].first);
+  }
+  for (size_t i = 0; i < outputs_.size(); ++i)
+    outputs_[i].second->seekp(0, ios::end);
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    CheckpointableMafIterator* stage = dynamic_cast<CheckpointableMafIterator*>(stages_[i]);
+    if (stage)
+      stage->restoreState(*checkpoint, "stage" + TextTools::toString(i) + ".");
+  }
+  last_ = chrono::steady_clock::now();
+  return true;
+}
+
+void MafCheckpointer::iterationMoves(const MafBlock& currentBlock)
+{
+  if (chrono::duration<double>(chrono::steady_clock::now() - last_).count() >= interval_)
+    checkpoint();
+}
+
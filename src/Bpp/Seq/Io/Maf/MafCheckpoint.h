@@ -0,0 +1,234 @@
+//
+// File: MafCheckpoint.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _MAFCHECKPOINT_H_
+#define _MAFCHECKPOINT_H_
+
+#include "MafIterator.h"
+#include "IterationListener.h"
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <cstdint>
+
+namespace bpp {
+
+class MafParser;
+
+/**
+ * @brief The state of a pipeline of iterators at a given block, as saved by a MafCheckpointer.
+ *
+ * Values are stored as strings, under keys chosen by each stage.
+ */
+class MafCheckpoint
+{
+  private:
+    std::map<std::string, std::string> values_;
+    std::vector< std::pair<std::string, uint64_t> > outputSizes_;
+
+  public:
+    MafCheckpoint(): values_(), outputSizes_() {}
+
+  public:
+    void setValue(const std::string& key, const std::string& value) { values_[key] = value; }
+
+    void setValue(const std::string& key, uint64_t value) { values_[key] = TextTools::toString(value); }
+
+    bool hasValue(const std::string& key) const { return values_.find(key) != values_.end(); }
+
+    /**
+     * @return The value associated to a key.
+     * @throw Exception If there is no value for this key.
+     */
+    const std::string& getValue(const std::string& key) const;
+
+    uint64_t getUIntValue(const std::string& key) const { return TextTools::to<uint64_t>(getValue(key)); }
+
+    /**
+     * @brief Record the size of an output file.
+     */
+    void setOutputSize(const std::string& path, uint64_t size) { outputSizes_.push_back(std::make_pair(path, size)); }
+
+    const std::vector< std::pair<std::string, uint64_t> >& getOutputSizes() const { return outputSizes_; }
+
+    /**
+     * @brief Write the checkpoint to a file.
+     *
+     * The checkpoint is first written to a temporary file, which then replaces the previous one,
+     * so that a valid checkpoint is always available.
+     * @param path The output path.
+     * @throw IOException If the file cannot be written.
+     */
+    void write(const std::string& path) const;
+
+    /**
+     * @param path The input path.
+     * @return A new checkpoint, or 0 if the file does not exist.
+     * @throw IOException If the file is not a valid checkpoint.
+     */
+    static MafCheckpoint* read(const std::string& path);
+};
+
+/**
+ * @brief Interface for iterators keeping a state between blocks, which can be saved in a checkpoint.
+ *
+ * Stages of a pipeline that do not implement this interface are assumed to be stateless. Output stages should
+ * write all their buffers to their streams when saving their state.
+ */
+class CheckpointableMafIterator
+{
+  public:
+    virtual ~CheckpointableMafIterator() {}
+
+  public:
+    /**
+     * @brief Save the state of the iterator.
+     *
+     * @param checkpoint The checkpoint.
+     * @param prefix A prefix to use for all keys, unique to this stage.
+     */
+    virtual void saveState(MafCheckpoint& checkpoint, const std::string& prefix) = 0;
+
+    /**
+     * @brief Restore the state of the iterator, before any block was read.
+     *
+     * @param checkpoint The checkpoint.
+     * @param prefix The prefix used when saving the state.
+     */
+    virtual void restoreState(const MafCheckpoint& checkpoint, const std::string& prefix) = 0;
+};
+
+/**
+ * @brief Save the state of a pipeline of iterators at regular intervals, so that an interrupted iteration can be resumed.
+ *
+ * The checkpointer listens to the last stage of the pipeline, which must start with a MafParser on a seekable input.
+ * A checkpoint is taken after a block is returned by the last stage, once the time interval has elapsed and no stage
+ * is holding a block (see AbstractMafIterator::getNumberOfBufferedBlocks()). It records the position in the input after the last
+ * block parsed, the state of all CheckpointableMafIterator stages (for instance the previous coordinates of
+ * OrderFilterMafIterator, or the called sites of MsmcOutputMafIterator) and the size of all registered output files,
+ * after output stages have been flushed. Stages always holding a block, like BlockMergerMafIterator, prevent checkpoints.
+ *
+ * To resume, the same pipeline is built with output files opened in append mode, and resume() is called before the first block is
+ * read. The input is then positioned after the last checkpointed block, stage states are restored, and output files are truncated
+ * to their checkpointed size, which also removes the headers written again by output stages upon construction:
+ * @code
+ * ofstream vcf("out.vcf", ios::out | ios::app);
+ * MafParser* parser = new MafParser(new CompressedLineReader("input.maf.gz"));
+ * ...
+ * VcfOutputMafIterator* output = new VcfOutputMafIterator(filter, &vcf, "hg38", genotypes);
+ * MafCheckpointer checkpointer(output, "job.checkpoint", 600);
+ * checkpointer.addOutputFile("out.vcf", &vcf);
+ * checkpointer.resume(); //Does nothing if there is no checkpoint.
+ * while (MafBlock* block = output->nextBlock()) output->recycle(block);
+ * @endcode
+ */
+class MafCheckpointer:
+  public virtual IterationListener
+{
+  private:
+    std::string path_;
+    double interval_;
+    std::vector<AbstractMafIterator*> stages_; //From the parser to the last stage.
+    MafParser* parser_;
+    std::vector< std::pair<std::string, std::ostream*> > outputs_;
+    std::chrono::steady_clock::time_point last_;
+    size_t nbCheckpoints_;
+
+  public:
+    /**
+     * @param iterator The last stage of the pipeline.
+     * @param path The checkpoint file.
+     * @param interval The minimum time between two checkpoints, in seconds.
+     */
+    MafCheckpointer(AbstractMafIterator* iterator, const std::string& path, double interval = 600.);
+
+  private:
+    //Recopy is forbidden!
+    MafCheckpointer(const MafCheckpointer& checkpointer);
+    MafCheckpointer& operator=(const MafCheckpointer& checkpointer);
+
+  public:
+    virtual ~MafCheckpointer() {}
+
+  public:
+    /**
+     * @brief Register an output file, to be truncated upon resume.
+     *
+     * @param path The path to the file.
+     * @param stream The stream writing to the file (not owned), flushed before each checkpoint.
+     * The current block of a BgzfOutputStream is also written, so that compressed outputs can be registered.
+     */
+    void addOutputFile(const std::string& path, std::ostream* stream);
+
+    /**
+     * @brief Save a checkpoint now, if no stage is holding a block.
+     *
+     * @return True if a checkpoint was written.
+     */
+    bool checkpoint();
+
+    /**
+     * @brief Restore the pipeline from the last checkpoint, if any.
+     *
+     * @return True if a checkpoint was found and restored.
+     * @throw Exception If the checkpoint does not match the pipeline.
+     */
+    bool resume();
+
+    size_t getNumberOfCheckpoints() const { return nbCheckpoints_; }
+
+  public:
+    void iterationStarts() { last_ = std::chrono::steady_clock::now(); }
+    void iterationMoves(const MafBlock& currentBlock);
+    void iterationMovesBatch(const MafBlock* const* blocks, size_t nbBlocks) {
+      if (nbBlocks > 0) iterationMoves(*blocks[nbBlocks - 1]);
+    }
+    void iterationStops() {}
+
+  private:
+    static void flushOutput_(std::ostream& out);
+    std::string getStageType_(size_t i) const;
+};
+
+} // end of namespace bpp.
+
+#endif //_MAFCHECKPOINT_H_
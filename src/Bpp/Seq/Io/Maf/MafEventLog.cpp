@@ -0,0 +1,192 @@
+//
+// File: MafEventLog.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "MafEventLog.h"
+#include "BinaryIoTools.h"
+
+//From bpp-core:
+#include <Bpp/Text/TextTools.h>
+
+//From the STL:
+#include <algorithm>
+
+using namespace bpp;
+using namespace std;
+
+const short MafEventType::LEVEL_DEBUG;
+const short MafEventType::LEVEL_INFO;
+const short MafEventType::LEVEL_WARNING;
+const size_t MafEvent::MAX_NB_VALUES;
+
+string MafEventType::formatEvent(const string& format, const string& description, const uint64_t* values, size_t nbValues, const string* text)
+{
+  string result;
+  result.reserve(format.size() + 32);
+  for (size_t i = 0; i < format.size(); ++i) {
+    char c = format[i];
+    if (c != '%' || i + 1 == format.size()) {
+      result += c;
+      continue;
+    }
+    char f = format[++i];
+    if (f == 'd') {
+      result += description;
+    } else if (f == 's') {
+      if (text) result += *text;
+    } else if (f >= '0' && f <= '9') {
+      size_t k = static_cast<size_t>(f - '0');
+      if (k < nbValues) result += TextTools::toString(values[k]);
+    } else {
+      result += f;
+    }
+  }
+  return result;
+}
+
+/******************************************************************************/
+
+void TextMafEventSink::write(const MafEvent& event)
+{
+  string line = event.toString();
+  lock_guard<mutex> lock(mutex_);
+  (*output_ << line).endLine();
+}
+
+/******************************************************************************/
+
+static const char READ_CONTEXT[] = "BinaryMafEventReader::nextEvent";
+
+BinaryMafEventSink::BinaryMafEventSink(ostream* output):
+  output_(output), typeIds_(), nbEvents_(0), mutex_()
+{
+  if (!output)
+    throw NullPointerException("BinaryMafEventSink (constructor). Output stream should not be a NULL pointer!");
+  output_->write("BPPEVNT1", 8);
+}
+
+void BinaryMafEventSink::write(const MafEvent& event)
+{
+  lock_guard<mutex> lock(mutex_);
+  map<const MafEventType*, uint64_t>::iterator it = typeIds_.find(event.type);
+  if (it == typeIds_.end()) {
+    //Describe the new type:
+    it = typeIds_.insert(make_pair(event.type, static_cast<uint64_t>(typeIds_.size()))).first;
+    BinaryIoTools::writeVarint(*output_, 0);
+    output_->put(static_cast<char>(event.type->level));
+    BinaryIoTools::writeVarintString(*output_, event.type->stage);
+    BinaryIoTools::writeVarintString(*output_, event.type->name);
+    BinaryIoTools::writeVarintString(*output_, event.type->format);
+  }
+  BinaryIoTools::writeVarint(*output_, it->second + 1);
+  //Flags: block, text, then the number of values.
+  size_t nbValues = min(event.nbValues, MafEvent::MAX_NB_VALUES);
+  output_->put(static_cast<char>((event.block ? 1 : 0) | (event.text ? 2 : 0) | (nbValues << 2)));
+  if (event.block) {
+    BinaryIoTools::writeVarint(*output_, event.block->getNumberOfSequences());
+    BinaryIoTools::writeVarint(*output_, event.block->getNumberOfSites());
+  }
+  for (size_t i = 0; i < nbValues; ++i)
+    BinaryIoTools::writeVarint(*output_, event.values[i]);
+  if (event.text)
+    BinaryIoTools::writeVarintString(*output_, *event.text);
+  nbEvents_++;
+}
+
+/******************************************************************************/
+
+string MafEventRecord::toString() const
+{
+  string description;
+  if (nbSequences > 0 || nbSites > 0)
+    description = TextTools::toString(nbSequences) + "x" + TextTools::toString(nbSites);
+  return MafEventType::formatEvent(format, description, values.empty() ? 0 : &values[0], values.size(), hasText ? &text : 0);
+}
+
+BinaryMafEventReader::BinaryMafEventReader(istream* input):
+  input_(input), types_()
+{
+  if (!input)
+    throw NullPointerException("BinaryMafEventReader (constructor). Input stream should not be a NULL pointer!");
+  char magic[8];
+  input_->read(magic, 8);
+  if (!*input_ || string(magic, 8) != "BPPEVNT1")
+    throw IOException("BinaryMafEventReader (constructor). Not an event log file.");
+}
+
+bool BinaryMafEventReader::nextEvent(MafEventRecord& record)
+{
+  uint64_t tag;
+  while (true) {
+    if (!BinaryIoTools::readVarint(*input_, tag, READ_CONTEXT))
+      return false;
+    if (tag > 0)
+      break;
+    Type_ type;
+    int level = input_->get();
+    if (level == char_traits<char>::eof())
+      BinaryIoTools::throwEndOfFile(READ_CONTEXT);
+    type.level = static_cast<short>(level);
+    type.stage = BinaryIoTools::readVarintString(*input_, READ_CONTEXT);
+    type.name = BinaryIoTools::readVarintString(*input_, READ_CONTEXT);
+    type.format = BinaryIoTools::readVarintString(*input_, READ_CONTEXT);
+    types_.push_back(type);
+  }
+  if (tag > types_.size())
+    throw IOException("BinaryMafEventReader::nextEvent. Undeclared event type.");
+  const Type_& type = types_[static_cast<size_t>(tag - 1)];
+  record.stage = type.stage;
+  record.name = type.name;
+  record.level = type.level;
+  record.format = type.format;
+  int flags = input_->get();
+  if (flags == char_traits<char>::eof())
+    BinaryIoTools::throwEndOfFile(READ_CONTEXT);
+  record.nbSequences = record.nbSites = 0;
+  if (flags & 1) {
+    record.nbSequences = BinaryIoTools::readRequiredVarint(*input_, READ_CONTEXT);
+    record.nbSites = BinaryIoTools::readRequiredVarint(*input_, READ_CONTEXT);
+  }
+  record.values.resize(static_cast<size_t>(flags >> 2));
+  for (size_t i = 0; i < record.values.size(); ++i)
+    record.values[i] = BinaryIoTools::readRequiredVarint(*input_, READ_CONTEXT);
+  record.hasText = (flags & 2) != 0;
+  record.text = (record.hasText ? BinaryIoTools::readVarintString(*input_, READ_CONTEXT) : string());
+  return true;
+}
+
@@ -0,0 +1,259 @@
+//
+// File: MafEventLog.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _MAFEVENTLOG_H_
+#define _MAFEVENTLOG_H_
+
+#include "MafBlock.h"
+
+//From bpp-core:
+#include <Bpp/Io/OutputStream.h>
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <iostream>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief Description of a kind of event reported by an iterator.
+ *
+ * Event types are static objects, compared by address. The format describes the text
+ * version of the event, where %d stands for the description of the block, %0 to %3 for
+ * the numeric fields, %s for the text field and %% for a percent sign.
+ */
+class MafEventType
+{
+  public:
+    static const short LEVEL_DEBUG = 0;
+    static const short LEVEL_INFO = 1;
+    static const short LEVEL_WARNING = 2;
+
+  public:
+    const char* stage;
+    const char* name;
+    short level;
+    const char* format;
+
+  public:
+    constexpr MafEventType(const char* eventStage, const char* eventName, short eventLevel, const char* eventFormat):
+      stage(eventStage), name(eventName), level(eventLevel), format(eventFormat) {}
+
+  public:
+    /**
+     * @brief Format an event.
+     *
+     * @param format The format of the event type.
+     * @param description The description of the block.
+     * @param values The numeric fields.
+     * @param nbValues The number of numeric fields.
+     * @param text The text field, or NULL.
+     */
+    static std::string formatEvent(const std::string& format, const std::string& description, const uint64_t* values, size_t nbValues, const std::string* text);
+};
+
+/**
+ * @brief An event, with a type, the block it refers to and a few fields.
+ *
+ * Events only hold pointers, and are only valid while they are written.
+ * They are formatted by sinks which need text.
+ */
+struct MafEvent
+{
+  static const size_t MAX_NB_VALUES = 4;
+
+  const MafEventType* type;
+  const MafBlock* block;
+  uint64_t values[MAX_NB_VALUES];
+  size_t nbValues;
+  const std::string* text;
+
+  MafEvent(const MafEventType& eventType, const MafBlock* eventBlock):
+    type(&eventType), block(eventBlock), values(), nbValues(0), text(0) {}
+
+  /**
+   * @return The text version of the event.
+   */
+  std::string toString() const {
+    return MafEventType::formatEvent(type->format, block ? block->getDescription() : std::string(), values, nbValues, text);
+  }
+};
+
+/**
+ * @brief Interface for objects receiving events.
+ *
+ * Sinks may be shared by several iterators, possibly running on several threads,
+ * and must therefore be thread-safe.
+ */
+class MafEventSink
+{
+  public:
+    virtual ~MafEventSink() {}
+
+  public:
+    virtual void write(const MafEvent& event) = 0;
+};
+
+/**
+ * @brief Write events as lines of text.
+ */
+class TextMafEventSink:
+  public virtual MafEventSink
+{
+  private:
+    std::shared_ptr<OutputStream> output_;
+    std::mutex mutex_;
+
+  public:
+    TextMafEventSink(std::shared_ptr<OutputStream> output):
+      output_(output), mutex_() {}
+
+  private:
+    //Recopy is forbidden!
+    TextMafEventSink(const TextMafEventSink& sink);
+    TextMafEventSink& operator=(const TextMafEventSink& sink);
+
+  public:
+    void write(const MafEvent& event);
+};
+
+/**
+ * @brief Write events in a compact binary format, for later analysis.
+ *
+ * Each event type is described once, the first time it is written, and events are stored
+ * as the number of sequences and sites of the block, followed by the fields, all as variable length integers.
+ * Files can be read back with BinaryMafEventReader.
+ */
+class BinaryMafEventSink:
+  public virtual MafEventSink
+{
+  private:
+    std::ostream* output_;
+    std::map<const MafEventType*, uint64_t> typeIds_;
+    uint64_t nbEvents_;
+    std::mutex mutex_;
+
+  public:
+    /**
+     * @param output The output stream (not owned), which should be opened in binary mode.
+     */
+    BinaryMafEventSink(std::ostream* output);
+
+  private:
+    //Recopy is forbidden!
+    BinaryMafEventSink(const BinaryMafEventSink& sink);
+    BinaryMafEventSink& operator=(const BinaryMafEventSink& sink);
+
+  public:
+    void write(const MafEvent& event);
+
+    uint64_t getNumberOfEvents() const { return nbEvents_; }
+};
+
+/**
+ * @brief An event read back from a binary file.
+ */
+struct MafEventRecord
+{
+  std::string stage;
+  std::string name;
+  short level;
+  std::string format;
+  uint64_t nbSequences;
+  uint64_t nbSites;
+  std::vector<uint64_t> values;
+  std::string text;
+  bool hasText;
+
+  MafEventRecord(): stage(), name(), level(0), format(), nbSequences(0), nbSites(0), values(), text(), hasText(false) {}
+
+  /**
+   * @return The text version of the event, as a TextMafEventSink would have written it.
+   */
+  std::string toString() const;
+};
+
+/**
+ * @brief Read events written by a BinaryMafEventSink.
+ */
+class BinaryMafEventReader
+{
+  private:
+    struct Type_
+    {
+      std::string stage;
+      std::string name;
+      short level;
+      std::string format;
+      Type_(): stage(), name(), level(0), format() {}
+    };
+
+  private:
+    std::istream* input_;
+    std::vector<Type_> types_;
+
+  public:
+    /**
+     * @param input The input stream (not owned), opened in binary mode.
+     */
+    BinaryMafEventReader(std::istream* input);
+
+  private:
+    //Recopy is forbidden!
+    BinaryMafEventReader(const BinaryMafEventReader& reader);
+    BinaryMafEventReader& operator=(const BinaryMafEventReader& reader);
+
+  public:
+    /**
+     * @brief Read the next event.
+     *
+     * @param record [out] The event read.
+     * @return False if the end of the file was reached.
+     */
+    bool nextEvent(MafEventRecord& record);
+};
+
+} // end of namespace bpp.
+
+#endif //_MAFEVENTLOG_H_
@@ -0,0 +1,171 @@
+//
+// File: MafIndex.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "MafIndex.h"
+#include "MafParser.h"
+
+#include <Bpp/Text/TextTools.h>
+#include <Bpp/Text/StringTokenizer.h>
+
+using namespace bpp;
+
+//From the STL:
+#include <fstream>
+#include <algorithm>
+
+using namespace std;
+
+size_t MafIndex::getNumberOfBlocks() const
+{
+  size_t n = 0;
+  for (map<string, vector<Entry> >::const_iterator it = entries_.begin(); it != entries_.end(); ++it)
+    n += it->second.size();
+  return n;
+}
+
+vector<string> MafIndex::getChromosomes() const
+{
+  vector<string> chrs;
+  for (map<string, vector<Entry> >::const_iterator it = entries_.begin(); it != entries_.end(); ++it)
+    chrs.push_back(it->first);
+  return chrs;
+}
+
+void MafIndex::sort_()
+{
+  maxStops_.clear();
+  for (map<string, vector<Entry> >::iterator it = entries_.begin(); it != entries_.end(); ++it) {
+    vector<Entry>& entries = it->second;
+    std::sort(entries.begin(), entries.end());
+    vector<size_t>& maxStops = maxStops_[it->first];
+    maxStops.resize(entries.size());
+    size_t m = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+      m = max(m, entries[i].stop);
+      maxStops[i] = m;
+    }
+  }
+  sorted_ = true;
+}
+
+const vector<MafIndex::Entry>& MafIndex::getEntries(const std::string& chr)
+{
+  static const vector<Entry> empty;
+  if (!sorted_) sort_();
+  map<string, vector<Entry> >::const_iterator it = entries_.find(chr);
+  return (it == entries_.end() ? empty : it->second);
+}
+
+vector<uint64_t> MafIndex::getOffsets(const std::string& chr, size_t start, size_t stop)
+{
+  if (!sorted_) sort_();
+  vector<uint64_t> offsets;
+  map<string, vector<Entry> >::const_iterator it = entries_.find(chr);
+  if (it == entries_.end())
+    return offsets;
+  const vector<Entry>& entries = it->second;
+  const vector<size_t>& maxStops = maxStops_[chr];
+  //Blocks starting after the end of the region cannot overlap:
+  size_t last = static_cast<size_t>(upper_bound(entries.begin(), entries.end(), Entry(stop > 0 ? stop - 1 : 0, 0, UINT64_MAX)) - entries.begin());
+  //Blocks before the first one with a running maximum stop after the region start cannot overlap either:
+  size_t first = static_cast<size_t>(upper_bound(maxStops.begin(), maxStops.begin() + static_cast<ptrdiff_t>(last), start) - maxStops.begin());
+  for (size_t i = first; i < last; ++i) {
+    if (entries[i].stop > start && entries[i].start < stop)
+      offsets.push_back(entries[i].offset);
+  }
+  std::sort(offsets.begin(), offsets.end());
+  return offsets;
+}
+
+void MafIndex::write(const std::string& path) const
+{
+  ofstream out(path.c_str(), ios::out);
+  if (!out)
+    throw IOException("MafIndex::write(). Cannot open file " + path + " for writing.");
+  out << "##mafindex version=1 reference=" << refSpecies_ << endl;
+  for (map<string, vector<Entry> >::const_iterator it = entries_.begin(); it != entries_.end(); ++it) {
+    for (size_t i = 0; i < it->second.size(); ++i) {
+      const Entry& entry = it->second[i];
+      out << it->first << "\t" << entry.start << "\t" << entry.stop << "\t" << entry.offset << "\n";
+    }
+  }
+  if (!out)
+    throw IOException("MafIndex::write(). Error while writing file " + path + ".");
+}
+
+MafIndex* MafIndex::read(const std::string& path)
+{
+  ifstream in(path.c_str(), ios::in);
+  if (!in)
+    throw IOException("MafIndex::read(). Cannot open file " + path + ".");
+  string line;
+  getline(in, line);
+  string tag = "##mafindex version=1 reference=";
+  if (line.compare(0, tag.size(), tag) != 0)
+    throw IOException("MafIndex::read(). File " + path + " is not a valid MAF index.");
+  unique_ptr<MafIndex> index(new MafIndex(line.substr(tag.size())));
+  while (getline(in, line)) {
+    if (TextTools::isEmpty(line)) continue;
+    StringTokenizer st(line, "\t");
+    if (st.numberOfRemainingTokens() != 4)
+      throw IOException("MafIndex::read(). Invalid line in index file " + path + ": " + line);
+    string chr = st.nextToken();
+    size_t start = TextTools::to<size_t>(st.nextToken());
+    size_t stop = TextTools::to<size_t>(st.nextToken());
+    uint64_t offset = TextTools::to<uint64_t>(st.nextToken());
+    index->addBlock(chr, start, stop, offset);
+  }
+  return index.release();
+}
+
+MafIndex* MafIndex::build(MafParser& parser, const std::string& refSpecies)
+{
+  unique_ptr<MafIndex> index(new MafIndex(refSpecies));
+  while (MafBlock* block = parser.nextBlock()) {
+    if (block->hasSequenceForSpecies(refSpecies)) {
+      const MafSequence& seq = block->getSequenceForSpecies(refSpecies);
+      if (seq.hasCoordinates()) {
+        Range<size_t> range = seq.getRange(true);
+        index->addBlock(seq.getChromosome(), range.begin(), range.end(), parser.getCurrentBlockOffset());
+      }
+    }
+    parser.recycle(block);
+  }
+  return index.release();
+}
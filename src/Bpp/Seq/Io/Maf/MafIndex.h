@@ -0,0 +1,166 @@
+//
+// File: MafIndex.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _MAFINDEX_H_
+#define _MAFINDEX_H_
+
+#include <Bpp/Exceptions.h>
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+namespace bpp {
+
+class MafParser;
+
+/**
+ * @brief An index of the blocks of a MAF file, according to the coordinates of a reference species.
+ *
+ * For each block containing the reference species, the index stores the offset of the block
+ * in the file (as returned by the LineReader used for parsing, which is a BGZF virtual offset
+ * for BGZF files), together with the chromosome and coordinates of the reference sequence.
+ * Coordinates are always expressed on the positive strand of the reference.
+ *
+ * The index can be saved to a sidecar text file and loaded again later. It is then
+ * typically used with MafParser::selectRegion, to only parse blocks overlapping a region
+ * of interest.
+ */
+class MafIndex
+{
+  public:
+    struct Entry
+    {
+      size_t start;
+      size_t stop;
+      uint64_t offset;
+      Entry(size_t b = 0, size_t e = 0, uint64_t o = 0): start(b), stop(e), offset(o) {}
+      bool operator<(const Entry& entry) const { return start < entry.start || (start == entry.start && offset < entry.offset); }
+    };
+
+  private:
+    std::string refSpecies_;
+    std::map<std::string, std::vector<Entry> > entries_;
+    std::map<std::string, std::vector<size_t> > maxStops_; //Running maximum of stop positions, for overlap queries.
+    bool sorted_;
+
+  public:
+    /**
+     * @param refSpecies The species used as a reference for coordinates.
+     */
+    MafIndex(const std::string& refSpecies):
+      refSpecies_(refSpecies), entries_(), maxStops_(), sorted_(true) {}
+
+  public:
+    const std::string& getReferenceSpecies() const { return refSpecies_; }
+
+    /**
+     * @brief Add a block to the index.
+     *
+     * @param chr The chromosome of the reference sequence.
+     * @param start The start position of the reference sequence (0-based, included).
+     * @param stop The stop position of the reference sequence (0-based, excluded).
+     * @param offset The offset of the block in the file.
+     */
+    void addBlock(const std::string& chr, size_t start, size_t stop, uint64_t offset) {
+      entries_[chr].push_back(Entry(start, stop, offset));
+      sorted_ = false;
+    }
+
+    /**
+     * @return The total number of indexed blocks.
+     */
+    size_t getNumberOfBlocks() const;
+
+    std::vector<std::string> getChromosomes() const;
+
+    /**
+     * @brief Get all blocks indexed for a chromosome.
+     *
+     * @param chr The chromosome of the reference species.
+     * @return The blocks, sorted by start position (empty if the chromosome is not indexed).
+     */
+    const std::vector<Entry>& getEntries(const std::string& chr);
+
+    /**
+     * @brief Get the offsets of all blocks overlapping a given region.
+     *
+     * @param chr The chromosome of the reference species.
+     * @param start The beginning of the region (0-based, included).
+     * @param stop The end of the region (0-based, excluded).
+     * @return A vector of offsets, sorted in file order.
+     */
+    std::vector<uint64_t> getOffsets(const std::string& chr, size_t start, size_t stop);
+
+    /**
+     * @brief Write the index to a file.
+     */
+    void write(const std::string& path) const;
+
+    /**
+     * @brief Read an index from a file.
+     *
+     * @throw IOException If the file cannot be read or is not a valid index.
+     */
+    static MafIndex* read(const std::string& path);
+
+    /**
+     * @brief Build an index by parsing all blocks.
+     *
+     * Blocks are read from the current position of the parser and deleted after indexing.
+     * @param parser The parser to read blocks from.
+     * @param refSpecies The reference species.
+     * @return A new index object.
+     */
+    static MafIndex* build(MafParser& parser, const std::string& refSpecies);
+
+    /**
+     * @return The default name of the index file associated to a MAF file.
+     */
+    static std::string getDefaultIndexPath(const std::string& mafPath) { return mafPath + ".mai"; }
+
+  private:
+    void sort_();
+};
+
+} // end of namespace bpp.
+
+#endif //_MAFINDEX_H_
@@ -39,12 +39,15 @@ knowledge of the CeCILL license and that you accept its terms.
 
 #include "MafIterator.h"
 #include "IterationListener.h"
+#include "PipelineProfiler.h"
+#include "ProgressReporter.h"
 
 using namespace bpp;
 
 //From the STL:
 #include <string>
 #include <numeric>
+#include <algorithm>
 
 using namespace std;
 
@@ -60,9 +63,165 @@ void AbstractMafIterator::fireIterationMoveSignal_(const MafBlock& currentBlock)
   }
 }
 
+void AbstractMafIterator::fireIterationBatchMoveSignal_(const MafBlock* const* blocks, size_t nbBlocks) {
+  for (std::vector<IterationListener*>::iterator it = iterationListeners_.begin(); it != iterationListeners_.end(); ++it) {
+    (*it)->iterationMovesBatch(blocks, nbBlocks);
+  }
+}
+
 void AbstractMafIterator::fireIterationStopSignal_() {
   for (std::vector<IterationListener*>::iterator it = iterationListeners_.begin(); it != iterationListeners_.end(); ++it) {
     (*it)->iterationStops();
   }
 }
 
+size_t AbstractMafIterator::nextBlocks(vector<MafBlock*>& blocks, size_t maxNbBlocks)
+{
+  if (maxNbBlocks == 0)
+    return 0;
+  //Profiled stages measure each block:
+  if (profile_)
+    return MafIterator::nextBlocks(blocks, maxNbBlocks);
+  if (!started_) {
+    fireIterationStartSignal_();
+    started_ = true;
+  }
+  size_t first = blocks.size();
+  size_t nbBlocks = analyseCurrentBlocks_(blocks, maxNbBlocks);
+  if (monitorBuffers_) {
+    try {
+      updateBufferStatistics_();
+    } catch (...) {
+      for (size_t i = first; i < blocks.size(); ++i)
+        recycle(blocks[i]);
+      blocks.resize(first);
+      throw;
+    }
+  }
+  if (nbBlocks > 0)
+    fireIterationBatchMoveSignal_(&blocks[first], nbBlocks);
+  else
+    fireIterationStopSignal_();
+  return nbBlocks;
+}
+
+size_t AbstractMafIterator::analyseCurrentBlocks_(vector<MafBlock*>& blocks, size_t maxNbBlocks)
+{
+  size_t first = blocks.size();
+  while (blocks.size() - first < maxNbBlocks) {
+    MafBlock* block = analyseCurrentBlock_();
+    if (!block) break;
+    blocks.push_back(block);
+  }
+  return blocks.size() - first;
+}
+
+MafBlock* AbstractMafIterator::profileCurrentBlock_()
+{
+  return PipelineProfiler::run(*profile_, [this]() { return analyseCurrentBlock_(); });
+}
+
+void AbstractMafIterator::addBytesRead_(uint64_t nbBytes)
+{
+  profile_->bytesRead += nbBytes;
+}
+
+void AbstractMafIterator::addBytesWritten_(uint64_t nbBytes)
+{
+  profile_->bytesWritten += nbBytes;
+}
+
+void AbstractMafIterator::addProgressBytes_(uint64_t nbBytes)
+{
+  progress_->addBytes(nbBytes);
+}
+
+void AbstractMafIterator::updateBufferStatistics_()
+{
+  size_t nbBlocks = 0;
+  uint64_t nbBytes = 0;
+  getBufferContent_(nbBlocks, nbBytes);
+  bufferStatistics_.nbBlocks = nbBlocks;
+  bufferStatistics_.nbBytes = nbBytes;
+  bufferStatistics_.peakNbBlocks = max(bufferStatistics_.peakNbBlocks, nbBlocks);
+  bufferStatistics_.peakNbBytes = max(bufferStatistics_.peakNbBytes, nbBytes);
+  if (exceedsBufferLimits_(nbBlocks, nbBytes))
+    bufferLimitsExceeded_();
+}
+
+void AbstractMafIterator::bufferLimitsExceeded_()
+{
+  throw Exception("AbstractMafIterator::nextBlock. Buffer limits exceeded: " + TextTools::toString(bufferStatistics_.nbBlocks) + " blocks and "
+      + TextTools::toString(bufferStatistics_.nbBytes) + " bytes are buffered, the maximum being " + TextTools::toString(maxBufferedBlocks_)
+      + " blocks and " + TextTools::toString(maxBufferedBytes_) + " bytes (0 for no limit).");
+}
+
+void AbstractMafIterator::addBufferContent_(const deque<MafBlock*>& buffer, size_t& nbBlocks, uint64_t& nbBytes)
+{
+  for (size_t i = 0; i < buffer.size(); ++i) {
+    if (!buffer[i]) continue;
+    nbBlocks++;
+    nbBytes += buffer[i]->getMemorySize();
+  }
+}
+
+void AbstractMafIterator::addBufferContent_(const deque<MafBlockView>& buffer, size_t& nbBlocks, uint64_t& nbBytes)
+{
+  //Views of the same block are consecutive, and the parent block is only counted once:
+  const MafBlock* previous = 0;
+  for (size_t i = 0; i < buffer.size(); ++i) {
+    if (buffer[i].isEmpty()) continue;
+    nbBlocks++;
+    const MafBlock* parent = &buffer[i].getBlock();
+    if (parent != previous)
+      nbBytes += parent->getMemorySize();
+    previous = parent;
+  }
+}
+
+void AbstractFilterMafIterator::writeEvent_(const MafEventType& type, const MafBlock* block, initializer_list<uint64_t> values, const string* text)
+{
+  MafEvent event(type, block);
+  for (initializer_list<uint64_t>::const_iterator it = values.begin(); it != values.end() && event.nbValues < MafEvent::MAX_NB_VALUES; ++it)
+    event.values[event.nbValues++] = *it;
+  event.text = text;
+  if (eventSink_)
+    eventSink_->write(event);
+  else
+    (*logstream_ << event.toString()).endLine();
+}
+
+MafBlock* AbstractSplitMafIterator::analyseCurrentBlock_()
+{
+  if (viewBuffer_.size() == 0) {
+    MafBlock* block = splitNextBlock_();
+    if (block || viewBuffer_.size() == 0)
+      return block;
+  }
+  MafBlock* block = viewBuffer_.front().materialize();
+  viewBuffer_.pop_front();
+  return block;
+}
+
+bool AbstractSplitMafIterator::nextBlockView(MafBlockView& view)
+{
+  if (!started_) {
+    fireIterationStartSignal_();
+    started_ = true;
+  }
+  if (viewBuffer_.size() == 0) {
+    MafBlock* block = splitNextBlock_();
+    if (block) {
+      view = MafBlockView(block, this);
+      return true;
+    }
+    if (viewBuffer_.size() == 0) {
+      fireIterationStopSignal_();
+      return false;
+    }
+  }
+  view = viewBuffer_.front();
+  viewBuffer_.pop_front();
+  return true;
+}
+
@@ -41,16 +41,24 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _MAFITERATOR_H_
 
 #include "MafBlock.h"
+#include "MafBlockPool.h"
+#include "MafBlockView.h"
+#include "MafEventLog.h"
 
 //From the STL:
 #include <iostream>
 #include <string>
 #include <deque>
+#include <vector>
+#include <initializer_list>
+#include <cstdint>
 
 namespace bpp {
 
-//Forward declaration:
+//Forward declarations:
 class IterationListener;
+class ProgressReporter;
+struct MafStageProfile;
 
 /**
  * @brief Interface to loop over maf alignment blocks.
@@ -68,19 +76,94 @@ class MafIterator
      */
     virtual MafBlock* nextBlock() = 0;
 
+    /**
+     * @brief Get several alignment blocks at once.
+     *
+     * This amortizes the cost of virtual calls and iteration signals when blocks are small.
+     * The default implementation calls nextBlock() repeatedly.
+     *
+     * @param blocks [out] A vector where the blocks are appended. They are owned by the caller.
+     * @param maxNbBlocks The maximum number of blocks to retrieve.
+     * @return The number of blocks appended, which is 0 only if no more block is available (or maxNbBlocks is 0).
+     */
+    virtual size_t nextBlocks(std::vector<MafBlock*>& blocks, size_t maxNbBlocks) {
+      size_t first = blocks.size();
+      while (blocks.size() - first < maxNbBlocks) {
+        MafBlock* block = nextBlock();
+        if (!block) break;
+        blocks.push_back(block);
+      }
+      return blocks.size() - first;
+    }
+
     virtual bool isVerbose() const = 0;
     
     virtual void setVerbose(bool yn) = 0;
     
     virtual void addIterationListener(IterationListener* listener) = 0;
-    
+
+    /**
+     * @brief Give back a block which is not used anymore.
+     *
+     * This should be preferred to deleting the block, as its memory can then be reused.
+     * The default implementation sends the block to the default MafBlockPool.
+     * Filter iterators forward it to their input iterator.
+     *
+     * @param block The block to recycle (may be NULL).
+     */
+    virtual void recycle(MafBlock* block) { MafBlockPool::getDefaultPool().recycle(block); }
+
+    /**
+     * @brief Get the next available alignment block, as a read-only view.
+     *
+     * Iterators splitting blocks return slices of their input blocks, without copying any data.
+     * The default implementation returns a view of the complete next block.
+     * Iteration listeners are only notified of blocks obtained with nextBlock().
+     *
+     * @param view [out] The view of the next block.
+     * @return False if no more block is available, in which case the view is left unchanged.
+     */
+    virtual bool nextBlockView(MafBlockView& view) {
+      MafBlock* block = nextBlock();
+      if (!block) return false;
+      view = MafBlockView(block, this);
+      return true;
+    }
 
 };
 
+/**
+ * @brief Statistics on the blocks held in the internal buffers of an iterator.
+ *
+ * Sizes are estimated with MafBlock::getMemorySize(). Blocks shared by several views are counted once.
+ */
+struct MafBufferStatistics
+{
+  size_t nbBlocks;
+  size_t peakNbBlocks;
+  uint64_t nbBytes;
+  uint64_t peakNbBytes;
+
+  MafBufferStatistics(): nbBlocks(0), peakNbBlocks(0), nbBytes(0), peakNbBytes(0) {}
+};
+
 /**
  * @brief Partial implementation of the MafIterator interface.
  *
- * This implements the listener parts.
+ * This implements the listener parts, the optional profiling of calls to analyseCurrentBlock_()
+ * (see PipelineProfiler), and the monitoring of internal buffers.
+ *
+ * Batches of blocks retrieved with nextBlocks() are produced by analyseCurrentBlocks_(), which calls
+ * analyseCurrentBlock_() by default, and listeners are notified once per batch. Derived classes
+ * may override it to process a batch in a single pass. When the iterator is profiled, batches are
+ * made of individual calls to nextBlock(), so that each block is measured.
+ *
+ * When buffer monitoring is enabled, the content of the internal buffers of the iterator is measured
+ * after each block, and current and peak values are available through getBufferStatistics().
+ * Limits can be set on the number of buffered blocks and bytes. Iterators running their input
+ * on other threads (PrefetchMafIterator, ParallelMafIterator) stop reading ahead when limits are reached.
+ * Other iterators cannot apply backpressure, as they have to output a block, and throw an exception
+ * instead, so that memory exhaustion can be attributed to a given stage.
  */
 class AbstractMafIterator:
   public virtual MafIterator
@@ -89,9 +172,16 @@ class AbstractMafIterator:
     std::vector<IterationListener*> iterationListeners_;
     bool started_;
     bool verbose_;
+    MafStageProfile* profile_;
+    ProgressReporter* progress_;
+    bool monitorBuffers_;
+    MafBufferStatistics bufferStatistics_;
+    size_t maxBufferedBlocks_;
+    uint64_t maxBufferedBytes_;
 
   public:
-    AbstractMafIterator(): iterationListeners_(), started_(false), verbose_(true) {}
+    AbstractMafIterator(): iterationListeners_(), started_(false), verbose_(true), profile_(0), progress_(0),
+      monitorBuffers_(false), bufferStatistics_(), maxBufferedBlocks_(0), maxBufferedBytes_(0) {}
     
     virtual ~AbstractMafIterator() {}
 
@@ -105,23 +195,152 @@ class AbstractMafIterator:
         fireIterationStartSignal_();
         started_ = true;
       }
-      MafBlock* block = analyseCurrentBlock_();
+      MafBlock* block = (profile_ ? profileCurrentBlock_() : analyseCurrentBlock_());
+      if (monitorBuffers_) {
+        try {
+          updateBufferStatistics_();
+        } catch (...) {
+          //The block may be shared with, or owned by, the input iterator:
+          recycle(block);
+          throw;
+        }
+      }
       if (block)
         fireIterationMoveSignal_(*block);
       else
         fireIterationStopSignal_();
       return block;
     }
+
+    size_t nextBlocks(std::vector<MafBlock*>& blocks, size_t maxNbBlocks);
     
     bool isVerbose() const { return verbose_; }
     void setVerbose(bool yn) { verbose_ = yn; }
 
+    /**
+     * @brief Set the object in which statistics on this iterator are recorded.
+     *
+     * @param profile The profile, typically created by a PipelineProfiler (not owned). NULL disables profiling.
+     */
+    void setProfile(MafStageProfile* profile) { profile_ = profile; }
+    MafStageProfile* getProfile() const { return profile_; }
+
+    /**
+     * @brief Set the object to which the bytes read by this iterator are reported.
+     *
+     * In verbose mode, iterators with a progress reporter do not display their own per-block progress.
+     * @param progress The reporter, typically set by ProgressReporter::attach() (not owned). NULL disables reporting.
+     */
+    void setProgressReporter(ProgressReporter* progress) { progress_ = progress; }
+    ProgressReporter* getProgressReporter() const { return progress_; }
+
+    /**
+     * @brief Enable or disable the monitoring of internal buffers.
+     */
+    void monitorBuffers(bool yn) { monitorBuffers_ = yn; }
+    bool monitorBuffers() const { return monitorBuffers_; }
+
+    /**
+     * @return Current and peak content of the internal buffers, as measured after the last block.
+     */
+    const MafBufferStatistics& getBufferStatistics() const { return bufferStatistics_; }
+
+    /**
+     * @return The number of blocks currently held by the iterator between two calls to nextBlock().
+     */
+    size_t getNumberOfBufferedBlocks() const {
+      size_t nbBlocks = 0;
+      uint64_t nbBytes = 0;
+      getBufferContent_(nbBlocks, nbBytes);
+      return nbBlocks;
+    }
+
+    /**
+     * @brief Set limits on the content of internal buffers, and enable monitoring.
+     *
+     * Limits should be set before the iteration starts.
+     * @param maxBlocks The maximum number of buffered blocks (0 for no limit).
+     * @param maxBytes The maximum number of buffered bytes (0 for no limit).
+     */
+    void setBufferLimits(size_t maxBlocks, uint64_t maxBytes) {
+      maxBufferedBlocks_ = maxBlocks;
+      maxBufferedBytes_ = maxBytes;
+      monitorBuffers_ = true;
+    }
+    size_t getMaxBufferedBlocks() const { return maxBufferedBlocks_; }
+    uint64_t getMaxBufferedBytes() const { return maxBufferedBytes_; }
+
   protected:
     virtual MafBlock* analyseCurrentBlock_() = 0;
+
+    /**
+     * @brief Append at most maxNbBlocks blocks to a vector, and return their number.
+     *
+     * 0 must only be returned if no more block is available.
+     */
+    virtual size_t analyseCurrentBlocks_(std::vector<MafBlock*>& blocks, size_t maxNbBlocks);
+
     virtual void fireIterationStartSignal_();
     virtual void fireIterationMoveSignal_(const MafBlock& currentBlock);
+    virtual void fireIterationBatchMoveSignal_(const MafBlock* const* blocks, size_t nbBlocks);
     virtual void fireIterationStopSignal_();
 
+    /**
+     * @brief Record input or output bytes, if profiling is enabled.
+     */
+    void countBytesRead_(uint64_t nbBytes) {
+      if (profile_) addBytesRead_(nbBytes);
+      if (progress_) addProgressBytes_(nbBytes);
+    }
+    void countBytesWritten_(uint64_t nbBytes) { if (profile_) addBytesWritten_(nbBytes); }
+
+    /**
+     * @return True if per-block tasks should be displayed, that is, in verbose mode and without progress reporter.
+     */
+    bool displaysTasks_() const { return verbose_ && !progress_; }
+
+    /**
+     * @brief Display a gauge for step i out of n, at most a hundred times per task.
+     */
+    static void displayGauge_(size_t i, size_t n, char symbol) {
+      if (n < 100 || i % (n / 100) == 0 || i == n)
+        ApplicationTools::displayGauge(i, n, symbol);
+    }
+
+    /**
+     * @brief Measure the content of the internal buffers.
+     *
+     * Iterators keeping blocks between two calls to nextBlock() should add them to the counts.
+     * @param nbBlocks [in,out] The number of blocks.
+     * @param nbBytes [in,out] The number of bytes.
+     */
+    virtual void getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const {}
+
+    /**
+     * @brief Called when the content of the buffers has been measured and exceeds the limits.
+     *
+     * The default implementation throws an exception.
+     */
+    virtual void bufferLimitsExceeded_();
+
+    /**
+     * @return True if a buffer content exceeds the limits.
+     */
+    bool exceedsBufferLimits_(size_t nbBlocks, uint64_t nbBytes) const {
+      return (maxBufferedBlocks_ > 0 && nbBlocks > maxBufferedBlocks_) || (maxBufferedBytes_ > 0 && nbBytes > maxBufferedBytes_);
+    }
+
+    static void addBufferContent_(const std::deque<MafBlock*>& buffer, size_t& nbBlocks, uint64_t& nbBytes);
+    static void addBufferContent_(const std::deque<MafBlockView>& buffer, size_t& nbBlocks, uint64_t& nbBytes);
+
+  private:
+    void updateBufferStatistics_();
+
+    MafBlock* profileCurrentBlock_();
+    void addBytesRead_(uint64_t nbBytes);
+    void addBytesWritten_(uint64_t nbBytes);
+    void addProgressBytes_(uint64_t nbBytes);
+
 };
 
 /**
@@ -154,29 +373,182 @@ class AbstractFilterMafIterator:
     MafBlock* currentBlock_;
     std::shared_ptr<OutputStream> logstream_;
 
+  private:
+    std::shared_ptr<MafEventSink> eventSink_;
+    short eventLevel_;
+    size_t eventSampling_;
+    size_t eventCount_;
+
   public:
     AbstractFilterMafIterator(MafIterator* iterator) :
       AbstractMafIterator(),
       iterator_(iterator), currentBlock_(0),
-      logstream_(ApplicationTools::message) {}
+      logstream_(ApplicationTools::message),
+      eventSink_(), eventLevel_(MafEventType::LEVEL_DEBUG), eventSampling_(1), eventCount_(0) {}
 
   private:
     AbstractFilterMafIterator(const AbstractFilterMafIterator& it):
       AbstractMafIterator(it), 
       iterator_(it.iterator_), currentBlock_(0),
-      logstream_(it.logstream_) {}
+      logstream_(it.logstream_),
+      eventSink_(it.eventSink_), eventLevel_(it.eventLevel_), eventSampling_(it.eventSampling_), eventCount_(0) {}
 
     AbstractFilterMafIterator& operator=(const AbstractFilterMafIterator& it) {
       AbstractMafIterator::operator=(it);
       currentBlock_ = 0;
       iterator_  = it.iterator_;
       logstream_ = it.logstream_;
+      eventSink_ = it.eventSink_;
+      eventLevel_ = it.eventLevel_;
+      eventSampling_ = it.eventSampling_;
+      eventCount_ = 0;
       return *this;
     }
 
   public:
     void setLogStream(std::shared_ptr<OutputStream> logstream) { logstream_ = logstream; }
 
+    /**
+     * @brief Send the events of this stage to a sink.
+     *
+     * Events are formatted by the sink, if needed. Without a sink, events are formatted
+     * as text and written to the log stream, if any.
+     * @param sink The sink, which may be shared by several stages, or NULL.
+     */
+    void setEventSink(std::shared_ptr<MafEventSink> sink) { eventSink_ = sink; }
+    std::shared_ptr<MafEventSink> getEventSink() const { return eventSink_; }
+
+    /**
+     * @brief Set the minimum level of the events reported by this stage.
+     *
+     * @param level One of MafEventType::LEVEL_DEBUG (the default, all events), LEVEL_INFO or LEVEL_WARNING.
+     */
+    void setEventLevel(short level) { eventLevel_ = level; }
+    short getEventLevel() const { return eventLevel_; }
+
+    /**
+     * @brief Only report one event out of n, for events below the warning level.
+     */
+    void setEventSampling(size_t n) { eventSampling_ = (n == 0 ? 1 : n); }
+    size_t getEventSampling() const { return eventSampling_; }
+
+    /**
+     * @return The input iterator.
+     */
+    MafIterator* getInputIterator() { return iterator_; }
+
+    void recycle(MafBlock* block) {
+      if (iterator_)
+        iterator_->recycle(block);
+      else
+        MafBlockPool::getDefaultPool().recycle(block);
+    }
+
+  protected:
+    /**
+     * @return True if an event of the given type should be reported. Sampled events are counted.
+     */
+    bool logsEvent_(const MafEventType& type) {
+      if (!eventSink_ && !logstream_) return false;
+      if (type.level < eventLevel_) return false;
+      if (eventSampling_ > 1 && type.level < MafEventType::LEVEL_WARNING)
+        return (eventCount_++ % eventSampling_) == 0;
+      return true;
+    }
+
+    /**
+     * @brief Report an event, which is only formatted if needed.
+     *
+     * @param type The type of event.
+     * @param block The block to which the event refers, or NULL.
+     * @param values The numeric fields (at most MafEvent::MAX_NB_VALUES).
+     * @param text A text field, or NULL.
+     */
+    void logEvent_(const MafEventType& type, const MafBlock* block, std::initializer_list<uint64_t> values = {}, const std::string* text = 0) {
+      if (logsEvent_(type))
+        writeEvent_(type, block, values, text);
+    }
+
+    /**
+     * @brief Fill a batch with the input blocks accepted by a predicate.
+     *
+     * Input batches are requested until at least one block is accepted, or the input is exhausted.
+     * Rejected blocks are recycled.
+     *
+     * @param blocks [out] A vector where the blocks are appended.
+     * @param maxNbBlocks The maximum number of blocks to append.
+     * @param accept A function taking a MafBlock&, possibly modifying it, and returning true if it should be kept.
+     * @return The number of blocks appended.
+     */
+    template<class Predicate>
+    size_t filterBlocks_(std::vector<MafBlock*>& blocks, size_t maxNbBlocks, Predicate accept) {
+      size_t first = blocks.size();
+      while (blocks.size() == first) {
+        if (iterator_->nextBlocks(blocks, maxNbBlocks) == 0) break;
+        size_t j = first;
+        for (size_t i = first; i < blocks.size(); ++i) {
+          if (accept(*blocks[i]))
+            blocks[j++] = blocks[i];
+          else
+            recycle(blocks[i]);
+        }
+        blocks.resize(j);
+      }
+      return blocks.size() - first;
+    }
+
+  private:
+    void writeEvent_(const MafEventType& type, const MafBlock* block, std::initializer_list<uint64_t> values, const std::string* text);
+
+};
+
+
+/**
+ * @brief Helper class for developping filters which split blocks.
+ *
+ * Derived classes implement the splitNextBlock_() method, which either returns a block to output as is,
+ * or stores the pieces of a split block, as views, in the view buffer.
+ * Pieces are returned without copy by nextBlockView(), and are only materialized by nextBlock().
+ */
+class AbstractSplitMafIterator:
+  public AbstractFilterMafIterator
+{
+  protected:
+    std::deque<MafBlockView> viewBuffer_;
+
+  public:
+    AbstractSplitMafIterator(MafIterator* iterator) :
+      AbstractFilterMafIterator(iterator),
+      viewBuffer_() {}
+
+  private:
+    AbstractSplitMafIterator(const AbstractSplitMafIterator& it):
+      AbstractFilterMafIterator(0),
+      viewBuffer_() {}
+
+    AbstractSplitMafIterator& operator=(const AbstractSplitMafIterator& it) {
+      viewBuffer_.clear();
+      return *this;
+    }
+
+  public:
+    bool nextBlockView(MafBlockView& view);
+
+  protected:
+    void getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const {
+      addBufferContent_(viewBuffer_, nbBlocks, nbBytes);
+    }
+
+    /**
+     * @brief Analyse input blocks, until pieces are available in the view buffer or a block can be output as is.
+     *
+     * @return A block to output unchanged, or a null pointer if pieces were added to the view buffer or if there is no more block.
+     */
+    virtual MafBlock* splitNextBlock_() = 0;
+
+  private:
+    MafBlock* analyseCurrentBlock_();
+
 };
 
 
@@ -242,7 +614,7 @@ class MafIteratorSynchronizer:
       currentBlock_ = iterator_->nextBlock();
       MafBlock* secondBlock = secondaryIterator_->nextBlock();
       if (secondBlock)
-        delete secondBlock;
+        secondaryIterator_->recycle(secondBlock);
       return currentBlock_;
     }
 
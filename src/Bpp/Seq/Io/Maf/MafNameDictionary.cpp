@@ -0,0 +1,143 @@
+//
+// File: MafNameDictionary.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "MafNameDictionary.h"
+
+#include <Bpp/Exceptions.h>
+
+using namespace bpp;
+using namespace std;
+
+const size_t MafNameDictionary::NO_ID = static_cast<size_t>(-1);
+
+size_t MafNameDictionary::intern(const std::string& name)
+{
+  lock_guard<mutex> lock(mutex_);
+  unordered_map<string, size_t>::const_iterator it = ids_.find(name);
+  if (it != ids_.end())
+    return it->second;
+  size_t id = names_.size();
+  names_.push_back(name);
+  ids_[name] = id;
+  return id;
+}
+
+size_t MafNameDictionary::find(const std::string& name) const
+{
+  lock_guard<mutex> lock(mutex_);
+  unordered_map<string, size_t>::const_iterator it = ids_.find(name);
+  return it == ids_.end() ? NO_ID : it->second;
+}
+
+const std::string& MafNameDictionary::getName(size_t id) const
+{
+  lock_guard<mutex> lock(mutex_);
+  if (id >= names_.size())
+    throw IndexOutOfBoundsException("MafNameDictionary::getName.", id, 0, names_.size());
+  //References to deque elements remain valid when new names are added at the end: 
+  return names_[id];
+}
+
+std::vector<uint64_t> MafNameDictionary::getBitset(const std::vector<std::string>& names)
+{
+  vector<uint64_t> bits;
+  for (size_t i = 0; i < names.size(); ++i) {
+    size_t id = intern(names[i]);
+    if ((id >> 6) >= bits.size())
+      bits.resize((id >> 6) + 1, 0);
+    bits[id >> 6] |= static_cast<uint64_t>(1) << (id & 63);
+  }
+  return bits;
+}
+
+size_t MafNameDictionary::getNumberOfNames() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return names_.size();
+}
+
+MafNameDictionary& MafNameDictionary::species()
+{
+  static MafNameDictionary dict;
+  return dict;
+}
+
+MafNameDictionary& MafNameDictionary::chromosomes()
+{
+  static MafNameDictionary dict;
+  return dict;
+}
+
+static MafNameDictionary::SequenceName makeSequenceName(const string& species, const string& chr)
+{
+  MafNameDictionary::SequenceName parts;
+  parts.speciesId = MafNameDictionary::species().intern(species);
+  parts.chromosomeId = MafNameDictionary::chromosomes().intern(chr);
+  parts.species = &MafNameDictionary::species().getName(parts.speciesId);
+  parts.chromosome = &MafNameDictionary::chromosomes().getName(parts.chromosomeId);
+  return parts;
+}
+
+const MafNameDictionary::SequenceName& MafNameDictionary::splitSequenceName(const std::string& name)
+{
+  //Each thread first looks in its own cache, so that the shared table is only locked once per name and thread:
+  thread_local unordered_map<string, const SequenceName*> cache;
+  unordered_map<string, const SequenceName*>::const_iterator cached = cache.find(name);
+  if (cached != cache.end())
+    return *cached->second;
+  //Elements of an unordered_map are not moved when it grows:
+  static unordered_map<string, SequenceName> names;
+  static mutex namesMutex;
+  lock_guard<mutex> lock(namesMutex);
+  unordered_map<string, SequenceName>::const_iterator it = names.find(name);
+  if (it == names.end()) {
+    size_t pos = name.find(".");
+    if (pos == string::npos)
+      throw Exception("MafNameDictionary::splitSequenceName. Invalid sequence name: " + name);
+    it = names.insert(make_pair(name, makeSequenceName(name.substr(0, pos), name.substr(pos + 1)))).first;
+  }
+  cache[name] = &it->second;
+  return it->second;
+}
+
+const MafNameDictionary::SequenceName& MafNameDictionary::getEmptySequenceName()
+{
+  static const SequenceName parts = makeSequenceName("", "");
+  return parts;
+}
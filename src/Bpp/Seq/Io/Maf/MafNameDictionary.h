@@ -0,0 +1,156 @@
+//
+// File: MafNameDictionary.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _MAFNAMEDICTIONARY_H_
+#define _MAFNAMEDICTIONARY_H_
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief A process-wide dictionary of names (typically species names), associating each distinct name with a small integer ID.
+ *
+ * IDs are attributed in order of first use, and remain valid for the whole program.
+ * All methods are thread-safe.
+ */
+class MafNameDictionary
+{
+  public:
+    static const size_t NO_ID;
+
+    /**
+     * @brief The species and chromosome parts of a MAF sequence name, as interned strings.
+     *
+     * IDs are the ones of the species() and chromosomes() dictionaries.
+     * Pointers refer to the names stored in these dictionaries, and remain valid for the whole program.
+     */
+    struct SequenceName
+    {
+      size_t speciesId;
+      size_t chromosomeId;
+      const std::string* species;
+      const std::string* chromosome;
+    };
+
+  private:
+    std::deque<std::string> names_;
+    std::unordered_map<std::string, size_t> ids_;
+    mutable std::mutex mutex_;
+
+  public:
+    MafNameDictionary(): names_(), ids_(), mutex_() {}
+
+  private:
+    MafNameDictionary(const MafNameDictionary& dict);
+    MafNameDictionary& operator=(const MafNameDictionary& dict);
+
+  public:
+    /**
+     * @return The ID of the given name, creating a new one if needed.
+     */
+    size_t intern(const std::string& name);
+
+    /**
+     * @return The ID of the given name, or NO_ID if the name was never interned.
+     */
+    size_t find(const std::string& name) const;
+
+    /**
+     * @return The name corresponding to a given ID.
+     * @throw IndexOutOfBoundsException if the ID is not valid.
+     */
+    const std::string& getName(size_t id) const;
+
+    size_t getNumberOfNames() const;
+
+    /**
+     * @brief Build a set of names as a bit array indexed by ID, for constant-time membership tests.
+     *
+     * The names are interned if needed.
+     *
+     * @param names The names in the set.
+     * @return A bit array where the bits of the IDs of the given names are set.
+     */
+    std::vector<uint64_t> getBitset(const std::vector<std::string>& names);
+
+    /**
+     * @return True if the given ID is in a set built with getBitset(). NO_ID is never in a set.
+     */
+    static bool isInBitset(const std::vector<uint64_t>& bits, size_t id) {
+      return (id >> 6) < bits.size() && ((bits[id >> 6] >> (id & 63)) & 1);
+    }
+
+    /**
+     * @return The dictionary used for species names.
+     */
+    static MafNameDictionary& species();
+
+    /**
+     * @return The dictionary used for chromosome names.
+     */
+    static MafNameDictionary& chromosomes();
+
+    /**
+     * @brief Split a sequence name of the form "species.chromosome" into interned parts.
+     *
+     * Each distinct name is split only once. Further requests are answered by a lookup in a per-thread cache,
+     * so that the table shared by all threads is only locked the first time a thread sees a name.
+     *
+     * @param name The sequence name.
+     * @return The parts of the name.
+     * @throw Exception If the name does not contain a dot.
+     */
+    static const SequenceName& splitSequenceName(const std::string& name);
+
+    /**
+     * @return The parts of a sequence name which was not split, that is the empty species and chromosome names.
+     */
+    static const SequenceName& getEmptySequenceName();
+};
+
+} // end of namespace bpp.
+
+#endif //_MAFNAMEDICTIONARY_H_
@@ -42,55 +42,91 @@ knowledge of the CeCILL license and that you accept its terms.
 #include <Bpp/Seq/SequenceWithAnnotationTools.h>
 #include <Bpp/Text/TextTools.h>
 #include <Bpp/Text/KeyvalTools.h>
+#include <Bpp/Text/StringTokenizer.h>
+#include <Bpp/Seq/Alphabet/AlphabetExceptions.h>
 
 #include <algorithm>
 
 using namespace std;
 using namespace bpp;
 
+constexpr int MafParser::INVALID_STATE_;
+
+void MafParser::initCharTables_()
+{
+  const Alphabet* alpha = &AlphabetTools::DNA_ALPHABET;
+  charCodes_.assign(256, INVALID_STATE_);
+  maskedChars_.assign(256, 0);
+  for (int i = 0; i < 256; ++i) {
+    char c = static_cast<char>(i);
+    string str(1, c);
+    if (alpha->isCharInAlphabet(str))
+      charCodes_[i] = alpha->charToInt(str);
+    try {
+      maskedChars_[i] = cmAlphabet_.isMasked(c) ? 1 : 0;
+    } catch (Exception& e) {
+      maskedChars_[i] = 0;
+    }
+  }
+  if (dotOption_ == DOT_ASGAP) {
+    charCodes_[static_cast<unsigned char>('.')] = alpha->getGapCharacterCode();
+  }
+  if (dotOption_ == DOT_ASUNRES) {
+    charCodes_[static_cast<unsigned char>('.')] = alpha->charToInt("N");
+  }
+}
+
 MafBlock* MafParser::analyseCurrentBlock_()
 {
   MafBlock* block = 0;
 
-  string line;
+  TextSpan line;
   bool test = true;
   unique_ptr<MafSequence> currentSequence;
+
+  if (regionMode_) {
+    if (regionOffsets_.empty())
+      return 0;
+    seek(regionOffsets_.front());
+    regionOffsets_.pop_front();
+  }
   
   while (test)
   {
-    if (stream_->eof()) {
+    if (!reader_->nextLine(line)) {
+     inputDone_ = true;
      break;
     }
-    getline(*stream_, line, '\n');
-    if (TextTools::isEmpty(line))
+    countBytesRead_(line.size + 1);
+    if (line.isBlank())
     {
       if (firstBlock_)
         continue;
       if (currentSequence) {
         //Add previous sequence:
-        block->addSequence(*currentSequence); //The sequence is copied in the container.
-        currentSequence.reset();
+        block->addSequence(std::move(currentSequence)); //The sequence content is moved to the container.
       }
 
       //end of paragraph
       test = false;
+      nextBlockOffset_ = reader_->getLineOffset();
     }
     else if (line[0] == 'a')
     {
       if (currentSequence) {
         //Add previous sequence:
-        block->addSequence(*currentSequence); //The sequence is copied in the container.
-        currentSequence.reset();
+        block->addSequence(std::move(currentSequence)); //The sequence content is moved to the container.
       }
       
       //New block.
-      block = new MafBlock();
+      block = pool_->getBlock();
       firstBlock_ = false;
+      blockOffset_ = reader_->getLineOffset();
 
       map<string, string> args;
-      if (line.size() > 2)
+      if (line.size > 2)
       {
-        KeyvalTools::multipleKeyvals(line.substr(2), args, " ");
+        KeyvalTools::multipleKeyvals(line.substr(2).toString(), args, " ");
 
         if (args.find("score") != args.end())
           if (args["score"] != "NA")
@@ -102,75 +138,19 @@ MafBlock* MafParser::analyseCurrentBlock_()
     }
     else if (line[0] == 's')
     {
-      StringTokenizer st(line);
-      st.nextToken(); //The 's' tag
-      string src = st.nextToken();
-      unsigned int start = TextTools::to<unsigned int>(st.nextToken());
-      unsigned int size = TextTools::to<unsigned int>(st.nextToken());
-      string tmp = st.nextToken();
-      if (tmp.size() != 1)
-        throw Exception("MafAlignmentParser::nextBlock. Strand specification is incorrect, should be only one character long, found " + TextTools::toString(tmp.size()) + ".");
-      char strand = tmp[0];
-
-      unsigned int srcSize = TextTools::to<unsigned int>(st.nextToken());
+      if (!block)
+        throw Exception("MafAlignmentParser::nextBlock. Sequence found outside of a block!");
       if (currentSequence) {
         //Add previous sequence:
-        block->addSequence(*currentSequence); //The sequence is copied in the container.
-        currentSequence.reset();
-      }
-      string seq = st.nextToken();
-      if (dotOption_ == DOT_ASGAP) {
-        std::replace(seq.begin(), seq.end(), '.', '-');
-      }
-      if (dotOption_ == DOT_ASUNRES) {
-        std::replace(seq.begin(), seq.end(), '.', 'N');
-      }
-      currentSequence.reset(new MafSequence(src, seq, start, strand, srcSize));
-      if (currentSequence->getGenomicSize() != size) {
-        if (checkSequenceSize_)
-          throw Exception("MafAlignmentParser::nextBlock. Sequence found (" + src + ") does not match specified size: " + TextTools::toString(currentSequence->getGenomicSize()) + ", should be " + TextTools::toString(size) + ".");
-        else {
-          if (verbose_) {
-            ApplicationTools::displayWarning("MafAlignmentParser::nextBlock. Sequence found (" + src + ") does not match specified size: " + TextTools::toString(currentSequence->getGenomicSize()) + ", should be " + TextTools::toString(size) + ".");
-          }
-        }
-      }
-      //Add mask:
-      if (mask_) {
-        vector<bool> mask(currentSequence->size());
-        for (size_t i = 0; i < mask.size(); ++i) {
-          mask[i] = cmAlphabet_.isMasked(seq[i]);
-        }
-        currentSequence->addAnnotation(new SequenceMask(mask));
+        block->addSequence(std::move(currentSequence)); //The sequence content is moved to the container.
       }
+      parseSequenceLine_(line, currentSequence);
     }
     else if (line[0] == 'q')
     {
       if (!currentSequence)
         throw Exception("MafAlignmentParser::nextBlock(). Quality scores found, but there is currently no sequence!");
-      StringTokenizer st(line);
-      st.nextToken(); //The 'q' tag
-      string name = st.nextToken();
-      if (name != currentSequence->getName())
-        throw Exception("MafAlignmentParser::nextBlock(). Quality scores found, but with a different name from the previous sequence: " + name + ", should be " + currentSequence->getName() + ".");
-      string qstr = st.nextToken();
-      //Now parse the score string:
-      SequenceQuality* seqQual = new SequenceQuality(qstr.size());
-      for (size_t i = 0; i < qstr.size(); ++i) {
-        char c = qstr[i];
-        if (c == '-') {
-          seqQual->setScore(i, -1);
-        } else if (c == '0' || c == '1' || c == '2' || c== '3' || c == '4' || c == '5' || c == '6' || c == '7' || c == '8' || c == '9') {
-          seqQual->setScore(i, c - '0');
-        } else if (c == 'F' || c == 'f') { //Finished
-          seqQual->setScore(i, 10);
-        } else if (c == '?' || c == '.') {
-          seqQual->setScore(i, -2);
-        } else {
-          throw Exception("MafAlignmentParser::nextBlock(). Unvalid quality score: " + TextTools::toString(c) + ". Should be 0-9, F or '-'.");
-        }
-      }
-      currentSequence->addAnnotation(seqQual);
+      parseQualityLine_(line, *currentSequence);
     }
   }
   //// Final check and passing by results
@@ -178,11 +158,147 @@ MafBlock* MafParser::analyseCurrentBlock_()
   //In case last line in not empty:
   if (currentSequence) {
     //Add previous sequence:
-    block->addSequence(*currentSequence); //The sequence is copied in the container.
-    currentSequence.reset();
+    block->addSequence(std::move(currentSequence)); //The sequence content is moved to the container.
   }
   
   //Returning block:
   return block;
 }
 
+size_t MafParser::analyseCurrentBlocks_(vector<MafBlock*>& blocks, size_t maxNbBlocks)
+{
+  size_t first = blocks.size();
+  while (blocks.size() - first < maxNbBlocks) {
+    //Non virtual call:
+    MafBlock* block = MafParser::analyseCurrentBlock_();
+    if (!block) break;
+    blocks.push_back(block);
+  }
+  return blocks.size() - first;
+}
+
+void MafParser::saveState(MafCheckpoint& checkpoint, const string& prefix)
+{
+  if (regionMode_) {
+    string offsets;
+    for (size_t i = 0; i < regionOffsets_.size(); ++i) {
+      if (i > 0) offsets += ',';
+      offsets += TextTools::toString(regionOffsets_[i]);
+    }
+    checkpoint.setValue(prefix + "regions", offsets);
+  } else if (inputDone_) {
+    checkpoint.setValue(prefix + "end", "1");
+  } else {
+    checkpoint.setValue(prefix + "offset", nextBlockOffset_);
+  }
+}
+
+void MafParser::restoreState(const MafCheckpoint& checkpoint, const string& prefix)
+{
+  if (checkpoint.hasValue(prefix + "regions")) {
+    vector<uint64_t> offsets;
+    StringTokenizer st(checkpoint.getValue(prefix + "regions"), ",");
+    while (st.hasMoreToken())
+      offsets.push_back(TextTools::to<uint64_t>(st.nextToken()));
+    selectBlocks(offsets);
+  } else if (checkpoint.hasValue(prefix + "end")) {
+    //Nothing left to read:
+    selectBlocks(vector<uint64_t>());
+  } else {
+    if (!reader_->isSeekable())
+      throw Exception("MafParser::restoreState(). The input does not support random access.");
+    seek(checkpoint.getUIntValue(prefix + "offset"));
+  }
+}
+
+void MafParser::parseSequenceLine_(const TextSpan& line, unique_ptr<MafSequence>& currentSequence)
+{
+  size_t pos = 1; //Skip the 's' tag
+  TextSpan src, startStr, sizeStr, strandStr, srcSizeStr, seq;
+  if (!(line.nextToken(pos, src) &&
+        line.nextToken(pos, startStr) &&
+        line.nextToken(pos, sizeStr) &&
+        line.nextToken(pos, strandStr) &&
+        line.nextToken(pos, srcSizeStr) &&
+        line.nextToken(pos, seq)))
+    throw Exception("MafAlignmentParser::nextBlock. Incomplete sequence line: " + line.toString());
+  size_t start = static_cast<size_t>(startStr.toUnsignedInteger());
+  size_t size = static_cast<size_t>(sizeStr.toUnsignedInteger());
+  if (strandStr.size != 1)
+    throw Exception("MafAlignmentParser::nextBlock. Strand specification is incorrect, should be only one character long, found " + TextTools::toString(strandStr.size) + ".");
+  char strand = strandStr[0];
+  size_t srcSize = static_cast<size_t>(srcSizeStr.toUnsignedInteger());
+
+  //Encode the sequence directly from the input buffer, in a single pass computing states, mask bits and the number of residues.
+  //Dots are translated by the character table. The loop has no branch, so that it can be vectorized:
+  vector<int> content = pool_->getBuffer(); //Reuse memory when possible.
+  content.resize(seq.size);
+  vector<uint64_t> bits(mask_ ? BitTools::getNumberOfWords(seq.size) : 0, 0);
+  const unsigned char* chars = reinterpret_cast<const unsigned char*>(seq.data);
+  const int* codes = &charCodes_[0];
+  const char* masked = &maskedChars_[0];
+  int minState = 0;
+  size_t nbResidues = 0;
+  for (size_t begin = 0; begin < seq.size; begin += 64) {
+    size_t end = min(begin + 64, seq.size);
+    uint64_t word = 0;
+    for (size_t i = begin; i < end; ++i) {
+      int state = codes[chars[i]];
+      content[i] = state;
+      minState = min(minState, state);
+      nbResidues += static_cast<size_t>(state >= 0);
+      word |= static_cast<uint64_t>(masked[chars[i]]) << (i - begin);
+    }
+    if (mask_)
+      bits[begin / 64] = word;
+  }
+  if (minState == INVALID_STATE_) {
+    size_t i = 0;
+    while (content[i] != INVALID_STATE_) ++i;
+    throw BadCharException(string(1, seq[i]), "MafAlignmentParser::nextBlock. Invalid character in sequence " + src.toString() + ".", &AlphabetTools::DNA_ALPHABET);
+  }
+  string name = src.toString();
+  currentSequence.reset(new MafSequence(name, std::move(content), start, strand, srcSize, nbResidues));
+  if (currentSequence->getGenomicSize() != size) {
+    if (checkSequenceSize_)
+      throw Exception("MafAlignmentParser::nextBlock. Sequence found (" + name + ") does not match specified size: " + TextTools::toString(currentSequence->getGenomicSize()) + ", should be " + TextTools::toString(size) + ".");
+    else {
+      if (verbose_) {
+        ApplicationTools::displayWarning("MafAlignmentParser::nextBlock. Sequence found (" + name + ") does not match specified size: " + TextTools::toString(currentSequence->getGenomicSize()) + ", should be " + TextTools::toString(size) + ".");
+      }
+    }
+  }
+  //Add mask:
+  if (mask_) {
+    if (lazyAnnotations_) {
+      currentSequence->setLazyMask(std::move(bits));
+    } else {
+      vector<bool> mask(seq.size);
+      for (size_t i = 0; i < mask.size(); ++i) {
+        mask[i] = BitTools::getBit(bits, i);
+      }
+      currentSequence->addAnnotation(new SequenceMask(mask));
+    }
+  }
+}
+
+void MafParser::parseQualityLine_(const TextSpan& line, MafSequence& currentSequence)
+{
+  size_t pos = 1; //Skip the 'q' tag
+  TextSpan name, qstr;
+  if (!(line.nextToken(pos, name) && line.nextToken(pos, qstr)))
+    throw Exception("MafAlignmentParser::nextBlock(). Incomplete quality line: " + line.toString());
+  if (!(name == currentSequence.getName()))
+    throw Exception("MafAlignmentParser::nextBlock(). Quality scores found, but with a different name from the previous sequence: " + name.toString() + ", should be " + currentSequence.getName() + ".");
+  //Now parse the score string:
+  vector<int> scores(lazyAnnotations_ ? 0 : qstr.size);
+  for (size_t i = 0; i < qstr.size; ++i) {
+    int score = MafSequence::decodeQualityChar(qstr[i]); //Also checks the validity of the score.
+    if (!lazyAnnotations_)
+      scores[i] = score;
+  }
+  if (lazyAnnotations_)
+    currentSequence.setLazyQuality(qstr.toString());
+  else
+    currentSequence.addAnnotation(new SequenceQuality(scores));
+}
@@ -41,10 +41,17 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _MAFPARSER_H_
 
 #include "MafIterator.h"
+#include "../LineReader.h"
+#include "../CompressedInput.h"
+#include "MafIndex.h"
+#include "MafCheckpoint.h"
 #include <Bpp/Seq/Alphabet/CaseMaskedAlphabet.h>
 
 //From the STL:
 #include <iostream>
+#include <memory>
+#include <vector>
+#include <deque>
 
 namespace bpp {
 
@@ -56,18 +63,38 @@ namespace bpp {
  * The MAF format is documented on the UCSC Genome Browser website:
  * <a href="http://genome.ucsc.edu/FAQ/FAQformat.html#format5">http://genome.ucsc.edu/FAQ/FAQformat.html#format5</a>
  *
+ * Input is read through a LineReader object, and lines are scanned in place
+ * without intermediate string copies. Sequence characters are encoded directly
+ * into their final integer states. Reading from a memory-mapped file (see
+ * MappedFileLineReader) avoids all copies of the input text. Gzip and BGZF
+ * compressed files can be read with a CompressedLineReader, BGZF blocks being
+ * decompressed ahead of the parser on several threads:
+ * @code
+ * MafParser parser(new CompressedLineReader("alignment.maf.gz"));
+ * @endcode
+ *
  * @author Julien Dutheil
  */
 class MafParser:
-  public AbstractMafIterator
+  public AbstractMafIterator,
+  public virtual CheckpointableMafIterator
 {
   private:
-    std::istream* stream_;
+    std::unique_ptr<LineReader> reader_;
     bool mask_;
+    bool lazyAnnotations_;
     bool checkSequenceSize_;
     CaseMaskedAlphabet cmAlphabet_;
     bool firstBlock_;
     short dotOption_;
+    std::vector<int> charCodes_;
+    std::vector<char> maskedChars_;
+    uint64_t blockOffset_;
+    uint64_t nextBlockOffset_;
+    bool inputDone_;
+    bool regionMode_;
+    std::deque<uint64_t> regionOffsets_;
+    MafBlockPool* pool_;
 
   public:
     /**
@@ -86,27 +113,165 @@ class MafParser:
      *        will increase parsing time.
      */
     MafParser(std::istream* stream, bool parseMask = false, bool checkSize = true, short dotOption = DOT_ERROR) :
-      stream_(stream), mask_(parseMask), checkSequenceSize_(checkSize), cmAlphabet_(&AlphabetTools::DNA_ALPHABET),
-      firstBlock_(true), dotOption_(dotOption) {}
+      reader_(new StreamLineReader(stream)), mask_(parseMask), lazyAnnotations_(false), checkSequenceSize_(checkSize), cmAlphabet_(&AlphabetTools::DNA_ALPHABET),
+      firstBlock_(true), dotOption_(dotOption), charCodes_(), maskedChars_(),
+      blockOffset_(0), nextBlockOffset_(0), inputDone_(false), regionMode_(false), regionOffsets_(), pool_(&MafBlockPool::getDefaultPool())
+    {
+      initCharTables_();
+    }
+
+    /**
+     * @brief Create a new instance of MafParser reading from a LineReader object.
+     *
+     * For instance, the following code parses a file without copying its content,
+     * using a memory mapping:
+     * @code
+     * MafParser parser(new MappedFileLineReader("alignment.maf"));
+     * @endcode
+     *
+     * @param reader The line reader to use. It will be owned by the parser and destroyed with it.
+     * @param parseMask Tell is masking (lower case) should be kept
+     * @param checkSize Tell if the size of sequence found should be
+     *        compared to the specified one.
+     * @param dotOption (one of DOT_ERROR, DOT_ASGAP or DOT_ASUNRES)
+     *        tells how dot should be treated.
+     * @see The constructor on an input stream for a full description of the options.
+     */
+    MafParser(LineReader* reader, bool parseMask = false, bool checkSize = true, short dotOption = DOT_ERROR) :
+      reader_(reader), mask_(parseMask), lazyAnnotations_(false), checkSequenceSize_(checkSize), cmAlphabet_(&AlphabetTools::DNA_ALPHABET),
+      firstBlock_(true), dotOption_(dotOption), charCodes_(), maskedChars_(),
+      blockOffset_(0), nextBlockOffset_(0), inputDone_(false), regionMode_(false), regionOffsets_(), pool_(&MafBlockPool::getDefaultPool())
+    {
+      if (!reader)
+        throw NullPointerException("MafParser (constructor). Line reader should not be a NULL pointer!");
+      initCharTables_();
+    }
 
   private:
     //Recopy is forbidden!
     MafParser(const MafParser& maf):
-      stream_(0), mask_(maf.mask_), checkSequenceSize_(maf.checkSequenceSize_),
+      reader_(), mask_(maf.mask_), lazyAnnotations_(maf.lazyAnnotations_), checkSequenceSize_(maf.checkSequenceSize_),
       cmAlphabet_(&AlphabetTools::DNA_ALPHABET), firstBlock_(maf.firstBlock_),
-      dotOption_(maf.dotOption_) {}
+      dotOption_(maf.dotOption_), charCodes_(maf.charCodes_), maskedChars_(maf.maskedChars_),
+      blockOffset_(maf.blockOffset_), nextBlockOffset_(maf.nextBlockOffset_), inputDone_(maf.inputDone_), regionMode_(maf.regionMode_), regionOffsets_(maf.regionOffsets_), pool_(maf.pool_) {}
 
     MafParser& operator=(const MafParser& maf) {
-      stream_ = 0;
+      reader_.reset();
       mask_ = maf.mask_;
+      lazyAnnotations_ = maf.lazyAnnotations_;
       checkSequenceSize_ = maf.checkSequenceSize_;
       firstBlock_ = maf.firstBlock_;
       dotOption_ = maf.dotOption_;
+      charCodes_ = maf.charCodes_;
+      maskedChars_ = maf.maskedChars_;
+      blockOffset_ = maf.blockOffset_;
+      nextBlockOffset_ = maf.nextBlockOffset_;
+      inputDone_ = maf.inputDone_;
+      regionMode_ = maf.regionMode_;
+      regionOffsets_ = maf.regionOffsets_;
+      pool_ = maf.pool_;
       return *this;
     }
 
+  public:
+    /**
+     * @brief Enable or disable lazy annotations.
+     *
+     * In lazy mode, masking information and quality scores are stored in the sequences in a compact, raw form,
+     * and only converted to SequenceMask and SequenceQuality annotations when first accessed (see MafSequence).
+     * This saves time and memory when annotations are not used, or only used by a few stages.
+     * Lazy annotations are disabled by default.
+     */
+    void setLazyAnnotations(bool yn) { lazyAnnotations_ = yn; }
+
+    bool lazyAnnotations() const { return lazyAnnotations_; }
+
+    /**
+     * @brief Set the pool used to allocate blocks and sequence buffers.
+     *
+     * By default, MafBlockPool::getDefaultPool() is used.
+     * @param pool The pool to use. It is not owned by the parser.
+     */
+    void setBlockPool(MafBlockPool* pool) {
+      if (!pool)
+        throw NullPointerException("MafParser::setBlockPool. Pool should not be a NULL pointer!");
+      pool_ = pool;
+    }
+
+    void recycle(MafBlock* block) { pool_->recycle(block); }
+
+    /**
+     * @return The offset in the input of the last block returned, as given by the underlying LineReader.
+     */
+    uint64_t getCurrentBlockOffset() const { return blockOffset_; }
+
+    /**
+     * @return True if the input supports random access.
+     */
+    bool isSeekable() const { return reader_->isSeekable(); }
+
+    /**
+     * @brief Move the parser to a given offset, which must point to the beginning of a block.
+     *
+     * @param offset An offset, typically obtained with getCurrentBlockOffset() or from a MafIndex.
+     * @throw Exception If the input does not support random access.
+     */
+    void seek(uint64_t offset) {
+      reader_->seek(offset);
+      firstBlock_ = true;
+      nextBlockOffset_ = offset;
+      inputDone_ = false;
+    }
+
+    /**
+     * @brief Restrict parsing to the blocks overlapping a region of the reference species of an index.
+     *
+     * Subsequent calls to nextBlock() will directly seek to each selected block, in file order,
+     * and return 0 once all blocks have been read.
+     *
+     * @param index The index of the input file.
+     * @param chr The chromosome of the reference species.
+     * @param start The beginning of the region (0-based, included).
+     * @param stop The end of the region (0-based, excluded).
+     */
+    void selectRegion(MafIndex& index, const std::string& chr, size_t start, size_t stop) {
+      if (!reader_->isSeekable())
+        throw Exception("MafParser::selectRegion(). The input does not support random access.");
+      selectBlocks(index.getOffsets(chr, start, stop));
+    }
+
+    /**
+     * @brief Restrict parsing to the blocks starting at given offsets.
+     *
+     * Subsequent calls to nextBlock() will directly seek to each block, in the given order,
+     * and return 0 once all blocks have been read.
+     *
+     * @param offsets The offsets of the blocks in the file, typically obtained from a MafIndex.
+     */
+    void selectBlocks(const std::vector<uint64_t>& offsets) {
+      if (!reader_->isSeekable())
+        throw Exception("MafParser::selectBlocks(). The input does not support random access.");
+      regionOffsets_.assign(offsets.begin(), offsets.end());
+      regionMode_ = true;
+    }
+
+    /**
+     * @brief Save the position after the last block returned, or the blocks remaining to be read in region mode.
+     */
+    void saveState(MafCheckpoint& checkpoint, const std::string& prefix);
+    void restoreState(const MafCheckpoint& checkpoint, const std::string& prefix);
+
   private:
     MafBlock* analyseCurrentBlock_();
+    size_t analyseCurrentBlocks_(std::vector<MafBlock*>& blocks, size_t maxNbBlocks);
+
+    /**
+     * @brief Build the character to state and masking lookup tables, according to the dot option.
+     */
+    void initCharTables_();
+
+    void parseSequenceLine_(const TextSpan& line, std::unique_ptr<MafSequence>& currentSequence);
+    void parseQualityLine_(const TextSpan& line, MafSequence& currentSequence);
 
   public:
     static constexpr short DOT_ERROR = 0;
@@ -114,6 +279,9 @@ class MafParser:
     static constexpr short DOT_ASUNRES = 2;
     //static constexpr short DOT_RESOLVE = 3; // not yet supported
 
+  private:
+    static constexpr int INVALID_STATE_ = -1000;
+
 };
 
 } // end of namespace bpp.
@@ -0,0 +1,92 @@
+//
+// File: MafPropertyKey.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "MafPropertyKey.h"
+
+#include <Bpp/Exceptions.h>
+
+//From the STL:
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+
+using namespace bpp;
+using namespace std;
+
+namespace {
+  struct KeyRegistry
+  {
+    unordered_map<string, size_t> slots;
+    vector<const type_info*> types;
+    mutex lock;
+
+    KeyRegistry(): slots(), types(), lock() {}
+  };
+
+  KeyRegistry& getRegistry()
+  {
+    static KeyRegistry registry;
+    return registry;
+  }
+}
+
+MafPropertyKeyBase::MafPropertyKeyBase(const string& name, const type_info& type, bool cache):
+  name_(name), slot_(0), cache_(cache)
+{
+  KeyRegistry& registry = getRegistry();
+  lock_guard<mutex> lock(registry.lock);
+  unordered_map<string, size_t>::const_iterator it = registry.slots.find(name);
+  if (it != registry.slots.end()) {
+    if (*registry.types[it->second] != type)
+      throw Exception("MafPropertyKeyBase (constructor). Property " + name + " is already registered with another type.");
+    slot_ = it->second;
+  } else {
+    slot_ = registry.types.size();
+    registry.types.push_back(&type);
+    registry.slots[name] = slot_;
+  }
+}
+
+size_t MafPropertyKeyBase::getNumberOfSlots()
+{
+  KeyRegistry& registry = getRegistry();
+  lock_guard<mutex> lock(registry.lock);
+  return registry.types.size();
+}
+
@@ -0,0 +1,136 @@
+//
+// File: MafPropertyKey.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _MAFPROPERTYKEY_H_
+#define _MAFPROPERTYKEY_H_
+
+//From the STL:
+#include <string>
+#include <typeinfo>
+
+namespace bpp {
+
+class MafBlock;
+
+/**
+ * @brief The untyped part of a block property key.
+ *
+ * Each distinct property name is associated with a small integer slot, once and for all, when the first key with
+ * this name is created. Keys with the same name must have the same value type.
+ * Registration is thread-safe.
+ */
+class MafPropertyKeyBase
+{
+  private:
+    std::string name_;
+    size_t slot_;
+    bool cache_;
+
+  protected:
+    MafPropertyKeyBase(const std::string& name, const std::type_info& type, bool cache);
+
+  public:
+    virtual ~MafPropertyKeyBase() {}
+
+  public:
+    const std::string& getName() const { return name_; }
+
+    /**
+     * @return The slot index of this property in blocks.
+     */
+    size_t getSlot() const { return slot_; }
+
+    /**
+     * @return True if the property is a cache, computed from the block content. Caches are discarded when the
+     * block is modified, and are not kept by copies unless requested.
+     */
+    bool isCache() const { return cache_; }
+
+    /**
+     * @return The number of property slots registered so far.
+     */
+    static size_t getNumberOfSlots();
+};
+
+/**
+ * @brief A typed key for fast block properties.
+ *
+ * Properties accessed with a key are stored in a vector of slots in each block, and retrieved with a constant time
+ * lookup and no dynamic cast, as opposed to string-keyed properties (see MafBlock::getProperty).
+ * Keys are typically static objects, created once by the iterator or statistics using them:
+ * @code
+ * static const MafPropertyKey<GapIndex> GAP_INDEX("GapIndex", true, &GapIndex::compute);
+ * const GapIndex& index = block.getProperty(GAP_INDEX);
+ * @endcode
+ *
+ * A key can have a compute function, which is used to create the property on first access when it is not set.
+ * The block takes ownership of the returned object. Like column counts, lazily computed properties are created
+ * in const methods, which makes concurrent access to the same block not thread-safe.
+ *
+ * @tparam T The type of the property value. It does not need to be clonable, as copies of a block share property values.
+ */
+template<class T>
+class MafPropertyKey:
+  public MafPropertyKeyBase
+{
+  public:
+    typedef T* (*ComputeFunction)(const MafBlock&);
+
+  private:
+    ComputeFunction compute_;
+
+  public:
+    /**
+     * @param name The name of the property.
+     * @param cache Tell if the property is a cache, computed from the block content.
+     * @param function A function creating the property for a given block, or NULL if the property has to be set explicitly.
+     */
+    MafPropertyKey(const std::string& name, bool cache = false, ComputeFunction function = 0):
+      MafPropertyKeyBase(name, typeid(T), cache), compute_(function)
+    {}
+
+  public:
+    bool canCompute() const { return compute_ != 0; }
+
+    T* compute(const MafBlock& block) const { return compute_(block); }
+};
+
+} // end of namespace bpp.
+
+#endif //_MAFPROPERTYKEY_H_
@@ -39,29 +39,255 @@ knowledge of the CeCILL license and that you accept its terms.
 
 #include "MafSequence.h"
 
+#include <Bpp/Seq/SequenceWithQuality.h>
+#include <Bpp/Seq/SequenceWithAnnotationTools.h>
+
 //From the STL:
 #include <string>
+#include <algorithm>
 
 using namespace bpp;
 using namespace std;
 
+size_t MafSequence::getMemorySize() const
+{
+  size_t size = sizeof(MafSequence) + content_.capacity() * sizeof(int)
+    + getName().capacity()
+    + lazyMask_.capacity() * sizeof(uint64_t) + lazyQuality_.capacity();
+  if (residueIndex_)
+    size += residueIndex_->getMemorySize();
+  //Materialized annotations, not counting lazy ones:
+  if (SequenceWithAnnotation::hasAnnotation(SequenceMask::MASK))
+    size += content_.size() / 8;
+  if (SequenceWithAnnotation::hasAnnotation(SequenceQuality::QUALITY_SCORE))
+    size += content_.size() * sizeof(int);
+  return size;
+}
+
 MafSequence* MafSequence::subSequence(size_t startAt, size_t length) const
 {
-  string subseq = toString().substr(startAt, length);
+  if (startAt > size())
+    throw IndexOutOfBoundsException("MafSequence::subSequence.", startAt, 0, size());
+  length = min(length, size() - startAt);
+  const vector<int>& content = getContent();
+  vector<int> subContent(content.begin() + static_cast<ptrdiff_t>(startAt), content.begin() + static_cast<ptrdiff_t>(startAt + length));
   size_t begin = begin_;
-  if (hasCoordinates_) {
-    for (size_t i = 0; i < startAt; ++i) {
-      if (! getAlphabet()->isGap(operator[](i))) begin++;
-    }
-  }
-  MafSequence* newSeq = new MafSequence(getName(), subseq, begin, strand_, srcSize_);
+  if (hasCoordinates_)
+    begin += getResidueIndex_().rank(startAt);
+  MafSequence* newSeq = new MafSequence(getName(), std::move(subContent), begin, strand_, srcSize_, true, getAlphabet());
   if (!hasCoordinates_)
     newSeq->removeCoordinates();
-  vector<string> anno = getAnnotationTypes();
+  vector<string> anno = SequenceWithAnnotation::getAnnotationTypes();
   for (size_t i = 0; i < anno.size(); ++i) {
-    newSeq->addAnnotation(getAnnotation(anno[i]).getPartAnnotation(startAt, length));
+    newSeq->addAnnotation(SequenceWithAnnotation::getAnnotation(anno[i]).getPartAnnotation(startAt, length));
+  }
+  //Lazy annotations remain lazy:
+  if (hasLazyMask_) {
+    vector<uint64_t> bits(BitTools::getNumberOfWords(length), 0);
+    for (size_t i = 0; i < length; ++i)
+      if (BitTools::getBit(lazyMask_, startAt + i))
+        BitTools::setBit(bits, i);
+    newSeq->setLazyMask(std::move(bits));
   }
+  if (hasLazyQuality_)
+    newSeq->setLazyQuality(lazyQuality_.substr(startAt, length));
   return newSeq;
 }
 
+//Remove sorted ranges from a vector or a string, moving each kept element once:
+template<class Container>
+static void compactRanges(Container& c, const vector< pair<size_t, size_t> >& ranges)
+{
+  size_t out = ranges[0].first;
+  for (size_t r = 0; r < ranges.size(); ++r) {
+    size_t next = (r + 1 < ranges.size() ? ranges[r + 1].first : c.size());
+    for (size_t in = ranges[r].first + ranges[r].second; in < next; ++in, ++out)
+      c[out] = c[in];
+  }
+  c.resize(out);
+}
+
+void MafSequence::deleteSites(const std::vector< std::pair<size_t, size_t> >& ranges)
+{
+  for (size_t r = 0; r < ranges.size(); ++r) {
+    if (r > 0 && ranges[r].first < ranges[r - 1].first + ranges[r - 1].second)
+      throw Exception("MafSequence::deleteSites. Ranges must be sorted and non-overlapping.");
+    if (ranges[r].first + ranges[r].second > size())
+      throw IndexOutOfBoundsException("MafSequence::deleteSites.", ranges[r].first + ranges[r].second, 0, size());
+  }
+  if (ranges.empty()) return;
+
+  //Annotations other than masks and quality scores are updated through deletion events:
+  vector<string> types = SequenceWithAnnotation::getAnnotationTypes();
+  for (size_t i = 0; i < types.size(); ++i) {
+    if (types[i] != SequenceMask::MASK && types[i] != SequenceQuality::QUALITY_SCORE) {
+      for (size_t r = ranges.size(); r > 0; --r)
+        deleteElements(ranges[r - 1].first, ranges[r - 1].second);
+      return;
+    }
+  }
+
+  size_t removed = 0;
+  for (size_t r = 0; r < ranges.size(); ++r)
+    removed += countResidues_(ranges[r].first, ranges[r].first + ranges[r].second);
+  size_t oldSize = content_.size();
+  compactRanges(content_, ranges);
+  size_ -= removed;
+  residueIndex_.reset();
+
+  if (hasLazyMask_) {
+    vector<uint64_t> bits(BitTools::getNumberOfWords(content_.size()), 0);
+    size_t in = 0, out = 0;
+    for (size_t r = 0; r <= ranges.size(); ++r) {
+      size_t end = (r < ranges.size() ? ranges[r].first : oldSize);
+      for (; in < end; ++in, ++out)
+        if (BitTools::getBit(lazyMask_, in))
+          BitTools::setBit(bits, out);
+      if (r < ranges.size())
+        in = ranges[r].first + ranges[r].second;
+    }
+    lazyMask_.swap(bits);
+  } else if (SequenceWithAnnotation::hasAnnotation(SequenceMask::MASK)) {
+    SequenceMask& mask = dynamic_cast<SequenceMask&>(SequenceWithAnnotation::getAnnotation(SequenceMask::MASK));
+    vector<bool> bits = mask.getMask();
+    compactRanges(bits, ranges);
+    mask.setMask(bits);
+  }
+  if (hasLazyQuality_) {
+    compactRanges(lazyQuality_, ranges);
+  } else if (SequenceWithAnnotation::hasAnnotation(SequenceQuality::QUALITY_SCORE)) {
+    SequenceQuality& quality = dynamic_cast<SequenceQuality&>(SequenceWithAnnotation::getAnnotation(SequenceQuality::QUALITY_SCORE));
+    vector<int> scores = quality.getScores();
+    compactRanges(scores, ranges);
+    quality.setScores(scores);
+  }
+}
+
+void MafSequence::setLazyMask(std::vector<uint64_t>&& bits)
+{
+  if (hasAnnotation(SequenceMask::MASK))
+    throw Exception("MafSequence::setLazyMask. Sequence " + getName() + " already has a mask.");
+  if (bits.size() < BitTools::getNumberOfWords(size()))
+    throw Exception("MafSequence::setLazyMask. Mask does not match sequence size.");
+  lazyMask_.swap(bits);
+  hasLazyMask_ = true;
+}
+
+void MafSequence::setLazyQuality(std::string&& scores)
+{
+  if (hasAnnotation(SequenceQuality::QUALITY_SCORE))
+    throw Exception("MafSequence::setLazyQuality. Sequence " + getName() + " already has quality scores.");
+  if (scores.size() != size())
+    throw Exception("MafSequence::setLazyQuality. Quality scores do not match sequence size.");
+  lazyQuality_.swap(scores);
+  hasLazyQuality_ = true;
+}
+
+bool MafSequence::getMaskBits(std::vector<uint64_t>& bits) const
+{
+  if (hasLazyMask_) {
+    bits.assign(lazyMask_.begin(), lazyMask_.begin() + static_cast<ptrdiff_t>(BitTools::getNumberOfWords(size())));
+    return true;
+  }
+  if (!SequenceWithAnnotation::hasAnnotation(SequenceMask::MASK))
+    return false;
+  const vector<bool>& mask = dynamic_cast<const SequenceMask&>(SequenceWithAnnotation::getAnnotation(SequenceMask::MASK)).getMask();
+  bits.assign(BitTools::getNumberOfWords(mask.size()), 0);
+  for (size_t i = 0; i < mask.size(); ++i)
+    if (mask[i]) BitTools::setBit(bits, i);
+  return true;
+}
+
+void MafSequence::materializeMask_() const
+{
+  if (!hasLazyMask_) return;
+  vector<bool> mask(size());
+  for (size_t i = 0; i < mask.size(); ++i)
+    mask[i] = BitTools::getBit(lazyMask_, i);
+  //Flags must be reset before the annotation is added, which checks for existing ones:
+  hasLazyMask_ = false;
+  vector<uint64_t>().swap(lazyMask_);
+  const_cast<MafSequence*>(this)->SequenceWithAnnotation::addAnnotation(new SequenceMask(mask));
+}
+
+void MafSequence::materializeQuality_() const
+{
+  if (!hasLazyQuality_) return;
+  vector<int> scores(lazyQuality_.size());
+  for (size_t i = 0; i < scores.size(); ++i)
+    scores[i] = decodeQualityChar(lazyQuality_[i]);
+  hasLazyQuality_ = false;
+  string().swap(lazyQuality_);
+  const_cast<MafSequence*>(this)->SequenceWithAnnotation::addAnnotation(new SequenceQuality(scores));
+}
+
+void MafSequence::materializeAnnotations() const
+{
+  materializeMask_();
+  materializeQuality_();
+}
+
+bool MafSequence::hasAnnotation(const std::string& type) const
+{
+  if (hasLazyMask_ && type == SequenceMask::MASK) return true;
+  if (hasLazyQuality_ && type == SequenceQuality::QUALITY_SCORE) return true;
+  return SequenceWithAnnotation::hasAnnotation(type);
+}
+
+const SequenceAnnotation& MafSequence::getAnnotation(const std::string& type) const
+{
+  if (type == SequenceMask::MASK) materializeMask_();
+  else if (type == SequenceQuality::QUALITY_SCORE) materializeQuality_();
+  return SequenceWithAnnotation::getAnnotation(type);
+}
+
+SequenceAnnotation& MafSequence::getAnnotation(const std::string& type)
+{
+  if (type == SequenceMask::MASK) materializeMask_();
+  else if (type == SequenceQuality::QUALITY_SCORE) materializeQuality_();
+  return SequenceWithAnnotation::getAnnotation(type);
+}
+
+std::vector<std::string> MafSequence::getAnnotationTypes() const
+{
+  materializeAnnotations();
+  return SequenceWithAnnotation::getAnnotationTypes();
+}
+
+const RankSelectIndex& MafSequence::getResidueIndex_() const
+{
+  if (!residueIndex_) {
+    size_t n = content_.size();
+    int gap = getAlphabet()->getGapCharacterCode();
+    vector<uint64_t> bits(BitTools::getNumberOfWords(n), 0);
+    for (size_t i = 0; i < n; ++i)
+      bits[i >> 6] |= static_cast<uint64_t>(content_[i] != gap) << (i & 63);
+    residueIndex_.reset(new RankSelectIndex(std::move(bits), n));
+  }
+  return *residueIndex_;
+}
+
+size_t MafSequence::getAlignmentPosition(size_t seqPos) const
+{
+  const RankSelectIndex& index = getResidueIndex_();
+  if (seqPos >= index.getNumberOfOnes())
+    throw Exception("MafSequence::getAlignmentPosition. Position " + TextTools::toString(seqPos) + " is out of bounds in sequence " + getName() + ".");
+  return index.select(seqPos);
+}
+
+size_t MafSequence::getSequencePosition(size_t alnPos) const
+{
+  if (alnPos >= content_.size())
+    throw Exception("MafSequence::getSequencePosition. Alignment position " + TextTools::toString(alnPos) + " is out of bounds in sequence " + getName() + ".");
+  //Number of characters up to this position, minus one:
+  return getResidueIndex_().rank(alnPos + 1) - 1;
+}
+
+size_t MafSequence::getGenomicSize(size_t begin, size_t end) const
+{
+  if (begin > end || end > content_.size())
+    throw Exception("MafSequence::getGenomicSize. Invalid range [" + TextTools::toString(begin) + ", " + TextTools::toString(end) + "[ in sequence " + getName() + ".");
+  const RankSelectIndex& index = getResidueIndex_();
+  return index.rank(end) - index.rank(begin);
+}
 
@@ -41,11 +41,17 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _MAFSEQUENCE_H_
 
 #include "../../Feature/SequenceFeature.h"
+#include "BitTools.h"
+#include "RankSelectIndex.h"
+#include "MafNameDictionary.h"
 
 #include <Bpp/Seq/SequenceWithAnnotation.h>
 #include <Bpp/Seq/Alphabet/AlphabetTools.h>
 #include <Bpp/Seq/SequenceTools.h>
 
+//From the STL:
+#include <memory>
+
 namespace bpp {
 
 /**
@@ -53,10 +59,13 @@ namespace bpp {
  * 
  * It extends the SequenceWithAnnotation class to store MAF-specific features,
  * like the chromosome position. The sequence is its own listener,
- * and recomputes its "genomic" site by using the SequenceTools::getNumberOfSites
- * function when a content modification is performed.
+ * and updates its "genomic" size from the edited range when a content modification is performed.
+ * The whole sequence is only recounted when its content is replaced.
  * Tags like begin and stop, hovever, have to be set by hand.
  *
+ * Species and chromosome names are interned (see MafNameDictionary): each sequence only refers to
+ * the shared strings, and their IDs can be compared instead of the names.
+ *
  * A MAF sequence is necessarily a DNA sequence.
  */
 class MafSequence:
@@ -65,34 +74,122 @@ class MafSequence:
   private:
     bool         hasCoordinates_;
     size_t       begin_;
-    std::string  species_;
-    std::string  chromosome_;
+    const MafNameDictionary::SequenceName* parsedName_;
     char         strand_;
     size_t       size_;
     size_t       srcSize_;
+    mutable bool moveOnClone_;
+    mutable bool hasLazyMask_;
+    mutable std::vector<uint64_t> lazyMask_;
+    mutable bool hasLazyQuality_;
+    mutable std::string lazyQuality_;
+    mutable std::unique_ptr<RankSelectIndex> residueIndex_;
+    size_t       pendingResidues_; //Number of residues in the range being edited, between the 'before' and 'after' events.
 
   public:
     MafSequence(const Alphabet* alphabet = &AlphabetTools::DNA_ALPHABET):
-      SequenceWithAnnotation(alphabet), hasCoordinates_(false), begin_(0), species_(""), chromosome_(""), strand_(0), size_(0), srcSize_(0)
+      SequenceWithAnnotation(alphabet), hasCoordinates_(false), begin_(0), parsedName_(&MafNameDictionary::getEmptySequenceName()), strand_(0), size_(0), srcSize_(0), moveOnClone_(false), hasLazyMask_(false), lazyMask_(), hasLazyQuality_(false), lazyQuality_(), residueIndex_(), pendingResidues_(0)
     {}
 
     MafSequence(const std::string& name, const std::string& sequence, bool parseName = true, const Alphabet* alphabet = &AlphabetTools::DNA_ALPHABET):
-      SequenceWithAnnotation(name, sequence, alphabet), hasCoordinates_(false), begin_(0), species_(""), chromosome_(""), strand_(0), size_(0), srcSize_(0)
+      SequenceWithAnnotation(name, sequence, alphabet), hasCoordinates_(false), begin_(0), parsedName_(&MafNameDictionary::getEmptySequenceName()), strand_(0), size_(0), srcSize_(0), moveOnClone_(false), hasLazyMask_(false), lazyMask_(), hasLazyQuality_(false), lazyQuality_(), residueIndex_(), pendingResidues_(0)
     {
       size_ = SequenceTools::getNumberOfSites(*this);
       if (parseName)
-        splitNameIntoSpeciesAndChromosome(name, species_, chromosome_);
+        parsedName_ = &MafNameDictionary::splitSequenceName(name);
     }
 
     MafSequence(const std::string& name, const std::string& sequence, size_t begin, char strand, size_t srcSize, bool parseName = true, const Alphabet* alphabet = &AlphabetTools::DNA_ALPHABET) :
-      SequenceWithAnnotation(name, sequence, alphabet), hasCoordinates_(true), begin_(begin), species_(""), chromosome_(""), strand_(strand), size_(0), srcSize_(srcSize)
+      SequenceWithAnnotation(name, sequence, alphabet), hasCoordinates_(true), begin_(begin), parsedName_(&MafNameDictionary::getEmptySequenceName()), strand_(strand), size_(0), srcSize_(srcSize), moveOnClone_(false), hasLazyMask_(false), lazyMask_(), hasLazyQuality_(false), lazyQuality_(), residueIndex_(), pendingResidues_(0)
+    {
+      size_ = SequenceTools::getNumberOfSites(*this);
+      if (parseName)
+        parsedName_ = &MafNameDictionary::splitSequenceName(name);
+    }
+
+    /**
+     * @brief Build a new sequence from already encoded states.
+     *
+     * The content vector is moved into the sequence, and is left empty after the call.
+     * States are not checked against the alphabet, which is the responsibility of the caller.
+     * This constructor is typically used by parsers which encode characters directly.
+     */
+    MafSequence(const std::string& name, std::vector<int>&& content, size_t begin, char strand, size_t srcSize, bool parseName = true, const Alphabet* alphabet = &AlphabetTools::DNA_ALPHABET) :
+      SequenceWithAnnotation(name, std::string(), alphabet), hasCoordinates_(true), begin_(begin), parsedName_(&MafNameDictionary::getEmptySequenceName()), strand_(strand), size_(0), srcSize_(srcSize), moveOnClone_(false), hasLazyMask_(false), lazyMask_(), hasLazyQuality_(false), lazyQuality_(), residueIndex_(), pendingResidues_(0)
     {
+      content_.swap(content);
       size_ = SequenceTools::getNumberOfSites(*this);
       if (parseName)
-        splitNameIntoSpeciesAndChromosome(name, species_, chromosome_);
+        parsedName_ = &MafNameDictionary::splitSequenceName(name);
+    }
+
+    /**
+     * @brief Build a new sequence from already encoded states, with a known genomic size.
+     *
+     * Same as the previous constructor, but the number of non-gap states is given by the caller,
+     * typically a parser which counted them while encoding, and is not recomputed.
+     */
+    MafSequence(const std::string& name, std::vector<int>&& content, size_t begin, char strand, size_t srcSize, size_t genomicSize, const Alphabet* alphabet = &AlphabetTools::DNA_ALPHABET) :
+      SequenceWithAnnotation(name, std::string(), alphabet), hasCoordinates_(true), begin_(begin), parsedName_(&MafNameDictionary::splitSequenceName(name)), strand_(strand), size_(genomicSize), srcSize_(srcSize), moveOnClone_(false), hasLazyMask_(false), lazyMask_(), hasLazyQuality_(false), lazyQuality_(), residueIndex_(), pendingResidues_(0)
+    {
+      content_.swap(content);
+    }
+
+    MafSequence(const MafSequence& seq):
+      SequenceWithAnnotation(seq), hasCoordinates_(seq.hasCoordinates_), begin_(seq.begin_), parsedName_(seq.parsedName_), strand_(seq.strand_), size_(seq.size_), srcSize_(seq.srcSize_), moveOnClone_(false),
+      hasLazyMask_(seq.hasLazyMask_), lazyMask_(seq.lazyMask_), hasLazyQuality_(seq.hasLazyQuality_), lazyQuality_(seq.lazyQuality_), residueIndex_(), pendingResidues_(0)
+    {}
+
+    /**
+     * @brief Move constructor.
+     *
+     * The content of the input sequence is transferred without copy, and the input sequence is left empty.
+     * Annotations and comments are copied, lazy annotations are moved. Annotations of the input sequence
+     * are then reset to its new, empty content.
+     */
+    MafSequence(MafSequence&& seq):
+      SequenceWithAnnotation(seq.getName(), std::string(), seq.getAlphabet()), hasCoordinates_(seq.hasCoordinates_), begin_(seq.begin_), parsedName_(seq.parsedName_), strand_(seq.strand_), size_(seq.size_), srcSize_(seq.srcSize_), moveOnClone_(false),
+      hasLazyMask_(seq.hasLazyMask_), lazyMask_(std::move(seq.lazyMask_)), hasLazyQuality_(seq.hasLazyQuality_), lazyQuality_(std::move(seq.lazyQuality_)),
+      residueIndex_(std::move(seq.residueIndex_)), pendingResidues_(0)
+    {
+      content_.swap(seq.content_);
+      setComments(seq.getComments());
+      //Only copy materialized annotations:
+      std::vector<std::string> types = seq.SequenceWithAnnotation::getAnnotationTypes();
+      for (size_t i = 0; i < types.size(); ++i) {
+        SequenceAnnotation& annotation = seq.SequenceWithAnnotation::getAnnotation(types[i]);
+        SequenceWithAnnotation::addAnnotation(annotation.clone());
+        annotation.init(seq);
+      }
+      seq.size_ = 0;
+      seq.hasLazyMask_ = false;
+      seq.hasLazyQuality_ = false;
+    }
+
+    MafSequence& operator=(const MafSequence& seq)
+    {
+      SequenceWithAnnotation::operator=(seq);
+      hasCoordinates_ = seq.hasCoordinates_;
+      begin_          = seq.begin_;
+      parsedName_     = seq.parsedName_;
+      strand_         = seq.strand_;
+      size_           = seq.size_;
+      srcSize_        = seq.srcSize_;
+      moveOnClone_    = false;
+      hasLazyMask_    = seq.hasLazyMask_;
+      lazyMask_       = seq.lazyMask_;
+      hasLazyQuality_ = seq.hasLazyQuality_;
+      lazyQuality_    = seq.lazyQuality_;
+      residueIndex_.reset();
+      return *this;
     }
 
     MafSequence* clone() const { 
+      if (moveOnClone_) {
+        //The sequence is being transferred to a container (see MafBlock::addSequence), its content is moved to the copy.
+        moveOnClone_ = false;
+        return new MafSequence(std::move(const_cast<MafSequence&>(*this)));
+      }
       return new MafSequence(*this);
     }
  
@@ -135,10 +232,9 @@ class MafSequence:
 
     void setName(const std::string& name) {
       try {
-        splitNameIntoSpeciesAndChromosome(name, species_, chromosome_);
+        parsedName_ = &MafNameDictionary::splitSequenceName(name);
       } catch (Exception& e) {
-        species_ = "";
-        chromosome_ = "";
+        parsedName_ = &MafNameDictionary::getEmptySequenceName();
       }
       SequenceWithAnnotation::setName(name);
     }
@@ -153,9 +249,19 @@ class MafSequence:
       }
     }
 
-    const std::string& getSpecies() const { return species_; }
+    const std::string& getSpecies() const { return *parsedName_->species; }
     
-    const std::string& getChromosome() const { return chromosome_; }
+    const std::string& getChromosome() const { return *parsedName_->chromosome; }
+
+    /**
+     * @return The ID of the species name, in MafNameDictionary::species().
+     */
+    size_t getSpeciesId() const { return parsedName_->speciesId; }
+
+    /**
+     * @return The ID of the chromosome name, in MafNameDictionary::chromosomes().
+     */
+    size_t getChromosomeId() const { return parsedName_->chromosomeId; }
     
     char getStrand() const { return strand_; }
     
@@ -166,13 +272,13 @@ class MafSequence:
     void setStart(size_t begin) { begin_ = begin; hasCoordinates_ = true; }
     
     void setChromosome(const std::string& chr) {
-      chromosome_ = chr;
-      SequenceWithAnnotation::setName(species_ + "." + chromosome_);
+      SequenceWithAnnotation::setName(getSpecies() + "." + chr);
+      parsedName_ = &MafNameDictionary::splitSequenceName(getName());
     }
     
     void setSpecies(const std::string& species) {
-      species_ = species;
-      SequenceWithAnnotation::setName(species_ + "." + chromosome_);
+      SequenceWithAnnotation::setName(species + "." + getChromosome());
+      parsedName_ = &MafNameDictionary::splitSequenceName(getName());
     }
     
     void setStrand(char s) { strand_ = s; }
@@ -189,16 +295,191 @@ class MafSequence:
      * @param length  the length of the sub-sequence.
      */
     MafSequence* subSequence(size_t startAt, size_t length) const;
+
+    /**
+     * @brief Remove several ranges of sites in a single pass.
+     *
+     * Content, masks and quality scores are compacted in place, and the genomic size is updated.
+     * Coordinates are not modified.
+     *
+     * @param ranges The ranges to remove, as (first site, number of sites) pairs, sorted and non-overlapping.
+     * @throw Exception if the ranges are not sorted or overlap.
+     * @throw IndexOutOfBoundsException if a range ends after the last site.
+     */
+    void deleteSites(const std::vector< std::pair<size_t, size_t> >& ranges);
+
+    /**
+     * @name Coordinate conversion.
+     *
+     * Conversions between alignment positions and positions in the ungapped sequence rely on an index of
+     * the non-gap positions, which is built on first use and discarded when the sequence content is modified.
+     * Both conversions are then performed in constant time, whatever the distance between successive queries.
+     * As building the index modifies the object, the first call is not thread-safe.
+     *
+     * @{
+     */
+
+    /**
+     * @return The alignment position of a given character of the ungapped sequence.
+     * @param seqPos The position in the ungapped sequence, starting at 0.
+     * @throw Exception if the sequence has less than seqPos + 1 characters.
+     */
+    size_t getAlignmentPosition(size_t seqPos) const;
+
+    /**
+     * @return The position in the ungapped sequence of a given alignment column.
+     * If the column is a gap, the position of the last character before it is returned, or (size_t)-1 if there is none.
+     * @param alnPos The alignment position.
+     * @throw Exception if the alignment position is out of bounds.
+     */
+    size_t getSequencePosition(size_t alnPos) const;
+
+    /**
+     * @return The number of characters (non-gap positions) in a given alignment range.
+     * @param begin The first alignment position.
+     * @param end The alignment position after the last one.
+     * @throw Exception if the range is not valid.
+     */
+    size_t getGenomicSize(size_t begin, size_t end) const;
+
+    /** @} */
+
+    /**
+     * @name Lazy annotations.
+     *
+     * Mask and quality information can be stored in a compact, raw form, and only be converted to
+     * SequenceMask and SequenceQuality annotations when they are first accessed.
+     * This conversion is triggered by the annotation accessors, and before any modification of the sequence content.
+     * As it modifies the object, concurrent access to the annotations of a sequence with lazy annotations is not thread-safe.
+     *
+     * @{
+     */
+
+    /**
+     * @brief Set the mask as a bitmap, 64 positions per word, first position in the lowest bit.
+     *
+     * @param bits The bitmap, which is moved to the sequence.
+     * @throw Exception if the bitmap is too short, or if the sequence already has a mask.
+     */
+    void setLazyMask(std::vector<uint64_t>&& bits);
+
+    /**
+     * @brief Set the quality scores as raw MAF quality characters ([0-9], F, '-', '?' or '.').
+     *
+     * @param scores The quality string, which is moved to the sequence.
+     * @throw Exception if the string size does not match the sequence size, or if the sequence already has quality scores.
+     */
+    void setLazyQuality(std::string&& scores);
+
+    bool hasLazyAnnotations() const { return hasLazyMask_ || hasLazyQuality_; }
+
+    /**
+     * @return An estimate of the number of bytes used by the sequence, including its content, annotations and indexes.
+     */
+    size_t getMemorySize() const;
+
+    /**
+     * @brief Reserve memory for a given number of sites, so that the sequence can be extended without reallocation.
+     *
+     * @param nbSites The total number of sites to allocate.
+     */
+    void reserve(size_t nbSites) { content_.reserve(nbSites); }
+
+    /**
+     * @return The number of sites the sequence can hold without reallocation.
+     */
+    size_t capacity() const { return content_.capacity(); }
+
+    /**
+     * @brief Get the mask as a bitmap, 64 positions per word, first position in the lowest bit.
+     *
+     * Lazy masks are not materialized by this method.
+     *
+     * @param bits [out] The bitmap.
+     * @return False if the sequence has no mask, in which case the bitmap is left unchanged.
+     */
+    bool getMaskBits(std::vector<uint64_t>& bits) const;
+
+    /**
+     * @brief Convert all lazy annotations to standard ones.
+     */
+    void materializeAnnotations() const;
+
+    /**
+     * @brief Build all lazy data of the sequence: annotations and the residue index.
+     *
+     * After this call, const methods do not modify the sequence, which can then be read from several threads.
+     */
+    void prepareForSharing() const {
+      materializeAnnotations();
+      getResidueIndex_();
+    }
+
+    /** @} */
+
+    bool hasAnnotation(const std::string& type) const;
+
+    const SequenceAnnotation& getAnnotation(const std::string& type) const;
+
+    SequenceAnnotation& getAnnotation(const std::string& type);
+
+    std::vector<std::string> getAnnotationTypes() const;
+
+    /**
+     * @return The quality score for a MAF quality character.
+     * @throw Exception if the character is not a valid quality score.
+     */
+    static int decodeQualityChar(char c) {
+      if (c == '-') {
+        return -1;
+      } else if (c >= '0' && c <= '9') {
+        return c - '0';
+      } else if (c == 'F' || c == 'f') { //Finished
+        return 10;
+      } else if (c == '?' || c == '.') {
+        return -2;
+      } else {
+        throw Exception("MafSequence::decodeQualityChar(). Unvalid quality score: " + TextTools::toString(c) + ". Should be 0-9, F or '-'.");
+      }
+    }
     
   private:
-    void beforeSequenceChanged(const SymbolListEditionEvent& event) {}
-    void afterSequenceChanged(const SymbolListEditionEvent& event) { size_ = SequenceTools::getNumberOfSites(*this); }
-    void beforeSequenceInserted(const SymbolListInsertionEvent& event) {}
-    void afterSequenceInserted(const SymbolListInsertionEvent& event) { size_ = SequenceTools::getNumberOfSites(*this); }
-    void beforeSequenceDeleted(const SymbolListDeletionEvent& event) {}
-    void afterSequenceDeleted(const SymbolListDeletionEvent& event) { size_ = SequenceTools::getNumberOfSites(*this); }
-    void beforeSequenceSubstituted(const SymbolListSubstitutionEvent& event) {}
-    void afterSequenceSubstituted(const SymbolListSubstitutionEvent& event) {}
+    const RankSelectIndex& getResidueIndex_() const;
+
+    void materializeMask_() const;
+    void materializeQuality_() const;
+
+    //Number of non-gap states in [begin, end[:
+    size_t countResidues_(size_t begin, size_t end) const {
+      size_t n = 0;
+      for (size_t i = begin; i < end; ++i)
+        n += static_cast<size_t>(content_[i] >= 0);
+      return n;
+    }
+
+    //The genomic size is updated from the edited range only, except when the whole content is replaced:
+    void beforeSequenceChanged(const SymbolListEditionEvent& event) { materializeAnnotations(); }
+    void afterSequenceChanged(const SymbolListEditionEvent& event) { size_ = countResidues_(0, content_.size()); residueIndex_.reset(); }
+    void beforeSequenceInserted(const SymbolListInsertionEvent& event) { materializeAnnotations(); }
+    void afterSequenceInserted(const SymbolListInsertionEvent& event) {
+      size_ += countResidues_(event.getPosition(), event.getPosition() + event.getLength());
+      residueIndex_.reset();
+    }
+    void beforeSequenceDeleted(const SymbolListDeletionEvent& event) {
+      materializeAnnotations();
+      pendingResidues_ = countResidues_(event.getPosition(), event.getPosition() + event.getLength());
+    }
+    void afterSequenceDeleted(const SymbolListDeletionEvent& event) { size_ -= pendingResidues_; residueIndex_.reset(); }
+    void beforeSequenceSubstituted(const SymbolListSubstitutionEvent& event) {
+      materializeAnnotations();
+      pendingResidues_ = countResidues_(event.getBegin(), event.getEnd() + 1);
+    }
+    void afterSequenceSubstituted(const SymbolListSubstitutionEvent& event) {
+      size_ = size_ - pendingResidues_ + countResidues_(event.getBegin(), event.getEnd() + 1);
+      residueIndex_.reset();
+    }
+
+    friend class MafBlock;
 };
 
 } // end of namespace bpp.
@@ -0,0 +1,339 @@
+//
+// File: MafSharding.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "MafSharding.h"
+#include "BinaryIoTools.h"
+#include "ProgressReporter.h"
+
+using namespace bpp;
+
+//From the STL:
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+const short MafShardPlan::BY_BYTES = 0;
+const short MafShardPlan::BY_SITES = 1;
+
+//A group of blocks which cannot be split:
+struct ShardUnit_
+{
+  string chr;
+  size_t start;
+  size_t stop;
+  uint64_t weight;
+
+  ShardUnit_(const string& c, size_t b): chr(c), start(b), stop(b), weight(0) {}
+};
+
+MafShardPlan* MafShardPlan::build(MafIndex& index, const string& path, size_t nbShards, short weighting, size_t chunkSize, size_t windowSize, size_t minGap)
+{
+  if (nbShards == 0)
+    throw Exception("MafShardPlan::build. The number of shards must be positive.");
+  if (weighting != BY_BYTES && weighting != BY_SITES)
+    throw Exception("MafShardPlan::build. Unknown weighting: " + TextTools::toString(weighting) + ".");
+  vector<string> chrs = index.getChromosomes();
+
+  //The size of a block in bytes is the distance to the next block in the file:
+  vector<uint64_t> offsets;
+  uint64_t fileSize = 0;
+  if (weighting == BY_BYTES) {
+    for (size_t c = 0; c < chrs.size(); ++c) {
+      const vector<MafIndex::Entry>& entries = index.getEntries(chrs[c]);
+      for (size_t i = 0; i < entries.size(); ++i)
+        offsets.push_back(entries[i].offset);
+    }
+    sort(offsets.begin(), offsets.end());
+    fileSize = ProgressReporter::getFileSize(path);
+  }
+
+  //Group blocks that cannot be separated:
+  vector<ShardUnit_> units;
+  uint64_t totalWeight = 0;
+  for (size_t c = 0; c < chrs.size(); ++c) {
+    const vector<MafIndex::Entry>& entries = index.getEntries(chrs[c]);
+    if (entries.empty()) continue;
+    units.push_back(ShardUnit_(chrs[c], 0));
+    size_t maxStop = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+      const MafIndex::Entry& entry = entries[i];
+      if (i > 0 && entry.start >= maxStop && entry.start - maxStop >= minGap
+          && (windowSize == 0 || maxStop == 0 || entry.start / windowSize > (maxStop - 1) / windowSize)) {
+        units.back().stop = entry.start;
+        units.push_back(ShardUnit_(chrs[c], entry.start));
+      }
+      uint64_t weight;
+      if (weighting == BY_SITES) {
+        weight = entry.stop - entry.start;
+      } else {
+        vector<uint64_t>::const_iterator next = upper_bound(offsets.begin(), offsets.end(), entry.offset);
+        uint64_t end = (next == offsets.end() ? max(fileSize, entry.offset) : *next);
+        weight = end - entry.offset;
+      }
+      units.back().weight += weight;
+      totalWeight += weight;
+      maxStop = max(maxStop, entry.stop);
+    }
+    units.back().stop = max(maxStop, units.back().start + 1);
+  }
+
+  //Fill shards in order, each one as close as possible to an equal share of the remaining weight:
+  unique_ptr<MafShardPlan> plan(new MafShardPlan());
+  plan->shards_.resize(nbShards);
+  plan->weights_.assign(nbShards, 0);
+  size_t shard = 0;
+  uint64_t remaining = totalWeight;
+  size_t regionStart = 0;
+  for (size_t u = 0; u < units.size(); ++u) {
+    const ShardUnit_& unit = units[u];
+    uint64_t& current = plan->weights_[shard];
+    if (current > 0 && shard + 1 < nbShards) {
+      double target = static_cast<double>(remaining) / static_cast<double>(nbShards - shard);
+      if (static_cast<double>(current + unit.weight) - target > target - static_cast<double>(current)) {
+        remaining -= current;
+        shard++;
+      }
+    }
+    vector<MafRegion>& regions = plan->shards_[shard];
+    if (!regions.empty() && regions.back().chr == unit.chr
+        && (chunkSize == 0 || unit.start < regionStart + chunkSize)) {
+      regions.back().stop = unit.stop;
+    } else {
+      regions.push_back(MafRegion(unit.chr, unit.start, unit.stop));
+      regionStart = unit.start;
+    }
+    plan->weights_[shard] += unit.weight;
+  }
+  return plan.release();
+}
+
+/******************************************************************************/
+
+void MafShardPlan::write(const string& path) const
+{
+  ofstream out(path.c_str(), ios::out);
+  if (!out)
+    throw IOException("MafShardPlan::write(). Could not open file: " + path);
+  out << "#Shards\t" << shards_.size() << endl;
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    out << "#Shard\t" << i << "\t" << weights_[i] << endl;
+    for (size_t j = 0; j < shards_[i].size(); ++j)
+      out << shards_[i][j].chr << "\t" << shards_[i][j].start << "\t" << shards_[i][j].stop << endl;
+  }
+  if (!out)
+    throw IOException("MafShardPlan::write(). Error while writing file: " + path);
+}
+
+MafShardPlan* MafShardPlan::read(const string& path)
+{
+  ifstream in(path.c_str(), ios::in);
+  if (!in)
+    throw IOException("MafShardPlan::read(). Could not open file: " + path);
+  unique_ptr<MafShardPlan> plan(new MafShardPlan());
+  string line;
+  size_t nbShards = 0;
+  if (!getline(in, line) || line.compare(0, 8, "#Shards\t") != 0)
+    throw IOException("MafShardPlan::read(). Not a shard plan: " + path);
+  nbShards = TextTools::to<size_t>(line.substr(8));
+  while (getline(in, line)) {
+    if (line.empty()) continue;
+    istringstream fields(line);
+    if (line.compare(0, 7, "#Shard\t") == 0) {
+      string tag;
+      size_t shard;
+      uint64_t weight;
+      fields >> tag >> shard >> weight;
+      if (!fields || shard != plan->shards_.size())
+        throw IOException("MafShardPlan::read(). Invalid shard line: " + line);
+      plan->shards_.push_back(vector<MafRegion>());
+      plan->weights_.push_back(weight);
+    } else {
+      MafRegion region;
+      fields >> region.chr >> region.start >> region.stop;
+      if (!fields || plan->shards_.empty())
+        throw IOException("MafShardPlan::read(). Invalid region line: " + line);
+      plan->shards_.back().push_back(region);
+    }
+  }
+  if (plan->shards_.size() != nbShards)
+    throw IOException("MafShardPlan::read(). Incomplete shard plan: " + path);
+  return plan.release();
+}
+
+/******************************************************************************/
+
+size_t MafShardPlan::getTaskId(size_t defaultId)
+{
+  static const char* variables[] = {
+    "OMPI_COMM_WORLD_RANK", "PMI_RANK", "PMIX_RANK",
+    "SLURM_ARRAY_TASK_ID", "PBS_ARRAYID", "SGE_TASK_ID", "LSB_JOBINDEX"
+  };
+  for (size_t i = 0; i < sizeof(variables) / sizeof(variables[0]); ++i) {
+    const char* value = getenv(variables[i]);
+    if (!value || !*value) continue;
+    char* end = 0;
+    unsigned long id = strtoul(value, &end, 10);
+    if (*end != '\0') continue; //For instance "undefined" with SGE.
+    bool oneBased = (strcmp(variables[i], "SGE_TASK_ID") == 0 || strcmp(variables[i], "LSB_JOBINDEX") == 0);
+    if (oneBased) {
+      if (id == 0) continue;
+      id--;
+    }
+    return static_cast<size_t>(id);
+  }
+  return defaultId;
+}
+
+/******************************************************************************/
+
+//Binary I/O, little endian:
+
+static const char READ_CONTEXT[] = "MafShardSummary::read()";
+
+static const char SHARD_SUMMARY_MAGIC[] = "BPPSHRD1";
+
+MafShardSummary::MafShardSummary(const RegionParallelMafRunner& runner, uint64_t nbBlocks):
+  nbBlocks_(nbBlocks), hasMsmc_(runner.hasMsmcOutput()),
+  msmcChr_(runner.getMsmcChromosome()), msmcCalledSites_(runner.getMsmcCalledSites()),
+  states_()
+{
+  const vector< unique_ptr<MergeableMafStatistics> >& stats = runner.getStatistics();
+  for (size_t i = 0; i < stats.size(); ++i) {
+    ostringstream state;
+    stats[i]->writeState(state);
+    states_.push_back(state.str());
+  }
+}
+
+void MafShardSummary::mergeStatistics(const vector<MergeableMafStatistics*>& stats) const
+{
+  //An empty shard has no statistics:
+  if (states_.empty()) return;
+  if (stats.size() != states_.size())
+    throw Exception("MafShardSummary::mergeStatistics. Wrong number of statistics: " + TextTools::toString(stats.size()) + ", expected " + TextTools::toString(states_.size()) + ".");
+  for (size_t i = 0; i < stats.size(); ++i) {
+    istringstream state(states_[i]);
+    stats[i]->mergeState(state);
+  }
+}
+
+void MafShardSummary::write(const string& path) const
+{
+  ofstream out(path.c_str(), ios::out | ios::binary);
+  if (!out)
+    throw IOException("MafShardSummary::write(). Could not open file: " + path);
+  out.write(SHARD_SUMMARY_MAGIC, 8);
+  BinaryIoTools::writeUInt(out, nbBlocks_, 8);
+  BinaryIoTools::writeUInt(out, hasMsmc_ ? 1 : 0, 1);
+  BinaryIoTools::writeString(out, msmcChr_);
+  BinaryIoTools::writeUInt(out, msmcCalledSites_, 4);
+  BinaryIoTools::writeUInt(out, states_.size(), 4);
+  for (size_t i = 0; i < states_.size(); ++i)
+    BinaryIoTools::writeString(out, states_[i]);
+  if (!out)
+    throw IOException("MafShardSummary::write(). Error while writing file: " + path);
+}
+
+MafShardSummary MafShardSummary::read(const string& path)
+{
+  ifstream in(path.c_str(), ios::in | ios::binary);
+  if (!in)
+    throw IOException("MafShardSummary::read(). Could not open file: " + path);
+  char magic[8];
+  in.read(magic, 8);
+  if (!in || memcmp(magic, SHARD_SUMMARY_MAGIC, 8) != 0)
+    throw IOException("MafShardSummary::read(). Not a shard summary: " + path);
+  MafShardSummary summary;
+  summary.nbBlocks_ = BinaryIoTools::readUInt(in, 8, READ_CONTEXT);
+  summary.hasMsmc_ = (BinaryIoTools::readUInt(in, 1, READ_CONTEXT) != 0);
+  summary.msmcChr_ = BinaryIoTools::readString(in, READ_CONTEXT);
+  summary.msmcCalledSites_ = static_cast<unsigned int>(BinaryIoTools::readUInt(in, 4, READ_CONTEXT));
+  size_t nbStates = static_cast<size_t>(BinaryIoTools::readUInt(in, 4, READ_CONTEXT));
+  for (size_t i = 0; i < nbStates; ++i)
+    summary.states_.push_back(BinaryIoTools::readString(in, READ_CONTEXT));
+  return summary;
+}
+
+/******************************************************************************/
+
+uint64_t MafShardMerger::mergeOutputs(const vector<string>& outputs, const vector<MafShardSummary>& summaries, ostream& out, size_t headerLines)
+{
+  if (outputs.size() != summaries.size())
+    throw Exception("MafShardMerger::mergeOutputs. There should be one summary per output.");
+  uint64_t nbBlocks = 0;
+  string carryChr;
+  unsigned int carry = 0;
+  string line;
+  for (size_t k = 0; k < outputs.size(); ++k) {
+    ifstream in(outputs[k].c_str(), ios::in | ios::binary);
+    if (!in)
+      throw IOException("MafShardMerger::mergeOutputs. Could not open file: " + outputs[k]);
+    for (size_t i = 0; i < headerLines && getline(in, line); ++i) {
+      if (k == 0) {
+        out << line;
+        if (!in.eof()) out << '\n';
+      }
+    }
+    const MafShardSummary& summary = summaries[k];
+    if (summary.hasMsmcOutput()) {
+      //Same as RegionParallelMafRunner::run(), with shards instead of regions:
+      if (getline(in, line)) {
+        bool complete = !in.eof();
+        RegionParallelMafRunner::correctMsmcCount(line, carryChr, carry);
+        out << line;
+        if (complete) out << '\n';
+        carryChr = summary.getMsmcChromosome();
+        carry = summary.getMsmcCalledSites();
+      } else if (!summary.getMsmcChromosome().empty()) {
+        carry = (summary.getMsmcChromosome() == carryChr ? carry : 0) + summary.getMsmcCalledSites();
+        carryChr = summary.getMsmcChromosome();
+      }
+    }
+    if (in.peek() != char_traits<char>::eof())
+      out << in.rdbuf();
+    nbBlocks += summary.getNumberOfBlocks();
+  }
+  out.flush();
+  return nbBlocks;
+}
+
@@ -0,0 +1,234 @@
+//
+// File: MafSharding.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _MAFSHARDING_H_
+#define _MAFSHARDING_H_
+
+#include "RegionParallelMafRunner.h"
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief Split an indexed MAF file into balanced shards, to be processed independently by several tasks.
+ *
+ * A shard is a list of consecutive regions of the reference species, and shards follow each other in
+ * chromosome and position order, so that concatenating their outputs in shard order gives the output of a
+ * sequential run. Each task, for instance a MPI rank or a task of a job array, runs the same pipeline on its
+ * own shard with a RegionParallelMafRunner, and writes its output together with a MafShardSummary.
+ * The outputs and summaries of all tasks are then combined with MafShardMerger.
+ *
+ * Shards are balanced according to the number of bytes or reference sites of their blocks. As with
+ * RegionParallelMafRunner::makeRegions(), cuts are only placed between blocks distant by at least a minimum gap
+ * on the reference. When a window size is given, cuts are furthermore only placed between blocks falling in
+ * different windows, so that windows of a WindowedStatisticsOutputIterationListener are never split.
+ * The plan only depends on the index and the parameters, so that all tasks can build it independently,
+ * or read it from a file written once.
+ */
+class MafShardPlan
+{
+  public:
+    static const short BY_BYTES;
+    static const short BY_SITES;
+
+  private:
+    std::vector< std::vector<MafRegion> > shards_;
+    std::vector<uint64_t> weights_;
+
+  public:
+    MafShardPlan(): shards_(), weights_() {}
+
+  public:
+    /**
+     * @brief Build a plan from an index.
+     *
+     * @param index The index of the MAF file.
+     * @param path The path to the MAF file, used to compute the size of the last block with BY_BYTES.
+     * @param nbShards The number of shards. Some shards may be empty if there are too few blocks.
+     * @param weighting The weight of each block, its size in bytes (BY_BYTES) or its number of reference sites (BY_SITES).
+     * @param chunkSize The minimum size of the regions within each shard (see RegionParallelMafRunner::makeRegions()).
+     * 0 means one region per chromosome in each shard.
+     * @param windowSize If positive, the size of windows that should never be split.
+     * @param minGap The minimum distance between two blocks at a cut.
+     * @return A new plan.
+     */
+    static MafShardPlan* build(MafIndex& index, const std::string& path, size_t nbShards,
+        short weighting = BY_BYTES, size_t chunkSize = 0, size_t windowSize = 0, size_t minGap = 1);
+
+    /**
+     * @brief Write the plan as a tab-separated table, with one region per line.
+     *
+     * @param path The output path.
+     * @throw IOException If the file cannot be written.
+     */
+    void write(const std::string& path) const;
+
+    /**
+     * @brief Read a plan written by write().
+     *
+     * @param path The input path.
+     * @return A new plan.
+     * @throw IOException If the file cannot be read or is not a valid plan.
+     */
+    static MafShardPlan* read(const std::string& path);
+
+    size_t getNumberOfShards() const { return shards_.size(); }
+
+    /**
+     * @return The regions of a shard, to be given to RegionParallelMafRunner::run().
+     * @param shard The shard index.
+     */
+    const std::vector<MafRegion>& getShard(size_t shard) const {
+      if (shard >= shards_.size())
+        throw Exception("MafShardPlan::getShard. No shard with index " + TextTools::toString(shard) + ".");
+      return shards_[shard];
+    }
+
+    uint64_t getWeight(size_t shard) const { return weights_[shard]; }
+
+    /**
+     * @return The index of the current task, from the environment of the MPI launcher or job scheduler.
+     *
+     * The following variables are looked for, in this order: OMPI_COMM_WORLD_RANK, PMI_RANK, PMIX_RANK
+     * (MPI ranks), SLURM_ARRAY_TASK_ID, PBS_ARRAYID, SGE_TASK_ID and LSB_JOBINDEX (job arrays, the last two
+     * being 1-based). Job arrays should therefore be numbered from 0, or from 1 with SGE and LSF.
+     * @param defaultId The index returned if no variable is set.
+     */
+    static size_t getTaskId(size_t defaultId = 0);
+};
+
+/**
+ * @brief What a task should record, in addition to its output, for its shard to be merged.
+ *
+ * This includes the state of the mergeable statistics of the pipelines (see MafRegionPipeline::addStatistics()),
+ * and the called sites carried over by MSMC output.
+ */
+class MafShardSummary
+{
+  private:
+    uint64_t nbBlocks_;
+    bool hasMsmc_;
+    std::string msmcChr_;
+    unsigned int msmcCalledSites_;
+    std::vector<std::string> states_;
+
+  public:
+    MafShardSummary():
+      nbBlocks_(0), hasMsmc_(false), msmcChr_(), msmcCalledSites_(0), states_() {}
+
+    /**
+     * @brief Summarize the last run of a runner.
+     *
+     * @param runner The runner.
+     * @param nbBlocks The number of blocks returned by the run.
+     */
+    MafShardSummary(const RegionParallelMafRunner& runner, uint64_t nbBlocks);
+
+  public:
+    uint64_t getNumberOfBlocks() const { return nbBlocks_; }
+    bool hasMsmcOutput() const { return hasMsmc_; }
+    const std::string& getMsmcChromosome() const { return msmcChr_; }
+    unsigned int getMsmcCalledSites() const { return msmcCalledSites_; }
+    size_t getNumberOfStatistics() const { return states_.size(); }
+
+    /**
+     * @brief Add the values of the statistics of the shard to other instances.
+     *
+     * @param stats The statistics to merge into, in the order they were added to the pipelines.
+     * @throw Exception If the statistics are not compatible.
+     */
+    void mergeStatistics(const std::vector<MergeableMafStatistics*>& stats) const;
+
+    /**
+     * @param path The output path.
+     * @throw IOException If the file cannot be written.
+     */
+    void write(const std::string& path) const;
+
+    /**
+     * @param path The input path.
+     * @return The summary written in the file.
+     * @throw IOException If the file cannot be read or is not a valid summary.
+     */
+    static MafShardSummary read(const std::string& path);
+};
+
+/**
+ * @brief Combine the outputs and summaries of all shards of a plan.
+ *
+ * Outputs are concatenated in shard order, and statistics are merged in shard order, so that the results do not
+ * depend on the number of shards.
+ */
+class MafShardMerger
+{
+  public:
+    /**
+     * @brief Concatenate the outputs of all shards.
+     *
+     * The called sites of MSMC output are corrected at the first SNP of each shard.
+     * @param outputs The paths to the outputs of all shards, in shard order.
+     * @param summaries The summaries of all shards, in shard order.
+     * @param out The output stream.
+     * @param headerLines The number of header lines written at the beginning of each output, which are only kept for the first shard.
+     * @return The total number of blocks.
+     * @throw IOException If an output cannot be read.
+     */
+    static uint64_t mergeOutputs(const std::vector<std::string>& outputs, const std::vector<MafShardSummary>& summaries,
+        std::ostream& out, size_t headerLines = 0);
+
+    /**
+     * @brief Merge the statistics of all shards.
+     *
+     * @param summaries The summaries of all shards, in shard order.
+     * @param stats Empty instances of the statistics added to the pipelines, in the same order.
+     */
+    static void mergeStatistics(const std::vector<MafShardSummary>& summaries, const std::vector<MergeableMafStatistics*>& stats) {
+      for (size_t i = 0; i < summaries.size(); ++i)
+        summaries[i].mergeStatistics(stats);
+    }
+};
+
+} // end of namespace bpp.
+
+#endif //_MAFSHARDING_H_
@@ -38,10 +38,8 @@ knowledge of the CeCILL license and that you accept its terms.
 */
 
 #include "MafStatistics.h"
-#include <Bpp/Seq/Container/SequenceContainerTools.h>
+#include "BitTools.h"
 #include <Bpp/Seq/Container/VectorSiteContainer.h>
-#include <Bpp/Seq/Container/SiteContainerTools.h>
-#include <Bpp/Seq/SiteTools.h>
 
 //From bpp-core:
 #include <Bpp/Numeric/NumConstants.h>
@@ -49,6 +47,7 @@ knowledge of the CeCILL license and that you accept its terms.
 //From the STL:
 #include <cmath>
 #include <map>
+#include <algorithm>
 
 using namespace bpp;
 using namespace std;
@@ -65,6 +64,75 @@ void PairwiseDivergenceMafStatistics::compute(const MafBlock& block)
     result_.setValue(100. - SequenceTools::getPercentIdentity(*seqs1[0], *seqs2[0], true));
 }
 
+DivergenceMatrixMafStatistics::DivergenceMatrixMafStatistics(const std::vector<std::string>& species):
+  AbstractMafStatistics(),
+  species_(species),
+  tags_(),
+  slots_(),
+  nbDiff_(),
+  nbComparable_()
+{
+  if (VectorTools::unique(species).size() != species.size())
+    throw Exception("DivergenceMatrixMafStatistics (constructor). Duplicated species name!");
+  for (size_t i = 0; i < species_.size(); ++i) {
+    for (size_t j = i + 1; j < species_.size(); ++j) {
+      tags_.push_back(species_[i] + "-" + species_[j]);
+      slots_.push_back(result_.addSlot(tags_.back()));
+    }
+  }
+  nbDiff_.resize(tags_.size());
+  nbComparable_.resize(tags_.size());
+}
+
+void DivergenceMatrixMafStatistics::compute(const MafBlock& block)
+{
+  //Number of columns compared at once, so that all rows of a tile remain in cache:
+  static const size_t TILE_SIZE = 1024;
+
+  size_t n = species_.size();
+  vector<const int*> rows(n, 0);
+  for (size_t i = 0; i < n; ++i) {
+    vector<const MafSequence*> seqs = block.getSequencesForSpecies(species_[i]);
+    if (seqs.size() > 1)
+      throw Exception("DivergenceMatrixMafStatistics::compute. Duplicated sequence for species " + species_[i] + ".");
+    if (seqs.size() == 1 && seqs[0]->size() > 0)
+      rows[i] = &seqs[0]->getContent()[0];
+  }
+  nbDiff_.assign(tags_.size(), 0);
+  nbComparable_.assign(tags_.size(), 0);
+  size_t nbSites = block.getNumberOfSites();
+  for (size_t tileBegin = 0; tileBegin < nbSites; tileBegin += TILE_SIZE) {
+    size_t tileEnd = min(nbSites, tileBegin + TILE_SIZE);
+    for (size_t i = 0; i < n; ++i) {
+      if (!rows[i]) continue;
+      const int* row1 = rows[i];
+      for (size_t j = i + 1; j < n; ++j) {
+        if (!rows[j]) continue;
+        const int* row2 = rows[j];
+        unsigned int nbDiff = 0, nbComp = 0;
+        for (size_t c = tileBegin; c < tileEnd; ++c) {
+          //Gaps are coded as -1:
+          unsigned int comparable = (row1[c] >= 0) & (row2[c] >= 0);
+          nbComp += comparable;
+          nbDiff += comparable & (row1[c] != row2[c]);
+        }
+        size_t k = getPairIndex(i, j);
+        nbDiff_[k] += nbDiff;
+        nbComparable_[k] += nbComp;
+      }
+    }
+  }
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = i + 1; j < n; ++j) {
+      size_t k = getPairIndex(i, j);
+      if (!rows[i] || !rows[j])
+        result_.setValue(slots_[k], NumConstants::NaN());
+      else
+        result_.setValue(slots_[k], 100. * static_cast<double>(nbDiff_[k]) / static_cast<double>(nbComparable_[k]));
+    }
+  }
+}
+
 SiteContainer* AbstractSpeciesSelectionMafStatistics::getSiteContainer_(const MafBlock& block)
 {
   if (noSpeciesMeansAllSpecies_ && species_.size() == 0) {
@@ -83,6 +151,46 @@ SiteContainer* AbstractSpeciesSelectionMafStatistics::getSiteContainer_(const Ma
   return alignment;
 }
 
+const ColumnCounts& AbstractSpeciesSelectionMafStatistics::getColumnCounts_(const MafBlock& block)
+{
+  if (noSpeciesMeansAllSpecies_ && species_.size() == 0) {
+    return block.getColumnCounts(VectorTools::unique(block.getSpeciesList()), true);
+  }
+  return block.getColumnCounts(species_, true);
+}
+
+void AbstractSpeciesSelectionMafStatistics::getSelectedSequences_(const MafBlock& block, std::vector<const MafSequence*>& selection) const
+{
+  selection.clear();
+  bool all = (noSpeciesMeansAllSpecies_ && species_.size() == 0);
+  for (size_t i = 0; i < block.getNumberOfSequences(); ++i) {
+    const MafSequence& seq = block.getSequence(i);
+    if (all || find(species_.begin(), species_.end(), seq.getSpecies()) != species_.end())
+      selection.push_back(&seq);
+  }
+}
+
+string AbstractSpeciesSelectionMafStatistics::getSelectionKey_() const
+{
+  if (noSpeciesMeansAllSpecies_ && species_.size() == 0)
+    return "*";
+  string key;
+  for (size_t i = 0; i < species_.size(); ++i)
+    key += species_[i] + "\t";
+  return key;
+}
+
+void AbstractSpeciesMultipleSelectionMafStatistics::getSelectedRows_(const MafBlock& block, size_t k, std::vector<const std::vector<int>*>& rows) const
+{
+  rows.clear();
+  for (size_t i = 0; i < species_[k].size(); ++i) {
+    vector<const MafSequence*> selection = block.getSequencesForSpecies(species_[k][i]);
+    for (size_t j = 0; j < selection.size(); ++j) {
+      rows.push_back(&selection[j]->getContent());
+    }
+  }
+}
+
 AbstractSpeciesMultipleSelectionMafStatistics::AbstractSpeciesMultipleSelectionMafStatistics(const std::vector< std::vector<std::string> >& species):
   species_(species)
 {
@@ -126,17 +234,22 @@ vector<string> CharacterCountsMafStatistics::getSupportedTags() const
 
 void CharacterCountsMafStatistics::compute(const MafBlock& block)
 {
-  std::map<int, int> counts;
-  unique_ptr<SiteContainer> sites(getSiteContainer_(block));
-  SequenceContainerTools::getCounts(*sites, counts); 
+  //Sequences are read in place, and counts accumulated in a fixed-size array (gaps first):
+  unsigned int counts[ColumnCounts::NB_CODES] = {0};
+  getSelectedSequences_(block, selection_);
+  for (size_t j = 0; j < selection_.size(); ++j) {
+    const vector<int>& content = selection_[j]->getContent();
+    if (content.size() > 0)
+      ColumnCounts::countStates(&content[0], content.size(), counts);
+  }
   for (int i = 0; i < static_cast<int>(alphabet_->getSize()); ++i) {
-    result_.setValue(alphabet_->intToChar(i), counts[i]);
+    result_.setValue(alphabet_->intToChar(i), counts[i + 1]);
   }
-  result_.setValue("Gap", counts[alphabet_->getGapCharacterCode()]);
+  result_.setValue("Gap", counts[0]);
   double countUnres = 0;
-  for (map<int, int>::iterator it = counts.begin(); it != counts.end(); ++it) {
-    if (alphabet_->isUnresolved(it->first))
-      countUnres += it->second;
+  for (int i = 0; i < static_cast<int>(ColumnCounts::NB_CODES) - 1; ++i) {
+    if (alphabet_->isUnresolved(i))
+      countUnres += counts[i + 1];
   }
   result_.setValue("Unresolved", countUnres);
 }
@@ -155,93 +268,113 @@ vector<string> SiteFrequencySpectrumMafStatistics::getSupportedTags() const
 
 void SiteFrequencySpectrumMafStatistics::compute(const MafBlock& block)
 {
+  //Number of columns transposed at once:
+  static const size_t TILE_SIZE = 256;
+
   unsigned int nbUnresolved = 0;
   unsigned int nbSaturated = 0;
   unsigned int nbIgnored = 0;
   counts_.assign(categorizer_.getNumberOfCategories(), 0);
-  int state;
   bool hasOutgroup = (outgroup_ != "");
   bool isAnalyzable;
-  unique_ptr<SiteContainer> alignment;
-  const Sequence* outgroupSeq = 0;
+  const MafSequence* outgroupSeq = 0;
   if (hasOutgroup) {
     isAnalyzable = (block.hasSequenceForSpecies(outgroup_) && block.getNumberOfSequences() > 1);
     if (isAnalyzable) {
       //We need to extract the outgroup sequence:
       outgroupSeq = &block.getSequenceForSpecies(outgroup_); //Here we assume there is only one! Otherwise we take the first one...
-      alignment.reset(getSiteContainer_(block));
     }
   } else {
     isAnalyzable = (block.getNumberOfSequences() > 0);
-    if (isAnalyzable)
-      alignment.reset(getSiteContainer_(block));
   }
+  selection_.clear();
   if (isAnalyzable) {
-    for (size_t i = 0; i < alignment->getNumberOfSites(); ++i) {
-      //Note: we do not rely on SiteTool::getCounts as it would be unefficient to count everything.
-      const Site& site = alignment->getSite(i);
-      map<int, unsigned int> counts;
+    //Rows are taken in the order of the species selection, as sites are scanned in this order:
+    const vector<string>& species = getSpecies_();
+    for (size_t i = 0; i < species.size(); ++i) {
+      vector<const MafSequence*> seqs = block.getSequencesForSpecies(species[i]);
+      selection_.insert(selection_.end(), seqs.begin(), seqs.end());
+    }
+  }
+  size_t nr = isAnalyzable ? selection_.size() : 0;
+  size_t nc = nr > 0 ? block.getNumberOfSites() : 0;
+  tile_.resize(TILE_SIZE * nr);
+  for (size_t tileBegin = 0; tileBegin < nc; tileBegin += TILE_SIZE) {
+    size_t tileSize = min(TILE_SIZE, nc - tileBegin);
+    //Transpose the rows of the ingroup for this tile:
+    for (size_t j = 0; j < nr; ++j) {
+      const int* row = &selection_[j]->getContent()[tileBegin];
+      for (size_t c = 0; c < tileSize; ++c)
+        tile_[c * nr + j] = row[c];
+    }
+    for (size_t c = 0; c < tileSize; ++c) {
+      const int* column = &tile_[c * nr];
+      //Gaps and unresolved characters are all states outside [0, 3].
+      //The scan stops at the first unresolved character or at the third observed state, whichever comes first:
+      unsigned int alleles[4] = {0, 0, 0, 0};
+      unsigned int nbStates = 0;
       bool isUnresolved = false;
-      bool isSaturated = false;
-      for (size_t j = 0; !isUnresolved && !isSaturated && j < site.size(); ++j) {
-        state = site[j];
-        if (alphabet_->isGap(state) || alphabet_->isUnresolved(state)) {
+      for (size_t j = 0; j < nr && nbStates <= 2; ++j) {
+        unsigned int state = static_cast<unsigned int>(column[j]);
+        if (state > 3) {
           isUnresolved = true;
-        } else {
-          counts[state]++;
-          if (counts.size() > 2) {
-            isSaturated = true;
-          }
+          break;
         }
+        if (alleles[state]++ == 0)
+          nbStates++;
       }
       if (isUnresolved) {
         nbUnresolved++;
-      } else if (isSaturated) {
+        continue;
+      }
+      if (nbStates > 2) {
         nbSaturated++;
-      } else if (hasOutgroup && (
-          alignment->getAlphabet()->isGap((*outgroupSeq)[i]) ||
-          alignment->getAlphabet()->isUnresolved((*outgroupSeq)[i]))) {
+        continue;
+      }
+      //Get the (at most two) observed states:
+      int state1 = -1, state2 = -1;
+      for (int k = 0; k < 4; ++k) {
+        if (alleles[k] > 0) {
+          if (state1 < 0) state1 = k;
+          else state2 = k;
+        }
+      }
+      int ancestral = hasOutgroup ? (*outgroupSeq)[tileBegin + c] : -1;
+      if (hasOutgroup && (ancestral < 0 || ancestral > 3)) {
         nbUnresolved++;
-      } else {
-        //Determine frequency class:
-        double count;
-        if (counts.size() == 1) {
-          if (hasOutgroup) {
-            if (counts.begin()->first == (*outgroupSeq)[i])
-              count = 0; //This is the ancestral state.
-            else
-              count = counts.begin()->second; //This is a derived state.
-          } else {
-            count = 0; //In this case we do not know, so we put 0.
-          }
+        continue;
+      }
+      //Determine frequency class:
+      double count;
+      if (nbStates == 1) {
+        if (hasOutgroup) {
+          if (state1 == ancestral)
+            count = 0; //This is the ancestral state.
+          else
+            count = alleles[state1]; //This is a derived state.
         } else {
-          map<int, unsigned int>::iterator it = counts.begin();
-          unsigned int count1 = it->second;
-          it++;
-          unsigned int count2 = it->second;
-          if (hasOutgroup) {
-            if (counts.begin()->first == (*outgroupSeq)[i])
-              count = counts.rbegin()->second; //This is the ancestral state, therefore we other one is the derived state.
-            else if (counts.rbegin()->first == (*outgroupSeq)[i])
-              count = counts.begin()->second; //The second state is the ancestral one, therefore the first one is the derived state.
-            else {
-              //None of the two states are ancestral! The position is therefore discarded.
-              isSaturated = true;
-            }
-          } else {
-            count = min(count1, count2); //In this case we do not know, so we take the minimum of the two values.
-          }
+          count = 0; //In this case we do not know, so we put 0.
         }
-        if (isSaturated)
-          nbSaturated++;
-        else {
-          try {
-            counts_[categorizer_.getCategory(count) - 1]++;
-          } catch (OutOfRangeException& oof) {
-            nbIgnored++;
+      } else {
+        if (hasOutgroup) {
+          if (state1 == ancestral)
+            count = alleles[state2]; //This is the ancestral state, therefore we other one is the derived state.
+          else if (state2 == ancestral)
+            count = alleles[state1]; //The second state is the ancestral one, therefore the first one is the derived state.
+          else {
+            //None of the two states are ancestral! The position is therefore discarded.
+            nbSaturated++;
+            continue;
           }
+        } else {
+          count = min(alleles[state1], alleles[state2]); //In this case we do not know, so we take the minimum of the two values.
         }
       }
+      try {
+        counts_[categorizer_.getCategory(count) - 1]++;
+      } catch (OutOfRangeException& oof) {
+        nbIgnored++;
+      }
     }
   }
   result_.setValue("Unresolved", nbUnresolved);
@@ -249,7 +382,59 @@ void SiteFrequencySpectrumMafStatistics::compute(const MafBlock& block)
   result_.setValue("Ignored", nbIgnored);
   for (size_t i = 0; i < counts_.size(); ++i) {
     result_.setValue("Bin" + TextTools::toString(i + 1), counts_[i]);
+    totalCounts_[i] += counts_[i];
   }
+  size_t nb = counts_.size();
+  totalCounts_[nb]     += nbUnresolved;
+  totalCounts_[nb + 1] += nbSaturated;
+  totalCounts_[nb + 2] += nbIgnored;
+  updateAccumulatedResult_();
+}
+
+const MafStatisticsResult& SiteFrequencySpectrumMafStatistics::getAccumulatedResult() const
+{
+  return totalResult_;
+}
+
+void SiteFrequencySpectrumMafStatistics::updateAccumulatedResult_()
+{
+  //Slots were created in the order of the accumulated counts:
+  for (size_t i = 0; i < totalCounts_.size(); ++i)
+    totalResult_.setValue(i, static_cast<double>(totalCounts_[i]), MafStatisticsResult::UNSIGNED_INT_VALUE);
+}
+
+void SiteFrequencySpectrumMafStatistics::merge(const MergeableMafStatistics& stats)
+{
+  const SiteFrequencySpectrumMafStatistics* sfs = dynamic_cast<const SiteFrequencySpectrumMafStatistics*>(&stats);
+  if (!sfs || sfs->totalCounts_.size() != totalCounts_.size())
+    throw Exception("SiteFrequencySpectrumMafStatistics::merge. Incompatible statistics.");
+  for (size_t i = 0; i < totalCounts_.size(); ++i)
+    totalCounts_[i] += sfs->totalCounts_[i];
+  updateAccumulatedResult_();
+}
+
+void SiteFrequencySpectrumMafStatistics::writeState(ostream& out) const
+{
+  out << totalCounts_.size();
+  for (size_t i = 0; i < totalCounts_.size(); ++i)
+    out << " " << totalCounts_[i];
+  out << endl;
+}
+
+void SiteFrequencySpectrumMafStatistics::mergeState(istream& in)
+{
+  size_t n = 0;
+  in >> n;
+  if (!in || n != totalCounts_.size())
+    throw Exception("SiteFrequencySpectrumMafStatistics::mergeState. Incompatible statistics.");
+  for (size_t i = 0; i < n; ++i) {
+    unsigned int count = 0;
+    in >> count;
+    if (!in)
+      throw IOException("SiteFrequencySpectrumMafStatistics::mergeState. Unexpected end of state.");
+    totalCounts_[i] += count;
+  }
+  updateAccumulatedResult_();
 }
 
 vector<string> FourSpeciesPatternCountsMafStatistics::getSupportedTags() const
@@ -265,27 +450,55 @@ vector<string> FourSpeciesPatternCountsMafStatistics::getSupportedTags() const
 void FourSpeciesPatternCountsMafStatistics::compute(const MafBlock& block)
 {
   counts_.assign(6, 0);
-  unique_ptr<SiteContainer> alignment(getSiteContainer_(block));
-  if (alignment->getNumberOfSequences() == 4) {
+  //Get the four sequences, in species order:
+  const vector<string>& species = getSpecies_();
+  const MafSequence* rows[4];
+  bool isAnalyzable = true;
+  for (size_t j = 0; j < 4 && isAnalyzable; ++j) {
+    vector<const MafSequence*> selection = block.getSequencesForSpecies(species[j]);
+    isAnalyzable = (selection.size() == 1);
+    if (isAnalyzable) rows[j] = selection[0];
+  }
+  size_t nbSites = block.getNumberOfSites();
+  if (isAnalyzable) {
     unsigned int nbIgnored = 0;
-    for (size_t i = 0; i < block.getNumberOfSites(); ++i) {
-      const Site& site = alignment->getSite(i);
-      if (SiteTools::isComplete(site)) {
-        if (site[0] == site[1] &&
-            site[2] != site[1] &&
-            site[3] == site[2])
-          counts_[0]++;
-        else if (site[1] == site[2] &&
-            site[1] != site[0] &&
-            site[3] == site[0])
-          counts_[1]++;
-        else if (site[0] == site[2] &&
-            site[1] != site[0] &&
-            site[3] == site[1])
-          counts_[2]++;
-      } else {
-        nbIgnored++;
+    const int* states[4];
+    for (size_t j = 0; j < 4; ++j)
+      states[j] = nbSites > 0 ? &rows[j]->getContent()[0] : 0;
+    //Sites are analysed 64 at a time, each sequence being encoded as one bitplane per nucleotide:
+    for (size_t w = 0; w < nbSites; w += 64) {
+      size_t n = min(static_cast<size_t>(64), nbSites - w);
+      uint64_t planes[4][4] = {{0}};
+      for (size_t j = 0; j < 4; ++j) {
+        const int* row = states[j] + w;
+        for (size_t k = 0; k < n; ++k) {
+          unsigned int state = static_cast<unsigned int>(row[k]);
+          if (state < 4)
+            planes[j][state] |= (1ULL << k);
+        }
       }
+      uint64_t complete = ~0ULL;
+      for (size_t j = 0; j < 4; ++j)
+        complete &= planes[j][0] | planes[j][1] | planes[j][2] | planes[j][3];
+      uint64_t eq01 = 0, eq02 = 0, eq03 = 0, eq12 = 0, eq13 = 0, eq23 = 0;
+      for (size_t b = 0; b < 4; ++b) {
+        eq01 |= planes[0][b] & planes[1][b];
+        eq02 |= planes[0][b] & planes[2][b];
+        eq03 |= planes[0][b] & planes[3][b];
+        eq12 |= planes[1][b] & planes[2][b];
+        eq13 |= planes[1][b] & planes[3][b];
+        eq23 |= planes[2][b] & planes[3][b];
+      }
+      //Equalities only hold for resolved states, the three patterns are mutually exclusive:
+      uint64_t masks[3];
+      masks[0] = eq01 & eq23 & ~eq12; //f1100
+      masks[1] = eq12 & eq03 & ~eq01; //f0110
+      masks[2] = eq02 & eq13 & ~eq01; //f1010
+      for (size_t p = 0; p < 3; ++p)
+        counts_[p] += BitTools::popcount(masks[p]);
+      nbIgnored += static_cast<unsigned int>(n) - BitTools::popcount(complete & (n == 64 ? ~0ULL : ((1ULL << n) - 1)));
+      if (jackknifeBlockSize_ > 0)
+        addJackknifeCounts_(nbSitesSeen_ + w, masks, n);
     }
     result_.setValue("f1100", counts_[0]);
     result_.setValue("f0110", counts_[1]);
@@ -295,8 +508,55 @@ void FourSpeciesPatternCountsMafStatistics::compute(const MafBlock& block)
     result_.setValue("f1100", 0);
     result_.setValue("f0110", 0);
     result_.setValue("f1010", 0);
-    result_.setValue("Ignored", static_cast<double>(block.getNumberOfSites()));
+    result_.setValue("Ignored", static_cast<double>(nbSites));
+  }
+  nbSitesSeen_ += nbSites;
+}
+
+void FourSpeciesPatternCountsMafStatistics::addJackknifeCounts_(size_t pos, const uint64_t masks[3], size_t nbBits)
+{
+  size_t k = 0;
+  while (k < nbBits) {
+    //Sites k to end-1 belong to the same jackknife block:
+    size_t bin = (pos + k) / jackknifeBlockSize_;
+    size_t end = min(nbBits, (bin + 1) * jackknifeBlockSize_ - pos);
+    uint64_t range = (end == 64 ? ~0ULL : ((1ULL << end) - 1)) & ~((1ULL << k) - 1);
+    if (jackknifeCounts_.size() < 3 * (bin + 1))
+      jackknifeCounts_.resize(3 * (bin + 1), 0);
+    for (size_t p = 0; p < 3; ++p)
+      jackknifeCounts_[3 * bin + p] += BitTools::popcount(masks[p] & range);
+    k = end;
+  }
+}
+
+void FourSpeciesPatternCountsMafStatistics::computeDStatistic(const std::vector<unsigned int>& jackknifeCounts, double& d, double& se)
+{
+  size_t nbBlocks = jackknifeCounts.size() / 3;
+  double abba = 0, baba = 0;
+  for (size_t i = 0; i < nbBlocks; ++i) {
+    abba += jackknifeCounts[3 * i + 1];
+    baba += jackknifeCounts[3 * i + 2];
+  }
+  d = (abba - baba) / (abba + baba);
+  se = NumConstants::NaN();
+  if (nbBlocks < 2) return;
+  vector<double> partials;
+  for (size_t i = 0; i < nbBlocks; ++i) {
+    double a = abba - jackknifeCounts[3 * i + 1];
+    double b = baba - jackknifeCounts[3 * i + 2];
+    if (a + b > 0)
+      partials.push_back((a - b) / (a + b));
   }
+  double n = static_cast<double>(partials.size());
+  if (n < 2) return;
+  double mean = 0;
+  for (size_t i = 0; i < partials.size(); ++i)
+    mean += partials[i];
+  mean /= n;
+  double ss = 0;
+  for (size_t i = 0; i < partials.size(); ++i)
+    ss += (partials[i] - mean) * (partials[i] - mean);
+  se = sqrt((n - 1) / n * ss);
 }
 
 vector<string> SiteMafStatistics::getSupportedTags() const
@@ -312,43 +572,48 @@ vector<string> SiteMafStatistics::getSupportedTags() const
   return tags;
 }
 
-void SiteMafStatistics::compute(const MafBlock& block)
-{
-  unique_ptr<SiteContainer> alignment(getSiteContainer_(block));
-  unsigned int nbNg = 0;
-  unsigned int nbCo = 0;
-  unsigned int nbPi = 0;
-  unsigned int nbP1 = 0;
-  unsigned int nbP2 = 0;
-  unsigned int nbP3 = 0;
-  unsigned int nbP4 = 0;
-  if (alignment->getNumberOfSequences() > 0) {
-    for (size_t i = 0; i < alignment->getNumberOfSites(); ++i) {
-      if (!SiteTools::hasGap(alignment->getSite(i)))
-        nbNg++;
-      if (SiteTools::isComplete(alignment->getSite(i))) {
-        nbCo++;
-        map<int, size_t> counts;
-        SiteTools::getCounts(alignment->getSite(i), counts);
-        switch (counts.size()) {
-          case 1: nbP1++; break;
-          case 2: nbP2++; break;
-          case 3: nbP3++; break;
-          case 4: nbP4++; break;
-          default: throw Exception("The impossible happened. Probably a distortion in the Minkowski space.");
-        }
-      }
-      if (SiteTools::isParsimonyInformativeSite(alignment->getSite(i)))
-        nbPi++;
+void SiteMafStatistics::beginSweep(const MafBlock& block, const ColumnCounts& counts)
+{
+  nbRows_ = counts.getNumberOfRows();
+  nbNg_ = nbCo_ = nbPi_ = nbP1_ = nbP2_ = nbP3_ = nbP4_ = 0;
+}
+
+void SiteMafStatistics::processColumn(const ColumnCounts& counts, size_t site)
+{
+  if (nbRows_ == 0) return;
+  const unsigned int* siteCounts = counts.getCounts(site);
+  if (counts.getNumberOfGaps(site) == 0)
+    nbNg_++;
+  if (counts.getNumberOfResolved(site) == nbRows_) {
+    nbCo_++;
+    unsigned int nbStates = 0;
+    for (size_t k = 1; k < 5; ++k)
+      if (siteCounts[k] > 0) nbStates++;
+    switch (nbStates) {
+      case 1: nbP1_++; break;
+      case 2: nbP2_++; break;
+      case 3: nbP3_++; break;
+      case 4: nbP4_++; break;
+      default: throw Exception("The impossible happened. Probably a distortion in the Minkowski space.");
     }
   }
-  result_.setValue("NbWithoutGap", nbNg);
-  result_.setValue("NbComplete", nbCo);
-  result_.setValue("NbConstant", nbP1);
-  result_.setValue("NbBiallelic", nbP2);
-  result_.setValue("NbTriallelic", nbP3);
-  result_.setValue("NbQuadriallelic", nbP4);
-  result_.setValue("NbParsimonyInformative", nbPi);
+  //Parsimony informative sites have at least two characters (including gaps) occurring at least twice:
+  unsigned int nbPars = 0;
+  for (size_t k = 0; k < ColumnCounts::NB_CODES; ++k)
+    if (siteCounts[k] > 1) nbPars++;
+  if (nbPars > 1)
+    nbPi_++;
+}
+
+void SiteMafStatistics::endSweep()
+{
+  result_.setValue("NbWithoutGap", nbNg_);
+  result_.setValue("NbComplete", nbCo_);
+  result_.setValue("NbConstant", nbP1_);
+  result_.setValue("NbBiallelic", nbP2_);
+  result_.setValue("NbTriallelic", nbP3_);
+  result_.setValue("NbQuadriallelic", nbP4_);
+  result_.setValue("NbParsimonyInformative", nbPi_);
 }
 
 vector<string> PolymorphismMafStatistics::getSupportedTags() const
@@ -367,27 +632,24 @@ vector<string> PolymorphismMafStatistics::getSupportedTags() const
   return tags;
 }
 
-vector<int> PolymorphismMafStatistics::getPatterns_(const SiteContainer& sites)
+void PolymorphismMafStatistics::getPatterns_(const std::vector<const std::vector<int>*>& rows, size_t nbSites, std::vector<int>& patterns)
 {
-  vector<int> patterns(sites.getNumberOfSites());
-  for (size_t i = 0; i < sites.getNumberOfSites(); ++i) {
-    const Site& site = sites.getSite(i);
-    int s = -1; //Unresolved
-    if (SiteTools::isComplete(site)) {
-      if (SiteTools::isConstant(site)) {
-        s = site[0]; //The fixed state
+  patterns.assign(nbSites, -1); //Unresolved
+  if (rows.size() == 0) return;
+  ColumnClassification classes(rows, nbSites);
+  for (size_t i = 0; i < nbSites; ++i) {
+    if (classes.isComplete(i)) {
+      if (classes.isConstant(i)) {
+        patterns[i] = (*rows[0])[i]; //The fixed state
       } else {
-        s = -10; //Polymorphic.
+        patterns[i] = -10; //Polymorphic.
       }
     }
-    patterns[i] = s;
   }
-  return patterns;
 }
 
 void PolymorphismMafStatistics::compute(const MafBlock& block)
 {
-  vector<SiteContainer*> alignments(getSiteContainers_(block));
   unsigned int nbF = 0;
   unsigned int nbP = 0;
   unsigned int nbFF = 0;
@@ -399,14 +661,12 @@ void PolymorphismMafStatistics::compute(const MafBlock& block)
   unsigned int nbXF = 0;
   unsigned int nbXP = 0;
   //Get all patterns:
-  vector<int> patterns1(block.getNumberOfSites(), -1);
-  vector<int> patterns2(block.getNumberOfSites(), -1); 
-  if (alignments[0]->getNumberOfSequences() > 0) {
-    patterns1 = getPatterns_(*alignments[0]);
-  }
-  if (alignments[1]->getNumberOfSequences() > 0) {
-    patterns2 = getPatterns_(*alignments[1]);
-  }
+  vector<const vector<int>*> rows;
+  vector<int> patterns1, patterns2;
+  getSelectedRows_(block, 0, rows);
+  getPatterns_(rows, block.getNumberOfSites(), patterns1);
+  getSelectedRows_(block, 1, rows);
+  getPatterns_(rows, block.getNumberOfSites(), patterns2);
   //Compare patterns:
   for (size_t i = 0; i < block.getNumberOfSites(); ++i) {
     int p1 = patterns1[i];  
@@ -478,27 +738,38 @@ vector<string> SequenceDiversityMafStatistics::getSupportedTags() const
   return tags;
 }
 
-void SequenceDiversityMafStatistics::compute(const MafBlock& block)
-{
-  unique_ptr<SiteContainer> alignment(getSiteContainer_(block));
-  //Get only complete sites:
-  unique_ptr<SiteContainer> alignment2(SiteContainerTools::getCompleteSites(*alignment));
-  double S = 0;
-  size_t nbTot = 0;
-  size_t n = alignment2->getNumberOfSequences();
-  if (n > 0) {
-    for (size_t i = 0; i < alignment2->getNumberOfSites(); ++i) {
-      const Site& site = alignment2->getSite(i);
-      if (SiteTools::isComplete(site)) {
-        nbTot++;
-        if (!SiteTools::isConstant(site))
-          S++;
-      }
-    }
-  } else {
-    size_t nbTot = alignment2->getNumberOfSites();
+void SequenceDiversityMafStatistics::beginSweep(const MafBlock& block, const ColumnCounts& counts)
+{
+  //All estimates are obtained from the allele counts of complete sites, in O(n.L):
+  nbRows_ = counts.getNumberOfRows();
+  nbTot_ = 0;
+  nbSegregating_ = 0;
+  sumDiff_ = 0;
+}
+
+void SequenceDiversityMafStatistics::processColumn(const ColumnCounts& counts, size_t site)
+{
+  if (nbRows_ == 0 || counts.getNumberOfResolved(site) != nbRows_) return;
+  nbTot_++;
+  const unsigned int* siteCounts = counts.getCounts(site);
+  double sumSq = 0;
+  unsigned int nbStates = 0;
+  for (size_t k = 1; k < 5; ++k) {
+    double c = static_cast<double>(siteCounts[k]);
+    sumSq += c * c;
+    if (siteCounts[k] > 0) nbStates++;
   }
+  if (nbStates > 1)
+    nbSegregating_++;
+  double n = static_cast<double>(nbRows_);
+  sumDiff_ += (n * n - sumSq) / 2.;
+}
 
+void SequenceDiversityMafStatistics::endSweep()
+{
+  double S = nbSegregating_;
+  size_t nbTot = nbTot_;
+  size_t n = nbRows_;
   double a1 = 0;
   double a2 = 0;
   double dn = static_cast<double>(n);
@@ -514,19 +785,8 @@ void SequenceDiversityMafStatistics::compute(const MafBlock& block)
   double e1 = c1 / a1;
   double e2 = c2 / (a1 * a1 + a2);
   
-  //Compute pairwise heterozigosity:
-  double pi = 0;
-  for (size_t i = 0; i < n - 1; ++i) {
-    for (size_t j = i + 1; j < n; ++j) {
-      pi += SiteContainerTools::computeSimilarity(
-          alignment2->getSequence(i),
-          alignment2->getSequence(j),
-          true,
-          SiteContainerTools::SIMILARITY_NOGAP,
-          true);
-    }
-  }
-  pi /= static_cast<double>((n - 1) * n / 2);
+  //Compute pairwise heterozigosity, as the mean proportion of differences over all pairs of sequences:
+  double pi = sumDiff_ / (static_cast<double>(nbTot) * static_cast<double>((n - 1) * n / 2));
 
   //Compute Tajima's D:
   double tajd = static_cast<double>(nbTot) * (pi - wt) / sqrt(e1 * S + e2 * S * (S - 1));
@@ -41,49 +41,112 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _MAFSTATISTICS_H_
 
 #include "MafBlock.h"
+#include "ColumnClassification.h"
 
 //From bpp-core:
-#include <Bpp/Utils/MapTools.h>
 #include <Bpp/Numeric/VectorTools.h>
-#include <Bpp/Numeric/Number.h>
+#include <Bpp/Text/TextTools.h>
 
 //From the STL:
 #include <map>
 #include <string>
+#include <iostream>
 
 namespace bpp {
 
 /**
  * @brief General interface for storing statistical results.
  *
+ * Values are stored in a contiguous array, with one slot per tag.
+ * A slot is associated to a tag when a value is first set (or with addSlot()), and remains valid for the lifetime of the result,
+ * so that tags can be resolved once (see getSlot()) and values then accessed directly.
+ * Const methods never modify the result, which can therefore be read from several threads.
+ * The type of each value is recorded for output.
+ *
  * @author Julien Dutheil
  * @see MafStatistics
  */
 class MafStatisticsResult
 {
+  public:
+    enum ValueType { NO_VALUE = 0, DOUBLE_VALUE, INT_VALUE, UNSIGNED_INT_VALUE };
+
   protected:
-    mutable std::map<std::string, BppNumberI*> values_;
+    std::vector<std::string> tags_;
+    std::vector<double> values_;
+    std::vector<ValueType> types_;
 
   public:
-    MafStatisticsResult(): values_() {}
+    MafStatisticsResult(): tags_(), values_(), types_() {}
+
+    /**
+     * @brief Build a result with one slot per tag, in the given order.
+     *
+     * @param tags The tags of all slots.
+     */
+    MafStatisticsResult(const std::vector<std::string>& tags):
+      tags_(tags), values_(tags.size(), 0), types_(tags.size(), NO_VALUE) {}
+
     virtual ~MafStatisticsResult() {}
 
-    MafStatisticsResult(const MafStatisticsResult& msr): values_()
-    {
-      for (std::map<std::string, BppNumberI*>::const_iterator it = msr.values_.begin();
-          it != msr.values_.end();
-          ++it) {
-        values_[it->first] = it->second->clone();
+  public:
+    /**
+     * @return The slot associated to a tag.
+     * @param tag The name of the value.
+     * @throw Exception if no slot is associated to the tag.
+     */
+    size_t getSlot(const std::string& tag) const {
+      size_t slot = findSlot_(tag);
+      if (slot == tags_.size())
+        throw Exception("MafStatisticsResult::getSlot(). No slot found for tag: " + tag + ".");
+      return slot;
+    }
+
+    /**
+     * @return A boolean saying whether a slot is associated to the given tag.
+     * @param tag The name of the value.
+     */
+    bool hasSlot(const std::string& tag) const { return findSlot_(tag) < tags_.size(); }
+
+    /**
+     * @return The slot associated to a tag. A new, empty slot is created if needed.
+     * @param tag The name of the value.
+     */
+    size_t addSlot(const std::string& tag) {
+      size_t slot = findSlot_(tag);
+      if (slot == tags_.size()) {
+        tags_.push_back(tag);
+        values_.push_back(0);
+        types_.push_back(NO_VALUE);
       }
+      return slot;
     }
 
-  public:
-    virtual const BppNumberI& getValue(const std::string& tag) const {
-      std::map<std::string, BppNumberI*>::iterator it = values_.find(tag);
-      if (it != values_.end())
-        return *it->second;
-      else
+    size_t getNumberOfSlots() const { return tags_.size(); }
+
+    const std::string& getTag(size_t slot) const { return tags_[slot]; }
+
+    virtual double getValue(const std::string& tag) const {
+      size_t slot = findSlot_(tag);
+      if (slot == tags_.size() || !hasValue(slot))
         throw Exception("MafStatisticsResult::getValue(). No value found for tag: " + tag + ".");
+      return values_[slot];
+    }
+
+    double getValue(size_t slot) const { return values_[slot]; }
+
+    ValueType getValueType(size_t slot) const { return types_[slot]; }
+
+    /**
+     * @return The value in a given slot, formatted according to its type, or "NA" if there is no value.
+     */
+    std::string getValueAsString(size_t slot) const {
+      switch (types_[slot]) {
+        case INT_VALUE: return TextTools::toString(static_cast<int>(values_[slot]));
+        case UNSIGNED_INT_VALUE: return TextTools::toString(static_cast<unsigned int>(values_[slot]));
+        case DOUBLE_VALUE: return TextTools::toString(values_[slot]);
+        default: return "NA";
+      }
     }
 
     /**
@@ -93,10 +156,7 @@ class MafStatisticsResult
      * @param value The value to associate to the tag.
      */
     virtual void setValue(const std::string& tag, double value) {
-      if (values_[tag]) {
-        delete values_[tag];
-      }
-      values_[tag] = new BppDouble(value);
+      setValue(addSlot(tag), value, DOUBLE_VALUE);
     }
 
     /**
@@ -106,10 +166,7 @@ class MafStatisticsResult
      * @param value The value to associate to the tag.
      */
     virtual void setValue(const std::string& tag, int value) {
-      if (values_[tag]) {
-        delete values_[tag];
-      }
-      values_[tag] = new BppInteger(value);
+      setValue(addSlot(tag), static_cast<double>(value), INT_VALUE);
     }
 
     /**
@@ -119,10 +176,19 @@ class MafStatisticsResult
      * @param value The value to associate to the tag.
      */
     virtual void setValue(const std::string& tag, unsigned int value) {
-      if (values_[tag]) {
-        delete values_[tag];
-      }
-      values_[tag] = new BppUnsignedInteger(value);
+      setValue(addSlot(tag), static_cast<double>(value), UNSIGNED_INT_VALUE);
+    }
+
+    /**
+     * @brief Set the value of a given slot.
+     *
+     * @param slot The slot index, as returned by getSlot() or addSlot().
+     * @param value The value.
+     * @param type The type of the value, or NO_VALUE to remove it.
+     */
+    void setValue(size_t slot, double value, ValueType type = DOUBLE_VALUE) {
+      values_[slot] = value;
+      types_[slot] = type;
     }
 
     /**
@@ -130,17 +196,33 @@ class MafStatisticsResult
      * @param tag The name of the value to associate.
      */
     virtual bool hasValue(const std::string& tag) const {
-      return (values_.find(tag) != values_.end()); 
+      size_t slot = findSlot_(tag);
+      return slot < tags_.size() && types_[slot] != NO_VALUE;
     }
 
+    bool hasValue(size_t slot) const { return types_[slot] != NO_VALUE; }
+
     /**
      * @return A vector with all available tags.
      */
-    std::vector<std::string> getAvailableTags() const { return MapTools::getKeys(values_); }
+    std::vector<std::string> getAvailableTags() const {
+      std::vector<std::string> tags;
+      for (size_t i = 0; i < tags_.size(); ++i)
+        if (types_[i] != NO_VALUE) tags.push_back(tags_[i]);
+      return tags;
+    }
+
+  private:
+    //Returns the number of slots if the tag is not found.
+    size_t findSlot_(const std::string& tag) const {
+      for (size_t i = 0; i < tags_.size(); ++i)
+        if (tags_[i] == tag) return i;
+      return tags_.size();
+    }
 };
 
 /**
- * @brief A simple maf statistics result, with only one value.
+ * @brief A simple maf statistics result, with only one value, in slot 0.
  */
 class SimpleMafStatisticsResult:
   public virtual MafStatisticsResult
@@ -149,17 +231,17 @@ class SimpleMafStatisticsResult:
     std::string name_;
 
   public:
-    SimpleMafStatisticsResult(const std::string& name): MafStatisticsResult(), name_(name) {
-      setValue(name, 0);
+    SimpleMafStatisticsResult(const std::string& name): MafStatisticsResult(std::vector<std::string>(1, name)), name_(name) {
+      setValue(0);
     }
     virtual ~SimpleMafStatisticsResult() {}
 
   public:
-    virtual const BppNumberI& getValue(const std::string& tag) const {
+    virtual double getValue(const std::string& tag) const {
       return MafStatisticsResult::getValue(tag);
     }
     
-    virtual const BppNumberI& getValue() const { return *values_[name_]; }
+    virtual double getValue() const { return values_[0]; }
 
     virtual void setValue(const std::string& tag, double value) {
       if (tag == name_)
@@ -182,20 +264,11 @@ class SimpleMafStatisticsResult:
         throw Exception("SimpleMafStatisticsResult::setValue(). Unvalid tag name: " + tag + ".");
     }
    
-    virtual void setValue(double value) {
-      if (values_[name_]) delete values_[name_];
-      values_[name_] = new BppDouble(value);
-    }
+    virtual void setValue(double value) { MafStatisticsResult::setValue(0, value, DOUBLE_VALUE); }
 
-    virtual void setValue(int value) {
-      if (values_[name_]) delete values_[name_];
-      values_[name_] = new BppInteger(value);
-    }
+    virtual void setValue(int value) { MafStatisticsResult::setValue(0, static_cast<double>(value), INT_VALUE); }
 
-    virtual void setValue(unsigned int value) {
-      if (values_[name_]) delete values_[name_];
-      values_[name_] = new BppUnsignedInteger(value);
-    }
+    virtual void setValue(unsigned int value) { MafStatisticsResult::setValue(0, static_cast<double>(value), UNSIGNED_INT_VALUE); }
 
 };
 
@@ -224,6 +297,50 @@ class MafStatistics
 
 };
 
+/**
+ * @brief Interface for statistics accumulating values over blocks, with partial results that can be merged.
+ *
+ * This enables reduction-style computations with several instances of the statistic, for instance one per thread
+ * (see ParallelSequenceStatisticsMafIterator). The per-block result returned by getResult() is not affected.
+ */
+class MergeableMafStatistics:
+  public virtual MafStatistics
+{
+  public:
+    MergeableMafStatistics() {}
+    virtual ~MergeableMafStatistics() {}
+
+  public:
+    /**
+     * @return The values accumulated over all blocks computed so far, including merged ones.
+     */
+    virtual const MafStatisticsResult& getAccumulatedResult() const = 0;
+
+    /**
+     * @brief Add the values accumulated by another instance of the same statistic.
+     *
+     * @param stats The other instance, which must be of the same type and have the same settings.
+     * @throw Exception if the statistics are not compatible.
+     */
+    virtual void merge(const MergeableMafStatistics& stats) = 0;
+
+    /**
+     * @brief Write the accumulated values, so that they can be merged in another process (see mergeState()).
+     *
+     * @param out The output stream.
+     */
+    virtual void writeState(std::ostream& out) const = 0;
+
+    /**
+     * @brief Add the values accumulated by another instance of the same statistic, as written by writeState().
+     *
+     * @param in The input stream.
+     * @throw Exception if the state is not compatible or cannot be read.
+     */
+    virtual void mergeState(std::istream& in) = 0;
+
+};
+
 /**
  * @brief Partial implementation of MafStatistics, for convenience.
  */
@@ -282,6 +399,55 @@ class PairwiseDivergenceMafStatistics:
 
 };
 
+/**
+ * @brief Computes the pairwise divergences between all pairs of species in a maf block.
+ *
+ * This is equivalent to using one PairwiseDivergenceMafStatistics per pair of species,
+ * but all pairs are compared in a single sweep over the block, by tiles of columns.
+ * For each pair, differences are counted over sites where none of the two sequences has a gap,
+ * and the divergence is reported as a percentage, with tag 'species1-species2'.
+ * The divergence is NaN if one of the species is missing, and an exception is thrown if a species is duplicated.
+ */
+class DivergenceMatrixMafStatistics:
+  public AbstractMafStatistics
+{
+  private:
+    std::vector<std::string> species_;
+    std::vector<std::string> tags_;
+    std::vector<size_t> slots_;
+    //Per-pair counts for the last block, pairs in the order of tags_:
+    std::vector<unsigned int> nbDiff_;
+    std::vector<unsigned int> nbComparable_;
+
+  public:
+    DivergenceMatrixMafStatistics(const std::vector<std::string>& species);
+
+    virtual ~DivergenceMatrixMafStatistics() {}
+
+  public:
+    std::string getShortName() const { return "DivMatrix"; }
+    std::string getFullName() const { return "Pairwise divergence matrix."; }
+    void compute(const MafBlock& block);
+    std::vector<std::string> getSupportedTags() const { return tags_; }
+
+    /**
+     * @return The index of the pair (i, j), i < j, in the vectors of counts.
+     */
+    size_t getPairIndex(size_t i, size_t j) const {
+      return i * species_.size() - i * (i + 1) / 2 + (j - i - 1);
+    }
+
+    /**
+     * @return The number of differences for each pair of species, in the last block.
+     */
+    const std::vector<unsigned int>& getNumbersOfDifferences() const { return nbDiff_; }
+
+    /**
+     * @return The number of comparable sites (without gap) for each pair of species, in the last block.
+     */
+    const std::vector<unsigned int>& getNumbersOfComparableSites() const { return nbComparable_; }
+};
+
 /**
  * @brief Computes the number of sequences in a maf block.
  */
@@ -395,8 +561,84 @@ class AbstractSpeciesSelectionMafStatistics:
     {}
 
   protected:
+    const std::vector<std::string>& getSpecies_() const { return species_; }
+
     SiteContainer* getSiteContainer_(const MafBlock& block);
 
+    /**
+     * @return The column counts of the selected sequences. Counts are cached in the block, and shared with other statistics and filters.
+     */
+    const ColumnCounts& getColumnCounts_(const MafBlock& block);
+
+    /**
+     * @brief Get the selected sequences of a block, without copy.
+     *
+     * @param block The input block.
+     * @param selection [out] The selected sequences. The vector is cleared first, so that it can be reused from one block to another.
+     */
+    void getSelectedSequences_(const MafBlock& block, std::vector<const MafSequence*>& selection) const;
+
+    /**
+     * @return A string identifying the selection of sequences, see ColumnSweepMafStatistics::getSelectionKey.
+     */
+    std::string getSelectionKey_() const;
+
+};
+
+
+/**
+ * @brief Interface for statistics computed from the column counts of a selection of sequences, in a single sweep over columns.
+ *
+ * Statistics sharing the same selection can be computed together, by a single sweep over the columns of a block
+ * (see SequenceStatisticsMafIterator). When computed alone, the compute() method performs the sweep.
+ */
+class ColumnSweepMafStatistics:
+  public virtual MafStatistics
+{
+  public:
+    ColumnSweepMafStatistics() {}
+    virtual ~ColumnSweepMafStatistics() {}
+
+  public:
+    /**
+     * @return A string identifying the selection of sequences. Statistics with identical keys use the same column counts.
+     */
+    virtual std::string getSelectionKey() const = 0;
+
+    /**
+     * @return The column counts of the selected sequences in a block.
+     */
+    virtual const ColumnCounts& getColumnCounts(const MafBlock& block) = 0;
+
+    /**
+     * @brief Reset the statistic before a new sweep.
+     *
+     * @param block The block to analyse.
+     * @param counts The column counts of the block.
+     */
+    virtual void beginSweep(const MafBlock& block, const ColumnCounts& counts) = 0;
+
+    /**
+     * @brief Update the statistic with one column.
+     *
+     * @param counts The column counts of the block.
+     * @param site The column index.
+     */
+    virtual void processColumn(const ColumnCounts& counts, size_t site) = 0;
+
+    /**
+     * @brief Set the result values once all columns have been processed.
+     */
+    virtual void endSweep() = 0;
+
+    void compute(const MafBlock& block) {
+      const ColumnCounts& counts = getColumnCounts(block);
+      beginSweep(block, counts);
+      for (size_t i = 0; i < counts.getNumberOfSites(); ++i)
+        processColumn(counts, i);
+      endSweep();
+    }
+
 };
 
 
@@ -417,6 +659,15 @@ class AbstractSpeciesMultipleSelectionMafStatistics:
   protected:
     std::vector<SiteContainer*> getSiteContainers_(const MafBlock& block);
 
+    /**
+     * @brief Get the states of the sequences of one selection, without copy.
+     *
+     * @param block The input block.
+     * @param k The index of the selection.
+     * @param rows [out] The states of the selected sequences. The vector is cleared first.
+     */
+    void getSelectedRows_(const MafBlock& block, size_t k, std::vector<const std::vector<int>*>& rows) const;
+
 };
 
 
@@ -439,22 +690,24 @@ class CharacterCountsMafStatistics:
 {
   private:
     const Alphabet* alphabet_;
+    std::vector<const MafSequence*> selection_;
 
   public:
     CharacterCountsMafStatistics(const Alphabet* alphabet, const std::vector<std::string>& species, const std::string suffix):
       AbstractMafStatistics(),
       AbstractSpeciesSelectionMafStatistics(species, true, suffix),
-      alphabet_(alphabet) {}
+      alphabet_(alphabet), selection_() {}
 
     CharacterCountsMafStatistics(const CharacterCountsMafStatistics& stats):
       AbstractMafStatistics(stats),
       AbstractSpeciesSelectionMafStatistics(stats),
-      alphabet_(stats.alphabet_) {}
+      alphabet_(stats.alphabet_), selection_() {}
     
     CharacterCountsMafStatistics& operator=(const CharacterCountsMafStatistics& stats) {
       AbstractMafStatistics::operator=(stats);
       AbstractSpeciesSelectionMafStatistics::operator=(stats);
       alphabet_ = stats.alphabet_;
+      selection_.clear();
       return *this;
     }
 
@@ -474,10 +727,16 @@ class CharacterCountsMafStatistics:
  *
  * If no outgroup is provided, the ancestral states are considered as unknown
  * and the unfolded spectrum is computed, so that 10000 and 11110 sites are treated equally.
+ *
+ * Ingroup sequences are transposed by tiles of consecutive columns, so that the states of each column are contiguous in memory,
+ * and alleles are counted with four fixed counters (nucleotide sequences are assumed).
+ * Each column is scanned in the order of the ingroup selection, and is classified as unresolved or saturated
+ * according to the first gap, unresolved character or third state met.
  */
 class SiteFrequencySpectrumMafStatistics:
   public AbstractMafStatistics,
-  public AbstractSpeciesSelectionMafStatistics
+  public AbstractSpeciesSelectionMafStatistics,
+  public MergeableMafStatistics
 {
   private:
     class Categorizer {
@@ -510,6 +769,12 @@ class SiteFrequencySpectrumMafStatistics:
     Categorizer categorizer_;
     std::vector<unsigned int> counts_;
     std::string outgroup_;
+    //Working buffers, kept from one block to another:
+    std::vector<const MafSequence*> selection_;
+    std::vector<int> tile_;
+    //Values accumulated over all blocks (bins, then unresolved, saturated and ignored sites):
+    std::vector<unsigned int> totalCounts_;
+    MafStatisticsResult totalResult_;
 
   public:
     SiteFrequencySpectrumMafStatistics(const Alphabet* alphabet, const std::vector<double>& bounds, const std::vector<std::string>& ingroup, const std::string outgroup = ""):
@@ -518,8 +783,17 @@ class SiteFrequencySpectrumMafStatistics:
       alphabet_(alphabet),
       categorizer_(bounds),
       counts_(bounds.size() - 1),
-      outgroup_(outgroup)
-    {}
+      outgroup_(outgroup),
+      selection_(),
+      tile_(),
+      totalCounts_(bounds.size() + 2),
+      totalResult_()
+    {
+      std::vector<std::string> tags = getSupportedTags();
+      for (size_t i = 0; i < tags.size(); ++i)
+        totalResult_.addSlot(tags[i]);
+      updateAccumulatedResult_();
+    }
 
     SiteFrequencySpectrumMafStatistics(const SiteFrequencySpectrumMafStatistics& stats):
       AbstractMafStatistics(),
@@ -527,7 +801,11 @@ class SiteFrequencySpectrumMafStatistics:
       alphabet_(stats.alphabet_),
       categorizer_(stats.categorizer_),
       counts_(stats.counts_),
-      outgroup_(stats.outgroup_)
+      outgroup_(stats.outgroup_),
+      selection_(),
+      tile_(),
+      totalCounts_(stats.totalCounts_),
+      totalResult_(stats.totalResult_)
     {}
 
     SiteFrequencySpectrumMafStatistics& operator=(const SiteFrequencySpectrumMafStatistics& stats) {
@@ -537,6 +815,10 @@ class SiteFrequencySpectrumMafStatistics:
       categorizer_ = stats.categorizer_;
       counts_      = stats.counts_;
       outgroup_    = stats.outgroup_;
+      selection_.clear();
+      tile_.clear();
+      totalCounts_ = stats.totalCounts_;
+      totalResult_ = stats.totalResult_;
       return *this;
     }
 
@@ -547,6 +829,15 @@ class SiteFrequencySpectrumMafStatistics:
     std::string getFullName() const { return "Site frequency spectrum."; }
     void compute(const MafBlock& block);
     std::vector<std::string> getSupportedTags() const;
+
+    const MafStatisticsResult& getAccumulatedResult() const;
+    void merge(const MergeableMafStatistics& stats);
+    void writeState(std::ostream& out) const;
+    void mergeState(std::istream& in);
+
+  private:
+    //Copies the accumulated counts to the accumulated result, so that it can be read without modification.
+    void updateAccumulatedResult_();
 };
 
 
@@ -559,6 +850,9 @@ class SiteFrequencySpectrumMafStatistics:
  * P2       0 1 1 0
  * P3       1 0 1 0
  * Sites with more than two states are ignored, as well as sites containing gaps or unresolved characters.
+ *
+ * Sites are classified 64 at a time, using one bitplane per nucleotide and sequence.
+ * Pattern counts can also be accumulated in consecutive jackknife blocks, in order to compute the standard error of the D statistic.
  */
 class FourSpeciesPatternCountsMafStatistics:
   public AbstractMafStatistics,
@@ -567,15 +861,28 @@ class FourSpeciesPatternCountsMafStatistics:
   private:
     const Alphabet* alphabet_;
     std::vector<unsigned int> counts_;
+    size_t jackknifeBlockSize_;
+    size_t nbSitesSeen_;
+    std::vector<unsigned int> jackknifeCounts_;
 
   public:
+    /**
+     * @param alphabet The alphabet of sequences.
+     * @param species The four species A, B, C and D, in this order.
+     * @param jackknifeBlockSize The number of alignment sites in each jackknife block (0 for none).
+     * Pattern counts are accumulated over all computed maf blocks, in consecutive jackknife blocks of this size, see getJackknifeCounts().
+     */
     FourSpeciesPatternCountsMafStatistics(
         const Alphabet* alphabet,
-        const std::vector<std::string>& species):
+        const std::vector<std::string>& species,
+        size_t jackknifeBlockSize = 0):
       AbstractMafStatistics(),
       AbstractSpeciesSelectionMafStatistics(species),
       alphabet_(alphabet),
-      counts_(6)
+      counts_(6),
+      jackknifeBlockSize_(jackknifeBlockSize),
+      nbSitesSeen_(0),
+      jackknifeCounts_()
     {
       if (species.size() != 4)
         throw Exception("FourSpeciesPatternCountsMafStatistics, constructor: 4 species should be provided.");
@@ -587,14 +894,20 @@ class FourSpeciesPatternCountsMafStatistics:
       AbstractMafStatistics(),
       AbstractSpeciesSelectionMafStatistics(stats),
       alphabet_(stats.alphabet_),
-      counts_(stats.counts_)
+      counts_(stats.counts_),
+      jackknifeBlockSize_(stats.jackknifeBlockSize_),
+      nbSitesSeen_(stats.nbSitesSeen_),
+      jackknifeCounts_(stats.jackknifeCounts_)
     {}
 
     FourSpeciesPatternCountsMafStatistics& operator=(const FourSpeciesPatternCountsMafStatistics& stats) {
       AbstractMafStatistics::operator=(stats);
       AbstractSpeciesSelectionMafStatistics::operator=(stats);
-      alphabet_    = stats.alphabet_;
-      counts_      = stats.counts_;
+      alphabet_           = stats.alphabet_;
+      counts_             = stats.counts_;
+      jackknifeBlockSize_ = stats.jackknifeBlockSize_;
+      nbSitesSeen_        = stats.nbSitesSeen_;
+      jackknifeCounts_    = stats.jackknifeCounts_;
       return *this;
     }
 
@@ -605,6 +918,32 @@ class FourSpeciesPatternCountsMafStatistics:
     std::string getFullName() const { return "FourSpecies pattern counts."; }
     void compute(const MafBlock& block);
     std::vector<std::string> getSupportedTags() const;
+
+    /**
+     * @return The pattern counts of each jackknife block, as consecutive triplets (f1100, f0110, f1010).
+     */
+    const std::vector<unsigned int>& getJackknifeCounts() const { return jackknifeCounts_; }
+
+    /**
+     * @brief Compute the D statistic (ABBA-BABA test), with its delete-one block jackknife standard error.
+     *
+     * D = (f0110 - f1010) / (f0110 + f1010), D being the outgroup.
+     *
+     * @param jackknifeCounts The pattern counts of each jackknife block, see getJackknifeCounts().
+     * @param d [out] The D statistic computed from all blocks.
+     * @param se [out] The jackknife standard error of D (NaN if less than 2 blocks are available).
+     */
+    static void computeDStatistic(const std::vector<unsigned int>& jackknifeCounts, double& d, double& se);
+
+  private:
+    /**
+     * @brief Add pattern counts for the given sites to the jackknife blocks.
+     *
+     * @param pos The position of the first site, counted over all blocks.
+     * @param masks The masks of sites with each pattern (f1100, f0110, f1010).
+     * @param nbBits The number of sites in the masks.
+     */
+    void addJackknifeCounts_(size_t pos, const uint64_t masks[3], size_t nbBits);
 };
 
 
@@ -623,12 +962,19 @@ class FourSpeciesPatternCountsMafStatistics:
  */
 class SiteMafStatistics:
   public AbstractMafStatistics,
-  public AbstractSpeciesSelectionMafStatistics
+  public AbstractSpeciesSelectionMafStatistics,
+  public ColumnSweepMafStatistics
 {
+  private:
+    size_t nbRows_;
+    unsigned int nbNg_, nbCo_, nbPi_, nbP1_, nbP2_, nbP3_, nbP4_;
+
   public:
     SiteMafStatistics(const std::vector<std::string>& species):
       AbstractMafStatistics(),
-      AbstractSpeciesSelectionMafStatistics(species)
+      AbstractSpeciesSelectionMafStatistics(species),
+      ColumnSweepMafStatistics(),
+      nbRows_(0), nbNg_(0), nbCo_(0), nbPi_(0), nbP1_(0), nbP2_(0), nbP3_(0), nbP4_(0)
     {}
 
     virtual ~SiteMafStatistics() {}
@@ -636,8 +982,13 @@ class SiteMafStatistics:
   public:
     std::string getShortName() const { return "SiteStatistics"; }
     std::string getFullName() const { return "Site statistics."; }
-    void compute(const MafBlock& block);
     std::vector<std::string> getSupportedTags() const;
+
+    std::string getSelectionKey() const { return getSelectionKey_(); }
+    const ColumnCounts& getColumnCounts(const MafBlock& block) { return getColumnCounts_(block); }
+    void beginSweep(const MafBlock& block, const ColumnCounts& counts);
+    void processColumn(const ColumnCounts& counts, size_t site);
+    void endSweep();
 };
 
 
@@ -675,7 +1026,10 @@ class PolymorphismMafStatistics:
     std::vector<std::string> getSupportedTags() const;
 
   private:
-    static std::vector<int> getPatterns_(const SiteContainer& sites); 
+    /**
+     * @brief Get the pattern of each site: the fixed state, -10 for polymorphic sites, or -1 for incomplete sites.
+     */
+    static void getPatterns_(const std::vector<const std::vector<int>*>& rows, size_t nbSites, std::vector<int>& patterns);
 };
 
 
@@ -685,19 +1039,30 @@ class PolymorphismMafStatistics:
  *
  * - Number of segregating sites
  * - Watterson's theta (per site)
- * - Tajima's pi (average pairwise differences)
+ * - Tajima's pi (average proportion of pairwise differences per site)
  * - Tajima's D
  *
  * Only fully resolved sites are analyzed (no gap, no generic character).
+ * Earlier versions reported the average pairwise similarity as Tajima's pi, which also biased Tajima's D.
+ * All estimates are computed from the per-column allele counts of the block, without comparing sequences pairwise.
  */
 class SequenceDiversityMafStatistics:
   public AbstractMafStatistics,
-  public AbstractSpeciesSelectionMafStatistics
+  public AbstractSpeciesSelectionMafStatistics,
+  public ColumnSweepMafStatistics
 {
+  private:
+    size_t nbRows_;
+    size_t nbTot_;
+    double nbSegregating_;
+    double sumDiff_; //Total number of pairwise differences.
+
   public:
     SequenceDiversityMafStatistics(const std::vector<std::string>& ingroup):
       AbstractMafStatistics(),
-      AbstractSpeciesSelectionMafStatistics(ingroup)
+      AbstractSpeciesSelectionMafStatistics(ingroup),
+      ColumnSweepMafStatistics(),
+      nbRows_(0), nbTot_(0), nbSegregating_(0), sumDiff_(0)
     {}
 
     virtual ~SequenceDiversityMafStatistics() {}
@@ -705,11 +1070,13 @@ class SequenceDiversityMafStatistics:
   public:
     std::string getShortName() const { return "SequenceDiversityStatistics"; }
     std::string getFullName() const { return "Sequence diversity statistics."; }
-    void compute(const MafBlock& block);
     std::vector<std::string> getSupportedTags() const;
 
-  private:
-    static std::vector<int> getPatterns_(const SiteContainer& sites); 
+    std::string getSelectionKey() const { return getSelectionKey_(); }
+    const ColumnCounts& getColumnCounts(const MafBlock& block) { return getColumnCounts_(block); }
+    void beginSweep(const MafBlock& block, const ColumnCounts& counts);
+    void processColumn(const ColumnCounts& counts, size_t site);
+    void endSweep();
 };
 
 
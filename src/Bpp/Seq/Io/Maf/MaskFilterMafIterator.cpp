@@ -38,6 +38,7 @@ knowledge of the CeCILL license and that you accept its terms.
 */
 
 #include "MaskFilterMafIterator.h"
+#include "SlidingWindowTools.h"
 
 //Fomr bpp-seq:
 #include <Bpp/Seq/SequenceWithAnnotationTools.h>
@@ -47,178 +48,116 @@ using namespace bpp;
 //From the STL:
 #include <string>
 #include <numeric>
+#include <algorithm>
 
 using namespace std;
 
-MafBlock* MaskFilterMafIterator::analyseCurrentBlock_()
+//Events reported by this filter:
+static const MafEventType MASK_KEPT("MASK CLEANER", "kept", MafEventType::LEVEL_DEBUG,
+    "MASK CLEANER: block is clean and kept as is.");
+static const MafEventType MASK_REMOVED("MASK CLEANER", "removed", MafEventType::LEVEL_INFO,
+    "MASK CLEANER: block was entirely removed. Tried to get the next one.");
+static const MafEventType MASK_SPLIT("MASK CLEANER", "split", MafEventType::LEVEL_INFO,
+    "MASK CLEANER: block with size %0 will be split into %1 blocks.");
+static const MafEventType MASK_REGION_REMOVED("MASK CLEANER", "region_removed", MafEventType::LEVEL_DEBUG,
+    "MASK CLEANER: removing region (%0, %1) from block.");
+
+MafBlock* MaskFilterMafIterator::splitNextBlock_()
 {
-  if (blockBuffer_.size() == 0) {
-    do {
-      //Else there is no more block in the buffer, we need parse more:
-      MafBlock* block = iterator_->nextBlock();
-      if (!block) return 0; //No more block.
-    
-      //Parse block.
-      vector< vector<bool> > aln;
-      for (size_t i = 0; i < species_.size(); ++i) {
-        if (block->hasSequenceForSpecies(species_[i])) {
-          const MafSequence* seq = &block->getSequenceForSpecies(species_[i]);
-          if (seq->hasAnnotation(SequenceMask::MASK)) {
-            aln.push_back(dynamic_cast<const SequenceMask&>(seq->getAnnotation(SequenceMask::MASK)).getMask());
-          }
+  do {
+    //Else there is no more block in the buffer, we need parse more:
+    MafBlock* block = iterator_->nextBlock();
+    if (!block) return 0; //No more block.
+  
+    //Parse block.
+    //Masks are handled as bitsets, 64 positions per word:
+    vector< vector<uint64_t> > aln;
+    vector<uint64_t> bits;
+    for (size_t i = 0; i < species_.size(); ++i) {
+      if (block->hasSequenceForSpecies(species_[i])) {
+        const MafSequence* seq = &block->getSequenceForSpecies(species_[i]);
+        if (seq->getMaskBits(bits)) {
+          aln.push_back(vector<uint64_t>());
+          aln.back().swap(bits);
         }
       }
-      size_t nr = aln.size();
-      size_t nc = block->getNumberOfSites();
-      //First we create a mask:
-      vector<size_t> pos;
-      vector<bool> col(nr);
-      //Reset window:
-      window_.clear();
-      //Init window:
-      size_t i;
-      for (i = 0; i < windowSize_; ++i) {
-        for (size_t j = 0; j < nr; ++j) {
-          col[j] = aln[j][i];
+    }
+    size_t nr = aln.size();
+    size_t nc = block->getNumberOfSites();
+    //Per-column masked counts, obtained by scanning set bits word by word:
+    vector<unsigned int> colMasked(nc, 0);
+    for (size_t j = 0; j < nr; ++j) {
+      for (size_t w = 0; w < aln[j].size(); ++w) {
+        uint64_t word = aln[j][w];
+        while (word) {
+          size_t c = (w << 6) + BitTools::countTrailingZeros(word);
+          if (c < nc) colMasked[c]++;
+          word &= word - 1;
         }
-        window_.push_back(col);
       }
-      //Slide window:
-      if (verbose_) {
-        ApplicationTools::message->endLine();
-        ApplicationTools::displayTask("Sliding window for mask filter", true);
+    }
+    PrefixSums<unsigned int> maskedSums(colMasked);
+    //First we create a mask:
+    vector<size_t> pos;
+    //Slide window:
+    if (displaysTasks_()) {
+      ApplicationTools::message->endLine();
+      ApplicationTools::displayTask("Sliding window for mask filter", true);
+    }
+    //A block smaller than the window is evaluated as a single window:
+    size_t windowSize = min(static_cast<size_t>(windowSize_), nc);
+    vector<size_t> ends = SlidingWindowTools::getWindowEnds(nc, windowSize, step_);
+    for (size_t w = 0; w < ends.size(); ++w) {
+      if (displaysTasks_() && w + 1 < ends.size())
+        displayGauge_(ends[w] - windowSize, nc - windowSize - 1, '>');
+      //Evaluate current window:
+      unsigned int sum = maskedSums.sum(ends[w] - windowSize, ends[w]);
+      if (sum > maxMasked_) {
+        //Note: in the last window, contiguous regions are not merged.
+        SlidingWindowTools::addRegion(pos, ends[w] - windowSize, ends[w], w + 1 == ends.size());
       }
-      while (i + step_ < nc) {
-        if (verbose_)
-          ApplicationTools::displayGauge(i - windowSize_, nc - windowSize_ - 1, '>');
-        //Evaluate current window:
-        unsigned int sum = 0;
-        for (size_t u = 0; u < window_.size(); ++u)
-          for (size_t v = 0; v < window_[u].size(); ++v)
-            if (window_[u][v]) sum++;
-        if (sum > maxMasked_) {
-          if (pos.size() == 0) {
-            pos.push_back(i - windowSize_);
-            pos.push_back(i);
-          } else {
-            if (i - windowSize_ <= pos[pos.size() - 1]) {
-              pos[pos.size() - 1] = i; //Windows are overlapping and we extend previous region
-            } else { //This is a new region
-              pos.push_back(i - windowSize_);
-              pos.push_back(i);
-            }
-          }
-        }
-      
-        //Move forward:
-        for (size_t k = 0; k < step_; ++k) {
-          for (size_t j = 0; j < nr; ++j) {
-            col[j] = aln[j][i];
-          }  
-          window_.push_back(col);
-          window_.pop_front();
-          ++i;
-        }
+    }
+    size_t i;
+    if (displaysTasks_())
+      ApplicationTools::displayTaskDone();
+  
+    //Now we remove regions with two many gaps, using a sliding window:
+    if (pos.size() == 0) {
+      logEvent_(MASK_KEPT, block);
+      return block;
+    } else if (pos.size() == 2 && pos.front() == 0 && pos.back() == block->getNumberOfSites()) {
+      //Everything is removed:
+      logEvent_(MASK_REMOVED, block);
+      recycle(block);
+    } else {
+      //Pieces share the input block, which is recycled when the last one is released:
+      std::shared_ptr<const MafBlock> parent = MafBlockView::share(block, iterator_);
+      logEvent_(MASK_SPLIT, block, {block->getNumberOfSites(), pos.size() / 2 + 1});
+      if (displaysTasks_()) {
+        ApplicationTools::message->endLine();
+        ApplicationTools::displayTask("Spliting block", true);
       }
-
-      //Evaluate last window:
-      unsigned int sum = 0;
-      for (size_t u = 0; u < window_.size(); ++u)
-        for (size_t v = 0; v < window_[u].size(); ++v)
-          if (window_[u][v]) sum++;
-      if (sum > maxMasked_) {
-        if (pos.size() == 0) {
-          pos.push_back(i - windowSize_);
-          pos.push_back(i);
-        } else {
-          if (i - windowSize_ < pos[pos.size() - 1]) {
-            pos[pos.size() - 1] = i; //Windows are overlapping and we extend previous region
-          } else { //This is a new region
-            pos.push_back(i - windowSize_);
-            pos.push_back(i);
-          }
+      for (i = 0; i < pos.size(); i+=2) {
+        if (displaysTasks_())
+          displayGauge_(i, pos.size() - 2, '=');
+        logEvent_(MASK_REGION_REMOVED, block, {pos[i], pos[i+1]});
+        if (pos[i] > 0) {
+          if (i == 0)
+            viewBuffer_.push_back(MafBlockView(parent, 0, pos[i]));
+          else
+            viewBuffer_.push_back(MafBlockView(parent, pos[i - 1], pos[i] - pos[i - 1]));
         }
+        
+        if (keepTrashedBlocks_)
+          trashBuffer_.push_back(MafBlockView(parent, pos[i], pos[i + 1] - pos[i]).materialize());
       }
-      if (verbose_)
+      //Add last block:
+      if (pos.back() < block->getNumberOfSites())
+        viewBuffer_.push_back(MafBlockView(parent, pos.back(), block->getNumberOfSites() - pos.back()));
+      if (displaysTasks_())
         ApplicationTools::displayTaskDone();
-    
-      //Now we remove regions with two many gaps, using a sliding window:
-      if (pos.size() == 0) {
-        blockBuffer_.push_back(block);
-        if (logstream_) {
-          (*logstream_ << "MASK CLEANER: block is clean and kept as is.").endLine();
-        }
-      } else if (pos.size() == 2 && pos.front() == 0 && pos.back() == block->getNumberOfSites()) {
-        //Everything is removed:
-        if (logstream_) {
-          (*logstream_ << "MASK CLEANER: block was entirely removed. Tried to get the next one.").endLine();
-        }
-      } else {
-        if (logstream_) {
-          (*logstream_ << "MASK CLEANER: block with size "<< block->getNumberOfSites() << " will be split into " << (pos.size() / 2 + 1) << " blocks.").endLine();
-        }
-        if (verbose_) {
-          ApplicationTools::message->endLine();
-          ApplicationTools::displayTask("Spliting block", true);
-        }
-        for (i = 0; i < pos.size(); i+=2) {
-          if (verbose_)
-            ApplicationTools::displayGauge(i, pos.size() - 2, '=');
-          if (logstream_) {
-            (*logstream_ << "MASK CLEANER: removing region (" << pos[i] << ", " << pos[i+1] << ") from block.").endLine();
-          }
-          if (pos[i] > 0) {
-            MafBlock* newBlock = new MafBlock();
-            newBlock->setScore(block->getScore());
-            newBlock->setPass(block->getPass());
-            for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-              MafSequence* subseq;
-              if (i == 0) {
-                subseq = block->getSequence(j).subSequence(0, pos[i]);
-              } else {
-                subseq = block->getSequence(j).subSequence(pos[i - 1], pos[i] - pos[i - 1]);
-              }
-              newBlock->addSequence(*subseq);
-              delete subseq;
-            }
-            blockBuffer_.push_back(newBlock);
-          }
-          
-          if (keepTrashedBlocks_) {
-            MafBlock* outBlock = new MafBlock();
-            outBlock->setScore(block->getScore());
-            outBlock->setPass(block->getPass());
-            for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-              MafSequence* outseq = block->getSequence(j).subSequence(pos[i], pos[i + 1] - pos[i]);
-              outBlock->addSequence(*outseq);
-              delete outseq;
-            } 
-            trashBuffer_.push_back(outBlock);
-          }
-        }
-        //Add last block:
-        if (pos[pos.size() - 1] < block->getNumberOfSites()) {
-          MafBlock* newBlock = new MafBlock();
-          newBlock->setScore(block->getScore());
-          newBlock->setPass(block->getPass());
-          for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-            MafSequence* subseq;
-            subseq = block->getSequence(j).subSequence(pos[pos.size() - 1], block->getNumberOfSites() - pos[pos.size() - 1]);
-            newBlock->addSequence(*subseq);
-            delete subseq;
-          }
-          blockBuffer_.push_back(newBlock);
-        }
-        if (verbose_)
-          ApplicationTools::displayTaskDone();
-
-        delete block;
-      }  
-    } while (blockBuffer_.size() == 0);
-  }
-
-  MafBlock* block = blockBuffer_.front();
-  blockBuffer_.pop_front();
-  return block;
+    }  
+  } while (viewBuffer_.size() == 0);
+  return 0;
 }
 
@@ -53,10 +53,10 @@ namespace bpp {
  * @brief Filter maf blocks to remove regions with masked positions.
  *
  * Regions with a too high proportion of masked position in a set of species will be removed,
- * and blocks adjusted accordingly. 
+ * and blocks adjusted accordingly. Blocks smaller than the window are evaluated as a single window.
  */
 class MaskFilterMafIterator:
-  public AbstractFilterMafIterator,
+  public AbstractSplitMafIterator,
   public MafTrashIterator
 {
   private:
@@ -64,21 +64,17 @@ class MaskFilterMafIterator:
     unsigned int windowSize_;
     unsigned int step_;
     unsigned int maxMasked_;
-    std::deque<MafBlock*> blockBuffer_;
     std::deque<MafBlock*> trashBuffer_;
-    std::deque< std::vector<bool> > window_;
     bool keepTrashedBlocks_;
 
   public:
     MaskFilterMafIterator(MafIterator* iterator, const std::vector<std::string>& species, unsigned int windowSize, unsigned int step, unsigned int maxMasked, bool keepTrashedBlocks) :
-      AbstractFilterMafIterator(iterator),
+      AbstractSplitMafIterator(iterator),
       species_(species),
       windowSize_(windowSize),
       step_(step),
       maxMasked_(maxMasked),
-      blockBuffer_(),
       trashBuffer_(),
-      window_(species.size()),
       keepTrashedBlocks_(keepTrashedBlocks)
     {}
 
@@ -90,8 +86,14 @@ class MaskFilterMafIterator:
       return block;
     }
 
+  protected:
+    void getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const {
+      AbstractSplitMafIterator::getBufferContent_(nbBlocks, nbBytes);
+      addBufferContent_(trashBuffer_, nbBlocks, nbBytes);
+    }
+
   private:
-    MafBlock* analyseCurrentBlock_();
+    MafBlock* splitNextBlock_();
 
 };
 
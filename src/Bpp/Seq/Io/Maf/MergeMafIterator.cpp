@@ -0,0 +1,183 @@
+//
+// File: MergeMafIterator.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "MergeMafIterator.h"
+
+using namespace bpp;
+
+//From the STL:
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+using namespace std;
+
+const short MergeMafIterator::KEEP_ALL = 0;
+const short MergeMafIterator::DISCARD_OVERLAPPING = 1;
+const short MergeMafIterator::DISCARD_DUPLICATES = 2;
+const short MergeMafIterator::THROW_ON_OVERLAP = 3;
+
+bool MergeMafIterator::Head_::operator>(const Head_& head) const
+{
+  //Blocks without coordinates come first:
+  if (placed != head.placed) return placed;
+  if (placed) {
+    if (rank != head.rank) return rank > head.rank;
+    if (chr != head.chr) return chr > head.chr;
+    if (start != head.start) return start > head.start;
+    if (stop != head.stop) return stop > head.stop;
+  }
+  return input > head.input;
+}
+
+MergeMafIterator::MergeMafIterator(const vector<MafIterator*>& iterators, const string& reference, short overlapPolicy):
+  iterators_(iterators), refSpecies_(reference), overlapPolicy_(overlapPolicy), chrOrder_(),
+  heap_(), lastHeads_(iterators.size()), initialized_(false),
+  hasLast_(false), lastChr_(), lastStart_(0), lastStop_(0), nbDiscarded_(0)
+{
+  if (iterators_.empty())
+    throw Exception("MergeMafIterator (constructor). At least one input iterator is required.");
+  for (size_t i = 0; i < iterators_.size(); ++i)
+    if (!iterators_[i])
+      throw NullPointerException("MergeMafIterator (constructor). Input iterators should not be NULL pointers!");
+  if (overlapPolicy != KEEP_ALL && overlapPolicy != DISCARD_OVERLAPPING
+      && overlapPolicy != DISCARD_DUPLICATES && overlapPolicy != THROW_ON_OVERLAP)
+    throw Exception("MergeMafIterator (constructor). Unvalid overlap policy: " + TextTools::toString(overlapPolicy));
+}
+
+MergeMafIterator::~MergeMafIterator()
+{
+  for (size_t i = 0; i < heap_.size(); ++i)
+    iterators_[heap_[i].input]->recycle(heap_[i].block);
+}
+
+void MergeMafIterator::setChromosomeOrder(const vector<string>& chromosomes)
+{
+  if (initialized_)
+    throw Exception("MergeMafIterator::setChromosomeOrder. The iteration has already started.");
+  chrOrder_.clear();
+  for (size_t i = 0; i < chromosomes.size(); ++i)
+    chrOrder_.insert(make_pair(chromosomes[i], i));
+}
+
+void MergeMafIterator::readInput_(size_t input)
+{
+  MafBlock* block = iterators_[input]->nextBlock();
+  if (!block) return;
+  Head_ head;
+  head.block = block;
+  head.input = input;
+  if (block->hasSequenceForSpecies(refSpecies_)) {
+    const MafSequence& refSeq = block->getSequenceForSpecies(refSpecies_);
+    if (refSeq.hasCoordinates()) {
+      head.placed = true;
+      head.chr = refSeq.getChromosome();
+      map<string, size_t>::const_iterator it = chrOrder_.find(head.chr);
+      head.rank = (it == chrOrder_.end() ? numeric_limits<size_t>::max() : it->second);
+      head.start = refSeq.start();
+      head.stop = refSeq.stop();
+      //Compare with the previous block of the same input:
+      Head_& previous = lastHeads_[input];
+      if (previous.placed && (previous.rank > head.rank || (previous.rank == head.rank
+          && (previous.chr > head.chr || (previous.chr == head.chr && previous.start > head.start))))) {
+        iterators_[input]->recycle(block);
+        throw Exception("MergeMafIterator::nextBlock. Input " + TextTools::toString(input) + " is not sorted according to species " + refSpecies_ + ", at " + head.chr + ":" + TextTools::toString(head.start) + ".");
+      }
+      previous = head;
+      previous.block = 0;
+    }
+  }
+  heap_.push_back(head);
+  push_heap(heap_.begin(), heap_.end(), greater<Head_>());
+}
+
+MafBlock* MergeMafIterator::analyseCurrentBlock_()
+{
+  if (!initialized_) {
+    for (size_t i = 0; i < iterators_.size(); ++i)
+      readInput_(i);
+    initialized_ = true;
+  }
+  while (!heap_.empty()) {
+    pop_heap(heap_.begin(), heap_.end(), greater<Head_>());
+    Head_ head = heap_.back();
+    heap_.pop_back();
+    try {
+      readInput_(head.input);
+    } catch (...) {
+      iterators_[head.input]->recycle(head.block);
+      throw;
+    }
+    if (!head.placed)
+      return head.block;
+
+    bool sameChr = hasLast_ && head.chr == lastChr_;
+    if (sameChr && head.start < lastStop_ && overlapPolicy_ != KEEP_ALL) {
+      bool duplicate = (head.start == lastStart_ && head.stop == lastStop_);
+      if (overlapPolicy_ == THROW_ON_OVERLAP) {
+        iterators_[head.input]->recycle(head.block);
+        throw Exception("MergeMafIterator::nextBlock. Overlapping blocks found at " + head.chr + ":" + TextTools::toString(head.start) + ".");
+      }
+      if (overlapPolicy_ == DISCARD_OVERLAPPING || duplicate) {
+        iterators_[head.input]->recycle(head.block);
+        nbDiscarded_++;
+        continue;
+      }
+    }
+    if (sameChr) {
+      lastStop_ = max(lastStop_, head.stop);
+    } else {
+      lastChr_ = head.chr;
+      lastStop_ = head.stop;
+      hasLast_ = true;
+    }
+    lastStart_ = head.start;
+    return head.block;
+  }
+  return 0;
+}
+
+void MergeMafIterator::getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const
+{
+  for (size_t i = 0; i < heap_.size(); ++i) {
+    nbBlocks++;
+    nbBytes += heap_[i].block->getMemorySize();
+  }
+}
+
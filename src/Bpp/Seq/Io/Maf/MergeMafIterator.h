@@ -0,0 +1,154 @@
+//
+// File: MergeMafIterator.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _MERGEMAFITERATOR_H_
+#define _MERGEMAFITERATOR_H_
+
+#include "MafIterator.h"
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <map>
+
+namespace bpp {
+
+/**
+ * @brief Merge several inputs sorted according to a reference species into a single sorted stream.
+ *
+ * The next block of each input is kept in a heap, ordered by chromosome and start position on the reference,
+ * so that merging N inputs only holds N blocks in memory. Ties are broken by input order, so that the result is
+ * deterministic. Chromosomes are compared alphabetically, unless an explicit order is given with setChromosomeOrder().
+ * Blocks without the reference species, or without coordinates, are forwarded as soon as they are read.
+ *
+ * Blocks overlapping on the reference, for instance when inputs come from overlapping runs, can be kept (KEEP_ALL),
+ * discarded when they overlap a previous block (DISCARD_OVERLAPPING), discarded only when they have the same
+ * coordinates as a previous block (DISCARD_DUPLICATES), or result in an exception (THROW_ON_OVERLAP).
+ * An exception is thrown if one of the inputs is not sorted.
+ *
+ * Input iterators are not owned by this object.
+ */
+class MergeMafIterator:
+  public AbstractMafIterator
+{
+  public:
+    static const short KEEP_ALL;
+    static const short DISCARD_OVERLAPPING;
+    static const short DISCARD_DUPLICATES;
+    static const short THROW_ON_OVERLAP;
+
+  private:
+    struct Head_
+    {
+      MafBlock* block;
+      size_t input;
+      bool placed; //False if the block has no reference coordinates.
+      size_t rank;
+      std::string chr;
+      size_t start;
+      size_t stop;
+
+      Head_(): block(0), input(0), placed(false), rank(0), chr(), start(0), stop(0) {}
+
+      bool operator>(const Head_& head) const;
+    };
+
+  private:
+    std::vector<MafIterator*> iterators_;
+    std::string refSpecies_;
+    short overlapPolicy_;
+    std::map<std::string, size_t> chrOrder_;
+    std::vector<Head_> heap_; //A min-heap, with std::greater.
+    std::vector<Head_> lastHeads_; //Last block read from each input, to check that inputs are sorted.
+    bool initialized_;
+    bool hasLast_;
+    std::string lastChr_;
+    size_t lastStart_;
+    size_t lastStop_;
+    size_t nbDiscarded_;
+
+  public:
+    /**
+     * @param iterators The input iterators, sorted according to the reference species.
+     * @param reference The reference species.
+     * @param overlapPolicy What to do with blocks overlapping previous blocks on the reference.
+     */
+    MergeMafIterator(const std::vector<MafIterator*>& iterators, const std::string& reference, short overlapPolicy = KEEP_ALL);
+
+  private:
+    //Recopy is forbidden!
+    MergeMafIterator(const MergeMafIterator& iterator);
+    MergeMafIterator& operator=(const MergeMafIterator& iterator);
+
+  public:
+    virtual ~MergeMafIterator();
+
+  public:
+    /**
+     * @brief Set the order of chromosomes, which is otherwise alphabetical.
+     *
+     * Chromosomes not in the list come after all listed ones, in alphabetical order.
+     * This should be called before the iteration starts.
+     * @param chromosomes The chromosomes, in the order of the inputs.
+     */
+    void setChromosomeOrder(const std::vector<std::string>& chromosomes);
+
+    size_t getNumberOfInputs() const { return iterators_.size(); }
+
+    /**
+     * @return The number of blocks discarded according to the overlap policy.
+     */
+    size_t getNumberOfDiscardedBlocks() const { return nbDiscarded_; }
+
+    void recycle(MafBlock* block) { iterators_.front()->recycle(block); }
+
+  private:
+    MafBlock* analyseCurrentBlock_();
+
+    void getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const;
+
+    /**
+     * @brief Read the next block of an input into the heap.
+     */
+    void readInput_(size_t input);
+};
+
+} // end of namespace bpp.
+
+#endif //_MERGEMAFITERATOR_H_
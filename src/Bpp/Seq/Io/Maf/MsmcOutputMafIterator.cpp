@@ -38,13 +38,12 @@ knowledge of the CeCILL license and that you accept its terms.
 */
 
 #include "MsmcOutputMafIterator.h"
+#include "BitTools.h"
+#include "ColumnCounts.h"
 
 //From bpp-seq:
 #include <Bpp/Seq/SequenceWithAnnotationTools.h>
 #include <Bpp/Seq/SequenceWithQuality.h>
-#include <Bpp/Seq/Container/VectorSiteContainer.h>
-#include <Bpp/Seq/SiteTools.h>
-#include <Bpp/Seq/SequenceWalker.h>
 
 using namespace bpp;
 
@@ -55,14 +54,51 @@ using namespace bpp;
 
 using namespace std;
 
-void MsmcOutputMafIterator::writeBlock_(std::ostream& out, const MafBlock& block)
+const size_t MsmcOutputMafIterator::BUFFER_SIZE = 1 << 20;
+
+void MsmcOutputMafIterator::flush()
 {
-  //Preliminary stuff...
+  if (output_ && buffer_.size() > 0) {
+    output_->write(buffer_.data(), static_cast<streamsize>(buffer_.size()));
+    output_->flush();
+  }
+  buffer_.clear();
+}
 
-  VectorSiteContainer sites(&AlphabetTools::DNA_ALPHABET);
+void MsmcOutputMafIterator::saveState(MafCheckpoint& checkpoint, const string& prefix)
+{
+  flush();
+  checkpoint.setValue(prefix + "chr", currentChr_);
+  checkpoint.setValue(prefix + "position", static_cast<uint64_t>(lastPosition_));
+  checkpoint.setValue(prefix + "calledSites", static_cast<uint64_t>(nbOfCalledSites_));
+}
+
+void MsmcOutputMafIterator::restoreState(const MafCheckpoint& checkpoint, const string& prefix)
+{
+  buffer_.clear();
+  currentChr_ = checkpoint.getValue(prefix + "chr");
+  lastPosition_ = static_cast<size_t>(checkpoint.getUIntValue(prefix + "position"));
+  nbOfCalledSites_ = static_cast<unsigned int>(checkpoint.getUIntValue(prefix + "calledSites"));
+}
+
+void MsmcOutputMafIterator::appendNumber_(std::string& buffer, size_t n)
+{
+  char tmp[24];
+  size_t i = sizeof(tmp);
+  do {
+    tmp[--i] = static_cast<char>('0' + n % 10);
+    n /= 10;
+  } while (n > 0);
+  buffer.append(tmp + i, sizeof(tmp) - i);
+}
+
+void MsmcOutputMafIterator::writeBlock_(const MafBlock& block)
+{
+  //Preliminary stuff...
+  rows_.clear();
   for (size_t i = 0; i < species_.size(); ++i) {
     if (block.hasSequenceForSpecies(species_[i])) {
-      sites.addSequence(block.getSequenceForSpecies(species_[i]));
+      rows_.push_back(&block.getSequenceForSpecies(species_[i]).getContent());
       //Note: in case of duplicates, this takes the first sequence.
     } else {
       //Block with missing species are ignored.
@@ -73,7 +109,7 @@ void MsmcOutputMafIterator::writeBlock_(std::ostream& out, const MafBlock& block
   if (! block.hasSequenceForSpecies(refSpecies_))
     return;
   const MafSequence& refSeq = block.getSequenceForSpecies(refSpecies_);
-  string chr = refSeq.getChromosome();
+  const string& chr = refSeq.getChromosome();
   if (chr != currentChr_) {
     currentChr_ = chr;
     nbOfCalledSites_ = 0; //Reset count of called sites.
@@ -85,29 +121,53 @@ void MsmcOutputMafIterator::writeBlock_(std::ostream& out, const MafBlock& block
     lastPosition_ = refSeq.stop();
   }
 
-  SequenceWalker walker(refSeq);
-  size_t offset = refSeq.start();
-  int gap = refSeq.getAlphabet()->getGapCharacterCode();
-  
-  //Now we shall scan all sites for SNPs:
-  for (size_t i = 0; i < sites.getNumberOfSites(); i++) {
-    if (refSeq[i] == gap)
-      continue;
-
-    //We call SNPs only at position without gap or unresolved characters:
-    if (SiteTools::isComplete(sites.getSite(i))) {
-      nbOfCalledSites_++;
-
-      if (!SiteTools::isConstant(sites.getSite(i))) {
-        string pos = "NA";
-        if (refSeq[i] != gap) {
-          pos = TextTools::toString(offset + walker.getSequencePosition(i) + 1);
-        }
-        out << chr << "\t" << pos << "\t" << nbOfCalledSites_ << "\t" << sites.getSite(i).toString() << endl;
-        //Reset number of called sites
-        nbOfCalledSites_ = 0;
-      }
+  //Now we shall scan all sites for SNPs, 64 columns at a time.
+  //We call SNPs only at position without gap or unresolved characters:
+  const string& chars = ColumnCounts::getCharacters();
+  size_t nbSites = block.getNumberOfSites();
+  classes_.compute(rows_, nbSites);
+  //Genotypes are written column by column, from the site-major copy of the rows:
+  const ColumnTable& table = block.getColumnTable(species_);
+  const vector<uint64_t>& complete = classes_.getCompleteBitmap();
+  const vector<uint64_t>& constant = classes_.getConstantBitmap();
+  const int* ref = nbSites > 0 ? &refSeq.getContent()[0] : 0;
+  size_t pos = refSeq.start(); //Position in the reference sequence, before the current word.
+  size_t nbWords = BitTools::getNumberOfWords(nbSites);
+  for (size_t w = 0; w < nbWords; ++w) {
+    size_t begin = w * 64;
+    size_t n = min(static_cast<size_t>(64), nbSites - begin);
+    //Columns which are not a gap in the reference:
+    uint64_t refMask = 0;
+    for (size_t k = 0; k < n; ++k)
+      refMask |= static_cast<uint64_t>(ref[begin + k] >= 0) << k;
+    uint64_t called = complete[w] & refMask;
+    uint64_t variable = called & ~constant[w];
+    unsigned int consumed = 0; //Number of called sites already counted in this word.
+    while (variable) {
+      unsigned int b = BitTools::countTrailingZeros(variable);
+      variable &= variable - 1;
+      uint64_t upTo = (b == 63 ? ~0ULL : ((1ULL << (b + 1)) - 1));
+      unsigned int nbCalled = BitTools::popcount(called & upTo);
+      nbOfCalledSites_ += nbCalled - consumed;
+      consumed = nbCalled;
+      size_t i = begin + b;
+      buffer_.append(chr);
+      buffer_ += '\t';
+      appendNumber_(buffer_, pos + BitTools::popcount(refMask & upTo));
+      buffer_ += '\t';
+      appendNumber_(buffer_, nbOfCalledSites_);
+      buffer_ += '\t';
+      const int8_t* column = table.getColumn(i);
+      for (size_t j = 0; j < rows_.size(); ++j)
+        buffer_ += chars[static_cast<size_t>(column[j] + 1)];
+      buffer_ += '\n';
+      //Reset number of called sites
+      nbOfCalledSites_ = 0;
     }
+    nbOfCalledSites_ += BitTools::popcount(called) - consumed;
+    pos += BitTools::popcount(refMask);
   }
+  if (buffer_.size() >= BUFFER_SIZE)
+    flush();
 }
 
@@ -41,6 +41,8 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _MSMCOUTPUTMAFITERATOR_H_
 
 #include "MafIterator.h"
+#include "ColumnClassification.h"
+#include "MafCheckpoint.h"
 
 //From the STL:
 #include <iostream>
@@ -53,10 +55,21 @@ namespace bpp {
  * @brief This iterator outputs all SNPs in the format readable by MSMC
  *
  * See https://github.com/stschiff/msmc for a format description.
+ *
+ * Columns are classified 64 at a time directly on the sequence rows, and lines are formatted
+ * into an internal buffer, which is written to the output stream by large chunks.
+ * The buffer is flushed when the input iterator is exhausted and when the iterator is destroyed.
  */
 class MsmcOutputMafIterator:
-  public AbstractFilterMafIterator
+  public AbstractFilterMafIterator,
+  public virtual CheckpointableMafIterator
 {
+  public:
+    /**
+     * @brief Size of the output buffer, in characters, above which it is written to the stream.
+     */
+    static const size_t BUFFER_SIZE;
+
   private:
     std::ostream* output_;
     std::vector<std::string> species_;
@@ -64,6 +77,9 @@ class MsmcOutputMafIterator:
     std::string currentChr_;
     size_t lastPosition_;
     unsigned int nbOfCalledSites_;
+    std::string buffer_;
+    std::vector<const std::vector<int>*> rows_;
+    ColumnClassification classes_;
 
   public:
     /**
@@ -83,7 +99,8 @@ class MsmcOutputMafIterator:
         const std::string& reference) :
       AbstractFilterMafIterator(iterator),
       output_(out), species_(species), refSpecies_(reference),
-      currentChr_(""), lastPosition_(0), nbOfCalledSites_(0)
+      currentChr_(""), lastPosition_(0), nbOfCalledSites_(0),
+      buffer_(), rows_(), classes_()
     {}
 
   private:
@@ -94,7 +111,10 @@ class MsmcOutputMafIterator:
       refSpecies_(iterator.refSpecies_),
       currentChr_(iterator.currentChr_),
       lastPosition_(iterator.lastPosition_),
-      nbOfCalledSites_(iterator.nbOfCalledSites_)
+      nbOfCalledSites_(iterator.nbOfCalledSites_),
+      buffer_(),
+      rows_(),
+      classes_()
     {}
     
     MsmcOutputMafIterator& operator=(const MsmcOutputMafIterator& iterator)
@@ -105,20 +125,53 @@ class MsmcOutputMafIterator:
       currentChr_ = iterator.currentChr_;
       lastPosition_ = iterator.lastPosition_;
       nbOfCalledSites_ = iterator.nbOfCalledSites_;
+      buffer_.clear();
       return *this;
     }
 
-
   public:
+    virtual ~MsmcOutputMafIterator()
+    {
+      flush();
+    }
+
+    /**
+     * @brief Write the content of the output buffer to the stream.
+     */
+    void flush();
+
+    std::ostream* getOutputStream() const { return output_; }
+
+    /**
+     * @return The chromosome of the last block written, empty if none.
+     */
+    const std::string& getCurrentChromosome() const { return currentChr_; }
+
+    /**
+     * @return The number of called sites since the last SNP written, on the current chromosome.
+     */
+    unsigned int getNumberOfCalledSites() const { return nbOfCalledSites_; }
+
+    /**
+     * @brief Flush the output, and save the position and number of called sites since the last SNP.
+     */
+    void saveState(MafCheckpoint& checkpoint, const std::string& prefix);
+    void restoreState(const MafCheckpoint& checkpoint, const std::string& prefix);
+
     MafBlock* analyseCurrentBlock_() {
       currentBlock_ = iterator_->nextBlock();
-      if (output_ && currentBlock_)
-        writeBlock_(*output_, *currentBlock_);
+      if (output_) {
+        if (currentBlock_)
+          writeBlock_(*currentBlock_);
+        else
+          flush(); //No more block.
+      }
       return currentBlock_;
     }
 
   private:
-    void writeBlock_(std::ostream& out, const MafBlock& block);
+    void writeBlock_(const MafBlock& block);
+    static void appendNumber_(std::string& buffer, size_t n);
 };
 
 } // end of namespace bpp.
@@ -60,7 +60,7 @@ bool OrderFilterMafIterator::parseBlock_(const MafBlock& block)
   if (! block.hasSequenceForSpecies(refSpecies_))
     return true; //We consider a block with no reference sequence as ordered
   const MafSequence& refSeq = block.getSequenceForSpecies(refSpecies_);
-  string chr = refSeq.getChromosome();
+  size_t chr = refSeq.getChromosomeId();
   if (chr != currentChr_) {
     currentChr_ = chr;
     previousBlockStart_ = 0;
@@ -96,3 +96,18 @@ bool OrderFilterMafIterator::parseBlock_(const MafBlock& block)
   return true;
 }
 
+void OrderFilterMafIterator::saveState(MafCheckpoint& checkpoint, const string& prefix)
+{
+  checkpoint.setValue(prefix + "chr", currentChr_ == MafNameDictionary::NO_ID ? string() : MafNameDictionary::chromosomes().getName(currentChr_));
+  checkpoint.setValue(prefix + "start", static_cast<uint64_t>(previousBlockStart_));
+  checkpoint.setValue(prefix + "stop", static_cast<uint64_t>(previousBlockStop_));
+}
+
+void OrderFilterMafIterator::restoreState(const MafCheckpoint& checkpoint, const string& prefix)
+{
+  string chr = checkpoint.getValue(prefix + "chr");
+  currentChr_ = chr.empty() ? MafNameDictionary::NO_ID : MafNameDictionary::chromosomes().intern(chr);
+  previousBlockStart_ = static_cast<size_t>(checkpoint.getUIntValue(prefix + "start"));
+  previousBlockStop_ = static_cast<size_t>(checkpoint.getUIntValue(prefix + "stop"));
+}
+
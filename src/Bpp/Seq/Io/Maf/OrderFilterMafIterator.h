@@ -41,6 +41,7 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _ORDERFILTERMAFITERATOR_H_
 
 #include "MafIterator.h"
+#include "MafCheckpoint.h"
 
 //From the STL:
 #include <iostream>
@@ -56,11 +57,12 @@ namespace bpp {
  * Alternatively, conflicting blocks can be discarded.
  */
 class OrderFilterMafIterator:
-  public AbstractFilterMafIterator
+  public AbstractFilterMafIterator,
+  public virtual CheckpointableMafIterator
 {
   private:
     std::string refSpecies_;
-    std::string currentChr_;
+    size_t currentChr_; //ID of the current chromosome, in MafNameDictionary::chromosomes().
     size_t previousBlockStart_;
     size_t previousBlockStop_;
     bool unsortedBlockDiscarded_;
@@ -87,7 +89,7 @@ class OrderFilterMafIterator:
         bool overlappingBlockThrowsException = false) :
       AbstractFilterMafIterator(iterator),
       refSpecies_(reference),
-      currentChr_(),
+      currentChr_(MafNameDictionary::NO_ID),
       previousBlockStart_(),
       previousBlockStop_(),
       unsortedBlockDiscarded_(unsortedBlockDiscarded),
@@ -136,6 +138,12 @@ class OrderFilterMafIterator:
       return currentBlock_;
     }
 
+    /**
+     * @brief Save the coordinates of the previous block.
+     */
+    void saveState(MafCheckpoint& checkpoint, const std::string& prefix);
+    void restoreState(const MafCheckpoint& checkpoint, const std::string& prefix);
+
   private:
     //Returns true if block is ordered with previous one
     bool parseBlock_(const MafBlock& block);
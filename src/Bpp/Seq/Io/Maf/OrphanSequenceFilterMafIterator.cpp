@@ -51,22 +51,17 @@ MafBlock* OrphanSequenceFilterMafIterator::analyseCurrentBlock_()
 {
   currentBlock_ = iterator_->nextBlock();
   while (currentBlock_) {
-    map<string, unsigned int> counts;
-    for (size_t i = 0; i < currentBlock_->getNumberOfSequences(); ++i) {
-      string species = currentBlock_->getSequence(i).getSpecies(); 
-      counts[species]++;
-    }
-    bool test = counts.size() <= species_.size();
+    bool test = currentBlock_->getNumberOfSpecies() <= species_.size();
     if (test) {
       //We have to check that the species are the right one:
       bool loseCrit = false;
       bool strictCrit = true;
       bool duplicate = false;
-      for (size_t i = 0; i < species_.size() && !duplicate; ++i) {
-        map<string, unsigned int>::iterator it = counts.find(species_[i]);
-        if (it != counts.end()) {
+      for (size_t i = 0; i < speciesIds_.size() && !duplicate; ++i) {
+        size_t n = currentBlock_->getNumberOfSequencesForSpecies(speciesIds_[i]);
+        if (n > 0) {
           loseCrit = true;
-          if (rmDuplicates_ && it->second > 1) {
+          if (rmDuplicates_ && n > 1) {
             //Duplicated sequences, block is discarded if asked to...
             duplicate = true;
           }
@@ -53,12 +53,14 @@ namespace bpp {
  * @brief Filter maf blocks to keep a the ones which display a specified combination of species.
  *
  * This filter is typically used to retrieve "orphan" sequences, that is sequences only present in one (set of) species.
+ * Species are looked up by ID in the species index of each block, without counting the sequences of the block.
  */
 class OrphanSequenceFilterMafIterator:
   public AbstractFilterMafIterator
 {
   private:
     std::vector<std::string> species_;
+    std::vector<size_t> speciesIds_;
     bool strict_;
     bool rmDuplicates_;
 
@@ -77,14 +79,19 @@ class OrphanSequenceFilterMafIterator:
         bool rmDuplicates = false) :
       AbstractFilterMafIterator(iterator),
       species_(species),
+      speciesIds_(),
       strict_(strict),
       rmDuplicates_(rmDuplicates)
-    {}
+    {
+      for (size_t i = 0; i < species.size(); ++i)
+        speciesIds_.push_back(MafNameDictionary::species().intern(species[i]));
+    }
 
   private:
     OrphanSequenceFilterMafIterator(const OrphanSequenceFilterMafIterator& iterator) :
       AbstractFilterMafIterator(0),
       species_(iterator.species_),
+      speciesIds_(iterator.speciesIds_),
       strict_(iterator.strict_),
       rmDuplicates_(iterator.rmDuplicates_)
     {}
@@ -92,6 +99,7 @@ class OrphanSequenceFilterMafIterator:
     OrphanSequenceFilterMafIterator& operator=(const OrphanSequenceFilterMafIterator& iterator)
     {
       species_       = iterator.species_;
+      speciesIds_    = iterator.speciesIds_;
       strict_        = iterator.strict_;
       rmDuplicates_  = iterator.rmDuplicates_;
       return *this;
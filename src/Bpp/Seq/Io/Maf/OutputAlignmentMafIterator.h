@@ -41,6 +41,7 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _OUTPUTALIGNMENTMAFITERATOR_H_
 
 #include "MafIterator.h"
+#include "../AsyncFileWriter.h"
 
 //From bpp-seq:
 #include <Bpp/Seq/Io/OSequence.h>
@@ -49,6 +50,7 @@ knowledge of the CeCILL license and that you accept its terms.
 #include <iostream>
 #include <string>
 #include <deque>
+#include <memory>
 
 namespace bpp {
 
@@ -68,6 +70,7 @@ class OutputAlignmentMafIterator:
     std::unique_ptr<OAlignment> writer_;
     unsigned int currentBlockIndex_;
     std::string refSpecies_;
+    std::shared_ptr<AsyncFileWriter> fileWriter_;
 
   public:
     /**
@@ -101,7 +104,8 @@ class OutputAlignmentMafIterator:
       addLDHatHeader_(addLDHatHeader),
       writer_(writer),
       currentBlockIndex_(0),
-      refSpecies_(reference)
+      refSpecies_(reference),
+      fileWriter_()
     {
       if (!writer)
         throw Exception("OutputAlignmentMafIterator (constructor 1): sequence writer should not be a NULL pointer!");
@@ -139,7 +143,8 @@ class OutputAlignmentMafIterator:
       addLDHatHeader_(addLDHatHeader),
       writer_(writer),
       currentBlockIndex_(0),
-      refSpecies_(reference)
+      refSpecies_(reference),
+      fileWriter_()
     {
       if (!writer)
         throw Exception("OutputAlignmentMafIterator (constructor 2): sequence writer should not be a NULL pointer!");
@@ -157,7 +162,8 @@ class OutputAlignmentMafIterator:
       addLDHatHeader_(iterator.addLDHatHeader_),
       writer_(),
       currentBlockIndex_(iterator.currentBlockIndex_),
-      refSpecies_(iterator.refSpecies_)
+      refSpecies_(iterator.refSpecies_),
+      fileWriter_(iterator.fileWriter_)
     {}
     
     OutputAlignmentMafIterator& operator=(const OutputAlignmentMafIterator& iterator)
@@ -170,10 +176,23 @@ class OutputAlignmentMafIterator:
       writer_.release();
       currentBlockIndex_ = iterator.currentBlockIndex_;
       refSpecies_ = iterator.refSpecies_;
+      fileWriter_ = iterator.fileWriter_;
       return *this;
     }
 
 
+  public:
+    /**
+     * @brief Hand the files over to an asynchronous writer, instead of writing them on the calling thread.
+     *
+     * Each block is formatted in memory, and the resulting file is queued in the writer, which may create one file
+     * per block or pack all blocks into a single archive. The writer can be shared with other iterators. Files are
+     * only guaranteed to be complete once the writer has been closed.
+     *
+     * @param writer The writer to use, or a null pointer to write files synchronously.
+     */
+    void setFileWriter(std::shared_ptr<AsyncFileWriter> writer) { fileWriter_ = writer; }
+
   private:
     MafBlock* analyseCurrentBlock_();
 
@@ -48,6 +48,7 @@ using namespace bpp;
 //From the STL:
 #include <string>
 #include <numeric>
+#include <cctype>
 
 using namespace std;
 
@@ -57,14 +58,69 @@ void OutputMafIterator::writeHeader(std::ostream& out) const
   //There are more options in the header that we may want to support...
 }
 
+void OutputMafIterator::close()
+{
+  if (bgzf_.get()) {
+    bgzf_->close();
+    bgzf_.reset();
+    output_ = 0;
+  } else if (output_) {
+    output_->flush();
+  }
+}
+
+size_t OutputMafIterator::getNumberOfDigits_(size_t n)
+{
+  size_t d = 1;
+  while (n >= 10) {
+    n /= 10;
+    d++;
+  }
+  return d;
+}
+
+void OutputMafIterator::appendNumber_(std::string& buffer, size_t n, size_t width)
+{
+  //Numbers are aligned on the right:
+  char tmp[24];
+  size_t i = sizeof(tmp);
+  do {
+    tmp[--i] = static_cast<char>('0' + n % 10);
+    n /= 10;
+  } while (n > 0);
+  size_t d = sizeof(tmp) - i;
+  if (width > d)
+    buffer.append(width - d, ' ');
+  buffer.append(tmp + i, d);
+}
+
+void OutputMafIterator::buildDecodingTable_(const Alphabet* alphabet) const
+{
+  for (size_t k = 0; k < 256; ++k) {
+    decode_[0][k] = '?';
+    decode_[1][k] = '?';
+  }
+  for (int state = -1; state < 255; ++state) {
+    if (alphabet->isIntInAlphabet(state)) {
+      char c = alphabet->intToChar(state)[0];
+      decode_[0][state + 1] = c;
+      decode_[1][state + 1] = static_cast<char>(tolower(static_cast<int>(c)));
+    }
+  }
+  alphabet_ = alphabet;
+}
+
 void OutputMafIterator::writeBlock(std::ostream& out, const MafBlock& block) const
 {
-  out << "a";
+  buffer_.clear();
+  buffer_ += 'a';
   if (! std::isinf(block.getScore()))
-    out << " score=" << block.getScore();
-  if (block.getPass() > 0)
-    out << " pass=" << block.getPass();
-  out << endl;
+    buffer_.append(" score=" + TextTools::toString(block.getScore()));
+  if (block.getPass() > 0) {
+    buffer_.append(" pass=");
+    appendNumber_(buffer_, block.getPass(), 0);
+  }
+  buffer_ += '\n';
   
   //Now we write sequences. First need to count characters for aligning blocks:
   size_t mxcSrc = 0, mxcStart = 0, mxcSize = 0, mxcSrcSize = 0;
@@ -74,57 +130,62 @@ void OutputMafIterator::writeBlock(std::ostream& out, const MafBlock& block) con
     if (seq->hasCoordinates())
       start = seq->start();
     mxcSrc     = max(mxcSrc    , seq->getName().size());
-    mxcStart   = max(mxcStart  , TextTools::toString(start).size());
-    mxcSize    = max(mxcSize   , TextTools::toString(seq->getGenomicSize()).size());
-    mxcSrcSize = max(mxcSrcSize, TextTools::toString(seq->getSrcSize()).size());
+    mxcStart   = max(mxcStart  , getNumberOfDigits_(start));
+    mxcSize    = max(mxcSize   , getNumberOfDigits_(seq->getGenomicSize()));
+    mxcSrcSize = max(mxcSrcSize, getNumberOfDigits_(seq->getSrcSize()));
   }
   //Now print each sequence:
   for (size_t i = 0; i < block.getNumberOfSequences(); i++) {
     const MafSequence* seq = &block.getSequence(i);
-    out << "s ";
-    out << TextTools::resizeRight(seq->getName(), mxcSrc, ' ') << " ";
+    buffer_.append("s ");
+    buffer_.append(seq->getName());
+    buffer_.append(mxcSrc - seq->getName().size() + 1, ' ');
     size_t start = 0; //Maybe we should output sthg else here?
     if (seq->hasCoordinates())
       start = seq->start();
-    out << TextTools::resizeLeft(TextTools::toString(start), mxcStart, ' ') << " ";
-    out << TextTools::resizeLeft(TextTools::toString(seq->getGenomicSize()), mxcSize, ' ') << " ";
-    out << seq->getStrand() << " ";
-    out << TextTools::resizeLeft(TextTools::toString(seq->getSrcSize()), mxcSrcSize, ' ') << " ";
+    appendNumber_(buffer_, start, mxcStart);
+    buffer_ += ' ';
+    appendNumber_(buffer_, seq->getGenomicSize(), mxcSize);
+    buffer_ += ' ';
+    buffer_ += seq->getStrand();
+    buffer_ += ' ';
+    appendNumber_(buffer_, seq->getSrcSize(), mxcSrcSize);
+    buffer_ += ' ';
     //Shall we write the sequence as masked?
-    string seqstr = seq->toString();
+    if (seq->getAlphabet() != alphabet_)
+      buildDecodingTable_(seq->getAlphabet());
+    const vector<int>& content = seq->getContent();
+    size_t n = content.size();
+    size_t first = buffer_.size();
+    buffer_.resize(first + n);
+    char* dest = &buffer_[0] + first;
     if (mask_ && seq->hasAnnotation(SequenceMask::MASK)) {
       const SequenceMask* mask = &dynamic_cast<const SequenceMask&>(seq->getAnnotation(SequenceMask::MASK));
-      for (size_t j = 0; j < seqstr.size(); ++j) {
-        char c = ((*mask)[j] ? static_cast<char>(tolower(static_cast<int>(seqstr[j]))) : seqstr[j]);
-        out << c;
-      }
+      for (size_t j = 0; j < n; ++j)
+        dest[j] = decode_[(*mask)[j] ? 1 : 0][static_cast<unsigned char>(content[j] + 1)];
     } else {
-      out << seqstr;
+      for (size_t j = 0; j < n; ++j)
+        dest[j] = decode_[0][static_cast<unsigned char>(content[j] + 1)];
     }
-    out << endl;
+    buffer_ += '\n';
     //Write quality scores if any:
     if (mask_ && seq->hasAnnotation(SequenceQuality::QUALITY_SCORE)) {
       const SequenceQuality* qual = &dynamic_cast<const SequenceQuality&>(seq->getAnnotation(SequenceQuality::QUALITY_SCORE));
-      out << "q ";
-      out << TextTools::resizeRight(seq->getName(), mxcSrc + mxcStart + mxcSize + mxcSrcSize + 5, ' ') << " ";
-      string qualStr;
+      buffer_.append("q ");
+      buffer_.append(seq->getName());
+      buffer_.append(mxcSrc + mxcStart + mxcSize + mxcSrcSize + 5 - seq->getName().size() + 1, ' ');
+      //Scores from -2 to 10:
+      static const char scores[] = "?-0123456789F";
       for (size_t j = 0; j < seq->size(); ++j) {
         int s = (*qual)[j];
-        if (s == -1) {
-          qualStr += "-";
-        } else if (s == -2) {
-          qualStr += "?";
-        } else if (s >=0 && s < 10) {
-          qualStr += TextTools::toString(s);
-        } else if (s == 10) {
-          qualStr += "F";
-        } else {
+        if (s < -2 || s > 10)
           throw Exception("MafAlignmentParser::writeBlock. Unsuported score value: " + TextTools::toString(s));
-        }
+        buffer_ += scores[s + 2];
       }
-      out << qualStr << endl;
+      buffer_ += '\n';
     }
   }
-  out << endl;
+  buffer_ += '\n';
+  out.write(buffer_.data(), static_cast<streamsize>(buffer_.size()));
 }
 
@@ -41,16 +41,22 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _OUTPUTMAFITERATOR_H_
 
 #include "MafIterator.h"
+#include "../CompressedOutput.h"
 
 //From the STL:
 #include <iostream>
 #include <string>
 #include <deque>
+#include <memory>
 
 namespace bpp {
 
 /**
  * @brief This iterator forward the iterator given as input after having printed its content to a file.
+ *
+ * Each block is formatted into an internal buffer, which is written to the output stream in one go.
+ * The output can optionally be BGZF compressed, in which case it can be indexed and randomly accessed
+ * (see MafIndex). The BGZF stream is closed when the input iterator is exhausted, or when the iterator is destroyed.
  */
 class OutputMafIterator:
   public AbstractFilterMafIterator
@@ -58,41 +64,66 @@ class OutputMafIterator:
   private:
     std::ostream* output_;
     bool mask_;
+    std::unique_ptr<BgzfOutputStream> bgzf_;
+    //Scratch space for writeBlock, kept from one block to another:
+    mutable std::string buffer_;
+    mutable const Alphabet* alphabet_; //The alphabet for which the decoding table was built.
+    mutable char decode_[2][256]; //Characters for each state (offset by 1 for gaps), upper and lower case.
 
   public:
-    OutputMafIterator(MafIterator* iterator, std::ostream* out, bool mask = true) :
-      AbstractFilterMafIterator(iterator), output_(out), mask_(mask)
+    /**
+     * @param iterator The input iterator.
+     * @param out The output stream where to write the MAF file. It should be open in binary mode if compress is true.
+     * @param mask Tell if masked positions (and quality scores) should be written.
+     * @param compress If true, the output is BGZF compressed.
+     * @param compressionLevel The BGZF compression level (see BgzfStreamBuffer).
+     */
+    OutputMafIterator(MafIterator* iterator, std::ostream* out, bool mask = true, bool compress = false, int compressionLevel = -1) :
+      AbstractFilterMafIterator(iterator), output_(out), mask_(mask), bgzf_(), buffer_(), alphabet_(0), decode_()
     {
+      if (output_ && compress) {
+        bgzf_.reset(new BgzfOutputStream(out, compressionLevel));
+        output_ = bgzf_.get();
+      }
       if (output_)
         writeHeader(*output_);
     }
 
   private:
-    OutputMafIterator(const OutputMafIterator& iterator) :
-      AbstractFilterMafIterator(0),
-      output_(iterator.output_),
-      mask_(iterator.mask_)
-    {}
-    
-    OutputMafIterator& operator=(const OutputMafIterator& iterator)
+    OutputMafIterator(const OutputMafIterator& iterator);
+    OutputMafIterator& operator=(const OutputMafIterator& iterator);
+
+  public:
+    virtual ~OutputMafIterator()
     {
-      output_ = iterator.output_;
-      mask_   = iterator.mask_;
-      return *this;
+      close();
     }
 
+    /**
+     * @brief Close the BGZF stream, if any.
+     *
+     * No block will be written after this method has been called.
+     */
+    void close();
 
-  public:
     MafBlock* analyseCurrentBlock_() {
       currentBlock_ = iterator_->nextBlock();
-      if (output_ && currentBlock_)
-        writeBlock(*output_, *currentBlock_);
+      if (output_) {
+        if (currentBlock_) {
+          writeBlock(*output_, *currentBlock_);
+          countBytesWritten_(buffer_.size()); //The buffer holds the block just written.
+        } else
+          close(); //No more block.
+      }
       return currentBlock_;
     }
 
   private:
     void writeHeader(std::ostream& out) const;
     void writeBlock(std::ostream& out, const MafBlock& block) const;
+    void buildDecodingTable_(const Alphabet* alphabet) const;
+    static void appendNumber_(std::string& buffer, size_t n, size_t width);
+    static size_t getNumberOfDigits_(size_t n);
 };
 
 } // end of namespace bpp.
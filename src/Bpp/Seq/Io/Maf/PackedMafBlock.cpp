@@ -0,0 +1,275 @@
+//
+// File: PackedMafBlock.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "PackedMafBlock.h"
+#include "BinaryIoTools.h"
+
+#include <Bpp/Seq/SequenceWithQuality.h>
+#include <Bpp/Seq/Alphabet/AlphabetExceptions.h>
+#include <Bpp/Seq/SequenceWithAnnotationTools.h>
+
+//From the STL:
+#include <cstring>
+
+using namespace bpp;
+using namespace std;
+
+//Binary I/O, little endian:
+
+static const char READ_CONTEXT[] = "PackedMafBlock::read()";
+
+static void writeWords(ostream& out, const vector<uint64_t>& words)
+{
+  string buffer(words.size() * 8, '\0');
+  for (size_t w = 0; w < words.size(); ++w)
+    for (size_t i = 0; i < 8; ++i)
+      buffer[w * 8 + i] = static_cast<char>((words[w] >> (8 * i)) & 0xff);
+  out.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+}
+
+static void readWords(istream& in, vector<uint64_t>& words, size_t nbWords)
+{
+  string buffer(nbWords * 8, '\0');
+  if (nbWords > 0)
+    in.read(&buffer[0], static_cast<streamsize>(buffer.size()));
+  if (!in)
+    BinaryIoTools::throwEndOfFile(READ_CONTEXT);
+  words.assign(nbWords, 0);
+  for (size_t w = 0; w < nbWords; ++w)
+    for (size_t i = 0; i < 8; ++i)
+      words[w] |= static_cast<uint64_t>(static_cast<unsigned char>(buffer[w * 8 + i])) << (8 * i);
+}
+
+PackedMafSequence::PackedMafSequence(const MafSequence& sequence):
+  name_(sequence.getName()),
+  hasCoordinates_(sequence.hasCoordinates()),
+  begin_(hasCoordinates_ ? sequence.start() : 0),
+  strand_(sequence.getStrand()),
+  srcSize_(sequence.getSrcSize()),
+  size_(sequence.size()),
+  states_((sequence.size() + 15) / 16, 0),
+  mask_(),
+  quality_()
+{
+  const vector<int>& content = sequence.getContent();
+  for (size_t i = 0; i < size_; ++i) {
+    int state = content[i];
+    if (state < -1 || state > 14)
+      throw BadIntException(state, "PackedMafSequence (constructor). State can't be packed.");
+    states_[i >> 4] |= static_cast<uint64_t>(state + 1) << ((i & 15) << 2);
+  }
+  if (sequence.hasAnnotation(SequenceMask::MASK)) {
+    const vector<bool>& mask = dynamic_cast<const SequenceMask&>(sequence.getAnnotation(SequenceMask::MASK)).getMask();
+    mask_.resize(BitTools::getNumberOfWords(size_), 0);
+    for (size_t i = 0; i < size_; ++i)
+      if (mask[i]) BitTools::setBit(mask_, i);
+  }
+  if (sequence.hasAnnotation(SequenceQuality::QUALITY_SCORE)) {
+    const vector<int>& scores = dynamic_cast<const SequenceQuality&>(sequence.getAnnotation(SequenceQuality::QUALITY_SCORE)).getScores();
+    quality_.resize(states_.size(), 0);
+    for (size_t i = 0; i < size_; ++i) {
+      //MAF quality scores are in [-2, 10]:
+      int q = scores[i] + 2;
+      if (q < 0 || q > 15)
+        throw BadIntException(scores[i], "PackedMafSequence (constructor). Quality score can't be packed.");
+      quality_[i >> 4] |= static_cast<uint64_t>(q) << ((i & 15) << 2);
+    }
+  }
+}
+
+void PackedMafSequence::decode(std::vector<int>& content) const
+{
+  content.resize(size_);
+  size_t i = 0;
+  for (size_t w = 0; w < states_.size(); ++w) {
+    uint64_t word = states_[w];
+    unsigned int n = getNumberOfNibbles_(w);
+    for (unsigned int k = 0; k < n; ++k, ++i, word >>= 4)
+      content[i] = static_cast<int>(word & 0xF) - 1;
+  }
+}
+
+MafSequence* PackedMafSequence::unpack() const
+{
+  vector<int> content;
+  decode(content);
+  MafSequence* seq = new MafSequence(name_, std::move(content), begin_, strand_, srcSize_);
+  if (!hasCoordinates_)
+    seq->removeCoordinates();
+  if (hasMask()) {
+    vector<bool> mask(size_);
+    for (size_t i = 0; i < size_; ++i)
+      mask[i] = BitTools::getBit(mask_, i);
+    seq->addAnnotation(new SequenceMask(mask));
+  }
+  if (hasQuality()) {
+    vector<int> scores(size_);
+    for (size_t i = 0; i < size_; ++i)
+      scores[i] = static_cast<int>((quality_[i >> 4] >> ((i & 15) << 2)) & 0xF) - 2;
+    seq->addAnnotation(new SequenceQuality(scores));
+  }
+  return seq;
+}
+
+void PackedMafSequence::write_(ostream& out, map<string, uint32_t>* names) const
+{
+  if (names) {
+    map<string, uint32_t>::iterator it = names->find(name_);
+    if (it == names->end())
+      it = names->insert(make_pair(name_, static_cast<uint32_t>(names->size()))).first;
+    BinaryIoTools::writeUInt(out, it->second, 4);
+  } else {
+    BinaryIoTools::writeUInt(out, name_.size(), 4);
+    out.write(name_.data(), static_cast<streamsize>(name_.size()));
+  }
+  BinaryIoTools::writeUInt(out, (hasCoordinates_ ? 1 : 0) | (hasMask() ? 2 : 0) | (hasQuality() ? 4 : 0), 1);
+  BinaryIoTools::writeUInt(out, static_cast<uint64_t>(static_cast<unsigned char>(strand_)), 1);
+  BinaryIoTools::writeUInt(out, begin_, 8);
+  BinaryIoTools::writeUInt(out, srcSize_, 8);
+  BinaryIoTools::writeUInt(out, size_, 8);
+  writeWords(out, states_);
+  writeWords(out, mask_);
+  writeWords(out, quality_);
+}
+
+PackedMafSequence PackedMafSequence::read_(istream& in, const vector<string>* names)
+{
+  PackedMafSequence seq;
+  size_t n = static_cast<size_t>(BinaryIoTools::readUInt(in, 4, READ_CONTEXT));
+  if (names) {
+    if (n >= names->size())
+      throw IOException("PackedMafBlock::read(). Invalid name index.");
+    seq.name_ = (*names)[n];
+  } else {
+    seq.name_.resize(n);
+    if (n > 0)
+      in.read(&seq.name_[0], static_cast<streamsize>(n));
+  }
+  unsigned int flags = static_cast<unsigned int>(BinaryIoTools::readUInt(in, 1, READ_CONTEXT));
+  seq.hasCoordinates_ = (flags & 1) != 0;
+  seq.strand_ = static_cast<char>(BinaryIoTools::readUInt(in, 1, READ_CONTEXT));
+  seq.begin_ = static_cast<size_t>(BinaryIoTools::readUInt(in, 8, READ_CONTEXT));
+  seq.srcSize_ = static_cast<size_t>(BinaryIoTools::readUInt(in, 8, READ_CONTEXT));
+  seq.size_ = static_cast<size_t>(BinaryIoTools::readUInt(in, 8, READ_CONTEXT));
+  readWords(in, seq.states_, (seq.size_ + 15) / 16);
+  if (flags & 2) readWords(in, seq.mask_, BitTools::getNumberOfWords(seq.size_));
+  if (flags & 4) readWords(in, seq.quality_, (seq.size_ + 15) / 16);
+  return seq;
+}
+
+size_t PackedMafSequence::countCode(unsigned int code) const
+{
+  size_t n = 0;
+  for (size_t w = 0; w < states_.size(); ++w)
+    n += BitTools::countNibbles(states_[w], code, getNumberOfNibbles_(w));
+  return n;
+}
+
+void PackedMafSequence::countCodes(size_t counts[16]) const
+{
+  for (size_t w = 0; w < states_.size(); ++w) {
+    uint64_t word = states_[w];
+    unsigned int n = getNumberOfNibbles_(w);
+    for (unsigned int k = 0; k < n; ++k, word >>= 4)
+      counts[word & 0xF]++;
+  }
+}
+
+PackedMafBlock::PackedMafBlock(const MafBlock& block):
+  score_(block.getScore()),
+  pass_(block.getPass()),
+  nbSites_(block.getNumberOfSites()),
+  sequences_()
+{
+  sequences_.reserve(block.getNumberOfSequences());
+  for (size_t i = 0; i < block.getNumberOfSequences(); ++i)
+    sequences_.push_back(PackedMafSequence(block.getSequence(i)));
+}
+
+MafBlock* PackedMafBlock::unpack() const
+{
+  unique_ptr<MafBlock> block(new MafBlock());
+  block->setScore(score_);
+  block->setPass(pass_);
+  for (size_t i = 0; i < sequences_.size(); ++i)
+    block->addSequence(unique_ptr<MafSequence>(sequences_[i].unpack()));
+  return block.release();
+}
+
+void PackedMafBlock::countCodes(size_t counts[16]) const
+{
+  for (size_t i = 0; i < sequences_.size(); ++i)
+    sequences_[i].countCodes(counts);
+}
+
+void PackedMafBlock::write(ostream& out, map<string, uint32_t>* names) const
+{
+  uint64_t score;
+  memcpy(&score, &score_, sizeof(score));
+  BinaryIoTools::writeUInt(out, score, 8);
+  BinaryIoTools::writeUInt(out, pass_, 4);
+  BinaryIoTools::writeUInt(out, nbSites_, 8);
+  BinaryIoTools::writeUInt(out, sequences_.size(), 4);
+  for (size_t i = 0; i < sequences_.size(); ++i)
+    sequences_[i].write_(out, names);
+}
+
+PackedMafBlock* PackedMafBlock::read(istream& in, const vector<string>* names)
+{
+  if (in.peek() == char_traits<char>::eof())
+    return 0;
+  unique_ptr<PackedMafBlock> block(new PackedMafBlock());
+  uint64_t score = BinaryIoTools::readUInt(in, 8, READ_CONTEXT);
+  memcpy(&block->score_, &score, sizeof(score));
+  block->pass_ = static_cast<unsigned int>(BinaryIoTools::readUInt(in, 4, READ_CONTEXT));
+  block->nbSites_ = static_cast<size_t>(BinaryIoTools::readUInt(in, 8, READ_CONTEXT));
+  size_t nbSequences = static_cast<size_t>(BinaryIoTools::readUInt(in, 4, READ_CONTEXT));
+  block->sequences_.reserve(nbSequences);
+  for (size_t i = 0; i < nbSequences; ++i)
+    block->sequences_.push_back(PackedMafSequence::read_(in, names));
+  return block.release();
+}
+
+size_t PackedMafBlock::getMemorySize() const
+{
+  size_t s = 0;
+  for (size_t i = 0; i < sequences_.size(); ++i)
+    s += sequences_[i].getMemorySize();
+  return s;
+}
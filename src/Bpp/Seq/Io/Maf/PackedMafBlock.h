@@ -0,0 +1,246 @@
+//
+// File: PackedMafBlock.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _PACKEDMAFBLOCK_H_
+#define _PACKEDMAFBLOCK_H_
+
+#include "MafBlock.h"
+#include "BitTools.h"
+
+//From the STL:
+#include <vector>
+#include <string>
+#include <iostream>
+#include <map>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief A compact, read-only representation of a MafSequence.
+ *
+ * DNA states are stored with 4 bits per position: the code of a state is its alphabet code plus one,
+ * so that gaps are encoded as 0, A, C, G, T as 1 to 4 and N as 15. Sixteen positions are stored per 64-bit word.
+ * Masking information, if any, is stored as a separate bitmap, and quality scores, if any, are also stored with 4 bits per position.
+ * Compared to the standard representation, which uses an int per position, memory usage is divided by 8.
+ *
+ * Counting kernels work directly on the packed words.
+ */
+class PackedMafSequence
+{
+  public:
+    static const unsigned int GAP_CODE = 0;
+    static const unsigned int N_CODE = 15;
+
+  private:
+    std::string name_;
+    bool hasCoordinates_;
+    size_t begin_;
+    char strand_;
+    size_t srcSize_;
+    size_t size_;
+    std::vector<uint64_t> states_;
+    std::vector<uint64_t> mask_;
+    std::vector<uint64_t> quality_;
+
+  public:
+    /**
+     * @brief Pack an existing sequence.
+     *
+     * @param sequence The sequence to pack.
+     * @throw BadIntException if the sequence contains an invalid state.
+     */
+    PackedMafSequence(const MafSequence& sequence);
+
+  private:
+    PackedMafSequence():
+      name_(), hasCoordinates_(false), begin_(0), strand_(0), srcSize_(0), size_(0),
+      states_(), mask_(), quality_() {}
+
+  public:
+    const std::string& getName() const { return name_; }
+
+    size_t size() const { return size_; }
+
+    /**
+     * @return The nibble code at a given position.
+     */
+    unsigned int getCode(size_t i) const {
+      return static_cast<unsigned int>((states_[i >> 4] >> ((i & 15) << 2)) & 0xF);
+    }
+
+    /**
+     * @return The alphabet state at a given position.
+     */
+    int getState(size_t i) const { return static_cast<int>(getCode(i)) - 1; }
+
+    bool hasMask() const { return !mask_.empty(); }
+
+    bool isMasked(size_t i) const { return hasMask() && BitTools::getBit(mask_, i); }
+
+    bool hasQuality() const { return !quality_.empty(); }
+
+    /**
+     * @return The packed states, 16 positions per word, first position in the lowest nibble.
+     */
+    const std::vector<uint64_t>& getWords() const { return states_; }
+
+    /**
+     * @return The mask bitmap, 64 positions per word. The vector is empty if there is no mask.
+     */
+    const std::vector<uint64_t>& getMaskBits() const { return mask_; }
+
+    /**
+     * @brief Decode all states.
+     *
+     * @param content A vector which will be filled with the states codes.
+     */
+    void decode(std::vector<int>& content) const;
+
+    /**
+     * @return A new MafSequence object, with mask and quality annotations if any.
+     */
+    MafSequence* unpack() const;
+
+    /**
+     * @return The number of positions with a given nibble code.
+     */
+    size_t countCode(unsigned int code) const;
+
+    /**
+     * @brief Count all codes.
+     *
+     * @param counts An array of size 16, where counts will be added, code by code.
+     */
+    void countCodes(size_t counts[16]) const;
+
+    /**
+     * @return The number of gap positions.
+     */
+    size_t getNumberOfGaps() const { return countCode(GAP_CODE); }
+
+    /**
+     * @return The number of masked positions.
+     */
+    size_t getNumberOfMaskedPositions() const { return hasMask() ? BitTools::countBits(mask_, 0, size_) : 0; }
+
+    /**
+     * @return The size of the packed data, in bytes.
+     */
+    size_t getMemorySize() const { return (states_.size() + mask_.size() + quality_.size()) * sizeof(uint64_t); }
+
+  private:
+    void write_(std::ostream& out, std::map<std::string, uint32_t>* names) const;
+    static PackedMafSequence read_(std::istream& in, const std::vector<std::string>* names);
+
+    friend class PackedMafBlock;
+
+    //Number of valid nibbles in word w:
+    unsigned int getNumberOfNibbles_(size_t w) const {
+      return (w + 1 < states_.size() || (size_ & 15) == 0) ? 16 : static_cast<unsigned int>(size_ & 15);
+    }
+};
+
+/**
+ * @brief A compact, read-only representation of a MafBlock, for stages keeping many blocks in memory.
+ *
+ * The block score, pass and all sequences are stored in packed form (see PackedMafSequence).
+ * Block properties are not kept.
+ *
+ * Packed blocks can be written to and read from a binary stream, for instance to spill blocks to temporary files.
+ * Sequence names can be written as indices in a name table shared by several blocks.
+ */
+class PackedMafBlock
+{
+  private:
+    double score_;
+    unsigned int pass_;
+    size_t nbSites_;
+    std::vector<PackedMafSequence> sequences_;
+
+  public:
+    PackedMafBlock(const MafBlock& block);
+
+  private:
+    PackedMafBlock(): score_(0), pass_(0), nbSites_(0), sequences_() {}
+
+  public:
+    double getScore() const { return score_; }
+    unsigned int getPass() const { return pass_; }
+    size_t getNumberOfSequences() const { return sequences_.size(); }
+    size_t getNumberOfSites() const { return nbSites_; }
+    const PackedMafSequence& getSequence(size_t i) const { return sequences_[i]; }
+
+    /**
+     * @return A new MafBlock object with the same content.
+     */
+    MafBlock* unpack() const;
+
+    /**
+     * @brief Count all codes for all sequences.
+     *
+     * @param counts An array of size 16, where counts will be added, code by code (alphabet state + 1).
+     */
+    void countCodes(size_t counts[16]) const;
+
+    size_t getMemorySize() const;
+
+    /**
+     * @brief Write the block in binary form.
+     *
+     * @param out The output stream, open in binary mode.
+     * @param names If not NULL, sequence names are written as their index in this table,
+     * new names being added to it with the next index.
+     */
+    void write(std::ostream& out, std::map<std::string, uint32_t>* names = 0) const;
+
+    /**
+     * @brief Read a block written by write().
+     *
+     * @param in The input stream, open in binary mode.
+     * @param names The name table, ordered by index, if one was used for writing the block.
+     * @return A new packed block, or 0 if the end of the stream was reached.
+     * @throw IOException If the stream ends within a block, or if a name index is invalid.
+     */
+    static PackedMafBlock* read(std::istream& in, const std::vector<std::string>* names = 0);
+};
+
+} // end of namespace bpp.
+
+#endif //_PACKEDMAFBLOCK_H_
@@ -0,0 +1,198 @@
+//
+// File: ParallelMafIterator.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "ParallelMafIterator.h"
+
+using namespace bpp;
+
+//From the STL:
+#include <algorithm>
+
+using namespace std;
+
+ParallelMafIterator::ParallelMafIterator(MafIterator* iterator, StageFactory factory, unsigned int nbThreads, size_t maxInFlight):
+  AbstractFilterMafIterator(iterator),
+  factory_(factory), nbThreads_(nbThreads), maxInFlight_(maxInFlight),
+  workers_(), pending_(), inFlight_(), ready_(), inFlightBytes_(0),
+  inputDone_(false), stop_(false), mutex_(), workAvailable_(), jobDone_()
+{
+  if (!factory)
+    throw Exception("ParallelMafIterator (constructor). A stage factory must be provided.");
+  if (nbThreads_ == 0)
+    nbThreads_ = max(thread::hardware_concurrency(), 1u);
+  if (maxInFlight_ == 0)
+    maxInFlight_ = 4 * nbThreads_;
+}
+
+ParallelMafIterator::~ParallelMafIterator()
+{
+  {
+    lock_guard<mutex> lock(mutex_);
+    stop_ = true;
+  }
+  workAvailable_.notify_all();
+  for (size_t i = 0; i < workers_.size(); ++i)
+    workers_[i].join();
+  //Free all blocks not retrieved:
+  for (size_t i = 0; i < inFlight_.size(); ++i) {
+    if (inFlight_[i]->input) delete inFlight_[i]->input;
+    for (size_t j = 0; j < inFlight_[i]->outputs.size(); ++j)
+      delete inFlight_[i]->outputs[j];
+  }
+  for (size_t i = 0; i < ready_.size(); ++i)
+    delete ready_[i];
+}
+
+void ParallelMafIterator::startWorkers_()
+{
+  for (unsigned int i = 0; i < nbThreads_; ++i)
+    workers_.push_back(thread(&ParallelMafIterator::workerLoop_, this));
+}
+
+void ParallelMafIterator::workerLoop_()
+{
+  SingleBlockMafIterator input;
+  unique_ptr<MafIterator> stage;
+  {
+    //Factories are not required to be thread-safe:
+    lock_guard<mutex> lock(mutex_);
+    stage.reset(factory_(&input));
+  }
+  stage->setVerbose(false);
+  while (true) {
+    shared_ptr<Job_> job;
+    {
+      unique_lock<mutex> lock(mutex_);
+      while (!stop_ && pending_.empty())
+        workAvailable_.wait(lock);
+      if (stop_)
+        return;
+      job = pending_.front();
+      pending_.pop_front();
+    }
+    try {
+      input.setBlock(job->input);
+      job->input = 0; //The block now belongs to the stage.
+      while (MafBlock* block = stage->nextBlock())
+        job->outputs.push_back(block);
+    } catch (...) {
+      job->error = current_exception();
+      //Reset the stage, which may be in an inconsistent state:
+      input.setBlock(0);
+      lock_guard<mutex> lock(mutex_);
+      stage.reset(factory_(&input));
+      stage->setVerbose(false);
+    }
+    {
+      lock_guard<mutex> lock(mutex_);
+      job->done = true;
+    }
+    jobDone_.notify_all();
+  }
+}
+
+bool ParallelMafIterator::canReadAhead_() const
+{
+  if (inFlight_.size() >= maxInFlight_)
+    return false;
+  if (inFlight_.empty())
+    return true;
+  return !exceedsBufferLimits_(inFlight_.size() + ready_.size() + 1, inFlightBytes_);
+}
+
+void ParallelMafIterator::getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const
+{
+  nbBlocks += inFlight_.size();
+  nbBytes += inFlightBytes_;
+  addBufferContent_(ready_, nbBlocks, nbBytes);
+}
+
+MafBlock* ParallelMafIterator::analyseCurrentBlock_()
+{
+  if (workers_.empty())
+    startWorkers_();
+  while (ready_.empty()) {
+    //Read more input:
+    while (!inputDone_ && canReadAhead_()) {
+      //The block is owned here until it is handed to the job queues:
+      unique_ptr<MafBlock> block(iterator_->nextBlock());
+      if (!block.get()) {
+        inputDone_ = true;
+        break;
+      }
+      //Sizes are only computed when needed:
+      uint64_t size = (monitorBuffers() ? block->getMemorySize() : 0);
+      shared_ptr<Job_> job(new Job_(block.get(), size));
+      {
+        lock_guard<mutex> lock(mutex_);
+        inFlight_.push_back(job);
+        try {
+          pending_.push_back(job);
+        } catch (...) {
+          inFlight_.pop_back();
+          throw;
+        }
+      }
+      block.release();
+      inFlightBytes_ += size;
+      workAvailable_.notify_one();
+    }
+    if (inFlight_.empty())
+      return 0;
+    //Wait for the oldest block:
+    shared_ptr<Job_> job = inFlight_.front();
+    {
+      unique_lock<mutex> lock(mutex_);
+      while (!job->done)
+        jobDone_.wait(lock);
+      inFlight_.pop_front();
+    }
+    inFlightBytes_ -= job->inputSize;
+    if (job->error) {
+      //Blocks output before the error are discarded:
+      for (size_t i = 0; i < job->outputs.size(); ++i)
+        delete job->outputs[i];
+      rethrow_exception(job->error);
+    }
+    ready_.insert(ready_.end(), job->outputs.begin(), job->outputs.end());
+  }
+  currentBlock_ = ready_.front();
+  ready_.pop_front();
+  return currentBlock_;
+}
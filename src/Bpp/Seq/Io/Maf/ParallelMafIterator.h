@@ -0,0 +1,187 @@
+//
+// File: ParallelMafIterator.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _PARALLELMAFITERATOR_H_
+#define _PARALLELMAFITERATOR_H_
+
+#include "MafIterator.h"
+
+//From the STL:
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+namespace bpp {
+
+/**
+ * @brief An iterator which returns a single block, set by hand.
+ *
+ * This is used to feed stages with one block at a time, for instance by ParallelMafIterator.
+ * Once the block has been returned, the iterator returns 0 until a new block is set.
+ */
+class SingleBlockMafIterator:
+  public AbstractMafIterator
+{
+  private:
+    MafBlock* block_;
+
+  public:
+    SingleBlockMafIterator(): AbstractMafIterator(), block_(0) {}
+
+  private:
+    SingleBlockMafIterator(const SingleBlockMafIterator& iterator):
+      AbstractMafIterator(iterator), block_(0) {}
+
+    SingleBlockMafIterator& operator=(const SingleBlockMafIterator& iterator) {
+      AbstractMafIterator::operator=(iterator);
+      block_ = 0;
+      return *this;
+    }
+
+  public:
+    void setBlock(MafBlock* block) { block_ = block; }
+
+  private:
+    MafBlock* analyseCurrentBlock_() {
+      MafBlock* block = block_;
+      block_ = 0;
+      return block;
+    }
+};
+
+/**
+ * @brief Run a per-block stage on several blocks concurrently, while preserving block order.
+ *
+ * The stage is given as a factory, which builds a new stage instance on top of a given input
+ * iterator. One instance is built for each thread. Each input block is then processed by one
+ * of the instances, and all output blocks produced (the stage may remove a block, or split it
+ * into several ones) are returned in input order.
+ *
+ * The stage must be stateless, that is, its output must only depend on the current input block,
+ * and it must accept new input after it returned 0. This is typically the case for filters like
+ * EntropyFilterMafIterator, FullGapFilterMafIterator, SequenceFilterMafIterator, MaskFilterMafIterator
+ * or QualityFilterMafIterator. Stages should not log to a shared, non thread-safe stream: the factory
+ * may disable logging, for instance by calling setLogStream(0). Stage instances are set as non verbose.
+ *
+ * Example:
+ * @code
+ * ParallelMafIterator it(input, [](MafIterator* in) {
+ *   FullGapFilterMafIterator* stage = new FullGapFilterMafIterator(in, species);
+ *   stage->setLogStream(0);
+ *   return stage;
+ * }, 8);
+ * @endcode
+ *
+ * Buffer limits (see setBufferLimits()) bound the number of blocks and bytes read ahead,
+ * in addition to maxInFlight. At least one block is always read.
+ */
+class ParallelMafIterator:
+  public AbstractFilterMafIterator
+{
+  public:
+    typedef std::function<MafIterator* (MafIterator*)> StageFactory;
+
+  private:
+    struct Job_
+    {
+      MafBlock* input;
+      uint64_t inputSize;
+      std::vector<MafBlock*> outputs;
+      bool done;
+      std::exception_ptr error;
+      Job_(MafBlock* block, uint64_t size): input(block), inputSize(size), outputs(), done(false), error() {}
+    };
+
+  private:
+    StageFactory factory_;
+    unsigned int nbThreads_;
+    size_t maxInFlight_;
+    std::vector<std::thread> workers_;
+    std::deque< std::shared_ptr<Job_> > pending_;
+    std::deque< std::shared_ptr<Job_> > inFlight_;
+    std::deque<MafBlock*> ready_;
+    uint64_t inFlightBytes_;
+    bool inputDone_;
+    bool stop_;
+    std::mutex mutex_;
+    std::condition_variable workAvailable_;
+    std::condition_variable jobDone_;
+
+  public:
+    /**
+     * @param iterator The input iterator.
+     * @param factory A function building a new stage instance from an input iterator.
+     * The stage instance is owned by the ParallelMafIterator.
+     * @param nbThreads The number of worker threads (0 means one per available core).
+     * @param maxInFlight The maximum number of input blocks read ahead (0 means 4 per thread).
+     */
+    ParallelMafIterator(MafIterator* iterator, StageFactory factory, unsigned int nbThreads = 0, size_t maxInFlight = 0);
+
+    virtual ~ParallelMafIterator();
+
+  private:
+    //Recopy is forbidden!
+    ParallelMafIterator(const ParallelMafIterator& iterator);
+    ParallelMafIterator& operator=(const ParallelMafIterator& iterator);
+
+  public:
+    unsigned int getNumberOfThreads() const { return nbThreads_; }
+
+  protected:
+    void getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const;
+
+    //Backpressure is applied when reading the input:
+    void bufferLimitsExceeded_() {}
+
+  private:
+    MafBlock* analyseCurrentBlock_();
+
+    bool canReadAhead_() const;
+    void startWorkers_();
+    void workerLoop_();
+};
+
+} // end of namespace bpp.
+
+#endif //_PARALLELMAFITERATOR_H_
@@ -0,0 +1,187 @@
+//
+// File: ParallelSequenceStatisticsMafIterator.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "ParallelSequenceStatisticsMafIterator.h"
+
+using namespace bpp;
+
+//From the STL:
+#include <algorithm>
+
+using namespace std;
+
+ParallelSequenceStatisticsMafIterator::ParallelSequenceStatisticsMafIterator(MafIterator* iterator, StatisticsFactory factory, unsigned int nbThreads, size_t maxInFlight):
+  SequenceStatisticsMafIterator(iterator, factory ? factory() : vector<MafStatistics*>()),
+  factory_(factory), nbThreads_(nbThreads), maxInFlight_(maxInFlight),
+  threadStatistics_(), workers_(), pending_(), inFlight_(),
+  inputDone_(false), merged_(false), stop_(false), mutex_(), workAvailable_(), jobDone_()
+{
+  if (!factory)
+    throw Exception("ParallelSequenceStatisticsMafIterator (constructor). A statistics factory must be provided.");
+  if (nbThreads_ == 0)
+    nbThreads_ = max(thread::hardware_concurrency(), 1u);
+  if (maxInFlight_ == 0)
+    maxInFlight_ = 4 * nbThreads_;
+}
+
+ParallelSequenceStatisticsMafIterator::~ParallelSequenceStatisticsMafIterator()
+{
+  {
+    lock_guard<mutex> lock(mutex_);
+    stop_ = true;
+  }
+  workAvailable_.notify_all();
+  for (size_t i = 0; i < workers_.size(); ++i)
+    workers_[i].join();
+  //Free all blocks not retrieved:
+  for (size_t i = 0; i < inFlight_.size(); ++i) {
+    if (inFlight_[i]->block) delete inFlight_[i]->block;
+  }
+  for (size_t i = 0; i < threadStatistics_.size(); ++i)
+    for (size_t j = 0; j < threadStatistics_[i].size(); ++j)
+      delete threadStatistics_[i][j];
+  for (size_t i = 0; i < statistics_.size(); ++i)
+    delete statistics_[i];
+}
+
+void ParallelSequenceStatisticsMafIterator::startWorkers_()
+{
+  //Factories are not required to be thread-safe, so all instances are built first:
+  for (unsigned int i = 0; i < nbThreads_; ++i) {
+    threadStatistics_.push_back(factory_());
+    if (threadStatistics_.back().size() != statistics_.size())
+      throw Exception("ParallelSequenceStatisticsMafIterator::startWorkers_. The factory must always return the same statistics.");
+  }
+  for (unsigned int i = 0; i < nbThreads_; ++i)
+    workers_.push_back(thread(&ParallelSequenceStatisticsMafIterator::workerLoop_, this, static_cast<size_t>(i)));
+}
+
+void ParallelSequenceStatisticsMafIterator::workerLoop_(size_t index)
+{
+  SingleBlockMafIterator input;
+  SequenceStatisticsMafIterator stage(&input, threadStatistics_[index]);
+  stage.setVerbose(false);
+  while (true) {
+    shared_ptr<Job_> job;
+    {
+      unique_lock<mutex> lock(mutex_);
+      while (!stop_ && pending_.empty())
+        workAvailable_.wait(lock);
+      if (stop_)
+        return;
+      job = pending_.front();
+      pending_.pop_front();
+    }
+    try {
+      input.setBlock(job->block);
+      //The stage returns the input block, unchanged:
+      stage.nextBlock();
+      job->results = stage.getResults();
+    } catch (...) {
+      job->error = current_exception();
+      input.setBlock(0);
+    }
+    {
+      lock_guard<mutex> lock(mutex_);
+      job->done = true;
+    }
+    jobDone_.notify_all();
+  }
+}
+
+void ParallelSequenceStatisticsMafIterator::mergeStatistics_()
+{
+  //All jobs are done, so that thread instances are not in use anymore:
+  for (size_t i = 0; i < statistics_.size(); ++i) {
+    MergeableMafStatistics* stats = dynamic_cast<MergeableMafStatistics*>(statistics_[i]);
+    if (!stats) continue;
+    for (size_t j = 0; j < threadStatistics_.size(); ++j)
+      stats->merge(dynamic_cast<const MergeableMafStatistics&>(*threadStatistics_[j][i]));
+  }
+  merged_ = true;
+}
+
+MafBlock* ParallelSequenceStatisticsMafIterator::analyseCurrentBlock_()
+{
+  if (workers_.empty() && !inputDone_)
+    startWorkers_();
+  //Read more input:
+  while (!inputDone_ && inFlight_.size() < maxInFlight_) {
+    //The block is owned here until it is handed to the job queues:
+    unique_ptr<MafBlock> block(iterator_->nextBlock());
+    if (!block.get()) {
+      inputDone_ = true;
+      break;
+    }
+    shared_ptr<Job_> job(new Job_(block.get()));
+    {
+      lock_guard<mutex> lock(mutex_);
+      inFlight_.push_back(job);
+      try {
+        pending_.push_back(job);
+      } catch (...) {
+        inFlight_.pop_back();
+        throw;
+      }
+    }
+    block.release();
+    workAvailable_.notify_one();
+  }
+  if (inFlight_.empty()) {
+    if (!merged_)
+      mergeStatistics_();
+    return 0;
+  }
+  //Wait for the oldest block:
+  shared_ptr<Job_> job = inFlight_.front();
+  {
+    unique_lock<mutex> lock(mutex_);
+    while (!job->done)
+      jobDone_.wait(lock);
+    inFlight_.pop_front();
+  }
+  if (job->error) {
+    delete job->block;
+    rethrow_exception(job->error);
+  }
+  results_ = std::move(job->results);
+  currentBlock_ = job->block;
+  return currentBlock_;
+}
+
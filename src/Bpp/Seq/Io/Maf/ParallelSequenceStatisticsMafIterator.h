@@ -0,0 +1,146 @@
+//
+// File: ParallelSequenceStatisticsMafIterator.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _PARALLELSEQUENCESTATISTICSMAFITERATOR_H_
+#define _PARALLELSEQUENCESTATISTICSMAFITERATOR_H_
+
+#include "SequenceStatisticsMafIterator.h"
+#include "ParallelMafIterator.h"
+
+//From the STL:
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+namespace bpp {
+
+/**
+ * @brief Compute a series of sequence statistics for several blocks concurrently.
+ *
+ * Statistics are built by a factory, which is called once per thread, plus once for the instances
+ * returned by getStatistics() and used for column names. Statistics instances are therefore never
+ * shared between threads, and are owned by the iterator.
+ *
+ * Blocks are output in input order, and results for the current block are available through getResults()
+ * when iteration listeners are notified, so that listeners like CsvStatisticsOutputIterationListener
+ * can be used as with a SequenceStatisticsMafIterator.
+ *
+ * At the end of the iteration, partial results of statistics implementing the MergeableMafStatistics interface
+ * are merged into the instances returned by getStatistics().
+ *
+ * Example:
+ * @code
+ * ParallelSequenceStatisticsMafIterator it(input, [&]() {
+ *   std::vector<MafStatistics*> stats;
+ *   stats.push_back(new SiteFrequencySpectrumMafStatistics(&AlphabetTools::DNA_ALPHABET, bounds, ingroup, outgroup));
+ *   return stats;
+ * }, 8);
+ * @endcode
+ */
+class ParallelSequenceStatisticsMafIterator:
+  public SequenceStatisticsMafIterator
+{
+  public:
+    typedef std::function<std::vector<MafStatistics*> ()> StatisticsFactory;
+
+  private:
+    struct Job_
+    {
+      MafBlock* block;
+      MafStatisticsResult results;
+      bool done;
+      std::exception_ptr error;
+      Job_(MafBlock* b): block(b), results(), done(false), error() {}
+    };
+
+  private:
+    StatisticsFactory factory_;
+    unsigned int nbThreads_;
+    size_t maxInFlight_;
+    std::vector< std::vector<MafStatistics*> > threadStatistics_;
+    std::vector<std::thread> workers_;
+    std::deque< std::shared_ptr<Job_> > pending_;
+    std::deque< std::shared_ptr<Job_> > inFlight_;
+    bool inputDone_;
+    bool merged_;
+    bool stop_;
+    std::mutex mutex_;
+    std::condition_variable workAvailable_;
+    std::condition_variable jobDone_;
+
+  public:
+    /**
+     * @param iterator The input iterator.
+     * @param factory A function building a new set of statistics instances, always in the same order.
+     * @param nbThreads The number of worker threads (0 means one per available core).
+     * @param maxInFlight The maximum number of input blocks read ahead (0 means 4 per thread).
+     */
+    ParallelSequenceStatisticsMafIterator(MafIterator* iterator, StatisticsFactory factory, unsigned int nbThreads = 0, size_t maxInFlight = 0);
+
+    virtual ~ParallelSequenceStatisticsMafIterator();
+
+  private:
+    //Recopy is forbidden!
+    ParallelSequenceStatisticsMafIterator(const ParallelSequenceStatisticsMafIterator& iterator);
+    ParallelSequenceStatisticsMafIterator& operator=(const ParallelSequenceStatisticsMafIterator& iterator);
+
+  public:
+    unsigned int getNumberOfThreads() const { return nbThreads_; }
+
+    /**
+     * @return The statistics instances of the iterator. Mergeable statistics contain the accumulated values of all threads once the iteration is over.
+     */
+    const std::vector<MafStatistics*>& getStatistics() const { return statistics_; }
+
+  private:
+    MafBlock* analyseCurrentBlock_();
+
+    void startWorkers_();
+    void workerLoop_(size_t index);
+    void mergeStatistics_();
+};
+
+} // end of namespace bpp.
+
+#endif //_PARALLELSEQUENCESTATISTICSMAFITERATOR_H_
@@ -0,0 +1,170 @@
+//
+// File: PipelineProfiler.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "PipelineProfiler.h"
+
+//From bpp-core:
+#include <Bpp/Text/TextTools.h>
+
+//From the STL:
+#include <typeinfo>
+#include <algorithm>
+#include <cstdlib>
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+using namespace bpp;
+using namespace std;
+
+MafStageProfile*& PipelineProfiler::currentStage_()
+{
+  static thread_local MafStageProfile* current = 0;
+  return current;
+}
+
+string PipelineProfiler::getClassName_(const AbstractMafIterator& iterator)
+{
+  string name = typeid(iterator).name();
+#ifdef __GNUG__
+  int status = 0;
+  char* demangled = abi::__cxa_demangle(name.c_str(), 0, 0, &status);
+  if (status == 0 && demangled)
+    name = demangled;
+  free(demangled);
+#endif
+  //Remove the namespace:
+  if (name.compare(0, 5, "bpp::") == 0)
+    name = name.substr(5);
+  return name;
+}
+
+/******************************************************************************/
+
+MafStageProfile& PipelineProfiler::addStage(AbstractMafIterator* iterator, const string& name)
+{
+  if (!iterator)
+    throw NullPointerException("PipelineProfiler::addStage. Iterator should not be a NULL pointer!");
+  if (iterator->getProfile())
+    throw Exception("PipelineProfiler::addStage. Iterator is already profiled.");
+  stages_.push_back(unique_ptr<MafStageProfile>(new MafStageProfile(name.empty() ? getClassName_(*iterator) : name)));
+  iterator->setProfile(stages_.back().get());
+  return *stages_.back();
+}
+
+void PipelineProfiler::attach(AbstractMafIterator* iterator)
+{
+  if (!iterator)
+    throw NullPointerException("PipelineProfiler::attach. Iterator should not be a NULL pointer!");
+  vector<AbstractMafIterator*> chain;
+  AbstractMafIterator* it = iterator;
+  while (it && !it->getProfile() && find(chain.begin(), chain.end(), it) == chain.end()) {
+    chain.push_back(it);
+    AbstractFilterMafIterator* filter = dynamic_cast<AbstractFilterMafIterator*>(it);
+    it = (filter ? dynamic_cast<AbstractMafIterator*>(filter->getInputIterator()) : 0);
+  }
+  //Stages are stored from upstream to downstream:
+  for (size_t i = chain.size(); i > 0; --i)
+    addStage(chain[i - 1]);
+  iterator->addIterationListener(this);
+}
+
+void PipelineProfiler::reset()
+{
+  for (size_t i = 0; i < stages_.size(); ++i)
+    stages_[i]->reset();
+  start_ = lastPrint_ = chrono::steady_clock::now();
+}
+
+/******************************************************************************/
+
+void PipelineProfiler::print(OutputStream& out) const
+{
+  size_t width = 5;
+  uint64_t total = 0;
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    width = max(width, stages_[i]->name.size());
+    total += stages_[i]->getExclusiveTime();
+  }
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start_).count();
+  out << "Pipeline profile after " << TextTools::toString(elapsed, 3) << "s:";
+  out.endLine();
+  out << TextTools::resizeRight("Stage", width) << " " << TextTools::resizeLeft("BlocksIn", 12) << " " << TextTools::resizeLeft("BlocksOut", 12)
+      << " " << TextTools::resizeLeft("SitesIn", 14) << " " << TextTools::resizeLeft("SitesOut", 14)
+      << " " << TextTools::resizeLeft("Time(s)", 10) << " " << TextTools::resizeLeft("Time(%)", 8)
+      << " " << TextTools::resizeLeft("Read(MB)", 10) << " " << TextTools::resizeLeft("Written(MB)", 11);
+  out.endLine();
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    const MafStageProfile& stage = *stages_[i];
+    double time = static_cast<double>(stage.getExclusiveTime()) * 1e-9;
+    double percent = (total > 0 ? 100. * static_cast<double>(stage.getExclusiveTime()) / static_cast<double>(total) : 0.);
+    out << TextTools::resizeRight(stage.name, width)
+        << " " << TextTools::resizeLeft(TextTools::toString(stage.blocksIn), 12)
+        << " " << TextTools::resizeLeft(TextTools::toString(stage.blocksOut), 12)
+        << " " << TextTools::resizeLeft(TextTools::toString(stage.sitesIn), 14)
+        << " " << TextTools::resizeLeft(TextTools::toString(stage.sitesOut), 14)
+        << " " << TextTools::resizeLeft(TextTools::toString(time, 4), 10)
+        << " " << TextTools::resizeLeft(TextTools::toString(percent, 3), 8)
+        << " " << TextTools::resizeLeft(TextTools::toString(static_cast<double>(stage.bytesRead) / 1048576., 4), 10)
+        << " " << TextTools::resizeLeft(TextTools::toString(static_cast<double>(stage.bytesWritten) / 1048576., 4), 11);
+    out.endLine();
+  }
+}
+
+void PipelineProfiler::iterationStarts()
+{
+  start_ = lastPrint_ = chrono::steady_clock::now();
+}
+
+void PipelineProfiler::iterationMoves(const MafBlock& currentBlock)
+{
+  if (interval_ <= 0 || !output_) return;
+  chrono::steady_clock::time_point now = chrono::steady_clock::now();
+  if (chrono::duration<double>(now - lastPrint_).count() >= interval_) {
+    lastPrint_ = now;
+    print(*output_);
+  }
+}
+
+void PipelineProfiler::iterationStops()
+{
+  if (output_)
+    print(*output_);
+}
+
@@ -0,0 +1,224 @@
+//
+// File: PipelineProfiler.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _PIPELINEPROFILER_H_
+#define _PIPELINEPROFILER_H_
+
+#include "MafIterator.h"
+#include "IterationListener.h"
+
+//From bpp-core:
+#include <Bpp/Io/OutputStream.h>
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief Statistics recorded for one stage (iterator) of a pipeline.
+ *
+ * Input counts are the blocks returned by upstream iterators while this stage was running.
+ * Times are in nanoseconds. The exclusive time is the time spent in the stage itself, that is,
+ * the total time minus the time spent in upstream iterators called from the same thread.
+ */
+struct MafStageProfile
+{
+  std::string name;
+  uint64_t blocksIn;
+  uint64_t blocksOut;
+  uint64_t sitesIn;
+  uint64_t sitesOut;
+  uint64_t bytesRead;
+  uint64_t bytesWritten;
+  uint64_t totalTime;
+  uint64_t upstreamTime;
+
+  MafStageProfile(const std::string& stageName = ""):
+    name(stageName), blocksIn(0), blocksOut(0), sitesIn(0), sitesOut(0),
+    bytesRead(0), bytesWritten(0), totalTime(0), upstreamTime(0) {}
+
+  uint64_t getExclusiveTime() const { return totalTime > upstreamTime ? totalTime - upstreamTime : 0; }
+
+  void reset() {
+    blocksIn = blocksOut = sitesIn = sitesOut = bytesRead = bytesWritten = totalTime = upstreamTime = 0;
+  }
+};
+
+/**
+ * @brief Record per-stage statistics of a chain of MafIterator objects.
+ *
+ * Each profiled iterator records the number of blocks and sites it receives and returns, the time spent in
+ * analyseCurrentBlock_() excluding upstream iterators, and the number of bytes read or written,
+ * for iterators which report them (parsers and MAF output). The cost is two clock readings per block and per stage,
+ * and nothing for iterators which are not profiled, so that profiling can stay enabled in production.
+ *
+ * The profiler listens to the last iterator of the chain, and prints a summary table when the iteration stops,
+ * and optionally at regular time intervals.
+ *
+ * @code
+ * PipelineProfiler profiler(ApplicationTools::message.get(), 60.);
+ * profiler.attach(lastIterator); //Profile the whole chain.
+ * while (MafBlock* block = lastIterator->nextBlock())
+ *   lastIterator->recycle(block);
+ * @endcode
+ *
+ * Only blocks obtained with nextBlock() are profiled. Iterators running their input in other
+ * threads, like PrefetchMafIterator, are profiled separately from their input.
+ * The profiler is not owned by the iterators, and must be destroyed after them.
+ */
+class PipelineProfiler:
+  public virtual IterationListener
+{
+  private:
+    std::vector< std::unique_ptr<MafStageProfile> > stages_;
+    OutputStream* output_;
+    double interval_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point lastPrint_;
+
+  public:
+    /**
+     * @param output The stream where summaries are printed (not owned), or NULL.
+     * @param interval The interval, in seconds, between two intermediate summaries. 0 means only at the end.
+     */
+    PipelineProfiler(OutputStream* output = 0, double interval = 0.):
+      stages_(), output_(output), interval_(interval), start_(std::chrono::steady_clock::now()), lastPrint_(start_) {}
+
+    virtual ~PipelineProfiler() {}
+
+  private:
+    //Recopy is forbidden!
+    PipelineProfiler(const PipelineProfiler& profiler);
+    PipelineProfiler& operator=(const PipelineProfiler& profiler);
+
+  public:
+    /**
+     * @brief Profile an iterator and all its upstream iterators.
+     *
+     * Upstream iterators are found through AbstractFilterMafIterator::getInputIterator(). Stages are named
+     * after their class, and the profiler listens to the given iterator.
+     *
+     * @param iterator The last iterator of the chain.
+     */
+    void attach(AbstractMafIterator* iterator);
+
+    /**
+     * @brief Profile a single iterator.
+     *
+     * @param iterator The iterator to profile.
+     * @param name The name of the stage. If empty, the class name is used.
+     * @return The profile of the stage, owned by the profiler.
+     */
+    MafStageProfile& addStage(AbstractMafIterator* iterator, const std::string& name = "");
+
+    size_t getNumberOfStages() const { return stages_.size(); }
+
+    /**
+     * @return The profile of a stage. Stages are ordered from upstream to downstream after attach().
+     */
+    const MafStageProfile& getStage(size_t i) const { return *stages_[i]; }
+
+    /**
+     * @brief Reset all counters.
+     */
+    void reset();
+
+    /**
+     * @brief Print a summary table, with one line per stage.
+     */
+    void print(OutputStream& out) const;
+
+    void iterationStarts();
+    void iterationMoves(const MafBlock& currentBlock);
+    void iterationStops();
+
+    /**
+     * @brief Record the execution of an iterator's analyseCurrentBlock_ method.
+     *
+     * @see AbstractMafIterator::nextBlock
+     */
+    template<class F>
+    static MafBlock* run(MafStageProfile& stage, F analyse);
+
+  private:
+    static MafStageProfile*& currentStage_();
+    static std::string getClassName_(const AbstractMafIterator& iterator);
+};
+
+template<class F>
+MafBlock* PipelineProfiler::run(MafStageProfile& stage, F analyse)
+{
+  MafStageProfile*& current = currentStage_();
+  MafStageProfile* caller = current;
+  current = &stage;
+  std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  MafBlock* block;
+  try {
+    block = analyse();
+  } catch (...) {
+    current = caller;
+    throw;
+  }
+  uint64_t dt = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count());
+  current = caller;
+  stage.totalTime += dt;
+  uint64_t nbSites = (block ? block->getNumberOfSites() : 0);
+  if (block) {
+    stage.blocksOut++;
+    stage.sitesOut += nbSites;
+  }
+  if (caller) {
+    caller->upstreamTime += dt;
+    if (block) {
+      caller->blocksIn++;
+      caller->sitesIn += nbSites;
+    }
+  }
+  return block;
+}
+
+} // end of namespace bpp.
+
+#endif //_PIPELINEPROFILER_H_
+
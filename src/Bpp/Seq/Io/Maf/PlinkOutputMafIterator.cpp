@@ -38,12 +38,13 @@ knowledge of the CeCILL license and that you accept its terms.
 */
 
 #include "PlinkOutputMafIterator.h"
+#include "ColumnCounts.h"
 
 //From bpp-seq:
 #include <Bpp/Seq/SequenceWithAnnotationTools.h>
-#include <Bpp/Seq/Container/VectorSiteContainer.h>
-#include <Bpp/Seq/SiteTools.h>
-#include <Bpp/Seq/SequenceWalker.h>
+
+//From bpp-core:
+#include <Bpp/Text/StringTokenizer.h>
 
 using namespace bpp;
 
@@ -64,15 +65,10 @@ void PlinkOutputMafIterator::init_() {
 void PlinkOutputMafIterator::parseBlock_(std::ostream& out, const MafBlock& block)
 {
   //Preliminary stuff...
-  VectorSiteContainer sites(&AlphabetTools::DNA_ALPHABET);
   for (size_t i = 0; i < species_.size(); ++i) {
-    if (block.hasSequenceForSpecies(species_[i])) {
-      sites.addSequence(block.getSequenceForSpecies(species_[i]));
-      //Note: in case of duplicates, this takes the first sequence.
-    } else {
-      //Block with missing species are ignored.
+    //Block with missing species are ignored.
+    if (!block.hasSequenceForSpecies(species_[i]))
       return;
-    }
   }
   //Get the reference species for coordinates:
   if (! block.hasSequenceForSpecies(refSpecies_))
@@ -101,30 +97,41 @@ void PlinkOutputMafIterator::parseBlock_(std::ostream& out, const MafBlock& bloc
     }
   }
 
-  SequenceWalker walker(refSeq);
-  size_t offset = refSeq.start();
-  int gap = refSeq.getAlphabet()->getGapCharacterCode();
-  
-  //Now we shall scan all sites for SNPs:
-  for (size_t i = 0; i < sites.getNumberOfSites(); i++) {
-    if (refSeq[i] == gap)
-      continue;
-
-    //We call SNPs only at position without gap or unresolved characters, and for biallelic sites:
-    if (SiteTools::isComplete(sites.getSite(i)) && SiteTools::getNumberOfDistinctCharacters(sites.getSite(i)) == 2) {
-      string pos = "NA";
-      if (refSeq[i] != gap) {
-        pos = TextTools::toString(offset + walker.getSequencePosition(i) + 1);
+  //We call SNPs only at position without gap or unresolved characters, and for biallelic sites.
+  //Note: in case of duplicates, the first sequence of each species is used.
+  matrix_.clear();
+  matrix_.addBlock(block, refSpecies_);
+
+  const string& chars = ColumnCounts::getCharacters();
+  size_t nbBytes = (species_.size() + 3) / 4;
+  for (size_t v = 0; v < matrix_.getNumberOfVariants(); ++v) {
+    //Positions are 1-based in PLINK files:
+    uint64_t pos = matrix_.getPosition(v) + 1;
+    char a1 = chars[static_cast<size_t>(matrix_.getFirstAllele(v) + 1)];
+    char a2 = chars[static_cast<size_t>(matrix_.getSecondAllele(v) + 1)];
+    // SNP identifier are built as <chr>.<pos>
+    out << chrStr << "\t" << chr << "." << pos << "\t";
+    if (!map3_)
+      out << "0\t"; //Add null genetic distance
+    out << pos;
+    if (binary_) {
+      //The first allele is the one of the first sequence, which is coded as 00 (homozygous), the other one as 11.
+      size_t first = bedBuffer_.size();
+      bedBuffer_.append(nbBytes, '\0');
+      for (size_t j = 0; j < species_.size(); ++j) {
+        if (matrix_.hasSecondAllele(v, j))
+          bedBuffer_[first + j / 4] = static_cast<char>(bedBuffer_[first + j / 4] | (3 << (2 * (j % 4))));
       }
-      string alleles = sites.getSite(i).toString();
-      for (size_t j = 0; j < alleles.size(); ++j) {
-        ped_[j] += "\t" + TextTools::toString(alleles[j]) + " " + alleles[j];
+      out << "\t" << a1 << "\t" << a2 << "\n";
+    } else {
+      for (size_t j = 0; j < species_.size(); ++j) {
+        char c = matrix_.hasSecondAllele(v, j) ? a2 : a1;
+        ped_[j] += '\t';
+        ped_[j] += c;
+        ped_[j] += ' ';
+        ped_[j] += c;
       }
-      // SNP identifier are built as <chr>.<pos>
-      out << chrStr << "\t" << chr << "." << pos << "\t";
-      if (!map3_)
-        out << "0\t"; //Add null genetic distance
-      out << pos << endl;
+      out << "\n";
     }
   }
 }
@@ -134,3 +141,42 @@ void PlinkOutputMafIterator::writePedToFile_(ostream& out) {
     out << ped_[i] << endl;
 }
 
+void PlinkOutputMafIterator::saveState(MafCheckpoint& checkpoint, const string& prefix)
+{
+  if (outputMap_) outputMap_->flush();
+  if (outputBed_) outputBed_->flush();
+  checkpoint.setValue(prefix + "chr", currentChr_);
+  checkpoint.setValue(prefix + "position", static_cast<uint64_t>(lastPosition_));
+  checkpoint.setValue(prefix + "code", static_cast<uint64_t>(currentCode_));
+  string codes;
+  for (map<string, unsigned int>::const_iterator it = chrCodes_.begin(); it != chrCodes_.end(); ++it)
+    codes += it->first + "\t" + TextTools::toString(it->second) + "\n";
+  checkpoint.setValue(prefix + "chrCodes", codes);
+  //The ped file is only written at the end:
+  if (!binary_) {
+    for (size_t i = 0; i < ped_.size(); ++i)
+      checkpoint.setValue(prefix + "ped" + TextTools::toString(i), ped_[i]);
+  }
+}
+
+void PlinkOutputMafIterator::restoreState(const MafCheckpoint& checkpoint, const string& prefix)
+{
+  currentChr_ = checkpoint.getValue(prefix + "chr");
+  lastPosition_ = static_cast<size_t>(checkpoint.getUIntValue(prefix + "position"));
+  currentCode_ = static_cast<unsigned int>(checkpoint.getUIntValue(prefix + "code"));
+  chrCodes_.clear();
+  StringTokenizer lines(checkpoint.getValue(prefix + "chrCodes"), "\n");
+  while (lines.hasMoreToken()) {
+    string line = lines.nextToken();
+    size_t tab = line.rfind('\t');
+    if (tab == string::npos)
+      throw Exception("PlinkOutputMafIterator::restoreState. Invalid chromosome codes.");
+    chrCodes_[line.substr(0, tab)] = TextTools::to<unsigned int>(line.substr(tab + 1));
+  }
+  if (!binary_) {
+    for (size_t i = 0; i < ped_.size(); ++i)
+      ped_[i] = checkpoint.getValue(prefix + "ped" + TextTools::toString(i));
+  }
+  bedBuffer_.clear();
+}
+
@@ -41,6 +41,8 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _PLINKOUTPUTMAFITERATOR_H_
 
 #include "MafIterator.h"
+#include "MafCheckpoint.h"
+#include "HaplotypeMatrix.h"
 
 //From the STL:
 #include <iostream>
@@ -51,13 +53,22 @@ namespace bpp {
 
 /**
  * @brief This iterator outputs all biallelic SNPs in the PLINK format (ped and map files).
+ *
+ * Alternatively, SNPs can be written in the PLINK binary format (bed, bim and fam files).
+ * In this case, the bed file is SNP-major and genotypes are packed on two bits. They are
+ * written as SNPs are found, so that memory usage does not depend on the number of sites.
+ * SNPs are called with a HaplotypeMatrix, filled block by block.
  */
 class PlinkOutputMafIterator:
-  public AbstractFilterMafIterator
+  public AbstractFilterMafIterator,
+  public virtual CheckpointableMafIterator
 {
   private:
     std::ostream* outputPed_;
     std::ostream* outputMap_;
+    std::ostream* outputBed_;
+    bool binary_;
+    std::string bedBuffer_;
     std::vector<std::string> species_;
     std::string refSpecies_;
     bool map3_;
@@ -67,6 +78,7 @@ class PlinkOutputMafIterator:
     bool recodeChr_;
     std::map<std::string, unsigned int> chrCodes_;
     unsigned int currentCode_;
+    HaplotypeMatrix matrix_;
 
   public:
     /**
@@ -95,17 +107,60 @@ class PlinkOutputMafIterator:
         bool map3 = false,
         bool recodeChr = false) :
       AbstractFilterMafIterator(iterator),
-      outputPed_(outPed), outputMap_(outMap), species_(species), refSpecies_(reference), map3_(map3),
-      ped_(species.size()), currentChr_(""), lastPosition_(0), recodeChr_(recodeChr), chrCodes_(), currentCode_(1)
+      outputPed_(outPed), outputMap_(outMap), outputBed_(0), binary_(false), bedBuffer_(),
+      species_(species), refSpecies_(reference), map3_(map3),
+      ped_(species.size()), currentChr_(""), lastPosition_(0), recodeChr_(recodeChr), chrCodes_(), currentCode_(1), matrix_(species)
     {
       init_();
     }
 
+    /**
+     * @brief Build a new PlinkOutputMafIterator object writing binary files.
+     *
+     * As for the text output, each sequence is considered as a haploid genome and will be written as a homozygous SNP.
+     * The fam file is written upon construction, and the bed and bim files are written as SNPs are found.
+     *
+     * @param iterator The input iterator.
+     * @param outBed The output stream where to write the bed file. It should be open in binary mode.
+     * @param outBim The output stream where to write the bim file (extended map file).
+     * @param outFam The output stream where to write the fam file.
+     * @param species A list of at least two species to compute SNPs.
+     * Only blocks containing at least these two species will be used.
+     * In case one species is duplicated in a block, the first sequence will be used.
+     * @param reference The species to use as a reference for coordinates.
+     * It does not have to be one of the selected species on which SNPs are computed.
+     * @param recodeChr Tell if chromosomes should be recoded to numbers.
+     */
+    PlinkOutputMafIterator(MafIterator* iterator,
+        std::ostream* outBed,
+        std::ostream* outBim,
+        std::ostream* outFam,
+        const std::vector<std::string>& species,
+        const std::string& reference,
+        bool recodeChr = false) :
+      AbstractFilterMafIterator(iterator),
+      outputPed_(0), outputMap_(outBim), outputBed_(outBed), binary_(true), bedBuffer_(),
+      species_(species), refSpecies_(reference), map3_(false),
+      ped_(species.size()), currentChr_(""), lastPosition_(0), recodeChr_(recodeChr), chrCodes_(), currentCode_(1), matrix_(species)
+    {
+      init_();
+      if (outFam)
+        writePedToFile_(*outFam);
+      if (outputBed_) {
+        //Magic number, followed by the SNP-major mode flag:
+        static const char magic[3] = {0x6c, 0x1b, 0x01};
+        outputBed_->write(magic, 3);
+      }
+    }
+
   private:
     PlinkOutputMafIterator(const PlinkOutputMafIterator& iterator) :
       AbstractFilterMafIterator(0),
       outputPed_(iterator.outputPed_),
       outputMap_(iterator.outputMap_),
+      outputBed_(iterator.outputBed_),
+      binary_(iterator.binary_),
+      bedBuffer_(),
       species_(iterator.species_),
       refSpecies_(iterator.refSpecies_),
       map3_(iterator.map3_),
@@ -114,13 +169,17 @@ class PlinkOutputMafIterator:
       lastPosition_(iterator.lastPosition_),
       recodeChr_(iterator.recodeChr_),
       chrCodes_(iterator.chrCodes_),
-      currentCode_(iterator.currentCode_)
+      currentCode_(iterator.currentCode_),
+      matrix_(iterator.species_)
     {}
     
     PlinkOutputMafIterator& operator=(const PlinkOutputMafIterator& iterator)
     {
       outputPed_       = iterator.outputPed_;
       outputMap_       = iterator.outputMap_;
+      outputBed_       = iterator.outputBed_;
+      binary_          = iterator.binary_;
+      bedBuffer_.clear();
       species_         = iterator.species_;
       refSpecies_      = iterator.refSpecies_;
       map3_            = iterator.map3_;
@@ -130,6 +189,7 @@ class PlinkOutputMafIterator:
       recodeChr_       = iterator.recodeChr_;
       chrCodes_        = iterator.chrCodes_;
       currentCode_     = iterator.currentCode_;
+      matrix_          = HaplotypeMatrix(iterator.species_);
       return *this;
     }
 
@@ -141,9 +201,20 @@ class PlinkOutputMafIterator:
         parseBlock_(*outputMap_, *currentBlock_);
       if (outputMap_ && outputPed_ && !currentBlock_)
         writePedToFile_(*outputPed_); //Note we currently can output Map and no Ped, but not Ped without Map.
+      if (outputBed_ && bedBuffer_.size() > 0) {
+        //Genotypes are written block by block:
+        outputBed_->write(bedBuffer_.data(), static_cast<std::streamsize>(bedBuffer_.size()));
+        bedBuffer_.clear();
+      }
       return currentBlock_;
     }
 
+    /**
+     * @brief Flush the outputs, and save the chromosome codes, as well as the genotypes of the ped file in text mode.
+     */
+    void saveState(MafCheckpoint& checkpoint, const std::string& prefix);
+    void restoreState(const MafCheckpoint& checkpoint, const std::string& prefix);
+
   private:
     void init_();
     void parseBlock_(std::ostream& out, const MafBlock& block);
@@ -0,0 +1,125 @@
+//
+// File: PrefetchMafIterator.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "PrefetchMafIterator.h"
+
+using namespace bpp;
+using namespace std;
+
+PrefetchMafIterator::~PrefetchMafIterator()
+{
+  if (running_) {
+    queue_.close();
+    {
+      //Wake up the producer if it waits for the buffer limits:
+      lock_guard<mutex> lock(spaceMutex_);
+    }
+    spaceAvailable_.notify_all();
+    producer_.join();
+    //Free blocks which were never retrieved:
+    MafBlock* block = 0;
+    while (queue_.tryPop(block))
+      if (block) delete block;
+  }
+}
+
+void PrefetchMafIterator::waitForSpace_(uint64_t size)
+{
+  unique_lock<mutex> lock(spaceMutex_);
+  while (!queue_.isClosed() && queuedBlocks_.load() > 0 && exceedsBufferLimits_(queuedBlocks_.load() + 1, queuedBytes_.load() + size))
+    spaceAvailable_.wait(lock);
+}
+
+void PrefetchMafIterator::produce_()
+{
+  try {
+    MafBlock* block = 0;
+    do {
+      block = iterator_->nextBlock();
+      if (block && monitorBuffers()) {
+        uint64_t size = block->getMemorySize();
+        if (getMaxBufferedBlocks() > 0 || getMaxBufferedBytes() > 0)
+          waitForSpace_(size);
+        queuedBlocks_ += 1;
+        queuedBytes_ += size;
+      }
+      if (!queue_.push(block)) {
+        //The queue was closed by the consumer:
+        if (block) delete block;
+        return;
+      }
+    } while (block);
+  } catch (...) {
+    error_ = current_exception();
+    queue_.push(0);
+  }
+}
+
+MafBlock* PrefetchMafIterator::analyseCurrentBlock_()
+{
+  if (finished_)
+    return 0;
+  if (!running_) {
+    producer_ = thread(&PrefetchMafIterator::produce_, this);
+    running_ = true;
+  }
+  MafBlock* block = 0;
+  queue_.pop(block);
+  if (block && monitorBuffers()) {
+    queuedBlocks_ -= 1;
+    queuedBytes_ -= block->getMemorySize();
+    if (getMaxBufferedBlocks() > 0 || getMaxBufferedBytes() > 0) {
+      {
+        lock_guard<mutex> lock(spaceMutex_);
+      }
+      spaceAvailable_.notify_one();
+    }
+  }
+  if (!block) {
+    finished_ = true;
+    if (error_) {
+      //Wait for the producer to be done before forwarding the exception:
+      producer_.join();
+      running_ = false;
+      rethrow_exception(error_);
+    }
+  }
+  currentBlock_ = block;
+  return block;
+}
@@ -0,0 +1,126 @@
+//
+// File: PrefetchMafIterator.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _PREFETCHMAFITERATOR_H_
+#define _PREFETCHMAFITERATOR_H_
+
+#include "MafIterator.h"
+#include "SpscBoundedQueue.h"
+
+//From the STL:
+#include <thread>
+#include <exception>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+namespace bpp {
+
+/**
+ * @brief Read blocks ahead from an input iterator, on a dedicated thread.
+ *
+ * The input iterator (typically a MafParser, possibly followed by cheap filters) is run
+ * on a background thread, which stores completed blocks in a bounded queue. Parsing and
+ * I/O therefore overlap with the downstream processing of the blocks. The background
+ * thread is started upon the first call to nextBlock().
+ *
+ * Iteration listeners attached to this iterator are fired in block order on the consumer
+ * thread, as for any other iterator. Listeners attached to the input iterator, however,
+ * are fired on the background thread, and should not share non thread-safe state with the
+ * downstream stages. Exceptions thrown by the input iterator are forwarded to the consumer
+ * when the corresponding block is requested.
+ *
+ * Buffer limits (see setBufferLimits()) bound the number of blocks and bytes in the queue,
+ * in addition to its size: the background thread waits until enough blocks were consumed.
+ * At least one block is always queued.
+ */
+class PrefetchMafIterator:
+  public AbstractFilterMafIterator
+{
+  private:
+    SpscBoundedQueue<MafBlock*> queue_;
+    std::thread producer_;
+    bool running_;
+    bool finished_;
+    std::exception_ptr error_;
+    std::atomic<size_t> queuedBlocks_;
+    std::atomic<uint64_t> queuedBytes_;
+    std::mutex spaceMutex_;
+    std::condition_variable spaceAvailable_;
+
+  public:
+    /**
+     * @param iterator The input iterator.
+     * @param queueSize The maximum number of blocks waiting in the queue.
+     */
+    PrefetchMafIterator(MafIterator* iterator, size_t queueSize = 16):
+      AbstractFilterMafIterator(iterator),
+      queue_(queueSize), producer_(), running_(false), finished_(false), error_(),
+      queuedBlocks_(0), queuedBytes_(0), spaceMutex_(), spaceAvailable_()
+    {}
+
+    virtual ~PrefetchMafIterator();
+
+  private:
+    //Recopy is forbidden!
+    PrefetchMafIterator(const PrefetchMafIterator& iterator);
+    PrefetchMafIterator& operator=(const PrefetchMafIterator& iterator);
+
+  public:
+    size_t getQueueSize() const { return queue_.getCapacity(); }
+
+  protected:
+    void getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const {
+      nbBlocks += queuedBlocks_.load();
+      nbBytes += queuedBytes_.load();
+    }
+
+    //Backpressure is applied by the background thread:
+    void bufferLimitsExceeded_() {}
+
+  private:
+    MafBlock* analyseCurrentBlock_();
+
+    void produce_();
+    void waitForSpace_(uint64_t size);
+};
+
+} // end of namespace bpp.
+
+#endif //_PREFETCHMAFITERATOR_H_
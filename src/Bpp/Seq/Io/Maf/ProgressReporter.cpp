@@ -0,0 +1,158 @@
+//
+// File: ProgressReporter.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "ProgressReporter.h"
+
+//From bpp-core:
+#include <Bpp/Text/TextTools.h>
+
+//From the STL:
+#include <fstream>
+#include <algorithm>
+
+using namespace bpp;
+using namespace std;
+
+ProgressReporter::ProgressReporter(OutputStream* output, double interval, uint64_t totalBytes):
+  nbBytes_(0), nbBlocks_(0), nbSites_(0), totalBytes_(totalBytes),
+  output_(output), interval_(interval), start_(chrono::steady_clock::now()),
+  thread_(), running_(false), mutex_(), stopped_()
+{
+  if (interval_ <= 0)
+    throw Exception("ProgressReporter (constructor). Interval should be strictly positive.");
+}
+
+ProgressReporter::~ProgressReporter()
+{
+  //Do not print anything if the iteration did not complete:
+  {
+    lock_guard<mutex> lock(mutex_);
+    running_ = false;
+  }
+  stopped_.notify_all();
+  if (thread_.joinable())
+    thread_.join();
+}
+
+void ProgressReporter::attach(AbstractMafIterator* iterator)
+{
+  if (!iterator)
+    throw NullPointerException("ProgressReporter::attach. Iterator should not be a NULL pointer!");
+  vector<AbstractMafIterator*> chain;
+  AbstractMafIterator* it = iterator;
+  while (it && find(chain.begin(), chain.end(), it) == chain.end()) {
+    chain.push_back(it);
+    it->setProgressReporter(this);
+    AbstractFilterMafIterator* filter = dynamic_cast<AbstractFilterMafIterator*>(it);
+    it = (filter ? dynamic_cast<AbstractMafIterator*>(filter->getInputIterator()) : 0);
+  }
+  iterator->addIterationListener(this);
+}
+
+void ProgressReporter::start()
+{
+  lock_guard<mutex> lock(mutex_);
+  if (running_ || thread_.joinable())
+    return;
+  start_ = chrono::steady_clock::now();
+  running_ = true;
+  thread_ = thread(&ProgressReporter::run_, this);
+}
+
+void ProgressReporter::stop()
+{
+  {
+    lock_guard<mutex> lock(mutex_);
+    if (!running_)
+      return;
+    running_ = false;
+  }
+  stopped_.notify_all();
+  thread_.join();
+  if (output_)
+    print(*output_);
+}
+
+void ProgressReporter::run_()
+{
+  chrono::steady_clock::duration step = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(interval_));
+  chrono::steady_clock::time_point next = chrono::steady_clock::now() + step;
+  unique_lock<mutex> lock(mutex_);
+  while (running_) {
+    if (stopped_.wait_until(lock, next) == cv_status::timeout && running_) {
+      next += step;
+      if (output_)
+        print(*output_);
+    }
+  }
+}
+
+void ProgressReporter::print(OutputStream& out) const
+{
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start_).count();
+  double mb = static_cast<double>(getNumberOfBytes()) / 1048576.;
+  out << "Progress: ";
+  if (totalBytes_ > 0)
+    out << TextTools::toString(100. * static_cast<double>(getNumberOfBytes()) / static_cast<double>(totalBytes_), 3) << "% ";
+  out << TextTools::toString(mb, 4) << " MB read, " << TextTools::toString(getNumberOfBlocks()) << " blocks, "
+      << TextTools::toString(getNumberOfSites()) << " sites in " << TextTools::toString(elapsed, 3) << "s";
+  if (elapsed > 0)
+    out << " (" << TextTools::toString(mb / elapsed, 4) << " MB/s, " << TextTools::toString(static_cast<double>(getNumberOfBlocks()) / elapsed, 4) << " blocks/s)";
+  out << ".";
+  out.endLine();
+  out.flush();
+}
+
+void ProgressReporter::iterationMovesBatch(const MafBlock* const* blocks, size_t nbBlocks)
+{
+  uint64_t nbSites = 0;
+  for (size_t i = 0; i < nbBlocks; ++i)
+    nbSites += blocks[i]->getNumberOfSites();
+  addBlocks(nbBlocks, nbSites);
+}
+
+uint64_t ProgressReporter::getFileSize(const string& path)
+{
+  ifstream file(path.c_str(), ios::in | ios::binary | ios::ate);
+  if (!file)
+    return 0;
+  streamoff size = file.tellg();
+  return (size > 0 ? static_cast<uint64_t>(size) : 0);
+}
+
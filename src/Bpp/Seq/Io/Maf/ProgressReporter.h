@@ -0,0 +1,165 @@
+//
+// File: ProgressReporter.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _PROGRESSREPORTER_H_
+#define _PROGRESSREPORTER_H_
+
+#include "MafIterator.h"
+#include "IterationListener.h"
+
+//From bpp-core:
+#include <Bpp/Io/OutputStream.h>
+
+//From the STL:
+#include <string>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief Report the progress of a chain of MafIterator objects, at a fixed rate.
+ *
+ * Iterators report counters with atomic increments: the number of bytes read from the input
+ * (for iterators which report them, like parsers), and the number of blocks and sites returned
+ * by the last iterator of the chain. A dedicated thread renders the counters at regular time intervals,
+ * with the fraction of the input processed if its total size is known. Counters can be updated from
+ * any thread, for instance a MafParser running behind a PrefetchMafIterator.
+ *
+ * Stages to which a reporter is attached do not display their own per-block progress in verbose mode.
+ *
+ * @code
+ * ProgressReporter progress(ApplicationTools::message.get(), 1., ProgressReporter::getFileSize("input.maf"));
+ * progress.attach(lastIterator);
+ * while (MafBlock* block = lastIterator->nextBlock()) { ... }
+ * @endcode
+ *
+ * The reporting thread is started when the iteration starts, and stopped when it stops,
+ * at which point a final line is printed. The reporter must be destroyed after the iterators.
+ */
+class ProgressReporter:
+  public virtual IterationListener
+{
+  private:
+    std::atomic<uint64_t> nbBytes_;
+    std::atomic<uint64_t> nbBlocks_;
+    std::atomic<uint64_t> nbSites_;
+    uint64_t totalBytes_;
+    OutputStream* output_;
+    double interval_;
+    std::chrono::steady_clock::time_point start_;
+    std::thread thread_;
+    bool running_;
+    std::mutex mutex_;
+    std::condition_variable stopped_;
+
+  public:
+    /**
+     * @param output The stream where progress is printed (not owned), or NULL.
+     * @param interval The interval, in seconds, between two progress lines.
+     * @param totalBytes The total size of the input, or 0 if unknown.
+     */
+    ProgressReporter(OutputStream* output, double interval = 1., uint64_t totalBytes = 0);
+
+    virtual ~ProgressReporter();
+
+  private:
+    //Recopy is forbidden!
+    ProgressReporter(const ProgressReporter& reporter);
+    ProgressReporter& operator=(const ProgressReporter& reporter);
+
+  public:
+    /**
+     * @brief Report the progress of an iterator and all its upstream iterators.
+     *
+     * Blocks are counted at the given iterator, and bytes at any upstream iterator reporting them.
+     * @param iterator The last iterator of the chain.
+     */
+    void attach(AbstractMafIterator* iterator);
+
+    void setTotalBytes(uint64_t totalBytes) { totalBytes_ = totalBytes; }
+    uint64_t getTotalBytes() const { return totalBytes_; }
+
+    void addBytes(uint64_t nbBytes) { nbBytes_.fetch_add(nbBytes, std::memory_order_relaxed); }
+    void addBlocks(uint64_t nbBlocks, uint64_t nbSites) {
+      nbBlocks_.fetch_add(nbBlocks, std::memory_order_relaxed);
+      nbSites_.fetch_add(nbSites, std::memory_order_relaxed);
+    }
+
+    uint64_t getNumberOfBytes() const { return nbBytes_.load(std::memory_order_relaxed); }
+    uint64_t getNumberOfBlocks() const { return nbBlocks_.load(std::memory_order_relaxed); }
+    uint64_t getNumberOfSites() const { return nbSites_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Start the reporting thread. This is called when the iteration starts.
+     */
+    void start();
+
+    /**
+     * @brief Stop the reporting thread, and print the final counts. This is called when the iteration stops.
+     */
+    void stop();
+
+    /**
+     * @brief Print the current counts on one line.
+     */
+    void print(OutputStream& out) const;
+
+    /**
+     * @return The size of a file, or 0 if it cannot be determined.
+     */
+    static uint64_t getFileSize(const std::string& path);
+
+  public:
+    void iterationStarts() { start(); }
+    void iterationMoves(const MafBlock& currentBlock) { addBlocks(1, currentBlock.getNumberOfSites()); }
+    void iterationMovesBatch(const MafBlock* const* blocks, size_t nbBlocks);
+    void iterationStops() { stop(); }
+
+  private:
+    void run_();
+};
+
+} // end of namespace bpp.
+
+#endif //_PROGRESSREPORTER_H_
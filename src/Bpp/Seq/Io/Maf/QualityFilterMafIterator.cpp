@@ -38,199 +38,146 @@ knowledge of the CeCILL license and that you accept its terms.
 */
 
 #include "QualityFilterMafIterator.h"
+#include "SlidingWindowTools.h"
 
 //From bpp-seq:
 #include <Bpp/Seq/SequenceWithQuality.h>
 
+//From bpp-core:
+#include <Bpp/Numeric/NumConstants.h>
+
 using namespace bpp;
 
 //From the STL:
 #include <string>
 #include <numeric>
+#include <algorithm>
 
 using namespace std;
 
-MafBlock* QualityFilterMafIterator::analyseCurrentBlock_()
+//Events reported by this filter:
+static const MafEventType QUAL_NO_QUALITY("QUAL CLEANER", "no_quality", MafEventType::LEVEL_WARNING,
+    "QUAL CLEANER: block is missing quality score for at least one species and will therefore not be filtered.");
+static const MafEventType QUAL_KEPT("QUAL CLEANER", "kept", MafEventType::LEVEL_DEBUG,
+    "QUAL CLEANER: block is clean and kept as is.");
+static const MafEventType QUAL_REMOVED("QUAL CLEANER", "removed", MafEventType::LEVEL_INFO,
+    "QUAL CLEANER: block was entirely removed. Tried to get the next one.");
+static const MafEventType QUAL_SPLIT("QUAL CLEANER", "split", MafEventType::LEVEL_INFO,
+    "QUAL CLEANER: block with size %0 will be split into %1 blocks.");
+static const MafEventType QUAL_REGION_REMOVED("QUAL CLEANER", "region_removed", MafEventType::LEVEL_DEBUG,
+    "QUAL CLEANER: removing region (%0, %1) from block.");
+
+MafBlock* QualityFilterMafIterator::splitNextBlock_()
 {
-  if (blockBuffer_.size() == 0) {
-    do {
-      //Else there is no more block in the buffer, we need parse more:
-      MafBlock* block = iterator_->nextBlock();
-      if (!block) return 0; //No more block.
-    
-      //Parse block.
-      vector< vector<int> > aln;
-      for (size_t i = 0; i < species_.size(); ++i) {
-        const MafSequence* seq = &block->getSequenceForSpecies(species_[i]);
-        if (seq->hasAnnotation(SequenceQuality::QUALITY_SCORE)) {
-          aln.push_back(dynamic_cast<const SequenceQuality&>(seq->getAnnotation(SequenceQuality::QUALITY_SCORE)).getScores());
-        }
+  do {
+    //Else there is no more block in the buffer, we need parse more:
+    MafBlock* block = iterator_->nextBlock();
+    if (!block) return 0; //No more block.
+  
+    //Parse block.
+    vector<const vector<int>*> aln;
+    for (size_t i = 0; i < species_.size(); ++i) {
+      const MafSequence* seq = &block->getSequenceForSpecies(species_[i]);
+      if (seq->hasAnnotation(SequenceQuality::QUALITY_SCORE)) {
+        aln.push_back(&dynamic_cast<const SequenceQuality&>(seq->getAnnotation(SequenceQuality::QUALITY_SCORE)).getScores());
       }
-      if (aln.size() != species_.size()) {
-        blockBuffer_.push_back(block);
-        if (logstream_) {
-          (*logstream_ << "QUAL CLEANER: block is missing quality score for at least one species and will therefore not be filtered.").endLine();
+    }
+    if (aln.size() != species_.size()) {
+      logEvent_(QUAL_NO_QUALITY, block);
+      //NB here we could decide to discard the block instead!
+      return block;
+    } else {
+      size_t nc = block->getNumberOfSites();
+      //First we create a mask:
+      vector<size_t> pos;
+      //Evaluate all windows at once:
+      if (displaysTasks_()) {
+        ApplicationTools::message->endLine();
+        ApplicationTools::displayTask("Sliding window for quality filter", true);
+      }
+      //A block smaller than the window is evaluated as a single window:
+      size_t windowSize = min(static_cast<size_t>(windowSize_), nc);
+      vector<size_t> ends = SlidingWindowTools::getWindowEnds(nc, windowSize, step_);
+      vector<double> means;
+      computeWindowMeanQualities(aln, windowSize, ends, means);
+      for (size_t w = 0; w < ends.size(); ++w) {
+        //NaN values (no score in window) are never lower than the threshold:
+        if (means[w] < minQual_) {
+          //Note: in the last window, contiguous regions are not merged.
+          SlidingWindowTools::addRegion(pos, ends[w] - windowSize, ends[w], w + 1 == ends.size());
         }
-        //NB here we could decide to discard the block instead!
+      }
+      size_t i;
+      if (displaysTasks_())
+        ApplicationTools::displayTaskDone();
+  
+      //Now we remove regions with two many gaps, using a sliding window:
+      if (pos.size() == 0) {
+        logEvent_(QUAL_KEPT, block);
+        return block;
+      } else if (pos.size() == 2 && pos.front() == 0 && pos.back() == block->getNumberOfSites()) {
+        //Everything is removed:
+        logEvent_(QUAL_REMOVED, block);
+        recycle(block);
       } else {
-        size_t nr = aln.size();
-        size_t nc = block->getNumberOfSites();
-        //First we create a mask:
-        vector<size_t> pos;
-        vector<int> col(nr);
-        //Reset window:
-        window_.clear();
-        //Init window:
-        size_t i;
-        for (i = 0; i < windowSize_; ++i) {
-          for (size_t j = 0; j < nr; ++j) {
-            col[j] = aln[j][i];
-          }
-          window_.push_back(col);
-        }
-        //Slide window:
-        if (verbose_) {
+        //Pieces share the input block, which is recycled when the last one is released:
+        std::shared_ptr<const MafBlock> parent = MafBlockView::share(block, iterator_);
+        logEvent_(QUAL_SPLIT, block, {block->getNumberOfSites(), pos.size() / 2 + 1});
+        if (displaysTasks_()) {
           ApplicationTools::message->endLine();
-          ApplicationTools::displayTask("Sliding window for quality filter", true);
+          ApplicationTools::displayTask("Spliting block", true);
         }
-        while (i + step_ < nc) {
-          if (verbose_)
-            ApplicationTools::displayGauge(i - windowSize_, nc - windowSize_ - 1, '>');
-          //Evaluate current window:
-          double mean = 0;
-          double n = static_cast<double>(aln.size() * windowSize_);
-          for (size_t u = 0; u < window_.size(); ++u)
-            for (size_t v = 0; v < window_[u].size(); ++v) {
-              mean += (window_[u][v] > 0 ? static_cast<double>(window_[u][v]) : 0.);
-              if (window_[u][v] == -1) n--;
-            }
-          if (n > 0 && (mean / n) < minQual_) {
-            if (pos.size() == 0) {
-              pos.push_back(i - windowSize_);
-              pos.push_back(i);
-            } else {
-              if (i - windowSize_ <= pos[pos.size() - 1]) {
-                pos[pos.size() - 1] = i; //Windows are overlapping and we extend previous region
-              } else { //This is a new region
-                pos.push_back(i - windowSize_);
-                pos.push_back(i);
-              }
-            }
-          }
-      
-          //Move forward:
-          for (size_t k = 0; k < step_; ++k) {
-            for (size_t j = 0; j < nr; ++j) {
-              col[j] = aln[j][i];
-            }  
-            window_.push_back(col);
-            window_.pop_front();
-            ++i;
+        for (i = 0; i < pos.size(); i+=2) {
+          if (displaysTasks_())
+            displayGauge_(i, pos.size() - 2, '=');
+          logEvent_(QUAL_REGION_REMOVED, block, {pos[i], pos[i+1]});
+          if (pos[i] > 0) {
+            if (i == 0)
+              viewBuffer_.push_back(MafBlockView(parent, 0, pos[i]));
+            else
+              viewBuffer_.push_back(MafBlockView(parent, pos[i - 1], pos[i] - pos[i - 1]));
           }
+         
+          if (keepTrashedBlocks_)
+            trashBuffer_.push_back(MafBlockView(parent, pos[i], pos[i + 1] - pos[i]).materialize());
         }
-
-        //Evaluate last window:
-        double mean = 0;
-        double n = static_cast<double>(aln.size() * windowSize_);
-        for (size_t u = 0; u < window_.size(); ++u)
-          for (size_t v = 0; v < window_[u].size(); ++v) {
-            mean += (window_[u][v] > 0 ? static_cast<double>(window_[u][v]) : 0.);
-            if (window_[u][v] == -1) n--;
-          }
-        if (n > 0 && (mean / n) < minQual_) {
-          if (pos.size() == 0) {
-            pos.push_back(i - windowSize_);
-            pos.push_back(i);
-          } else {
-            if (i - windowSize_ < pos[pos.size() - 1]) {
-              pos[pos.size() - 1] = i; //Windows are overlapping and we extend previous region
-            } else { //This is a new region
-              pos.push_back(i - windowSize_);
-              pos.push_back(i);
-            }
-          }
-        }
-        if (verbose_)
+        //Add last block:
+        if (pos.back() < block->getNumberOfSites())
+          viewBuffer_.push_back(MafBlockView(parent, pos.back(), block->getNumberOfSites() - pos.back()));
+        if (displaysTasks_())
           ApplicationTools::displayTaskDone();
-    
-        //Now we remove regions with two many gaps, using a sliding window:
-        if (pos.size() == 0) {
-          blockBuffer_.push_back(block);
-          if (logstream_) {
-            (*logstream_ << "QUAL CLEANER: block is clean and kept as is.").endLine();
-          }
-        } else if (pos.size() == 2 && pos.front() == 0 && pos.back() == block->getNumberOfSites()) {
-          //Everything is removed:
-          if (logstream_) {
-            (*logstream_ << "QUAL CLEANER: block was entirely removed. Tried to get the next one.").endLine();
-          }
-        } else {
-          if (logstream_) {
-            (*logstream_ << "QUAL CLEANER: block with size "<< block->getNumberOfSites() << " will be split into " << (pos.size() / 2 + 1) << " blocks.").endLine();
-          }
-          if (verbose_) {
-            ApplicationTools::message->endLine();
-            ApplicationTools::displayTask("Spliting block", true);
-          }
-          for (i = 0; i < pos.size(); i+=2) {
-            if (verbose_)
-              ApplicationTools::displayGauge(i, pos.size() - 2, '=');
-            if (logstream_) {
-              (*logstream_ << "QUAL CLEANER: removing region (" << pos[i] << ", " << pos[i+1] << ") from block.").endLine();
-            }
-            if (pos[i] > 0) {
-              MafBlock* newBlock = new MafBlock();
-              newBlock->setScore(block->getScore());
-              newBlock->setPass(block->getPass());
-              for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-                MafSequence* subseq;
-                if (i == 0) {
-                  subseq = block->getSequence(j).subSequence(0, pos[i]);
-                } else {
-                  subseq = block->getSequence(j).subSequence(pos[i - 1], pos[i] - pos[i - 1]);
-                }
-                newBlock->addSequence(*subseq);
-                delete subseq;
-              }
-              blockBuffer_.push_back(newBlock);
-            }
-           
-            if (keepTrashedBlocks_) {
-              MafBlock* outBlock = new MafBlock();
-              outBlock->setScore(block->getScore());
-              outBlock->setPass(block->getPass());
-              for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-                MafSequence* outseq = block->getSequence(j).subSequence(pos[i], pos[i + 1] - pos[i]);
-                outBlock->addSequence(*outseq);
-                delete outseq;
-              } 
-              trashBuffer_.push_back(outBlock);
-            }
-          }
-          //Add last block:
-          if (pos[pos.size() - 1] < block->getNumberOfSites()) {
-            MafBlock* newBlock = new MafBlock();
-            newBlock->setScore(block->getScore());
-            newBlock->setPass(block->getPass());
-            for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-              MafSequence* subseq;
-              subseq = block->getSequence(j).subSequence(pos[pos.size() - 1], block->getNumberOfSites() - pos[pos.size() - 1]);
-              newBlock->addSequence(*subseq);
-              delete subseq;
-            }
-            blockBuffer_.push_back(newBlock);
-          }
-          if (verbose_)
-            ApplicationTools::displayTaskDone();
-
-          delete block;
-        }
       }
-    } while (blockBuffer_.size() == 0);
-  }
-
-  MafBlock* block = blockBuffer_.front();
-  blockBuffer_.pop_front();
-  return block;
+    }
+  } while (viewBuffer_.size() == 0);
+  return 0;
 }
 
+
+void QualityFilterMafIterator::computeWindowMeanQualities(
+    const std::vector<const std::vector<int>*>& scores,
+    size_t windowSize,
+    const std::vector<size_t>& ends,
+    std::vector<double>& means)
+{
+  size_t nc = scores.size() > 0 ? scores[0]->size() : 0;
+  //Column sums, computed row by row to stream memory:
+  vector<long long> colSums(nc, 0);
+  vector<long long> colMissing(nc, 0);
+  for (size_t j = 0; j < scores.size(); ++j) {
+    const int* row = scores[j]->data();
+    for (size_t c = 0; c < nc; ++c) {
+      int q = row[c];
+      colSums[c] += (q > 0 ? q : 0);
+      colMissing[c] += (q == -1 ? 1 : 0);
+    }
+  }
+  PrefixSums<long long> sums(colSums);
+  PrefixSums<long long> missing(colMissing);
+  means.resize(ends.size());
+  double total = static_cast<double>(scores.size() * windowSize);
+  for (size_t w = 0; w < ends.size(); ++w) {
+    size_t begin = ends[w] - windowSize;
+    double n = total - static_cast<double>(missing.sum(begin, ends[w]));
+    means[w] = n > 0 ? static_cast<double>(sums.sum(begin, ends[w])) / n : NumConstants::NaN();
+  }
+}
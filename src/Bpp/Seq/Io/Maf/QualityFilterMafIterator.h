@@ -53,10 +53,10 @@ namespace bpp {
  * @brief Filter maf blocks to remove regions with low quality.
  *
  * Regions with a too low average quality in a set of species will be removed,
- * and blocks adjusted accordingly. 
+ * and blocks adjusted accordingly. Blocks smaller than the window are evaluated as a single window.
  */
 class QualityFilterMafIterator:
-  public AbstractFilterMafIterator,
+  public AbstractSplitMafIterator,
   public MafTrashIterator
 {
   private:
@@ -64,21 +64,17 @@ class QualityFilterMafIterator:
     unsigned int windowSize_;
     unsigned int step_;
     unsigned int minQual_;
-    std::deque<MafBlock*> blockBuffer_;
     std::deque<MafBlock*> trashBuffer_;
-    std::deque< std::vector<int> > window_;
     bool keepTrashedBlocks_;
 
   public:
     QualityFilterMafIterator(MafIterator* iterator, const std::vector<std::string>& species, unsigned int windowSize, unsigned int step, unsigned int minQual, bool keepTrashedBlocks) :
-      AbstractFilterMafIterator(iterator),
+      AbstractSplitMafIterator(iterator),
       species_(species),
       windowSize_(windowSize),
       step_(step),
       minQual_(minQual),
-      blockBuffer_(),
       trashBuffer_(),
-      window_(species.size()),
       keepTrashedBlocks_(keepTrashedBlocks)
     {}
 
@@ -90,8 +86,31 @@ class QualityFilterMafIterator:
       return block;
     }
 
+    /**
+     * @brief Compute the mean quality of a series of windows, in a single pass.
+     *
+     * Negative scores count as 0, and missing scores (-1) are not counted.
+     * Per-column sums of scores and missing scores are computed first, so that each window mean is obtained in constant time.
+     *
+     * @param scores The quality scores for each sequence, all of the same size.
+     * @param windowSize The size of the windows.
+     * @param ends The end positions of the windows (exclusive), see SlidingWindowTools::getWindowEnds.
+     * @param means [out] The mean quality of each window, or NaN if a window has only missing scores.
+     */
+    static void computeWindowMeanQualities(
+        const std::vector<const std::vector<int>*>& scores,
+        size_t windowSize,
+        const std::vector<size_t>& ends,
+        std::vector<double>& means);
+
+  protected:
+    void getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const {
+      AbstractSplitMafIterator::getBufferContent_(nbBlocks, nbBytes);
+      addBufferContent_(trashBuffer_, nbBlocks, nbBytes);
+    }
+
   private:
-    MafBlock* analyseCurrentBlock_();
+    MafBlock* splitNextBlock_();
 };
 
 } // end of namespace bpp.
@@ -0,0 +1,89 @@
+//
+// File: RankSelectIndex.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "RankSelectIndex.h"
+
+#include <Bpp/Exceptions.h>
+#include <Bpp/Text/TextTools.h>
+
+using namespace bpp;
+using namespace std;
+
+void RankSelectIndex::init(std::vector<uint64_t>&& bits, size_t size)
+{
+  size_t nbWords = BitTools::getNumberOfWords(size);
+  if (bits.size() < nbWords)
+    throw Exception("RankSelectIndex::init. Bit vector is too short: " + TextTools::toString(bits.size()) + " words for " + TextTools::toString(size) + " positions.");
+  size_ = size;
+  bits_.swap(bits);
+  bits_.resize(nbWords);
+  //Make sure that positions after the end are not set:
+  if (size & 63)
+    bits_.back() &= (1ULL << (size & 63)) - 1;
+  ranks_.resize(nbWords + 1);
+  samples_.clear();
+  size_t r = 0;
+  for (size_t w = 0; w < nbWords; ++w) {
+    ranks_[w] = r;
+    size_t n = BitTools::popcount(bits_[w]);
+    //Store the word of all set bits with a rank multiple of SAMPLE_RATE:
+    while (samples_.size() * SAMPLE_RATE < r + n)
+      samples_.push_back(w);
+    r += n;
+  }
+  ranks_[nbWords] = r;
+}
+
+size_t RankSelectIndex::select(size_t k) const
+{
+  if (k >= getNumberOfOnes())
+    throw Exception("RankSelectIndex::select. Only " + TextTools::toString(getNumberOfOnes()) + " bits are set, cannot select bit " + TextTools::toString(k) + ".");
+  //The word is between two samples, we look for the last word with rank <= k:
+  size_t s = k / SAMPLE_RATE;
+  size_t lo = samples_[s];
+  size_t hi = (s + 1 < samples_.size() ? samples_[s + 1] : bits_.size() - 1);
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo + 1) / 2;
+    if (ranks_[mid] <= k)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  return lo * 64 + selectInWord(bits_[lo], k - ranks_[lo]);
+}
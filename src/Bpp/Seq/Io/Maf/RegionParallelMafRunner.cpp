@@ -0,0 +1,241 @@
+//
+// File: RegionParallelMafRunner.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "RegionParallelMafRunner.h"
+#include "MsmcOutputMafIterator.h"
+
+using namespace bpp;
+
+//From the STL:
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+using namespace std;
+
+struct RegionParallelMafRunner::Result_
+{
+  string text;
+  uint64_t nbBlocks;
+  bool hasMsmc;
+  string msmcChr;
+  unsigned int msmcCalledSites;
+  vector< unique_ptr<MergeableMafStatistics> > statistics;
+
+  Result_(): text(), nbBlocks(0), hasMsmc(false), msmcChr(), msmcCalledSites(0), statistics() {}
+};
+
+RegionParallelMafRunner::RegionParallelMafRunner(const string& path, MafIndex& index, PipelineFactory factory, unsigned int nbThreads):
+  path_(path), index_(&index), factory_(factory), nbThreads_(nbThreads),
+  parseMask_(false), checkSize_(true), dotOption_(MafParser::DOT_ERROR),
+  statistics_(), hasMsmc_(false), msmcChr_(), msmcCalledSites_(0)
+{
+  if (!factory)
+    throw Exception("RegionParallelMafRunner (constructor). A pipeline factory must be provided.");
+  if (nbThreads_ == 0)
+    nbThreads_ = max(thread::hardware_concurrency(), 1u);
+}
+
+/******************************************************************************/
+
+vector<MafRegion> RegionParallelMafRunner::makeRegions(MafIndex& index, size_t chunkSize, size_t minGap)
+{
+  vector<MafRegion> regions;
+  vector<string> chrs = index.getChromosomes();
+  for (size_t c = 0; c < chrs.size(); ++c) {
+    const vector<MafIndex::Entry>& entries = index.getEntries(chrs[c]);
+    if (entries.empty()) continue;
+    size_t regionStart = 0;
+    size_t maxStop = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+      if (chunkSize > 0 && i > 0 && entries[i].start >= regionStart + chunkSize
+          && entries[i].start >= maxStop && entries[i].start - maxStop >= minGap) {
+        regions.push_back(MafRegion(chrs[c], regionStart, entries[i].start));
+        regionStart = entries[i].start;
+      }
+      maxStop = max(maxStop, entries[i].stop);
+    }
+    regions.push_back(MafRegion(chrs[c], regionStart, max(maxStop, regionStart + 1)));
+  }
+  return regions;
+}
+
+/******************************************************************************/
+
+RegionParallelMafRunner::Result_* RegionParallelMafRunner::processRegion_(const MafRegion& region, const vector<uint64_t>& offsets)
+{
+  unique_ptr<Result_> result(new Result_());
+  MafParser* parser = new MafParser(new MappedFileLineReader(path_), parseMask_, checkSize_, dotOption_);
+  MafRegionPipeline pipeline(region, parser);
+  parser->setVerbose(false);
+  parser->selectBlocks(offsets);
+  MafIterator* last = factory_(pipeline);
+  if (!last)
+    throw NullPointerException("RegionParallelMafRunner::run. The pipeline factory returned a NULL pointer.");
+  last->setVerbose(false);
+  //The called sites counter of MSMC output is corrected at merge time:
+  MsmcOutputMafIterator* msmc = 0;
+  size_t nbMsmc = 0;
+  for (size_t i = 0; i < pipeline.getStages().size(); ++i) {
+    MsmcOutputMafIterator* stage = dynamic_cast<MsmcOutputMafIterator*>(pipeline.getStages()[i].get());
+    if (stage) {
+      nbMsmc++;
+      if (stage->getOutputStream() == &pipeline.getOutput())
+        msmc = stage;
+    }
+  }
+  while (MafBlock* block = last->nextBlock()) {
+    result->nbBlocks++;
+    last->recycle(block);
+  }
+  if (msmc && nbMsmc == 1) {
+    result->hasMsmc = true;
+    result->msmcChr = msmc->getCurrentChromosome();
+    result->msmcCalledSites = msmc->getNumberOfCalledSites();
+  }
+  //Flush all outputs:
+  pipeline.clear();
+  result->text = pipeline.getText();
+  result->statistics = std::move(pipeline.getStatistics());
+  return result.release();
+}
+
+/******************************************************************************/
+
+void RegionParallelMafRunner::correctMsmcCount(string& text, const string& chr, unsigned int carry)
+{
+  if (carry == 0 || text.compare(0, chr.size(), chr) != 0 || text.size() <= chr.size() || text[chr.size()] != '\t')
+    return;
+  size_t begin = text.find('\t', chr.size() + 1);
+  if (begin == string::npos) return;
+  begin++;
+  size_t end = text.find('\t', begin);
+  if (end == string::npos) return;
+  unsigned int count = TextTools::to<unsigned int>(text.substr(begin, end - begin));
+  text.replace(begin, end - begin, TextTools::toString(count + carry));
+}
+
+uint64_t RegionParallelMafRunner::run(const vector<MafRegion>& regions, ostream& output)
+{
+  //The index is not thread-safe, offsets are therefore computed first.
+  //Blocks are assigned to the region containing their start:
+  vector< vector<uint64_t> > offsets(regions.size());
+  for (size_t r = 0; r < regions.size(); ++r) {
+    const vector<MafIndex::Entry>& entries = index_->getEntries(regions[r].chr);
+    vector<MafIndex::Entry>::const_iterator it = lower_bound(entries.begin(), entries.end(), MafIndex::Entry(regions[r].start, 0, 0));
+    for (; it != entries.end() && it->start < regions[r].stop; ++it)
+      offsets[r].push_back(it->offset);
+    std::sort(offsets[r].begin(), offsets[r].end());
+  }
+
+  vector< unique_ptr<Result_> > results(regions.size());
+  size_t nextOutput = 0;
+  uint64_t nbBlocks = 0;
+  statistics_.clear();
+  hasMsmc_ = false;
+  string carryChr;
+  unsigned int carry = 0;
+  atomic<size_t> nextRegion(0);
+  atomic<bool> failed(false);
+  exception_ptr error;
+  mutex mtx;
+
+  auto worker = [&]() {
+    while (!failed.load()) {
+      size_t r = nextRegion.fetch_add(1);
+      if (r >= regions.size()) return;
+      try {
+        unique_ptr<Result_> result(processRegion_(regions[r], offsets[r]));
+        //Write all consecutive outputs available, in region order:
+        lock_guard<mutex> lock(mtx);
+        results[r] = std::move(result);
+        while (nextOutput < results.size() && results[nextOutput]) {
+          Result_& res = *results[nextOutput];
+          if (res.hasMsmc) {
+            hasMsmc_ = true;
+            if (!res.text.empty()) {
+              correctMsmcCount(res.text, carryChr, carry);
+              carryChr = res.msmcChr;
+              carry = res.msmcCalledSites;
+            } else if (!res.msmcChr.empty()) {
+              carry = (res.msmcChr == carryChr ? carry : 0) + res.msmcCalledSites;
+              carryChr = res.msmcChr;
+            }
+          }
+          output.write(res.text.data(), static_cast<streamsize>(res.text.size()));
+          nbBlocks += res.nbBlocks;
+          if (statistics_.empty()) {
+            statistics_ = std::move(res.statistics);
+          } else {
+            if (res.statistics.size() != statistics_.size())
+              throw Exception("RegionParallelMafRunner::run. All pipelines should have the same statistics.");
+            for (size_t i = 0; i < statistics_.size(); ++i)
+              statistics_[i]->merge(*res.statistics[i]);
+          }
+          results[nextOutput].reset();
+          nextOutput++;
+        }
+      } catch (...) {
+        lock_guard<mutex> lock(mtx);
+        if (!failed.load()) {
+          error = current_exception();
+          failed.store(true);
+        }
+        return;
+      }
+    }
+  };
+
+  vector<thread> threads;
+  size_t nbWorkers = min(static_cast<size_t>(nbThreads_), regions.size());
+  for (size_t i = 1; i < nbWorkers; ++i)
+    threads.push_back(thread(worker));
+  worker();
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+  if (error)
+    rethrow_exception(error);
+  msmcChr_ = carryChr;
+  msmcCalledSites_ = carry;
+  output.flush();
+  return nbBlocks;
+}
+
@@ -0,0 +1,295 @@
+//
+// File: RegionParallelMafRunner.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _REGIONPARALLELMAFRUNNER_H_
+#define _REGIONPARALLELMAFRUNNER_H_
+
+#include "MafIterator.h"
+#include "MafIndex.h"
+#include "MafParser.h"
+#include "MafStatistics.h"
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <memory>
+#include <sstream>
+#include <functional>
+#include <cstdint>
+
+namespace bpp {
+
+class MsmcOutputMafIterator;
+
+/**
+ * @brief A region of the reference species.
+ */
+struct MafRegion
+{
+  std::string chr;
+  size_t start; //0-based, included.
+  size_t stop;  //0-based, excluded.
+
+  MafRegion(const std::string& regionChr = "", size_t regionStart = 0, size_t regionStop = 0):
+    chr(regionChr), start(regionStart), stop(regionStop) {}
+};
+
+/**
+ * @brief The iterators processing one region, as built by a RegionParallelMafRunner factory.
+ *
+ * The pipeline reads from getInput(), a parser positioned on the blocks of the region,
+ * and writes its output to getOutput(). Stages created by the factory are given to the
+ * pipeline with add(), and destroyed once the region is processed, downstream first,
+ * so that output iterators are flushed. Statistics given with addStatistics() are kept
+ * after the stages are destroyed, and merged over all regions by the runner.
+ */
+class MafRegionPipeline
+{
+  private:
+    MafRegion region_;
+    std::ostringstream output_;
+    std::vector< std::unique_ptr<MergeableMafStatistics> > statistics_;
+    std::vector< std::unique_ptr<MafIterator> > stages_;
+
+  public:
+    MafRegionPipeline(const MafRegion& region, MafParser* parser):
+      region_(region), output_(), statistics_(), stages_()
+    {
+      stages_.push_back(std::unique_ptr<MafIterator>(parser));
+    }
+
+    ~MafRegionPipeline() { clear(); }
+
+  private:
+    //Recopy is forbidden!
+    MafRegionPipeline(const MafRegionPipeline& pipeline);
+    MafRegionPipeline& operator=(const MafRegionPipeline& pipeline);
+
+  public:
+    const MafRegion& getRegion() const { return region_; }
+
+    /**
+     * @return The parser reading the blocks of the region.
+     */
+    MafIterator* getInput() { return stages_.front().get(); }
+
+    /**
+     * @return The stream where the output of the region should be written.
+     */
+    std::ostream& getOutput() { return output_; }
+
+    /**
+     * @brief Give a stage to the pipeline, which then owns it.
+     *
+     * @return The stage.
+     */
+    template<class T>
+    T* add(T* stage) {
+      stages_.push_back(std::unique_ptr<MafIterator>(stage));
+      return stage;
+    }
+
+    const std::vector< std::unique_ptr<MafIterator> >& getStages() const { return stages_; }
+
+    /**
+     * @brief Give a statistic to the pipeline, which then owns it.
+     *
+     * The statistics accumulated in each region are merged by the runner, in the order they were added
+     * (see RegionParallelMafRunner::getStatistics()). All pipelines should therefore add the same statistics,
+     * in the same order.
+     * @return The statistic.
+     */
+    template<class T>
+    T* addStatistics(T* stats) {
+      statistics_.push_back(std::unique_ptr<MergeableMafStatistics>(stats));
+      return stats;
+    }
+
+    std::vector< std::unique_ptr<MergeableMafStatistics> >& getStatistics() { return statistics_; }
+
+    /**
+     * @return The output written so far.
+     */
+    std::string getText() const { return output_.str(); }
+
+    /**
+     * @brief Destroy all stages, starting from the last one.
+     */
+    void clear() {
+      while (!stages_.empty())
+        stages_.pop_back();
+    }
+};
+
+/**
+ * @brief Run a pipeline of iterators independently on several regions of an indexed MAF file, with several threads.
+ *
+ * For each region, a parser is opened on the file and restricted to the blocks of the region with the index,
+ * and a pipeline is built on top of it by a user factory. A block belongs to the region containing the start of its
+ * reference sequence, so that blocks overlapping several regions are processed once. Regions are processed in parallel,
+ * and their outputs are concatenated in the order of the region list.
+ *
+ * Stages keeping a state between blocks need care at region boundaries:
+ * - OrderFilterMafIterator and BlockMergerMafIterator compare each block with the previous one. Regions built with
+ *   makeRegions() are cut only between blocks that do not overlap and are distant by at least a minimum gap on the
+ *   reference, so that, when this gap is larger than the maximum merging distance (and the reference is one of the
+ *   merged species), these stages behave as in a sequential run. Chromosomes are always independent.
+ * - MsmcOutputMafIterator counts the called sites since the last SNP, which spans region boundaries. When the pipeline
+ *   contains one such iterator writing to the region output, the count of the first SNP of each region is corrected
+ *   with the called sites carried over from the previous regions of the same chromosome when outputs are merged.
+ *
+ * @code
+ * RegionParallelMafRunner runner("input.maf", index, [&](MafRegionPipeline& pipeline) {
+ *   MafIterator* it = pipeline.add(new BlockLengthMafIterator(pipeline.getInput(), 100));
+ *   return pipeline.add(new MsmcOutputMafIterator(it, &pipeline.getOutput(), species, "hg38"));
+ * }, 64);
+ * runner.run(RegionParallelMafRunner::makeRegions(index, 10000000), output);
+ * @endcode
+ */
+class RegionParallelMafRunner
+{
+  public:
+    /**
+     * @brief Build the pipeline of a region, and return its last iterator.
+     *
+     * The factory may be called concurrently from several threads. Stages should not log to a shared,
+     * non thread-safe stream.
+     */
+    typedef std::function<MafIterator* (MafRegionPipeline&)> PipelineFactory;
+
+  private:
+    struct Result_;
+
+  private:
+    std::string path_;
+    MafIndex* index_;
+    PipelineFactory factory_;
+    unsigned int nbThreads_;
+    bool parseMask_;
+    bool checkSize_;
+    short dotOption_;
+    std::vector< std::unique_ptr<MergeableMafStatistics> > statistics_;
+    bool hasMsmc_;
+    std::string msmcChr_;
+    unsigned int msmcCalledSites_;
+
+  public:
+    /**
+     * @param path The path to the MAF file, which must support random access.
+     * @param index The index of the file (not owned).
+     * @param factory The pipeline factory.
+     * @param nbThreads The number of threads (0 means one per available core).
+     */
+    RegionParallelMafRunner(const std::string& path, MafIndex& index, PipelineFactory factory, unsigned int nbThreads = 0);
+
+  private:
+    //Recopy is forbidden!
+    RegionParallelMafRunner(const RegionParallelMafRunner& runner);
+    RegionParallelMafRunner& operator=(const RegionParallelMafRunner& runner);
+
+  public:
+    /**
+     * @brief Set the options of the parsers (see MafParser).
+     */
+    void setParserOptions(bool parseMask, bool checkSize = true, short dotOption = MafParser::DOT_ERROR) {
+      parseMask_ = parseMask;
+      checkSize_ = checkSize;
+      dotOption_ = dotOption;
+    }
+
+    unsigned int getNumberOfThreads() const { return nbThreads_; }
+
+    /**
+     * @brief Process all regions.
+     *
+     * Errors in any region stop the processing, and are forwarded to the caller.
+     * @param regions The regions, in output order.
+     * @param output The stream where the outputs of all regions are concatenated.
+     * @return The total number of blocks returned by the last stage of all pipelines.
+     */
+    uint64_t run(const std::vector<MafRegion>& regions, std::ostream& output);
+
+    /**
+     * @return The statistics added to the pipelines, merged over all regions processed by the last call to run().
+     */
+    const std::vector< std::unique_ptr<MergeableMafStatistics> >& getStatistics() const { return statistics_; }
+
+    /**
+     * @return True if the pipelines of the last run contained a MsmcOutputMafIterator writing to the region output.
+     */
+    bool hasMsmcOutput() const { return hasMsmc_; }
+
+    /**
+     * @return The chromosome of the last called sites of the MSMC output, after the last run.
+     */
+    const std::string& getMsmcChromosome() const { return msmcChr_; }
+
+    /**
+     * @return The number of called sites after the last SNP of the MSMC output, after the last run.
+     * These sites are to be added to the first SNP following the processed regions, if on the same chromosome.
+     */
+    unsigned int getMsmcCalledSites() const { return msmcCalledSites_; }
+
+    /**
+     * @brief Add a number of called sites to the first SNP of a MSMC output, if it is on a given chromosome.
+     *
+     * @param text The MSMC output.
+     * @param chr The chromosome of the called sites.
+     * @param calledSites The number of sites to add.
+     */
+    static void correctMsmcCount(std::string& text, const std::string& chr, unsigned int calledSites);
+
+    /**
+     * @brief Split the indexed chromosomes into regions.
+     *
+     * Cuts are only placed before a block starting at least minGap positions after the end of all previous blocks.
+     * @param index The index.
+     * @param chunkSize The minimum size of a region. 0 means one region per chromosome.
+     * @param minGap The minimum distance between two blocks at a cut.
+     * @return Regions covering all indexed blocks, sorted by chromosome and position.
+     */
+    static std::vector<MafRegion> makeRegions(MafIndex& index, size_t chunkSize = 0, size_t minGap = 1);
+
+  private:
+    Result_* processRegion_(const MafRegion& region, const std::vector<uint64_t>& offsets);
+};
+
+} // end of namespace bpp.
+
+#endif //_REGIONPARALLELMAFRUNNER_H_
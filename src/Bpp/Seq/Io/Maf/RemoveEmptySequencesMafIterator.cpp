@@ -46,22 +46,20 @@ MafBlock* RemoveEmptySequencesMafIterator::analyseCurrentBlock_()
 {
   currentBlock_ = iterator_->nextBlock();
   if (currentBlock_) {
-    for (size_t i = currentBlock_->getNumberOfSequences(); i > 0; --i) {
-      const MafSequence& seq = currentBlock_->getSequence(i - 1);
-      bool isEmpty = true;
-      if (unresolvedAsGaps_) {
+    vector<bool> keep(currentBlock_->getNumberOfSequences(), true);
+    for (size_t i = 0; i < keep.size(); ++i) {
+      const MafSequence& seq = currentBlock_->getSequence(i);
+      //The genomic size is the number of non-gap characters:
+      bool isEmpty = seq.getGenomicSize() == 0;
+      if (!isEmpty && unresolvedAsGaps_) {
+        isEmpty = true;
         for (size_t j = 0; isEmpty && j < currentBlock_->getNumberOfSites(); ++j) {
           if (!AlphabetTools::DNA_ALPHABET.isUnresolved(seq[j]) && !AlphabetTools::DNA_ALPHABET.isGap(seq[j])) isEmpty = false;
         }
-      } else {
-        for (size_t j = 0; isEmpty && j < currentBlock_->getNumberOfSites(); ++j) {
-          if (!AlphabetTools::DNA_ALPHABET.isGap(seq[j])) isEmpty = false;
-        }
-      }
-      if (isEmpty) {
-        currentBlock_->getAlignment().deleteSequence(i - 1); 
       }
+      keep[i] = !isEmpty;
     }
+    currentBlock_->keepSequences(keep);
   }
   return currentBlock_;
 }
@@ -0,0 +1,197 @@
+//
+// File: SamplingMafIterator.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "SamplingMafIterator.h"
+#include "MafParser.h"
+#include "MafIndex.h"
+
+using namespace bpp;
+
+//From the STL:
+#include <string>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+const short SamplingMafIterator::BLOCKS = 0;
+const short SamplingMafIterator::SITES = 1;
+
+SamplingMafIterator::SamplingMafIterator(MafIterator* iterator, size_t sampleSize, short mode, uint64_t seed):
+  AbstractFilterMafIterator(iterator),
+  sampleSize_(sampleSize), mode_(mode), generator_(seed),
+  streaming_(true), sampled_(false), populationSize_(0),
+  reservoir_(), sample_(), nextItem_(0), weight_(1.)
+{
+  if (mode != BLOCKS && mode != SITES)
+    throw Exception("SamplingMafIterator. Unknown sampling mode: " + TextTools::toString(mode) + ".");
+}
+
+SamplingMafIterator::SamplingMafIterator(MafParser* parser, MafIndex& index, size_t sampleSize, uint64_t seed):
+  AbstractFilterMafIterator(parser),
+  sampleSize_(sampleSize), mode_(BLOCKS), generator_(seed),
+  streaming_(false), sampled_(true), populationSize_(0),
+  reservoir_(), sample_(), nextItem_(0), weight_(1.)
+{
+  if (!parser->isSeekable())
+    throw Exception("SamplingMafIterator. The input does not support random access.");
+  vector<uint64_t> offsets;
+  vector<string> chrs = index.getChromosomes();
+  for (size_t i = 0; i < chrs.size(); ++i) {
+    const vector<MafIndex::Entry>& entries = index.getEntries(chrs[i]);
+    for (size_t j = 0; j < entries.size(); ++j)
+      offsets.push_back(entries[j].offset);
+  }
+  sort(offsets.begin(), offsets.end());
+  populationSize_ = offsets.size();
+  //Partial Fisher-Yates shuffle, then blocks are read in file order:
+  size_t n = min(sampleSize, offsets.size());
+  for (size_t i = 0; i < n; ++i) {
+    size_t j = i + static_cast<size_t>(uniform_() * static_cast<double>(offsets.size() - i));
+    swap(offsets[i], offsets[j]);
+  }
+  offsets.resize(n);
+  sort(offsets.begin(), offsets.end());
+  parser->selectBlocks(offsets);
+}
+
+SamplingMafIterator::~SamplingMafIterator()
+{
+  for (size_t i = 0; i < reservoir_.size(); ++i)
+    delete reservoir_[i].second;
+  for (size_t i = 0; i < sample_.size(); ++i)
+    delete sample_[i];
+}
+
+/******************************************************************************/
+
+MafBlock* SamplingMafIterator::analyseCurrentBlock_()
+{
+  if (!streaming_)
+    return iterator_->nextBlock();
+  if (!sampled_)
+    drawSample_();
+  if (sample_.empty())
+    return 0;
+  MafBlock* block = sample_.front();
+  sample_.pop_front();
+  return block;
+}
+
+void SamplingMafIterator::drawSample_()
+{
+  size_t nbItems = 0;
+  MafBlock* block;
+  while ((block = iterator_->nextBlock())) {
+    size_t n = (mode_ == BLOCKS ? 1 : block->getNumberOfSites());
+    if (!addItems_(block, nbItems, n))
+      recycle(block);
+    nbItems += n;
+  }
+  populationSize_ = nbItems;
+  sampled_ = true;
+  //Sampled items are returned in input order:
+  sort(reservoir_.begin(), reservoir_.end());
+  for (size_t i = 0; i < reservoir_.size(); ++i)
+    sample_.push_back(reservoir_[i].second);
+  reservoir_.clear();
+  if (logstream_) {
+    (*logstream_ << "SAMPLING: " << sample_.size() << " " << (mode_ == BLOCKS ? "blocks" : "sites") << " sampled out of " << populationSize_ << ".").endLine();
+  }
+}
+
+bool SamplingMafIterator::addItems_(MafBlock* block, size_t begin, size_t n)
+{
+  if (sampleSize_ == 0)
+    return false;
+  bool used = false;
+  while (nextItem_ < begin + n) {
+    MafBlock* item;
+    if (mode_ == BLOCKS) {
+      item = block;
+      used = true;
+    } else {
+      item = getColumn_(*block, nextItem_ - begin);
+    }
+    if (reservoir_.size() < sampleSize_) {
+      reservoir_.push_back(make_pair(nextItem_, item));
+    } else {
+      //Replace a random item of the reservoir:
+      size_t slot = static_cast<size_t>(uniform_() * static_cast<double>(sampleSize_));
+      recycle(reservoir_[slot].second);
+      reservoir_[slot] = make_pair(nextItem_, item);
+    }
+    skip_();
+  }
+  return used;
+}
+
+void SamplingMafIterator::skip_()
+{
+  if (nextItem_ + 1 < sampleSize_) {
+    //The reservoir is not full yet:
+    nextItem_++;
+    return;
+  }
+  double k = static_cast<double>(sampleSize_);
+  if (nextItem_ + 1 == sampleSize_)
+    weight_ = exp(log(uniform_()) / k);
+  else
+    weight_ *= exp(log(uniform_()) / k);
+  double skip = floor(log(uniform_()) / log1p(-weight_));
+  //Very long skips mean that no other item will be sampled:
+  if (skip >= 1e18) {
+    nextItem_ = static_cast<size_t>(-1);
+    return;
+  }
+  nextItem_ += static_cast<size_t>(skip) + 1;
+}
+
+MafBlock* SamplingMafIterator::getColumn_(const MafBlock& block, size_t site)
+{
+  MafBlock* column = new MafBlock();
+  column->setScore(block.getScore());
+  column->setPass(block.getPass());
+  for (size_t i = 0; i < block.getNumberOfSequences(); ++i) {
+    unique_ptr<MafSequence> sequence(block.getSequence(i).subSequence(site, 1));
+    column->addSequence(std::move(sequence));
+  }
+  return column;
+}
+
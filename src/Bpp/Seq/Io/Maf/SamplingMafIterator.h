@@ -0,0 +1,177 @@
+//
+// File: SamplingMafIterator.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _SAMPLINGMAFITERATOR_H_
+#define _SAMPLINGMAFITERATOR_H_
+
+#include "MafIterator.h"
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <deque>
+#include <random>
+#include <cstdint>
+
+namespace bpp {
+
+class MafParser;
+class MafIndex;
+
+/**
+ * @brief Take a reproducible random subsample of the blocks, or of the sites, of the input.
+ *
+ * In streaming mode, the sample is drawn uniformly, without replacement, by reservoir sampling (algorithm L),
+ * so that only the sampled items are kept in memory. The whole input is therefore read when the first block is requested,
+ * and sampled items are then returned in input order:
+ * - In BLOCKS mode, sampled blocks are returned unchanged.
+ * - In SITES mode, each sampled site is returned as a block of size one, made of the corresponding column of its block.
+ * Blocks which are not sampled are recycled as soon as they are read.
+ *
+ * When the input is a seekable MafParser and an index of the file is available, blocks can instead be sampled from the index,
+ * and the parser only reads the sampled blocks (see MafParser::selectBlocks). As the index only stores blocks
+ * containing its reference species, other blocks cannot be sampled in this mode. Sites cannot be sampled from an index,
+ * which does not store the number of columns of each block.
+ *
+ * The random generator is a std::mt19937_64, and all draws are derived from its output only,
+ * so that a given seed always produces the same sample.
+ * Statistics computed on the sample can be summarized with a SampleSummaryIterationListener.
+ */
+class SamplingMafIterator:
+  public AbstractFilterMafIterator
+{
+  public:
+    static const short BLOCKS;
+    static const short SITES;
+
+  private:
+    size_t sampleSize_;
+    short mode_;
+    std::mt19937_64 generator_;
+    bool streaming_;
+    bool sampled_;
+    size_t populationSize_;
+    //The reservoir, as (item index, block) pairs:
+    std::vector< std::pair<size_t, MafBlock*> > reservoir_;
+    std::deque<MafBlock*> sample_;
+    size_t nextItem_;
+    double weight_;
+
+  public:
+    /**
+     * @brief Sample blocks or sites from a stream of blocks.
+     *
+     * @param iterator The input iterator.
+     * @param sampleSize The number of blocks or sites to sample. All items are returned if the input has fewer.
+     * @param mode BLOCKS or SITES.
+     * @param seed The seed of the random generator.
+     * @throw Exception if the mode is not supported.
+     */
+    SamplingMafIterator(MafIterator* iterator, size_t sampleSize, short mode = BLOCKS, uint64_t seed = 0);
+
+    /**
+     * @brief Sample blocks using an index, and only parse the sampled ones.
+     *
+     * @param parser The input parser, which must support random access.
+     * @param index The index of the input file.
+     * @param sampleSize The number of blocks to sample. All blocks are returned if the index has fewer.
+     * @param seed The seed of the random generator.
+     * @throw Exception if the parser does not support random access.
+     */
+    SamplingMafIterator(MafParser* parser, MafIndex& index, size_t sampleSize, uint64_t seed = 0);
+
+    virtual ~SamplingMafIterator();
+
+  private:
+    SamplingMafIterator(const SamplingMafIterator& iterator);
+    SamplingMafIterator& operator=(const SamplingMafIterator& iterator);
+
+  public:
+    short getMode() const { return mode_; }
+
+    size_t getSampleSize() const { return sampleSize_; }
+
+    /**
+     * @return The number of blocks or sites the sample was drawn from. In streaming mode, it is only known
+     * once the first block was requested.
+     */
+    size_t getPopulationSize() const { return populationSize_; }
+
+    /**
+     * @return True if the population size is known.
+     */
+    bool hasPopulationSize() const { return sampled_; }
+
+  protected:
+    void getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const {
+      addBufferContent_(sample_, nbBlocks, nbBytes);
+    }
+
+  private:
+    MafBlock* analyseCurrentBlock_();
+
+    /**
+     * @brief Read the whole input, and fill the reservoir.
+     */
+    void drawSample_();
+
+    /**
+     * @brief Add the items [begin, begin + n[ of the input to the reservoir.
+     *
+     * @param block The block containing the items.
+     * @param begin The index of the first item of the block.
+     * @param n The number of items in the block (1 for blocks, the number of sites otherwise).
+     * @return True if the block was used in the reservoir, and should not be recycled.
+     */
+    bool addItems_(MafBlock* block, size_t begin, size_t n);
+
+    //Move to the next item to be sampled, using the skip lengths of algorithm L:
+    void skip_();
+
+    //A uniform number in ]0, 1[, computed from the 53 upper bits of the generator output:
+    double uniform_() {
+      return (static_cast<double>(generator_() >> 11) + 0.5) / 9007199254740992.;
+    }
+
+    static MafBlock* getColumn_(const MafBlock& block, size_t site);
+};
+
+} // end of namespace bpp.
+
+#endif //_SAMPLINGMAFITERATOR_H_
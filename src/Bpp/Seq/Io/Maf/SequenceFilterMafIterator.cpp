@@ -47,56 +47,59 @@ using namespace bpp;
 
 using namespace std;
 
+//Events reported by this filter:
+static const MafEventType SEQUENCE_REMOVED("SEQUENCE FILTER", "sequence_removed", MafEventType::LEVEL_DEBUG,
+    "SEQUENCE FILTER: remove sequence '%s' from current block %d.");
+static const MafEventType SEQUENCE_EMPTY("SEQUENCE FILTER", "empty", MafEventType::LEVEL_INFO,
+    "SEQUENCE FILTER: block %d is now empty. Try to get the next one.");
+static const MafEventType SEQUENCE_INCOMPLETE("SEQUENCE FILTER", "incomplete", MafEventType::LEVEL_INFO,
+    "SEQUENCE FILTER: block %d does not contain all species and will be ignored. Try to get the next one.");
+static const MafEventType SEQUENCE_DUPLICATE("SEQUENCE FILTER", "duplicate", MafEventType::LEVEL_INFO,
+    "SEQUENCE FILTER: block %d has two sequences for species '%s' and will be ignored. Try to get the next one.");
+
+bool SequenceFilterMafIterator::filterBlock_(MafBlock& block)
+{
+  size_t nbSequences = block.getNumberOfSequences();
+  vector<bool> keep(nbSequences, true);
+  for (size_t i = 0; i < nbSequences; ++i) {
+    const MafSequence& sequence = block.getSequence(i);
+    if (!MafNameDictionary::isInBitset(speciesBits_, sequence.getSpeciesId())) {
+      logEvent_(SEQUENCE_REMOVED, &block, {}, &sequence.getSpecies());
+      keep[i] = false;
+    }
+  }
+  //Selected species are counted with the species index of the block:
+  size_t nbFound = 0;
+  const string* duplicate = 0;
+  for (size_t i = 0; i < speciesIds_.size(); ++i) {
+    size_t n = block.getNumberOfSequencesForSpecies(speciesIds_[i]);
+    if (n > 0) nbFound++;
+    if (n > 1 && !duplicate) duplicate = &species_[i];
+  }
+  if (!keep_)
+    block.keepSequences(keep);
+  if (block.getNumberOfSequences() == 0) {
+    logEvent_(SEQUENCE_EMPTY, &block);
+    return false;
+  }
+  if (strict_ && nbFound != species_.size()) {
+    logEvent_(SEQUENCE_INCOMPLETE, &block);
+    return false;
+  }
+  if (rmDuplicates_ && duplicate) {
+    logEvent_(SEQUENCE_DUPLICATE, &block, {}, duplicate);
+    return false;
+  }
+  return true;
+}
+
 MafBlock* SequenceFilterMafIterator::analyseCurrentBlock_()
 {
   currentBlock_ = iterator_->nextBlock();
   while (currentBlock_) {
-    map<string, unsigned int> counts;
-    for (size_t i = currentBlock_->getNumberOfSequences(); i > 0; --i) {
-      string species = currentBlock_->getSequence(i-1).getSpecies(); 
-      if (!VectorTools::contains(species_, species)) {
-        if (logstream_) {
-          (*logstream_ << "SEQUENCE FILTER: remove sequence '" << species << "' from current block " << currentBlock_->getDescription() << ".").endLine();
-        }
-        if (!keep_) {
-          currentBlock_->getAlignment().deleteSequence(i - 1);
-        }
-      } else {
-        counts[species]++;
-      }
-    }
-    bool test = currentBlock_->getNumberOfSequences() == 0;
-    //Avoid a memory leak:
-    if (test) {
-      if (logstream_) {
-        (*logstream_ << "SEQUENCE FILTER: block " << currentBlock_->getDescription() << " is now empty. Try to get the next one.").endLine();
-      }
-      delete currentBlock_;
-    } else {
-      test = strict_ && (counts.size() != species_.size());
-      if (test) {
-        if (logstream_) {
-          (*logstream_ << "SEQUENCE FILTER: block " << currentBlock_->getDescription() << " does not contain all species and will be ignored. Try to get the next one.").endLine();
-        }
-        delete currentBlock_;
-      } else {
-        if (rmDuplicates_) {
-          test = false;
-          map<string, unsigned int>::iterator it;
-          for (it = counts.begin(); it != counts.end() && !(test = it->second > 1); it++) {}
-          if (test) {
-            if (logstream_) {
-              (*logstream_ << "SEQUENCE FILTER: block " << currentBlock_->getDescription() << " has two sequences for species '" << it->first << "' and will be ignored. Try to get the next one.").endLine();
-            }
-            delete currentBlock_;
-          } else {
-            return currentBlock_;
-          }
-        } else {
-          return currentBlock_;
-        }
-      }
-    }
+    if (filterBlock_(*currentBlock_))
+      return currentBlock_;
+    recycle(currentBlock_);
 
     //Look for the next block:
     currentBlock_ = iterator_->nextBlock();
@@ -58,12 +58,16 @@ namespace bpp {
  * - strict=no, keep=no: extract the species from the list, at least the one which are there.
  * - strict=yes, keep=yes: filter blocks to retain only the ones that contain at least all species from the list.
  * Blocks that are empty after the filtering are removed.
+ *
+ * Species are tested by ID against a bit array built once, and unselected sequences are removed in a single pass (see MafBlock::keepSequences).
  */
 class SequenceFilterMafIterator:
   public AbstractFilterMafIterator
 {
   private:
     std::vector<std::string> species_;
+    std::vector<uint64_t> speciesBits_;
+    std::vector<size_t> speciesIds_;
     bool strict_;
     bool keep_;
     bool rmDuplicates_;
@@ -79,15 +83,22 @@ class SequenceFilterMafIterator:
     SequenceFilterMafIterator(MafIterator* iterator, const std::vector<std::string>& species, bool strict = false, bool keep = false, bool rmDuplicates = false) :
       AbstractFilterMafIterator(iterator),
       species_(species),
+      speciesBits_(MafNameDictionary::species().getBitset(species)),
+      speciesIds_(),
       strict_(strict),
       keep_(keep),
       rmDuplicates_(rmDuplicates)
-    {}
+    {
+      for (size_t i = 0; i < species.size(); ++i)
+        speciesIds_.push_back(MafNameDictionary::species().intern(species[i]));
+    }
 
   private:
     SequenceFilterMafIterator(const SequenceFilterMafIterator& iterator) :
       AbstractFilterMafIterator(0),
       species_(iterator.species_),
+      speciesBits_(iterator.speciesBits_),
+      speciesIds_(iterator.speciesIds_),
       strict_(iterator.strict_),
       keep_(iterator.keep_),
       rmDuplicates_(iterator.rmDuplicates_)
@@ -96,15 +107,36 @@ class SequenceFilterMafIterator:
     SequenceFilterMafIterator& operator=(const SequenceFilterMafIterator& iterator)
     {
       species_       = iterator.species_;
+      speciesBits_   = iterator.speciesBits_;
+      speciesIds_    = iterator.speciesIds_;
       strict_        = iterator.strict_;
       keep_          = iterator.keep_;
       rmDuplicates_  = iterator.rmDuplicates_;
       return *this;
     }
 
+  public:
+    /**
+     * @brief Filter a block which is not pulled from the input iterator, as a stage of a StaticMafPipeline.
+     *
+     * @return False if the block should be discarded.
+     */
+    bool processBlock(MafBlock& block) { return filterBlock_(block); }
+
   private:
     MafBlock* analyseCurrentBlock_();
 
+    size_t analyseCurrentBlocks_(std::vector<MafBlock*>& blocks, size_t maxNbBlocks) {
+      return filterBlocks_(blocks, maxNbBlocks, [this](MafBlock& block) { return filterBlock_(block); });
+    }
+
+    /**
+     * @brief Remove unselected sequences from a block.
+     *
+     * @return False if the block should be discarded.
+     */
+    bool filterBlock_(MafBlock& block);
+
 };
 
 } // end of namespace bpp.
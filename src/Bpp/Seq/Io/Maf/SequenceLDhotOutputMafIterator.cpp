@@ -49,6 +49,7 @@ using namespace bpp;
 //From the STL:
 #include <string>
 #include <numeric>
+#include <sstream>
 
 using namespace std;
 
@@ -70,8 +71,15 @@ MafBlock* SequenceLDhotOutputMafIterator::analyseCurrentBlock_()
     TextTools::replaceAll(file, "%c", chr);
     TextTools::replaceAll(file, "%b", start);
     TextTools::replaceAll(file, "%e", stop);
-    std::ofstream output(file.c_str(), ios::out);
-    writeBlock(output, *block);
+    if (fileWriter_) {
+      ostringstream output;
+      writeBlock(output, *block);
+      string content = output.str();
+      fileWriter_->write(file, content);
+    } else {
+      std::ofstream output(file.c_str(), ios::out);
+      writeBlock(output, *block);
+    }
   }
   return block;
 }
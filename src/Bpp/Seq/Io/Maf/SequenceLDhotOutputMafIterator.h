@@ -41,6 +41,7 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _SEQUENCELDHOTOUTPUTMAFITERATOR_H_
 
 #include "MafIterator.h"
+#include "../AsyncFileWriter.h"
 
 //From bpp-seq:
 #include <Bpp/Seq/Io/OSequence.h>
@@ -49,6 +50,7 @@ knowledge of the CeCILL license and that you accept its terms.
 #include <iostream>
 #include <string>
 #include <deque>
+#include <memory>
 
 namespace bpp {
 
@@ -61,6 +63,7 @@ class SequenceLDhotOutputMafIterator:
   private:
     std::string file_;
     std::string refSpecies_;
+    std::shared_ptr<AsyncFileWriter> fileWriter_;
     unsigned int currentBlockIndex_;
     bool completeOnly_;
 
@@ -84,6 +87,7 @@ class SequenceLDhotOutputMafIterator:
       AbstractFilterMafIterator(iterator),
       file_(file),
       refSpecies_(reference),
+      fileWriter_(),
       currentBlockIndex_(0),
       completeOnly_(completeOnly)
     {
@@ -96,6 +100,7 @@ class SequenceLDhotOutputMafIterator:
       AbstractFilterMafIterator(0),
       file_(iterator.file_),
       refSpecies_(iterator.refSpecies_),
+      fileWriter_(iterator.fileWriter_),
       currentBlockIndex_(iterator.currentBlockIndex_),
       completeOnly_(iterator.completeOnly_)
     {}
@@ -104,12 +109,25 @@ class SequenceLDhotOutputMafIterator:
     {
       file_ = iterator.file_;
       refSpecies_ = iterator.refSpecies_;
+      fileWriter_ = iterator.fileWriter_;
       currentBlockIndex_ = iterator.currentBlockIndex_;
       completeOnly_ = iterator.completeOnly_;
       return *this;
     }
 
 
+  public:
+    /**
+     * @brief Hand the files over to an asynchronous writer, instead of writing them on the calling thread.
+     *
+     * Each block is formatted in memory, and the resulting file is queued in the writer, which may create one file
+     * per block or pack all blocks into a single archive. The writer can be shared with other iterators. Files are
+     * only guaranteed to be complete once the writer has been closed.
+     *
+     * @param writer The writer to use, or a null pointer to write files synchronously.
+     */
+    void setFileWriter(std::shared_ptr<AsyncFileWriter> writer) { fileWriter_ = writer; }
+
   private:
     MafBlock* analyseCurrentBlock_();
 
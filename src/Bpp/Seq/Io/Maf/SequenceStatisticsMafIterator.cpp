@@ -44,6 +44,8 @@ using namespace bpp;
 //From the STL:
 #include <string>
 #include <numeric>
+#include <limits>
+#include <map>
 
 using namespace std;
 
@@ -51,10 +53,28 @@ SequenceStatisticsMafIterator::SequenceStatisticsMafIterator(MafIterator* iterat
   AbstractFilterMafIterator(iterator),
   statistics_(statistics),
   results_(),
-  names_()
+  names_(),
+  slots_(),
+  slotTags_(),
+  sweeps_(),
+  others_()
 {
   string name;
+  map<string, size_t> sweepIndex;
   for (size_t i = 0; i < statistics_.size(); ++i) {
+    ColumnSweepMafStatistics* sweep = dynamic_cast<ColumnSweepMafStatistics*>(statistics_[i]);
+    if (sweep) {
+      map<string, size_t>::iterator it = sweepIndex.find(sweep->getSelectionKey());
+      if (it == sweepIndex.end()) {
+        sweepIndex[sweep->getSelectionKey()] = sweeps_.size();
+        sweeps_.push_back(vector<ColumnSweepMafStatistics*>(1, sweep));
+      } else {
+        sweeps_[it->second].push_back(sweep);
+      }
+    } else {
+      others_.push_back(statistics_[i]);
+    }
+
     name = statistics_[i]->getShortName();
     vector<string> tags = statistics_[i]->getSupportedTags();
     if (tags.size() > 1) {
@@ -64,28 +84,47 @@ SequenceStatisticsMafIterator::SequenceStatisticsMafIterator(MafIterator* iterat
     } else {
       names_.push_back(name);
     }
+    //Slots are only created when a value is first set, and are otherwise resolved after the first computation:
+    const MafStatisticsResult& result = statistics_[i]->getResult();
+    for (size_t j = 0; j < tags.size(); ++j) {
+      slots_.push_back(make_pair(i, result.hasSlot(tags[j]) ? result.getSlot(tags[j]) : numeric_limits<size_t>::max()));
+      slotTags_.push_back(tags[j]);
+    }
   }
-  results_.resize(names_.size());
+  results_ = MafStatisticsResult(names_);
 }
 
 MafBlock* SequenceStatisticsMafIterator::analyseCurrentBlock_()
 {
-  vector<string> tags;
   currentBlock_ = iterator_->nextBlock();
   if (currentBlock_) {
-    size_t k = 0;
-    for (size_t i = 0; i < statistics_.size(); ++i) {
-      statistics_[i]->compute(*currentBlock_);
-      const MafStatisticsResult& result = statistics_[i]->getResult();
-      tags = statistics_[i]->getSupportedTags();
-      for (size_t j = 0; j < tags.size(); ++j) {
-        if (result.hasValue(tags[j])) {
-          results_[k] = result.getValue(tags[j]).clone();
-        } else {
-          results_[k] = 0;
+    //One sweep over the columns for each selection of sequences:
+    for (size_t g = 0; g < sweeps_.size(); ++g) {
+      const vector<ColumnSweepMafStatistics*>& group = sweeps_[g];
+      const ColumnCounts& counts = group[0]->getColumnCounts(*currentBlock_);
+      for (size_t j = 0; j < group.size(); ++j)
+        group[j]->beginSweep(*currentBlock_, counts);
+      for (size_t c = 0; c < counts.getNumberOfSites(); ++c) {
+        for (size_t j = 0; j < group.size(); ++j)
+          group[j]->processColumn(counts, c);
+      }
+      for (size_t j = 0; j < group.size(); ++j)
+        group[j]->endSweep();
+    }
+    for (size_t i = 0; i < others_.size(); ++i)
+      others_[i]->compute(*currentBlock_);
+
+    for (size_t k = 0; k < slots_.size(); ++k) {
+      const MafStatisticsResult& result = statistics_[slots_[k].first]->getResult();
+      if (slots_[k].second == numeric_limits<size_t>::max()) {
+        if (!result.hasSlot(slotTags_[k])) {
+          results_.setValue(k, 0, MafStatisticsResult::NO_VALUE);
+          continue;
         }
-        k++;
+        slots_[k].second = result.getSlot(slotTags_[k]);
       }
+      size_t slot = slots_[k].second;
+      results_.setValue(k, result.getValue(slot), result.getValueType(slot));
     }
   }
   return currentBlock_;
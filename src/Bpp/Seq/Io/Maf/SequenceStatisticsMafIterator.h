@@ -53,7 +53,8 @@ namespace bpp {
 /**
  * @brief Compute a series of sequence statistics for each block.
  *
- * Computed statistics are stored into a vector of double, which can be retrieved as well as statistics names.
+ * Computed statistics are stored into a MafStatisticsResult with one slot per column, which can be retrieved as well as statistics names.
+ * Slots of the statistics results are resolved once at construction, so that no tag lookup is needed per block.
  * Listeners can be set up to automatically analyse or write the output after iterations are over.
  *
  * The current implementation focuses on speed and memory efificiency, as it only stores in memory the current results of the statistics.
@@ -61,14 +62,26 @@ namespace bpp {
  * although appropriate buffering should most likely circumvent the issue.
  * The code is easily extensible, however, to enable storage of all results into a matrix,
  * with writing only once at the end of iterations.
+ *
+ * Statistics implementing the ColumnSweepMafStatistics interface are grouped according to their selection of sequences.
+ * For each group, column counts are computed once, and a single sweep over the columns updates all statistics of the group.
  */
 class SequenceStatisticsMafIterator:
   public AbstractFilterMafIterator
 {
-  private:
+  protected:
     std::vector<MafStatistics*> statistics_;
-    std::vector<const BppNumberI*> results_;
+    MafStatisticsResult results_;
     std::vector<std::string> names_;
+    //For each column, the index of the statistic and the slot in its result (or the maximum size_t if not yet resolved),
+    //and the tag of the slot:
+    std::vector< std::pair<size_t, size_t> > slots_;
+    std::vector<std::string> slotTags_;
+
+  private:
+    //Execution plan: statistics swept together, and statistics computed independently.
+    std::vector< std::vector<ColumnSweepMafStatistics*> > sweeps_;
+    std::vector<MafStatistics*> others_;
 
   public:
     /**
@@ -82,7 +95,11 @@ class SequenceStatisticsMafIterator:
       AbstractFilterMafIterator(0),
       statistics_(iterator.statistics_),
       results_(iterator.results_),
-      names_(iterator.names_)
+      names_(iterator.names_),
+      slots_(iterator.slots_),
+      slotTags_(iterator.slotTags_),
+      sweeps_(iterator.sweeps_),
+      others_(iterator.others_)
     {}
     
     SequenceStatisticsMafIterator& operator=(const SequenceStatisticsMafIterator& iterator)
@@ -90,11 +107,18 @@ class SequenceStatisticsMafIterator:
       statistics_ = iterator.statistics_;
       results_ = iterator.results_;
       names_ = iterator.names_;
+      slots_ = iterator.slots_;
+      slotTags_ = iterator.slotTags_;
+      sweeps_ = iterator.sweeps_;
+      others_ = iterator.others_;
       return *this;
     }
 
   public:
-    const std::vector<const BppNumberI*>& getResults() const { return results_; }
+    /**
+     * @return The results for the current block, with one slot per column (see getResultsColumnNames()).
+     */
+    const MafStatisticsResult& getResults() const { return results_; }
     const std::vector<std::string>& getResultsColumnNames() const { return names_; }
 
   private:
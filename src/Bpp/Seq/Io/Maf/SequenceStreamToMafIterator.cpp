@@ -39,38 +39,172 @@ knowledge of the CeCILL license and that you accept its terms.
 
 #include "SequenceStreamToMafIterator.h"
 #include <Bpp/Text/TextTools.h>
-#include <Bpp/Text/StringTokenizer.h>
 
 using namespace std;
 using namespace bpp;
 
-MafBlock* SequenceStreamToMafIterator::analyseCurrentBlock_()
+constexpr int SequenceStreamToMafIterator::INVALID_STATE_;
+
+SequenceStreamToMafIterator::SequenceStreamToMafIterator(LineReader* reader, bool zeroBasedCoordinates, bool groupRows) :
+  seqStream_(), stream_(0), reader_(reader), zeroBasedCoords_(zeroBasedCoordinates), firstBlock_(true), groupRows_(groupRows),
+  pool_(&MafBlockPool::getDefaultPool()), charCodes_(256, INVALID_STATE_), header_(), hasHeader_(false), name_(), next_()
+{
+  if (!reader)
+    throw NullPointerException("SequenceStreamToMafIterator. LineReader should not be a NULL pointer!");
+  const Alphabet* alpha = &AlphabetTools::DNA_ALPHABET;
+  for (int i = 0; i < 256; ++i) {
+    string str(1, static_cast<char>(i));
+    if (alpha->isCharInAlphabet(str))
+      charCodes_[i] = alpha->charToInt(str);
+  }
+}
+
+/******************************************************************************/
+
+bool SequenceStreamToMafIterator::parseHeader_(const TextSpan& header, size_t& start, char& strand, size_t& length)
+{
+  //Locate the four separators of "species:chr:start:strand:length":
+  size_t sep[4];
+  size_t nbSep = 0;
+  for (size_t i = 0; i < header.size; ++i) {
+    if (header[i] == ':') {
+      if (nbSep == 4) {
+        nbSep++;
+        break;
+      }
+      sep[nbSep++] = i;
+    }
+  }
+  if (nbSep != 4) {
+    name_.assign(header.data, header.size);
+    return false;
+  }
+  //Empty fields are not allowed, as StringTokenizer would skip them:
+  if (sep[0] == 0 || sep[1] == sep[0] + 1 || sep[2] == sep[1] + 1 || sep[3] == sep[2] + 1 || sep[3] + 1 == header.size) {
+    name_.assign(header.data, header.size);
+    return false;
+  }
+  name_.assign(header.data, sep[1]);
+  name_[sep[0]] = '.';
+  start = static_cast<size_t>(header.substr(sep[1] + 1, sep[2] - sep[1] - 1).toUnsignedInteger());
+  if (!zeroBasedCoords_)
+    start--;
+  strand = header[sep[2] + 1];
+  length = static_cast<size_t>(header.substr(sep[3] + 1).toUnsignedInteger());
+  return true;
+}
+
+void SequenceStreamToMafIterator::checkLength_(const MafSequence& seq, size_t length) const
+{
+  if (seq.size() != length)
+    throw Exception("SequenceStreamToMafIterator::analyseCurrentBlock_. Sequence size does not match its header specification: expected " + TextTools::toString(length) + " and found " + TextTools::toString(seq.size()));
+}
+
+/******************************************************************************/
+
+void SequenceStreamToMafIterator::setHeader_(const TextSpan& line)
+{
+  size_t n = line.size;
+  while (n > 1 && TextSpan::isSpace(line[n - 1])) n--;
+  header_.assign(line.data + 1, n - 1);
+  hasHeader_ = true;
+}
+
+MafSequence SequenceStreamToMafIterator::readFasta_(bool& found)
+{
+  TextSpan line;
+  while (!hasHeader_ && reader_->nextLine(line)) {
+    countBytesRead_(line.size + 1);
+    if (line.isBlank()) continue;
+    if (line[0] != '>')
+      throw IOException("SequenceStreamToMafIterator::readFasta_. Sequence found before any header: " + line.toString());
+    setHeader_(line);
+  }
+  found = hasHeader_;
+  if (!found) return MafSequence();
+
+  //The header is parsed before being overwritten by the next one:
+  size_t start = 0, length = 0;
+  char strand = 0;
+  bool hasCoords = parseHeader_(TextSpan(header_.data(), header_.size()), start, strand, length);
+  hasHeader_ = false;
+
+  //Sequence lines are encoded directly from the input buffer:
+  vector<int> content = pool_->getBuffer();
+  while (reader_->nextLine(line)) {
+    countBytesRead_(line.size + 1);
+    if (line.size > 0 && line[0] == '>') {
+      setHeader_(line);
+      break;
+    }
+    size_t n = line.size;
+    while (n > 0 && TextSpan::isSpace(line[n - 1])) n--;
+    size_t offset = content.size();
+    content.resize(offset + n);
+    int* dest = &content[0] + offset;
+    size_t k = 0;
+    for (size_t i = 0; i < n; ++i) {
+      unsigned char c = static_cast<unsigned char>(line[i]);
+      if (TextSpan::isSpace(line[i])) continue;
+      int state = charCodes_[c];
+      if (state == INVALID_STATE_)
+        throw BadCharException(string(1, line[i]), "SequenceStreamToMafIterator::readFasta_. Invalid character in sequence " + name_ + ".", &AlphabetTools::DNA_ALPHABET);
+      dest[k++] = state;
+    }
+    content.resize(offset + k);
+  }
+  MafSequence seq(name_, std::move(content), start, strand, 0, false);
+  seq.setName(name_); //Also sets the species and chromosome, if any.
+  if (hasCoords)
+    checkLength_(seq, length);
+  else
+    seq.removeCoordinates();
+  return seq;
+}
+
+MafSequence SequenceStreamToMafIterator::nextSequence_(bool& found)
 {
-  unique_ptr<MafBlock> block(new MafBlock());
+  if (reader_.get())
+    return readFasta_(found);
 
   MafSequence mafSeq;
-  if (stream_->eof()) return 0;
-  
-  seqStream_->nextSequence(*stream_, mafSeq);
+  found = !stream_->eof() && seqStream_->nextSequence(*stream_, mafSeq);
+  if (!found) return mafSeq;
   //Check if sequence name contains meta information:
-  string meta = mafSeq.getName();
-  StringTokenizer st(meta, ":");
-  if (st.numberOfRemainingTokens() == 5) {
-    string species = st.nextToken();
-    string chr     = st.nextToken();
-    unsigned int start   = TextTools::to<unsigned int>(st.nextToken());
-    if (!zeroBasedCoords_)
-      start--;
-    string strand  = st.nextToken();
-    unsigned int length  = TextTools::to<unsigned int>(st.nextToken());
-    mafSeq.setName(species + "." + chr);
-    mafSeq.setStrand(strand[0]);
+  size_t start = 0, length = 0;
+  char strand = '+';
+  if (parseHeader_(TextSpan(mafSeq.getName().data(), mafSeq.getName().size()), start, strand, length)) {
+    mafSeq.setName(name_);
+    mafSeq.setStrand(strand);
     mafSeq.setStart(start);
-    if (mafSeq.size() != length)
-      throw Exception("SequenceStreamToMafIterator::analyseCurrentBlock_. Sequence size does not match its header specification: expected " + TextTools::toString(length) + " and found " + TextTools::toString(mafSeq.size()));
+    checkLength_(mafSeq, length);
   }
-  block->addSequence(mafSeq);
+  return mafSeq;
+}
 
+MafBlock* SequenceStreamToMafIterator::analyseCurrentBlock_()
+{
+  unique_ptr<MafBlock> block;
+  if (next_.get()) {
+    //This sequence was read with the previous block:
+    block.reset(pool_->getBlock());
+    block->addSequence(std::move(*next_));
+    next_.reset();
+  }
+  bool found = true;
+  while (found) {
+    MafSequence mafSeq = nextSequence_(found);
+    if (!found) break;
+    if (!block.get()) {
+      block.reset(pool_->getBlock());
+    } else if (mafSeq.size() != block->getNumberOfSites() || block->hasSequenceForSpecies(mafSeq.getSpecies())) {
+      //This sequence starts a new block:
+      next_.reset(new MafSequence(std::move(mafSeq)));
+      break;
+    }
+    block->addSequence(std::move(mafSeq));
+    if (!groupRows_) break;
+  }
   return block.release();
 }
 
@@ -41,20 +41,33 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _SEQUENCESTREAMTOMAFITERATOR_H_
 
 #include "MafIterator.h"
+#include "../LineReader.h"
 #include <Bpp/Seq/Alphabet/CaseMaskedAlphabet.h>
 #include <Bpp/Seq/Io/ISequenceStream.h>
 
 //From the STL:
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace bpp {
 
 /**
  * @brief A MafIterator built from a sequence stream.
  *
- * Each block will contain one sequence from the original file.
- * 
+ * Each block will contain one sequence from the original file. Sequence names of the form
+ * "species:chromosome:start:strand:length" are parsed to set the coordinates of the sequence.
+ *
+ * Sequences can either be read through a ISequenceStream object (e.g. Fasta or Fastq), or directly
+ * from a FASTA file through a LineReader object. In the latter case, sequence lines are encoded
+ * in place into recycled buffers, without any intermediate string.
+ *
+ * Optionally, consecutive sequences with the same alignment length and from distinct species are grouped
+ * into a single multi-row block, which allows to convert multi-FASTA files of aligned contigs.
+ * Blocks are obtained from a MafBlockPool, so that memory is reused when downstream iterators recycle
+ * them.
+ *
  * @author Julien Dutheil
  */
 class SequenceStreamToMafIterator:
@@ -63,25 +76,98 @@ class SequenceStreamToMafIterator:
   private:
     std::unique_ptr<ISequenceStream> seqStream_;
     std::istream* stream_;
+    std::unique_ptr<LineReader> reader_;
     bool zeroBasedCoords_;
     bool firstBlock_;
+    bool groupRows_;
+    MafBlockPool* pool_;
+    std::vector<int> charCodes_;
+    std::string header_; //Header of the next record, when reading directly from a LineReader.
+    bool hasHeader_;
+    std::string name_;
+    std::unique_ptr<MafSequence> next_; //Sequence read but not added to the previous block.
 
   public:
-    SequenceStreamToMafIterator(ISequenceStream* seqStream, std::istream* stream, bool parseMask = false, bool zeroBasedCoordinates = true) :
-      seqStream_(seqStream), stream_(stream), zeroBasedCoords_(zeroBasedCoordinates), firstBlock_(true) {}
+    /**
+     * @param seqStream The sequence reader, owned by the iterator.
+     * @param stream The input stream, not owned.
+     * @param parseMask Not used.
+     * @param zeroBasedCoordinates Tell if the coordinates in sequence names are 0-based (otherwise 1-based).
+     * @param groupRows Group consecutive sequences into multi-row blocks.
+     */
+    SequenceStreamToMafIterator(ISequenceStream* seqStream, std::istream* stream, bool parseMask = false, bool zeroBasedCoordinates = true, bool groupRows = false) :
+      seqStream_(seqStream), stream_(stream), reader_(), zeroBasedCoords_(zeroBasedCoordinates), firstBlock_(true), groupRows_(groupRows),
+      pool_(&MafBlockPool::getDefaultPool()), charCodes_(), header_(), hasHeader_(false), name_(), next_() {}
+
+    /**
+     * @brief Read a FASTA file directly, using a LineReader object.
+     *
+     * @code
+     * SequenceStreamToMafIterator it(new CompressedLineReader("contigs.fa.gz"), true, true);
+     * @endcode
+     *
+     * @param reader The line reader, owned by the iterator.
+     * @param zeroBasedCoordinates Tell if the coordinates in sequence names are 0-based (otherwise 1-based).
+     * @param groupRows Group consecutive sequences into multi-row blocks.
+     */
+    SequenceStreamToMafIterator(LineReader* reader, bool zeroBasedCoordinates = true, bool groupRows = false);
 
   private:
     //Recopy is forbidden!
     SequenceStreamToMafIterator(const SequenceStreamToMafIterator& ss2mi):
-      seqStream_(), stream_(0), zeroBasedCoords_(ss2mi.zeroBasedCoords_), firstBlock_(ss2mi.firstBlock_) {}
+      seqStream_(), stream_(0), reader_(), zeroBasedCoords_(ss2mi.zeroBasedCoords_), firstBlock_(ss2mi.firstBlock_), groupRows_(ss2mi.groupRows_),
+      pool_(ss2mi.pool_), charCodes_(), header_(), hasHeader_(false), name_(), next_() {}
     SequenceStreamToMafIterator& operator=(const SequenceStreamToMafIterator& ss2mi) {
-      seqStream_.reset(); stream_ = 0; zeroBasedCoords_ = ss2mi.zeroBasedCoords_; firstBlock_ = ss2mi.firstBlock_;
+      seqStream_.reset(); stream_ = 0; reader_.reset(); zeroBasedCoords_ = ss2mi.zeroBasedCoords_; firstBlock_ = ss2mi.firstBlock_; groupRows_ = ss2mi.groupRows_;
+      pool_ = ss2mi.pool_; charCodes_.clear(); header_.clear(); hasHeader_ = false; name_.clear(); next_.reset();
       return *this;
     }
 
+  public:
+    /**
+     * @brief Set the pool used to allocate blocks and sequence buffers.
+     *
+     * By default, MafBlockPool::getDefaultPool() is used.
+     * @param pool The pool to use. It is not owned by the iterator.
+     */
+    void setBlockPool(MafBlockPool* pool) {
+      if (!pool)
+        throw NullPointerException("SequenceStreamToMafIterator::setBlockPool. Pool should not be a NULL pointer!");
+      pool_ = pool;
+    }
+
+    void recycle(MafBlock* block) { pool_->recycle(block); }
+
+    void groupRows(bool yn) { groupRows_ = yn; }
+    bool groupRows() const { return groupRows_; }
+
   private:
     MafBlock* analyseCurrentBlock_();
 
+    /**
+     * @brief Read the next sequence from the input.
+     *
+     * The sequence is returned by value, its content being moved and not copied.
+     * @param found [out] False if there is no more sequence, in which case the returned sequence is empty.
+     */
+    MafSequence nextSequence_(bool& found);
+    MafSequence readFasta_(bool& found);
+    void setHeader_(const TextSpan& line);
+
+    /**
+     * @brief Parse a sequence header in place.
+     *
+     * @param header The header, without the leading '>'.
+     * @param start [out] The start position, if any.
+     * @param strand [out] The strand, if any.
+     * @param length [out] The length of the sequence, if any.
+     * @return True if the header contains coordinates. The name of the sequence is stored in name_.
+     */
+    bool parseHeader_(const TextSpan& header, size_t& start, char& strand, size_t& length);
+
+    void checkLength_(const MafSequence& seq, size_t length) const;
+
+    static constexpr int INVALID_STATE_ = -1000;
 };
 
 } // end of namespace bpp.
@@ -0,0 +1,242 @@
+//
+// File: ShardedOutputMafIterator.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "ShardedOutputMafIterator.h"
+
+using namespace bpp;
+
+//From the STL:
+#include <string>
+
+using namespace std;
+
+ShardedOutputMafIterator::ShardedOutputMafIterator(
+    MafIterator* iterator,
+    const std::string& refSpecies,
+    const std::string& fileTemplate,
+    OutputFactory factory,
+    unsigned int nbThreads,
+    size_t queueSize,
+    bool forwardBlocks):
+  AbstractFilterMafIterator(iterator),
+  refSpecies_(refSpecies),
+  fileTemplate_(fileTemplate),
+  manifest_(),
+  factory_(factory),
+  forwardBlocks_(forwardBlocks),
+  shards_(),
+  shardIndex_(),
+  queues_(),
+  workers_(),
+  errors_(),
+  failed_(false),
+  finished_(false)
+{
+  if (fileTemplate_.find("%c") == string::npos)
+    throw Exception("ShardedOutputMafIterator (constructor). File name template should contain '%c': " + fileTemplate_);
+  if (nbThreads == 0)
+    nbThreads = thread::hardware_concurrency();
+  if (nbThreads == 0)
+    nbThreads = 1;
+  errors_.resize(nbThreads);
+  for (size_t i = 0; i < nbThreads; ++i)
+    queues_.push_back(unique_ptr< SpscBoundedQueue<Job_> >(new SpscBoundedQueue<Job_>(queueSize)));
+  for (size_t i = 0; i < nbThreads; ++i)
+    workers_.push_back(thread(&ShardedOutputMafIterator::workerLoop_, this, i));
+}
+
+ShardedOutputMafIterator::~ShardedOutputMafIterator()
+{
+  if (!finished_) {
+    try {
+      close();
+    } catch (...) {
+      //Errors cannot be forwarded from the destructor.
+    }
+  }
+}
+
+void ShardedOutputMafIterator::workerLoop_(size_t worker)
+{
+  SpscBoundedQueue<Job_>& queue = *queues_[worker];
+  Job_ job;
+  while (queue.pop(job)) {
+    if (errors_[worker]) {
+      //A previous block failed, the remaining ones are discarded:
+      if (job.block) delete job.block;
+      continue;
+    }
+    try {
+      job.shard->input.setBlock(job.block);
+      //An empty input lets the output iterator know that the input is done:
+      MafBlock* block = job.shard->output->nextBlock();
+      if (block)
+        job.shard->output->recycle(block);
+    } catch (...) {
+      errors_[worker] = current_exception();
+      failed_.store(true);
+    }
+  }
+}
+
+ShardedOutputMafIterator::Shard_& ShardedOutputMafIterator::getShard_(const std::string& chromosome)
+{
+  map<string, Shard_*>::iterator it = shardIndex_.find(chromosome);
+  if (it != shardIndex_.end())
+    return *it->second;
+
+  unique_ptr<Shard_> shard(new Shard_());
+  shard->chromosome = chromosome;
+  shard->file = fileTemplate_;
+  for (size_t pos = shard->file.find("%c"); pos != string::npos; pos = shard->file.find("%c", pos + chromosome.size()))
+    shard->file.replace(pos, 2, chromosome);
+  shard->stream.reset(new ofstream(shard->file.c_str(), ios::out | ios::binary));
+  if (!*shard->stream)
+    throw IOException("ShardedOutputMafIterator::getShard_. Could not open file " + shard->file + " for writing.");
+  shard->output.reset(factory_(&shard->input, shard->stream.get()));
+  if (!shard->output.get())
+    throw Exception("ShardedOutputMafIterator::getShard_. The factory returned no output iterator.");
+  shard->output->setVerbose(false);
+  shard->worker = shards_.size() % queues_.size();
+  if (logstream_) {
+    (*logstream_ << "SHARDED OUTPUT: new shard for chromosome " << chromosome << ", written to " << shard->file << ".").endLine();
+  }
+  Shard_* ptr = shard.get();
+  shards_.push_back(std::move(shard));
+  shardIndex_[chromosome] = ptr;
+  return *ptr;
+}
+
+void ShardedOutputMafIterator::dispatch_(MafBlock* block)
+{
+  Shard_& shard = getShard_(block->getSequenceForSpecies(refSpecies_).getChromosome());
+  shard.nbBlocks++;
+  if (!queues_[shard.worker]->push(Job_(&shard, block)))
+    delete block;
+}
+
+void ShardedOutputMafIterator::stopWorkers_()
+{
+  for (size_t i = 0; i < queues_.size(); ++i)
+    queues_[i]->close();
+  for (size_t i = 0; i < workers_.size(); ++i)
+    if (workers_[i].joinable())
+      workers_[i].join();
+}
+
+void ShardedOutputMafIterator::checkErrors_()
+{
+  for (size_t i = 0; i < errors_.size(); ++i)
+    if (errors_[i])
+      rethrow_exception(errors_[i]);
+}
+
+void ShardedOutputMafIterator::close()
+{
+  if (finished_) return;
+  finished_ = true;
+
+  //Let all output iterators know that the input is done, then wait for the writers:
+  if (!failed_.load()) {
+    for (size_t i = 0; i < shards_.size(); ++i)
+      queues_[shards_[i]->worker]->push(Job_(shards_[i].get(), 0));
+  }
+  stopWorkers_();
+
+  //Deleting the output iterators flushes their output:
+  bool ioError = false;
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    shards_[i]->output.reset();
+    shards_[i]->stream->close();
+    if (shards_[i]->stream->fail())
+      ioError = true;
+  }
+  checkErrors_();
+  if (ioError)
+    throw IOException("ShardedOutputMafIterator::close. An error occurred while writing shards.");
+
+  if (!manifest_.empty()) {
+    ofstream manifest(manifest_.c_str(), ios::out);
+    if (!manifest)
+      throw IOException("ShardedOutputMafIterator::close. Could not open manifest file " + manifest_ + " for writing.");
+    manifest << "chromosome\tfile\tblocks" << endl;
+    for (size_t i = 0; i < shards_.size(); ++i)
+      manifest << shards_[i]->chromosome << "\t" << shards_[i]->file << "\t" << shards_[i]->nbBlocks << "\n";
+    manifest.close();
+    if (manifest.fail())
+      throw IOException("ShardedOutputMafIterator::close. An error occurred while writing manifest file " + manifest_ + ".");
+  }
+  if (logstream_) {
+    (*logstream_ << "SHARDED OUTPUT: " << shards_.size() << " shards written.").endLine();
+  }
+}
+
+MafBlock* ShardedOutputMafIterator::analyseCurrentBlock_()
+{
+  if (finished_) return 0;
+  MafBlock* block = 0;
+  while ((block = iterator_->nextBlock())) {
+    bool routed = block->hasSequenceForSpecies(refSpecies_);
+    if (routed) {
+      MafBlock* shardBlock = block;
+      if (forwardBlocks_) {
+        //The writer threads read a copy-on-write copy, which shares its sequences with the forwarded block.
+        //Lazy data must be built before both threads can read them:
+        block->prepareForSharing();
+        shardBlock = new MafBlock(*block);
+      }
+      dispatch_(shardBlock);
+    } else if (logstream_) {
+      (*logstream_ << "SHARDED OUTPUT: block " << block->getDescription() << " does not contain the reference species and was not written.").endLine();
+    }
+    if (failed_.load()) {
+      if (forwardBlocks_ || !routed) iterator_->recycle(block);
+      close(); //Forwards the error.
+      return 0;
+    }
+    if (forwardBlocks_) {
+      currentBlock_ = block;
+      return block;
+    }
+    if (!routed)
+      iterator_->recycle(block);
+  }
+  close();
+  return 0;
+}
@@ -0,0 +1,183 @@
+//
+// File: ShardedOutputMafIterator.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _SHARDEDOUTPUTMAFITERATOR_H_
+#define _SHARDEDOUTPUTMAFITERATOR_H_
+
+#include "MafIterator.h"
+#include "ParallelMafIterator.h"
+#include "SpscBoundedQueue.h"
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <exception>
+
+namespace bpp {
+
+/**
+ * @brief Write blocks to one output file per chromosome of a reference species, concurrently.
+ *
+ * Each block is routed according to the chromosome of its reference sequence. For each new
+ * chromosome, a file is opened, named after a template in which "%c" is replaced by the chromosome
+ * name, and an output iterator is built on top of it with a user-provided factory. Shards are
+ * distributed over a pool of writer threads, so that several chromosomes are formatted and
+ * written at the same time, while blocks of a given chromosome are written in input order.
+ *
+ * Blocks without the reference species are not written. When all blocks have been read, the
+ * shard iterators are deleted (which flushes their output), the files are closed, and a manifest
+ * is written if a file name was given, with one line per shard: chromosome, file name and number
+ * of blocks, in order of first occurrence.
+ *
+ * The factory is called on the calling thread, but the output iterators are then run on the writer
+ * threads: they should not log to a shared, non thread-safe stream. Exceptions thrown by the
+ * shard iterators are forwarded to the caller of nextBlock().
+ *
+ * Example:
+ * @code
+ * ShardedOutputMafIterator it(input, "hg19", "out.%c.vcf", [&](MafIterator* in, std::ostream* out) {
+ *   return new VcfOutputMafIterator(in, out, "hg19", genotypes);
+ * }, 4);
+ * it.setManifest("out.manifest.txt");
+ * @endcode
+ */
+class ShardedOutputMafIterator:
+  public AbstractFilterMafIterator
+{
+  public:
+    typedef std::function<MafIterator* (MafIterator*, std::ostream*)> OutputFactory;
+
+  private:
+    struct Shard_
+    {
+      std::string chromosome;
+      std::string file;
+      std::unique_ptr<std::ofstream> stream;
+      SingleBlockMafIterator input;
+      std::unique_ptr<MafIterator> output;
+      size_t worker;
+      size_t nbBlocks;
+      Shard_(): chromosome(), file(), stream(), input(), output(), worker(0), nbBlocks(0) {}
+    };
+
+    struct Job_
+    {
+      Shard_* shard;
+      MafBlock* block; //0 means end of input for this shard.
+      Job_(): shard(0), block(0) {}
+      Job_(Shard_* s, MafBlock* b): shard(s), block(b) {}
+    };
+
+  private:
+    std::string refSpecies_;
+    std::string fileTemplate_;
+    std::string manifest_;
+    OutputFactory factory_;
+    bool forwardBlocks_;
+    std::vector< std::unique_ptr<Shard_> > shards_;
+    std::map<std::string, Shard_*> shardIndex_;
+    std::vector< std::unique_ptr< SpscBoundedQueue<Job_> > > queues_;
+    std::vector<std::thread> workers_;
+    std::vector<std::exception_ptr> errors_;
+    std::atomic<bool> failed_;
+    bool finished_;
+
+  public:
+    /**
+     * @param iterator The input iterator.
+     * @param refSpecies The species according to which blocks are routed.
+     * @param fileTemplate The file name template, where "%c" stands for the chromosome name.
+     * @param factory A function building an output iterator on top of an input iterator and an output stream.
+     * The output iterator is owned by the ShardedOutputMafIterator.
+     * @param nbThreads The number of writer threads (0 means one per available core).
+     * @param queueSize The maximum number of blocks waiting for each writer thread.
+     * @param forwardBlocks If true, blocks are copied to the shards and forwarded downstream.
+     * Otherwise, all blocks are written upon the first call to nextBlock(), which then returns 0.
+     */
+    ShardedOutputMafIterator(
+        MafIterator* iterator,
+        const std::string& refSpecies,
+        const std::string& fileTemplate,
+        OutputFactory factory,
+        unsigned int nbThreads = 0,
+        size_t queueSize = 16,
+        bool forwardBlocks = true);
+
+    virtual ~ShardedOutputMafIterator();
+
+  private:
+    //Recopy is forbidden!
+    ShardedOutputMafIterator(const ShardedOutputMafIterator& iterator);
+    ShardedOutputMafIterator& operator=(const ShardedOutputMafIterator& iterator);
+
+  public:
+    /**
+     * @param file The name of the manifest file written at the end of the iteration (empty for none).
+     */
+    void setManifest(const std::string& file) { manifest_ = file; }
+
+    size_t getNumberOfThreads() const { return queues_.size(); }
+    size_t getNumberOfShards() const { return shards_.size(); }
+
+    /**
+     * @brief Flush and close all shards, and write the manifest.
+     *
+     * This is called automatically at the end of the input.
+     */
+    void close();
+
+  private:
+    MafBlock* analyseCurrentBlock_();
+
+    Shard_& getShard_(const std::string& chromosome);
+    void dispatch_(MafBlock* block);
+    void workerLoop_(size_t worker);
+    void stopWorkers_();
+    void checkErrors_();
+};
+
+} // end of namespace bpp.
+
+#endif //_SHARDEDOUTPUTMAFITERATOR_H_
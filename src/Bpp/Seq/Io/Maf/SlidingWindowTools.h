@@ -0,0 +1,131 @@
+//
+// File: SlidingWindowTools.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _SLIDINGWINDOWTOOLS_H_
+#define _SLIDINGWINDOWTOOLS_H_
+
+//From the STL:
+#include <vector>
+#include <cstddef>
+
+namespace bpp {
+
+/**
+ * @brief Prefix sums over a vector of per-column values, for constant time window sums.
+ *
+ * Sums are exact for integer values. For floating point values, a window sum may differ
+ * in its last bits from the sum of the values of the window.
+ */
+template<class T>
+class PrefixSums
+{
+  private:
+    std::vector<T> sums_;
+
+  public:
+    PrefixSums(): sums_(1, T()) {}
+
+    PrefixSums(const std::vector<T>& values): sums_(1, T()) { init(values); }
+
+  public:
+    void init(const std::vector<T>& values) {
+      sums_.resize(values.size() + 1);
+      sums_[0] = T();
+      for (size_t i = 0; i < values.size(); ++i)
+        sums_[i + 1] = sums_[i] + values[i];
+    }
+
+    /**
+     * @return The sum of values in [begin, end[.
+     */
+    T sum(size_t begin, size_t end) const { return sums_[end] - sums_[begin]; }
+
+    size_t size() const { return sums_.size() - 1; }
+};
+
+/**
+ * @brief Tools shared by sliding-window filters.
+ */
+class SlidingWindowTools
+{
+  public:
+    /**
+     * @brief Compute the positions of the windows evaluated by a sliding window filter.
+     *
+     * The first window is [0, windowSize[, and windows are moved by step positions as long as the next window
+     * start strictly before the end of the block minus the step. This reproduces the original traversal
+     * of the sliding window filters.
+     *
+     * @param nbSites The number of sites in the block. It must be at least windowSize.
+     * @param windowSize The size of the window.
+     * @param step The step used to move the window.
+     * @return The list of window ends (exclusive); each window covers [end - windowSize, end[.
+     */
+    static std::vector<size_t> getWindowEnds(size_t nbSites, size_t windowSize, size_t step) {
+      std::vector<size_t> ends;
+      size_t i = windowSize;
+      while (i + step < nbSites) {
+        ends.push_back(i);
+        i += step;
+      }
+      ends.push_back(i);
+      return ends;
+    }
+
+    /**
+     * @brief Add a region to a sorted list of regions, merging it with the previous one if they overlap.
+     *
+     * @param pos A vector of region bounds, as [begin1, end1, begin2, end2, ...].
+     * @param begin The start of the region to add.
+     * @param end The end of the region to add.
+     * @param strict If true, regions are merged only if they strictly overlap, and not if they are contiguous.
+     */
+    static void addRegion(std::vector<size_t>& pos, size_t begin, size_t end, bool strict = false) {
+      if (pos.size() > 0 && (strict ? begin < pos.back() : begin <= pos.back())) {
+        pos.back() = end; //Windows are overlapping and we extend previous region
+      } else { //This is a new region
+        pos.push_back(begin);
+        pos.push_back(end);
+      }
+    }
+};
+
+} // end of namespace bpp.
+
+#endif //_SLIDINGWINDOWTOOLS_H_
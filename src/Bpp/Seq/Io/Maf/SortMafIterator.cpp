@@ -0,0 +1,236 @@
+//
+// File: SortMafIterator.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "SortMafIterator.h"
+#include "PackedMafBlock.h"
+
+using namespace bpp;
+
+//From the STL:
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
+
+using namespace std;
+
+bool SortMafIterator::Key_::operator<(const Key_& key) const
+{
+  //Blocks without coordinates come first:
+  if (placed != key.placed) return !placed;
+  if (!placed) return false;
+  if (rank != key.rank) return rank < key.rank;
+  if (chr != key.chr) return chr < key.chr;
+  if (start != key.start) return start < key.start;
+  return stop < key.stop;
+}
+
+/******************************************************************************/
+
+SortMafIterator::SortMafIterator(MafIterator* iterator, const string& reference, uint64_t maxMemory, const string& tmpDir):
+  AbstractFilterMafIterator(iterator), refSpecies_(reference), maxMemory_(maxMemory), tmpDir_(tmpDir), chrOrder_(),
+  buffer_(), bufferSize_(0), nextBuffered_(0), nbRuns_(0), runPaths_(), runs_(), heap_(), sorted_(false)
+{
+  if (tmpDir_ == "") {
+    const char* env = getenv("TMPDIR");
+    tmpDir_ = (env && *env ? env : "/tmp");
+  }
+}
+
+SortMafIterator::~SortMafIterator()
+{
+  for (size_t i = nextBuffered_; i < buffer_.size(); ++i)
+    if (buffer_[i].second)
+      iterator_->recycle(buffer_[i].second);
+  for (size_t i = 0; i < heap_.size(); ++i)
+    delete heap_[i].block;
+  removeRuns_();
+}
+
+/******************************************************************************/
+
+void SortMafIterator::setChromosomeOrder(const vector<string>& chromosomes)
+{
+  if (sorted_)
+    throw Exception("SortMafIterator::setChromosomeOrder. The iteration has already started.");
+  chrOrder_.clear();
+  for (size_t i = 0; i < chromosomes.size(); ++i)
+    chrOrder_.insert(make_pair(chromosomes[i], i));
+}
+
+/******************************************************************************/
+
+SortMafIterator::Key_ SortMafIterator::makeKey_(const MafBlock& block) const
+{
+  Key_ key;
+  if (block.hasSequenceForSpecies(refSpecies_)) {
+    const MafSequence& refSeq = block.getSequenceForSpecies(refSpecies_);
+    if (refSeq.hasCoordinates()) {
+      key.placed = true;
+      key.chr = refSeq.getChromosome();
+      map<string, size_t>::const_iterator it = chrOrder_.find(key.chr);
+      key.rank = (it == chrOrder_.end() ? numeric_limits<size_t>::max() : it->second);
+      key.start = refSeq.start();
+      key.stop = refSeq.stop();
+    }
+  }
+  return key;
+}
+
+/******************************************************************************/
+
+void SortMafIterator::writeRun_()
+{
+  stable_sort(buffer_.begin(), buffer_.end(), lessKey_);
+  string path = tmpDir_ + "/bppsort_XXXXXX";
+  vector<char> name(path.begin(), path.end());
+  name.push_back('\0');
+  int fd = mkstemp(&name[0]);
+  if (fd == -1)
+    throw IOException("SortMafIterator::writeRun_. Could not create a temporary file in " + tmpDir_ + ".");
+  close(fd);
+  path = string(&name[0]);
+  runPaths_.push_back(path);
+  nbRuns_++;
+  ofstream out(path.c_str(), ios::out | ios::binary | ios::trunc);
+  if (!out)
+    throw IOException("SortMafIterator::writeRun_. Could not open temporary file " + path + ".");
+  for (size_t i = 0; i < buffer_.size(); ++i) {
+    PackedMafBlock(*buffer_[i].second).write(out);
+    iterator_->recycle(buffer_[i].second);
+    buffer_[i].second = 0;
+  }
+  out.close();
+  if (!out)
+    throw IOException("SortMafIterator::writeRun_. Error while writing temporary file " + path + ".");
+  if (logstream_) {
+    (*logstream_ << "SORT: " << buffer_.size() << " blocks written to run " << path << ".").endLine();
+  }
+  buffer_.clear();
+  bufferSize_ = 0;
+}
+
+void SortMafIterator::readRun_(size_t run)
+{
+  Head_ head;
+  head.run = run;
+  if (run == runs_.size()) {
+    if (nextBuffered_ == buffer_.size()) return;
+    head.block = buffer_[nextBuffered_].second;
+    head.key = buffer_[nextBuffered_].first;
+    buffer_[nextBuffered_++].second = 0;
+  } else {
+    unique_ptr<PackedMafBlock> packed(PackedMafBlock::read(*runs_[run]));
+    if (!packed.get()) return;
+    head.block = packed->unpack();
+    head.key = makeKey_(*head.block);
+  }
+  heap_.push_back(head);
+  push_heap(heap_.begin(), heap_.end(), greater<Head_>());
+}
+
+void SortMafIterator::readInput_()
+{
+  MafBlock* block;
+  while ((block = iterator_->nextBlock())) {
+    buffer_.push_back(make_pair(makeKey_(*block), block));
+    bufferSize_ += block->getMemorySize();
+    if (bufferSize_ > maxMemory_)
+      writeRun_();
+  }
+  stable_sort(buffer_.begin(), buffer_.end(), lessKey_);
+  //Runs are merged with the remaining blocks, unless the input fitted in memory:
+  for (size_t i = 0; i < runPaths_.size(); ++i) {
+    runs_.push_back(unique_ptr<ifstream>(new ifstream(runPaths_[i].c_str(), ios::in | ios::binary)));
+    if (!*runs_.back())
+      throw IOException("SortMafIterator::readInput_. Could not read temporary file " + runPaths_[i] + ".");
+  }
+  if (!runs_.empty())
+    for (size_t i = 0; i <= runs_.size(); ++i)
+      readRun_(i);
+  sorted_ = true;
+}
+
+void SortMafIterator::removeRuns_()
+{
+  runs_.clear();
+  for (size_t i = 0; i < runPaths_.size(); ++i)
+    remove(runPaths_[i].c_str());
+  runPaths_.clear();
+}
+
+/******************************************************************************/
+
+MafBlock* SortMafIterator::analyseCurrentBlock_()
+{
+  if (!sorted_)
+    readInput_();
+  if (runs_.empty()) {
+    if (nextBuffered_ == buffer_.size()) return 0;
+    MafBlock* block = buffer_[nextBuffered_].second;
+    buffer_[nextBuffered_++].second = 0;
+    return block;
+  }
+  if (heap_.empty()) {
+    removeRuns_();
+    return 0;
+  }
+  pop_heap(heap_.begin(), heap_.end(), greater<Head_>());
+  //The block is owned here until it is returned, in case reading the next one throws:
+  unique_ptr<MafBlock> block(heap_.back().block);
+  size_t run = heap_.back().run;
+  heap_.pop_back();
+  readRun_(run);
+  return block.release();
+}
+
+void SortMafIterator::getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const
+{
+  for (size_t i = nextBuffered_; i < buffer_.size(); ++i) {
+    nbBlocks++;
+    nbBytes += buffer_[i].second->getMemorySize();
+  }
+  for (size_t i = 0; i < heap_.size(); ++i) {
+    nbBlocks++;
+    nbBytes += heap_[i].block->getMemorySize();
+  }
+}
+
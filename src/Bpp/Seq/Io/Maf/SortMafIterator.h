@@ -0,0 +1,174 @@
+//
+// File: SortMafIterator.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _SORTMAFITERATOR_H_
+#define _SORTMAFITERATOR_H_
+
+#include "MafIterator.h"
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <fstream>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief Sort blocks according to a reference species, with a bounded memory usage.
+ *
+ * Blocks are ordered by chromosome and start position on the reference, and the sort is stable.
+ * Chromosomes are compared alphabetically, unless an explicit order is given with setChromosomeOrder().
+ * Blocks without the reference species, or without coordinates, come first.
+ *
+ * All input blocks are read when the first block is requested. Blocks are kept in memory until their total size
+ * exceeds the memory budget, in which case they are sorted and written as a run to a temporary file, in packed binary
+ * form (see PackedMafBlock). Runs are then merged back with a heap. When the whole input fits in the budget, no file is
+ * written. Spilled blocks keep their sequences, coordinates, masks and quality scores, but not block properties.
+ * As packed blocks, only nucleotide sequences are supported.
+ */
+class SortMafIterator:
+  public AbstractFilterMafIterator
+{
+  private:
+    struct Key_
+    {
+      bool placed; //False if the block has no reference coordinates.
+      size_t rank;
+      std::string chr;
+      size_t start;
+      size_t stop;
+
+      Key_(): placed(false), rank(0), chr(), start(0), stop(0) {}
+
+      bool operator<(const Key_& key) const;
+    };
+
+    struct Head_
+    {
+      MafBlock* block;
+      size_t run;
+      Key_ key;
+
+      Head_(): block(0), run(0), key() {}
+
+      bool operator>(const Head_& head) const {
+        if (key < head.key) return false;
+        if (head.key < key) return true;
+        return run > head.run;
+      }
+    };
+
+  private:
+    std::string refSpecies_;
+    uint64_t maxMemory_;
+    std::string tmpDir_;
+    std::map<std::string, size_t> chrOrder_;
+    std::vector< std::pair<Key_, MafBlock*> > buffer_;
+    uint64_t bufferSize_;
+    size_t nextBuffered_;
+    size_t nbRuns_;
+    std::vector<std::string> runPaths_;
+    std::vector< std::unique_ptr<std::ifstream> > runs_;
+    std::vector<Head_> heap_; //A min-heap, with std::greater.
+    bool sorted_;
+
+  public:
+    /**
+     * @param iterator The input iterator.
+     * @param reference The reference species.
+     * @param maxMemory The maximum size of blocks kept in memory before a run is written, in bytes.
+     * @param tmpDir The directory for temporary files. By default, the TMPDIR environment variable, or /tmp.
+     */
+    SortMafIterator(MafIterator* iterator, const std::string& reference, uint64_t maxMemory = 1073741824, const std::string& tmpDir = "");
+
+  private:
+    //Recopy is forbidden!
+    SortMafIterator(const SortMafIterator& iterator);
+    SortMafIterator& operator=(const SortMafIterator& iterator);
+
+  public:
+    virtual ~SortMafIterator();
+
+  public:
+    /**
+     * @brief Set the order of chromosomes, which is otherwise alphabetical.
+     *
+     * Chromosomes not in the list come after all listed ones, in alphabetical order.
+     * This should be called before the iteration starts.
+     * @param chromosomes The chromosomes, in output order.
+     */
+    void setChromosomeOrder(const std::vector<std::string>& chromosomes);
+
+    /**
+     * @return The number of runs written to temporary files.
+     */
+    size_t getNumberOfRuns() const { return nbRuns_; }
+
+  private:
+    MafBlock* analyseCurrentBlock_();
+
+    void getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const;
+
+    Key_ makeKey_(const MafBlock& block) const;
+
+    static bool lessKey_(const std::pair<Key_, MafBlock*>& a, const std::pair<Key_, MafBlock*>& b) {
+      return a.first < b.first;
+    }
+
+    void readInput_();
+
+    /**
+     * @brief Sort the blocks in memory, and write them to a new run.
+     */
+    void writeRun_();
+
+    /**
+     * @brief Add the next block of a run to the heap. The last run is the one remaining in memory.
+     */
+    void readRun_(size_t run);
+
+    void removeRuns_();
+};
+
+} // end of namespace bpp.
+
+#endif //_SORTMAFITERATOR_H_
@@ -0,0 +1,183 @@
+//
+// File: SpscBoundedQueue.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _SPSCBOUNDEDQUEUE_H_
+#define _SPSCBOUNDEDQUEUE_H_
+
+#include <Bpp/Exceptions.h>
+
+//From the STL:
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+namespace bpp {
+
+/**
+ * @brief A bounded single-producer single-consumer queue.
+ *
+ * Elements are stored in a ring buffer, and push/pop operations are lock-free as long
+ * as the queue is neither full nor empty. When one side has to wait, it sleeps on a
+ * condition variable, and is woken up by the other side. The mutex is only taken when
+ * a thread is actually waiting.
+ *
+ * Exactly one thread may push, and exactly one (other) thread may pop.
+ */
+template<class T>
+class SpscBoundedQueue
+{
+  private:
+    std::vector<T> buffer_;
+    size_t capacity_;
+    std::atomic<size_t> head_; //Next position to read
+    std::atomic<size_t> tail_; //Next position to write
+    std::atomic<bool> consumerWaiting_;
+    std::atomic<bool> producerWaiting_;
+    std::atomic<bool> closed_;
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+
+  public:
+    /**
+     * @param capacity The maximum number of elements in the queue.
+     */
+    SpscBoundedQueue(size_t capacity):
+      buffer_(capacity + 1), capacity_(capacity + 1),
+      head_(0), tail_(0),
+      consumerWaiting_(false), producerWaiting_(false), closed_(false),
+      mutex_(), notEmpty_(), notFull_()
+    {
+      if (capacity == 0)
+        throw Exception("SpscBoundedQueue (constructor). Capacity should be at least 1.");
+    }
+
+  private:
+    SpscBoundedQueue(const SpscBoundedQueue&);
+    SpscBoundedQueue& operator=(const SpscBoundedQueue&);
+
+  public:
+    /**
+     * @brief Add an element, waiting for some space if the queue is full.
+     *
+     * @return False if the queue was closed, in which case the element is not added.
+     */
+    bool push(const T& value) {
+      size_t tail = tail_.load(std::memory_order_relaxed);
+      size_t next = (tail + 1) % capacity_;
+      if (next == head_.load()) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        producerWaiting_.store(true);
+        while (next == head_.load() && !closed_.load())
+          notFull_.wait(lock);
+        producerWaiting_.store(false);
+      }
+      if (closed_.load())
+        return false;
+      buffer_[tail] = value;
+      tail_.store(next);
+      if (consumerWaiting_.load()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        notEmpty_.notify_one();
+      }
+      return true;
+    }
+
+    /**
+     * @brief Retrieve an element, waiting for one if the queue is empty.
+     *
+     * @return False if the queue was closed and no element was available.
+     */
+    bool pop(T& value) {
+      size_t head = head_.load(std::memory_order_relaxed);
+      if (head == tail_.load()) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        consumerWaiting_.store(true);
+        while (head == tail_.load() && !closed_.load())
+          notEmpty_.wait(lock);
+        consumerWaiting_.store(false);
+        if (head == tail_.load())
+          return false;
+      }
+      value = buffer_[head];
+      head_.store((head + 1) % capacity_);
+      if (producerWaiting_.load()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        notFull_.notify_one();
+      }
+      return true;
+    }
+
+    /**
+     * @brief Retrieve an element if one is available, without waiting.
+     */
+    bool tryPop(T& value) {
+      size_t head = head_.load(std::memory_order_relaxed);
+      if (head == tail_.load())
+        return false;
+      value = buffer_[head];
+      head_.store((head + 1) % capacity_);
+      if (producerWaiting_.load()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        notFull_.notify_one();
+      }
+      return true;
+    }
+
+    /**
+     * @brief Close the queue: waiting threads are released, and further push operations fail.
+     *
+     * Elements already in the queue can still be popped.
+     */
+    void close() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_.store(true);
+      notEmpty_.notify_all();
+      notFull_.notify_all();
+    }
+
+    bool isClosed() const { return closed_.load(); }
+
+    size_t getCapacity() const { return capacity_ - 1; }
+};
+
+} // end of namespace bpp.
+
+#endif //_SPSCBOUNDEDQUEUE_H_
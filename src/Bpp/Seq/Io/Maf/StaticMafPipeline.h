@@ -0,0 +1,281 @@
+//
+// File: StaticMafPipeline.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _STATICMAFPIPELINE_H_
+#define _STATICMAFPIPELINE_H_
+
+#include "MafIterator.h"
+#include "MafStatistics.h"
+
+//From the STL:
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace bpp {
+
+/**
+ * @brief A pipeline of stages known at compile time, applied to each block in a single loop.
+ *
+ * A stage is any object with a method
+ * @code
+ * bool processBlock(MafBlock& block);
+ * @endcode
+ * which may modify the block, and returns false if the block should be discarded. A stage can also have a method
+ * @code
+ * void finishBlocks();
+ * @endcode
+ * which is called once, after the last block. Several iterators can be used as stages, in which case their input
+ * iterator is not used and can be NULL: SequenceFilterMafIterator, BlockLengthMafIterator, FullGapFilterMafIterator,
+ * and the variant output iterators (VcfOutputMafIterator...). MafStatisticsStage and MafFunctionStage adapt
+ * statistics and functions.
+ *
+ * Stages are called directly, in order, without going through the MafIterator interface: no virtual call,
+ * iteration listener or buffer is involved between them.
+ * The pipeline pulls blocks from a dynamic MafIterator, and can be wrapped in a StaticPipelineMafIterator to feed
+ * a dynamic chain.
+ *
+ * Stages are held by reference, and must outlive the pipeline. Pipelines are usually built with makeStaticPipeline():
+ * @code
+ * SequenceFilterMafIterator seqFilter(0, species);
+ * FullGapFilterMafIterator fullGap(0, species);
+ * VcfOutputMafIterator vcfOut(0, &out, reference, species);
+ * auto pipeline = makeStaticPipeline(&parser, seqFilter, fullGap, vcfOut);
+ * pipeline.run();
+ * @endcode
+ */
+template<class... Stages>
+class StaticMafPipeline
+{
+  private:
+    MafIterator* source_;
+    std::tuple<Stages&...> stages_;
+    size_t nbInputBlocks_;
+    size_t nbOutputBlocks_;
+    bool finished_;
+
+  public:
+    /**
+     * @param source The input iterator.
+     * @param stages The stages, in the order they should be applied.
+     */
+    StaticMafPipeline(MafIterator* source, Stages&... stages):
+      source_(source), stages_(stages...), nbInputBlocks_(0), nbOutputBlocks_(0), finished_(false)
+    {
+      if (!source)
+        throw NullPointerException("StaticMafPipeline (constructor). Input iterator should not be a NULL pointer!");
+    }
+
+  public:
+    /**
+     * @return The next block accepted by all stages, or NULL if the input is exhausted.
+     * Blocks should be given back with recycle().
+     */
+    MafBlock* nextBlock() {
+      if (finished_) return 0;
+      while (MafBlock* block = source_->nextBlock()) {
+        nbInputBlocks_++;
+        if (process_<0>(*block)) {
+          nbOutputBlocks_++;
+          return block;
+        }
+        source_->recycle(block);
+      }
+      finish();
+      return 0;
+    }
+
+    void recycle(MafBlock* block) { source_->recycle(block); }
+
+    /**
+     * @brief Process all blocks, and recycle them.
+     *
+     * @return The number of blocks accepted by all stages.
+     */
+    size_t run() {
+      while (MafBlock* block = nextBlock())
+        source_->recycle(block);
+      return nbOutputBlocks_;
+    }
+
+    /**
+     * @brief Signal the end of the input to all stages.
+     *
+     * This is done automatically when the input is exhausted, and only once.
+     */
+    void finish() {
+      if (finished_) return;
+      finished_ = true;
+      finish_<0>();
+    }
+
+    size_t getNumberOfInputBlocks() const { return nbInputBlocks_; }
+    size_t getNumberOfOutputBlocks() const { return nbOutputBlocks_; }
+
+    /**
+     * @return A given stage.
+     */
+    template<size_t I>
+    typename std::tuple_element<I, std::tuple<Stages...> >::type& getStage() { return std::get<I>(stages_); }
+
+  private:
+    template<size_t I>
+    typename std::enable_if<(I < sizeof...(Stages)), bool>::type process_(MafBlock& block) {
+      return std::get<I>(stages_).processBlock(block) && process_<I + 1>(block);
+    }
+
+    template<size_t I>
+    typename std::enable_if<(I == sizeof...(Stages)), bool>::type process_(MafBlock& block) { return true; }
+
+    template<size_t I>
+    typename std::enable_if<(I < sizeof...(Stages))>::type finish_() {
+      finishStage_(std::get<I>(stages_), 0);
+      finish_<I + 1>();
+    }
+
+    template<size_t I>
+    typename std::enable_if<(I == sizeof...(Stages))>::type finish_() {}
+
+    //Only called if the stage has a finishBlocks method:
+    template<class Stage>
+    static auto finishStage_(Stage& stage, int) -> decltype(stage.finishBlocks(), void()) { stage.finishBlocks(); }
+
+    template<class Stage>
+    static void finishStage_(Stage& stage, long) {}
+};
+
+/**
+ * @brief Build a StaticMafPipeline, deducing the types of its stages.
+ */
+template<class... Stages>
+StaticMafPipeline<Stages...> makeStaticPipeline(MafIterator* source, Stages&... stages)
+{
+  return StaticMafPipeline<Stages...>(source, stages...);
+}
+
+/**
+ * @brief A stage which computes statistics on each block.
+ */
+template<class Statistics>
+class MafStatisticsStage
+{
+  private:
+    Statistics* statistics_;
+
+  public:
+    MafStatisticsStage(Statistics* statistics): statistics_(statistics) {}
+
+  public:
+    /**
+     * @return Always true, as blocks are never discarded.
+     */
+    bool processBlock(MafBlock& block) {
+      //The qualified call is resolved at compile time:
+      statistics_->Statistics::compute(block);
+      return true;
+    }
+
+    Statistics& getStatistics() { return *statistics_; }
+};
+
+template<class Statistics>
+MafStatisticsStage<Statistics> makeStatisticsStage(Statistics* statistics)
+{
+  return MafStatisticsStage<Statistics>(statistics);
+}
+
+/**
+ * @brief A stage calling a function, or any callable object, on each block.
+ *
+ * The function takes a MafBlock& and returns a bool, false if the block should be discarded.
+ */
+template<class Function>
+class MafFunctionStage
+{
+  private:
+    Function function_;
+
+  public:
+    MafFunctionStage(Function function): function_(function) {}
+
+  public:
+    bool processBlock(MafBlock& block) { return function_(block); }
+};
+
+template<class Function>
+MafFunctionStage<Function> makeFunctionStage(Function function)
+{
+  return MafFunctionStage<Function>(function);
+}
+
+/**
+ * @brief Use a StaticMafPipeline as a MafIterator, to feed a dynamic chain of iterators.
+ */
+template<class Pipeline>
+class StaticPipelineMafIterator:
+  public AbstractMafIterator
+{
+  private:
+    Pipeline* pipeline_;
+
+  public:
+    /**
+     * @param pipeline The pipeline, which must outlive the iterator.
+     */
+    StaticPipelineMafIterator(Pipeline* pipeline): pipeline_(pipeline)
+    {
+      if (!pipeline)
+        throw NullPointerException("StaticPipelineMafIterator (constructor). Pipeline should not be a NULL pointer!");
+    }
+
+  private:
+    //Recopy is forbidden!
+    StaticPipelineMafIterator(const StaticPipelineMafIterator& iterator);
+    StaticPipelineMafIterator& operator=(const StaticPipelineMafIterator& iterator);
+
+  public:
+    void recycle(MafBlock* block) { pipeline_->recycle(block); }
+
+  private:
+    MafBlock* analyseCurrentBlock_() { return pipeline_->nextBlock(); }
+};
+
+} // end of namespace bpp.
+
+#endif //_STATICMAFPIPELINE_H_
@@ -42,9 +42,6 @@ knowledge of the CeCILL license and that you accept its terms.
 //From bpp-core:
 #include <Bpp/Text/TextTools.h>
 
-//From bpp-seq:
-#include <Bpp/Seq/SequenceWalker.h>
-
 using namespace bpp;
 
 //From the STL:
@@ -57,14 +54,13 @@ using namespace std;
 void TableOutputMafIterator::writeBlock_(std::ostream& out, const MafBlock& block)
 {
   //Check for reference species for coordinates:
-  unique_ptr<SequenceWalker> walker;
+  const MafSequence* refSeq = 0;
   bool hasCoordinates = block.hasSequenceForSpecies(refSpecies_);
   string chr = "NA";
   string pos = "NA";
   if (hasCoordinates) {
-    const MafSequence& refSeq = block.getSequenceForSpecies(refSpecies_);
-    walker.reset(new SequenceWalker(refSeq));
-    chr = refSeq.getChromosome();
+    refSeq = &block.getSequenceForSpecies(refSpecies_);
+    chr = refSeq->getChromosome();
   }
 
   //Preprocess data:
@@ -74,8 +70,8 @@ void TableOutputMafIterator::writeBlock_(std::ostream& out, const MafBlock& bloc
   } 
   //Loop over all alignment columns:
   for (size_t i = 0; i < block.getNumberOfSites(); ++i) {
-    pos = TextTools::toString(walker->getSequencePosition(i));
     if (hasCoordinates) {
+      pos = TextTools::toString(refSeq->getSequencePosition(i));
       *output_ << chr << "\t" << pos;
     }
     for (const string& seq : seqs) {
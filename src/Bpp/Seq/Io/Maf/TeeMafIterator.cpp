@@ -0,0 +1,166 @@
+//
+// File: TeeMafIterator.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "TeeMafIterator.h"
+
+using namespace bpp;
+
+//From the STL:
+#include <algorithm>
+
+using namespace std;
+
+TeeMafIterator::TeeMafIterator(MafIterator* iterator, size_t nbBranches):
+  iterator_(iterator), branches_(), positions_(nbBranches, 0), closed_(nbBranches, false), nbOpenBranches_(nbBranches),
+  buffer_(), offset_(0), refCounts_(), copies_(), done_(false), mutex_()
+{
+  if (!iterator)
+    throw NullPointerException("TeeMafIterator (constructor). Input iterator should not be a NULL pointer!");
+  if (nbBranches == 0)
+    throw Exception("TeeMafIterator (constructor). At least one branch is required.");
+  for (size_t i = 0; i < nbBranches; ++i)
+    branches_.push_back(unique_ptr<Branch>(new Branch(this, i)));
+}
+
+TeeMafIterator::~TeeMafIterator()
+{
+  for (size_t i = 0; i < branches_.size(); ++i)
+    closeBranch(i);
+}
+
+/******************************************************************************/
+
+MafBlock* TeeMafIterator::nextBlock_(size_t branch)
+{
+  lock_guard<mutex> lock(mutex_);
+  if (closed_[branch])
+    return 0;
+  uint64_t pos = positions_[branch];
+  if (pos - offset_ == buffer_.size()) {
+    //This branch is the first one to request this block:
+    if (done_)
+      return 0;
+    MafBlock* block = iterator_->nextBlock();
+    if (!block) {
+      done_ = true;
+      return 0;
+    }
+    if (refCounts_.find(block) != refCounts_.end())
+      throw Exception("TeeMafIterator::nextBlock. The input iterator returned a block which is still in use.");
+    //Lazy data must be built before other threads can read the block:
+    block->prepareForSharing();
+    refCounts_[block] = nbOpenBranches_;
+    buffer_.push_back(block);
+  }
+  //Each branch gets its own copy, which shares the sequences of the buffered block until it is modified:
+  MafBlock* block = buffer_[static_cast<size_t>(pos - offset_)];
+  unique_ptr<MafBlock> copy(new MafBlock(*block));
+  copies_[copy.get()] = block;
+  positions_[branch]++;
+  trim_();
+  return copy.release();
+}
+
+void TeeMafIterator::release_(MafBlock* block)
+{
+  if (!block) return;
+  {
+    lock_guard<mutex> lock(mutex_);
+    unordered_map<const MafBlock*, MafBlock*>::iterator it = copies_.find(block);
+    if (it == copies_.end()) {
+      //This block was not sent by a branch:
+      iterator_->recycle(block);
+      return;
+    }
+    unref_(it->second);
+    copies_.erase(it);
+  }
+  MafBlockPool::getDefaultPool().recycle(block);
+}
+
+void TeeMafIterator::unref_(MafBlock* block)
+{
+  unordered_map<const MafBlock*, size_t>::iterator it = refCounts_.find(block);
+  if (it == refCounts_.end()) {
+    //This block was not created by the input iterator:
+    iterator_->recycle(block);
+    return;
+  }
+  if (--it->second == 0) {
+    refCounts_.erase(it);
+    iterator_->recycle(block);
+  }
+}
+
+void TeeMafIterator::trim_()
+{
+  //Blocks sent to all open branches do not need to be buffered anymore:
+  uint64_t first = offset_ + buffer_.size();
+  for (size_t i = 0; i < positions_.size(); ++i)
+    if (!closed_[i])
+      first = min(first, positions_[i]);
+  while (offset_ < first) {
+    buffer_.pop_front();
+    offset_++;
+  }
+}
+
+void TeeMafIterator::closeBranch(size_t i)
+{
+  if (i >= branches_.size())
+    throw IndexOutOfBoundsException("TeeMafIterator::closeBranch.", i, 0, branches_.size() - 1);
+  lock_guard<mutex> lock(mutex_);
+  if (closed_[i]) return;
+  for (uint64_t pos = positions_[i]; pos < offset_ + buffer_.size(); ++pos)
+    unref_(buffer_[static_cast<size_t>(pos - offset_)]);
+  closed_[i] = true;
+  nbOpenBranches_--;
+  trim_();
+}
+
+void TeeMafIterator::getBufferContent_(size_t branch, size_t& nbBlocks, uint64_t& nbBytes) const
+{
+  lock_guard<mutex> lock(mutex_);
+  if (closed_[branch]) return;
+  for (uint64_t pos = positions_[branch]; pos < offset_ + buffer_.size(); ++pos) {
+    nbBlocks++;
+    nbBytes += buffer_[static_cast<size_t>(pos - offset_)]->getMemorySize();
+  }
+}
+
@@ -0,0 +1,174 @@
+//
+// File: TeeMafIterator.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _TEEMAFITERATOR_H_
+#define _TEEMAFITERATOR_H_
+
+#include "MafIterator.h"
+
+//From the STL:
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace bpp {
+
+/**
+ * @brief Send the blocks of one iterator to several branches, without copying their sequences.
+ *
+ * Each branch is an iterator, which outputs all blocks of the input in the same order, and can be used as the
+ * input of an independent chain of filters and outputs. Each branch gets its own copy of a block, which shares
+ * the sequences of the input block until it is modified (see MafBlock::detach): a block is counted once per branch,
+ * and is recycled in the input iterator when the copies of all branches have been recycled.
+ * Blocks already read by some branches but not by the others are kept in a buffer: branches can be pulled in any
+ * order, but the buffer grows as long as a branch lags behind. Buffer limits can be set on each branch
+ * (see AbstractMafIterator::setBufferLimits) to detect a branch which is never pulled, and a branch which is
+ * not needed anymore should be closed.
+ *
+ * Downstream iterators can modify the blocks of their branch in place, but must give them back with recycle()
+ * instead of deleting them. Branches can be pulled from different threads: blocks are prepared for sharing
+ * (see MafBlock::prepareForSharing) before they are copied for any branch.
+ */
+class TeeMafIterator
+{
+  public:
+    class Branch:
+      public AbstractMafIterator
+    {
+      private:
+        TeeMafIterator* tee_;
+        size_t index_;
+
+      public:
+        Branch(TeeMafIterator* tee, size_t index): tee_(tee), index_(index) {}
+
+      private:
+        //Recopy is forbidden!
+        Branch(const Branch& branch);
+        Branch& operator=(const Branch& branch);
+
+      public:
+        void recycle(MafBlock* block) { tee_->release_(block); }
+
+      private:
+        MafBlock* analyseCurrentBlock_() { return tee_->nextBlock_(index_); }
+
+        void getBufferContent_(size_t& nbBlocks, uint64_t& nbBytes) const {
+          tee_->getBufferContent_(index_, nbBlocks, nbBytes);
+        }
+    };
+
+  private:
+    MafIterator* iterator_;
+    std::vector< std::unique_ptr<Branch> > branches_;
+    std::vector<uint64_t> positions_;
+    std::vector<bool> closed_;
+    size_t nbOpenBranches_;
+    std::deque<MafBlock*> buffer_;
+    uint64_t offset_; //The position of the first buffered block in the input.
+    std::unordered_map<const MafBlock*, size_t> refCounts_;
+    std::unordered_map<const MafBlock*, MafBlock*> copies_; //Copies sent to the branches, and their input block.
+    bool done_;
+    mutable std::mutex mutex_;
+
+  public:
+    /**
+     * @param iterator The input iterator.
+     * @param nbBranches The number of branches.
+     */
+    TeeMafIterator(MafIterator* iterator, size_t nbBranches);
+
+  private:
+    //Recopy is forbidden!
+    TeeMafIterator(const TeeMafIterator& tee);
+    TeeMafIterator& operator=(const TeeMafIterator& tee);
+
+  public:
+    /**
+     * @brief Close all branches, and recycle the blocks which are only held by the tee.
+     *
+     * Blocks still used downstream should be recycled before the tee is destroyed.
+     */
+    virtual ~TeeMafIterator();
+
+  public:
+    size_t getNumberOfBranches() const { return branches_.size(); }
+
+    /**
+     * @return The iterator for a given branch, which is owned by the tee.
+     */
+    AbstractMafIterator* getBranch(size_t i) {
+      if (i >= branches_.size())
+        throw IndexOutOfBoundsException("TeeMafIterator::getBranch.", i, 0, branches_.size() - 1);
+      return branches_[i].get();
+    }
+
+    /**
+     * @brief Stop sending blocks to a branch.
+     *
+     * Blocks buffered for this branch are released, and the branch outputs no more block.
+     */
+    void closeBranch(size_t i);
+
+    /**
+     * @return The number of blocks read but not yet sent to all open branches.
+     */
+    size_t getNumberOfBufferedBlocks() const {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return buffer_.size();
+    }
+
+  private:
+    MafBlock* nextBlock_(size_t branch);
+
+    void release_(MafBlock* block);
+
+    //Must be called with the mutex locked:
+    void unref_(MafBlock* block);
+
+    void trim_();
+
+    void getBufferContent_(size_t branch, size_t& nbBlocks, uint64_t& nbBytes) const;
+};
+
+} // end of namespace bpp.
+
+#endif //_TEEMAFITERATOR_H_
@@ -42,9 +42,6 @@ knowledge of the CeCILL license and that you accept its terms.
 //From bpp-seq:
 #include <Bpp/Seq/SequenceWithAnnotationTools.h>
 #include <Bpp/Seq/SequenceWithQuality.h>
-#include <Bpp/Seq/Container/VectorSiteContainer.h>
-#include <Bpp/Seq/SiteTools.h>
-#include <Bpp/Seq/SequenceWalker.h>
 
 using namespace bpp;
 
@@ -55,19 +52,34 @@ using namespace bpp;
 
 using namespace std;
 
-void VcfOutputMafIterator::writeHeader_(std::ostream& out) const
+vector< vector<string> > AbstractVariantOutputMafIterator::toCombinations_(const std::vector<std::string>& genotypes)
 {
+  vector< vector<string> > combinations;
+  for (auto g: genotypes) {
+    vector<string> tmp;
+    tmp.push_back(g);
+    combinations.push_back(tmp);
+  }
+  return combinations;
+}
+
+void AbstractVariantOutputMafIterator::writeVcfHeader_(std::ostream& out, const std::vector<std::string>& contigs) const
+{
+  //Dictionary indices, only written when contigs are provided (BCF):
+  bool idx = contigs.size() > 0;
   time_t t = time(0); // get current time
   struct tm* ct = localtime(&t);
-  out << "##fileformat=VCFv4.0" << endl;
+  out << (idx ? "##fileformat=VCFv4.2" : "##fileformat=VCFv4.0") << endl;
   out << "##fileDate=" << (ct->tm_year + 1900) << (ct->tm_mon + 1) << ct->tm_mday << endl;
   out << "##source=Bio++" << endl;  
-  out << "##FILTER=<ID=PASS,Description=\"All filters passed\">" << endl;
-  out << "##FILTER=<ID=gap,Description=\"At least one sequence contains a gap\">" << endl;
-  out << "##FILTER=<ID=unk,Description=\"At least one sequence contains an unresolved character\">" << endl;
+  out << "##FILTER=<ID=PASS,Description=\"All filters passed\"" << (idx ? ",IDX=0>" : ">") << endl;
+  out << "##FILTER=<ID=gap,Description=\"At least one sequence contains a gap\"" << (idx ? ",IDX=1>" : ">") << endl;
+  out << "##FILTER=<ID=unk,Description=\"At least one sequence contains an unresolved character\"" << (idx ? ",IDX=2>" : ">") << endl;
   if (genotypes_.size() > 0)
-    out << "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\">" << endl;
-  out << "##INFO=<ID=AC,Number=A,Type=Integer,Description=\"Total number of alternate alleles in called genotypes\">" << endl;
+    out << "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\"" << (idx ? ",IDX=4>" : ">") << endl;
+  out << "##INFO=<ID=AC,Number=A,Type=Integer,Description=\"Total number of alternate alleles in called genotypes\"" << (idx ? ",IDX=3>" : ">") << endl;
+  for (size_t i = 0; i < contigs.size(); ++i)
+    out << "##contig=<ID=" << contigs[i] << ",IDX=" << i << ">" << endl;
   //There are more options in the header that we may want to support...
 
   //Now write the header line:
@@ -87,92 +99,163 @@ void VcfOutputMafIterator::writeHeader_(std::ostream& out) const
   out << endl;
 }
 
-void VcfOutputMafIterator::writeBlock_(std::ostream& out, const MafBlock& block) const
+MafBlock* AbstractVariantOutputMafIterator::analyseCurrentBlock_()
+{
+  currentBlock_ = iterator_->nextBlock();
+  if (hasOutput_()) {
+    if (currentBlock_) {
+      analyseBlock_(*currentBlock_);
+      endOfBlock_();
+    } else {
+      endOfInput_(); //No more block.
+    }
+  }
+  return currentBlock_;
+}
+
+void AbstractVariantOutputMafIterator::analyseBlock_(const MafBlock& block)
 {
   const MafSequence& refSeq = block.getSequenceForSpecies(refSpecies_);
-  string chr = refSeq.getChromosome();
-  SequenceWalker walker(refSeq);
-  size_t offset = refSeq.start();
-  int gap = refSeq.getAlphabet()->getGapCharacterCode();
-  map<int, string> chars;
-  for (int i = 0; i < static_cast<int>(AlphabetTools::DNA_ALPHABET.getNumberOfTypes()); ++i)
-    chars[i] = AlphabetTools::DNA_ALPHABET.intToChar(i);
-  VectorSiteContainer sites(block.getAlignment());
-  //Where to store genotype information, if any:
-  vector<int> gt(genotypes_.size());
-  //Now we look all sites for SNPs:
-  for (size_t i = 0; i < sites.getNumberOfSites(); i++) {
-    if (refSeq[i] == gap)
+  size_t nbSites = block.getNumberOfSites();
+  int unknown = AlphabetTools::DNA_ALPHABET.getUnknownCharacterCode();
+
+  //States of all sequences are counted once for the whole block:
+  rows_.clear();
+  for (size_t j = 0; j < block.getNumberOfSequences(); ++j)
+    rows_.push_back(&block.getSequence(j).getContent());
+  counts_.compute(rows_, nbSites);
+
+  //Genotype sequences are resolved once for the whole block, missing ones being null:
+  genotypeRows_.clear();
+  genotypeOffsets_.clear();
+  for (size_t g = 0; g < genotypes_.size(); ++g) {
+    genotypeOffsets_.push_back(genotypeRows_.size());
+    for (size_t k = 0; k < genotypes_[g].size(); ++k) {
+      vector<const MafSequence*> sequences = block.getSequencesForSpecies(genotypes_[g][k]);
+      if (sequences.size() > 1)
+        throw Exception("AbstractVariantOutputMafIterator::analyseBlock_(). Duplicated sequence for species '" + genotypes_[g][k] + "'.");
+      genotypeRows_.push_back(sequences.size() == 0 ? 0 : &sequences[0]->getContent());
+    }
+  }
+
+  Variant_ variant;
+  variant.chromosome = &refSeq.getChromosome();
+  variant.position = refSeq.start(); //Position in the reference sequence, before the current site.
+  const vector<int>& ref = refSeq.getContent();
+  for (size_t i = 0; i < nbSites; ++i) {
+    int r = ref[i];
+    if (r < 0) //Gap in the reference
       continue;
-    string filter = "";
-    if (SiteTools::hasGap(sites.getSite(i))) {
-      filter = "gap";
+    variant.position++;
+    const unsigned int* counts = counts_.getCounts(i);
+    unsigned int nbAlt = 0;
+    for (int x = 0; x < 4; ++x) {
+      variant.alleles[x] = (x != r && counts[x + 1] > 0) ? static_cast<int>(++nbAlt) : 0;
     }
-    if (SiteTools::hasUnknown(sites.getSite(i))) {
-      if (filter != "")
-        filter += ";";
-      filter += "unk";
+    if (nbAlt == 0 && !outputAll_)
+      continue;
+    variant.site = i;
+    variant.reference = r;
+    variant.nbAlt = nbAlt;
+    variant.counts = counts;
+    variant.hasGap = counts[0] > 0;
+    variant.hasUnknown = counts[unknown + 1] > 0;
+    writeVariant_(variant);
+  }
+}
+
+void AbstractVariantOutputMafIterator::getGenotype_(const Variant_& variant, size_t g, std::vector<int>& alleles) const
+{
+  alleles.clear();
+  size_t k = genotypeOffsets_[g];
+  for (size_t h = 0; h < genotypes_[g].size(); ++h, ++k) {
+    const vector<int>* row = genotypeRows_[k];
+    int state = row ? (*row)[variant.site] : -1;
+    //Missing sequence, gap or unresolved character:
+    int allele = (state < 0 || state > 3) ? -1 : variant.alleles[state];
+    alleles.push_back(allele);
+    if (generateDiploids_)
+      alleles.push_back(allele);
+  }
+}
+
+/******************************************************************************/
+
+const size_t VcfOutputMafIterator::BUFFER_SIZE = 1 << 20;
+
+void VcfOutputMafIterator::flush()
+{
+  if (output_ && buffer_.size() > 0) {
+    output_->write(buffer_.data(), static_cast<streamsize>(buffer_.size()));
+    output_->flush();
+  }
+  buffer_.clear();
+}
+
+void VcfOutputMafIterator::appendNumber_(std::string& buffer, size_t n)
+{
+  char tmp[24];
+  size_t i = sizeof(tmp);
+  do {
+    tmp[--i] = static_cast<char>('0' + n % 10);
+    n /= 10;
+  } while (n > 0);
+  buffer.append(tmp + i, sizeof(tmp) - i);
+}
+
+void VcfOutputMafIterator::writeVariant_(const Variant_& variant)
+{
+  const string& chars = ColumnCounts::getCharacters();
+  buffer_.append(*variant.chromosome);
+  buffer_ += '\t';
+  appendNumber_(buffer_, variant.position);
+  buffer_.append("\t.\t");
+  buffer_ += chars[static_cast<size_t>(variant.reference + 1)];
+  buffer_ += '\t';
+  bool first = true;
+  for (int x = 0; x < 4; ++x) {
+    if (variant.alleles[x] > 0) {
+      if (!first) buffer_ += ',';
+      buffer_ += chars[static_cast<size_t>(x + 1)];
+      first = false;
     }
-    if (filter == "")
-      filter = "PASS";
-      
-    map<int, size_t> counts;
-    SiteTools::getCounts(sites.getSite(i), counts);
-    int ref = refSeq[i];
-    string alt = "";
-    string ac = "";
-    
-    map<int, int> snps;
-    int c = 0;
+  }
+  buffer_.append("\t.\t");
+  if (variant.hasGap)
+    buffer_.append(variant.hasUnknown ? "gap;unk" : "gap");
+  else
+    buffer_.append(variant.hasUnknown ? "unk" : "PASS");
+  buffer_.append("\tAC=");
+  if (variant.nbAlt == 0) {
+    appendNumber_(buffer_, variant.counts[variant.reference + 1]);
+  } else {
+    first = true;
     for (int x = 0; x < 4; ++x) {
-      if (x != ref) {
-        size_t f = counts[x];
-        if (f > 0) {
-          if (alt != "") {
-            alt += ",";
-            ac += ",";
-          }
-          alt += chars[x];
-          ac += TextTools::toString(f);
-          snps[x] = ++c;
-        }
-      } else {
-        snps[x] = 0;
+      if (variant.alleles[x] > 0) {
+        if (!first) buffer_ += ',';
+        appendNumber_(buffer_, variant.counts[x + 1]);
+        first = false;
       }
     }
-    if (ac == "" && outputAll_) {
-      ac = TextTools::toString(counts[ref]);
-    }
-    if (ac != "") {
-      out << chr << "\t" << (offset + walker.getSequencePosition(i) + 1) << "\t.\t" << chars[refSeq[i]] << "\t" << alt << "\t.\t" << filter << "\tAC=" << ac;
-      //Write genotpyes:
-      if (genotypes_.size() > 0) {
-        out << "\tGT";
-        for (size_t g = 0; g < genotypes_.size(); ++g) {
-          string geno = "";
-          for (auto x: genotypes_[g]) {
-            if (geno != "") geno += "|"; //Polyploid
-            vector<const MafSequence*> sequences = block.getSequencesForSpecies(x);
-            if (sequences.size() == 0)
-              geno += (generateDiploids_ ? ".|." : ".");
-            else if (sequences.size() > 1)
-              throw Exception("VcfOutputMafIterator::writeBlock(). Duplicated sequence for species '" + x + "'.");
-            else {
-              int state = (*sequences[0])[i];
-              if (AlphabetTools::DNA_ALPHABET.isGap(state) || AlphabetTools::DNA_ALPHABET.isUnresolved(state))
-                geno += (generateDiploids_ ? ".|." : ".");
-              else { 
-                geno += TextTools::toString(snps[state]);
-                if (generateDiploids_) 
-                  geno += geno +  "|" + TextTools::toString(snps[state]);
-              }
-            }
-          }
-          out << "\t" << geno;
-        }
+  }
+  //Write genotypes:
+  if (genotypes_.size() > 0) {
+    buffer_.append("\tGT");
+    for (size_t g = 0; g < genotypes_.size(); ++g) {
+      buffer_ += '\t';
+      getGenotype_(variant, g, genotype_);
+      for (size_t h = 0; h < genotype_.size(); ++h) {
+        if (h > 0) buffer_ += '|'; //Polyploid
+        buffer_ += (genotype_[h] < 0 ? '.' : static_cast<char>('0' + genotype_[h]));
       }
-      out << endl;
     }
   }
+  buffer_ += '\n';
+}
+
+void VcfOutputMafIterator::endOfBlock_()
+{
+  if (buffer_.size() >= BUFFER_SIZE)
+    flush();
 }
 
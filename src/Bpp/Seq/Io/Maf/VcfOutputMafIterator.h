@@ -37,33 +37,201 @@ The fact that you are presently reading this means that you have had
 knowledge of the CeCILL license and that you accept its terms.
 */
 
+
 #ifndef _VCFOUTPUTMAFITERATOR_H_
 #define _VCFOUTPUTMAFITERATOR_H_
 
 #include "MafIterator.h"
+#include "ColumnCounts.h"
+#include "MafCheckpoint.h"
 
 //From the STL:
 #include <iostream>
 #include <string>
+#include <vector>
 #include <deque>
 
 namespace bpp {
 
 /**
- * @brief This iterator performs a simple SNP call from the MAF blocks, and outputs the results in the Variant Call Format (VCF).
+ * @brief Base class for iterators performing a simple SNP call from the MAF blocks.
+ *
+ * This class implements the variant detection logic shared by the VCF and BCF writers.
+ * States are counted once per block for all columns, and genotype sequences are resolved once per block.
+ * Each site which is not a gap in the reference sequence and shows at least one alternative allele
+ * (or all sites, if outputAll is true) is passed to the writeVariant_ method.
  *
  * Only substitutions are supported for now.
  */
-class VcfOutputMafIterator:
+class AbstractVariantOutputMafIterator:
   public AbstractFilterMafIterator
 {
-  private:
-    std::ostream* output_;
+  protected:
+    /**
+     * @brief A variable site, as passed to writers.
+     */
+    struct Variant_
+    {
+      const std::string* chromosome;
+      size_t site; //Position in the alignment.
+      size_t position; //Position in the reference sequence, 1-based.
+      int reference; //State of the reference, from 0 to 14.
+      unsigned int nbAlt; //Number of alternative alleles.
+      int alleles[4]; //Index of each nucleotide in the list of alleles, 0 for the reference or absent nucleotides.
+      const unsigned int* counts; //State counts at this site, gaps first, as returned by ColumnCounts.
+      bool hasGap;
+      bool hasUnknown;
+    };
+
+  protected:
     std::string refSpecies_;
     std::vector<std::vector<std::string> >genotypes_;
     bool outputAll_;
     bool generateDiploids_;
 
+  private:
+    std::vector<const std::vector<int>*> rows_;
+    std::vector<const std::vector<int>*> genotypeRows_;
+    std::vector<size_t> genotypeOffsets_; //Index of the first row of each genotype in genotypeRows_.
+    ColumnCounts counts_;
+
+  public:
+    /**
+     * @param iterator The input iterator.
+     * @param reference The species to use as a reference.
+     * @param genotypes A list of species combinations for which genotype information should be written.
+     * @param outputAll If true, also output non-variable positions.
+     * @param generateDiploids If true, output artificial "homozygous" diploids.
+     */
+    AbstractVariantOutputMafIterator(MafIterator* iterator, const std::string& reference, const std::vector< std::vector<std::string> >& genotypes, bool outputAll, bool generateDiploids) :
+      AbstractFilterMafIterator(iterator), refSpecies_(reference), genotypes_(genotypes), outputAll_(outputAll), generateDiploids_(generateDiploids),
+      rows_(), genotypeRows_(), genotypeOffsets_(), counts_()
+    {}
+
+  protected:
+    AbstractVariantOutputMafIterator(const AbstractVariantOutputMafIterator& iterator) :
+      AbstractFilterMafIterator(0),
+      refSpecies_(iterator.refSpecies_),
+      genotypes_(iterator.genotypes_),
+      outputAll_(iterator.outputAll_),
+      generateDiploids_(iterator.generateDiploids_),
+      rows_(),
+      genotypeRows_(),
+      genotypeOffsets_(),
+      counts_()
+    {}
+    
+    AbstractVariantOutputMafIterator& operator=(const AbstractVariantOutputMafIterator& iterator)
+    {
+      refSpecies_ = iterator.refSpecies_;
+      genotypes_ = iterator.genotypes_;
+      outputAll_ = iterator.outputAll_;
+      generateDiploids_ = iterator.generateDiploids_;
+      return *this;
+    }
+
+  public:
+    virtual ~AbstractVariantOutputMafIterator() {}
+
+  public:
+    MafBlock* analyseCurrentBlock_();
+
+    /**
+     * @brief Write the variants of a block which is not pulled from the input iterator, as a stage of a StaticMafPipeline.
+     *
+     * @return Always true, as blocks are never discarded.
+     */
+    bool processBlock(MafBlock& block) {
+      if (hasOutput_()) {
+        analyseBlock_(block);
+        endOfBlock_();
+      }
+      return true;
+    }
+
+    /**
+     * @brief Signal the end of the input, when used as a stage of a StaticMafPipeline.
+     */
+    void finishBlocks() {
+      if (hasOutput_())
+        endOfInput_();
+    }
+
+  protected:
+    /**
+     * @return False if there is nothing to write, in which case blocks are not analysed.
+     */
+    virtual bool hasOutput_() const { return true; }
+
+    /**
+     * @brief Write one variant.
+     */
+    virtual void writeVariant_(const Variant_& variant) = 0;
+
+    /**
+     * @brief Called after all variants of a block have been written.
+     */
+    virtual void endOfBlock_() {}
+
+    /**
+     * @brief Called once, when the input iterator is exhausted.
+     */
+    virtual void endOfInput_() {}
+
+    /**
+     * @return The number of haploid genotypes in a genotype column, that is twice the number of species in case artificial diploids are generated.
+     * @param g The genotype column.
+     */
+    size_t getPloidy_(size_t g) const {
+      return genotypes_[g].size() * (generateDiploids_ ? 2 : 1);
+    }
+
+    /**
+     * @brief Get the alleles of a genotype at the current variant.
+     *
+     * @param variant The current variant.
+     * @param g The genotype column.
+     * @param alleles [out] A vector of getPloidy_(g) allele indices. Missing alleles (missing sequence, gap or unresolved character) are coded as -1.
+     */
+    void getGenotype_(const Variant_& variant, size_t g, std::vector<int>& alleles) const;
+
+    /**
+     * @brief Write the VCF header text.
+     *
+     * @param out The output stream.
+     * @param contigs If not empty, a list of contigs to declare in the header, and dictionary indices are added to all header lines, as required by BCF.
+     */
+    void writeVcfHeader_(std::ostream& out, const std::vector<std::string>& contigs) const;
+
+    static std::vector< std::vector<std::string> > toCombinations_(const std::vector<std::string>& genotypes);
+
+  private:
+    void analyseBlock_(const MafBlock& block);
+};
+
+/**
+ * @brief This iterator performs a simple SNP call from the MAF blocks, and outputs the results in the Variant Call Format (VCF).
+ *
+ * Only substitutions are supported for now.
+ *
+ * Lines are formatted into an internal buffer, which is written to the output stream by large chunks.
+ * The buffer is flushed when the input iterator is exhausted and when the iterator is destroyed.
+ */
+class VcfOutputMafIterator:
+  public AbstractVariantOutputMafIterator,
+  public virtual CheckpointableMafIterator
+{
+  public:
+    /**
+     * @brief Size of the output buffer, in characters, above which it is written to the stream.
+     */
+    static const size_t BUFFER_SIZE;
+
+  private:
+    std::ostream* output_;
+    std::string buffer_;
+    std::vector<int> genotype_;
+
   public:
     /**
      * @brief Build a new VcfOutputMafIterator object.
@@ -76,15 +244,11 @@ class VcfOutputMafIterator:
      * @param generateDiploids If true, output artificial "homozygous" diploids.
      */
     VcfOutputMafIterator(MafIterator* iterator, std::ostream* out, const std::string& reference, const std::vector<std::string>& genotypes, bool outputAll = false, bool generateDiploids = false) :
-      AbstractFilterMafIterator(iterator), output_(out), refSpecies_(reference), genotypes_(), outputAll_(outputAll), generateDiploids_(generateDiploids)
+      AbstractVariantOutputMafIterator(iterator, reference, toCombinations_(genotypes), outputAll, generateDiploids),
+      output_(out), buffer_(), genotype_()
     {
-      for (auto g: genotypes) {
-        std::vector<std::string> tmp;
-        tmp.push_back(g);
-        genotypes_.push_back(tmp);
-      }
       if (output_)
-        writeHeader_(*output_);
+        writeVcfHeader_(*output_, std::vector<std::string>());
     }
 
     /**
@@ -95,46 +259,57 @@ class VcfOutputMafIterator:
      * @param reference The species to use as a reference.
      * @param genotypes A list of species combinations for which genotype information should be written in the VCF file. There will be one extra column per genotype, +1 format column. When more than one sequence is specified in a combination, a (phased) polyploid genotype will be created.
      * @param outputAll If true, also output non-variable positions.
+     * @param generateDiploids If true, output artificial "homozygous" diploids.
      */
     VcfOutputMafIterator(MafIterator* iterator, std::ostream* out, const std::string& reference, const std::vector< std::vector<std::string> >& genotypes, bool outputAll = false, bool generateDiploids = false) :
-      AbstractFilterMafIterator(iterator), output_(out), refSpecies_(reference), genotypes_(genotypes), outputAll_(outputAll), generateDiploids_(false)
+      AbstractVariantOutputMafIterator(iterator, reference, genotypes, outputAll, generateDiploids),
+      output_(out), buffer_(), genotype_()
     {
       if (output_)
-        writeHeader_(*output_);
+        writeVcfHeader_(*output_, std::vector<std::string>());
     }
 
   private:
     VcfOutputMafIterator(const VcfOutputMafIterator& iterator) :
-      AbstractFilterMafIterator(0),
+      AbstractVariantOutputMafIterator(iterator),
       output_(iterator.output_),
-      refSpecies_(iterator.refSpecies_),
-      genotypes_(iterator.genotypes_),
-      outputAll_(iterator.outputAll_),
-      generateDiploids_(iterator.generateDiploids_)
+      buffer_(),
+      genotype_()
     {}
     
     VcfOutputMafIterator& operator=(const VcfOutputMafIterator& iterator)
     {
+      AbstractVariantOutputMafIterator::operator=(iterator);
       output_ = iterator.output_;
-      refSpecies_ = iterator.refSpecies_;
-      genotypes_ = iterator.genotypes_;
-      outputAll_ = iterator.outputAll_;
-      generateDiploids_ = iterator.generateDiploids_;
+      buffer_.clear();
       return *this;
     }
 
-
   public:
-    MafBlock* analyseCurrentBlock_() {
-      currentBlock_ = iterator_->nextBlock();
-      if (output_ && currentBlock_)
-        writeBlock_(*output_, *currentBlock_);
-      return currentBlock_;
+    virtual ~VcfOutputMafIterator()
+    {
+      flush();
     }
 
+    /**
+     * @brief Write the content of the output buffer to the stream.
+     */
+    void flush();
+
+    /**
+     * @brief Flush the output. Variant calling keeps no state between blocks.
+     */
+    void saveState(MafCheckpoint& checkpoint, const std::string& prefix) { flush(); }
+    void restoreState(const MafCheckpoint& checkpoint, const std::string& prefix) { buffer_.clear(); }
+
+  protected:
+    bool hasOutput_() const { return output_ != 0; }
+    void writeVariant_(const Variant_& variant);
+    void endOfBlock_();
+    void endOfInput_() { flush(); }
+
   private:
-    void writeHeader_(std::ostream& out) const;
-    void writeBlock_(std::ostream& out, const MafBlock& block) const;
+    static void appendNumber_(std::string& buffer, size_t n);
 };
 
 } // end of namespace bpp.
@@ -52,9 +52,9 @@ const short WindowSplitMafIterator::RAGGED_RIGHT = 1;
 const short WindowSplitMafIterator::CENTER = 2;
 const short WindowSplitMafIterator::ADJUST= 3;
 
-MafBlock* WindowSplitMafIterator::analyseCurrentBlock_()
+MafBlock* WindowSplitMafIterator::splitNextBlock_()
 {
-  while (blockBuffer_.size() == 0) {
+  while (viewBuffer_.size() == 0) {
     //Build a new series of windows:
     MafBlock* block = iterator_->nextBlock();
     if (!block) return 0; //No more block.
@@ -73,11 +73,14 @@ MafBlock* WindowSplitMafIterator::analyseCurrentBlock_()
         }               
       default             : { }
     }
+    //A small block does not contain any window:
+    if (align_ == ADJUST && keepSmallBlocks_ && bSize < windowSize_)
+      return block;
+
+    //Windows share the input block, which is recycled by the input iterator when the last window is released:
+    std::shared_ptr<const MafBlock> parent = MafBlockView::share(block, iterator_);
     //cout << "Effective size: " << size << endl;
     for(size_t i = pos; i + size <= bSize; i += size) {
-      MafBlock* newBlock = new MafBlock();
-      newBlock->setScore(block->getScore());
-      newBlock->setPass(block->getPass());
       if (align_ == ADJUST) {
         if (bSize - (i + size) > 0 && bSize - (i + size) < size) {
           //cout << "Old size: " << size;
@@ -86,22 +89,9 @@ MafBlock* WindowSplitMafIterator::analyseCurrentBlock_()
           //cout << " => new size: " << size << endl;
         }
       }
-      for (size_t j = 0; j < block->getNumberOfSequences(); ++j) {
-        unique_ptr<MafSequence> subseq(block->getSequence(j).subSequence(i, size));
-        newBlock->addSequence(*subseq);
-      }
-      blockBuffer_.push_back(newBlock);
-    }
-    
-    if (align_ == ADJUST && keepSmallBlocks_ && bSize < windowSize_) {
-      blockBuffer_.push_back(block);
-    } else {
-      delete block;
+      viewBuffer_.push_back(MafBlockView(parent, i, size));
     }
   }
- 
-  MafBlock* nxtBlock = blockBuffer_.front();
-  blockBuffer_.pop_front();
-  return nxtBlock;
+  return 0;
 }
 
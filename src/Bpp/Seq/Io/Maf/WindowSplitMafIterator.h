@@ -51,14 +51,15 @@ namespace bpp {
 
 /**
  * @brief Splits block into windows of given sizes.
+ *
+ * Windows are views of the input blocks (see MafIterator::nextBlockView), which are only copied when retrieved with nextBlock().
  */
 class WindowSplitMafIterator:
-  public AbstractFilterMafIterator
+  public AbstractSplitMafIterator
 {
   private:
     size_t windowSize_;
     short align_;
-    std::deque<MafBlock*> blockBuffer_;
     bool keepSmallBlocks_;
 
   public:
@@ -69,8 +70,8 @@ class WindowSplitMafIterator:
 
   public:
     WindowSplitMafIterator(MafIterator* iterator, size_t windowSize, short splitOption = CENTER, bool keepSmallBlocks = false):
-      AbstractFilterMafIterator(iterator),
-      windowSize_(windowSize), align_(splitOption), blockBuffer_(), keepSmallBlocks_(keepSmallBlocks)
+      AbstractSplitMafIterator(iterator),
+      windowSize_(windowSize), align_(splitOption), keepSmallBlocks_(keepSmallBlocks)
     {
       if (splitOption != RAGGED_LEFT && splitOption != RAGGED_RIGHT
           && splitOption != CENTER && splitOption != ADJUST)
@@ -78,7 +79,7 @@ class WindowSplitMafIterator:
     }
 
   private:
-    MafBlock* analyseCurrentBlock_();
+    MafBlock* splitNextBlock_();
 
 };
 
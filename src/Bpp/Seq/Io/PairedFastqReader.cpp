@@ -0,0 +1,312 @@
+//
+// File: PairedFastqReader.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "PairedFastqReader.h"
+#include "CompressedInput.h"
+
+//From bpp-core:
+#include <Bpp/Text/TextTools.h>
+
+//From the STL:
+#include <algorithm>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+PairedFastqReader::PairedFastqReader(const string& path1, const string& path2, const Alphabet* alphabet,
+    size_t batchSize, unsigned int nbThreads, bool checkNames):
+  PairedFastqReader(new CompressedLineReader(path1, nbThreads), new CompressedLineReader(path2, nbThreads), alphabet, batchSize, nbThreads, checkNames)
+{}
+
+PairedFastqReader::PairedFastqReader(const string& path, const Alphabet* alphabet,
+    size_t batchSize, unsigned int nbThreads, bool checkNames):
+  PairedFastqReader(new CompressedLineReader(path, nbThreads), alphabet, batchSize, nbThreads, checkNames)
+{}
+
+PairedFastqReader::PairedFastqReader(LineReader* input1, LineReader* input2, const Alphabet* alphabet,
+    size_t batchSize, unsigned int nbThreads, bool checkNames):
+  alphabet_(alphabet), batchSize_(batchSize), interleaved_(false), checkNames_(checkNames),
+  inputs_(), chunks_(), inputDone_(), inputError_(), inFlight_(), nbPairs_(0), nbQueuedPairs_(0),
+  maxChunks_(0), maxInFlight_(0), stop_(false), threads_(), mutex_(),
+  chunkAvailable_(), spaceAvailable_(), jobDone_()
+{
+  inputs_[0].reset(input1);
+  inputs_[1].reset(input2);
+  if (!input1 || !input2)
+    throw NullPointerException("PairedFastqReader (constructor). Line readers should not be NULL pointers!");
+  start_(nbThreads);
+}
+
+PairedFastqReader::PairedFastqReader(LineReader* input, const Alphabet* alphabet,
+    size_t batchSize, unsigned int nbThreads, bool checkNames):
+  alphabet_(alphabet), batchSize_(batchSize), interleaved_(true), checkNames_(checkNames),
+  inputs_(), chunks_(), inputDone_(), inputError_(), inFlight_(), nbPairs_(0), nbQueuedPairs_(0),
+  maxChunks_(0), maxInFlight_(0), stop_(false), threads_(), mutex_(),
+  chunkAvailable_(), spaceAvailable_(), jobDone_()
+{
+  inputs_[0].reset(input);
+  if (!input)
+    throw NullPointerException("PairedFastqReader (constructor). Line reader should not be a NULL pointer!");
+  start_(nbThreads);
+}
+
+PairedFastqReader::~PairedFastqReader()
+{
+  stopThreads_();
+}
+
+/******************************************************************************/
+
+void PairedFastqReader::start_(unsigned int nbThreads)
+{
+  if (!alphabet_)
+    throw NullPointerException("PairedFastqReader (constructor). Alphabet should not be a NULL pointer!");
+  if (batchSize_ == 0)
+    throw Exception("PairedFastqReader (constructor). Batch size must be positive.");
+  if (nbThreads == 0)
+    nbThreads = max(thread::hardware_concurrency(), 1u);
+  inputDone_[0] = false;
+  inputDone_[1] = interleaved_;
+  maxChunks_ = 2 * nbThreads;
+  maxInFlight_ = 2 * nbThreads + 2;
+  threads_.push_back(thread(&PairedFastqReader::splitterLoop_, this, 0));
+  if (!interleaved_)
+    threads_.push_back(thread(&PairedFastqReader::splitterLoop_, this, 1));
+  for (unsigned int i = 0; i < nbThreads; ++i)
+    threads_.push_back(thread(&PairedFastqReader::workerLoop_, this));
+}
+
+void PairedFastqReader::stopThreads_()
+{
+  {
+    lock_guard<mutex> lock(mutex_);
+    stop_ = true;
+  }
+  chunkAvailable_.notify_all();
+  spaceAvailable_.notify_all();
+  jobDone_.notify_all();
+  for (size_t i = 0; i < threads_.size(); ++i)
+    threads_[i].join();
+  threads_.clear();
+}
+
+bool PairedFastqReader::canPair_() const
+{
+  if (interleaved_)
+    return !chunks_[0].empty();
+  //A chunk without a mate is still parsed, so that the error is reported in order:
+  return (!chunks_[0].empty() && (!chunks_[1].empty() || inputDone_[1]))
+      || (!chunks_[1].empty() && inputDone_[0]);
+}
+
+bool PairedFastqReader::isExhausted_() const
+{
+  return inputDone_[0] && inputDone_[1] && chunks_[0].empty() && chunks_[1].empty();
+}
+
+/******************************************************************************/
+
+void PairedFastqReader::splitterLoop_(size_t k)
+{
+  try {
+    LineReader& input = *inputs_[k];
+    size_t nbRecords = interleaved_ ? 2 * batchSize_ : batchSize_;
+    size_t lastSize = 0;
+    bool eof = false;
+    while (!eof) {
+      shared_ptr<Chunk_> chunk(new Chunk_());
+      chunk->text.reserve(lastSize);
+      TextSpan line;
+      while (chunk->nbReads < nbRecords) {
+        //Blank lines between records are ignored:
+        do {
+          eof = !input.nextLine(line);
+        } while (!eof && line.isBlank());
+        if (eof) break;
+        //A record spans four lines, incomplete records are reported by the parser:
+        for (size_t j = 0; j < 4 && !eof; ++j) {
+          if (j > 0)
+            eof = !input.nextLine(line);
+          if (!eof) {
+            chunk->text.insert(chunk->text.end(), line.begin(), line.end());
+            chunk->text.push_back('\n');
+          }
+        }
+        chunk->nbReads++;
+      }
+      lastSize = chunk->text.size();
+      if (chunk->nbReads > 0) {
+        unique_lock<mutex> lock(mutex_);
+        while (!stop_ && chunks_[k].size() >= maxChunks_)
+          spaceAvailable_.wait(lock);
+        if (stop_)
+          return;
+        chunks_[k].push_back(chunk);
+      }
+      chunkAvailable_.notify_all();
+    }
+  } catch (...) {
+    lock_guard<mutex> lock(mutex_);
+    if (!inputError_)
+      inputError_ = current_exception();
+  }
+  {
+    lock_guard<mutex> lock(mutex_);
+    inputDone_[k] = true;
+  }
+  chunkAvailable_.notify_all();
+  jobDone_.notify_all();
+}
+
+void PairedFastqReader::workerLoop_()
+{
+  while (true) {
+    shared_ptr<Job_> job(new Job_(alphabet_));
+    {
+      unique_lock<mutex> lock(mutex_);
+      while (!stop_ && !isExhausted_() && !(canPair_() && inFlight_.size() < maxInFlight_))
+        chunkAvailable_.wait(lock);
+      if (stop_ || isExhausted_())
+        return;
+      //Jobs are created in the order of the chunks, which is the order of the output:
+      size_t nbReads = 0;
+      if (!chunks_[0].empty()) {
+        job->chunk1 = chunks_[0].front();
+        chunks_[0].pop_front();
+        nbReads = interleaved_ ? (job->chunk1->nbReads + 1) / 2 : job->chunk1->nbReads;
+      }
+      if (!interleaved_ && !chunks_[1].empty()) {
+        job->chunk2 = chunks_[1].front();
+        chunks_[1].pop_front();
+        nbReads = max(nbReads, job->chunk2->nbReads);
+      }
+      job->firstPair = nbQueuedPairs_;
+      nbQueuedPairs_ += nbReads;
+      inFlight_.push_back(job);
+    }
+    spaceAvailable_.notify_all();
+    try {
+      parse_(*job);
+    } catch (...) {
+      job->error = current_exception();
+    }
+    job->chunk1.reset(); //Free text as soon as possible.
+    job->chunk2.reset();
+    {
+      lock_guard<mutex> lock(mutex_);
+      job->done = true;
+    }
+    jobDone_.notify_all();
+  }
+}
+
+void PairedFastqReader::parse_(Job_& job) const
+{
+  if (job.chunk1) {
+    FastqBatchReader reader(new MemoryLineReader(job.chunk1->text.data(), job.chunk1->text.size()), alphabet_);
+    if (interleaved_) {
+      while (reader.nextRead(job.batch1)) {
+        if (!reader.nextRead(job.batch2))
+          throw IOException("PairedFastqReader::nextBatch. Interleaved input has an odd number of reads.");
+      }
+    } else {
+      while (reader.nextRead(job.batch1)) {}
+    }
+  }
+  if (job.chunk2) {
+    FastqBatchReader reader(new MemoryLineReader(job.chunk2->text.data(), job.chunk2->text.size()), alphabet_);
+    while (reader.nextRead(job.batch2)) {}
+  }
+  if (job.batch1.size() != job.batch2.size())
+    throw IOException("PairedFastqReader::nextBatch. Input files do not have the same number of reads.");
+  if (checkNames_) {
+    for (size_t i = 0; i < job.batch1.size(); ++i) {
+      if (!isSameFragment(job.batch1.getName(i), job.batch2.getName(i)))
+        throw IOException("PairedFastqReader::nextBatch. Names of pair " + TextTools::toString(job.firstPair + i + 1) + " do not match: " + job.batch1.getName(i).toString() + " and " + job.batch2.getName(i).toString() + ".");
+    }
+  }
+}
+
+/******************************************************************************/
+
+bool PairedFastqReader::nextBatch(FastqBatch& batch1, FastqBatch& batch2)
+{
+  shared_ptr<Job_> job;
+  {
+    unique_lock<mutex> lock(mutex_);
+    while (true) {
+      if (!inFlight_.empty()) {
+        if (inFlight_.front()->done) {
+          job = inFlight_.front();
+          inFlight_.pop_front();
+          break;
+        }
+      } else if (isExhausted_()) {
+        if (inputError_)
+          rethrow_exception(inputError_);
+        return false;
+      }
+      jobDone_.wait(lock);
+    }
+    //A read error on one file usually makes the next chunks inconsistent, it is reported first:
+    if (job->error && inputError_)
+      rethrow_exception(inputError_);
+  }
+  chunkAvailable_.notify_all();
+  if (job->error)
+    rethrow_exception(job->error);
+  swap(batch1, job->batch1);
+  swap(batch2, job->batch2);
+  nbPairs_ += batch1.size();
+  return true;
+}
+
+bool PairedFastqReader::isSameFragment(const TextSpan& name1, const TextSpan& name2)
+{
+  size_t n1 = 0, n2 = 0;
+  while (n1 < name1.size && !TextSpan::isSpace(name1[n1])) ++n1;
+  while (n2 < name2.size && !TextSpan::isSpace(name2[n2])) ++n2;
+  //Remove mate suffixes:
+  if (n1 >= 2 && name1[n1 - 2] == '/' && (name1[n1 - 1] == '1' || name1[n1 - 1] == '2')) n1 -= 2;
+  if (n2 >= 2 && name2[n2 - 2] == '/' && (name2[n2 - 1] == '1' || name2[n2 - 1] == '2')) n2 -= 2;
+  return n1 == n2 && memcmp(name1.data, name2.data, n1) == 0;
+}
+
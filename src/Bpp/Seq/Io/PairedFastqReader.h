@@ -0,0 +1,208 @@
+//
+// File: PairedFastqReader.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _PAIREDFASTQREADER_H_
+#define _PAIREDFASTQREADER_H_
+
+#include "FastqBatch.h"
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+namespace bpp {
+
+/**
+ * @brief Read paired-end FASTQ data, as two files or as one interleaved file, using several threads.
+ *
+ * Each input file is read (and decompressed, see CompressedLineReader) on its own thread, and cut into
+ * chunks of complete records. Matching chunks of the two mates are then parsed by a pool of worker
+ * threads, and the resulting pairs of batches are returned in file order, so that R1 and R2 reads are
+ * always kept in lockstep. In interleaved mode, both mates are read from a single file, the first read
+ * of each pair being the R1 read.
+ *
+ * The number of chunks read ahead and of batches parsed ahead are bounded. Unless disabled, the names
+ * of both mates are compared up to the first white space, ignoring a trailing "/1" or "/2".
+ *
+ * @code
+ * PairedFastqReader reader("reads_R1.fastq.gz", "reads_R2.fastq.gz", &AlphabetTools::DNA_ALPHABET);
+ * FastqBatch r1(&AlphabetTools::DNA_ALPHABET), r2(&AlphabetTools::DNA_ALPHABET);
+ * while (reader.nextBatch(r1, r2)) {
+ *   for (size_t i = 0; i < r1.size(); ++i) { ... r1.getBases(i) ... r2.getBases(i) ... }
+ * }
+ * @endcode
+ */
+class PairedFastqReader
+{
+  private:
+    struct Chunk_
+    {
+      std::vector<char> text;
+      size_t nbReads;
+      Chunk_(): text(), nbReads(0) {}
+    };
+
+    struct Job_
+    {
+      std::shared_ptr<Chunk_> chunk1;
+      std::shared_ptr<Chunk_> chunk2;
+      uint64_t firstPair;
+      FastqBatch batch1;
+      FastqBatch batch2;
+      bool done;
+      std::exception_ptr error;
+      Job_(const Alphabet* alphabet):
+        chunk1(), chunk2(), firstPair(0), batch1(alphabet), batch2(alphabet), done(false), error() {}
+    };
+
+  private:
+    const Alphabet* alphabet_;
+    size_t batchSize_;
+    bool interleaved_;
+    bool checkNames_;
+    std::unique_ptr<LineReader> inputs_[2];
+    std::deque< std::shared_ptr<Chunk_> > chunks_[2];
+    bool inputDone_[2];
+    std::exception_ptr inputError_;
+    std::deque< std::shared_ptr<Job_> > inFlight_;
+    uint64_t nbPairs_;
+    uint64_t nbQueuedPairs_;
+    size_t maxChunks_;
+    size_t maxInFlight_;
+    bool stop_;
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable chunkAvailable_;
+    std::condition_variable spaceAvailable_;
+    std::condition_variable jobDone_;
+
+  public:
+    /**
+     * @brief Read pairs from two files, which may be gzip or BGZF compressed.
+     *
+     * @param path1 The file with the R1 reads.
+     * @param path2 The file with the R2 reads.
+     * @param alphabet The alphabet of the reads.
+     * @param batchSize The number of pairs in each batch.
+     * @param nbThreads The number of parsing threads, also used for BGZF decompression (0 means one per available core).
+     * @param checkNames Tell if the names of the two mates should be compared.
+     */
+    PairedFastqReader(const std::string& path1, const std::string& path2, const Alphabet* alphabet,
+        size_t batchSize = 16384, unsigned int nbThreads = 0, bool checkNames = true);
+
+    /**
+     * @brief Read pairs from an interleaved file, which may be gzip or BGZF compressed.
+     *
+     * @param path The file with the reads, R1 and R2 reads alternating.
+     * @param alphabet The alphabet of the reads.
+     * @param batchSize The number of pairs in each batch.
+     * @param nbThreads The number of parsing threads, also used for BGZF decompression (0 means one per available core).
+     * @param checkNames Tell if the names of the two mates should be compared.
+     */
+    PairedFastqReader(const std::string& path, const Alphabet* alphabet,
+        size_t batchSize = 16384, unsigned int nbThreads = 0, bool checkNames = true);
+
+    /**
+     * @brief Read pairs from two line readers, which are owned by this object.
+     */
+    PairedFastqReader(LineReader* input1, LineReader* input2, const Alphabet* alphabet,
+        size_t batchSize = 16384, unsigned int nbThreads = 0, bool checkNames = true);
+
+    /**
+     * @brief Read interleaved pairs from a line reader, which is owned by this object.
+     */
+    PairedFastqReader(LineReader* input, const Alphabet* alphabet,
+        size_t batchSize = 16384, unsigned int nbThreads = 0, bool checkNames = true);
+
+    virtual ~PairedFastqReader();
+
+  private:
+    //Recopy is forbidden!
+    PairedFastqReader(const PairedFastqReader&);
+    PairedFastqReader& operator=(const PairedFastqReader&);
+
+  public:
+    bool isInterleaved() const { return interleaved_; }
+
+    /**
+     * @brief Get the next batch of pairs.
+     *
+     * The content of the batches is replaced, mates being stored at the same index in both.
+     *
+     * @param batch1 [out] The R1 reads.
+     * @param batch2 [out] The R2 reads.
+     * @return False if the end of input was reached.
+     * @throw IOException If a record is malformed, if the inputs do not have the same number of reads,
+     * or if the names of two mates do not match.
+     */
+    bool nextBatch(FastqBatch& batch1, FastqBatch& batch2);
+
+    /**
+     * @return The number of pairs returned so far.
+     */
+    uint64_t getNumberOfPairs() const { return nbPairs_; }
+
+    /**
+     * @return True if two read names refer to the same fragment, that is, if they are identical up to
+     * the first white space, after removing a trailing "/1" or "/2" mate suffix.
+     */
+    static bool isSameFragment(const TextSpan& name1, const TextSpan& name2);
+
+  private:
+    void start_(unsigned int nbThreads);
+    void stopThreads_();
+    void splitterLoop_(size_t k);
+    void workerLoop_();
+    void parse_(Job_& job) const;
+
+    //Tell if a job can be created, or if the inputs are exhausted. Must be called with the mutex locked.
+    bool canPair_() const;
+    bool isExhausted_() const;
+};
+
+} // end of namespace bpp.
+
+#endif //_PAIREDFASTQREADER_H_
+
@@ -0,0 +1,252 @@
+//
+// File: TabixIndex.cpp
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include "TabixIndex.h"
+#include "CompressedInput.h"
+
+//From the STL:
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <cstring>
+
+using namespace bpp;
+using namespace std;
+
+namespace {
+
+/**
+ * Little-endian reader on the decompressed content of the index.
+ */
+class IndexBuffer_
+{
+  private:
+    const string& data_;
+    size_t pos_;
+
+  public:
+    IndexBuffer_(const string& data): data_(data), pos_(0) {}
+
+  public:
+    void read(void* out, size_t n) {
+      if (pos_ + n > data_.size())
+        throw IOException("TabixIndex. Truncated index file.");
+      memcpy(out, data_.data() + pos_, n);
+      pos_ += n;
+    }
+    int32_t readInt32() {
+      unsigned char b[4];
+      read(b, 4);
+      return static_cast<int32_t>(static_cast<uint32_t>(b[0]) | (static_cast<uint32_t>(b[1]) << 8) | (static_cast<uint32_t>(b[2]) << 16) | (static_cast<uint32_t>(b[3]) << 24));
+    }
+    uint32_t readUInt32() { return static_cast<uint32_t>(readInt32()); }
+    uint64_t readUInt64() {
+      uint64_t lo = readUInt32();
+      uint64_t hi = readUInt32();
+      return lo | (hi << 32);
+    }
+    size_t readSize() {
+      int32_t n = readInt32();
+      if (n < 0)
+        throw IOException("TabixIndex. Invalid index file.");
+      return static_cast<size_t>(n);
+    }
+    size_t getPosition() const { return pos_; }
+    void skip(size_t n) {
+      if (pos_ + n > data_.size())
+        throw IOException("TabixIndex. Truncated index file.");
+      pos_ += n;
+    }
+};
+
+}
+
+TabixIndex::TabixIndex(const std::string& path):
+  minShift_(14), depth_(5), format_(0), sequenceColumn_(1), beginColumn_(4), endColumn_(5),
+  meta_('#'), skip_(0), names_(), ids_(), references_()
+{
+  //Index files are BGZF-compressed:
+  CompressedInputStream input(path, 1);
+  string data((istreambuf_iterator<char>(input)), istreambuf_iterator<char>());
+  IndexBuffer_ buffer(data);
+  char magic[4];
+  buffer.read(magic, 4);
+  bool csi;
+  if (memcmp(magic, "TBI\1", 4) == 0)
+    csi = false;
+  else if (memcmp(magic, "CSI\1", 4) == 0)
+    csi = true;
+  else
+    throw IOException("TabixIndex (constructor). Not a .tbi or .csi index: " + path);
+
+  //The tabix header is stored directly in .tbi files, and as auxiliary data in .csi files:
+  bool hasHeader = true;
+  if (csi) {
+    minShift_ = buffer.readInt32();
+    depth_ = buffer.readInt32();
+    size_t lAux = buffer.readSize();
+    if (lAux < 28) {
+      hasHeader = false;
+      buffer.skip(lAux);
+    }
+  }
+  vector<string> names;
+  size_t nbRefs = 0;
+  if (!csi)
+    nbRefs = buffer.readSize();
+  if (hasHeader) {
+    format_ = buffer.readInt32();
+    sequenceColumn_ = buffer.readInt32();
+    beginColumn_ = buffer.readInt32();
+    endColumn_ = buffer.readInt32();
+    meta_ = static_cast<char>(buffer.readInt32());
+    skip_ = buffer.readInt32();
+    size_t lNames = buffer.readSize();
+    string all(lNames, '\0');
+    if (lNames > 0) buffer.read(&all[0], lNames);
+    size_t start = 0;
+    for (size_t i = 0; i < lNames; ++i) {
+      if (all[i] == '\0') {
+        names.push_back(all.substr(start, i - start));
+        start = i + 1;
+      }
+    }
+  }
+  if (csi)
+    nbRefs = buffer.readSize();
+
+  //The pseudo-bin holding meta-data is not used:
+  uint32_t pseudoBin = static_cast<uint32_t>(((1 << (3 * depth_ + 3)) - 1) / 7 + 1);
+  references_.resize(nbRefs);
+  for (size_t r = 0; r < nbRefs; ++r) {
+    Reference_& ref = references_[r];
+    size_t nbBins = buffer.readSize();
+    for (size_t b = 0; b < nbBins; ++b) {
+      uint32_t bin = buffer.readUInt32();
+      if (csi) buffer.readUInt64(); //loffset, not used.
+      size_t nbChunks = buffer.readSize();
+      vector<Chunk> chunks(nbChunks);
+      for (size_t c = 0; c < nbChunks; ++c) {
+        chunks[c].begin = buffer.readUInt64();
+        chunks[c].end = buffer.readUInt64();
+      }
+      if (bin != pseudoBin)
+        ref.bins[bin].swap(chunks);
+    }
+    if (!csi) {
+      size_t nbIntervals = buffer.readSize();
+      ref.linear.resize(nbIntervals);
+      for (size_t i = 0; i < nbIntervals; ++i)
+        ref.linear[i] = buffer.readUInt64();
+    }
+  }
+  names_ = names;
+  for (size_t i = 0; i < names_.size() && i < nbRefs; ++i)
+    ids_[names_[i]] = i;
+}
+
+std::string TabixIndex::findIndexFile(const std::string& dataPath)
+{
+  const char* extensions[2] = { ".tbi", ".csi" };
+  for (size_t i = 0; i < 2; ++i) {
+    string path = dataPath + extensions[i];
+    ifstream test(path.c_str(), ios::in | ios::binary);
+    if (test.good())
+      return path;
+  }
+  throw IOException("TabixIndex::findIndexFile. No .tbi or .csi index found for file " + dataPath);
+}
+
+void TabixIndex::regionToBins_(uint64_t begin, uint64_t end, std::vector<uint32_t>& bins) const
+{
+  if (begin >= end) return;
+  int s = minShift_ + depth_ * 3;
+  uint64_t maxPos = static_cast<uint64_t>(1) << s;
+  if (end > maxPos) end = maxPos;
+  if (begin >= end) return;
+  --end;
+  uint32_t t = 0;
+  for (int l = 0; l <= depth_; ++l) {
+    uint32_t b = t + static_cast<uint32_t>(begin >> s);
+    uint32_t e = t + static_cast<uint32_t>(end >> s);
+    for (uint32_t i = b; i <= e; ++i)
+      bins.push_back(i);
+    s -= 3;
+    t += static_cast<uint32_t>(1) << (3 * l);
+  }
+}
+
+void TabixIndex::getChunks(const std::string& seqId, uint64_t begin, uint64_t end, std::vector<Chunk>& chunks) const
+{
+  map<string, size_t>::const_iterator it = ids_.find(seqId);
+  if (it == ids_.end()) return;
+  const Reference_& ref = references_[it->second];
+
+  //Chunks ending before the first line overlapping the 16kb window of begin can be ignored:
+  uint64_t minOffset = 0;
+  if (!ref.linear.empty()) {
+    size_t w = static_cast<size_t>(begin >> minShift_);
+    minOffset = ref.linear[min(w, ref.linear.size() - 1)];
+  }
+
+  vector<uint32_t> bins;
+  regionToBins_(begin, end, bins);
+  vector<Chunk> found;
+  for (size_t i = 0; i < bins.size(); ++i) {
+    map< uint32_t, vector<Chunk> >::const_iterator b = ref.bins.find(bins[i]);
+    if (b == ref.bins.end()) continue;
+    for (size_t c = 0; c < b->second.size(); ++c)
+      if (b->second[c].end > minOffset)
+        found.push_back(b->second[c]);
+  }
+  if (found.empty()) return;
+
+  //Sort and merge overlapping chunks:
+  sort(found.begin(), found.end());
+  Chunk current = found[0];
+  for (size_t i = 1; i < found.size(); ++i) {
+    if (found[i].begin <= current.end) {
+      current.end = max(current.end, found[i].end);
+    } else {
+      chunks.push_back(current);
+      current = found[i];
+    }
+  }
+  chunks.push_back(current);
+}
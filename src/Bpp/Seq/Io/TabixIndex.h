@@ -0,0 +1,148 @@
+//
+// File: TabixIndex.h
+// Authors: Julien Dutheil
+// Created: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for sequences analysis.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#ifndef _TABIXINDEX_H_
+#define _TABIXINDEX_H_
+
+#include <Bpp/Exceptions.h>
+
+//From the STL:
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+namespace bpp {
+
+/**
+ * @brief Binning index of a BGZF-compressed, coordinate-sorted text file, as created by tabix.
+ *
+ * Both the .tbi and .csi formats are supported (see the htslib specifications).
+ * For a given region of a sequence, the index gives the list of chunks of the file, as
+ * pairs of BGZF virtual offsets, which may contain lines overlapping the region. These
+ * lines still need to be checked against the region, as chunks can contain other lines.
+ *
+ * Indexes can be created with 'tabix -p gff file.gff.gz' or 'tabix -p bed file.bedgraph.gz'.
+ */
+class TabixIndex
+{
+  public:
+    struct Chunk
+    {
+      uint64_t begin; //Virtual offset of the first line of the chunk.
+      uint64_t end;   //Virtual offset after the last line of the chunk.
+      Chunk(uint64_t b = 0, uint64_t e = 0): begin(b), end(e) {}
+      bool operator<(const Chunk& chunk) const { return begin < chunk.begin; }
+    };
+
+  private:
+    struct Reference_
+    {
+      std::map< uint32_t, std::vector<Chunk> > bins;
+      std::vector<uint64_t> linear; //Smallest offset for each 16kb window (.tbi only)
+      Reference_(): bins(), linear() {}
+    };
+
+  private:
+    int minShift_;
+    int depth_;
+    int format_;
+    int sequenceColumn_;
+    int beginColumn_;
+    int endColumn_;
+    char meta_;
+    int skip_;
+    std::vector<std::string> names_;
+    std::map<std::string, size_t> ids_;
+    std::vector<Reference_> references_;
+
+  public:
+    /**
+     * @brief Read an index file.
+     *
+     * @param path The path of the .tbi or .csi file.
+     */
+    TabixIndex(const std::string& path);
+
+  public:
+    /**
+     * @return The path of the index of a data file (data file name with extension .tbi or .csi).
+     * @throw IOException If no index file could be found.
+     */
+    static std::string findIndexFile(const std::string& dataPath);
+
+    const std::vector<std::string>& getSequenceNames() const { return names_; }
+
+    bool hasSequence(const std::string& seqId) const { return ids_.find(seqId) != ids_.end(); }
+
+    /**
+     * @return True if begin coordinates in the file are 0-based (for instance BED), false if they are 1-based (for instance GFF).
+     */
+    bool isZeroBased() const { return (format_ & 0x10000) != 0; }
+
+    /**
+     * @return The column of the sequence name, counting from 1.
+     */
+    int getSequenceColumn() const { return sequenceColumn_; }
+
+    /**
+     * @return The character starting comment lines.
+     */
+    char getMetaCharacter() const { return meta_; }
+
+    /**
+     * @brief Get the chunks of the file which may contain lines overlapping a region.
+     *
+     * @param seqId The sequence name.
+     * @param begin The beginning of the region (0-based, included).
+     * @param end The end of the region (0-based, excluded).
+     * @param chunks [out] A vector where the chunks are appended, sorted and merged.
+     */
+    void getChunks(const std::string& seqId, uint64_t begin, uint64_t end, std::vector<Chunk>& chunks) const;
+
+  private:
+    /**
+     * @brief Compute the list of bins overlapping a region, as in htslib's hts_reg2bins.
+     */
+    void regionToBins_(uint64_t begin, uint64_t end, std::vector<uint32_t>& bins) const;
+};
+
+} //end of namespace bpp.
+
+#endif //_TABIXINDEX_H_
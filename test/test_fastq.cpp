@@ -39,11 +39,18 @@ knowledge of the CeCILL license and that you accept its terms.
 
 #include <Bpp/Numeric/VectorTools.h>
 #include <Bpp/Seq/Io/Fastq.h>
+#include <Bpp/Seq/Io/FastqBatch.h>
+#include <Bpp/Seq/Io/FastqBatchWriter.h>
+#include <Bpp/Seq/Io/FastqIndex.h>
+#include <Bpp/Seq/Io/PairedFastqReader.h>
+#include <Bpp/Seq/Io/FastqStatistics.h>
 #include <Bpp/Seq/SequenceWithQuality.h>
 #include <Bpp/Seq/Alphabet/DNA.h>
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <memory>
 
 using namespace bpp;
 
@@ -67,6 +74,116 @@ int main () {
       fq.writeSequence(std::cout, seq);
       fq.repeatName(false);
     }
+
+    //Batched reading gives the same reads:
+    std::ifstream input2(filename.c_str(), std::ios::in);
+    std::ifstream input3(filename.c_str(), std::ios::in);
+    FastqBatchReader reader(input2, alpha);
+    FastqBatch batch(alpha);
+    size_t nbReads = 0;
+    while (reader.nextBatch(batch, 2) > 0) {
+      for (size_t i = 0; i < batch.size(); ++i) {
+        if (!fq.nextSequence(input3, seq))
+          return 1;
+        std::unique_ptr<SequenceWithQuality> read(batch.toSequence(i));
+        if (read->getName() != seq.getName() || read->toString() != seq.toString() || read->getQualities() != seq.getQualities())
+          return 1;
+        nbReads++;
+      }
+    }
+    std::cout << nbReads << " reads in batches." << std::endl;
+    if (nbReads != 3 || reader.getNumberOfReads() != 3)
+      return 1;
+
+    //Compact reads, through Fastq or a batch, hold the same content:
+    std::ifstream input4(filename.c_str(), std::ios::in);
+    CompactRead read(alpha), batchRead(alpha);
+    batch.clear();
+    size_t nbCompact = 0;
+    while (fq.nextRead(input4, read)) {
+      std::unique_ptr<SequenceWithQuality> copy(read.toSequence());
+      batchRead.fromSequence(*copy);
+      batch.addRead(batchRead);
+      batch.getRead(batch.size() - 1, batchRead);
+      if (read.size() != 25 || read.getQuality(0) != 26 || batchRead.toString() != read.toString() || batchRead.getQuality(24) != read.getQuality(24))
+        return 1;
+      nbCompact++;
+    }
+    std::cout << nbCompact << " compact reads." << std::endl;
+    if (nbCompact != 3)
+      return 1;
+
+    //Batches written back are read identically:
+    std::stringstream buffer;
+    {
+      FastqBatchWriter writer(buffer, true);
+      writer.write(batch);
+      writer.close();
+    }
+    FastqBatchReader reader2(buffer, alpha);
+    FastqBatch batch2(alpha);
+    reader2.nextBatch(batch2, 10);
+    if (batch2.size() != batch.size() || batch2.getNumberOfBases() != batch.getNumberOfBases() || !(batch2.getName(2) == batch.getName(2).toString()))
+      return 1;
+
+    //Quality control, in parallel or not:
+    FastqStatistics stats(alpha), parallelStats(alpha);
+    stats.add(batch);
+    FastqQualityControl::compute(filename, parallelStats, 2);
+    std::cout << parallelStats.getNumberOfReads() << " reads, median quality at first cycle: " << parallelStats.getQualityQuantile(0, 0.5) << std::endl;
+    if (parallelStats.getNumberOfBases() != 75 || parallelStats.getLengthCount(25) != 3 || parallelStats.getQualityQuantile(0, 0.5) != 26)
+      return 1;
+    for (size_t i = 0; i < 25; ++i)
+      if (stats.getMeanQuality(i) != parallelStats.getMeanQuality(i) || stats.getStateCount(i, 2) != parallelStats.getStateCount(i, 2))
+        return 1;
+
+    //Paired reading, with the example file as both mates, and as an interleaved file:
+    {
+      PairedFastqReader paired(filename, filename, alpha, 2, 2);
+      FastqBatch r1(alpha), r2(alpha);
+      size_t nbPairs = 0;
+      while (paired.nextBatch(r1, r2)) {
+        for (size_t i = 0; i < r1.size(); ++i)
+          if (!(r1.getName(i) == r2.getName(i).toString()) || r1.getLength(i) != r2.getLength(i))
+            return 1;
+        nbPairs += r1.size();
+      }
+      std::cout << nbPairs << " pairs." << std::endl;
+      if (nbPairs != 3 || paired.getNumberOfPairs() != 3)
+        return 1;
+    }
+    {
+      PairedFastqReader interleaved(filename, alpha, 1, 2, false);
+      FastqBatch r1(alpha), r2(alpha);
+      interleaved.nextBatch(r1, r2);
+      if (r1.size() != 1 || r2.size() != 1 || !(r2.getName(0) == "EAS54_6_R1_2_1_540_792"))
+        return 1;
+      //The third read has no mate:
+      try {
+        interleaved.nextBatch(r1, r2);
+        return 1;
+      } catch (IOException& ex) {
+        std::cout << ex.what() << std::endl;
+      }
+    }
+    //Random access:
+    {
+      FastqIndex index = FastqIndex::build(filename);
+      std::cout << index.getNumberOfReads() << " reads indexed." << std::endl;
+      if (index.getNumberOfReads() != 3 || index.getLength(2) != 25)
+        return 1;
+      FastqBatchReader indexedReader(filename, alpha);
+      FastqBatch fetched(alpha);
+      if (!index.fetch(indexedReader, "EAS54_6_R1_2_1_540_792", fetched) || fetched.size() != 1
+          || !(fetched.getName(0) == "EAS54_6_R1_2_1_540_792"))
+        return 1;
+      index.fetch(indexedReader, 0, 3, fetched);
+      if (fetched.size() != 4 || fetched.getNumberOfBases() != 100)
+        return 1;
+      std::vector<size_t> parts = index.split(2);
+      if (parts.size() != 3 || parts.front() != 0 || parts.back() != 3)
+        return 1;
+    }
     return 0;
   } catch (std::exception& ex) {
     std::cerr << ex.what() << std::endl;
@@ -38,9 +38,20 @@ knowledge of the CeCILL license and that you accept its terms.
 */
 
 #include <Bpp/Seq/Feature/Gff/GffFeatureReader.h>
+#include <Bpp/Seq/Feature/SequenceFeatureView.h>
+#include <Bpp/Seq/Feature/ParallelFeatureLoader.h>
+#include <Bpp/Seq/Feature/SequenceFeatureCache.h>
+#include <Bpp/Seq/Feature/SequenceFeatureTools.h>
+#include <Bpp/Seq/Feature/FeatureRangeIndex.h>
+#include <Bpp/Seq/Alphabet/AlphabetTools.h>
+#include <Bpp/Seq/GeneticCode/StandardGeneticCode.h>
+#include <Bpp/Seq/Container/VectorSequenceContainer.h>
 
 #include <iostream>
 #include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
 
 using namespace bpp;
 using namespace std;
@@ -53,6 +64,182 @@ int main() {
     BasicSequenceFeature feature = reader.nextFeature();
     cout << "Found feature " << feature.getId() << " of type " << feature.getType() << ", starting at " << feature.getStart() << " and ending at " << feature.getEnd() << endl;
   }
+
+  //Bulk and filtered reading:
+  ifstream input2("example.gff", ios::in);
+  SequenceFeatureSet all;
+  GffFeatureReader(input2).getAllFeatures(all);
+  ifstream input3("example.gff", ios::in);
+  SequenceFeatureSet exons;
+  GffFeatureReader(input3).getFeaturesOfType("exon", exons);
+  cout << all.getNumberOfFeatures() << " features, " << exons.getNumberOfFeatures() << " exons." << endl;
+  if (all.getNumberOfFeatures() != 23 || exons.getNumberOfFeatures() != 5)
+    return 1;
+  if (exons[1].getAttribute("Parent") != "mRNA00001,mRNA00002" || exons[1].getStart() != 1049)
+    return 1;
+
+  //Attributes are stored, and written back, sorted by name:
+  string line = GffFeatureReader::toString(all[10]);
+  cout << line << endl;
+  if (line != "ctg123\t.\tCDS\t1201\t1500\t0\t+\t0\tID=cds00001;GFF_PHASE=0;Name=edenprotein.1;Parent=mRNA00001")
+    return 1;
+  const BasicSequenceFeature& cds = dynamic_cast<const BasicSequenceFeature&>(all[10]);
+  if (cds.getNumberOfAttributes() != 3 || cds.getAttributeName(0) != "GFF_PHASE" || cds.getAttributeName(1) != "Name" || cds.getAttributeName(2) != "Parent")
+    return 1;
+
+  //Indexed selections, without copy:
+  all.buildIndex();
+  SequenceFeatureView view = SequenceFeatureView(all).ofType("exon").inRange("ctg123", SeqRange(1000, 3000), false);
+  cout << view.getNumberOfFeatures() << " exons overlapping [1000, 3000[." << endl;
+  if (view.getNumberOfFeatures() != 3 || view[0].getId() != "exon00001" || view[2].getId() != "exon00003")
+    return 1;
+
+  //Parallel loading, with small chunks, keeps the file order:
+  SequenceFeatureSet loaded;
+  ParallelFeatureLoader loader([](LineReader* lines, bool) -> FeatureReader* { return new GffFeatureReader(lines); }, 3, 200);
+  loader.load("example.gff", loaded);
+  cout << loaded.getNumberOfFeatures() << " features loaded in parallel." << endl;
+  if (loaded.getNumberOfFeatures() != all.getNumberOfFeatures())
+    return 1;
+  for (size_t i = 0; i < loaded.getNumberOfFeatures(); ++i)
+    if (GffFeatureReader::toString(loaded[i]) != GffFeatureReader::toString(all[i]))
+      return 1;
+
+  //Binary snapshot, with the index restored:
+  SequenceFeatureCache::write(all, "example.gff.cache");
+  {
+    SequenceFeatureCache cache("example.gff.cache");
+    vector<size_t> indices;
+    cache.getIndicesForRange("ctg123", SeqRange(1000, 3000), false, indices);
+    SequenceFeatureSet restored;
+    cache.load(restored);
+    cout << cache.getNumberOfFeatures() << " features in snapshot, " << indices.size() << " overlapping [1000, 3000[." << endl;
+    if (cache.getNumberOfFeatures() != 23 || indices.size() != 11 || !restored.isIndexed())
+      return 1;
+    if (GffFeatureReader::toString(cache.getFeature(10)) != line || GffFeatureReader::toString(restored[10]) != line)
+      return 1;
+  }
+  {
+    //A snapshot with a string index beyond the string table is rejected when opened:
+    ifstream in("example.gff.cache", ios::in | ios::binary);
+    string bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    uint64_t featuresOffset;
+    memcpy(&featuresOffset, bytes.data() + 80, sizeof(featuresOffset));
+    memset(&bytes[static_cast<size_t>(featuresOffset) + 24], 0xff, 8);
+    ofstream out("example.gff.cache", ios::out | ios::binary | ios::trunc);
+    out << bytes;
+  }
+  try {
+    SequenceFeatureCache cache("example.gff.cache");
+    return 1;
+  } catch (IOException& e) {
+    cout << "Corrupted snapshot rejected: " << e.what() << endl;
+  }
+  remove("example.gff.cache");
+
+  //Sweep-line joins:
+  unique_ptr<SequenceFeatureSet> mRNAs(all.getSubsetForType("mRNA"));
+  vector< pair<size_t, size_t> > pairs;
+  SequenceFeatureTools::overlapJoin(exons, *mRNAs, pairs, SequenceFeatureTools::STRAND_SAME, SequenceFeatureTools::JOIN_A_IN_B);
+  SequenceFeatureSet merged;
+  SequenceFeatureTools::merge(exons, merged);
+  cout << pairs.size() << " exons in mRNAs, " << merged.getNumberOfFeatures() << " exonic regions." << endl;
+  if (pairs.size() != 14 || merged.getNumberOfFeatures() != 4 || merged[0].getStart() != 1049 || merged[0].getEnd() != 1500)
+    return 1;
+
+  //Joins by strand and inclusion, intersections and differences:
+  SequenceFeatureSet setA, setB;
+  setA.addFeature(BasicSequenceFeature("a0", "chr1", "test", "A", 10, 50, '+'));
+  setA.addFeature(BasicSequenceFeature("a1", "chr1", "test", "A", 60, 100, '-'));
+  setA.addFeature(BasicSequenceFeature("a2", "chr2", "test", "A", 0, 30, '+'));
+  setB.addFeature(BasicSequenceFeature("b0", "chr1", "test", "B", 0, 20, '+'));
+  setB.addFeature(BasicSequenceFeature("b1", "chr1", "test", "B", 30, 40, '-'));
+  setB.addFeature(BasicSequenceFeature("b2", "chr1", "test", "B", 45, 70, '-'));
+  setB.addFeature(BasicSequenceFeature("b3", "chr1", "test", "B", 80, 90, '+'));
+  setB.addFeature(BasicSequenceFeature("b4", "chr2", "test", "B", 5, 10, '-'));
+  auto sameRanges = [](const SequenceFeatureSet& features, const vector< pair<size_t, size_t> >& expected) -> bool {
+    if (features.getNumberOfFeatures() != expected.size())
+      return false;
+    for (size_t i = 0; i < expected.size(); ++i)
+      if (features[i].getStart() != expected[i].first || features[i].getEnd() != expected[i].second)
+        return false;
+    return true;
+  };
+  vector< pair<size_t, size_t> > oppositePairs, includedPairs;
+  SequenceFeatureTools::overlapJoin(setA, setB, oppositePairs, SequenceFeatureTools::STRAND_OPPOSITE);
+  SequenceFeatureTools::overlapJoin(setA, setB, includedPairs, SequenceFeatureTools::STRAND_IGNORE, SequenceFeatureTools::JOIN_B_IN_A);
+  cout << oppositePairs.size() << " overlaps on opposite strands, " << includedPairs.size() << " included features." << endl;
+  if (oppositePairs != vector< pair<size_t, size_t> >({ {0, 1}, {0, 2}, {1, 3}, {2, 4} }))
+    return 1;
+  if (includedPairs != vector< pair<size_t, size_t> >({ {0, 1}, {1, 3}, {2, 4} }))
+    return 1;
+  SequenceFeatureSet intersection, difference;
+  SequenceFeatureTools::intersect(setA, setB, intersection);
+  SequenceFeatureTools::subtract(setA, setB, difference);
+  cout << intersection.getNumberOfFeatures() << " intersections, " << difference.getNumberOfFeatures() << " remaining parts." << endl;
+  if (!sameRanges(intersection, { {10, 20}, {30, 40}, {45, 50}, {60, 70}, {80, 90}, {5, 10} }) || intersection[5].getId() != "a2")
+    return 1;
+  if (!sameRanges(difference, { {20, 30}, {40, 45}, {70, 80}, {90, 100}, {0, 5}, {10, 30} }) || !difference[2].isNegativeStrand())
+    return 1;
+
+  //Shared range index:
+  FeatureRangeIndex exonIndex(exons);
+  RangeSet<size_t> exonRanges;
+  exonIndex.fillRangeCollectionForRange("ctg123", SeqRange(1000, 3000), false, exonRanges);
+  vector<size_t> bounds = exonIndex.getBoundsWithin("ctg123", SeqRange(1400, 6000));
+  cout << exonIndex.getRanges("ctg123").size() << " indexed exons, " << exonRanges.getSet().size() << " overlapping [1000, 3000[." << endl;
+  if (exonIndex.getRanges("ctg123").size() != 5 || exonIndex.getBounds("ctg123").size() != 8 || exonRanges.getSet().size() != 3)
+    return 1;
+  if (bounds.size() != 6 || bounds[0] != 1400 || bounds[1] != 1500 || bounds[5] != 5500)
+    return 1;
+
+  //ORF scanning:
+  StandardGeneticCode gCode(&AlphabetTools::DNA_ALPHABET);
+  BasicSequence orfSeq("orfs", "GCTATGGTCAATATGATAACATCATCGTCATAACGAAACTATGTGGCCCAGTGTGAATTGACATAGGGTTTTATAACATTGATGCATACG", &AlphabetTools::DNA_ALPHABET);
+  auto sameOrfs = [](const SequenceFeatureSet& orfs, const vector< pair<size_t, size_t> >& expected, size_t nbForward) -> bool {
+    if (orfs.getNumberOfFeatures() != expected.size())
+      return false;
+    for (size_t i = 0; i < expected.size(); ++i)
+      if (orfs[i].getStart() != expected[i].first || orfs[i].getEnd() != expected[i].second || orfs[i].isNegativeStrand() != (i >= nbForward))
+        return false;
+    return true;
+  };
+  SequenceFeatureSet orfs;
+  SequenceFeatureTools::getOrfs(orfSeq, orfs, gCode);
+  cout << orfs.getNumberOfFeatures() << " ORFs on the forward strand." << endl;
+  if (!sameOrfs(orfs, { {3, 32}, {12, 32}, {40, 60} }, 3))
+    return 1;
+  SequenceFeatureSet longestOrfs;
+  OrfScanner(gCode).scan(orfSeq, longestOrfs);
+  if (!sameOrfs(longestOrfs, { {3, 32}, {40, 60}, {28, 87}, {8, 64}, {71, 79} }, 2))
+    return 1;
+  SequenceFeatureSet nestedOrfs;
+  OrfScanner(gCode, 0, true, true).scan(orfSeq, nestedOrfs);
+  if (!sameOrfs(nestedOrfs, { {3, 32}, {12, 32}, {40, 60}, {28, 87}, {8, 22}, {8, 25}, {8, 31}, {8, 64}, {71, 79} }, 3))
+    return 1;
+  SequenceFeatureSet longOrfs;
+  OrfScanner(gCode, 25, true, true).scan(orfSeq, longOrfs);
+  cout << nestedOrfs.getNumberOfFeatures() << " ORFs on both strands, " << longOrfs.getNumberOfFeatures() << " of length 25 or more." << endl;
+  if (!sameOrfs(longOrfs, { {3, 32}, {28, 87}, {8, 64} }, 1))
+    return 1;
+
+  //Threaded scanning gives the same ORFs, in sequence order:
+  VectorSequenceContainer orfSeqs(&AlphabetTools::DNA_ALPHABET);
+  orfSeqs.addSequence(orfSeq);
+  orfSeqs.addSequence(BasicSequence("short", "ATGAAATAGCATTTATTACCCATG", &AlphabetTools::DNA_ALPHABET));
+  orfSeqs.addSequence(BasicSequence("none", "CCCCCC", &AlphabetTools::DNA_ALPHABET));
+  orfSeqs.addSequence(BasicSequence("twice", orfSeq.toString() + orfSeq.toString(), &AlphabetTools::DNA_ALPHABET));
+  OrfScanner scanner(gCode, 10, true, true);
+  SequenceFeatureSet threaded, sequential;
+  size_t nbThreaded = scanner.scan(orfSeqs, threaded, 3);
+  for (size_t i = 0; i < orfSeqs.getNumberOfSequences(); ++i)
+    scanner.scan(orfSeqs.getSequence(i), sequential);
+  cout << nbThreaded << " ORFs found with 3 threads." << endl;
+  if (nbThreaded != sequential.getNumberOfFeatures() || threaded.getNumberOfFeatures() != sequential.getNumberOfFeatures())
+    return 1;
+  for (size_t i = 0; i < sequential.getNumberOfFeatures(); ++i)
+    if (GffFeatureReader::toString(threaded[i]) != GffFeatureReader::toString(sequential[i]))
+      return 1;
   return 0;
   } catch (exception& ex) {
     cerr << ex.what() << endl;
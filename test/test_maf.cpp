@@ -0,0 +1,2024 @@
+//
+// File: test_maf.cpp
+// Created by: Julien Dutheil
+// Created on: Wed Oct 14 2026
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (2026)
+
+This software is a computer program whose purpose is to provide classes
+for numerical calculus. This file is part of the Bio++ project.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include <Bpp/Seq/Io/Maf/MafParser.h>
+#include <Bpp/Seq/Io/Maf/BlockLengthMafIterator.h>
+#include <Bpp/Seq/Io/Maf/OutputMafIterator.h>
+#include <Bpp/Seq/Io/Maf/LiftoverIndex.h>
+#include <Bpp/Seq/Io/Maf/PipelineProfiler.h>
+#include <Bpp/Seq/Io/Maf/ProgressReporter.h>
+#include <Bpp/Seq/Io/Maf/RegionParallelMafRunner.h>
+#include <Bpp/Seq/Io/Maf/MafSharding.h>
+#include <Bpp/Seq/Io/Maf/MafCheckpoint.h>
+#include <Bpp/Seq/Io/Maf/MergeMafIterator.h>
+#include <Bpp/Seq/Io/Maf/SortMafIterator.h>
+#include <Bpp/Seq/Io/Maf/BinaryOutputMafIterator.h>
+#include <Bpp/Seq/Io/Maf/HaplotypeMatrix.h>
+#include <Bpp/Seq/Io/Maf/GapRunSequence.h>
+#include <Bpp/Seq/Io/Maf/ConcatenateMafIterator.h>
+#include <Bpp/Seq/Io/Maf/TeeMafIterator.h>
+#include <Bpp/Seq/Io/Maf/StaticMafPipeline.h>
+#include <Bpp/Seq/Io/Maf/FullGapFilterMafIterator.h>
+#include <Bpp/Seq/Io/Maf/MafStatistics.h>
+#include <Bpp/Seq/Io/Maf/OrderFilterMafIterator.h>
+#include <Bpp/Seq/Io/Maf/MsmcOutputMafIterator.h>
+#include <Bpp/Seq/Io/Maf/SequenceStreamToMafIterator.h>
+#include <Bpp/Seq/Io/Maf/SequenceFilterMafIterator.h>
+#include <Bpp/Seq/Io/Maf/SamplingMafIterator.h>
+#include <Bpp/Seq/Io/Maf/IterationListener.h>
+#include <Bpp/Seq/Io/Maf/WindowSplitMafIterator.h>
+#include <Bpp/Seq/Io/Maf/AlignmentFilterMafIterator.h>
+#include <Bpp/Seq/Io/Maf/EntropyFilterMafIterator.h>
+#include <Bpp/Seq/Io/Maf/MaskFilterMafIterator.h>
+#include <Bpp/Seq/Io/Maf/QualityFilterMafIterator.h>
+#include <Bpp/Seq/Io/Maf/FeatureFilterMafIterator.h>
+#include <Bpp/Seq/Io/Maf/MafBlockView.h>
+#include <Bpp/Seq/Io/Maf/VcfOutputMafIterator.h>
+#include <Bpp/Seq/Io/Maf/ColumnCounts.h>
+#include <Bpp/Seq/Io/Maf/BcfOutputMafIterator.h>
+#include <Bpp/Seq/Io/Maf/ColumnarTableOutputMafIterator.h>
+#include <Bpp/Seq/Io/Maf/PlinkOutputMafIterator.h>
+#include <Bpp/Seq/Io/Maf/ParallelSequenceStatisticsMafIterator.h>
+#include <Bpp/Seq/Io/AsyncFileWriter.h>
+#include <Bpp/Seq/SequenceWithAnnotationTools.h>
+#include <Bpp/Io/OutputStream.h>
+#include <Bpp/Text/StringTokenizer.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <thread>
+#include <set>
+#include <memory>
+#include <cmath>
+
+using namespace bpp;
+using namespace std;
+
+size_t nbComputedSizes = 0;
+
+size_t* computeGenomicSize(const MafBlock& block) {
+  nbComputedSizes++;
+  return new size_t(block.getSequence(0).getGenomicSize());
+}
+
+vector<string> parse(MafIterator& parser) {
+  vector<string> blocks;
+  while (MafBlock* block = parser.nextBlock()) {
+    string desc = block->getDescription();
+    for (size_t i = 0; i < block->getNumberOfSequences(); ++i) {
+      const MafSequence& seq = block->getSequence(i);
+      desc += " " + seq.getDescription() + " " + seq.toString();
+    }
+    blocks.push_back(desc);
+    delete block;
+  }
+  return blocks;
+}
+
+/**
+ * Pass blocks through, and check that each of them is recycled exactly once.
+ * Recycled blocks are kept until the end, so that their addresses are not reused.
+ */
+class RecycleCheckMafIterator:
+  public AbstractFilterMafIterator
+{
+  private:
+    set<const MafBlock*> pending_;
+    set<const MafBlock*> recycled_;
+    vector<MafBlock*> storage_;
+    size_t nbDoubles_;
+
+  public:
+    RecycleCheckMafIterator(MafIterator* iterator):
+      AbstractFilterMafIterator(iterator), pending_(), recycled_(), storage_(), nbDoubles_(0) {}
+
+    ~RecycleCheckMafIterator() {
+      for (size_t i = 0; i < storage_.size(); ++i)
+        delete storage_[i];
+    }
+
+  private:
+    RecycleCheckMafIterator(const RecycleCheckMafIterator&);
+    RecycleCheckMafIterator& operator=(const RecycleCheckMafIterator&);
+
+  public:
+    void recycle(MafBlock* block) {
+      if (!block) return;
+      if (!recycled_.insert(block).second) {
+        nbDoubles_++;
+        return;
+      }
+      pending_.erase(block);
+      storage_.push_back(block);
+    }
+
+    size_t getNumberOfPendingBlocks() const { return pending_.size(); }
+    bool isPending(const MafBlock* block) const { return pending_.count(block) > 0; }
+    size_t getNumberOfDoubleRecycles() const { return nbDoubles_; }
+
+  private:
+    MafBlock* analyseCurrentBlock_() {
+      MafBlock* block = iterator_->nextBlock();
+      if (block) pending_.insert(block);
+      return block;
+    }
+};
+
+/**
+ * @return The coordinates of the first row of the kept (K) and trashed (T) pieces of a split iterator.
+ */
+string splitRegions(AbstractFilterMafIterator& filter) {
+  filter.setVerbose(false);
+  filter.setLogStream(0);
+  MafTrashIterator* trash = dynamic_cast<MafTrashIterator*>(&filter);
+  string regions;
+  while (MafBlock* block = filter.nextBlock()) {
+    regions += "K:" + TextTools::toString(block->getSequence(0).start()) + "-" + TextTools::toString(block->getSequence(0).stop()) + " ";
+    delete block;
+    while (MafBlock* removed = trash->nextRemovedBlock()) {
+      regions += "T:" + TextTools::toString(removed->getSequence(0).start()) + "-" + TextTools::toString(removed->getSequence(0).stop()) + " ";
+      delete removed;
+    }
+  }
+  return regions;
+}
+
+MafIterator* splitIterator(size_t i, MafIterator* input, const SequenceFeatureSet& features) {
+  vector<string> all = {"hg16", "panTro1", "baboon", "mm4", "rn3"};
+  switch (i) {
+    case 0: return new WindowSplitMafIterator(input, 10, WindowSplitMafIterator::ADJUST, true);
+    case 1: return new AlignmentFilterMafIterator(input, all, 5, 1, 0u, 0.6, true, true);
+    case 2: return new EntropyFilterMafIterator(input, all, 4, 1, 0.1, 0, true, false, true);
+    case 3: return new MaskFilterMafIterator(input, {"hg16", "rn3"}, 4, 1, 0, true);
+    case 4: return new QualityFilterMafIterator(input, {"hg16", "mm4"}, 4, 1, 8, true);
+    default: return new FeatureFilterMafIterator(input, "hg16", features, true);
+  }
+}
+
+int main() {
+  try {
+    ifstream input("example.maf", ios::in);
+    MafParser streamParser(&input, true);
+    streamParser.setVerbose(false);
+    vector<string> blocks1 = parse(streamParser);
+
+    MafParser mappedParser(new MappedFileLineReader("example.maf"), true);
+    mappedParser.setVerbose(false);
+    vector<string> blocks2 = parse(mappedParser);
+
+    if (blocks1.size() != 3) {
+      cerr << "Wrong number of blocks: " << blocks1.size() << endl;
+      return 1;
+    }
+    if (blocks1 != blocks2) {
+      cerr << "Stream and memory-mapped parsers do not agree." << endl;
+      return 1;
+    }
+    for (size_t i = 0; i < blocks1.size(); ++i)
+      cout << blocks1[i] << endl;
+
+    //Retrieve blocks in batches, through a filter:
+    {
+      MafParser batchParser(new MappedFileLineReader("example.maf"), true);
+      batchParser.setVerbose(false);
+      BlockLengthMafIterator lengthFilter(&batchParser, 10);
+      lengthFilter.setVerbose(false);
+      lengthFilter.setLogStream(0);
+      ProgressReporter progress(0, 1., ProgressReporter::getFileSize("example.maf"));
+      progress.attach(&lengthFilter);
+      vector<MafBlock*> batch;
+      vector<string> batchBlocks;
+      while (lengthFilter.nextBlocks(batch, 2) > 0) {}
+      if (progress.getNumberOfBytes() != progress.getTotalBytes() || progress.getNumberOfBlocks() != 2 || progress.getNumberOfSites() != 55) {
+        cerr << "Progress reporting failed." << endl;
+        return 1;
+      }
+      for (size_t i = 0; i < batch.size(); ++i) {
+        batchBlocks.push_back(batch[i]->getDescription());
+        delete batch[i];
+      }
+      if (batchBlocks.size() != 2 || blocks1[2].find(batchBlocks[1]) != 0) {
+        cerr << "Batch iteration failed." << endl;
+        return 1;
+      }
+    }
+
+    //Merge the file with itself, with or without duplicates:
+    for (short policy = MergeMafIterator::KEEP_ALL; policy <= MergeMafIterator::DISCARD_DUPLICATES; policy += 2) {
+      MafParser input1(new MappedFileLineReader("example.maf"));
+      MafParser input2(new MappedFileLineReader("example.maf"));
+      input1.setVerbose(false);
+      input2.setVerbose(false);
+      vector<MafIterator*> inputs;
+      inputs.push_back(&input1);
+      inputs.push_back(&input2);
+      MergeMafIterator merge(inputs, "hg16", policy);
+      merge.setVerbose(false);
+      vector<string> merged = parse(merge);
+      bool keepAll = (policy == MergeMafIterator::KEEP_ALL);
+      if (merged.size() != (keepAll ? 6 : 3) || merge.getNumberOfDiscardedBlocks() != (keepAll ? 0 : 3)
+          || merged[keepAll ? 2 : 1] != blocks1[1] || merged.back() != blocks1[2]) {
+        cerr << "Merging failed: " << merged.size() << " blocks." << endl;
+        return 1;
+      }
+    }
+
+    //Sort the blocks in reverse order, in memory or through temporary runs:
+    {
+      ifstream file("example.maf", ios::in);
+      stringstream content;
+      content << file.rdbuf();
+      string text = content.str();
+      vector<string> parts;
+      for (size_t pos = 0, next; pos < text.size(); pos = next + 2) {
+        next = text.find("\n\n", pos);
+        if (next == string::npos) next = text.size();
+        string part = text.substr(pos, next - pos);
+        while (!part.empty() && part[part.size() - 1] == '\n')
+          part.erase(part.size() - 1);
+        parts.push_back(part + "\n");
+      }
+      string reversed = parts[0] + "\n";
+      for (size_t i = parts.size() - 1; i > 0; --i)
+        reversed += parts[i] + "\n";
+      for (uint64_t budget = 1; budget <= 1000000; budget *= 1000000) {
+        istringstream unsorted(reversed);
+        MafParser unsortedParser(&unsorted, true);
+        unsortedParser.setVerbose(false);
+        SortMafIterator sort(&unsortedParser, "hg16", budget);
+        sort.setVerbose(false);
+        vector<string> sorted = parse(sort);
+        if (sorted != blocks1 || sort.getNumberOfRuns() != (budget == 1 ? 3 : 0)) {
+          cerr << "Sorting failed: " << sorted.size() << " blocks, " << sort.getNumberOfRuns() << " runs." << endl;
+          return 1;
+        }
+      }
+
+      //Merging with an unsorted input throws, and the pending blocks are recycled:
+      {
+        MafParser sortedParser(new MappedFileLineReader("example.maf"), true);
+        istringstream unsorted(reversed);
+        MafParser unsortedParser(&unsorted, true);
+        sortedParser.setVerbose(false);
+        unsortedParser.setVerbose(false);
+        RecycleCheckMafIterator sortedChecker(&sortedParser);
+        RecycleCheckMafIterator unsortedChecker(&unsortedParser);
+        sortedChecker.setVerbose(false);
+        unsortedChecker.setVerbose(false);
+        vector<MafIterator*> inputs;
+        inputs.push_back(&sortedChecker);
+        inputs.push_back(&unsortedChecker);
+        bool thrown = false;
+        {
+          MergeMafIterator merge(inputs, "hg16");
+          merge.setVerbose(false);
+          try {
+            while (MafBlock* block = merge.nextBlock())
+              (sortedChecker.isPending(block) ? sortedChecker : unsortedChecker).recycle(block);
+          } catch (Exception&) {
+            thrown = true;
+          }
+        }
+        if (!thrown || sortedChecker.getNumberOfPendingBlocks() != 0 || unsortedChecker.getNumberOfPendingBlocks() != 0) {
+          cerr << "Merging an unsorted input leaked " << sortedChecker.getNumberOfPendingBlocks() + unsortedChecker.getNumberOfPendingBlocks() << " blocks." << endl;
+          return 1;
+        }
+      }
+    }
+
+    //Binary files are read back identically, and indexed:
+    for (size_t chunkSize = 1; chunkSize <= 1000000; chunkSize *= 1000000) {
+      {
+        MafParser textParser(new MappedFileLineReader("example.maf"), true);
+        textParser.setVerbose(false);
+        ofstream binaryFile("example.bmaf", ios::out | ios::binary);
+        BinaryOutputMafIterator writer(&textParser, &binaryFile, "hg16", chunkSize);
+        writer.setVerbose(false);
+        parse(writer);
+      }
+      BinaryMafParser binaryParser("example.bmaf");
+      binaryParser.setVerbose(false);
+      vector<string> binaryBlocks = parse(binaryParser);
+      size_t found = binaryParser.findBlock("chr7", 27699740);
+      binaryParser.seekBlock(found);
+      vector<string> lastBlocks = parse(binaryParser);
+      remove("example.bmaf");
+      if (binaryBlocks != blocks1 || binaryParser.getNumberOfChunks() != (chunkSize == 1 ? 3 : 1)
+          || found != 1 || lastBlocks.size() != 2 || lastBlocks[0] != blocks1[1]) {
+        cerr << "Binary file differs: " << binaryBlocks.size() << " blocks in " << binaryParser.getNumberOfChunks() << " chunks." << endl;
+        return 1;
+      }
+    }
+
+    //Copies share their sequences until modified:
+    {
+      MafParser cowParser(new MappedFileLineReader("example.maf"), true);
+      cowParser.setVerbose(false);
+      unique_ptr<MafBlock> block(cowParser.nextBlock());
+      unique_ptr<MafBlock> copy(block->clone());
+      if (!block->isShared() || &copy->getSequence(0) != &block->getSequence(0)) {
+        cerr << "Block copy is not shared." << endl;
+        return 1;
+      }
+      copy->deleteSequence(0);
+      if (block->isShared() || copy->isShared() || block->getNumberOfSequences() != 5 || copy->getNumberOfSequences() != 4
+          || block->getSequence(0).getSpecies() != "hg16") {
+        cerr << "Copy on write failed." << endl;
+        return 1;
+      }
+      //Rows are removed in one pass, and only kept rows of a shared block are copied:
+      unique_ptr<MafBlock> subset(block->clone());
+      if (subset->keepSequences({ true, false, true, false, true }) != 2 || block->getNumberOfSequences() != 5
+          || subset->getNumberOfSequences() != 3 || subset->getSequence(1).getSpecies() != "baboon"
+          || subset->getNumberOfSpecies() != 3 || subset->getNumberOfSequencesForSpecies(subset->getSequence(2).getSpeciesId()) != 1
+          || !block->hasSequenceForSpecies("panTro1") || subset->hasSequenceForSpecies("panTro1")) {
+        cerr << "Row compaction failed." << endl;
+        return 1;
+      }
+    }
+
+    //Column tables hold the selected rows site by site, and are cached:
+    {
+      MafParser tableParser(new MappedFileLineReader("example.maf"), true);
+      tableParser.setVerbose(false);
+      unique_ptr<MafBlock> block(tableParser.nextBlock());
+      vector<string> selection = { "rn3", "hg16", "dog" };
+      const ColumnTable& table = block->getColumnTable(selection, false, true);
+      if (&block->getColumnTable(selection, false, true) != &table || table.getNumberOfRows() != 3
+          || table.getNumberOfSites() != block->getNumberOfSites()) {
+        cerr << "Column table is not cached." << endl;
+        return 1;
+      }
+      for (size_t i = 0; i < table.getNumberOfSites(); ++i) {
+        if (table.getState(i, 0) != block->getSequenceForSpecies("rn3")[i]
+            || table.getColumn(i)[1] != block->getSequenceForSpecies("hg16")[i] || table.getState(i, 2) != -1) {
+          cerr << "Column table differs from the block at site " << i << "." << endl;
+          return 1;
+        }
+      }
+    }
+
+    //Rows encoded as runs give the same states, coordinates and column counts:
+    {
+      MafParser runParser(new MappedFileLineReader("example.maf"));
+      runParser.setVerbose(false);
+      unique_ptr<MafBlock> block(runParser.nextBlock());
+      vector<string> allSpecies = block->getSpeciesList();
+      vector< unique_ptr<GapRunSequence> > encoded;
+      vector<const GapRunSequence*> rows;
+      for (size_t i = 0; i < block->getNumberOfSequences(); ++i) {
+        const MafSequence& sequence = block->getSequence(i);
+        encoded.push_back(unique_ptr<GapRunSequence>(new GapRunSequence(sequence)));
+        const GapRunSequence& row = *encoded.back();
+        rows.push_back(&row);
+        unique_ptr<MafSequence> unpacked(row.unpack());
+        if (row.getGenomicSize() != sequence.getGenomicSize() || unpacked->toString() != sequence.toString()
+            || row.getSequencePosition(3) != sequence.getSequencePosition(3) || row.getGenomicSize(2, 30) != sequence.getGenomicSize(2, 30)) {
+          cerr << "Run encoding differs for sequence " << sequence.getName() << "." << endl;
+          return 1;
+        }
+        for (size_t j = 0; j < row.size(); ++j)
+          if (row.getState(j) != sequence[j] || row.rank(j) != sequence.getGenomicSize(0, j))
+            return 1;
+        for (size_t k = 0; k < row.getGenomicSize(); ++k)
+          if (row.getAlignmentPosition(k) != sequence.getAlignmentPosition(k))
+            return 1;
+      }
+      ColumnCounts runCounts(rows, block->getNumberOfSites());
+      const ColumnCounts& counts = block->getColumnCounts(allSpecies, true);
+      for (size_t i = 0; i < counts.getNumberOfSites(); ++i) {
+        for (int state = -1; state <= 14; ++state) {
+          if (runCounts.getCount(i, state) != counts.getCount(i, state)) {
+            cerr << "Column counts from runs differ at site " << i << "." << endl;
+            return 1;
+          }
+        }
+      }
+    }
+
+    //Biallelic sites are packed into a haplotype matrix, with positions in the reference:
+    {
+      MafParser matrixParser(new MappedFileLineReader("example.maf"));
+      matrixParser.setVerbose(false);
+      HaplotypeMatrix matrix({ "hg16", "mm4" }, "chr7");
+      vector<uint64_t> positions;
+      unique_ptr<MafBlock> block;
+      while ((block = unique_ptr<MafBlock>(matrixParser.nextBlock()))) {
+        const MafSequence& hg16 = block->getSequenceForSpecies("hg16");
+        const MafSequence& mm4 = block->getSequenceForSpecies("mm4");
+        size_t nbVariants = positions.size();
+        uint64_t pos = hg16.start();
+        for (size_t i = 0; i < block->getNumberOfSites(); ++i) {
+          if (hg16[i] < 0)
+            continue;
+          if (hg16[i] <= 3 && mm4[i] >= 0 && mm4[i] <= 3 && hg16[i] != mm4[i])
+            positions.push_back(pos);
+          pos++;
+        }
+        if (matrix.addBlock(*block, "hg16") != positions.size() - nbVariants || matrix.getNumberOfVariants() != positions.size()) {
+          cerr << "Haplotype matrix has " << matrix.getNumberOfVariants() << " variants instead of " << positions.size() << "." << endl;
+          return 1;
+        }
+      }
+      for (size_t v = 0; v < matrix.getNumberOfVariants(); ++v) {
+        if (matrix.getPosition(v) != positions[v] || matrix.hasSecondAllele(v, 0) || !matrix.hasSecondAllele(v, 1)
+            || matrix.getFirstAllele(v) == matrix.getSecondAllele(v)) {
+          cerr << "Haplotype matrix differs at variant " << v << "." << endl;
+          return 1;
+        }
+      }
+      ostringstream matrixFile;
+      matrix.write(matrixFile);
+      size_t n = matrix.getNumberOfVariants();
+      if (matrixFile.str().substr(0, 8) != "BPPHAP01" || matrixFile.str().size() != 64 + 24 + 8 * n + (2 * n + 7) / 8 * 8 + 8 * n) {
+        cerr << "Haplotype matrix file has a wrong layout." << endl;
+        return 1;
+      }
+    }
+
+    //States, masks and sizes are computed together, with dots read as gaps:
+    {
+      istringstream dotted("##maf version=1\n\na score=0\ns hg16.chr7 10 3 + 100 Ac.-G\ns mm4.chr6 20 5 + 200 aCGTN\n\n");
+      MafParser dotParser(&dotted, true, true, MafParser::DOT_ASGAP);
+      dotParser.setVerbose(false);
+      unique_ptr<MafBlock> block(dotParser.nextBlock());
+      const MafSequence& hg16 = block->getSequenceForSpecies("hg16");
+      const vector<bool>& mask = dynamic_cast<const SequenceMask&>(hg16.getAnnotation(SequenceMask::MASK)).getMask();
+      if (hg16.getGenomicSize() != 3 || hg16.toString() != "AC--G" || !mask[1] || mask[0] || mask[2]
+          || block->getSequenceForSpecies("mm4").getGenomicSize() != 5) {
+        cerr << "Dotted sequence was not parsed correctly: " << hg16.toString() << "." << endl;
+        return 1;
+      }
+      //A moved-from sequence keeps annotations consistent with its empty content:
+      MafSequence source("hg16.chr7", "AC--G", 10, '+', 100);
+      source.addAnnotation(new SequenceMask(vector<bool>(source.size(), true)));
+      MafSequence moved(std::move(source));
+      if (moved.toString() != "AC--G" || source.size() != 0
+          || dynamic_cast<const SequenceMask&>(moved.getAnnotation(SequenceMask::MASK)).getMask().size() != 5
+          || dynamic_cast<const SequenceMask&>(source.getAnnotation(SequenceMask::MASK)).getMask().size() != 0) {
+        cerr << "Moved sequence has inconsistent annotations." << endl;
+        return 1;
+      }
+    }
+
+    //Several ranges of sites are removed at once, and genomic sizes are updated:
+    {
+      MafParser deleteParser(new MappedFileLineReader("example.maf"), true);
+      deleteParser.setVerbose(false);
+      deleteParser.nextBlock(); //Skip the first block.
+      unique_ptr<MafBlock> block(deleteParser.nextBlock());
+      unique_ptr<MafBlock> copy(block->clone());
+      vector< pair<size_t, size_t> > ranges = { make_pair(0, 1), make_pair(1, 1), make_pair(4, 2) };
+      copy->deleteSites(ranges);
+      for (size_t i = 0; i < block->getNumberOfSequences(); ++i) {
+        const MafSequence& seq = block->getSequence(i);
+        const MafSequence& compacted = copy->getSequence(i);
+        string expected = seq.toString().substr(2, 2);
+        size_t nbResidues = static_cast<size_t>(count_if(expected.begin(), expected.end(), [](char c) { return c != '-'; }));
+        if (compacted.toString() != expected || compacted.getGenomicSize() != nbResidues
+            || dynamic_cast<const SequenceMask&>(compacted.getAnnotation(SequenceMask::MASK)).getSize() != 2) {
+          cerr << "Sites were not removed correctly: " << compacted.toString() << " instead of " << expected << "." << endl;
+          return 1;
+        }
+      }
+      if (copy->getNumberOfSites() != 2 || block->getNumberOfSites() != 6) {
+        cerr << "Wrong number of sites after removal." << endl;
+        return 1;
+      }
+    }
+
+    //Species and chromosome names are interned:
+    {
+      MafSequence seq1("hg16.chr7", "ACGT"), seq2("hg16.chr7", "AC-T"), seq3("panTro1.chr7", "ACGT");
+      if (&seq1.getSpecies() != &seq2.getSpecies() || seq1.getSpeciesId() == seq3.getSpeciesId()
+          || seq1.getChromosomeId() != seq3.getChromosomeId()) {
+        cerr << "Sequence names are not interned." << endl;
+        return 1;
+      }
+      seq3.setSpecies("hg16");
+      seq2.setChromosome("chr8");
+      if (seq3.getName() != "hg16.chr7" || seq3.getSpeciesId() != seq1.getSpeciesId()
+          || seq2.getChromosome() != "chr8" || seq2.getChromosomeId() == seq1.getChromosomeId()) {
+        cerr << "Renamed sequences have wrong names." << endl;
+        return 1;
+      }
+    }
+
+    //A static pipeline gives the same blocks as the equivalent chain of iterators:
+    {
+      vector<string> species = {"hg16", "mm4"};
+      MafParser dynamicParser(new MappedFileLineReader("example.maf"), true);
+      dynamicParser.setVerbose(false);
+      SequenceFilterMafIterator dynamicSeqFilter(&dynamicParser, species);
+      dynamicSeqFilter.setVerbose(false);
+      FullGapFilterMafIterator dynamicFullGap(&dynamicSeqFilter, species);
+      dynamicFullGap.setVerbose(false);
+      BlockLengthMafIterator dynamicLength(&dynamicFullGap, 10);
+      dynamicLength.setVerbose(false);
+      vector<string> dynamicBlocks = parse(dynamicLength);
+
+      MafParser staticParser(new MappedFileLineReader("example.maf"), true);
+      staticParser.setVerbose(false);
+      SequenceFilterMafIterator seqFilter(0, species);
+      FullGapFilterMafIterator fullGap(0, species);
+      fullGap.setVerbose(false);
+      BlockLengthMafIterator length(0, 10);
+      BlockSizeMafStatistics blockSize;
+      auto sizeStage = makeStatisticsStage(&blockSize);
+      size_t nbBlocks = 0;
+      auto countStage = makeFunctionStage([&nbBlocks](MafBlock& block) { nbBlocks++; return true; });
+      auto pipeline = makeStaticPipeline(&staticParser, seqFilter, fullGap, length, sizeStage, countStage);
+      StaticPipelineMafIterator<decltype(pipeline)> staticIterator(&pipeline);
+      staticIterator.setVerbose(false);
+      vector<string> staticBlocks = parse(staticIterator);
+      if (staticBlocks != dynamicBlocks || staticBlocks.size() != 2 || nbBlocks != 2 || pipeline.getNumberOfInputBlocks() != 3
+          || blockSize.getResult().getValue("BlockSize") != 2) {
+        cerr << "Static pipeline failed: " << staticBlocks.size() << " blocks." << endl;
+        return 1;
+      }
+    }
+
+    //Typed properties, computed on demand:
+    {
+      static const MafPropertyKey<size_t> genomicSize("test.GenomicSize", true, &computeGenomicSize);
+      static const MafPropertyKey<string> label("test.Label");
+      MafParser propertyParser(new MappedFileLineReader("example.maf"), true);
+      propertyParser.setVerbose(false);
+      unique_ptr<MafBlock> block(propertyParser.nextBlock());
+      block->setProperty(label, new string("first"));
+      size_t size1 = block->getProperty(genomicSize);
+      size_t size2 = block->getProperty(genomicSize);
+      unique_ptr<MafBlock> copy(block->clone());
+      unique_ptr<MafBlock> copyWithCaches(block->clone(true));
+      if (size1 != 38 || size2 != 38 || nbComputedSizes != 1 || copy->hasProperty(genomicSize) || !copyWithCaches->hasProperty(genomicSize)
+          || copy->getProperty(label) != "first") {
+        cerr << "Typed properties failed." << endl;
+        return 1;
+      }
+      block->deleteSequence(0);
+      if (block->hasProperty(genomicSize) || !block->hasProperty(label) || block->getProperty(genomicSize) != 38 || nbComputedSizes != 2) {
+        cerr << "Typed caches were not discarded." << endl;
+        return 1;
+      }
+    }
+
+    //Concatenate all blocks in place:
+    {
+      MafParser concatParser(new MappedFileLineReader("example.maf"), true);
+      concatParser.setVerbose(false);
+      ConcatenateMafIterator concat(&concatParser, 1000, "hg16");
+      concat.setVerbose(false);
+      unique_ptr<MafBlock> block(concat.nextBlock());
+      MafParser refParser(new MappedFileLineReader("example.maf"), true);
+      refParser.setVerbose(false);
+      string refSeq;
+      while (MafBlock* refBlock = refParser.nextBlock()) {
+        refSeq += refBlock->getSequenceForSpecies("hg16").toString();
+        delete refBlock;
+      }
+      if (!block.get() || concat.nextBlock() || block->getNumberOfSites() != 61 || block->getNumberOfSequences() != 5
+          || block->getSequenceForSpecies("hg16").toString() != refSeq
+          || block->getSequenceForSpecies("hg16").getGenomicSize() != 57) {
+        cerr << "Concatenation failed." << endl;
+        return 1;
+      }
+    }
+
+    //Share one parse between two branches, one of them filtered:
+    {
+      MafParser teeParser(new MappedFileLineReader("example.maf"), true);
+      teeParser.setVerbose(false);
+      TeeMafIterator tee(&teeParser, 2);
+      tee.getBranch(0)->setVerbose(false);
+      tee.getBranch(1)->setVerbose(false);
+      BlockLengthMafIterator lengthFilter(tee.getBranch(1), 10);
+      lengthFilter.setVerbose(false);
+      vector<MafBlock*> blocks;
+      while (MafBlock* block = tee.getBranch(0)->nextBlock())
+        blocks.push_back(block);
+      if (blocks.size() != 3 || tee.getNumberOfBufferedBlocks() != 3 || tee.getBranch(1)->getNumberOfBufferedBlocks() != 3) {
+        cerr << "Tee buffering failed." << endl;
+        return 1;
+      }
+      MafBlock* first = lengthFilter.nextBlock();
+      MafBlock* second = lengthFilter.nextBlock();
+      if (first == blocks[0] || &first->getSequence(0) != &blocks[0]->getSequence(0) || &second->getSequence(0) != &blocks[2]->getSequence(0)
+          || lengthFilter.nextBlock() || tee.getNumberOfBufferedBlocks() != 0) {
+        cerr << "Tee branches do not share sequences." << endl;
+        return 1;
+      }
+      for (size_t i = 0; i < blocks.size(); ++i)
+        tee.getBranch(0)->recycle(blocks[i]);
+      lengthFilter.recycle(first);
+      lengthFilter.recycle(second);
+    }
+
+    //A branch can modify its blocks in place, without changing the ones of the other branches:
+    {
+      MafParser teeParser(new MappedFileLineReader("example.maf"), true);
+      teeParser.setVerbose(false);
+      TeeMafIterator tee(&teeParser, 2);
+      tee.getBranch(0)->setVerbose(false);
+      tee.getBranch(1)->setVerbose(false);
+      SequenceFilterMafIterator speciesFilter(tee.getBranch(1), { "hg16", "panTro1" });
+      speciesFilter.setVerbose(false);
+      speciesFilter.setLogStream(0);
+      vector<size_t> nbFiltered, nbSequences;
+      while (MafBlock* block = speciesFilter.nextBlock()) {
+        nbFiltered.push_back(block->getNumberOfSequences());
+        speciesFilter.recycle(block);
+      }
+      while (MafBlock* block = tee.getBranch(0)->nextBlock()) {
+        nbSequences.push_back(block->getNumberOfSequences());
+        tee.getBranch(0)->recycle(block);
+      }
+      if (nbFiltered != vector<size_t>({ 2, 2, 2 }) || nbSequences != vector<size_t>({ 5, 5, 4 }) || tee.getNumberOfBufferedBlocks() != 0) {
+        cerr << "Filtering a tee branch in place changed the other branch." << endl;
+        return 1;
+      }
+    }
+
+    //Pull two branches from two threads, which both fill the caches of the shared blocks:
+    {
+      MafParser teeParser(new MappedFileLineReader("example.maf"), true);
+      teeParser.setVerbose(false);
+      TeeMafIterator tee(&teeParser, 2);
+      vector<string> species = { "hg16", "panTro1", "baboon", "mm4", "rn3" };
+      vector<string> descs[2];
+      unsigned int nbGaps[2] = { 0, 0 };
+      bool failed[2] = { false, false };
+      vector<thread> threads;
+      for (size_t b = 0; b < 2; ++b) {
+        tee.getBranch(b)->setVerbose(false);
+        threads.push_back(thread([&, b]() {
+          try {
+            while (MafBlock* block = tee.getBranch(b)->nextBlock()) {
+              string desc = block->getDescription();
+              for (size_t i = 0; i < block->getNumberOfSequences(); ++i) {
+                const MafSequence& seq = block->getSequence(i);
+                desc += " " + seq.getDescription() + " " + seq.toString();
+              }
+              descs[b].push_back(desc);
+              const ColumnCounts& counts = block->getColumnCounts(species, false, true);
+              for (size_t i = 0; i < counts.getNumberOfSites(); ++i)
+                nbGaps[b] += counts.getNumberOfGaps(i);
+              block->getSequenceForSpecies("hg16").getAlignmentPosition(0);
+              tee.getBranch(b)->recycle(block);
+            }
+          } catch (exception&) {
+            failed[b] = true;
+          }
+        }));
+      }
+      for (size_t b = 0; b < 2; ++b)
+        threads[b].join();
+      if (failed[0] || failed[1] || descs[0] != blocks1 || descs[1] != blocks1
+          || nbGaps[0] != nbGaps[1] || tee.getNumberOfBufferedBlocks() != 0) {
+        cerr << "Tee branches pulled from two threads differ." << endl;
+        return 1;
+      }
+    }
+
+    //Record filter events in binary form, and read them back:
+    {
+      stringstream events;
+      {
+        MafParser eventParser(new MappedFileLineReader("example.maf"));
+        eventParser.setVerbose(false);
+        SequenceFilterMafIterator sequenceFilter(&eventParser, {"hg16", "mm4"});
+        sequenceFilter.setVerbose(false);
+        shared_ptr<BinaryMafEventSink> sink(new BinaryMafEventSink(&events));
+        sequenceFilter.setEventSink(sink);
+        while (MafBlock* block = sequenceFilter.nextBlock())
+          delete block;
+        if (sink->getNumberOfEvents() != 8) {
+          cerr << "Wrong number of events: " << sink->getNumberOfEvents() << endl;
+          return 1;
+        }
+      }
+      BinaryMafEventReader eventReader(&events);
+      MafEventRecord record;
+      if (!eventReader.nextEvent(record) || record.name != "sequence_removed"
+          || record.toString() != "SEQUENCE FILTER: remove sequence 'panTro1' from current block 5x42.") {
+        cerr << "Events could not be read back." << endl;
+        return 1;
+      }
+    }
+
+    //Index the file and retrieve the second block only:
+    MafParser indexParser(new MappedFileLineReader("example.maf"));
+    indexParser.setVerbose(false);
+    unique_ptr<MafIndex> index(MafIndex::build(indexParser, "hg16"));
+    index->write("example.maf.mai");
+    index.reset(MafIndex::read("example.maf.mai"));
+    remove("example.maf.mai");
+    if (index->getNumberOfBlocks() != 3) {
+      cerr << "Wrong number of indexed blocks: " << index->getNumberOfBlocks() << endl;
+      return 1;
+    }
+    MafParser regionParser(new MappedFileLineReader("example.maf"));
+    regionParser.setVerbose(false);
+    regionParser.selectRegion(*index, "chr7", 27699740, 27699742);
+    vector<string> blocks3 = parse(regionParser);
+    if (blocks3.size() != 1 || blocks3[0] != blocks1[1]) {
+      cerr << "Indexed access failed." << endl;
+      return 1;
+    }
+
+    //Sample blocks and sites reproducibly, from the stream or from the index:
+    {
+      vector< vector<string> > samples;
+      for (size_t i = 0; i < 2; ++i) {
+        MafParser sampledParser(new MappedFileLineReader("example.maf"));
+        sampledParser.setVerbose(false);
+        SamplingMafIterator sampler(&sampledParser, 2, SamplingMafIterator::BLOCKS, 42);
+        sampler.setVerbose(false);
+        samples.push_back(parse(sampler));
+        if (sampler.getPopulationSize() != 3)
+          return 1;
+      }
+      if (samples[0] != samples[1] || samples[0].size() != 2 || find(blocks1.begin(), blocks1.end(), samples[0][0]) == blocks1.end()
+          || find(blocks1.begin(), blocks1.end(), samples[0][0]) >= find(blocks1.begin(), blocks1.end(), samples[0][1])) {
+        cerr << "Block sampling is not reproducible." << endl;
+        return 1;
+      }
+      MafParser siteParser(new MappedFileLineReader("example.maf"));
+      siteParser.setVerbose(false);
+      SamplingMafIterator sites(&siteParser, 5, SamplingMafIterator::SITES, 7);
+      sites.setVerbose(false);
+      vector<string> sampledSites = parse(sites);
+      if (sampledSites.size() != 5 || sites.getPopulationSize() != 42 + 6 + 13) {
+        cerr << "Site sampling failed: " << sampledSites.size() << " sites out of " << sites.getPopulationSize() << "." << endl;
+        return 1;
+      }
+      MafParser indexedParser(new MappedFileLineReader("example.maf"));
+      indexedParser.setVerbose(false);
+      SamplingMafIterator indexed(&indexedParser, *index, 2, 42);
+      indexed.setVerbose(false);
+      vector<string> indexedSample = parse(indexed);
+      if (indexedSample.size() != 2 || indexed.getPopulationSize() != 3
+          || find(blocks1.begin(), blocks1.end(), indexedSample[1]) == blocks1.end()) {
+        cerr << "Indexed sampling failed." << endl;
+        return 1;
+      }
+      //When all blocks are sampled, estimates are exact:
+      MafParser fullParser(new MappedFileLineReader("example.maf"));
+      fullParser.setVerbose(false);
+      SamplingMafIterator full(&fullParser, 10, SamplingMafIterator::BLOCKS, 1);
+      full.setVerbose(false);
+      BlockLengthMafStatistics blockLength;
+      SequenceStatisticsMafIterator stats(&full, { &blockLength });
+      stats.setVerbose(false);
+      SampleSummaryIterationListener summary(&stats, &full);
+      stats.addIterationListener(&summary);
+      parse(stats);
+      SampleSummaryIterationListener::Estimate mean = summary.getEstimate(0);
+      SampleSummaryIterationListener::Estimate total = summary.getEstimate(0, 0.95, true);
+      if (mean.nbValues != 3 || abs(mean.mean - 61. / 3.) > 1e-9 || abs(mean.upper - mean.lower) > 1e-9 || abs(total.mean - 61.) > 1e-9) {
+        cerr << "Sample summary failed: mean " << mean.mean << " [" << mean.lower << ", " << mean.upper << "]." << endl;
+        return 1;
+      }
+    }
+
+    //Process each block as a separate region, and compare with a sequential run:
+    {
+      vector<string> msmcSpecies;
+      msmcSpecies.push_back("hg16");
+      msmcSpecies.push_back("mm4");
+      vector<MafRegion> regions = RegionParallelMafRunner::makeRegions(*index, 1);
+      if (regions.size() != 3 || RegionParallelMafRunner::makeRegions(*index).size() != 1) {
+        cerr << "Wrong number of regions: " << regions.size() << endl;
+        return 1;
+      }
+      ostringstream serialOutput, parallelOutput;
+      {
+        MafParser serialParser(new MappedFileLineReader("example.maf"));
+        serialParser.setVerbose(false);
+        MsmcOutputMafIterator msmc(&serialParser, &serialOutput, msmcSpecies, "hg16");
+        msmc.setVerbose(false);
+        parse(msmc);
+      }
+      RegionParallelMafRunner runner("example.maf", *index, [&](MafRegionPipeline& pipeline) {
+        MafIterator* msmc = pipeline.add(new MsmcOutputMafIterator(pipeline.getInput(), &pipeline.getOutput(), msmcSpecies, "hg16"));
+        msmc->setVerbose(false);
+        return msmc;
+      }, 2);
+      if (runner.run(regions, parallelOutput) != 3 || parallelOutput.str() != serialOutput.str()) {
+        cerr << "Region-parallel run differs from the sequential one:" << endl << parallelOutput.str();
+        return 1;
+      }
+
+      //Split the file in two shards, run them separately, and merge them back:
+      unique_ptr<MafShardPlan> plan(MafShardPlan::build(*index, "example.maf", 2, MafShardPlan::BY_SITES, 1));
+      plan->write("example.maf.shards");
+      plan.reset(MafShardPlan::read("example.maf.shards"));
+      if (plan->getNumberOfShards() != 2 || plan->getShard(0).size() != 1 || plan->getShard(1).size() != 2
+          || plan->getWeight(0) != 38 || plan->getWeight(1) != 19) {
+        cerr << "Wrong shard plan." << endl;
+        return 1;
+      }
+      vector<string> shardOutputs;
+      vector<MafShardSummary> summaries;
+      for (size_t k = 0; k < plan->getNumberOfShards(); ++k) {
+        string path = "example.maf.shard" + TextTools::toString(k);
+        ofstream shardOutput(path.c_str(), ios::out | ios::binary);
+        uint64_t nbShardBlocks = runner.run(plan->getShard(k), shardOutput);
+        MafShardSummary(runner, nbShardBlocks).write(path + ".summary");
+        shardOutputs.push_back(path);
+        summaries.push_back(MafShardSummary::read(path + ".summary"));
+      }
+      ostringstream shardedOutput;
+      if (MafShardMerger::mergeOutputs(shardOutputs, summaries, shardedOutput) != 3 || shardedOutput.str() != serialOutput.str()) {
+        cerr << "Sharded run differs from the sequential one:" << endl << shardedOutput.str();
+        return 1;
+      }
+      remove("example.maf.shards");
+      for (size_t k = 0; k < shardOutputs.size(); ++k) {
+        remove(shardOutputs[k].c_str());
+        remove((shardOutputs[k] + ".summary").c_str());
+      }
+
+      //Interrupt a run after two blocks, and resume it from the last checkpoint:
+      remove("example.maf.checkpoint");
+      for (unsigned int attempt = 0; attempt < 2; ++attempt) {
+        ofstream msmcFile("example.msmc", attempt == 0 ? ios::out | ios::trunc : ios::out | ios::app);
+        MafParser checkpointParser(new MappedFileLineReader("example.maf"));
+        checkpointParser.setVerbose(false);
+        OrderFilterMafIterator order(&checkpointParser, "hg16");
+        order.setVerbose(false);
+        MsmcOutputMafIterator msmc(&order, &msmcFile, msmcSpecies, "hg16");
+        msmc.setVerbose(false);
+        MafCheckpointer checkpointer(&msmc, "example.maf.checkpoint", 0.);
+        checkpointer.addOutputFile("example.msmc", &msmcFile);
+        if (checkpointer.resume() != (attempt == 1)) {
+          cerr << "Checkpoint not found." << endl;
+          return 1;
+        }
+        size_t nbRead = 0;
+        while (MafBlock* block = msmc.nextBlock()) {
+          delete block;
+          if (attempt == 0 && ++nbRead == 2) break;
+        }
+        if (checkpointer.getNumberOfCheckpoints() == 0) {
+          cerr << "No checkpoint written." << endl;
+          return 1;
+        }
+      }
+      ifstream msmcFile("example.msmc");
+      stringstream resumedOutput;
+      resumedOutput << msmcFile.rdbuf();
+      if (resumedOutput.str() != serialOutput.str()) {
+        cerr << "Resumed run differs from the sequential one:" << endl << resumedOutput.str();
+        return 1;
+      }
+      msmcFile.close();
+      remove("example.maf.checkpoint");
+      remove("example.msmc");
+    }
+
+    //Build a liftover index from human to mouse, and translate a few positions:
+    MafParser liftParser(new MappedFileLineReader("example.maf"));
+    liftParser.setVerbose(false);
+    unique_ptr<LiftoverIndex> liftover(LiftoverIndex::build(liftParser, "hg16", "mm4"));
+    liftover->write("example.maf.lift");
+    liftover.reset(LiftoverIndex::read("example.maf.lift"));
+    remove("example.maf.lift");
+    vector<uint64_t> positions = {27578828, 27578829, 27699739};
+    vector<LiftoverIndex::Position> lifted;
+    liftover->lift("chr7", positions, lifted);
+    if (lifted[0].mapped || !lifted[1].mapped || lifted[1].position != 53215344 || !lifted[2].mapped || lifted[2].position != 53303881
+        || liftover->getTargetChromosomes()[lifted[1].chr] != "chr6") {
+      cerr << "Liftover failed." << endl;
+      return 1;
+    }
+
+    //Write a BGZF compressed copy and parse it again:
+    {
+      ofstream output("example.maf.gz", ios::out | ios::binary);
+      //The profiler must be destroyed after the iterators it is attached to:
+      PipelineProfiler profiler(ApplicationTools::message.get());
+      MafParser copyParser(new MappedFileLineReader("example.maf"), true);
+      copyParser.setVerbose(false);
+      OutputMafIterator writer(&copyParser, &output, true, true);
+      writer.setVerbose(false);
+      profiler.attach(&writer);
+      while (MafBlock* block = writer.nextBlock())
+        delete block;
+      if (profiler.getNumberOfStages() != 2 || profiler.getStage(0).blocksOut != 3 || profiler.getStage(1).blocksIn != 3
+          || profiler.getStage(1).blocksOut != 3 || profiler.getStage(1).sitesIn != profiler.getStage(0).sitesOut
+          || profiler.getStage(0).bytesRead != 971 || profiler.getStage(1).bytesWritten == 0) {
+        cerr << "Profiling failed." << endl;
+        return 1;
+      }
+    }
+    MafParser compressedParser(new CompressedLineReader("example.maf.gz"), true);
+    compressedParser.setVerbose(false);
+    vector<string> blocks4 = parse(compressedParser);
+    if (blocks4 != blocks1) {
+      cerr << "Compressed output could not be read back." << endl;
+      return 1;
+    }
+    remove("example.maf.gz");
+
+    //Convert aligned contigs from FASTA, with one or several rows per block:
+    {
+      string fasta = ">hg18:chr7:100:+:6\nACG-TA\n\n>mm9:chr6:200:-:6\nAC\nGGTA\r\n>hg18:chr7:106:+:4\nTTNA\n>contig1\nAC\n";
+      SequenceStreamToMafIterator single(new MemoryLineReader(fasta.data(), fasta.size()));
+      single.setVerbose(false);
+      vector<string> blocks5 = parse(single);
+      SequenceStreamToMafIterator grouped(new MemoryLineReader(fasta.data(), fasta.size()), true, true);
+      grouped.setVerbose(false);
+      vector<string> blocks6 = parse(grouped);
+      if (blocks5.size() != 4 || blocks6.size() != 3
+          || blocks6[0].find("mm9.chr6-:200-206 ACGGTA") == string::npos) {
+        cerr << "FASTA conversion failed." << endl;
+        return 1;
+      }
+    }
+    //Monitor the windows waiting in a split iterator, then limit them:
+    {
+      MafParser windowParser(new MappedFileLineReader("example.maf"));
+      windowParser.setVerbose(false);
+      WindowSplitMafIterator windows(&windowParser, 10, WindowSplitMafIterator::RAGGED_LEFT);
+      windows.setVerbose(false);
+      windows.monitorBuffers(true);
+      vector<string> blocks7 = parse(windows);
+      if (blocks7.size() != 5 || windows.getBufferStatistics().peakNbBlocks != 3
+          || windows.getBufferStatistics().nbBlocks != 0 || windows.getBufferStatistics().peakNbBytes == 0) {
+        cerr << "Buffer monitoring failed." << endl;
+        return 1;
+      }
+      MafParser limitedParser(new MappedFileLineReader("example.maf"));
+      limitedParser.setVerbose(false);
+      WindowSplitMafIterator limited(&limitedParser, 10, WindowSplitMafIterator::RAGGED_LEFT);
+      limited.setVerbose(false);
+      limited.setBufferLimits(2, 0);
+      try {
+        parse(limited);
+        cerr << "Buffer limits were not enforced." << endl;
+        return 1;
+      } catch (Exception& ex) {}
+    }
+    //Split blocks give the same pieces through nextBlock and nextBlockView, and each input block is recycled once:
+    {
+      string qualityMaf = "##maf version=1\n\n"
+        "a score=1\n"
+        "s hg16.chr7 100 22 + 1000 ACGTACGTAC--GTACGTACGTAC\n"
+        "q hg16.chr7               9999999999--992229999922\n"
+        "s mm4.chr6  200 24 + 1000 ACGTACGTACGTGTACGTACGTAC\n"
+        "q mm4.chr6                999999999999999999999997\n"
+        "s rn3.chr4  300 24 + 1000 ACGTACGTACGTGTACGTACGTAC\n\n"
+        "a score=2\n"
+        "s hg16.chr7 200 8 + 1000 ACGTACGT\n"
+        "q hg16.chr7              11119999\n"
+        "s mm4.chr6  300 8 + 1000 ACGTACGT\n"
+        "q mm4.chr6               99999999\n\n";
+      SequenceFeatureSet features;
+      features.addFeature(BasicSequenceFeature("f1", "chr7", "test", "exon", 27578830, 27578840, '+'));
+      features.addFeature(BasicSequenceFeature("f2", "chr7", "test", "exon", 27578860, 27578880, '+'));
+      features.addFeature(BasicSequenceFeature("f3", "chr7", "test", "exon", 27707225, 27707227, '+'));
+      //Kept (K) and trashed (T) pieces, with the coordinates and content of their first row, as produced before blocks were split into views:
+      vector< vector<string> > expected = {
+        { "K 5x10 hg16.chr7+:27578828-27578837 AAA-GGGAAT",
+          "K 5x10 hg16.chr7+:27578837-27578847 GTTAACCAAA",
+          "K 5x10 hg16.chr7+:27578847-27578854 TGA---ATTG",
+          "K 5x12 hg16.chr7+:27578854-27578866 TCTCTTACGGTG",
+          "K 5x6 hg16.chr7+:27699739-27699745 TAAAGA",
+          "K 4x13 hg16.chr7+:27707221-27707234 GCAGCTGAAAACA" },
+        { "K 5x1 hg16.chr7+:27578865-27578866 G",
+          "T 5x41 hg16.chr7+:27578828-27578865 AAA-GGGAATGTTAACCAAATGA---ATTGTCTCTTACGGT",
+          "K 5x1 hg16.chr7+:27699744-27699745 A",
+          "T 5x5 hg16.chr7+:27699739-27699744 TAAAG",
+          "K 4x1 hg16.chr7+:27707233-27707234 A",
+          "T 4x12 hg16.chr7+:27707221-27707233 GCAGCTGAAAAC" },
+        { "K 5x14 hg16.chr7+:27578834-27578848 AATGTTAACCAAAT",
+          "T 5x7 hg16.chr7+:27578828-27578834 AAA-GGG",
+          "T 5x5 hg16.chr7+:27578848-27578850 GA---",
+          "T 5x8 hg16.chr7+:27578851-27578859 TTGTCTCT",
+          "K 5x1 hg16.chr7+:27578850-27578851 A",
+          "K 5x7 hg16.chr7+:27578859-27578866 TACGGTG",
+          "K 5x6 hg16.chr7+:27699739-27699745 TAAAGA",
+          "K 4x1 hg16.chr7+:27707221-27707222 G",
+          "T 4x10 hg16.chr7+:27707222-27707232 CAGCTGAAAA",
+          "K 4x2 hg16.chr7+:27707232-27707234 CA" },
+        { "K 5x42 hg16.chr7+:27578828-27578866 AAA-GGGAATGTTAACCAAATGA---ATTGTCTCTTACGGTG",
+          "K 5x1 hg16.chr7+:27699744-27699745 A",
+          "T 5x5 hg16.chr7+:27699739-27699744 TAAAG",
+          "K 4x1 hg16.chr7+:27707233-27707234 A",
+          "T 4x12 hg16.chr7+:27707221-27707233 GCAGCTGAAAAC" },
+        { "K 3x12 hg16.chr7+:100-110 ACGTACGTAC--",
+          "T 3x7 hg16.chr7+:110-117 GTACGTA",
+          "K 3x5 hg16.chr7+:117-122 CGTAC",
+          "K 2x2 hg16.chr7+:206-208 GT",
+          "T 2x6 hg16.chr7+:200-206 ACGTAC" },
+        { "K 5x2 hg16.chr7+:27578828-27578830 AA",
+          "T 5x11 hg16.chr7+:27578830-27578840 A-GGGAATGTT",
+          "T 5x6 hg16.chr7+:27578860-27578866 ACGGTG",
+          "K 5x23 hg16.chr7+:27578840-27578860 AACCAAATGA---ATTGTCTCTT",
+          "K 5x6 hg16.chr7+:27699739-27699745 TAAAGA",
+          "K 4x4 hg16.chr7+:27707221-27707225 GCAG",
+          "T 4x2 hg16.chr7+:27707225-27707227 CT",
+          "K 4x7 hg16.chr7+:27707227-27707234 GAAAACA" } };
+      for (size_t f = 0; f < expected.size(); ++f) {
+        vector<string> pieces[2];
+        for (size_t pass = 0; pass < 2; ++pass) {
+          MafParser splitParser(f == 4 ? static_cast<LineReader*>(new MemoryLineReader(qualityMaf.data(), qualityMaf.size()))
+                                       : static_cast<LineReader*>(new MappedFileLineReader("example.maf")), true);
+          splitParser.setVerbose(false);
+          RecycleCheckMafIterator checker(&splitParser);
+          unique_ptr<MafIterator> split(splitIterator(f, &checker, features));
+          split->setVerbose(false);
+          dynamic_cast<AbstractFilterMafIterator*>(split.get())->setLogStream(0);
+          MafTrashIterator* trash = dynamic_cast<MafTrashIterator*>(split.get());
+          MafBlockView view;
+          while (true) {
+            string desc;
+            if (pass == 0) {
+              MafBlock* block = split->nextBlock();
+              if (!block) break;
+              for (size_t i = 0; i < block->getNumberOfSequences(); ++i)
+                desc += " " + block->getSequence(i).getDescription() + " " + block->getSequence(i).toString();
+              desc = block->getDescription() + desc;
+              split->recycle(block);
+            } else {
+              if (!split->nextBlockView(view)) break;
+              for (size_t i = 0; i < view.getNumberOfSequences(); ++i) {
+                const MafSequence& seq = view.getSequence(i);
+                unique_ptr<MafSequence> sub(view.getSubSequence(i));
+                desc += " " + seq.getName() + seq.getStrand() + ":"
+                  + TextTools::toString(view.start(i)) + "-" + TextTools::toString(view.stop(i)) + " " + sub->toString();
+              }
+              desc = view.getDescription() + desc;
+            }
+            pieces[pass].push_back("K " + desc);
+            while (MafBlock* removed = trash ? trash->nextRemovedBlock() : 0) {
+              pieces[pass].push_back("T " + removed->getDescription() + " " + removed->getSequence(0).getDescription() + " " + removed->getSequence(0).toString());
+              split->recycle(removed);
+            }
+          }
+          view = MafBlockView();
+          if (checker.getNumberOfPendingBlocks() != 0 || checker.getNumberOfDoubleRecycles() != 0) {
+            cerr << "Split iterator " << f << " did not recycle each input block once: " << checker.getNumberOfPendingBlocks()
+                 << " not recycled, " << checker.getNumberOfDoubleRecycles() << " recycled twice." << endl;
+            return 1;
+          }
+        }
+        if (pieces[0] != pieces[1]) {
+          cerr << "Split iterator " << f << " does not give the same pieces as blocks and as views." << endl;
+          return 1;
+        }
+        for (size_t i = 0; i < pieces[0].size(); ++i) {
+          //Only keep the first row:
+          size_t pos = pieces[0][i].find(' ', pieces[0][i].find(' ', pieces[0][i].find(' ', 2) + 1) + 1);
+          pieces[0][i] = pieces[0][i].substr(0, pos);
+        }
+        if (pieces[0] != expected[f]) {
+          cerr << "Split iterator " << f << " changed its output:" << endl;
+          for (size_t i = 0; i < pieces[0].size(); ++i)
+            cerr << pieces[0][i] << endl;
+          return 1;
+        }
+      }
+    }
+    //Alignment filters remove the same regions as before windows were evaluated from per-column caches:
+    {
+      vector<string> all = {"hg16", "panTro1", "baboon", "mm4", "rn3"};
+      double maxEnt[] = {0., 0.15, 0.25, 0.35};
+      vector<string> expected = {
+        "K:27578828-27578831 T:27578831-27578850 T:27578850-27578865 K:27578850-27578850 K:27578865-27578866 K:27699744-27699745 T:27699739-27699744 K:27707221-27707234 ",
+        "K:27578850-27578850 T:27578828-27578850 T:27578850-27578865 K:27578865-27578866 K:27699744-27699745 T:27699739-27699744 K:27707221-27707234 ",
+        "K:27578865-27578866 T:27578828-27578865 K:27699744-27699745 T:27699739-27699744 K:27707221-27707234 ",
+        "K:27578865-27578866 T:27578828-27578865 K:27699744-27699745 T:27699739-27699744 K:27707221-27707222 T:27707222-27707232 K:27707232-27707234 ",
+        "K:27578865-27578866 T:27578828-27578865 K:27699744-27699745 T:27699739-27699744 K:27707232-27707234 T:27707221-27707232 ",
+        "K:27578828-27578830 T:27578830-27578832 T:27578849-27578851 K:27578832-27578849 K:27578851-27578866 K:27699739-27699745 K:27707221-27707234 ",
+        "K:27578835-27578846 T:27578828-27578835 T:27578846-27578854 K:27578854-27578866 K:27699739-27699745 K:27707221-27707234 " };
+      for (size_t f = 0; f < expected.size(); ++f) {
+        MafParser alnParser(new MappedFileLineReader("example.maf"));
+        alnParser.setVerbose(false);
+        unique_ptr<AbstractFilterMafIterator> filter;
+        if (f < 4)
+          filter.reset(new AlignmentFilterMafIterator(&alnParser, all, 3, 1, 0u, maxEnt[f], true, true));
+        else if (f == 4)
+          filter.reset(new AlignmentFilterMafIterator(&alnParser, all, 3, 2, 0., 0.35, true, false));
+        else if (f == 5)
+          filter.reset(new AlignmentFilter2MafIterator(&alnParser, all, 3, 2, 2u, 0u, true, true));
+        else
+          filter.reset(new AlignmentFilter2MafIterator(&alnParser, all, 5, 1, 0., 0u, true, false));
+        string regions = splitRegions(*filter);
+        if (regions != expected[f]) {
+          cerr << "Alignment filter " << f << " changed its regions: " << regions << endl;
+          return 1;
+        }
+      }
+    }
+    //Mask filter, on short blocks and on masks spanning several 64-bit words:
+    {
+      string longMaf = "##maf version=1\n\na score=1\n"
+        "s hg16.chr7 100 150 + 1000 ACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTacgtacgtacGTACGTACGTACGTACGTACGT"
+        "ACGTACGTACGTACGTACGTACGTACGTacgtacgtacGTACGTACGTACGTACGTAC\n"
+        "s mm4.chr6  200 150 + 1000 ACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACgtacGTACGTACGTACGTACGTACGTACGT"
+        "ACGTACGTACGTACGTACGTACGTACGTACGTACGtaCGTACGTACGTACGTACGTAC\n\n";
+      unsigned int params[5][4] = {{0, 3, 1, 0}, {0, 4, 3, 5}, {0, 10, 1, 2}, {1, 3, 3, 0}, {1, 10, 1, 0}};
+      vector<string> expected = {
+        "K:100-158 T:158-172 T:218-232 K:172-218 K:232-250 ",
+        "K:100-160 T:160-167 T:226-230 K:167-226 K:230-250 ",
+        "K:100-153 T:153-177 T:213-238 K:177-213 K:238-250 ",
+        "K:27578828-27578866 K:27699742-27699745 T:27699739-27699742 K:27707230-27707230 T:27707221-27707230 T:27707230-27707233 K:27707233-27707234 ",
+        //The second block is smaller than the window, and entirely removed:
+        "K:27578828-27578866 K:27707233-27707234 T:27707221-27707233 " };
+      for (size_t f = 0; f < expected.size(); ++f) {
+        MafParser maskParser(params[f][0] == 0 ? static_cast<LineReader*>(new MemoryLineReader(longMaf.data(), longMaf.size()))
+                                               : static_cast<LineReader*>(new MappedFileLineReader("example.maf")), true);
+        maskParser.setVerbose(false);
+        vector<string> maskSpecies = {"hg16", params[f][0] == 0 ? "mm4" : "rn3"};
+        MaskFilterMafIterator maskFilter(&maskParser, maskSpecies, params[f][1], params[f][2], params[f][3], true);
+        string regions = splitRegions(maskFilter);
+        if (regions != expected[f]) {
+          cerr << "Mask filter " << f << " changed its regions: " << regions << endl;
+          return 1;
+        }
+      }
+    }
+    //Quality filter, with missing scores, contiguous regions in the last window and blocks smaller than the window:
+    {
+      vector<int> scores1 = {9, 9, 10, 1, -1, -1, 1, 1, -2, 9};
+      vector<int> scores2 = {9, 9, 9, 9, 9, 9, 1, 1, 9, 9};
+      vector<const vector<int>*> scores = {&scores1, &scores2};
+      vector<double> means;
+      QualityFilterMafIterator::computeWindowMeanQualities(scores, 2, {2, 4, 6, 8, 10}, means);
+      vector<double> expectedMeans = {9., 7.25, 9., 1., 6.75};
+      vector<int> missing = {-1, -1, 5};
+      vector<double> missingMeans;
+      QualityFilterMafIterator::computeWindowMeanQualities({&missing}, 2, {2}, missingMeans);
+      if (means != expectedMeans || missingMeans.size() != 1 || !std::isnan(missingMeans[0])) {
+        cerr << "Wrong window mean qualities." << endl;
+        return 1;
+      }
+      string qualityMaf = "##maf version=1\n\n"
+        "a score=1\n"
+        "s hg16.chr7 100 10 + 1000 ACGT--ACGTAC\n"
+        "q hg16.chr7               99F1--11?999\n"
+        "s mm4.chr6  200 12 + 1000 ACGTACGTACGT\n"
+        "q mm4.chr6                999999119999\n\n"
+        "a score=2\n"
+        "s hg16.chr7 200 7 + 1000 ACGTACG\n"
+        "q hg16.chr7              1111119\n"
+        "s mm4.chr6  300 7 + 1000 ACGTACG\n"
+        "q mm4.chr6               1111119\n\n"
+        "a score=3\n"
+        "s hg16.chr7 300 6 + 1000 ACGTAC\n"
+        "q hg16.chr7              000000\n"
+        "s mm4.chr6  400 6 + 1000 ACGTAC\n"
+        "q mm4.chr6               000000\n\n"
+        "a score=4\n"
+        "s hg16.chr7 400 6 + 1000 ACGTAC\n"
+        "q hg16.chr7              000000\n"
+        "s mm4.chr6  500 6 + 1000 ACGTAC\n\n"
+        "a score=5\n"
+        "s hg16.chr7 500 3 + 1000 ACG\n"
+        "q hg16.chr7              000\n"
+        "s mm4.chr6  600 3 + 1000 ACG\n"
+        "q mm4.chr6               000\n\n";
+      unsigned int params[3][3] = {{2, 2, 2}, {3, 1, 5}, {4, 3, 8}};
+      vector<string> expected = {
+        //In the last window of the second block, contiguous regions are not merged:
+        "K:100-104 T:104-106 K:106-110 K:204-204 T:200-204 T:204-206 K:206-207 K:302-302 T:300-302 T:302-304 K:304-306 K:400-406 K:502-503 T:500-502 ",
+        "K:100-104 T:104-108 K:108-110 K:206-207 T:200-206 K:305-306 T:300-305 K:400-406 ",
+        //The last block is smaller than the window, and entirely removed:
+        "K:100-103 T:103-108 K:108-110 K:204-207 T:200-204 K:304-306 T:300-304 K:400-406 " };
+      for (size_t f = 0; f < expected.size(); ++f) {
+        MafParser qualityParser(new MemoryLineReader(qualityMaf.data(), qualityMaf.size()));
+        qualityParser.setVerbose(false);
+        QualityFilterMafIterator qualityFilter(&qualityParser, {"hg16", "mm4"}, params[f][0], params[f][1], params[f][2], true);
+        string regions = splitRegions(qualityFilter);
+        if (regions != expected[f]) {
+          cerr << "Quality filter " << f << " changed its regions: " << regions << endl;
+          return 1;
+        }
+      }
+    }
+    //Entropy filter, when a selected species is missing from a block and not replaced by gaps:
+    {
+      vector<string> expected = {
+        "K:27578834-27578848 T:27578828-27578834 T:27578848-27578850 T:27578851-27578859 K:27578850-27578851 K:27578859-27578866 K:27699739-27699745 K:27707221-27707222 T:27707222-27707232 K:27707232-27707234 ",
+        "K:27578828-27578829 T:27578829-27578850 T:27578850-27578861 K:27578850-27578850 K:27578861-27578866 K:27699744-27699745 T:27699739-27699744 K:27707233-27707234 T:27707221-27707233 " };
+      for (size_t f = 0; f < 4; ++f) {
+        unsigned int maxPos = static_cast<unsigned int>(f / 2);
+        bool ignoreGaps = (f % 2 == 1);
+        MafParser entropyParser(new MappedFileLineReader("example.maf"));
+        entropyParser.setVerbose(false);
+        EntropyFilterMafIterator entropyFilter(&entropyParser, {"rn3", "hg16", "mm4"}, 4, 1, 0.1, maxPos, true, false, ignoreGaps);
+        string regions = splitRegions(entropyFilter);
+        //The third block has no rn3 sequence, and is filtered on the other species only:
+        MafParser presentParser(new MappedFileLineReader("example.maf"));
+        presentParser.setVerbose(false);
+        EntropyFilterMafIterator presentFilter(&presentParser, {"hg16", "mm4"}, 4, 1, 0.1, maxPos, true, false, ignoreGaps);
+        string presentRegions = splitRegions(presentFilter);
+        size_t pos = regions.find(":27707");
+        size_t presentPos = presentRegions.find(":27707");
+        if (pos == string::npos || presentPos == string::npos
+            || regions.substr(pos - 1) != presentRegions.substr(presentPos - 1)
+            || (f == 1 && regions != expected[0]) || (f == 2 && regions != expected[1])) {
+          cerr << "Entropy filter " << f << " changed its regions: " << regions << endl;
+          return 1;
+        }
+      }
+      //Blocks smaller than the window are evaluated as a single window, and kept or entirely removed:
+      string shortMaf = "##maf version=1\n\n"
+        "a score=0\ns hg16.chr1 100 3 + 1000 ACG\ns mm4.chr1 100 3 + 1000 ATG\ns rn3.chr1 100 3 + 1000 AAG\n\n"
+        "a score=0\ns hg16.chr1 200 3 + 1000 AAA\ns mm4.chr1 200 3 + 1000 AAA\ns rn3.chr1 200 3 + 1000 AAA\n\n";
+      vector<string> expectedShort = { "K:100-103 ", "" };
+      for (unsigned int maxPos = 0; maxPos < 2; ++maxPos) {
+        istringstream shortInput(shortMaf);
+        MafParser shortParser(&shortInput);
+        shortParser.setVerbose(false);
+        EntropyFilterMafIterator shortFilter(&shortParser, {"rn3", "hg16", "mm4"}, 5, 1, 0.1, maxPos, true, false, false);
+        string regions = splitRegions(shortFilter);
+        if (regions != expectedShort[maxPos]) {
+          cerr << "Entropy filter changed the regions of short blocks: " << regions << endl;
+          return 1;
+        }
+      }
+    }
+    //Full gap filter and site statistics, which share the column counts of a selection:
+    {
+      vector< vector<string> > selections = { { "hg16", "rn3" }, { "mm4", "rn3" } };
+      vector<string> expected = {
+        "AAAGGGAATGTTAACCAAATGA---ATTGTCTCTTACGGTG -AAGGGGATGCTAAGCCAATGAGTTGTTGTCTCTCAATGTG",
+        "AA-GGGAATGTTAACCAAATGA---ATTGTCTCTTACGGTG AA-GGGGATGCTAAGCCAATGAGTTGTTGTCTCTCAATGTG" };
+      for (size_t s = 0; s < selections.size(); ++s) {
+        MafParser fullGapParser(new MappedFileLineReader("example.maf"));
+        fullGapParser.setVerbose(false);
+        FullGapFilterMafIterator fullGap(&fullGapParser, selections[s]);
+        fullGap.setVerbose(false);
+        vector<size_t> sizes;
+        string first;
+        while (MafBlock* block = fullGap.nextBlock()) {
+          sizes.push_back(block->getNumberOfSites());
+          if (sizes.size() == 1)
+            first = block->getSequenceForSpecies("hg16").toString() + " " + block->getSequenceForSpecies("rn3").toString();
+          delete block;
+        }
+        if (sizes != vector<size_t>({ 41, 6, 13 }) || first != expected[s]) {
+          cerr << "Full gap filter removed wrong columns with selection " << s << ": " << first << endl;
+          return 1;
+        }
+      }
+
+      //NbWithoutGap, NbComplete, NbConstant, NbBiallelic, NbTriallelic, NbQuadriallelic, NbParsimonyInformative, for each block:
+      vector< vector<string> > statSelections = { { "hg16", "panTro1", "baboon", "mm4", "rn3" }, { "hg16", "mm4", "rn3" }, { "rn3", "mm4" } };
+      vector< vector< vector<double> > > expectedStats = {
+        { { 37, 37, 28, 8, 0, 1, 5 }, { 6, 6, 5, 1, 0, 0, 0 }, { 13, 13, 11, 2, 0, 0, 0 } },
+        { { 37, 37, 28, 8, 1, 0, 0 }, { 6, 6, 5, 1, 0, 0, 0 }, { 13, 13, 11, 2, 0, 0, 0 } },
+        { { 37, 37, 31, 6, 0, 0, 0 }, { 6, 6, 5, 1, 0, 0, 0 }, { 13, 13, 13, 0, 0, 0, 0 } } };
+      for (size_t s = 0; s < statSelections.size(); ++s) {
+        MafParser statParser(new MappedFileLineReader("example.maf"));
+        statParser.setVerbose(false);
+        SiteMafStatistics siteStats(statSelections[s]);
+        vector<string> tags = siteStats.getSupportedTags();
+        size_t b = 0;
+        while (MafBlock* block = statParser.nextBlock()) {
+          siteStats.compute(*block);
+          const ColumnCounts* counts = &block->getColumnCounts(statSelections[s], true);
+          for (size_t t = 0; t < tags.size(); ++t) {
+            if (b >= expectedStats[s].size() || siteStats.getResult().getValue(tags[t]) != expectedStats[s][b][t]) {
+              cerr << "Site statistics differ for selection " << s << ", block " << b << ", tag " << tags[t] << "." << endl;
+              return 1;
+            }
+          }
+          //The statistics cached the counts in the block, and modifying the block discards them:
+          if (&siteStats.getColumnCounts(*block) != counts) {
+            cerr << "Site statistics did not share the column counts of block " << b << "." << endl;
+            return 1;
+          }
+          size_t nbRows = counts->getNumberOfRows();
+          block->deleteSequence(block->getNumberOfSequences() - 1);
+          if (block->getColumnCounts(statSelections[s], true).getNumberOfRows() != nbRows - 1) {
+            cerr << "Column counts were not updated after a sequence was removed from block " << b << "." << endl;
+            return 1;
+          }
+          delete block;
+          ++b;
+        }
+        if (b != 3) return 1;
+      }
+    }
+    //Sequence diversity, pi being the mean proportion of pairwise differences per complete site:
+    {
+      MafParser diversityParser(new MappedFileLineReader("example.maf"));
+      diversityParser.setVerbose(false);
+      SequenceDiversityMafStatistics diversity({ "hg16", "panTro1", "baboon", "mm4", "rn3" });
+      //Segregating sites, Watterson's theta, Tajima's pi and D of each block, rn3 being absent from the last one:
+      vector< vector<double> > expectedDiversity = {
+        { 9, 108. / 925., 49. / 370., 0.9541046050027393 },
+        { 1, 2. / 25., 1. / 15., -0.8164965809277289 },
+        { 2, 12. / 143., 1. / 13., -0.7098961678794737 } };
+      vector<string> tags = { "NbSeggregating", "WattersonTheta", "TajimaPi", "TajimaD" };
+      size_t b = 0;
+      while (MafBlock* block = diversityParser.nextBlock()) {
+        diversity.compute(*block);
+        delete block;
+        for (size_t t = 0; t < tags.size(); ++t) {
+          if (b >= expectedDiversity.size() || abs(diversity.getResult().getValue(tags[t]) - expectedDiversity[b][t]) > 1e-12) {
+            cerr << "Sequence diversity differs for block " << b << ", tag " << tags[t] << "." << endl;
+            return 1;
+          }
+        }
+        ++b;
+      }
+      if (b != 3) return 1;
+    }
+    //Windowed statistics, the second block having no segregating site and therefore a NaN Tajima's D:
+    {
+      MafParser windowParser(new MappedFileLineReader("example.maf"));
+      windowParser.setVerbose(false);
+      SequenceDiversityMafStatistics diversity({ "hg16", "panTro1", "baboon", "mm4" });
+      SequenceStatisticsMafIterator stats(&windowParser, { &diversity });
+      stats.setVerbose(false);
+      ostringstream windowOutput;
+      StlOutputStreamWrapper windowStream(&windowOutput);
+      WindowedStatisticsOutputIterationListener windows(&stats, "hg16", 200000, &windowStream);
+      stats.addIterationListener(&windows);
+      parse(stats);
+      //The second window holds the last two blocks, and only the last one has a value:
+      istringstream lines(windowOutput.str());
+      vector< vector<string> > fields;
+      string line;
+      while (getline(lines, line)) {
+        StringTokenizer tokens(line, "\t");
+        fields.push_back(vector<string>());
+        while (tokens.hasMoreToken())
+          fields.back().push_back(tokens.nextToken());
+      }
+      size_t column = 0;
+      for (size_t i = 0; fields.size() > 0 && i < fields[0].size(); ++i)
+        if (fields[0][i] == "SequenceDiversityStatistics.TajimaD.Sum") column = i;
+      bool ok = fields.size() == 3 && column > 0 && fields[2].size() == fields[0].size() && fields[2][3] == "2";
+      for (size_t k = 0; ok && k < 4; ++k)
+        ok = abs(TextTools::toDouble(fields[2][column + k]) + 0.7098961678794737) < 1e-4;
+      if (!ok) {
+        cerr << "Windowed statistics did not ignore a NaN value:" << endl << windowOutput.str() << endl;
+        return 1;
+      }
+    }
+    //Site frequency spectrum, compared to the site-by-site scan of the original implementation:
+    {
+      vector<double> bounds = { 0, 1, 2, 3, 4, 5 };
+      vector<string> all = { "hg16", "panTro1", "baboon", "mm4", "rn3" };
+      vector<SiteFrequencySpectrumMafStatistics*> spectra = {
+        new SiteFrequencySpectrumMafStatistics(&AlphabetTools::DNA_ALPHABET, bounds, all),
+        new SiteFrequencySpectrumMafStatistics(&AlphabetTools::DNA_ALPHABET, bounds, { "hg16", "panTro1", "baboon", "rn3" }, "mm4"),
+        new SiteFrequencySpectrumMafStatistics(&AlphabetTools::DNA_ALPHABET, { 0, 1, 2 }, all) };
+      //Bins, then unresolved, saturated and ignored sites, for each block:
+      vector< vector< vector<double> > > expectedSpectra = {
+        { { 28, 4, 4, 0, 0, 5, 1, 0 }, { 5, 1, 0, 0, 0, 0, 0, 0 }, { 11, 2, 0, 0, 0, 0, 0, 0 } },
+        { { 28, 3, 1, 3, 1, 5, 1, 0 }, { 5, 1, 0, 0, 0, 0, 0, 0 }, { 11, 0, 0, 2, 0, 0, 0, 0 } },
+        { { 28, 4, 5, 1, 4 }, { 5, 1, 0, 0, 0 }, { 11, 2, 0, 0, 0 } } };
+      for (size_t s = 0; s < spectra.size(); ++s) {
+        MafParser sfsParser(new MappedFileLineReader("example.maf"));
+        sfsParser.setVerbose(false);
+        vector<string> tags = spectra[s]->getSupportedTags();
+        vector<double> totals(tags.size(), 0);
+        size_t b = 0;
+        while (MafBlock* block = sfsParser.nextBlock()) {
+          spectra[s]->compute(*block);
+          delete block;
+          for (size_t t = 0; t < tags.size(); ++t) {
+            if (b >= expectedSpectra[s].size() || spectra[s]->getResult().getValue(tags[t]) != expectedSpectra[s][b][t]) {
+              cerr << "Site frequency spectrum " << s << " differs for block " << b << ", tag " << tags[t] << "." << endl;
+              return 1;
+            }
+            totals[t] += expectedSpectra[s][b][t];
+          }
+          ++b;
+        }
+        for (size_t t = 0; t < tags.size(); ++t) {
+          if (spectra[s]->getAccumulatedResult().getValue(tags[t]) != totals[t]) {
+            cerr << "Site frequency spectrum " << s << " accumulated a wrong value for tag " << tags[t] << "." << endl;
+            return 1;
+          }
+        }
+        delete spectra[s];
+      }
+      //Sites are scanned in the order of the ingroup selection, and classified by the first unresolved character or third state met:
+      istringstream scanned("##maf version=1\n\na score=0\ns sp4.chr1 0 2 + 10 -AT\ns sp3.chr1 0 2 + 10 G-T\n"
+          "s sp2.chr1 0 3 + 10 CAT\ns sp1.chr1 0 3 + 10 ACT\n\n");
+      MafParser scannedParser(&scanned);
+      scannedParser.setVerbose(false);
+      SiteFrequencySpectrumMafStatistics sfs(&AlphabetTools::DNA_ALPHABET, bounds, { "sp1", "sp2", "sp3", "sp4" });
+      unique_ptr<MafBlock> block(scannedParser.nextBlock());
+      sfs.compute(*block);
+      vector<double> expected = { 1, 0, 0, 0, 0, 1, 1, 0 };
+      vector<string> tags = sfs.getSupportedTags();
+      for (size_t t = 0; t < tags.size(); ++t) {
+        if (sfs.getResult().getValue(tags[t]) != expected[t]) {
+          cerr << "Site frequency spectrum depends on the order of sequences in the block, tag " << tags[t] << "." << endl;
+          return 1;
+        }
+      }
+    }
+    //Statistics sharing a selection are swept together, and give the same results as when computed alone:
+    {
+      vector<string> all = { "hg16", "panTro1", "baboon", "mm4", "rn3" };
+      vector<string> primates = { "hg16", "panTro1", "baboon", "mm4" };
+      SiteMafStatistics siteAll(all), siteRodents({ "rn3", "mm4" }), sitePrimates(primates);
+      SequenceDiversityMafStatistics diversityAll(all), diversityPrimates(primates);
+      BlockSizeMafStatistics blockSize;
+      vector<MafStatistics*> statistics = { &siteAll, &diversityAll, &blockSize, &siteRodents, &sitePrimates, &diversityPrimates };
+      SiteMafStatistics aloneSiteAll(all), aloneSiteRodents({ "rn3", "mm4" }), aloneSitePrimates(primates);
+      SequenceDiversityMafStatistics aloneDiversityAll(all), aloneDiversityPrimates(primates);
+      BlockSizeMafStatistics aloneBlockSize;
+      vector<MafStatistics*> alone = { &aloneSiteAll, &aloneDiversityAll, &aloneBlockSize, &aloneSiteRodents, &aloneSitePrimates, &aloneDiversityPrimates };
+      MafParser sweepParser(new MappedFileLineReader("example.maf"));
+      sweepParser.setVerbose(false);
+      SequenceStatisticsMafIterator sweepStats(&sweepParser, statistics);
+      sweepStats.setVerbose(false);
+      size_t b = 0;
+      while (MafBlock* block = sweepStats.nextBlock()) {
+        size_t k = 0;
+        for (size_t i = 0; i < alone.size(); ++i) {
+          alone[i]->compute(*block);
+          vector<string> tags = alone[i]->getSupportedTags();
+          for (size_t t = 0; t < tags.size(); ++t, ++k) {
+            double expected = alone[i]->getResult().getValue(tags[t]);
+            double observed = sweepStats.getResults().getValue(k);
+            if (observed != expected && !(std::isnan(observed) && std::isnan(expected))) {
+              cerr << "Swept statistic " << sweepStats.getResultsColumnNames()[k] << " differs from its value computed alone in block " << b << "." << endl;
+              return 1;
+            }
+          }
+        }
+        delete block;
+        ++b;
+      }
+      if (b != 3 || siteAll.getResult().getValue("NbParsimonyInformative") != 0) return 1;
+    }
+    //Statistics computed in parallel are returned in input order, with the same values as when computed serially:
+    {
+      auto factory = []() -> vector<MafStatistics*> {
+        return {
+          new SiteMafStatistics({ "hg16", "panTro1", "baboon", "mm4", "rn3" }),
+          new SequenceDiversityMafStatistics({ "hg16", "panTro1", "baboon", "mm4" }),
+          new BlockSizeMafStatistics(),
+          new SiteFrequencySpectrumMafStatistics(&AlphabetTools::DNA_ALPHABET, { 0, 1, 2, 3 }, { "hg16", "panTro1", "baboon", "rn3" }, "mm4") };
+      };
+      MafParser serialParser(new MappedFileLineReader("example.maf"));
+      serialParser.setVerbose(false);
+      WindowSplitMafIterator serialWindows(&serialParser, 3, WindowSplitMafIterator::RAGGED_LEFT, true);
+      serialWindows.setVerbose(false);
+      vector<MafStatistics*> serialStatistics = factory();
+      SequenceStatisticsMafIterator serialStats(&serialWindows, serialStatistics);
+      serialStats.setVerbose(false);
+      MafParser parallelParser(new MappedFileLineReader("example.maf"));
+      parallelParser.setVerbose(false);
+      WindowSplitMafIterator parallelWindows(&parallelParser, 3, WindowSplitMafIterator::RAGGED_LEFT, true);
+      parallelWindows.setVerbose(false);
+      ParallelSequenceStatisticsMafIterator parallelStats(&parallelWindows, factory, 3, 2);
+      parallelStats.setVerbose(false);
+      if (parallelStats.getResultsColumnNames() != serialStats.getResultsColumnNames()) {
+        cerr << "Parallel statistics do not have the same columns as serial ones." << endl;
+        return 1;
+      }
+      size_t nbBlocks = 0;
+      while (MafBlock* serialBlock = serialStats.nextBlock()) {
+        unique_ptr<MafBlock> parallelBlock(parallelStats.nextBlock());
+        if (!parallelBlock.get() || parallelBlock->getSequence(0).start() != serialBlock->getSequence(0).start()) {
+          cerr << "Parallel statistics returned block " << nbBlocks << " out of order." << endl;
+          return 1;
+        }
+        delete serialBlock;
+        for (size_t k = 0; k < serialStats.getResultsColumnNames().size(); ++k) {
+          double expected = serialStats.getResults().getValue(k);
+          double observed = parallelStats.getResults().getValue(k);
+          if (observed != expected && !(std::isnan(observed) && std::isnan(expected))) {
+            cerr << "Parallel statistic " << serialStats.getResultsColumnNames()[k] << " differs in block " << nbBlocks << "." << endl;
+            return 1;
+          }
+        }
+        ++nbBlocks;
+      }
+      if (nbBlocks < 10 || parallelStats.nextBlock()) return 1;
+      //The spectra accumulated by each thread are merged once the iteration is over:
+      const MergeableMafStatistics& serialSfs = dynamic_cast<const MergeableMafStatistics&>(*serialStatistics[3]);
+      const MergeableMafStatistics& parallelSfs = dynamic_cast<const MergeableMafStatistics&>(*parallelStats.getStatistics()[3]);
+      vector<string> tags = serialStatistics[3]->getSupportedTags();
+      for (size_t t = 0; t < tags.size(); ++t) {
+        if (parallelSfs.getAccumulatedResult().getValue(tags[t]) != serialSfs.getAccumulatedResult().getValue(tags[t])) {
+          cerr << "Merged site frequency spectrum differs for tag " << tags[t] << "." << endl;
+          return 1;
+        }
+      }
+      for (size_t i = 0; i < serialStatistics.size(); ++i)
+        delete serialStatistics[i];
+    }
+    //Four-species pattern counts, compared to the site-by-site comparisons of the original implementation:
+    {
+      vector< vector<string> > quartets = { { "hg16", "baboon", "mm4", "rn3" }, { "hg16", "panTro1", "baboon", "mm4" }, { "hg16", "rn3", "mm4", "baboon" } };
+      //f1100, f0110, f1010 and Ignored, for each block, rn3 being absent from the last one:
+      vector< vector< vector<double> > > expectedPatterns = {
+        { { 3, 0, 1, 5 }, { 0, 0, 0, 0 }, { 0, 0, 0, 13 } },
+        { { 0, 0, 0, 5 }, { 0, 0, 0, 0 }, { 0, 0, 0, 0 } },
+        { { 0, 3, 1, 5 }, { 0, 0, 0, 0 }, { 0, 0, 0, 13 } } };
+      for (size_t q = 0; q < quartets.size(); ++q) {
+        MafParser patternParser(new MappedFileLineReader("example.maf"));
+        patternParser.setVerbose(false);
+        FourSpeciesPatternCountsMafStatistics patterns(&AlphabetTools::DNA_ALPHABET, quartets[q], 10);
+        vector<string> tags = patterns.getSupportedTags();
+        size_t b = 0;
+        while (MafBlock* block = patternParser.nextBlock()) {
+          patterns.compute(*block);
+          delete block;
+          for (size_t t = 0; t < tags.size(); ++t) {
+            if (b >= expectedPatterns[q].size() || patterns.getResult().getValue(tags[t]) != expectedPatterns[q][b][t]) {
+              cerr << "Four-species pattern counts differ for quartet " << q << ", block " << b << ", tag " << tags[t] << "." << endl;
+              return 1;
+            }
+          }
+          ++b;
+        }
+        if (b != 3) return 1;
+        if (q < 2) continue;
+        //Informative sites are at positions 15 (f0110), 26 (f1010), 35 and 38 (f0110), and the second block extends the last jackknife block to position 47:
+        vector<unsigned int> expectedCounts = { 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 2, 0, 0, 0, 0 };
+        double d, se;
+        FourSpeciesPatternCountsMafStatistics::computeDStatistic(patterns.getJackknifeCounts(), d, se);
+        if (patterns.getJackknifeCounts() != expectedCounts || abs(d - 0.5) > 1e-12 || abs(se - 0.6463573143221772) > 1e-12) {
+          cerr << "Wrong jackknife counts or D statistic: " << d << " +/- " << se << "." << endl;
+          return 1;
+        }
+      }
+    }
+    //Divergence matrix, compared to one pairwise divergence per pair of species:
+    {
+      vector<string> species = { "hg16", "panTro1", "mm4", "rn3" };
+      DivergenceMatrixMafStatistics matrix(species);
+      //hg16-mm4 and mm4-rn3 divergences in each block, rn3 being absent from the last one:
+      vector< vector<double> > expectedDivergences = {
+        { 500. / 37., 600. / 37. }, { 0., 100. / 6. }, { 200. / 13., std::nan("") } };
+      MafParser divergenceParser(new MappedFileLineReader("example.maf"));
+      divergenceParser.setVerbose(false);
+      size_t b = 0;
+      while (MafBlock* block = divergenceParser.nextBlock()) {
+        matrix.compute(*block);
+        for (size_t i = 0; i < species.size(); ++i) {
+          for (size_t j = i + 1; j < species.size(); ++j) {
+            PairwiseDivergenceMafStatistics pairwise(species[i], species[j]);
+            pairwise.compute(*block);
+            double expected = pairwise.getResult().getValue();
+            double observed = matrix.getResult().getValue(species[i] + "-" + species[j]);
+            if (std::isnan(expected) != std::isnan(observed) || abs(observed - expected) > 1e-9) {
+              cerr << "Divergence matrix differs from pairwise divergence for " << species[i] << "-" << species[j] << " in block " << b << "." << endl;
+              return 1;
+            }
+          }
+        }
+        delete block;
+        double hgMm = matrix.getResult().getValue("hg16-mm4");
+        double mmRn = matrix.getResult().getValue("mm4-rn3");
+        if (b >= expectedDivergences.size() || abs(hgMm - expectedDivergences[b][0]) > 1e-9
+            || (std::isnan(expectedDivergences[b][1]) ? !std::isnan(mmRn) : abs(mmRn - expectedDivergences[b][1]) > 1e-9)) {
+          cerr << "Wrong divergences in block " << b << ": " << hgMm << ", " << mmRn << "." << endl;
+          return 1;
+        }
+        ++b;
+      }
+      if (b != 3) return 1;
+    }
+    //Column classification bitmaps, compared to the per-column counts:
+    {
+      vector<MafBlock*> blocks;
+      MafParser classParser(new MappedFileLineReader("example.maf"));
+      classParser.setVerbose(false);
+      while (MafBlock* block = classParser.nextBlock())
+        blocks.push_back(block);
+      istringstream ambiguous("##maf version=1\n\na score=0\ns hg16.chr1 0 4 + 10 AC-NT\ns mm4.chr1 0 5 + 10 ARGNT\ns rn3.chr1 0 5 + 10 AGGTT\n\n");
+      MafParser ambiguousParser(&ambiguous);
+      ambiguousParser.setVerbose(false);
+      blocks.push_back(ambiguousParser.nextBlock());
+      for (size_t b = 0; b < blocks.size(); ++b) {
+        //All sequences, then the primates only:
+        for (size_t s = 0; s < 2; ++s) {
+          vector<const vector<int>*> rows;
+          for (size_t i = 0; i < blocks[b]->getNumberOfSequences(); ++i) {
+            const MafSequence& seq = blocks[b]->getSequence(i);
+            if (s == 0 || seq.getSpecies() == "hg16" || seq.getSpecies() == "panTro1" || seq.getSpecies() == "baboon")
+              rows.push_back(&seq.getContent());
+          }
+          size_t nbSites = blocks[b]->getNumberOfSites();
+          ColumnClassification classes(rows, nbSites);
+          ColumnCounts counts(rows, nbSites);
+          size_t nbComplete = 0;
+          for (size_t i = 0; i < nbSites; ++i) {
+            const unsigned int* siteCounts = counts.getCounts(i);
+            unsigned int nbStates = 0;
+            for (size_t k = 1; k < 5; ++k)
+              if (siteCounts[k] > 0) nbStates++;
+            bool complete = (counts.getNumberOfResolved(i) == counts.getNumberOfRows());
+            nbComplete += complete;
+            if (classes.isComplete(i) != complete
+                || classes.isConstant(i) != (complete && nbStates == 1)
+                || classes.isBiallelic(i) != (complete && nbStates == 2)
+                || classes.hasGap(i) != (counts.getNumberOfGaps(i) > 0)
+                || classes.hasUnknown(i) != (counts.getCount(i, 14) > 0)) {
+              cerr << "Column classification differs from column counts in block " << b << ", selection " << s << ", site " << i << "." << endl;
+              return 1;
+            }
+          }
+          //Bits past the last site are never set:
+          size_t nbBits = 0;
+          const vector<uint64_t>& complete = classes.getCompleteBitmap();
+          for (size_t w = 0; w < complete.size(); ++w)
+            nbBits += BitTools::popcount(complete[w]);
+          if (complete.size() != BitTools::getNumberOfWords(nbSites) || nbBits != nbComplete) {
+            cerr << "Column classification bitmap of block " << b << " has bits past the last site." << endl;
+            return 1;
+          }
+        }
+        delete blocks[b];
+      }
+    }
+    //Polymorphism statistics, compared to the site-by-site patterns of the original implementation:
+    {
+      MafParser polymorphismParser(new MappedFileLineReader("example.maf"));
+      polymorphismParser.setVerbose(false);
+      PolymorphismMafStatistics polymorphism({ { "hg16", "panTro1", "baboon" }, { "mm4", "rn3" } });
+      //F, P, FP, PF, FF, X, FX, PX, XF and XP, for each block:
+      vector< vector<double> > expectedPolymorphism = {
+        { 28, 2, 4, 0, 3, 4, 1, 0, 0, 0 },
+        { 5, 0, 1, 0, 0, 0, 0, 0, 0, 0 },
+        { 11, 0, 0, 0, 2, 0, 0, 0, 0, 0 } };
+      vector<string> tags = polymorphism.getSupportedTags();
+      size_t b = 0;
+      while (MafBlock* block = polymorphismParser.nextBlock()) {
+        polymorphism.compute(*block);
+        delete block;
+        for (size_t t = 0; t < tags.size(); ++t) {
+          if (b >= expectedPolymorphism.size() || polymorphism.getResult().getValue(tags[t]) != expectedPolymorphism[b][t]) {
+            cerr << "Polymorphism statistics differ for block " << b << ", tag " << tags[t] << "." << endl;
+            return 1;
+          }
+        }
+        ++b;
+      }
+      if (b != 3) return 1;
+    }
+    //Reading a result never creates a slot, slots being only created when a value is set:
+    {
+      MafStatisticsResult result;
+      result.setValue("A", 1.);
+      const MafStatisticsResult& constResult = result;
+      bool thrown = false;
+      try {
+        constResult.getValue("B");
+      } catch (Exception&) {
+        thrown = true;
+      }
+      try {
+        constResult.getSlot("B");
+        thrown = false;
+      } catch (Exception&) {}
+      if (!thrown || constResult.hasValue("B") || constResult.hasSlot("B") || constResult.getNumberOfSlots() != 1
+          || constResult.getSlot("A") != 0 || constResult.getValue("A") != 1.) {
+        cerr << "Reading a statistics result modified it." << endl;
+        return 1;
+      }
+    }
+    //VCF output, with and without genotypes:
+    {
+      vector<string> variants = {
+        "chr7\t27578835\t.\tA\tG\t.\tPASS\tAC=1", "chr7\t27578839\t.\tT\tC\t.\tPASS\tAC=1", "chr7\t27578843\t.\tC\tG\t.\tPASS\tAC=2",
+        "chr7\t27578845\t.\tA\tC\t.\tPASS\tAC=1", "chr7\t27578848\t.\tT\tC\t.\tPASS\tAC=1", "chr7\t27578851\t.\tA\tG\t.\tPASS\tAC=2",
+        "chr7\t27578860\t.\tT\tC\t.\tPASS\tAC=2", "chr7\t27578862\t.\tC\tA,G,T\t.\tPASS\tAC=1,1,1", "chr7\t27578863\t.\tG\tT\t.\tPASS\tAC=2",
+        "chr7\t27699743\t.\tA\tG\t.\tPASS\tAC=1", "chr7\t27707222\t.\tG\tA\t.\tPASS\tAC=1", "chr7\t27707233\t.\tC\tT\t.\tPASS\tAC=1" };
+      //Genotypes of mm4 and rn3 at each variant, rn3 being absent from the last block:
+      vector<string> mm4 = { "0", "0", "1", "0", "1", "0", "1", "2", "1", "0", "1", "1" };
+      vector<string> rn3 = { "1", "1", "1", "1", "0", "1", "1", "1", "1", "1", ".", "." };
+      for (size_t c = 0; c < 5; ++c) {
+        MafParser vcfParser(new MappedFileLineReader("example.maf"));
+        vcfParser.setVerbose(false);
+        ostringstream vcf;
+        string header = "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO";
+        {
+          unique_ptr<VcfOutputMafIterator> writer;
+          if (c == 0) {
+            writer.reset(new VcfOutputMafIterator(&vcfParser, &vcf, "hg16", vector<string>()));
+          } else if (c <= 2) {
+            writer.reset(new VcfOutputMafIterator(&vcfParser, &vcf, "hg16", vector<string>({ "mm4", "rn3" }), false, c == 2));
+            header += "\tFORMAT\tmm4\trn3";
+          } else {
+            writer.reset(new VcfOutputMafIterator(&vcfParser, &vcf, "hg16", vector< vector<string> >({ { "mm4", "rn3" } }), false, c == 4));
+            header += "\tFORMAT\tmm4-rn3";
+          }
+          writer->setVerbose(false);
+          //Lines are buffered until the end of the input:
+          MafBlock* block = writer->nextBlock();
+          if (vcf.str().find("\nchr7") != string::npos) {
+            cerr << "VCF lines were written before the end of input." << endl;
+            return 1;
+          }
+          do { delete block; } while ((block = writer->nextBlock()));
+        }
+        istringstream lines(vcf.str());
+        string line;
+        vector<string> records;
+        bool hasHeader = false;
+        while (getline(lines, line)) {
+          if (line == header) hasHeader = true;
+          else if (line.size() > 0 && line[0] != '#') records.push_back(line);
+        }
+        bool ok = hasHeader && records.size() == variants.size();
+        for (size_t i = 0; ok && i < records.size(); ++i) {
+          string expected = variants[i];
+          if (c == 1) expected += "\tGT\t" + mm4[i] + "\t" + rn3[i];
+          if (c == 2) expected += "\tGT\t" + mm4[i] + "|" + mm4[i] + "\t" + rn3[i] + "|" + rn3[i];
+          if (c == 3) expected += "\tGT\t" + mm4[i] + "|" + rn3[i];
+          if (c == 4) expected += "\tGT\t" + mm4[i] + "|" + mm4[i] + "|" + rn3[i] + "|" + rn3[i];
+          ok = (records[i] == expected);
+        }
+        if (!ok) {
+          cerr << "VCF output " << c << " differs:" << endl << vcf.str() << endl;
+          return 1;
+        }
+      }
+
+      //Buffered lines are written when the writer is destroyed before the end of input:
+      MafParser vcfParser(new MappedFileLineReader("example.maf"));
+      vcfParser.setVerbose(false);
+      ostringstream vcf;
+      {
+        VcfOutputMafIterator writer(&vcfParser, &vcf, "hg16", vector<string>());
+        writer.setVerbose(false);
+        delete writer.nextBlock();
+      }
+      if (vcf.str().find("\n" + variants[8] + "\n") == string::npos || vcf.str().find(variants[9]) != string::npos) {
+        cerr << "VCF lines of the first block were not flushed on destruction." << endl;
+        return 1;
+      }
+
+      //Ambiguous reference states are written with the characters of the alphabet:
+      const string& chars = ColumnCounts::getCharacters();
+      for (int state = -1; state < 15; ++state) {
+        if (chars.substr(static_cast<size_t>(state + 1), 1) != AlphabetTools::DNA_ALPHABET.intToChar(state)) {
+          cerr << "Wrong character for state " << state << ": " << chars << endl;
+          return 1;
+        }
+      }
+      istringstream ambiguous("##maf version=1\n\na score=0\ns hg16.chr1 0 3 + 10 MCA\ns mm4.chr1 0 3 + 10 ACG\n\n");
+      MafParser ambiguousParser(&ambiguous);
+      ambiguousParser.setVerbose(false);
+      ostringstream ambiguousVcf;
+      {
+        VcfOutputMafIterator writer(&ambiguousParser, &ambiguousVcf, "hg16", vector<string>());
+        writer.setVerbose(false);
+        while (MafBlock* block = writer.nextBlock()) delete block;
+      }
+      if (ambiguousVcf.str().find("\nchr1\t1\t.\tM\tA\t.\tPASS\tAC=1\nchr1\t3\t.\tA\tG\t.\tPASS\tAC=1\n") == string::npos) {
+        cerr << "Ambiguous reference state was not written correctly:" << endl << ambiguousVcf.str() << endl;
+        return 1;
+      }
+    }
+
+    //BCF output of all positions, decoded record by record:
+    {
+      {
+        ofstream bcfFile("example.bcf", ios::out | ios::binary);
+        istringstream input("##maf version=1\n\na score=0\ns hg16.chr1 0 3 + 10 MCA\ns mm4.chr1 0 3 + 10 ACG\n\n");
+        MafParser bcfParser(&input);
+        bcfParser.setVerbose(false);
+        BcfOutputMafIterator writer(&bcfParser, &bcfFile, "hg16", vector<string>({ "chr1" }), vector< vector<string> >({ { "mm4" } }), true);
+        writer.setVerbose(false);
+        while (MafBlock* block = writer.nextBlock()) delete block;
+      }
+      string bcf;
+      {
+        CompressedFileReader reader("example.bcf");
+        const char* data;
+        size_t size, start;
+        uint64_t address;
+        while (reader.nextChunk(data, size, start, address))
+          bcf.append(data + start, size - start);
+      }
+      remove("example.bcf");
+      auto readInt32 = [&bcf](size_t pos) {
+        uint32_t value = 0;
+        for (size_t k = 4; k > 0; --k)
+          value = (value << 8) | static_cast<unsigned char>(bcf[pos + k - 1]);
+        return value;
+      };
+      //Each record is described as "position alleles... AC=values GT=value":
+      vector<string> records;
+      size_t pos = bcf.substr(0, 5) == string("BCF\2\2", 5) ? 9 + readInt32(5) : bcf.size();
+      while (pos + 8 <= bcf.size()) {
+        size_t lShared = readInt32(pos);
+        size_t lIndiv = readInt32(pos + 4);
+        size_t p = pos + 8;
+        string desc = to_string(readInt32(p + 4) + 1);
+        size_t nbAlleles = readInt32(p + 16) >> 16;
+        size_t nbInfo = readInt32(p + 16) & 0xffff;
+        p += 25; //Fixed fields and missing ID.
+        for (size_t a = 0; a < nbAlleles; ++a, p += 2)
+          desc += " " + bcf.substr(p + 1, 1);
+        p += 1 + (static_cast<unsigned char>(bcf[p]) >> 4); //Filters
+        for (size_t i = 0; i < nbInfo; ++i) {
+          size_t n = static_cast<unsigned char>(bcf[p + 2]) >> 4;
+          desc += " AC=";
+          for (size_t k = 0; k < n; ++k)
+            desc += (k > 0 ? "," : "") + to_string(static_cast<int>(bcf[p + 3 + k]));
+          p += 3 + n;
+        }
+        desc += " GT=" + to_string(static_cast<int>(bcf[pos + 8 + lShared + 3]));
+        records.push_back(desc);
+        pos += 8 + lShared + lIndiv;
+      }
+      //Genotypes are coded as (allele + 1) << 1:
+      vector<string> expected = { "1 M A AC=1 GT=4", "2 C AC=2 GT=2", "3 A G AC=1 GT=4" };
+      if (records != expected) {
+        cerr << "BCF records differ:";
+        for (size_t i = 0; i < records.size(); ++i) cerr << " [" << records[i] << "]";
+        cerr << endl;
+        return 1;
+      }
+    }
+
+    //Columnar tables are read back with their positions, chromosomes and states, with or without compression:
+    for (int level = 0; level < 2; ++level) {
+      {
+        ofstream tableFile("example.col", ios::out | ios::binary);
+        istringstream input("##maf version=1\n\na score=0\ns hg16.chr1 0 3 + 10 MC-A\ns mm4.chr1 0 4 + 10 ACGT\n\n"
+                            "a score=0\ns hg16.chr2 5 2 + 10 GN\ns mm4.chr1 10 1 + 20 Y-\n\n");
+        MafParser tableParser(&input);
+        tableParser.setVerbose(false);
+        ColumnarTableOutputMafIterator writer(&tableParser, &tableFile, { "hg16", "mm4" }, "hg16", 4, level);
+        writer.setVerbose(false);
+        while (MafBlock* block = writer.nextBlock()) delete block;
+      }
+      ColumnarTableReader reader("example.col");
+      vector<int64_t> positions;
+      vector<uint32_t> chromosomes;
+      vector<string> rows(2);
+      for (size_t c = 0; c < reader.getNumberOfChunks(); ++c) {
+        vector<int64_t> chunkPositions;
+        vector<uint32_t> chunkChromosomes;
+        vector< vector<uint8_t> > columns;
+        reader.readChunk(c, chunkPositions, chunkChromosomes, columns);
+        positions.insert(positions.end(), chunkPositions.begin(), chunkPositions.end());
+        chromosomes.insert(chromosomes.end(), chunkChromosomes.begin(), chunkChromosomes.end());
+        for (size_t j = 0; j < columns.size() && j < 2; ++j)
+          for (size_t k = 0; k < columns[j].size(); ++k)
+            rows[j] += reader.getStates()[columns[j][k]];
+      }
+      remove("example.col");
+      if (reader.getStates() != ColumnCounts::getCharacters() || reader.getNumberOfChunks() != 2
+          || reader.getChromosomes() != vector<string>({ "chr1", "chr2" })
+          || positions != vector<int64_t>({ 0, 1, 1, 2, 0, 1 })
+          || chromosomes != vector<uint32_t>({ 0, 0, 0, 0, 1, 1 })
+          || rows[0] != "MC-AGN" || rows[1] != "ACGTY-") {
+        cerr << "Columnar table was not read back correctly: " << rows[0] << " " << rows[1] << endl;
+        return 1;
+      }
+    }
+
+    //PLINK binary output, the third block being ignored as it has no rn3 sequence:
+    {
+      MafParser plinkParser(new MappedFileLineReader("example.maf"));
+      plinkParser.setVerbose(false);
+      ostringstream bed, bim, fam;
+      PlinkOutputMafIterator plink(&plinkParser, &bed, &bim, &fam, { "hg16", "mm4", "rn3" }, "hg16");
+      plink.setVerbose(false);
+      while (MafBlock* block = plink.nextBlock()) delete block;
+      vector<string> snps = {
+        "27578835\tA\tG", "27578839\tT\tC", "27578843\tC\tG", "27578845\tA\tC", "27578848\tT\tC",
+        "27578851\tA\tG", "27578860\tT\tC", "27578863\tG\tT", "27699743\tA\tG" };
+      string expectedBim;
+      for (const string& snp : snps)
+        expectedBim += "chr7\tchr7." + snp.substr(0, 8) + "\t0\t" + snp + "\n";
+      //One byte per SNP, the species carrying the second allele being coded 11:
+      string expectedBed = string("\x6c\x1b\x01", 3) + string("\x30\x30\x3c\x30\x0c\x30\x3c\x3c\x30", 9);
+      if (bim.str() != expectedBim || bed.str() != expectedBed
+          || fam.str() != "FAM001\t1\t0\t0\t0\t0\nFAM001\t2\t0\t0\t0\t0\nFAM001\t3\t0\t0\t0\t0\n") {
+        cerr << "PLINK binary output differs:" << endl << bim.str() << endl;
+        return 1;
+      }
+    }
+
+    //MSMC output: positions of segregating sites, and number of called sites since the previous one, across blocks:
+    {
+      MafParser msmcParser(new MappedFileLineReader("example.maf"));
+      msmcParser.setVerbose(false);
+      ostringstream msmcOutput;
+      {
+        MsmcOutputMafIterator msmc(&msmcParser, &msmcOutput, { "panTro1", "mm4", "rn3" }, "hg16");
+        msmc.setVerbose(false);
+        while (MafBlock* block = msmc.nextBlock()) delete block;
+      }
+      vector<string> lines = {
+        "chr7\t27578835\t6\tAAG", "chr7\t27578839\t4\tTTC", "chr7\t27578843\t4\tCGG", "chr7\t27578845\t2\tAAC", "chr7\t27578848\t3\tTCT",
+        "chr7\t27578851\t3\tAAG", "chr7\t27578860\t9\tTCC", "chr7\t27578862\t2\tCGA", "chr7\t27578863\t1\tGTT", "chr7\t27699743\t7\tAAG" };
+      string expected;
+      for (const string& line : lines)
+        expected += line + "\n";
+      if (msmcOutput.str() != expected) {
+        cerr << "MSMC output differs:" << endl << msmcOutput.str() << endl;
+        return 1;
+      }
+    }
+    //Asynchronous writing of an archive, read back from its index:
+    {
+      vector<string> names = { "block1.fasta", "block2.fasta", "empty.fasta" };
+      vector<string> contents = { ">hg16\nACGT\n", ">hg16\nTTGA\n>mm4\nTTGC\n", "" };
+      bool rejected = true;
+      {
+        AsyncFileWriter writer("example.archive", 2);
+        for (size_t i = 0; i < names.size(); ++i) {
+          string content = contents[i];
+          writer.write(names[i], content);
+        }
+        //Duplicated names and names breaking the index are rejected:
+        vector<string> invalid = { "block1.fasta", "block\t3.fasta", "block\n3.fasta" };
+        for (size_t i = 0; i < invalid.size(); ++i) {
+          string content = "ACGT";
+          try {
+            writer.write(invalid[i], content);
+            rejected = false;
+          } catch (Exception&) {}
+        }
+        writer.close();
+        rejected = rejected && writer.getNumberOfRecords() == names.size();
+      }
+      AsyncFileReader reader("example.archive");
+      bool ok = rejected && reader.getNumberOfRecords() == names.size();
+      for (size_t i = names.size(); ok && i > 0; --i) {
+        string content = "x";
+        ok = reader.readRecord(names[i - 1], content) && content == contents[i - 1];
+      }
+      string content;
+      ok = ok && !reader.readRecord("block3.fasta", content)
+          && AsyncFileWriter::readRecord("example.archive", names[1], content) && content == contents[1];
+      //Each record is written in its own file otherwise, and a name used twice is rejected too:
+      {
+        AsyncFileWriter writer(2);
+        string content1 = contents[0], content2 = contents[1];
+        writer.write("example.archive.1", content1);
+        try {
+          writer.write("example.archive.1", content2);
+          ok = false;
+        } catch (Exception&) {}
+        writer.close();
+      }
+      ifstream written("example.archive.1");
+      string line1, line2;
+      ok = ok && getline(written, line1) && getline(written, line2) && line1 == ">hg16" && line2 == "ACGT" && !getline(written, line1);
+      written.close();
+      remove("example.archive");
+      remove("example.archive.idx");
+      remove("example.archive.1");
+      if (!ok) {
+        cerr << "Archive records could not be read back, or invalid names were accepted." << endl;
+        return 1;
+      }
+    }
+
+    return 0;
+  } catch (exception& ex) {
+    cerr << ex.what() << endl;
+    return 1;
+  }
+}